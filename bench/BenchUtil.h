@@ -0,0 +1,118 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// 基准测试公共工具：计时、结果输出与测试音频生成（纯标准库，Linux/Windows 均可编译）
+namespace bench {
+
+class Stopwatch {
+public:
+    Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+    void reset() { m_start = std::chrono::steady_clock::now(); }
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// 打印一行结果：名称、总耗时、单次耗时
+inline void report(const char* name, double totalMs, size_t operations) {
+    double nsPerOp = operations > 0 ? totalMs * 1e6 / static_cast<double>(operations) : 0.0;
+    std::printf("  %-40s %10.2f ms  %12zu ops  %10.1f ns/op\n", name, totalMs, operations, nsPerOp);
+}
+
+// 打印一行校验失败，返回 1 便于累加失败数
+inline int fail(const char* what) {
+    std::printf("  [FAIL] %s\n", what);
+    return 1;
+}
+
+// 小端写入 bytes 个字节
+inline void appendLe(std::vector<char>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// 44 字节 WAV 头。formatTag 1 为整数 PCM，3 为 IEEE float；dataBytes 为 data 块头记录的字节数
+inline std::vector<char> wavHeader(uint16_t formatTag, uint32_t rate, uint16_t channels, uint16_t bits,
+                                   uint32_t dataBytes) {
+    const uint32_t blockAlign = channels * bits / 8u;
+    std::vector<char> out;
+    out.insert(out.end(), {'R', 'I', 'F', 'F'});
+    appendLe(out, 36 + dataBytes, 4);
+    out.insert(out.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    appendLe(out, 16, 4);
+    appendLe(out, formatTag, 2);
+    appendLe(out, channels, 2);
+    appendLe(out, rate, 4);
+    appendLe(out, rate * blockAlign, 4);
+    appendLe(out, blockAlign, 2);
+    appendLe(out, bits, 2);
+    out.insert(out.end(), {'d', 'a', 't', 'a'});
+    appendLe(out, dataBytes, 4);
+    return out;
+}
+
+inline void writeFile(const std::filesystem::path& path, const std::vector<char>& bytes) {
+    std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// 16 位 PCM WAV，samples 为交错采样
+inline void writeWav(const std::filesystem::path& path, uint32_t rate, uint16_t channels,
+                     const std::vector<int16_t>& samples) {
+    const auto dataBytes = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+    std::vector<char> out = wavHeader(1, rate, channels, 16, dataBytes);
+    out.reserve(out.size() + dataBytes);
+    for (int16_t sample : samples) {
+        appendLe(out, static_cast<uint16_t>(sample), 2);
+    }
+    writeFile(path, out);
+}
+
+// 32 位 float WAV，samples 为交错采样
+inline void writeWav(const std::filesystem::path& path, uint32_t rate, uint16_t channels,
+                     const std::vector<float>& samples) {
+    const auto dataBytes = static_cast<uint32_t>(samples.size() * sizeof(float));
+    std::vector<char> out = wavHeader(3, rate, channels, 32, dataBytes);
+    if (dataBytes > 0) {
+        out.resize(out.size() + dataBytes);
+        std::memcpy(out.data() + out.size() - dataBytes, samples.data(), dataBytes);
+    }
+    writeFile(path, out);
+}
+
+// 440 Hz 正弦，各声道相同，幅度 amplitude（满幅为 1），交错采样
+inline std::vector<float> sineSamples(uint32_t rate, double seconds, uint16_t channels = 2, double amplitude = 0.5) {
+    const auto frames = static_cast<size_t>(seconds * rate + 0.5);
+    std::vector<float> samples;
+    samples.reserve(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        const double value = amplitude * std::sin(2.0 * 3.14159265358979 * 440.0 * static_cast<double>(i) / rate);
+        samples.insert(samples.end(), channels, static_cast<float>(value));
+    }
+    return samples;
+}
+
+// 16 位 PCM 正弦 WAV（440 Hz）
+inline void writeSine(const std::filesystem::path& path, uint32_t rate, double seconds, uint16_t channels = 2,
+                      double amplitude = 0.5) {
+    const std::vector<float> sine = sineSamples(rate, seconds, channels, amplitude);
+    std::vector<int16_t> samples;
+    samples.reserve(sine.size());
+    for (float value : sine) {
+        samples.push_back(static_cast<int16_t>(std::lround(value * 32767.0)));
+    }
+    writeWav(path, rate, channels, samples);
+}
+
+}  // namespace bench
@@ -0,0 +1,130 @@
+// 音频预载池基准：临时目录下生成一组大小不一的素材文件，测量整体载入耗时、吞吐与内存占用，
+// 并校验预算约束、重复载入沿用、AUTO/PCM 策略的升级与回退（PCM 解码用按字节展开的替身解码器）。
+#include "AudioAssetPool.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t kFileSizes[] = {64 << 10, 128 << 10, 256 << 10, 512 << 10, 768 << 10,
+                                 1 << 20, 2 << 20, 3 << 20, 4 << 20, 8 << 20};
+
+using bench::fail;
+
+double megabytes(uint64_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void printStats(const char* label, const AssetPoolStats& stats) {
+    std::printf("  %-28s %2zu/%zu files (raw %zu, pcm %zu, reused %zu, missing %zu, over budget %zu)  "
+                "%7.1f MB / %7.1f MB  %8.2f ms",
+                label, stats.loadedFiles, stats.requestedFiles, stats.compressedFiles, stats.pcmFiles,
+                stats.reusedFiles, stats.missingFiles, stats.overBudgetFiles, megabytes(stats.footprintBytes()),
+                megabytes(stats.budgetBytes), stats.loadMs);
+    if (stats.loadMs > 0.0 && stats.reusedFiles < stats.loadedFiles) {
+        std::printf("  %7.0f MB/s", megabytes(stats.footprintBytes()) / (stats.loadMs / 1000.0));
+    }
+    std::printf("\n");
+}
+
+// 替身解码器：每个输入字节展开为一帧立体声 float（8 倍膨胀，接近 MP3 -> PCM 的比例）
+bool fakeDecode(const std::vector<char>& bytes, PcmBuffer& out) {
+    out.sampleRate = 44100;
+    out.samples.resize(bytes.size() * 2);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        float value = static_cast<signed char>(bytes[i]) / 128.0f;
+        out.samples[i * 2] = value;
+        out.samples[i * 2 + 1] = value;
+    }
+    return true;
+}
+}  // namespace
+
+int benchAssetPool() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-assets";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+
+    std::vector<std::string> files;
+    uint64_t totalBytes = 0;
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < std::size(kFileSizes); ++i) {
+        std::string name = "clip" + std::to_string(i) + ".mp3";
+        std::vector<char> data(kFileSizes[i]);
+        for (auto& byte : data) {
+            byte = static_cast<char>(rng());
+        }
+        std::ofstream(dir / name, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+        files.push_back(name);
+        totalBytes += data.size();
+    }
+    files.push_back("absent.mp3");
+    files.push_back("clip0.mp3");  // 重复引用只载入一次
+    PathUtil::setAudioDir(dir);
+    std::printf("  %zu files, %.1f MB on disk (+1 missing, +1 duplicate reference)\n",
+                std::size(kFileSizes), megabytes(totalBytes));
+
+    int failures = 0;
+    const uint64_t MB = 1024 * 1024;
+    {
+        AudioAssetPool pool;
+        AssetPoolStats cold = pool.load(files, AssetPolicy::COMPRESSED, 256 * MB);
+        printStats("compressed, 256 MB", cold);
+        if (cold.loadedFiles != std::size(kFileSizes) || cold.missingFiles != 1 ||
+            cold.footprintBytes() != totalBytes || cold.requestedFiles != std::size(kFileSizes) + 1) {
+            failures += fail("全部文件应按原字节载入，缺失文件单独计数");
+        }
+        auto asset = pool.find("clip3.mp3");
+        if (!asset || !asset->compressed || asset->compressed->size() != kFileSizes[3] || pool.find("absent.mp3")) {
+            failures += fail("find() 结果与文件不符");
+        }
+
+        AssetPoolStats warm = pool.load(files, AssetPolicy::COMPRESSED, 256 * MB);
+        printStats("reload unchanged", warm);
+        if (warm.reusedFiles != std::size(kFileSizes) || pool.find("clip3.mp3")->compressed != asset->compressed) {
+            failures += fail("未变化的文件应直接沿用");
+        }
+
+        AssetPoolStats tight = pool.load(files, AssetPolicy::COMPRESSED, 8 * MB);
+        printStats("compressed, 8 MB", tight);
+        if (tight.footprintBytes() > 8 * MB || tight.overBudgetFiles == 0 || tight.loadedFiles == 0) {
+            failures += fail("超出预算的文件应留给磁盘");
+        }
+    }
+    {
+        AudioAssetPool pool;
+        pool.setDecoder(fakeDecode);
+        AssetPoolStats all = pool.load(files, AssetPolicy::PCM, 1024 * MB);
+        printStats("pcm, 1024 MB", all);
+        if (all.pcmFiles != std::size(kFileSizes) || all.pcmBytes != totalBytes * 8) {
+            failures += fail("PCM 策略应全部解码");
+        }
+
+        AssetPoolStats mixed = pool.load(files, AssetPolicy::PCM, 48 * MB);
+        printStats("pcm, 48 MB", mixed);
+        if (mixed.footprintBytes() > 48 * MB || mixed.pcmFiles == 0 || mixed.compressedFiles == 0) {
+            failures += fail("PCM 超预算时应退回原文件字节");
+        }
+
+        AudioAssetPool autoPool;
+        autoPool.setDecoder(fakeDecode);
+        AssetPoolStats automatic = autoPool.load(files, AssetPolicy::AUTO, 48 * MB);
+        printStats("auto, 48 MB", automatic);
+        auto small = autoPool.find("clip0.mp3");
+        auto large = autoPool.find("clip9.mp3");
+        if (automatic.footprintBytes() > 48 * MB || automatic.loadedFiles != std::size(kFileSizes) ||
+            !small || !small->pcm || !large || large->pcm) {
+            failures += fail("AUTO 应先全部载入原文件，再从小到大升级为 PCM");
+        }
+    }
+
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -0,0 +1,278 @@
+// 文件头解析基准：临时目录下生成数百个 MP3（CBR / Xing+LAME / VBRI / 带 ID3 标签）与 WAV
+// （PCM / EXTENSIBLE float / data 长度未知）以及损坏/非音频文件，整目录扫描一遍，
+// 报告每秒文件数与实际读取字节数（对比整文件读入），并逐个校验时长与拒绝结果。
+#include "AudioHeaderParser.h"
+#include "BenchUtil.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint32_t kMp3SampleRate = 44100;
+constexpr uint32_t kMp3FrameBytes = 417;  // MPEG-1 Layer III 128 kbps 44.1 kHz 无填充
+constexpr uint32_t kMp3FrameSamples = 1152;
+constexpr uint32_t kLameDelay = 576;
+constexpr uint32_t kLamePadding = 1000;
+
+struct Sample {
+    std::string name;
+    std::vector<uint8_t> bytes;
+    bool valid = true;
+    double expectedSeconds = 0.0;
+    double tolerance = 1e-9;  // CBR 按码率推算，允许 0.5% 误差
+};
+
+void putBe32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    out[at] = static_cast<uint8_t>(value >> 24);
+    out[at + 1] = static_cast<uint8_t>(value >> 16);
+    out[at + 2] = static_cast<uint8_t>(value >> 8);
+    out[at + 3] = static_cast<uint8_t>(value);
+}
+
+void appendLe(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void appendText(std::vector<uint8_t>& out, const char* text) {
+    out.insert(out.end(), text, text + std::strlen(text));
+}
+
+std::vector<uint8_t> mp3Frame() {
+    std::vector<uint8_t> frame(kMp3FrameBytes, 0);
+    frame[0] = 0xFF;
+    frame[1] = 0xFB;
+    frame[2] = 0x90;
+    frame[3] = 0x00;
+    return frame;
+}
+
+enum class Mp3Tag { NONE, XING, VBRI };
+
+Sample makeMp3(const std::string& name, uint32_t frames, Mp3Tag tag, bool id3v2, bool id3v1) {
+    Sample sample;
+    sample.name = name;
+    auto& out = sample.bytes;
+    if (id3v2) {
+        // 4 KB ID3v2（模拟封面等大标签）
+        const uint32_t size = 4096;
+        appendText(out, "ID3");
+        out.insert(out.end(), {4, 0, 0, static_cast<uint8_t>((size >> 21) & 0x7F), static_cast<uint8_t>((size >> 14) & 0x7F),
+                               static_cast<uint8_t>((size >> 7) & 0x7F), static_cast<uint8_t>(size & 0x7F)});
+        out.resize(out.size() + size, 0);
+    }
+    if (tag == Mp3Tag::XING) {
+        auto frame = mp3Frame();
+        size_t at = 4 + 32;
+        std::memcpy(frame.data() + at, "Xing", 4);
+        putBe32(frame, at + 4, 0x0F);
+        putBe32(frame, at + 8, frames);
+        putBe32(frame, at + 12, frames * kMp3FrameBytes);
+        at += 16 + 100 + 4;
+        std::memcpy(frame.data() + at, "LAME3.100", 9);
+        frame[at + 21] = static_cast<uint8_t>(kLameDelay >> 4);
+        frame[at + 22] = static_cast<uint8_t>(((kLameDelay & 0x0F) << 4) | (kLamePadding >> 8));
+        frame[at + 23] = static_cast<uint8_t>(kLamePadding & 0xFF);
+        out.insert(out.end(), frame.begin(), frame.end());
+        sample.expectedSeconds =
+            static_cast<double>(frames * kMp3FrameSamples - kLameDelay - kLamePadding) / kMp3SampleRate;
+    } else if (tag == Mp3Tag::VBRI) {
+        auto frame = mp3Frame();
+        std::memcpy(frame.data() + 36, "VBRI", 4);
+        putBe32(frame, 36 + 10, frames * kMp3FrameBytes);
+        putBe32(frame, 36 + 14, frames);
+        out.insert(out.end(), frame.begin(), frame.end());
+        sample.expectedSeconds = static_cast<double>(frames) * kMp3FrameSamples / kMp3SampleRate;
+    } else {
+        sample.expectedSeconds = static_cast<double>(frames) * kMp3FrameSamples / kMp3SampleRate;
+        sample.tolerance = sample.expectedSeconds * 0.005;
+    }
+    auto frame = mp3Frame();
+    for (uint32_t i = 0; i < frames; ++i) {
+        out.insert(out.end(), frame.begin(), frame.end());
+    }
+    if (id3v1) {
+        std::vector<uint8_t> tag(128, ' ');
+        std::memcpy(tag.data(), "TAG", 3);
+        out.insert(out.end(), tag.begin(), tag.end());
+    }
+    return sample;
+}
+
+Sample makeWav(const std::string& name, uint32_t sampleRate, uint16_t channels, uint16_t bits, bool isFloat,
+               uint32_t frames, bool extensible, bool unknownSize) {
+    Sample sample;
+    sample.name = name;
+    auto& out = sample.bytes;
+    const uint16_t blockAlign = static_cast<uint16_t>(channels * bits / 8);
+    const uint32_t dataBytes = frames * blockAlign;
+    appendText(out, "RIFF");
+    appendLe(out, unknownSize ? 0xFFFFFFFFu : 4 + 8 + (extensible ? 40 : 16) + 8 + 26 + 8 + dataBytes, 4);
+    appendText(out, "WAVE");
+    appendText(out, "fmt ");
+    appendLe(out, extensible ? 40 : 16, 4);
+    appendLe(out, extensible ? 0xFFFE : (isFloat ? 3 : 1), 2);
+    appendLe(out, channels, 2);
+    appendLe(out, sampleRate, 4);
+    appendLe(out, sampleRate * blockAlign, 4);
+    appendLe(out, blockAlign, 2);
+    appendLe(out, bits, 2);
+    if (extensible) {
+        appendLe(out, 22, 2);
+        appendLe(out, bits, 2);
+        appendLe(out, 3, 4);  // 声道掩码
+        appendLe(out, isFloat ? 3 : 1, 2);
+        out.resize(out.size() + 14, 0);  // GUID 余下部分
+    }
+    // 中间夹一个奇数长度的 LIST 块，验证块对齐
+    appendText(out, "LIST");
+    appendLe(out, 25, 4);
+    out.resize(out.size() + 26, 0);
+    appendText(out, "data");
+    appendLe(out, unknownSize ? 0xFFFFFFFFu : dataBytes, 4);
+    out.resize(out.size() + dataBytes, 0);
+    sample.expectedSeconds = static_cast<double>(frames) / sampleRate;
+    return sample;
+}
+
+Sample makeInvalid(const std::string& name, std::vector<uint8_t> bytes) {
+    Sample sample;
+    sample.name = name;
+    sample.bytes = std::move(bytes);
+    sample.valid = false;
+    return sample;
+}
+
+std::vector<Sample> makeSamples() {
+    std::vector<Sample> samples;
+    for (uint32_t i = 0; i < 120; ++i) {
+        samples.push_back(makeMp3("cbr" + std::to_string(i) + ".mp3", 100 + i * 7, Mp3Tag::NONE, i % 3 == 0, i % 2 == 0));
+    }
+    for (uint32_t i = 0; i < 120; ++i) {
+        samples.push_back(makeMp3("xing" + std::to_string(i) + ".mp3", 100 + i * 5, Mp3Tag::XING, i % 2 == 0, i % 4 == 0));
+    }
+    for (uint32_t i = 0; i < 40; ++i) {
+        samples.push_back(makeMp3("vbri" + std::to_string(i) + ".mp3", 100 + i * 11, Mp3Tag::VBRI, false, false));
+    }
+    for (uint32_t i = 0; i < 120; ++i) {
+        switch (i % 4) {
+            case 0: samples.push_back(makeWav("pcm16_" + std::to_string(i) + ".wav", 44100, 2, 16, false, 22050 + i * 331, false, false)); break;
+            case 1: samples.push_back(makeWav("mono8_" + std::to_string(i) + ".wav", 16000, 1, 8, false, 8000 + i * 97, false, false)); break;
+            case 2: samples.push_back(makeWav("float_" + std::to_string(i) + ".wav", 48000, 2, 32, true, 24000 + i * 211, true, false)); break;
+            default: samples.push_back(makeWav("stream_" + std::to_string(i) + ".wav", 22050, 1, 16, false, 11025 + i * 53, false, true)); break;
+        }
+    }
+
+    std::vector<uint8_t> text(2000, 'a');
+    std::vector<uint8_t> zeros(65536, 0);
+    auto lonelySync = mp3Frame();  // 一个帧头之后全是 0：不构成连续帧
+    lonelySync.resize(100000, 0);
+    auto truncatedWav = makeWav("tmp", 44100, 2, 16, false, 100, false, false).bytes;
+    truncatedWav.resize(30);  // fmt 块被截断
+    std::vector<uint8_t> noData;
+    appendText(noData, "RIFF");
+    appendLe(noData, 28, 4);
+    appendText(noData, "WAVE");
+    appendText(noData, "JUNK");
+    appendLe(noData, 16, 4);
+    noData.resize(noData.size() + 16, 0);
+    std::vector<uint8_t> id3Only;
+    appendText(id3Only, "ID3");
+    id3Only.insert(id3Only.end(), {4, 0, 0, 0, 0, 1, 0});
+    id3Only.resize(id3Only.size() + 128, 0);
+    std::vector<uint8_t> ogg;
+    appendText(ogg, "OggS");
+    ogg.resize(4096, 0);
+    for (int i = 0; i < 10; ++i) {
+        samples.push_back(makeInvalid("notes" + std::to_string(i) + ".mp3", text));
+        samples.push_back(makeInvalid("zeros" + std::to_string(i) + ".mp3", zeros));
+        samples.push_back(makeInvalid("sync" + std::to_string(i) + ".mp3", lonelySync));
+        samples.push_back(makeInvalid("cut" + std::to_string(i) + ".wav", truncatedWav));
+        samples.push_back(makeInvalid("nodata" + std::to_string(i) + ".wav", noData));
+        samples.push_back(makeInvalid("id3only" + std::to_string(i) + ".mp3", id3Only));
+        samples.push_back(makeInvalid("vorbis" + std::to_string(i) + ".ogg", ogg));
+    }
+    return samples;
+}
+}  // namespace
+
+int benchAudioHeader() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-headers";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+
+    std::vector<Sample> samples = makeSamples();
+    uint64_t totalBytes = 0;
+    for (const auto& sample : samples) {
+        std::ofstream(dir / sample.name, std::ios::binary)
+            .write(reinterpret_cast<const char*>(sample.bytes.data()), static_cast<std::streamsize>(sample.bytes.size()));
+        totalBytes += sample.bytes.size();
+    }
+    std::printf("  %zu files, %.1f MB\n", samples.size(), totalBytes / (1024.0 * 1024.0));
+
+    // 整目录扫描：只读文件头（统计实际读取的字节数）
+    int failures = 0;
+    uint64_t headerBytes = 0;
+    size_t accepted = 0;
+    bench::Stopwatch watch;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::ifstream file(entry.path(), std::ios::binary);
+        auto readAt = [&](uint64_t offset, void* out, size_t size) -> size_t {
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(static_cast<char*>(out), static_cast<std::streamsize>(size));
+            headerBytes += static_cast<uint64_t>(file.gcount());
+            return static_cast<size_t>(file.gcount());
+        };
+        AudioFormatInfo info;
+        accepted += AudioHeaderParser::probe(readAt, entry.file_size(), info) ? 1 : 0;
+    }
+    double headerMs = watch.elapsedMs();
+
+    // 对照：整文件读入（相当于不解析头部、靠解码器/读全文件得时长的 I/O 量）
+    watch.reset();
+    uint64_t wholeBytes = 0;
+    std::vector<char> buffer;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::ifstream file(entry.path(), std::ios::binary);
+        buffer.resize(static_cast<size_t>(entry.file_size()));
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        wholeBytes += static_cast<uint64_t>(file.gcount());
+    }
+    double wholeMs = watch.elapsedMs();
+
+    std::printf("  %-28s %8.2f ms  %8.0f files/s  %9.1f KB read\n", "header scan", headerMs,
+                samples.size() / (headerMs / 1000.0), headerBytes / 1024.0);
+    std::printf("  %-28s %8.2f ms  %8.0f files/s  %9.1f KB read\n", "whole-file read", wholeMs,
+                samples.size() / (wholeMs / 1000.0), wholeBytes / 1024.0);
+
+    // 逐个校验
+    size_t expectedValid = 0;
+    for (const auto& sample : samples) {
+        AudioFormatInfo info;
+        std::string error;
+        bool ok = AudioHeaderParser::probeFile(dir / sample.name, info, &error);
+        expectedValid += sample.valid ? 1 : 0;
+        if (ok != sample.valid) {
+            std::printf("  [FAIL] %s: %s\n", sample.name.c_str(), ok ? "损坏/非音频文件未被拒绝" : error.c_str());
+            ++failures;
+        } else if (ok && std::fabs(info.durationSeconds - sample.expectedSeconds) > sample.tolerance) {
+            std::printf("  [FAIL] %s: 时长 %.6f s，应为 %.6f s\n", sample.name.c_str(), info.durationSeconds,
+                        sample.expectedSeconds);
+            ++failures;
+        }
+    }
+    if (accepted != expectedValid) {
+        std::printf("  [FAIL] 扫描接受 %zu 个，应为 %zu 个\n", accepted, expectedValid);
+        ++failures;
+    }
+
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -0,0 +1,278 @@
+// 音频打包文件基准：临时目录下约 500 个文件打包后的内容与零拷贝校验、按文件名查索引与
+// stat + 打开散文件的单次耗时对照、包外文件回退到散文件、损坏/截断的包被拒绝，
+// 以及散文件删除后 WAV 后端仍能从包中取时长、冷启动与预热起播。
+#include "AudioBundle.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t kFiles = 480;
+constexpr size_t kMinBytes = 4 << 10;
+constexpr size_t kMaxBytes = 96 << 10;
+constexpr size_t kLookupRounds = 20;
+constexpr size_t kOpenRounds = 2;
+constexpr uint32_t kRate = 44100;
+constexpr double kToneSeconds = 0.3;
+
+using bench::fail;
+
+std::vector<char> readAll(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// 打包内容与原文件逐字节一致，且 find() 返回的指针落在映射内（零拷贝）
+int checkContents(const std::filesystem::path& dir, const std::vector<std::string>& files,
+                  const AudioBundle& bundle) {
+    int failures = 0;
+    const char* base = bundle.find(files.front()).data - bundle.entries().front().offset;
+    bool zeroCopy = true;
+    bool equal = bundle.entries().size() == files.size();
+    for (const auto& file : files) {
+        AudioBytes bytes = bundle.find(file);
+        std::vector<char> original = readAll(dir / std::filesystem::u8path(file));
+        if (bytes.empty() || bytes.size != original.size() ||
+            std::memcmp(bytes.data, original.data(), original.size()) != 0) {
+            equal = false;
+        }
+        if (bytes.data < base || bytes.data + bytes.size > base + bundle.fileSize()) {
+            zeroCopy = false;
+        }
+    }
+    if (!equal) {
+        failures += fail("打包内容与原文件不一致");
+    }
+    if (!zeroCopy) {
+        failures += fail("find() 返回的字节不在映射内");
+    }
+    std::string backslash = files.back();
+    std::replace(backslash.begin(), backslash.end(), '/', '\\');
+    if (bundle.find(backslash).data != bundle.find(files.back()).data || !bundle.find("no-such.mp3").empty()) {
+        failures += fail("'\\\\' 分隔或不存在的文件名查找结果不对");
+    }
+    return failures;
+}
+
+// 按文件名取音频：索引二分查找 vs 散文件 stat + 打开
+void benchLookup(const std::filesystem::path& dir, const std::vector<std::string>& files,
+                 const AudioBundle& bundle) {
+    size_t found = 0;
+    bench::Stopwatch stopwatch;
+    for (size_t round = 0; round < kLookupRounds; ++round) {
+        for (const auto& file : files) {
+            found += bundle.find(file).empty() ? 0 : 1;
+        }
+    }
+    bench::report("bundle index lookup", stopwatch.elapsedMs(), kLookupRounds * files.size());
+
+    AudioLocation location;
+    stopwatch.reset();
+    for (size_t round = 0; round < kLookupRounds; ++round) {
+        for (const auto& file : files) {
+            found += AudioBundle::locate(file, location) ? 0 : 1;
+        }
+    }
+    bench::report("AudioBundle::locate (mounted)", stopwatch.elapsedMs(), kLookupRounds * files.size());
+
+    stopwatch.reset();
+    for (size_t round = 0; round < kOpenRounds; ++round) {
+        for (const auto& file : files) {
+            const std::filesystem::path path = dir / std::filesystem::u8path(file);
+            std::error_code ec;
+            if (std::filesystem::exists(path, ec)) {
+                std::ifstream in(path, std::ios::binary);
+                found += in ? 1 : 0;
+            }
+        }
+    }
+    bench::report("loose file exists + open", stopwatch.elapsedMs(), kOpenRounds * files.size());
+    (void)found;
+}
+
+// 魔数、截断、条目越界、索引乱序的包都应被拒绝
+int checkCorrupt(const std::filesystem::path& dir, const std::filesystem::path& good) {
+    int failures = 0;
+    const std::vector<char> original = readAll(good);
+    const std::filesystem::path path = dir / "corrupt.pak";
+    struct Case {
+        const char* label;
+        std::vector<char> bytes;
+    };
+    std::vector<Case> cases;
+    cases.push_back({"bad magic", original});
+    cases.back().bytes[0] = 'X';
+    cases.push_back({"bad version", original});
+    cases.back().bytes[8] = 9;
+    cases.push_back({"truncated header", std::vector<char>(original.begin(), original.begin() + 20)});
+    cases.push_back({"truncated data", std::vector<char>(original.begin(), original.end() - 1)});
+    cases.push_back({"index overflow", original});
+    cases.back().bytes[16] = static_cast<char>(0xFF);
+    cases.back().bytes[20] = static_cast<char>(0xFF);
+    cases.push_back({"unsorted index", original});
+    // 首条名称的首字节改大，与第二条不再有序
+    cases.back().bytes[32 + 18] = static_cast<char>(0x7F);
+    for (const auto& c : cases) {
+        bench::writeFile(path, c.bytes);
+        std::string error;
+        auto bundle = AudioBundle::open(path, &error);
+        std::printf("  %-18s -> %s\n", c.label, bundle ? "accepted" : error.c_str());
+        if (bundle) {
+            failures += fail("损坏的打包文件未被拒绝");
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return failures;
+}
+
+// 散文件删除后，时长（元数据缓存与直接探测）、冷启动与预热起播都从包中取；包外的文件照旧取散文件
+int checkPlayback(const std::filesystem::path& dir) {
+    namespace fs = std::filesystem;
+    int failures = 0;
+    bench::writeSine(dir / "tone_a.wav", kRate, kToneSeconds, 2, 0.1);
+    bench::writeSine(dir / "tone_b.wav", kRate, kToneSeconds, 2, 0.1);
+    std::string error;
+    if (!AudioBundle::pack(dir, {"tone_a.wav", "tone_b.wav"}, dir / AudioBundle::BUNDLE_FILENAME, error)) {
+        return fail("打包 WAV 失败");
+    }
+    std::error_code ec;
+    fs::remove(dir / "tone_a.wav", ec);
+    fs::remove(dir / "tone_b.wav", ec);
+    bench::writeSine(dir / "loose.wav", kRate, kToneSeconds, 2, 0.1);
+    PathUtil::setAudioDir(dir);
+    AudioBundle::remount();
+
+    AudioLocation bundled;
+    AudioLocation loose;
+    if (!AudioBundle::locate("tone_a.wav", bundled) || !bundled.inBundle() ||
+        !AudioBundle::locate("loose.wav", loose) || loose.inBundle() || AudioBundle::exists("missing.wav")) {
+        failures += fail("包内/散文件/缺失文件定位结果不对");
+    }
+
+    WavSinkOptions options;
+    options.path.clear();
+    options.sampleRate = kRate;
+    options.writeEventLog = false;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    if (!AudioPlayer::initialize()) {
+        PathUtil::setAudioDir({});
+        AudioPlayer::setBackend(nullptr);
+        AudioBundle::remount();
+        return failures + fail("WAV 后端初始化失败");
+    }
+
+    const double duration = AudioPlayer::getAudioDuration("tone_a.wav");
+    AudioPlayer::refreshMetadataAsync({"tone_a.wav", "tone_b.wav", "loose.wav"}, nullptr);
+    AudioPlayer::playAudioFile("tone_a.wav");
+    std::this_thread::sleep_for(std::chrono::duration<double>(kToneSeconds + 0.1));
+    AudioPlayer::prepareAudioFile("tone_b.wav");
+    AudioPlayer::playAudioFile("tone_b.wav");
+    const bool prepared = AudioPlayer::wasLastStartPrepared();
+    std::this_thread::sleep_for(std::chrono::duration<double>(kToneSeconds + 0.1));
+    AudioPlayer::playAudioFile("loose.wav");
+    std::this_thread::sleep_for(std::chrono::duration<double>(kToneSeconds + 0.1));
+    const double cached = AudioPlayer::getCachedDuration("tone_b.wav");
+    AudioPlayer::cleanup();
+
+    std::vector<WavSinkEvent> events = backend->getEvents();
+    std::printf("  duration from bundle %.3f s (cached %.3f s), %zu voices played, prepared start %s\n", duration,
+                cached, events.size(), prepared ? "yes" : "no");
+    if (std::fabs(duration - kToneSeconds) > 0.001 || std::fabs(cached - kToneSeconds) > 0.001) {
+        failures += fail("从打包文件取得的时长不对");
+    }
+    bool played = events.size() == 3 && prepared;
+    for (const auto& event : events) {
+        const double seconds = event.endSeconds - event.startSeconds;
+        played = played && event.finished && std::fabs(seconds - kToneSeconds) < 0.001;
+    }
+    if (!played) {
+        failures += fail("散文件删除后未能从打包文件起播");
+    }
+
+    PathUtil::setAudioDir({});
+    AudioPlayer::setBackend(nullptr);
+    AudioBundle::remount();
+    return failures;
+}
+}  // namespace
+
+int benchBundle() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-bundle";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "listening");
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<size_t> sizes(kMinBytes, kMaxBytes);
+    std::vector<std::string> files;
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < kFiles; ++i) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "%s%04zu.mp3", i % 3 == 0 ? "listening/part" : "instr", i);
+        std::vector<char> bytes(sizes(rng));
+        for (auto& b : bytes) {
+            b = static_cast<char>(rng());
+        }
+        bench::writeFile(dir / fs::u8path(name), bytes);
+        files.push_back(name);
+        totalBytes += bytes.size();
+    }
+
+    int failures = 0;
+    const fs::path packPath = dir / AudioBundle::BUNDLE_FILENAME;
+    std::string error;
+    bench::Stopwatch stopwatch;
+    if (!AudioBundle::pack(dir, files, packPath, error)) {
+        std::printf("  %s\n", error.c_str());
+        fs::remove_all(dir, ec);
+        return fail("打包失败");
+    }
+    const double packMs = stopwatch.elapsedMs();
+    stopwatch.reset();
+    auto bundle = AudioBundle::open(packPath, &error);
+    const double openMs = stopwatch.elapsedMs();
+    if (!bundle) {
+        std::printf("  %s\n", error.c_str());
+        fs::remove_all(dir, ec);
+        return fail("打开打包文件失败");
+    }
+    std::printf("  packed %zu files / %.1f MB in %.1f ms, open + index check %.3f ms\n", files.size(),
+                totalBytes / (1024.0 * 1024.0), packMs, openMs);
+    std::sort(files.begin(), files.end());
+    failures += checkContents(dir, files, *bundle);
+    if (AudioBundle::pack(dir, {files[0], files[0]}, dir / "dup.pak", error) ||
+        AudioBundle::pack(dir, {"no-such.mp3"}, dir / "missing.pak", error)) {
+        failures += fail("重名或缺失的文件未导致打包失败");
+    }
+
+    // 挂载后的 locate 不再访问文件系统
+    PathUtil::setAudioDir(dir);
+    AudioBundle::remount();
+    benchLookup(dir, files, *bundle);
+    PathUtil::setAudioDir({});
+    AudioBundle::remount();
+
+    failures += checkCorrupt(dir, packPath);
+    bundle.reset();
+
+    fs::path playDir = dir / "play";
+    fs::create_directories(playDir);
+    failures += checkPlayback(playDir);
+
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -0,0 +1,393 @@
+// 接续指令基准：
+//  1) 配置解析：after:偏移 记为接续指令并排在所接指令之后，所接偏移处没有指令的退回按时刻播放；
+//  2) 会话语义（虚拟时钟 + 替身输出端）：所接指令播完即接上（长于过期阈值也不过期）、
+//     所接指令播放失败时立即起播、所接指令过期/被停止/被新指令打断时一并跳过；
+//  3) 实时：PlaybackEngine 接 AudioPlayer + WavSinkBackend，两段恒定电平的片段首尾相接，
+//     从输出 WAV 逐采样量出交接间隙；对照不支持预约、只靠播完通知唤醒后再起播的输出端。
+// 实时部分约 2 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "ConfigManager.h"
+#include "ExamSession.h"
+#include "PathUtil.h"
+#include "PlaybackEngine.h"
+#include "RecordingAudioSink.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+// 两段片段的帧数都不是块长的整数倍，交接点落在块中间
+constexpr size_t kFirstFrames = 13331;
+constexpr size_t kSecondFrames = 8821;
+constexpr float kFirstLevel = 0.25f;
+constexpr float kSecondLevel = 0.5f;
+// 预约接续的交接间隙上限：混音器在同一块内换源，应为 0
+constexpr double kMaxArmedGapMs = 1.0;
+
+using bench::fail;
+
+// 32 位 float 立体声 WAV，恒定电平（输出中按电平区分两段，按零值量间隙）
+void writeLevelWav(const std::filesystem::path& path, size_t frames, float level) {
+    bench::writeWav(path, kRate, 2, std::vector<float>(frames * 2, level));
+}
+
+int checkConfig(const std::filesystem::path& dir) {
+    const std::filesystem::path path = dir / "chain.ini";
+    std::ofstream(path, std::ios::binary) << "[测试]\nduration=10\n"
+                                             "after:0=听力|tl.wav\n"
+                                             "0=开始考试|ks.wav\n"
+                                             "after: 0=听力第二节|tl2.wav\n"
+                                             "60=结束前|jsq.wav\n"
+                                             "after:30=无所接|x.wav\n";
+    auto& configManager = ConfigManager::getInstance();
+    if (!configManager.loadConfig(PathUtil::toWide(path))) {
+        return fail("接续指令配置加载失败");
+    }
+    auto templates = configManager.getInstructionTemplates("测试");
+    std::printf("  config: %zu instructions,", templates.size());
+    for (const auto& instruction : templates) {
+        std::printf(" %s%lld=%s", instruction.chained ? "after:" : "",
+                    static_cast<long long>(instruction.offsetMilliseconds / 1000), instruction.name.c_str());
+    }
+    std::printf("\n");
+    const bool ordered = templates.size() == 5 && templates[0].name == "开始考试" && !templates[0].chained &&
+                         templates[1].name == "听力" && templates[1].chained &&
+                         templates[2].name == "听力第二节" && templates[2].chained &&
+                         templates[3].name == "无所接" && !templates[3].chained &&
+                         templates[3].offsetMilliseconds == 30000 && templates[4].name == "结束前";
+    return ordered ? 0 : fail("接续指令解析、排序或无所接时的回退不符");
+}
+
+// ---- 会话语义：虚拟时钟逐事件推进，完成检测在输出端报告的结束时刻当即进行 ----
+
+struct EventLog : ExamSessionListener {
+    std::vector<SessionEvent> events;
+    void onSessionEvent(const SessionEvent& event) override { events.push_back(event); }
+    int count(SessionEventType type, int index) const {
+        return static_cast<int>(std::count_if(events.begin(), events.end(), [&](const SessionEvent& event) {
+            return event.type == type && event.index == index;
+        }));
+    }
+};
+
+struct Scenario {
+    VirtualClock clock;
+    RecordingAudioSink sink;
+    ExamSession session;
+    EventLog log;
+    system_clock::time_point base;
+
+    explicit Scenario(system_clock::time_point start) : clock(start), sink(clock), session(clock, sink), base(start) {
+        session.setListener(&log);
+    }
+
+    void add(const char* name, const char* file, seconds offset, bool chained) {
+        Instruction instruction;
+        instruction.subjectId = 1;
+        instruction.subjectName = "英语";
+        instruction.name = name;
+        instruction.audioFile = file;
+        instruction.playTime = base + offset;
+        instruction.chained = chained;
+        m_pending.push_back(instruction);
+    }
+
+    void load() { session.addInstructions(m_pending); }
+
+    void runUntil(system_clock::time_point end) {
+        session.checkPlaybackCompletion();
+        session.updateNextInstruction();
+        for (int step = 0; step < 1000; ++step) {
+            auto next = std::min(session.getNextDueTime(), sink.getPlaybackEndTime());
+            if (next == system_clock::time_point::max() || next > end) {
+                break;
+            }
+            clock.set(std::max(next, clock.now()));
+            session.checkPlaybackCompletion();
+            session.updateNextInstruction();
+        }
+        clock.set(std::max(end, clock.now()));
+    }
+
+    // 按文件名取第一条播放记录
+    const RecordingAudioSink::PlayRecord* record(const std::string& filename) const {
+        for (const auto& record : sink.getRecords()) {
+            if (record.filename == filename) {
+                return &record;
+            }
+        }
+        return nullptr;
+    }
+
+    double offsetSeconds(system_clock::time_point time) const {
+        return duration<double>(time - base).count();
+    }
+
+private:
+    std::vector<Instruction> m_pending;
+};
+
+int checkSession(system_clock::time_point start) {
+    int failures = 0;
+
+    // 所接指令 90 秒（长于过期阈值）：两条接续依次在前一条结束时刻接上
+    {
+        Scenario s(start);
+        s.sink.setDurationSeconds("long.mp3", 90.0);
+        s.sink.setDurationSeconds("c1.mp3", 5.0);
+        s.sink.setDurationSeconds("c2.mp3", 3.0);
+        s.add("听力", "long.mp3", seconds(0), false);
+        s.add("第二节", "c1.mp3", seconds(0), true);
+        s.add("第三节", "c2.mp3", seconds(0), true);
+        s.load();
+        s.runUntil(start + seconds(200));
+        auto* c1 = s.record("c1.mp3");
+        auto* c2 = s.record("c2.mp3");
+        const bool ok = c1 && c2 && c1->joined && c2->joined && s.offsetSeconds(c1->startTime) == 90.0 &&
+                        s.offsetSeconds(c2->startTime) == 95.0 && s.log.count(SessionEventType::EXPIRED, 1) == 0;
+        std::printf("  session: 90 s predecessor -> followers at %+.3f s / %+.3f s (joined %d/%d)\n",
+                    c1 ? s.offsetSeconds(c1->startTime) : -1.0, c2 ? s.offsetSeconds(c2->startTime) : -1.0,
+                    c1 && c1->joined ? 1 : 0, c2 && c2->joined ? 1 : 0);
+        failures += ok ? 0 : fail("接续指令未在所接指令结束时刻接上");
+    }
+
+    // 所接指令文件缺失：接续指令立即起播
+    {
+        Scenario s(start);
+        s.sink.setMissing("bad.mp3");
+        s.add("听力", "bad.mp3", seconds(10), false);
+        s.add("第二节", "c1.mp3", seconds(10), true);
+        s.load();
+        s.runUntil(start + seconds(60));
+        auto* c1 = s.record("c1.mp3");
+        const bool ok = s.log.count(SessionEventType::PLAY_FAILED, 0) == 1 && c1 && s.offsetSeconds(c1->startTime) == 10.0;
+        std::printf("  session: failed predecessor -> follower at %+.3f s\n", c1 ? s.offsetSeconds(c1->startTime) : -1.0);
+        failures += ok ? 0 : fail("所接指令播放失败时接续指令未立即起播");
+    }
+
+    // 启动时所接指令已过期：接续指令一并过期
+    {
+        Scenario s(start - seconds(120));
+        s.add("听力", "long.mp3", seconds(0), false);
+        s.add("第二节", "c1.mp3", seconds(0), true);
+        s.add("第三节", "c2.mp3", seconds(0), true);
+        s.add("结束前", "end.mp3", seconds(300), false);
+        s.clock.set(start);
+        s.load();
+        s.runUntil(start + seconds(400));
+        const bool ok = s.log.count(SessionEventType::EXPIRED, 0) == 1 && s.log.count(SessionEventType::EXPIRED, 1) == 1 &&
+                        s.log.count(SessionEventType::EXPIRED, 2) == 1 && !s.record("c1.mp3") && s.record("end.mp3");
+        std::printf("  session: expired predecessor -> followers expired %d/2, later instruction played %d\n",
+                    s.log.count(SessionEventType::EXPIRED, 1) + s.log.count(SessionEventType::EXPIRED, 2),
+                    s.record("end.mp3") ? 1 : 0);
+        failures += ok ? 0 : fail("所接指令过期时接续指令未一并过期");
+    }
+
+    // 所接指令播放中被停止：接续指令跳过
+    {
+        Scenario s(start);
+        s.sink.setDurationSeconds("long.mp3", 90.0);
+        s.add("听力", "long.mp3", seconds(0), false);
+        s.add("第二节", "c1.mp3", seconds(0), true);
+        s.load();
+        s.runUntil(start + seconds(10));
+        s.session.stopPlayback();
+        s.sink.stop();
+        s.runUntil(start + seconds(200));
+        const bool ok = s.log.count(SessionEventType::SKIPPED, 1) == 1 && !s.record("c1.mp3");
+        std::printf("  session: stopped predecessor -> follower skipped %d\n", s.log.count(SessionEventType::SKIPPED, 1));
+        failures += ok ? 0 : fail("所接指令被停止时接续指令未跳过");
+    }
+
+    // 混音输出下所接指令被到点的新指令打断：接续指令跳过，新指令照常
+    {
+        Scenario s(start);
+        s.sink.setOverlap(true);
+        s.sink.setDurationSeconds("long.mp3", 90.0);
+        s.add("听力", "long.mp3", seconds(0), false);
+        s.add("第二节", "c1.mp3", seconds(0), true);
+        s.add("结束前", "end.mp3", seconds(30), false);
+        s.load();
+        s.runUntil(start + seconds(200));
+        auto* end = s.record("end.mp3");
+        const bool ok = s.log.count(SessionEventType::SKIPPED, 1) == 1 && !s.record("c1.mp3") && end &&
+                        s.offsetSeconds(end->startTime) == 30.0;
+        std::printf("  session: interrupted predecessor -> follower skipped %d, interrupting instruction at %+.3f s\n",
+                    s.log.count(SessionEventType::SKIPPED, 1), end ? s.offsetSeconds(end->startTime) : -1.0);
+        failures += ok ? 0 : fail("所接指令被打断时接续指令未跳过");
+    }
+    return failures;
+}
+
+// ---- 实时：播放线程 + 混音器 + WAV 后端 ----
+
+// 不支持预约的输出端：只转发，接续指令要等播完通知唤醒播放线程后再起播
+class NoQueueSink : public AudioSink {
+public:
+    bool prepare(const std::string& filename) override { return m_inner.prepare(filename); }
+    bool play(const std::string& filename) override { return m_inner.play(filename); }
+    bool isPlaying() override { return m_inner.isPlaying(); }
+    void stop() override { m_inner.stop(); }
+    double getCurrentStreamDuration() override { return m_inner.getCurrentStreamDuration(); }
+    void setEndNotify(std::function<void()> notify) override { m_inner.setEndNotify(std::move(notify)); }
+    bool supportsOverlap() const override { return m_inner.supportsOverlap(); }
+    bool measuresOnset() const override { return m_inner.measuresOnset(); }
+    bool getOnsetDelayMs(double& delayMs) override { return m_inner.getOnsetDelayMs(delayMs); }
+    void recordOnsetMeasurement() override { m_inner.recordOnsetMeasurement(); }
+
+private:
+    AudioPlayerSink m_inner;
+};
+
+struct Handoff {
+    bool ok = false;
+    size_t firstFrames = 0;   // 第一段出声的帧数
+    int64_t gapFrames = -1;   // 第一段最后一帧之后到第二段首帧之间的静音帧
+    size_t secondFrames = 0;
+    double wakeMs = 0.0;      // 第一段结束到播放线程处理完成（事件发布）的耗时
+};
+
+// 输出中找出两段电平：第一段 kFirstLevel，之后第一个 kSecondLevel 即第二段
+Handoff measureOutput(const std::filesystem::path& path) {
+    Handoff handoff;
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    AudioFormatInfo info;
+    if (!AudioHeaderParser::probeMemory(wav.data(), wav.size(), info) || info.dataOffset >= wav.size()) {
+        return handoff;
+    }
+    const size_t frames = (wav.size() - info.dataOffset) / (2 * sizeof(float));
+    auto level = [&](size_t frame) {
+        float sample = 0.0f;
+        std::memcpy(&sample, wav.data() + info.dataOffset + frame * 2 * sizeof(float), sizeof(sample));
+        return sample;
+    };
+    auto is = [](float sample, float target) { return std::fabs(sample - target) < 1e-4f; };
+    size_t i = 0;
+    while (i < frames && !is(level(i), kFirstLevel)) {
+        ++i;
+    }
+    const size_t firstStart = i;
+    while (i < frames && is(level(i), kFirstLevel)) {
+        ++i;
+    }
+    handoff.firstFrames = i - firstStart;
+    const size_t firstEnd = i;
+    while (i < frames && !is(level(i), kSecondLevel)) {
+        ++i;
+    }
+    const size_t secondStart = i;
+    while (i < frames && is(level(i), kSecondLevel)) {
+        ++i;
+    }
+    handoff.secondFrames = i - secondStart;
+    handoff.gapFrames = static_cast<int64_t>(secondStart - firstEnd);
+    handoff.ok = handoff.firstFrames > 0 && handoff.secondFrames > 0;
+    return handoff;
+}
+
+Handoff runRealtime(const std::filesystem::path& output, AudioSink& sink) {
+    WavSinkOptions options;
+    options.path = output;
+    options.sampleRate = kRate;
+    options.writeEventLog = false;
+    AudioPlayer::setBackend(std::make_unique<WavSinkBackend>(options));
+    AudioPlayer::setTrimLeadingSilence(false);
+    if (!AudioPlayer::initialize()) {
+        AudioPlayer::setBackend(nullptr);
+        return Handoff();
+    }
+
+    PlaybackEngine engine(Clock::system(), sink);
+    engine.start();
+    const auto base = time_point_cast<milliseconds>(system_clock::now()) + milliseconds(150);
+    std::vector<Instruction> instructions(2);
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        instructions[i].subjectId = 1;
+        instructions[i].subjectName = "英语";
+        instructions[i].name = i == 0 ? "听力" : "第二节";
+        instructions[i].audioFile = i == 0 ? "first.wav" : "second.wav";
+        instructions[i].playTime = base;
+        instructions[i].chained = i == 1;
+    }
+    engine.addInstructions(instructions);
+
+    // 播放线程一播完即被唤醒：第二段在第一段结束后立即发布 PLAYED 事件
+    const double firstSeconds = static_cast<double>(kFirstFrames) / kRate;
+    const double total = firstSeconds + static_cast<double>(kSecondFrames) / kRate;
+    system_clock::time_point secondPlayed;
+    const auto deadline = steady_clock::now() + milliseconds(150) + duration_cast<milliseconds>(duration<double>(total)) +
+                          milliseconds(300);
+    while (steady_clock::now() < deadline) {
+        engine.drainEvents([&](EngineEvent& event) {
+            if (event.hasSessionEvent && event.sessionEvent.type == SessionEventType::PLAYED &&
+                event.sessionEvent.index == 1) {
+                secondPlayed = system_clock::now();
+            }
+        });
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    engine.stop();
+    AudioPlayer::cleanup();
+    AudioPlayer::setBackend(nullptr);
+
+    Handoff handoff = measureOutput(output);
+    if (secondPlayed != system_clock::time_point()) {
+        handoff.wakeMs = duration<double, std::milli>(secondPlayed - (base + duration_cast<system_clock::duration>(
+                                                                              duration<double>(firstSeconds))))
+                             .count();
+    }
+    return handoff;
+}
+
+void print(const char* label, const Handoff& handoff) {
+    std::printf("  %-28s first %zu frames, second %zu frames, gap %lld frames (%.3f ms), follower dispatched %+.1f ms\n",
+                label, handoff.firstFrames, handoff.secondFrames, static_cast<long long>(handoff.gapFrames),
+                handoff.gapFrames * 1000.0 / kRate, handoff.wakeMs);
+}
+}  // namespace
+
+int benchChain() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-chain";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    writeLevelWav(dir / "first.wav", kFirstFrames, kFirstLevel);
+    writeLevelWav(dir / "second.wav", kSecondFrames, kSecondLevel);
+    PathUtil::setAudioDir(dir);
+
+    int failures = checkConfig(dir);
+    failures += checkSession(time_point_cast<seconds>(system_clock::now()));
+
+    AudioPlayerSink armedSink;
+    Handoff armed = runRealtime(dir / "armed.wav", armedSink);
+    NoQueueSink wakeSink;
+    Handoff woken = runRealtime(dir / "woken.wav", wakeSink);
+    print("queued (sample-exact):", armed);
+    print("end-notify wake only:", woken);
+    if (!armed.ok || armed.firstFrames != kFirstFrames || armed.secondFrames != kSecondFrames) {
+        failures += fail("预约接续的输出与两段片段不符");
+    } else if (armed.gapFrames * 1000.0 / kRate > kMaxArmedGapMs) {
+        failures += fail("预约接续的交接间隙过大");
+    }
+    // 不预约时间隙约为混音输出的排队量；超过完成检测周期说明播完通知没有唤醒播放线程
+    if (!woken.ok || woken.gapFrames * 1000.0 / kRate >= PlaybackEngine::COMPLETION_POLL.count()) {
+        failures += fail("播完通知未唤醒播放线程");
+    }
+
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
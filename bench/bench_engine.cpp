@@ -0,0 +1,231 @@
+// 播放线程基准：界面线程被阻塞（列表重建、模态对话框）跨过指令到点时刻，
+// 对比原做法（调度线程 PostMessage，界面线程上做播放决策）与专用播放线程的起播迟到量。
+// 实时运行（系统时钟 + 替身输出端），每种做法约 0.5 秒。
+#include "BenchUtil.h"
+#include "PlaybackEngine.h"
+#include "RecordingAudioSink.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr milliseconds kBlock{400};                       // 界面线程阻塞时长
+constexpr int kOffsetsMs[] = {100, 160, 220, 280};        // 相对起点的指令时刻（均落在阻塞期内）
+constexpr double kClipSeconds = 0.03;
+constexpr double kMaxEngineLatenessMs = 50.0;
+
+std::vector<Instruction> makeInstructions(system_clock::time_point base) {
+    std::vector<Instruction> instructions;
+    for (size_t i = 0; i < std::size(kOffsetsMs); ++i) {
+        Instruction instruction;
+        instruction.subjectId = 1;
+        instruction.subjectName = "英语";
+        instruction.name = "指令" + std::to_string(i + 1);
+        instruction.audioFile = "clip" + std::to_string(i + 1) + ".mp3";
+        instruction.playTime = base + milliseconds(kOffsetsMs[i]);
+        instructions.push_back(instruction);
+    }
+    return instructions;
+}
+
+struct Lateness {
+    size_t played = 0;
+    double avgMs = 0.0;
+    double maxMs = 0.0;
+};
+
+Lateness measure(const RecordingAudioSink& sink, system_clock::time_point base) {
+    Lateness result;
+    double total = 0.0;
+    for (const auto& record : sink.getRecords()) {
+        for (size_t i = 0; i < std::size(kOffsetsMs); ++i) {
+            if (record.filename != "clip" + std::to_string(i + 1) + ".mp3") {
+                continue;
+            }
+            double late = duration<double, std::milli>(
+                record.startTime - (base + milliseconds(kOffsetsMs[i]))).count();
+            total += late;
+            result.maxMs = std::max(result.maxMs, late);
+            ++result.played;
+        }
+    }
+    result.avgMs = result.played > 0 ? total / result.played : 0.0;
+    return result;
+}
+
+void print(const char* label, const Lateness& lateness) {
+    std::printf("  %-40s played %zu/%zu  avg %8.2f ms  max %8.2f ms\n", label, lateness.played,
+                std::size(kOffsetsMs), lateness.avgMs, lateness.maxMs);
+}
+
+// 原做法的调度线程：睡到布防时刻只投递一次“到点”（WM_INSTRUCTION_DUE），触发后撤防
+class DueThread {
+public:
+    explicit DueThread(std::function<void(int)> onDue) : m_onDue(std::move(onDue)), m_thread([this] { run(); }) {}
+    ~DueThread() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    void arm(int index, system_clock::time_point due) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_armed && m_index == index && m_due == due) {
+            return;
+        }
+        m_armed = true;
+        m_index = index;
+        m_due = due;
+        m_cv.notify_one();
+    }
+    void disarm() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_armed = false;
+        m_cv.notify_one();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_running) {
+            if (!m_armed) {
+                m_cv.wait(lock);
+                continue;
+            }
+            const auto remaining = m_due - system_clock::now();
+            if (remaining > system_clock::duration::zero()) {
+                m_cv.wait_for(lock, duration_cast<steady_clock::duration>(remaining));
+                continue;
+            }
+            m_armed = false;
+            const int index = m_index;
+            lock.unlock();
+            m_onDue(index);
+            lock.lock();
+        }
+    }
+
+    std::function<void(int)> m_onDue;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_running = true;
+    bool m_armed = false;
+    int m_index = -1;
+    system_clock::time_point m_due;
+    std::thread m_thread;  // 最后构造：启动时其余成员已就绪
+};
+
+// 原做法：调度线程只投递“到点”消息，播放决策排在界面消息队列里
+Lateness runUiThreadDriven() {
+    RecordingAudioSink sink(Clock::system());
+    sink.setDefaultDurationSeconds(kClipSeconds);
+    sink.setOverlap(true);  // 与正式的混音输出端一致：到点即播
+    ExamSession session(Clock::system(), sink);
+    const auto base = time_point_cast<milliseconds>(system_clock::now());
+    session.addInstructions(makeInstructions(base));
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<int> messages;  // 模拟界面消息队列（WM_INSTRUCTION_DUE）
+    DueThread scheduler([&](int index) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back(index);
+        }
+        cv.notify_one();
+    });
+
+    auto arm = [&] {
+        int next = session.getNextInstructionIndex();
+        if (next >= 0) {
+            scheduler.arm(next, session.getInstructions().playTime(next));
+        } else {
+            scheduler.disarm();
+        }
+    };
+    arm();
+
+    // 界面线程：先被一次长操作占住，之后才处理积压的消息
+    std::this_thread::sleep_until(steady_clock::now() + kBlock);
+    const auto end = base + kBlock + milliseconds(200);
+    while (system_clock::now() < end) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, milliseconds(5), [&] { return !messages.empty(); });
+        messages.clear();
+        lock.unlock();
+        session.checkPlaybackCompletion();
+        session.updateNextInstruction();
+        arm();
+    }
+    return measure(sink, base);
+}
+
+// 专用播放线程：界面线程同样被占住，事件在阻塞结束后才取
+Lateness runPlaybackEngine(int& failures) {
+    RecordingAudioSink sink(Clock::system());
+    sink.setDefaultDurationSeconds(kClipSeconds);
+    sink.setOverlap(true);  // 与正式的混音输出端一致：到点即播
+    PlaybackEngine engine(Clock::system(), sink);
+    std::atomic<int> notifications{0};
+    engine.setNotify([&] { notifications.fetch_add(1, std::memory_order_relaxed); });
+    engine.start();
+
+    const auto base = time_point_cast<milliseconds>(system_clock::now());
+    engine.addInstructions(makeInstructions(base));
+
+    std::this_thread::sleep_until(steady_clock::now() + kBlock);
+    std::this_thread::sleep_for(milliseconds(100));
+
+    // 阻塞结束：一次取走积压事件，最终快照应为全部已播完
+    size_t played = 0;
+    std::shared_ptr<const SessionView> view;
+    size_t drained = engine.drainEvents([&](EngineEvent& event) {
+        if (event.hasSessionEvent && event.sessionEvent.type == SessionEventType::PLAYED) {
+            ++played;
+        }
+        view = event.view;
+    });
+    engine.stop();
+
+    EngineStats stats = engine.getStats();
+    std::printf("  engine: %zu events drained after %d notifications, %llu wakeups, %llu dropped\n",
+                drained, notifications.load(), static_cast<unsigned long long>(stats.wakeups),
+                static_cast<unsigned long long>(stats.eventsDropped));
+    if (played != std::size(kOffsetsMs) || !view || view->instructions.size() != std::size(kOffsetsMs) ||
+        view->findNextUnplayedInstruction() >= 0) {
+        std::printf("  [FAIL] 事件/快照与播放记录不一致\n");
+        ++failures;
+    }
+    return measure(sink, base);
+}
+}  // namespace
+
+int benchEngine() {
+    int failures = 0;
+    std::printf("  UI thread blocked for %lld ms; %zu instructions due at +%d..+%d ms\n",
+                static_cast<long long>(kBlock.count()), std::size(kOffsetsMs), kOffsetsMs[0],
+                kOffsetsMs[std::size(kOffsetsMs) - 1]);
+
+    Lateness legacy = runUiThreadDriven();
+    print("UI-thread decisions (PostMessage)", legacy);
+
+    Lateness engine = runPlaybackEngine(failures);
+    print("dedicated playback thread", engine);
+
+    if (engine.played != std::size(kOffsetsMs) || engine.maxMs > kMaxEngineLatenessMs) {
+        std::printf("  [FAIL] 播放线程起播迟到超过 %.0f ms\n", kMaxEngineLatenessMs);
+        ++failures;
+    }
+    return failures;
+}
@@ -0,0 +1,430 @@
+// 多设备扇出基准：
+//  1) 虚拟时钟下驱动 FanOutOutput（三台设备延迟与时钟偏差各不相同），按混音器的补写方式运行 10 分钟，
+//     每秒一个单帧脉冲，逐个比较各设备上实际出声的时刻：起播对齐、漂移追平、渲染卡顿后的重新对齐、
+//     写入失败/不再取数据的设备被放弃而其余设备不受影响；
+//  2) AudioPlayer 接多设备 WavSinkBackend 实时播放，从各设备的 WAV 与设备时钟折算出声时刻校验对齐，
+//     并校验 setOutputDevices 的选择与重开。实时部分约 4 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "FanOutOutput.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr size_t kBlockFrames = 441;
+constexpr size_t kTargetFrames = kBlockFrames * 4;
+constexpr size_t kTolerance = 2;
+constexpr double kStepSeconds = 0.002;  // 虚拟渲染循环的步长（混音器约半块睡眠一次）
+constexpr uint64_t kPulseOffset = 300;  // 脉冲在每秒中的位置（不落在块首，避免被追平丢帧吃掉）
+// 各设备出声时刻之差的上限：容差 + 测量滞后的一两个窗（100ms）内累积的漂移，留出余量。
+// 实时运行时各设备的排队量不是同一瞬间读到的，再放宽一倍
+constexpr double kMaxSkewFrames = 11.0;          // 约 0.25ms
+constexpr double kMaxRealtimeSkewFrames = 22.0;  // 约 0.5ms
+constexpr double kMaxStartSkewFrames = kTolerance;  // 设备延迟取整到帧 + 首个脉冲前的漂移
+
+using bench::fail;
+
+// 虚拟时钟下的一台设备：按自身时钟消耗已写入的帧（欠载时补静音），
+// 记录每个脉冲帧被播出的虚拟时刻（含设备延迟）
+class VirtualDevice : public MixerOutput {
+public:
+    VirtualDevice(double clockPpm, double latencyMs)
+        : m_clockRate(kRate * (1.0 + clockPpm * 1e-6)), m_latency(latencyMs / 1000.0) {}
+
+    size_t latencyFrames() const { return static_cast<size_t>(m_latency * kRate + 0.5); }
+
+    void advance(double now, double seconds) {
+        if (m_stalled) {
+            return;
+        }
+        m_played += seconds * m_clockRate;
+        while (!m_pending.empty() && static_cast<double>(m_pending.front()) < m_played) {
+            // 脉冲帧被播到的时刻：本步末尾往回折算
+            heard.push_back(now + seconds - (m_played - m_pending.front()) / m_clockRate + m_latency);
+            m_pending.pop_front();
+        }
+    }
+
+    size_t queuedFrames() override {
+        const auto consumed = static_cast<uint64_t>(m_played);
+        if (consumed > m_written) {
+            padded += consumed - m_written;
+            m_written = consumed;
+        }
+        return static_cast<size_t>(m_written - consumed);
+    }
+
+    bool write(const float* samples, size_t frames) override {
+        if (m_failing) {
+            return false;
+        }
+        for (size_t i = 0; i < frames; ++i) {
+            if (samples[i * 2] > 0.5f) {
+                m_pending.push_back(m_written + i);
+            }
+        }
+        m_written += frames;
+        return true;
+    }
+
+    void setStalled(bool stalled) { m_stalled = stalled; }
+    void setFailing(bool failing) { m_failing = failing; }
+
+    std::vector<double> heard;
+    uint64_t padded = 0;
+
+private:
+    const double m_clockRate;
+    const double m_latency;
+    double m_played = 0.0;
+    uint64_t m_written = 0;
+    std::deque<uint64_t> m_pending;
+    bool m_stalled = false;
+    bool m_failing = false;
+};
+
+struct DeviceSpec {
+    const char* name;
+    double clockPpm;
+    double latencyMs;
+};
+
+// 按混音器的方式驱动扇出：每步先让设备走，再补写到目标排队量。
+// event(now, devices) 每步调用一次，返回 false 时本步不渲染（模拟渲染线程卡顿）
+std::vector<OutputDeviceStats> simulate(std::vector<VirtualDevice>& devices, const std::vector<DeviceSpec>& specs,
+                                        double seconds,
+                                        const std::function<bool(double, std::vector<VirtualDevice>&)>& event) {
+    std::vector<FanOutDevice> fanOutDevices;
+    for (size_t i = 0; i < devices.size(); ++i) {
+        fanOutDevices.push_back({specs[i].name, &devices[i], devices[i].latencyFrames()});
+    }
+    FanOutOutput fanOut(std::move(fanOutDevices), kRate, kTolerance);
+    std::vector<float> block(kBlockFrames * 2);
+    uint64_t mixPosition = 0;
+    const auto steps = static_cast<uint64_t>(seconds / kStepSeconds);
+    for (uint64_t step = 0; step < steps; ++step) {
+        const double now = step * kStepSeconds;
+        for (auto& device : devices) {
+            device.advance(now, kStepSeconds);
+        }
+        if (!event(now, devices)) {
+            continue;
+        }
+        // 每步最多补一个目标排队量（写入一直失败时混音器会空转，这里不模拟）
+        for (size_t rendered = 0; rendered < kTargetFrames && fanOut.queuedFrames() < kTargetFrames;
+             rendered += kBlockFrames) {
+            std::fill(block.begin(), block.end(), 0.0f);
+            for (size_t i = 0; i < kBlockFrames; ++i) {
+                if ((mixPosition + i) % kRate == kPulseOffset) {
+                    block[i * 2] = block[i * 2 + 1] = 1.0f;
+                }
+            }
+            fanOut.write(block.data(), kBlockFrames);
+            mixPosition += kBlockFrames;
+        }
+    }
+    return fanOut.getStats();
+}
+
+// 第 pulse 个脉冲在 indices 各设备上出声时刻之差（帧）。有设备没听到返回 -1
+double pulseSkew(const std::vector<VirtualDevice>& devices, const std::vector<size_t>& indices, size_t pulse) {
+    double earliest = 1e300;
+    double latest = -1e300;
+    for (size_t index : indices) {
+        if (pulse >= devices[index].heard.size()) {
+            return -1.0;
+        }
+        earliest = std::min(earliest, devices[index].heard[pulse]);
+        latest = std::max(latest, devices[index].heard[pulse]);
+    }
+    return (latest - earliest) * kRate;
+}
+
+void printStats(const std::vector<OutputDeviceStats>& stats) {
+    for (const auto& device : stats) {
+        std::printf("    %-10s latency %5zu, compensation %5zu, max skew %6lld, dropped %6llu, failed writes %llu%s\n",
+                    device.name.c_str(), device.latencyFrames, device.compensationFrames,
+                    static_cast<long long>(device.maxSkewFrames), static_cast<unsigned long long>(device.droppedFrames),
+                    static_cast<unsigned long long>(device.failedWrites), device.lost ? ", lost" : "");
+    }
+}
+
+const std::vector<DeviceSpec> kSpecs = {{"hall", 0.0, 0.0}, {"usb", 300.0, 15.0}, {"hdmi", -250.0, 42.0}};
+
+std::vector<VirtualDevice> makeDevices(const std::vector<DeviceSpec>& specs) {
+    std::vector<VirtualDevice> devices;
+    for (const auto& spec : specs) {
+        devices.emplace_back(spec.clockPpm, spec.latencyMs);
+    }
+    return devices;
+}
+
+// 长时间运行：起播对齐与漂移追平
+int checkDrift() {
+    constexpr double kSeconds = 600.0;
+    auto devices = makeDevices(kSpecs);
+    bench::Stopwatch stopwatch;
+    auto stats = simulate(devices, kSpecs, kSeconds, [](double, std::vector<VirtualDevice>&) { return true; });
+    const double ms = stopwatch.elapsedMs();
+
+    int failures = 0;
+    const size_t pulses = static_cast<size_t>(kSeconds) - 1;
+    double startSkew = pulseSkew(devices, {0, 1, 2}, 0);
+    double maxSkew = 0.0;
+    double sumSkew = 0.0;
+    for (size_t pulse = 0; pulse < pulses; ++pulse) {
+        double skew = pulseSkew(devices, {0, 1, 2}, pulse);
+        if (skew < 0.0) {
+            return fail("有设备漏播脉冲");
+        }
+        maxSkew = std::max(maxSkew, skew);
+        sumSkew += skew;
+    }
+    const double uncorrectedMs = (kSpecs[1].clockPpm - kSpecs[2].clockPpm) * 1e-6 * kSeconds * 1000.0;
+    std::printf("  drift: %.0f s simulated in %.1f ms, %zu pulses, start skew %.2f frames, "
+                "max %.2f / mean %.2f frames (uncorrected drift would reach %.0f ms)\n",
+                kSeconds, ms, pulses, startSkew, maxSkew, sumSkew / pulses, uncorrectedMs);
+    printStats(stats);
+    if (startSkew > kMaxStartSkewFrames) {
+        failures += fail("起播未按采样对齐");
+    }
+    if (maxSkew > kMaxSkewFrames) {
+        failures += fail("时钟漂移未被追平");
+    }
+    // 时钟最快的 usb 是基准，只有较慢的设备丢帧；起播补偿补在延迟较小的设备上
+    if (stats[1].droppedFrames != 0 || stats[0].droppedFrames == 0 || stats[2].droppedFrames == 0 ||
+        stats[0].compensationFrames != 1852 || stats[2].compensationFrames != 0) {
+        failures += fail("补偿或丢帧落在了错误的设备上");
+    }
+    for (const auto& device : devices) {
+        if (device.padded > kTargetFrames) {
+            failures += fail("运行中设备欠载");
+            break;
+        }
+    }
+    return failures;
+}
+
+// 渲染线程卡顿 60ms：延迟最大（排队最少）的设备先欠载，恢复后应在 1 秒内重新对齐
+int checkUnderrun() {
+    auto devices = makeDevices(kSpecs);
+    auto stats = simulate(devices, kSpecs, 10.0, [](double now, std::vector<VirtualDevice>&) {
+        return now < 5.0 || now >= 5.06;
+    });
+    int failures = 0;
+    const double during = pulseSkew(devices, {0, 1, 2}, 5);
+    const double after = pulseSkew(devices, {0, 1, 2}, 6);
+    double worstAfter = 0.0;
+    for (size_t pulse = 6; pulse < 9; ++pulse) {
+        worstAfter = std::max(worstAfter, pulseSkew(devices, {0, 1, 2}, pulse));
+    }
+    std::printf("  render stall 60 ms at 5 s: pulse at 5 s skew %.1f frames, at 6 s %.2f frames, "
+                "worst after %.2f frames\n", during, after, worstAfter);
+    printStats(stats);
+    if (devices[2].padded <= devices[0].padded) {
+        failures += fail("卡顿未造成欠载，场景无效");
+    }
+    if (after < 0.0 || worstAfter > kMaxSkewFrames) {
+        failures += fail("欠载后未重新对齐");
+    }
+    return failures;
+}
+
+// 设备失效：hdmi 自 2 秒起写入失败，usb 自 3 秒起不再取数据，hall 自 8 秒起也写入失败（最后一台不放弃）
+int checkLost() {
+    auto devices = makeDevices(kSpecs);
+    auto stats = simulate(devices, kSpecs, 10.0, [](double now, std::vector<VirtualDevice>& all) {
+        all[2].setFailing(now >= 2.0);
+        all[1].setStalled(now >= 3.0);
+        all[0].setFailing(now >= 8.0);
+        return true;
+    });
+    int failures = 0;
+    // hall 上的脉冲间隔应始终是一秒整，只差向 usb 追平漂移丢的帧（失效设备不拖累其余设备）
+    const double driftPerSecond = (kSpecs[1].clockPpm - kSpecs[0].clockPpm) * 1e-6 * kRate;
+    double worstGap = 0.0;
+    for (size_t pulse = 1; pulse < 8 && pulse < devices[0].heard.size(); ++pulse) {
+        const double interval = (devices[0].heard[pulse] - devices[0].heard[pulse - 1]) * kRate;
+        worstGap = std::max(worstGap, std::fabs(interval - kRate));
+    }
+    std::printf("  lost devices: hall heard %zu pulses, worst interval error %.2f frames\n", devices[0].heard.size(),
+                worstGap);
+    printStats(stats);
+    if (!stats[2].lost || stats[2].failedWrites == 0 || !stats[1].lost || stats[0].lost) {
+        failures += fail("失效设备未被放弃，或最后一台设备被放弃");
+    }
+    if (devices[0].heard.size() < 8 || worstGap > driftPerSecond + kMaxSkewFrames) {
+        failures += fail("失效设备影响了其余设备的播放");
+    }
+    return failures;
+}
+
+// 16 位立体声 WAV：从峰值起音的 -6 dBFS 方波，首个采样即可听
+void writeClick(const std::filesystem::path& path, double seconds) {
+    const size_t frames = static_cast<size_t>(seconds * kRate);
+    std::vector<int16_t> samples;
+    samples.reserve(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        const int16_t sample = (i / 50) % 2 == 0 ? 16384 : -16384;
+        samples.insert(samples.end(), 2, sample);
+    }
+    bench::writeWav(path, kRate, 2, samples);
+}
+
+// 输出 WAV 中各段声音的首帧（之前至少 minGap 帧静音）
+std::vector<uint64_t> onsets(const std::filesystem::path& path, uint64_t minGap) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    AudioFormatInfo info;
+    std::vector<uint64_t> result;
+    if (!AudioHeaderParser::probeMemory(wav.data(), wav.size(), info)) {
+        return result;
+    }
+    const uint64_t frames = (wav.size() - info.dataOffset) / (2 * sizeof(float));
+    uint64_t silent = minGap;
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        float sample;
+        std::memcpy(&sample, wav.data() + info.dataOffset + frame * 2 * sizeof(float), sizeof(sample));
+        if (std::fabs(sample) > 0.1f) {
+            if (silent >= minGap) {
+                result.push_back(frame);
+            }
+            silent = 0;
+        } else {
+            ++silent;
+        }
+    }
+    return result;
+}
+
+// 第 play 次播放在 indices 各设备上出声时刻之差（帧）。有设备缺这次播放返回 -1
+double playSkew(const WavSinkBackend& backend, const std::vector<std::vector<uint64_t>>& found,
+                const std::vector<size_t>& indices, size_t play) {
+    steady_clock::time_point earliest = steady_clock::time_point::max();
+    steady_clock::time_point latest = steady_clock::time_point::min();
+    for (size_t index : indices) {
+        if (play >= found[index].size()) {
+            return -1.0;
+        }
+        auto heard = backend.getDeviceFrameTime(index, found[index][play]);
+        earliest = std::min(earliest, heard);
+        latest = std::max(latest, heard);
+    }
+    return duration<double>(latest - earliest).count() * kRate;
+}
+
+// 实时：AudioPlayer 接三台模拟设备
+int checkRealtime() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-fanout";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    writeClick(dir / "click.wav", 0.1);
+    PathUtil::setAudioDir(dir);
+
+    WavSinkOptions options;
+    options.sampleRate = kRate;
+    for (const auto& spec : kSpecs) {
+        options.devices.push_back({spec.name, dir / (std::string(spec.name) + ".wav"), spec.latencyMs, spec.clockPpm});
+    }
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+
+    int failures = 0;
+    constexpr int kPlays = 4;
+    if (!AudioPlayer::initialize() || backend->getDevices().size() != kSpecs.size()) {
+        AudioPlayer::setBackend(nullptr);
+        PathUtil::setAudioDir({});
+        return fail("多设备 WAV 后端初始化失败");
+    }
+    for (int i = 0; i < kPlays; ++i) {
+        std::this_thread::sleep_for(milliseconds(i == 0 ? 100 : 700));
+        AudioPlayer::playAudioFile("click.wav");
+    }
+    std::this_thread::sleep_for(milliseconds(300));
+    auto stats = AudioPlayer::getOutputDeviceStats();
+    AudioPlayer::cleanup();
+
+    std::vector<std::vector<uint64_t>> found;
+    for (const auto& device : backend->getDevices()) {
+        found.push_back(onsets(device.path, kRate / 10));
+    }
+    double maxSkew = 0.0;
+    for (size_t play = 0; play < kPlays; ++play) {
+        double skew = playSkew(*backend, found, {0, 1, 2}, play);
+        if (skew < 0.0) {
+            maxSkew = 1e9;
+            break;
+        }
+        maxSkew = std::max(maxSkew, skew);
+    }
+    std::printf("  realtime, 3 WAV devices: %d plays, max skew %.2f frames (%.3f ms)\n", kPlays, maxSkew,
+                maxSkew * 1000.0 / kRate);
+    printStats(stats);
+    if (stats.size() != kSpecs.size() || maxSkew > kMaxRealtimeSkewFrames) {
+        failures += fail("实时多设备起播未对齐");
+    }
+
+    // 按编号与名称片段选两台；运行中改选不存在的设备，重开后退回第一台（单设备，不经扇出）
+    AudioPlayer::setOutputDevices({"2", "hdm"});
+    bool selected = AudioPlayer::initialize() && backend->getDevices().size() == 2 &&
+                    backend->getDevices()[0].name == "usb" && backend->getDevices()[1].name == "hdmi";
+    std::this_thread::sleep_for(milliseconds(100));
+    AudioPlayer::playAudioFile("click.wav");
+    std::this_thread::sleep_for(milliseconds(300));
+    AudioPlayer::setOutputDevices({"missing"});
+    const bool fallback = backend->getDevices().size() == 1 && backend->getDevices()[0].name == "hall" &&
+                          AudioPlayer::getOutputDeviceStats().empty();
+    AudioPlayer::cleanup();
+    AudioPlayer::setOutputDevices({});
+
+    // getDeviceFrameTime 按当前打开的设备折算，这里按两台设备自身的参数换算
+    std::vector<std::vector<uint64_t>> pair = {onsets(dir / "usb.wav", kRate / 10),
+                                               onsets(dir / "hdmi.wav", kRate / 10)};
+    double pairSkew = -1.0;
+    if (pair[0].size() == 1 && pair[1].size() == 1) {
+        // 两台设备同时打开，起点相差不到一帧；按各自时钟与延迟折算
+        const double usb = pair[0][0] / (kRate * (1.0 + kSpecs[1].clockPpm * 1e-6)) + kSpecs[1].latencyMs / 1000.0;
+        const double hdmi = pair[1][0] / (kRate * (1.0 + kSpecs[2].clockPpm * 1e-6)) + kSpecs[2].latencyMs / 1000.0;
+        pairSkew = std::fabs(usb - hdmi) * kRate;
+    }
+    std::printf("  selection \"2|hdm\": %s, skew %.2f frames; unknown selection falls back to first device: %s\n",
+                selected ? "usb+hdmi" : "wrong", pairSkew, fallback ? "yes" : "no");
+    if (!selected || pairSkew < 0.0 || pairSkew > kMaxRealtimeSkewFrames) {
+        failures += fail("按编号/名称选择设备后未对齐");
+    }
+    if (!fallback) {
+        failures += fail("选择不存在的设备时未退回第一台");
+    }
+
+    AudioPlayer::setBackend(nullptr);
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
+}  // namespace
+
+int benchFanOut() {
+    int failures = 0;
+    failures += checkDrift();
+    failures += checkUnderrun();
+    failures += checkLost();
+    failures += checkRealtime();
+    return failures;
+}
@@ -0,0 +1,252 @@
+// 指令表扫描基准：行式 std::vector<Instruction>（现行做法）对比列式 InstructionTable。
+// 覆盖每秒/每次操作都会全表遍历的四个热路径，规模从 kMaxInstructionsTotal 到其 100 倍。
+// 附带毫秒偏移的端到端校验：带小数的偏移经配置解析、列式表与会话（虚拟时钟）后按计划时刻起播。
+#include "BenchUtil.h"
+#include "Clock.h"
+#include "ConfigManager.h"
+#include "ExamSession.h"
+#include "InstructionTable.h"
+#include "RecordingAudioSink.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr int kRepeats = 200;
+const char* const kAudioFiles[] = {
+    "1kq12.mp3", "2kq10.mp3", "3kq5.mp3", "4ksks.mp3", "5jsq15.mp3", "6ksjs.mp3", "sy.mp3", "tl.mp3",
+};
+const char* const kNames[] = {"考前12分钟", "考前10分钟", "考前5分钟", "开始考试", "结束前15分钟", "考试结束"};
+const char* const kSubjects[] = {"语文", "数学", "英语", "首选科目", "再选合堂"};
+
+// 毫秒偏移：配置写法与应解析出的毫秒数（超出毫秒的小数位截断）
+struct OffsetCase {
+    const char* text;
+    int milliseconds;
+};
+const OffsetCase kOffsetCases[] = {
+    {"0.001", 1}, {"20.500", 20500}, {"61.0019", 61001}, {"1234.5", 1234500}, {"7199.999", 7199999},
+    {"59999", 59999000},
+};
+// 虚拟时钟下起播时刻与计划时刻之差的上限（与 evcs-sim --max-onset-error-ms 1 同一门限）
+constexpr double kMaxOnsetErrorMs = 1.0;
+
+int64_t toMilliseconds(system_clock::time_point timePoint) {
+    return duration_cast<milliseconds>(timePoint.time_since_epoch()).count();
+}
+
+// 前一半已播放（过去），后一半未播放（未来）；now 位于两者之间
+std::vector<Instruction> makeInstructions(size_t count, system_clock::time_point now) {
+    std::vector<Instruction> instructions(count);
+    for (size_t i = 0; i < count; ++i) {
+        Instruction& instruction = instructions[i];
+        instruction.subjectId = static_cast<int>(i / 8);
+        instruction.subjectName = kSubjects[(i / 8) % 5];
+        instruction.name = kNames[i % 6];
+        instruction.audioFile = kAudioFiles[i % 8];
+        instruction.playTime = now + seconds(static_cast<int64_t>(i) - static_cast<int64_t>(count / 2));
+        instruction.status = i < count / 2 ? PlaybackStatus::PLAYED : PlaybackStatus::UNPLAYED;
+    }
+    return instructions;
+}
+
+int runSize(size_t count) {
+    const auto now = system_clock::time_point(seconds(1800000000));
+    const int64_t nowMilliseconds = toMilliseconds(now);
+    const int64_t window = 60000;
+    auto rows = makeInstructions(count, now);
+    InstructionTable table;
+    table.append(rows);
+    const size_t ops = count * kRepeats;
+    size_t rowResult = 0;
+    size_t tableResult = 0;
+    char label[64];
+
+    std::printf("  -- %zu instructions\n", count);
+
+    // 1) 找下一条未播放：最坏情况为只剩最后一条
+    for (size_t i = 0; i + 1 < count; ++i) {
+        rows[i].status = PlaybackStatus::PLAYED;
+        table.setStatus(i, PlaybackStatus::PLAYED);
+    }
+    bench::Stopwatch watch;
+    for (int r = 0; r < kRepeats; ++r) {
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (rows[i].status == PlaybackStatus::UNPLAYED) {
+                rowResult += i;
+                break;
+            }
+        }
+    }
+    double rowMs = watch.elapsedMs();
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        tableResult += static_cast<size_t>(table.findFirst(PlaybackStatus::UNPLAYED));
+    }
+    double tableMs = watch.elapsedMs();
+    bench::report("rows  find next unplayed (per row)", rowMs, ops);
+    std::snprintf(label, sizeof(label), "table find next unplayed (%.1fx)", rowMs / tableMs);
+    bench::report(label, tableMs, ops);
+    if (rowResult != tableResult) {
+        std::printf("  [FAIL] find next unplayed mismatch\n");
+        return 1;
+    }
+
+    // 2) 过期清扫：恢复前一半已播放/后一半未来，每秒一次且通常无命中
+    for (size_t i = 0; i < count; ++i) {
+        PlaybackStatus status = i < count / 2 ? PlaybackStatus::PLAYED : PlaybackStatus::UNPLAYED;
+        rows[i].status = status;
+        table.setStatus(i, status);
+    }
+    rowResult = tableResult = 0;
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        for (auto& instruction : rows) {
+            if (instruction.status == PlaybackStatus::UNPLAYED) {
+                auto instructionTimestamp = toMilliseconds(instruction.playTime);
+                if (instructionTimestamp < nowMilliseconds && (nowMilliseconds - instructionTimestamp) > window) {
+                    instruction.status = PlaybackStatus::SKIPPED;
+                    ++rowResult;
+                }
+            }
+        }
+    }
+    rowMs = watch.elapsedMs();
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        tableResult += table.skipExpired(nowMilliseconds, window, nullptr);
+    }
+    tableMs = watch.elapsedMs();
+    bench::report("rows  expiry sweep (per row)", rowMs, ops);
+    std::snprintf(label, sizeof(label), "table expiry sweep (%.1fx)", rowMs / tableMs);
+    bench::report(label, tableMs, ops);
+    if (rowResult != tableResult) {
+        std::printf("  [FAIL] expiry sweep mismatch\n");
+        return 1;
+    }
+
+    // 3) 手动播放最后一条：跳过前序（前序均已处理，只剩扫描成本）
+    rowResult = tableResult = 0;
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        for (size_t i = 0; i < count / 2; ++i) {
+            if (rows[i].status == PlaybackStatus::UNPLAYED) {
+                rows[i].status = PlaybackStatus::SKIPPED;
+                ++rowResult;
+            }
+        }
+    }
+    rowMs = watch.elapsedMs();
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        tableResult += table.skipUnplayedBefore(count / 2, nullptr);
+    }
+    tableMs = watch.elapsedMs();
+    bench::report("rows  skip previous (per row)", rowMs, count / 2 * kRepeats);
+    std::snprintf(label, sizeof(label), "table skip previous (%.1fx)", rowMs / tableMs);
+    bench::report(label, tableMs, count / 2 * kRepeats);
+    if (rowResult != tableResult) {
+        std::printf("  [FAIL] skip previous mismatch\n");
+        return 1;
+    }
+
+    // 4) 缺失文件计数：以集合查找代替 filesystem::exists，统计探测次数
+    const std::set<std::string> present = {"1kq12.mp3", "2kq10.mp3", "3kq5.mp3", "4ksks.mp3", "6ksjs.mp3"};
+    size_t rowProbes = 0;
+    size_t tableProbes = 0;
+    rowResult = tableResult = 0;
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        for (const auto& instruction : rows) {
+            ++rowProbes;
+            rowResult += present.count(instruction.audioFile) ? 0 : 1;
+        }
+    }
+    rowMs = watch.elapsedMs();
+    watch.reset();
+    for (int r = 0; r < kRepeats; ++r) {
+        tableResult += table.countMissingAudio([&](const std::string& audioFile) {
+            ++tableProbes;
+            return present.count(audioFile) > 0;
+        });
+    }
+    tableMs = watch.elapsedMs();
+    bench::report("rows  missing audio count (per row)", rowMs, ops);
+    std::snprintf(label, sizeof(label), "table missing audio count (%.1fx)", rowMs / tableMs);
+    bench::report(label, tableMs, ops);
+    std::printf("  probes: rows=%zu table=%zu\n", rowProbes / kRepeats, tableProbes / kRepeats);
+    if (rowResult != tableResult) {
+        std::printf("  [FAIL] missing audio count mismatch\n");
+        return 1;
+    }
+    return 0;
+}
+// 毫秒偏移端到端：解析 → 计划时刻 → 列式表 → 会话按虚拟时钟逐个到点起播，量起播误差
+int checkMillisecondOffsets() {
+    const auto start = system_clock::time_point(seconds(1800000000));
+    VirtualClock clock(start - seconds(1));
+    RecordingAudioSink sink(clock);
+    ExamSession session(clock, sink);
+    std::vector<Instruction> instructions;
+    for (const OffsetCase& offsetCase : kOffsetCases) {
+        int offsetMilliseconds = 0;
+        if (!ConfigManager::parseOffsetMilliseconds(offsetCase.text, offsetMilliseconds) ||
+            offsetMilliseconds != offsetCase.milliseconds) {
+            std::printf("  [FAIL] offset \"%s\" parsed as %d ms, expected %d ms\n", offsetCase.text,
+                        offsetMilliseconds, offsetCase.milliseconds);
+            return 1;
+        }
+        Instruction instruction;
+        instruction.subjectId = 1;
+        instruction.subjectName = "英语";
+        instruction.name = offsetCase.text;
+        instruction.audioFile = std::string("offset") + std::to_string(instructions.size()) + ".mp3";
+        instruction.playTime = start + milliseconds(offsetMilliseconds);
+        sink.setDurationSeconds(instruction.audioFile, 0.25);
+        instructions.push_back(instruction);
+    }
+    session.addInstructions(instructions);
+
+    // 与播放线程相同：只在会话报告的下一到点时刻（或当前一路结束时刻）驱动
+    const auto end = start + milliseconds(kOffsetCases[std::size(kOffsetCases) - 1].milliseconds) + seconds(1);
+    session.updateNextInstruction();
+    for (int step = 0; step < 1000; ++step) {
+        auto next = std::min(session.getNextDueTime(), sink.getPlaybackEndTime());
+        if (next == system_clock::time_point::max() || next > end) {
+            break;
+        }
+        clock.set(std::max(next, clock.now()));
+        session.checkPlaybackCompletion();
+        session.updateNextInstruction();
+    }
+
+    const auto& records = sink.getRecords();
+    double maxErrorMs = 0.0;
+    bool complete = records.size() == instructions.size();
+    for (size_t i = 0; complete && i < records.size(); ++i) {
+        complete = records[i].filename == instructions[i].audioFile;
+        maxErrorMs = std::max(maxErrorMs, std::fabs(duration<double, std::milli>(
+                                              records[i].startTime - instructions[i].playTime).count()));
+    }
+    std::printf("  ms offsets: %zu/%zu played (0.001 .. 59999 s), max onset error %.3f ms\n", records.size(),
+                instructions.size(), maxErrorMs);
+    if (!complete || maxErrorMs > kMaxOnsetErrorMs) {
+        std::printf("  [FAIL] millisecond offsets not played at their planned time\n");
+        return 1;
+    }
+    return 0;
+}
+}  // namespace
+
+int benchInstructionTable() {
+    const size_t limit = ConfigManager::kMaxInstructionsTotal;
+    int failures = checkMillisecondOffsets();
+    for (size_t count : {limit, limit * 10, limit * 100}) {
+        failures += runSize(count);
+    }
+    return failures;
+}
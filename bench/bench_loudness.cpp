@@ -0,0 +1,359 @@
+// 响度分析基准：EBU R128 积分响度的参考信号校验（正弦电平、门限、静音/过短），
+// 标量/SSE2/AVX2 内核结果一致性与吞吐（文件/秒、倍实时），
+// 以及经 AudioPlayer（WAV 后端）后台分析 -> 元数据缓存 -> 起播增益 -> 输出电平的整条路径。
+// 吞吐部分约 1 秒，整条路径实时播放约 2 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "LoudnessMeter.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kThroughputFiles = 48;
+constexpr double kThroughputSeconds = 10.0;
+constexpr int kPipelineFiles = 16;
+constexpr double kPipelineSeconds = 4.0;
+constexpr double kTargetLufs = -20.0;
+
+using bench::fail;
+
+// 交错立体声：两声道相同的 1kHz 正弦，振幅 amplitude
+void appendSine(std::vector<float>& out, double amplitude, double seconds, double frequency = 1000.0) {
+    const size_t frames = static_cast<size_t>(seconds * kRate);
+    const size_t start = out.size() / 2;
+    for (size_t i = 0; i < frames; ++i) {
+        float value = static_cast<float>(amplitude * std::sin(2.0 * kPi * frequency * (start + i) / kRate));
+        out.push_back(value);
+        out.push_back(value);
+    }
+}
+
+double dbToAmplitude(double db) {
+    return std::pow(10.0, db / 20.0);
+}
+
+// 近似语音的测试节目：几个频率的正弦加噪声，按音节起伏，左右声道略有差异
+std::vector<float> makeProgram(std::mt19937& rng, double level, double seconds) {
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    const size_t frames = static_cast<size_t>(seconds * kRate);
+    std::vector<float> out(frames * 2);
+    const double base = 120.0 + 200.0 * (rng() % 100) / 100.0;
+    for (size_t i = 0; i < frames; ++i) {
+        double t = static_cast<double>(i) / kRate;
+        double envelope = 0.5 + 0.5 * std::sin(2.0 * kPi * 3.0 * t);
+        double voice = 0.5 * std::sin(2.0 * kPi * base * t) + 0.3 * std::sin(2.0 * kPi * base * 2.7 * t) +
+                       0.2 * std::sin(2.0 * kPi * 2500.0 * t);
+        out[i * 2] = static_cast<float>(level * envelope * (voice + 0.1 * noise(rng)));
+        out[i * 2 + 1] = static_cast<float>(level * envelope * (0.9 * voice + 0.1 * noise(rng)));
+    }
+    return out;
+}
+
+bool measure(const std::vector<float>& samples, SimdLevel kernel, LoudnessResult& result) {
+    LoudnessMeter meter(kRate, kernel);
+    // 按解码源的读取粒度分段喂入
+    for (size_t offset = 0; offset < samples.size(); offset += 16384 * 2) {
+        size_t count = std::min<size_t>(16384 * 2, samples.size() - offset);
+        meter.add(samples.data() + offset, count / 2);
+    }
+    return meter.finish(result);
+}
+
+std::vector<SimdLevel> supportedKernels() {
+    std::vector<SimdLevel> kernels;
+    for (SimdLevel kernel : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (CpuFeatures::supports(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+// 参考信号：EBU Tech 3341 的电平与门限用例（时长按比例缩短）
+int checkReference() {
+    int failures = 0;
+    struct Case {
+        const char* name;
+        std::vector<float> samples;
+        double expected;
+    };
+    std::vector<Case> cases;
+    {
+        Case c{"1kHz -23 dBFS 20s", {}, -23.0};
+        appendSine(c.samples, dbToAmplitude(-23.0), 20.0);
+        cases.push_back(std::move(c));
+    }
+    {
+        Case c{"1kHz -33 dBFS 20s", {}, -33.0};
+        appendSine(c.samples, dbToAmplitude(-33.0), 20.0);
+        cases.push_back(std::move(c));
+    }
+    {
+        // -36/-23/-36：首尾低于相对门限，不计入
+        Case c{"-36/-23/-36 dBFS 5/30/5s", {}, -23.0};
+        appendSine(c.samples, dbToAmplitude(-36.0), 5.0);
+        appendSine(c.samples, dbToAmplitude(-23.0), 30.0);
+        appendSine(c.samples, dbToAmplitude(-36.0), 5.0);
+        cases.push_back(std::move(c));
+    }
+    {
+        // 长静音：低于绝对门限，不拉低结果
+        Case c{"-23 dBFS 10s + silence 20s", {}, -23.0};
+        appendSine(c.samples, dbToAmplitude(-23.0), 10.0);
+        c.samples.resize(c.samples.size() + static_cast<size_t>(20.0 * kRate) * 2, 0.0f);
+        cases.push_back(std::move(c));
+    }
+    for (const auto& c : cases) {
+        for (SimdLevel kernel : supportedKernels()) {
+            LoudnessResult result;
+            bool ok = measure(c.samples, kernel, result);
+            if (kernel == SimdLevel::SCALAR) {
+                std::printf("  %-28s %8.3f LUFS (期望 %.1f), %zu/%zu 块通过门限\n", c.name, result.integratedLufs,
+                            c.expected, result.gatedBlocks, result.blocks);
+            }
+            if (!ok || std::fabs(result.integratedLufs - c.expected) > 0.1) {
+                std::printf("  [FAIL] %s (%s): %.3f LUFS\n", c.name, CpuFeatures::name(kernel),
+                            result.integratedLufs);
+                ++failures;
+            }
+        }
+    }
+
+    std::vector<float> silence(static_cast<size_t>(5.0 * kRate) * 2, 0.0f);
+    std::vector<float> shortClip;
+    appendSine(shortClip, 0.5, 0.3);
+    LoudnessResult result;
+    if (measure(silence, CpuFeatures::best(), result) ||
+        measure(shortClip, CpuFeatures::best(), result)) {
+        failures += fail("静音与不足 400ms 的片段应无法测量");
+    }
+
+    // 增益：提升受 12 dB 与峰值 -1 dBFS 约束，衰减不受限
+    float boost = LoudnessMeter::normalizationGain(-40.0, 0.05, kTargetLufs);
+    float peakLimited = LoudnessMeter::normalizationGain(-30.0, 0.5, kTargetLufs);
+    float cut = LoudnessMeter::normalizationGain(-10.0, 1.0, kTargetLufs);
+    if (std::fabs(20.0 * std::log10(boost) - 12.0) > 0.01 ||
+        std::fabs(peakLimited * 0.5 - dbToAmplitude(-1.0)) > 1e-4 ||
+        std::fabs(20.0 * std::log10(cut) + 10.0) > 0.01) {
+        failures += fail("归一化增益的上限/峰值约束不符");
+    }
+    return failures;
+}
+
+// 各内核对同一批节目：结果一致，吞吐按文件/秒与倍实时
+int checkKernels() {
+    int failures = 0;
+    std::mt19937 rng(20240607);
+    std::vector<std::vector<float>> programs;
+    for (int i = 0; i < kThroughputFiles; ++i) {
+        double level = dbToAmplitude(-30.0 + 20.0 * (i % 8) / 7.0);
+        programs.push_back(makeProgram(rng, level, kThroughputSeconds));
+    }
+
+    std::vector<LoudnessResult> reference;
+    double scalarMs = 0.0;
+    for (SimdLevel kernel : supportedKernels()) {
+        std::vector<LoudnessResult> results(programs.size());
+        bench::Stopwatch stopwatch;
+        for (size_t i = 0; i < programs.size(); ++i) {
+            measure(programs[i], kernel, results[i]);
+        }
+        double elapsedMs = stopwatch.elapsedMs();
+        if (kernel == SimdLevel::SCALAR) {
+            scalarMs = elapsedMs;
+        }
+        char label[64];
+        std::snprintf(label, sizeof(label), "analyze %d x %.0fs (%s)", kThroughputFiles, kThroughputSeconds,
+                      CpuFeatures::name(kernel));
+        bench::report(label, elapsedMs, programs.size());
+        std::printf("  %-40s %10.1f files/s  %8.0fx realtime  %5.2fx vs scalar\n", "",
+                    programs.size() * 1000.0 / elapsedMs, kThroughputFiles * kThroughputSeconds * 1000.0 / elapsedMs,
+                    scalarMs / elapsedMs);
+
+        if (reference.empty()) {
+            reference = results;
+            continue;
+        }
+        double maxDiff = 0.0;
+        bool peaksEqual = true;
+        for (size_t i = 0; i < results.size(); ++i) {
+            maxDiff = std::max(maxDiff, std::fabs(results[i].integratedLufs - reference[i].integratedLufs));
+            peaksEqual = peaksEqual && results[i].samplePeak == reference[i].samplePeak;
+        }
+        if (maxDiff > 0.001 || !peaksEqual) {
+            std::printf("  [FAIL] %s 与标量结果不一致：最大差 %.6f LU\n", CpuFeatures::name(kernel), maxDiff);
+            ++failures;
+        }
+    }
+    std::printf("  best kernel on this CPU: %s\n", CpuFeatures::name(CpuFeatures::best()));
+    return failures;
+}
+
+// 16 位立体声 WAV
+void writeWav(const std::filesystem::path& path, const std::vector<float>& samples) {
+    std::vector<int16_t> pcm(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        pcm[i] = static_cast<int16_t>(std::lround(samples[i] * 32767.0f));
+    }
+    bench::writeWav(path, kRate, 2, pcm);
+}
+
+// 输出 WAV（32 位 float 立体声）中 [from, to) 帧的峰值
+float peak(const std::vector<char>& wav, uint64_t dataOffset, uint64_t from, uint64_t to) {
+    float result = 0.0f;
+    for (uint64_t frame = from; frame < to; ++frame) {
+        uint64_t offset = dataOffset + frame * 2 * sizeof(float);
+        if (offset + 2 * sizeof(float) > wav.size()) {
+            break;
+        }
+        float samples[2];
+        std::memcpy(samples, wav.data() + offset, sizeof(samples));
+        result = std::max({result, std::fabs(samples[0]), std::fabs(samples[1])});
+    }
+    return result;
+}
+
+double refreshAndWait(std::vector<std::string> files) {
+    std::promise<void> analyzed;
+    auto done = analyzed.get_future();
+    bench::Stopwatch stopwatch;
+    AudioPlayer::refreshMetadataAsync(std::move(files), nullptr, [&analyzed] { analyzed.set_value(); });
+    done.wait();
+    return stopwatch.elapsedMs();
+}
+
+// 后台分析 -> 缓存 -> 起播增益 -> 输出电平
+int checkPipeline() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-loudness";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+
+    std::mt19937 rng(7);
+    std::vector<std::string> files;
+    for (int i = 0; i < kPipelineFiles; ++i) {
+        std::string name = "cmd" + std::to_string(i) + ".wav";
+        writeWav(dir / name, makeProgram(rng, dbToAmplitude(-30.0 + 2.0 * (i % 10)), kPipelineSeconds));
+        files.push_back(name);
+    }
+    // 起播校验用的两段正弦：-30 与 -14 LUFS，归一到 -20 后振幅都应为 0.1
+    std::vector<float> quiet;
+    std::vector<float> loud;
+    appendSine(quiet, dbToAmplitude(-30.0), 0.5);
+    appendSine(loud, dbToAmplitude(-14.0), 0.5);
+    writeWav(dir / "quiet.wav", quiet);
+    writeWav(dir / "loud.wav", loud);
+    files.push_back("quiet.wav");
+    files.push_back("loud.wav");
+    PathUtil::setAudioDir(dir);
+
+    WavSinkOptions options;
+    options.path = dir / "out.wav";
+    options.sampleRate = kRate;
+    options.writeEventLog = false;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    int failures = 0;
+    if (!AudioPlayer::initialize()) {
+        PathUtil::setAudioDir({});
+        AudioPlayer::setBackend(nullptr);
+        return fail("WAV 后端初始化失败");
+    }
+    AudioPlayer::setLoudnessTarget(kTargetLufs);
+
+    // 首次刷新分析全部文件，第二次文件未变化，只 stat
+    double coldMs = refreshAndWait(files);
+    double warmMs = refreshAndWait(files);
+    std::printf("  background analysis: %zu files (%.0fs audio) cold %.1f ms = %.1f files/s, warm %.2f ms\n",
+                files.size(), kPipelineFiles * kPipelineSeconds + 1.0, coldMs, files.size() * 1000.0 / coldMs,
+                warmMs);
+
+    std::string cache;
+    {
+        std::ifstream file(dir / AudioMetadataCache::CACHE_FILENAME, std::ios::binary);
+        cache.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    size_t measured = 0;
+    for (size_t pos = cache.find("\twav\t-"); pos != std::string::npos; pos = cache.find("\twav\t-", pos + 1)) {
+        if (pos + 6 < cache.size() && std::isdigit(static_cast<unsigned char>(cache[pos + 6]))) {
+            ++measured;  // 负的 LUFS 值（未分析记为 "-"）
+        }
+    }
+    if (cache.rfind("# EVCS audio metadata v3", 0) != 0 || measured != files.size()) {
+        failures += fail("缓存文件应记录每个文件的响度");
+    }
+    if (warmMs > coldMs / 4) {
+        failures += fail("文件未变化时不应重新分析");
+    }
+
+    std::this_thread::sleep_for(milliseconds(100));
+    AudioPlayer::playAudioFile("quiet.wav");
+    float quietGain = AudioPlayer::getLastGain();
+    std::this_thread::sleep_for(milliseconds(700));
+    AudioPlayer::playAudioFile("loud.wav");
+    float loudGain = AudioPlayer::getLastGain();
+    std::this_thread::sleep_for(milliseconds(700));
+    AudioPlayer::setLoudnessTarget(0.0);
+    AudioPlayer::playAudioFile("loud.wav");
+    float offGain = AudioPlayer::getLastGain();
+    std::this_thread::sleep_for(milliseconds(700));
+    AudioPlayer::cleanup();
+
+    std::printf("  playback gain: quiet %+.2f dB, loud %+.2f dB, normalization off %+.2f dB\n",
+                20.0 * std::log10(quietGain), 20.0 * std::log10(loudGain), 20.0 * std::log10(offGain));
+    if (std::fabs(20.0 * std::log10(quietGain) - 10.0) > 0.1 || std::fabs(20.0 * std::log10(loudGain) + 6.0) > 0.1 ||
+        offGain != 1.0f) {
+        failures += fail("起播增益应把两段正弦归一到目标响度");
+    }
+
+    std::vector<WavSinkEvent> events = backend->getEvents();
+    AudioFormatInfo info;
+    std::ifstream file(options.path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (events.size() != 3 || !AudioHeaderParser::probeMemory(wav.data(), wav.size(), info)) {
+        failures += fail("输出 WAV 或事件记录缺失");
+    } else {
+        float levels[3];
+        for (size_t i = 0; i < 3; ++i) {
+            levels[i] = peak(wav, info.dataOffset, events[i].startFrame, events[i].endFrame);
+        }
+        std::printf("  output peak: quiet %.4f, loud %.4f (target %.4f), loud unnormalized %.4f\n", levels[0],
+                    levels[1], dbToAmplitude(kTargetLufs), levels[2]);
+        if (std::fabs(levels[0] - dbToAmplitude(kTargetLufs)) > 0.003 ||
+            std::fabs(levels[1] - dbToAmplitude(kTargetLufs)) > 0.003 ||
+            std::fabs(levels[2] - dbToAmplitude(-14.0)) > 0.003) {
+            failures += fail("输出电平与目标响度不符");
+        }
+    }
+
+    PathUtil::setAudioDir({});
+    AudioPlayer::setBackend(nullptr);
+    fs::remove_all(dir, ec);
+    return failures;
+}
+}  // namespace
+
+int benchLoudness() {
+    int failures = checkReference();
+    failures += checkKernels();
+    failures += checkPipeline();
+    return failures;
+}
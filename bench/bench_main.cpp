@@ -0,0 +1,73 @@
+// evcs-bench：性能基准入口。用法：evcs-bench [名称...]，不带参数运行全部
+#include <cstdio>
+#include <cstring>
+
+int benchTimingWheel();
+int benchInstructionTable();
+int benchMixer();
+int benchEngine();
+int benchAssetPool();
+int benchMetadataCache();
+int benchAudioHeader();
+int benchWavBackend();
+int benchOnsetLatency();
+int benchLoudness();
+int benchSilenceTrim();
+int benchManifest();
+int benchBundle();
+int benchFanOut();
+int benchSequence();
+int benchChain();
+int benchPcmKernels();
+int benchPreflight();
+int benchMirror();
+int benchWatchdog();
+int benchOutputLatency();
+
+namespace {
+struct BenchEntry {
+    const char* name;
+    const char* description;
+    int (*run)();
+};
+
+const BenchEntry kBenches[] = {
+    {"timing-wheel", "1000 考场 x 单科目上限指令的多会话调度", benchTimingWheel},
+    {"instruction-table", "行式与列式指令表的全表扫描热路径", benchInstructionTable},
+    {"mixer", "N 声部混音每块开销、CPU 余量与命令队列吞吐", benchMixer},
+    {"engine", "界面线程阻塞时专用播放线程与界面线程决策的起播迟到量", benchEngine},
+    {"asset-pool", "音频预载池载入耗时、吞吐、内存占用与预算/策略校验", benchAssetPool},
+    {"metadata-cache", "音频元数据缓存冷/热启动与增量刷新的耗时与探测次数", benchMetadataCache},
+    {"audio-header", "MP3/WAV 文件头解析：整目录扫描速度、读取量与时长/拒绝校验", benchAudioHeader},
+    {"wav-backend", "无声卡 WAV 后端：起播延迟、叠加区间、播放时长与输出内容校验", benchWavBackend},
+    {"onset-latency", "起播延迟记录：每科结束写报告，出声阶段与 WAV 后端采样位置对照", benchOnsetLatency},
+    {"loudness", "EBU R128 响度分析：参考信号、各 SIMD 内核一致性与文件/秒、后台分析到起播增益", benchLoudness},
+    {"silence-trim", "开头静音裁剪：各 SIMD 扫描内核一致性与吞吐、后台分析到起播裁剪后的出声位置", benchSilenceTrim},
+    {"manifest", "音频目录完整性清单：XXH64 参考值、单线程/线程池冷校验吞吐、增量校验、异常检出与时间预算", benchManifest},
+    {"bundle", "音频打包文件：内容与零拷贝校验、索引查找与散文件打开对照、散文件回退、损坏拒绝与从包中起播", benchBundle},
+    {"fan-out", "多设备扇出：起播按采样对齐、时钟漂移追平、欠载后重新对齐、失效设备放弃与设备选择", benchFanOut},
+    {"sequence", "组合指令：片段解析与展开、音频库占用、拼接无空隙校验与起播耗时（片段缓存/散文件 vs 单文件）", benchSequence},
+    {"chain", "接续指令：after: 解析、会话接续/失败/过期/停止/打断语义、实时交接间隙（预约接续 vs 播完通知后起播）", benchChain},
+    {"pcm-kernels", "PCM 内核：各 SIMD 级别与标量逐位一致、各内核吞吐、混音器换用内核后的输出一致性与每块开销", benchPcmKernels},
+    {"preflight", "完整解码预检：缺失/无法解码/截断/削波检出、单线程与线程池的墙钟耗时与加速比、后台检查的回调与取消", benchPreflight},
+    {"mirror", "本机镜像：冷同步拷贝吞吐与就绪用时、热同步只回读校验、改动/篡改重拷、重定向定位、镜像目录不可用、后台回调与取消", benchMirror},
+    {"watchdog", "播放看门狗：音频提前中断改用备用文件、设备卡住/写入失败换备用设备，检出与接替耗时、听到的间隙", benchWatchdog},
+    {"output-latency", "输出延迟补偿：按报告的设备延迟 + 排队量提前起播后首帧相对计划时刻的残余误差（关/开补偿）与起播观测", benchOutputLatency},
+};
+}  // namespace
+
+int main(int argc, char** argv) {
+    int failures = 0;
+    for (const auto& entry : kBenches) {
+        bool selected = (argc <= 1);
+        for (int i = 1; i < argc && !selected; ++i) {
+            selected = std::strcmp(argv[i], entry.name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+        std::printf("== %s: %s\n", entry.name, entry.description);
+        failures += entry.run() != 0 ? 1 : 0;
+    }
+    return failures == 0 ? 0 : 1;
+}
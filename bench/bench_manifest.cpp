@@ -0,0 +1,249 @@
+// 音频目录完整性清单基准：XXH64 参考值与分段一致性，临时目录下约 160 MB 素材的清单生成、
+// 单线程与线程池冷校验吞吐、未变化文件的增量校验，以及缺失/截断/改写/多出文件与时间预算内的部分结果。
+// 冷校验紧接生成之后，文件多在页缓存中，吞吐反映的是哈希与调度而不是磁盘。
+#include "AudioManifest.h"
+#include "BenchUtil.h"
+#include "XxHash64.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t kSmallFiles = 96;
+constexpr size_t kSmallBytes = 1 << 20;
+constexpr size_t kLargeFiles = 2;
+constexpr size_t kLargeBytes = 32 << 20;
+// 预算测试：到点回调应在预算后这么久之内发出
+constexpr double kBudgetSlackMs = 50.0;
+
+using bench::fail;
+
+double megabytes(uint64_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void writeFile(const std::filesystem::path& path, size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> words((size + 3) / 4);
+    for (auto& word : words) {
+        word = rng();
+    }
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(words.data()),
+                                                static_cast<std::streamsize>(size));
+}
+
+void printReport(const char* label, const ManifestReport& report) {
+    std::printf("  %-26s %3zu/%zu ok (reused %3zu, hashed %3zu, pending %zu, problems %zu, unlisted %zu)  "
+                "%2zu thr  %8.2f ms",
+                label, report.verifiedFiles, report.files, report.reusedFiles, report.hashedFiles,
+                report.pendingFiles, report.problems.size(), report.unlistedFiles, report.threads,
+                report.elapsedMs);
+    if (report.hashedBytes > 0 && report.elapsedMs > 0.0) {
+        std::printf("  %7.0f MB/s", megabytes(report.hashedBytes) / (report.elapsedMs / 1000.0));
+    }
+    std::printf("\n");
+}
+
+bool hasProblem(const ManifestReport& report, const std::string& path, ManifestProblem problem) {
+    return std::find(report.problems.begin(), report.problems.end(), std::make_pair(path, problem)) !=
+           report.problems.end();
+}
+
+// 参考实现给出的值，以及任意分段喂入与一次计算一致
+int checkHash() {
+    int failures = 0;
+    struct Vector {
+        const char* text;
+        uint64_t hash;
+    };
+    const Vector vectors[] = {
+        {"", 0xEF46DB3751D8E999ULL},
+        {"a", 0xD24EC4F1A98C6E5BULL},
+        {"abc", 0x44BC2CF5AD770999ULL},
+        {"Nobody inspects the spammish repetition", 0xFBCEA83C8A378BF1ULL},
+    };
+    for (const auto& vector : vectors) {
+        if (XxHash64::hash(vector.text, std::strlen(vector.text)) != vector.hash) {
+            std::printf("  XXH64(\"%s\") = %016llx\n", vector.text,
+                        static_cast<unsigned long long>(XxHash64::hash(vector.text, std::strlen(vector.text))));
+            failures += fail("XXH64 与参考值不符");
+        }
+    }
+
+    std::vector<unsigned char> data(1000);
+    std::mt19937 rng(5);
+    for (auto& byte : data) {
+        byte = static_cast<unsigned char>(rng());
+    }
+    const uint64_t whole = XxHash64::hash(data.data(), data.size());
+    for (size_t step : {1, 3, 7, 31, 32, 33, 100, 999}) {
+        XxHash64 hasher;
+        for (size_t offset = 0; offset < data.size(); offset += step) {
+            hasher.update(data.data() + offset, std::min(step, data.size() - offset));
+        }
+        if (hasher.digest() != whole) {
+            failures += fail("分段计算与一次计算不符");
+            break;
+        }
+    }
+
+    std::vector<unsigned char> big(64 << 20, 0x5A);
+    bench::Stopwatch watch;
+    uint64_t sink = XxHash64::hash(big.data(), big.size());
+    double ms = watch.elapsedMs();
+    std::printf("  xxh64 in-memory            %.0f MB/s (%016llx)\n", megabytes(big.size()) / (ms / 1000.0),
+                static_cast<unsigned long long>(sink));
+    return failures;
+}
+}  // namespace
+
+int benchManifest() {
+    namespace fs = std::filesystem;
+    int failures = checkHash();
+
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-manifest";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "listening");
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < kSmallFiles; ++i) {
+        writeFile(dir / ("clip" + std::to_string(i) + ".mp3"), kSmallBytes, static_cast<uint32_t>(i));
+        totalBytes += kSmallBytes;
+    }
+    for (size_t i = 0; i < kLargeFiles; ++i) {
+        writeFile(dir / "listening" / fs::u8path(u8"听力" + std::to_string(i) + ".mp3"), kLargeBytes,
+                  static_cast<uint32_t>(1000 + i));
+        totalBytes += kLargeBytes;
+    }
+    const size_t totalFiles = kSmallFiles + kLargeFiles;
+    std::printf("  %zu files, %.1f MB on disk (%zu x %.0f MB in a subdirectory)\n", totalFiles,
+                megabytes(totalBytes), kLargeFiles, megabytes(kLargeBytes));
+
+    std::vector<ManifestEntry> entries;
+    std::string error;
+    bench::Stopwatch watch;
+    if (!AudioManifest::generate(dir, 0, entries, error) || entries.size() != totalFiles) {
+        failures += fail("清单生成失败");
+    }
+    double ms = watch.elapsedMs();
+    std::printf("  %-26s %3zu files  %8.2f ms  %7.0f MB/s\n", "generate", entries.size(), ms,
+                megabytes(totalBytes) / (ms / 1000.0));
+    std::vector<ManifestEntry> reread;
+    if (!AudioManifest::read(dir / AudioManifest::MANIFEST_FILENAME, reread) || reread.size() != entries.size() ||
+        reread.back().path != entries.back().path || reread.back().hash != entries.back().hash ||
+        entries.back().path != u8"listening/听力1.mp3") {
+        failures += fail("清单读回与生成结果不符");
+    }
+
+    // 冷校验：1 线程与默认线程池（每次先删除本机状态）
+    ManifestReport single;
+    ManifestReport pooled;
+    for (size_t threads : {size_t(1), size_t(0)}) {
+        fs::remove(dir / AudioManifest::STATE_FILENAME, ec);
+        ManifestVerifier verifier;
+        verifier.setThreads(threads);
+        ManifestReport report = verifier.verify(dir);
+        printReport(threads == 1 ? "cold, 1 thread" : "cold, pool", report);
+        if (!report.complete || report.verifiedFiles != totalFiles || report.hashedFiles != totalFiles ||
+            !report.problems.empty() || report.unlistedFiles != 0) {
+            failures += fail("冷校验应逐个计算并全部通过");
+        }
+        (threads == 1 ? single : pooled) = report;
+    }
+    if (pooled.threads > 1 && single.elapsedMs > 0.0) {
+        std::printf("  pool speedup               %.2fx\n", single.elapsedMs / std::max(pooled.elapsedMs, 0.001));
+    }
+
+    ManifestVerifier verifier;
+    ManifestReport warm = verifier.verify(dir);
+    printReport("warm (unchanged)", warm);
+    if (!warm.complete || warm.reusedFiles != totalFiles || warm.hashedFiles != 0 || !warm.problems.empty()) {
+        failures += fail("未变化的文件应沿用上次结果，不读文件");
+    }
+
+    // 改写（同大小、修改时间变化）、截断、删除与多出文件
+    const fs::path corrupted = dir / "clip10.mp3";
+    const auto modified = fs::last_write_time(corrupted);
+    writeFile(corrupted, kSmallBytes, 9999);
+    fs::last_write_time(corrupted, modified + std::chrono::seconds(2));
+    fs::resize_file(dir / "clip20.mp3", kSmallBytes / 2);
+    fs::remove(dir / "clip30.mp3");
+    writeFile(dir / "extra.mp3", 4096, 1);
+    ManifestReport damaged = verifier.verify(dir);
+    printReport("damaged", damaged);
+    if (!damaged.complete || damaged.problems.size() != 3 || damaged.hashedFiles != 1 ||
+        damaged.reusedFiles != totalFiles - 3 || damaged.unlistedFiles != 1 ||
+        !hasProblem(damaged, "clip10.mp3", ManifestProblem::HASH_MISMATCH) ||
+        !hasProblem(damaged, "clip20.mp3", ManifestProblem::SIZE_MISMATCH) ||
+        !hasProblem(damaged, "clip30.mp3", ManifestProblem::MISSING)) {
+        failures += fail("改写/截断/缺失应分别报告，其余沿用上次结果");
+    }
+    ManifestReport again = verifier.verify(dir);
+    if (!hasProblem(again, "clip10.mp3", ManifestProblem::HASH_MISMATCH) || again.hashedFiles != 1) {
+        failures += fail("内容不符的文件不应记入本机状态");
+    }
+
+    // 时间预算：单线程冷校验，1 ms 预算到点先报告部分结果（stat 阶段发现的问题已在其中），随后校验完成
+    fs::remove(dir / AudioManifest::STATE_FILENAME, ec);
+    ManifestVerifier budgeted;
+    budgeted.setThreads(1);
+    budgeted.setBudget(std::chrono::milliseconds(1));
+    std::mutex mutex;
+    std::condition_variable done;
+    ManifestReport partial;
+    ManifestReport finished;
+    bool budgetCalled = false;
+    bool doneCalled = false;
+    budgeted.verifyAsync(
+        dir,
+        [&](const ManifestReport& report) {
+            std::lock_guard<std::mutex> lock(mutex);
+            partial = report;
+            budgetCalled = true;
+        },
+        [&](const ManifestReport& report) {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = report;
+            doneCalled = true;
+            done.notify_all();
+        });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::seconds(30), [&]() { return doneCalled; });
+    }
+    budgeted.cancel();
+    printReport("budget 1 ms: partial", partial);
+    printReport("budget 1 ms: final", finished);
+    if (!budgetCalled || partial.complete || partial.pendingFiles == 0 ||
+        partial.elapsedMs > 1.0 + kBudgetSlackMs || !hasProblem(partial, "clip30.mp3", ManifestProblem::MISSING) ||
+        !hasProblem(partial, "clip20.mp3", ManifestProblem::SIZE_MISMATCH)) {
+        failures += fail("预算到点应先给出含已发现问题的部分结果");
+    }
+    if (!doneCalled || !finished.complete || finished.problems.size() != 3 || finished.verifiedFiles != totalFiles - 3) {
+        failures += fail("预算到点后校验应继续完成");
+    }
+
+    // 取消：进行中的后台校验应及时停下且不回调
+    fs::remove(dir / AudioManifest::STATE_FILENAME, ec);
+    ManifestVerifier cancelled;
+    cancelled.setThreads(1);
+    bool cancelledDone = false;
+    cancelled.verifyAsync(dir, {}, [&](const ManifestReport&) { cancelledDone = true; });
+    watch.reset();
+    cancelled.cancel();
+    ms = watch.elapsedMs();
+    ManifestReport stopped = cancelled.getReport();
+    std::printf("  %-26s %8.2f ms to stop, %zu files still pending\n", "cancel", ms, stopped.pendingFiles);
+    if (cancelledDone || ms > 200.0) {
+        failures += fail("取消应及时生效且不回调");
+    }
+
+    fs::remove_all(dir, ec);
+    return failures;
+}
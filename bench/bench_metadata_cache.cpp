@@ -0,0 +1,139 @@
+// 音频元数据缓存基准：临时目录下生成一批音频文件，对比冷启动（逐个探测）、热启动（新进程读缓存文件、
+// 只 stat）与增量刷新（少量文件变化）的耗时与探测次数，并校验缓存文件往返与后台刷新。
+// 探测器用替身：打开文件读头部 64 KB，按文件大小推算时长（近似 BASS 建流读头部的 I/O）。
+#include "AudioMetadataCache.h"
+#include "BenchUtil.h"
+#include "InstructionTable.h"
+#include "PathUtil.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t kFileCount = 2000;
+constexpr size_t kFileBytes = 96 * 1024;
+constexpr size_t kTouchedFiles = 10;
+constexpr size_t kProbeBytes = 64 * 1024;
+
+using bench::fail;
+
+std::atomic<size_t> g_probes{0};
+
+bool fakeProbe(const AudioLocation& location, AudioMetadata& metadata) {
+    g_probes.fetch_add(1);
+    std::ifstream file(location.path, std::ios::binary);
+    std::vector<char> header(kProbeBytes);
+    if (!file || !file.read(header.data(), static_cast<std::streamsize>(header.size()))) {
+        return false;
+    }
+    metadata.durationSeconds = metadata.fileSize / 16000.0;  // 128 kbps
+    metadata.sampleRate = 44100;
+    metadata.channels = 2;
+    metadata.codec = "mp3";
+    return true;
+}
+
+void writeFile(const std::filesystem::path& path, size_t bytes, char fill) {
+    std::vector<char> data(bytes, fill);
+    std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void printStats(const char* label, const MetadataCacheStats& stats) {
+    std::printf("  %-26s %8.2f ms  %5zu files  loaded %5zu  reused %5zu  probed %5zu  saved %s\n", label,
+                stats.elapsedMs, stats.requestedFiles, stats.loadedEntries, stats.reusedFiles, stats.probedFiles,
+                stats.saved ? "yes" : "no");
+}
+}  // namespace
+
+int benchMetadataCache() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-metadata";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+
+    std::vector<std::string> files;
+    for (size_t i = 0; i < kFileCount; ++i) {
+        std::string name = "指令" + std::to_string(i) + ".mp3";
+        writeFile(dir / fs::u8path(name), kFileBytes + i, static_cast<char>(i));
+        files.push_back(name);
+    }
+    files.push_back("absent.mp3");
+    PathUtil::setAudioDir(dir);
+
+    int failures = 0;
+    {
+        AudioMetadataCache cache;
+        cache.setProber(fakeProbe);
+        MetadataCacheStats cold = cache.refresh(files);
+        printStats("cold (no cache file)", cold);
+        if (cold.probedFiles != kFileCount || cold.missingFiles != 1 || !cold.saved) {
+            failures += fail("冷启动应探测全部文件并写出缓存文件");
+        }
+    }
+
+    // 模拟下一次启动：新实例从缓存文件读入，只 stat
+    g_probes.store(0);
+    AudioMetadataCache cache;
+    cache.setProber(fakeProbe);
+    MetadataCacheStats warm = cache.refresh(files);
+    printStats("warm (cache file)", warm);
+    auto sample = cache.find(files[7]);
+    if (warm.probedFiles != 0 || g_probes.load() != 0 || warm.reusedFiles != kFileCount || !sample ||
+        sample->fileSize != kFileBytes + 7 || sample->codec != "mp3" || sample->channels != 2 ||
+        std::abs(sample->durationSeconds - (kFileBytes + 7) / 16000.0) > 1e-6) {
+        failures += fail("未变化的文件不应重新探测，缓存记录应与探测结果一致");
+    }
+
+    // 少量文件变化（大小改变）：后台增量刷新只探测这几个
+    for (size_t i = 0; i < kTouchedFiles; ++i) {
+        writeFile(dir / fs::u8path(files[i * 100]), kFileBytes * 2, 'x');
+    }
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+    MetadataCacheStats incremental;
+    cache.refreshAsync(files, [&](const MetadataCacheStats& stats) {
+        std::lock_guard<std::mutex> lock(mutex);
+        incremental = stats;
+        finished = true;
+        done.notify_one();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!done.wait_for(lock, std::chrono::seconds(30), [&] { return finished; })) {
+            failures += fail("后台刷新未完成");
+        }
+    }
+    printStats("incremental (background)", incremental);
+    if (incremental.probedFiles != kTouchedFiles || cache.find(files[100])->fileSize != kFileBytes * 2) {
+        failures += fail("增量刷新应只探测变化的文件");
+    }
+
+    // 时长填入指令表后可在播放前检查重叠
+    InstructionTable table;
+    Instruction instruction;
+    instruction.audioFile = files[1];
+    instruction.playTime = std::chrono::system_clock::time_point(std::chrono::hours(1000));
+    table.append(instruction);
+    instruction.audioFile = files[2];
+    instruction.playTime += std::chrono::seconds(5);  // 上一条约 6 秒，播完前下一条已开始
+    table.append(instruction);
+    instruction.audioFile = "absent.mp3";
+    instruction.playTime += std::chrono::seconds(60);
+    table.append(instruction);
+    size_t filled = table.fillDurations([&cache](const std::string& file) { return cache.getDuration(file); });
+    if (filled != 2 || !table.overlapsNext(0) || table.overlapsNext(1) || table.overlapsNext(2)) {
+        failures += fail("时长填写/重叠判定不符");
+    }
+
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -0,0 +1,216 @@
+// 本机镜像基准：临时目录下的“源”（约 48 MB 散文件 + 打包文件 + 元数据缓存，模拟 U 盘上的 audio 目录）
+// 镜像到本机目录：需要镜像的文件列表、冷同步的拷贝吞吐与就绪用时、源未变化时只回读镜像的热同步、
+// 源文件改动与镜像被篡改后只重拷对应文件、重定向后从镜像定位散文件与打包条目、镜像目录不可用、
+// 后台同步的完成回调与取消。源在页缓存中，吞吐反映的是拷贝与哈希而不是 U 盘。
+#include "AudioBundle.h"
+#include "AudioManifest.h"
+#include "AudioMetadataCache.h"
+#include "AudioMirror.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t kLooseFiles = 32;
+constexpr size_t kLooseBytes = 3 << 19;  // 1.5 MB
+constexpr size_t kBundledFiles = 3;
+constexpr size_t kBundledBytes = 256 << 10;
+
+using bench::fail;
+
+void writeRandom(const std::filesystem::path& path, size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> words((size + 3) / 4);
+    for (auto& word : words) {
+        word = rng();
+    }
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(words.data()),
+                                                static_cast<std::streamsize>(size));
+}
+
+void printReport(const char* label, const MirrorReport& report) {
+    std::printf("  %-24s %2zu files (copied %2zu, reused %2zu, problems %zu)  %6.1f MB copied  %7.1f MB/s  "
+                "verify %7.2f ms  ready %s in %8.2f ms\n",
+                label, report.files, report.copiedFiles, report.reusedFiles, report.problems.size(),
+                report.copiedBytes / (1024.0 * 1024.0), report.copyMegabytesPerSecond(), report.verifyMs,
+                report.ready ? "yes" : "no ", report.elapsedMs);
+}
+
+// 镜像中每个文件与源逐字节哈希一致，修改时间沿用源
+bool sameAsSource(const std::filesystem::path& source, const std::filesystem::path& mirror,
+                  const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+        const auto from = source / std::filesystem::u8path(file);
+        const auto to = mirror / std::filesystem::u8path(file);
+        std::error_code ec;
+        if (!std::filesystem::exists(from, ec)) {
+            continue;
+        }
+        uint64_t a = 0;
+        uint64_t b = 0;
+        if (!AudioManifest::hashFile(from, a) || !AudioManifest::hashFile(to, b) || a != b ||
+            std::filesystem::last_write_time(from, ec) != std::filesystem::last_write_time(to, ec)) {
+            std::printf("  %s differs\n", file.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hasProblem(const MirrorReport& report, const std::string& file, MirrorProblem problem) {
+    return std::find(report.problems.begin(), report.problems.end(), std::make_pair(file, problem)) !=
+           report.problems.end();
+}
+
+// 重定向后散文件与打包条目都从镜像取；取消重定向回到源
+int checkRedirect(const std::filesystem::path& source, const std::filesystem::path& mirror) {
+    int failures = 0;
+    PathUtil::setAudioDir(source);
+    PathUtil::setAudioMirror(mirror);
+    AudioLocation loose;
+    AudioLocation bundled;
+    const bool located = AudioBundle::locate("instr01.mp3", loose) && AudioBundle::locate("clip0.mp3", bundled);
+    auto bundle = AudioBundle::mounted();
+    if (!located || loose.inBundle() || loose.path.parent_path() != mirror || !bundled.inBundle() || !bundle ||
+        bundle->path().parent_path() != mirror || PathUtil::getAudioSourceDir() != source) {
+        failures += fail("重定向后未从镜像定位");
+    }
+    PathUtil::setAudioMirror({});
+    if (!AudioBundle::locate("instr01.mp3", loose) || loose.path.parent_path() != source ||
+        AudioBundle::mounted()->path().parent_path() != source) {
+        failures += fail("取消重定向后未回到源目录");
+    }
+    PathUtil::setAudioDir({});
+    return failures;
+}
+
+// 后台同步：完成回调带就绪结果；启动后立即取消则不回调
+int checkAsync(const std::filesystem::path& source, const std::filesystem::path& mirror,
+               const std::vector<std::string>& files) {
+    int failures = 0;
+    AudioMirror async;
+    bool called = false;
+    async.syncAsync(source, mirror, files, [&called](const MirrorReport&) { called = true; });
+    async.cancel();
+    const MirrorReport cancelled = async.getReport();
+    std::printf("  cancel: %zu/%zu files done when cancelled\n", cancelled.copiedFiles + cancelled.reusedFiles,
+                cancelled.files);
+    if (called || cancelled.ready) {
+        failures += fail("取消后仍回调或报告就绪");
+    }
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool ready = false;
+    called = false;
+    async.syncAsync(source, mirror, files, [&](const MirrorReport& report) {
+        std::lock_guard<std::mutex> lock(mutex);
+        called = true;
+        ready = report.ready;
+        done.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!done.wait_for(lock, std::chrono::seconds(30), [&]() { return called; }) || !ready) {
+        failures += fail("后台同步未回调就绪结果");
+    }
+    return failures;
+}
+}  // namespace
+
+int benchMirror() {
+    namespace fs = std::filesystem;
+    const fs::path root = fs::temp_directory_path() / "evcs-bench-mirror";
+    const fs::path source = root / "usb" / "audio";
+    const fs::path mirror = root / "local" / "audio_mirror";
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(source);
+
+    std::vector<std::string> referenced;
+    for (size_t i = 0; i < kLooseFiles; ++i) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "%s%02zu.mp3", i % 4 == 0 ? "listening/part" : "instr", i);
+        writeRandom(source / fs::u8path(name), kLooseBytes + i * 4099, static_cast<uint32_t>(i));
+        referenced.push_back(name);
+    }
+    std::vector<std::string> bundled;
+    for (size_t i = 0; i < kBundledFiles; ++i) {
+        const std::string name = "clip" + std::to_string(i) + ".mp3";
+        writeRandom(source / name, kBundledBytes, static_cast<uint32_t>(100 + i));
+        bundled.push_back(name);
+    }
+    std::string error;
+    if (!AudioBundle::pack(source, bundled, source / AudioBundle::BUNDLE_FILENAME, error)) {
+        fs::remove_all(root, ec);
+        return fail("打包失败");
+    }
+    for (const auto& name : bundled) {
+        fs::remove(source / name, ec);
+    }
+    writeRandom(source / AudioMetadataCache::CACHE_FILENAME, 4096, 200);
+    // 组合指令展开的片段、重复引用与缺失文件
+    referenced.insert(referenced.end(), bundled.begin(), bundled.end());
+    referenced.push_back("instr01.mp3");
+    referenced.push_back("missing.mp3");
+
+    int failures = 0;
+    const std::vector<std::string> files = AudioMirror::listFiles(source, referenced);
+    const size_t expectedFiles = kLooseFiles + 1 + 2;  // 散文件 + 缺失 + 打包文件与元数据缓存
+    std::printf("  %zu referenced -> %zu to mirror\n", referenced.size(), files.size());
+    if (files.size() != expectedFiles ||
+        std::find(files.begin(), files.end(), AudioBundle::BUNDLE_FILENAME) == files.end() ||
+        std::find(files.begin(), files.end(), "clip0.mp3") != files.end()) {
+        failures += fail("需要镜像的文件列表不对（打包条目应随打包文件镜像，重复只列一次）");
+    }
+
+    AudioMirror audioMirror;
+    const MirrorReport cold = audioMirror.sync(source, mirror, files);
+    printReport("cold (copy + verify):", cold);
+    if (!cold.ready || cold.copiedFiles != files.size() - 1 || cold.problems.size() != 1 ||
+        !hasProblem(cold, "missing.mp3", MirrorProblem::MISSING) || !sameAsSource(source, mirror, files)) {
+        failures += fail("冷同步结果不对");
+    }
+
+    const MirrorReport warm = audioMirror.sync(source, mirror, files);
+    printReport("warm (verify only):", warm);
+    if (!warm.ready || warm.copiedFiles != 0 || warm.reusedFiles != files.size() - 1) {
+        failures += fail("源未变化时仍从源拷贝");
+    }
+
+    // 源改动（大小不变、修改时间变化）与镜像被篡改（修改时间不变）各重拷一个文件
+    writeRandom(source / "instr02.mp3", fs::file_size(source / "instr02.mp3"), 999);
+    fs::last_write_time(source / "instr02.mp3", fs::last_write_time(source / "instr02.mp3") + std::chrono::seconds(5));
+    const auto tamperedTime = fs::last_write_time(mirror / "instr03.mp3");
+    writeRandom(mirror / "instr03.mp3", fs::file_size(mirror / "instr03.mp3"), 998);
+    fs::last_write_time(mirror / "instr03.mp3", tamperedTime);
+    const MirrorReport changed = audioMirror.sync(source, mirror, files);
+    printReport("1 changed + 1 tampered:", changed);
+    if (!changed.ready || changed.copiedFiles != 2 || !sameAsSource(source, mirror, files)) {
+        failures += fail("改动或被篡改的文件未重拷");
+    }
+
+    failures += checkRedirect(source, mirror);
+
+    // 镜像目录不可用（同名普通文件占位）：不就绪，源照常使用
+    writeRandom(root / "blocked", 16, 1);
+    const MirrorReport blocked = audioMirror.sync(source, root / "blocked" / "audio_mirror", files);
+    std::printf("  blocked mirror dir: %s\n", AudioMirror::formatReport(blocked).c_str());
+    if (blocked.ready || blocked.error.empty()) {
+        failures += fail("镜像目录不可用时报告就绪");
+    }
+
+    fs::remove_all(mirror, ec);
+    failures += checkAsync(source, mirror, files);
+    std::printf("  %s\n", AudioMirror::formatReport(audioMirror.sync(source, mirror, files)).c_str());
+
+    fs::remove_all(root, ec);
+    return failures;
+}
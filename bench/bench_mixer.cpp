@@ -0,0 +1,290 @@
+// 混音器基准：每块（10ms）混音开销随声部数的变化与 CPU 余量，
+// 以及控制端 -> 渲染线程命令队列的吞吐。附带叠加/闪避/抢占的正确性校验，
+// 以及预读源在慢速/卡住的内层源上渲染线程侧 read() 的开销与补静音、放弃行为。
+#include "AudioMixer.h"
+#include "BenchUtil.h"
+#include "ReadAheadSource.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint32_t kRate = 44100;
+
+std::shared_ptr<const PcmBuffer> makeTone(double seconds, float amplitude, uint32_t rate = kRate) {
+    auto buffer = std::make_shared<PcmBuffer>();
+    buffer->sampleRate = rate;
+    const size_t frames = static_cast<size_t>(seconds * rate);
+    buffer->samples.resize(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        float value = amplitude * static_cast<float>(std::sin(2.0 * 3.14159265358979 * 440.0 * i / rate));
+        buffer->samples[i * 2] = value;
+        buffer->samples[i * 2 + 1] = value;
+    }
+    return buffer;
+}
+
+std::shared_ptr<const PcmBuffer> makeConstant(double seconds, float value) {
+    auto buffer = std::make_shared<PcmBuffer>();
+    buffer->sampleRate = kRate;
+    buffer->samples.assign(static_cast<size_t>(seconds * kRate) * 2, value);
+    return buffer;
+}
+
+std::unique_ptr<MixerSource> sourceOf(const std::shared_ptr<const PcmBuffer>& buffer) {
+    return std::make_unique<PcmBufferSource>(buffer);
+}
+
+using bench::fail;
+
+// 叠加、闪避、停止淡出与抢占的行为校验（直接调用 render，确定性）
+int checkBehaviour() {
+    MixerConfig config;
+    config.voiceCount = 2;
+    AudioMixer mixer(config);
+    std::vector<float> out(config.blockFrames * 2);
+
+    // 两路同优先级：直接相加，互不截断
+    auto a = mixer.play(sourceOf(makeConstant(1.0, 0.2f)), AudioMixer::PRIORITY_NORMAL);
+    auto b = mixer.play(sourceOf(makeConstant(1.0, 0.3f)), AudioMixer::PRIORITY_NORMAL);
+    if (!mixer.isPlaying(a) || !mixer.isPlaying(b)) {
+        return fail("排队中的播放应视为在播");
+    }
+    mixer.render(out.data(), config.blockFrames);
+    if (std::fabs(out[0] - 0.5f) > 1e-5f) {
+        return fail("两路同级应叠加");
+    }
+
+    // 第二路升为前台：第一路在 rampMs 内压到 duckGain
+    mixer.setPriority(b, AudioMixer::PRIORITY_FOREGROUND);
+    for (int i = 0; i < 10; ++i) {
+        mixer.render(out.data(), config.blockFrames);
+    }
+    float expected = 0.2f * config.duckGain + 0.3f;
+    if (std::fabs(out[0] - expected) > 1e-4f) {
+        return fail("低优先级声部应被闪避");
+    }
+
+    // 前台停止：淡出后释放，后台恢复原增益
+    mixer.stop(b);
+    for (int i = 0; i < 10; ++i) {
+        mixer.render(out.data(), config.blockFrames);
+    }
+    if (mixer.isPlaying(b) || std::fabs(out[0] - 0.2f) > 1e-4f) {
+        return fail("停止后应释放并恢复闪避");
+    }
+
+    // 声部用尽：同级抢占最早的，更低优先级的请求被丢弃
+    auto c = mixer.play(sourceOf(makeConstant(1.0, 0.1f)), AudioMixer::PRIORITY_NORMAL);
+    auto d = mixer.play(sourceOf(makeConstant(1.0, 0.1f)), AudioMixer::PRIORITY_NORMAL);
+    auto e = mixer.play(sourceOf(makeConstant(1.0, 0.1f)), AudioMixer::PRIORITY_BACKGROUND);
+    mixer.render(out.data(), config.blockFrames);
+    MixerStats stats = mixer.getStats();
+    if (mixer.isPlaying(a) || !mixer.isPlaying(c) || !mixer.isPlaying(d) || mixer.isPlaying(e) ||
+        stats.stolen != 1 || stats.dropped != 1) {
+        return fail("声部抢占/丢弃不符合优先级规则");
+    }
+
+    // 声部用尽时回收正在淡出的声部只算回收槽位，不计抢占
+    mixer.stop(c);
+    auto f = mixer.play(sourceOf(makeConstant(1.0, 0.1f)), AudioMixer::PRIORITY_NORMAL);
+    mixer.render(out.data(), config.blockFrames);
+    if (!mixer.isPlaying(f) || mixer.getStats().stolen != 1) {
+        return fail("回收淡出中的声部不应计为抢占");
+    }
+
+    // 自然播完后释放
+    for (int i = 0; i < 110; ++i) {
+        mixer.render(out.data(), config.blockFrames);
+    }
+    if (mixer.isPlaying(d) || mixer.isPlaying(f) || mixer.getStats().activeVoices != 0) {
+        return fail("播完的声部应释放");
+    }
+    std::printf("  behaviour: overlap / duck / release / steal OK\n");
+    return 0;
+}
+
+// 每块混音开销：voices 路同时发声（一半为后台被闪避，半数需变采样）
+void measureCost(size_t voices) {
+    MixerConfig config;
+    config.voiceCount = voices;
+    AudioMixer mixer(config);
+    auto tone = makeTone(30.0, 0.05f);
+    auto tone48k = makeTone(30.0, 0.05f, 48000);
+    for (size_t i = 0; i < voices; ++i) {
+        std::unique_ptr<MixerSource> source = sourceOf(i % 2 == 0 ? tone : tone48k);
+        if (i % 2 != 0) {
+            source = std::make_unique<ResamplingSource>(std::move(source), 48000, kRate);
+        }
+        mixer.play(std::move(source), i == 0 ? AudioMixer::PRIORITY_FOREGROUND : AudioMixer::PRIORITY_NORMAL);
+    }
+
+    const size_t blocks = 2000;  // 20 秒音频
+    std::vector<float> out(config.blockFrames * 2);
+    bench::Stopwatch watch;
+    for (size_t i = 0; i < blocks; ++i) {
+        mixer.render(out.data(), config.blockFrames);
+    }
+    double totalMs = watch.elapsedMs();
+    MixerStats stats = mixer.getStats();
+    char label[64];
+    std::snprintf(label, sizeof(label), "mix %2zu voices (per 10ms block)", voices);
+    bench::report(label, totalMs, blocks);
+    std::printf("    avg %.2f us  max %.2f us  budget %.0f us  load %.3f%%  headroom %.1fx\n",
+                stats.avgCostUs, stats.maxCostUs, stats.budgetUs, stats.load * 100.0,
+                stats.avgCostUs > 0.0 ? stats.budgetUs / stats.avgCostUs : 0.0);
+}
+
+// 命令队列：控制端线程连续 play/stop，渲染线程并发取命令
+int measureQueue() {
+    MixerConfig config;
+    config.voiceCount = 8;
+    config.commandCapacity = 1024;
+    AudioMixer mixer(config);
+    auto clip = makeConstant(0.05, 0.01f);
+
+    std::atomic<bool> running{true};
+    std::thread renderer([&] {
+        std::vector<float> out(config.blockFrames * 2);
+        while (running.load(std::memory_order_acquire)) {
+            mixer.render(out.data(), config.blockFrames);
+        }
+    });
+
+    const size_t commands = 200000;
+    size_t accepted = 0;
+    bench::Stopwatch watch;
+    for (size_t i = 0; i < commands; ++i) {
+        AudioMixer::VoiceHandle handle = 0;
+        while ((handle = mixer.play(sourceOf(clip), AudioMixer::PRIORITY_NORMAL)) == 0) {
+            std::this_thread::yield();  // 队满：等渲染端取走
+        }
+        ++accepted;
+        if (i % 2 == 0) {
+            mixer.stop(handle);
+        }
+    }
+    double totalMs = watch.elapsedMs();
+    running.store(false, std::memory_order_release);
+    renderer.join();
+    mixer.collectRetired();
+    bench::report("command queue play(+stop) round", totalMs, accepted);
+    return accepted == commands ? 0 : fail("命令丢失");
+}
+// 模拟从慢盘解码的源：每次 read 先睡 readDelay，读到 stallAt 帧时卡住 stallFor；样本值为帧序号
+class SlowSource : public MixerSource {
+public:
+    SlowSource(size_t frames, std::chrono::microseconds readDelay, size_t stallAt = 0,
+               std::chrono::milliseconds stallFor = std::chrono::milliseconds(0))
+        : m_frames(frames), m_readDelay(readDelay), m_stallAt(stallAt), m_stallFor(stallFor) {}
+
+    size_t read(float* out, size_t frames) override {
+        std::this_thread::sleep_for(m_readDelay);
+        if (m_stallAt > 0 && m_position >= m_stallAt && !m_stalled) {
+            m_stalled = true;
+            std::this_thread::sleep_for(m_stallFor);
+        }
+        const size_t count = std::min(frames, m_frames - m_position);
+        for (size_t i = 0; i < count; ++i) {
+            out[i * 2] = static_cast<float>(m_position + i);
+            out[i * 2 + 1] = static_cast<float>(m_position + i);
+        }
+        m_position += count;
+        return count;
+    }
+
+private:
+    size_t m_frames;
+    std::chrono::microseconds m_readDelay;
+    size_t m_stallAt;
+    std::chrono::milliseconds m_stallFor;
+    size_t m_position = 0;
+    bool m_stalled = false;
+};
+
+// 按设备节奏（每 10ms 一块）读预读源；返回读出的帧数，readMs/maxReadMs 为 read() 的总耗时与单次最大耗时
+size_t pull(MixerSource& source, size_t blocks, std::vector<float>& all, double& readMs, double& maxReadMs) {
+    constexpr size_t kBlock = kRate / 100;
+    std::vector<float> out(kBlock * 2);
+    size_t total = 0;
+    for (size_t i = 0; i < blocks; ++i) {
+        bench::Stopwatch watch;
+        const size_t read = source.read(out.data(), kBlock);
+        const double elapsedMs = watch.elapsedMs();
+        readMs += elapsedMs;
+        maxReadMs = std::max(maxReadMs, elapsedMs);
+        all.insert(all.end(), out.begin(), out.begin() + read * 2);
+        total += read;
+        if (read < kBlock) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return total;
+}
+
+int checkReadAhead() {
+    using namespace std::chrono;
+    int failures = 0;
+    // 内层每读 1024 帧睡 2ms（约 10 倍实时余量，但直接在渲染线程上读共要等 40 余 ms）：数据逐帧无缺
+    {
+        const size_t frames = kRate / 2;
+        ReadAheadSource source(std::make_unique<SlowSource>(frames, microseconds(2000)), kRate);
+        std::vector<float> all;
+        double readMs = 0.0;
+        double maxReadMs = 0.0;
+        const size_t read = pull(source, 100, all, readMs, maxReadMs);
+        bool exact = read == frames;
+        for (size_t i = 0; exact && i < read; ++i) {
+            exact = all[i * 2] == static_cast<float>(i);
+        }
+        std::printf("  read-ahead: %zu frames through a 2 ms/read source, render reads %.2f ms total, starved %llu\n",
+                    read, readMs, static_cast<unsigned long long>(source.getStarvedFrames()));
+        if (!exact || source.getStarvedFrames() != 0) {
+            failures += fail("预读源应逐帧无缺地交出内层数据");
+        }
+        if (readMs > 10.0) {
+            failures += fail("预读源的 read() 不应等内层解码");
+        }
+    }
+    // 内层在 0.6 秒处卡住 1 秒：渲染侧补静音 STARVE_SECONDS 后按读尽返回，析构不等卡住的内层
+    {
+        const size_t frames = kRate * 2;
+        auto source = std::make_unique<ReadAheadSource>(
+            std::make_unique<SlowSource>(frames, microseconds(0), kRate * 6 / 10, milliseconds(1000)), kRate);
+        std::vector<float> all;
+        double readMs = 0.0;
+        double maxReadMs = 0.0;
+        const size_t read = pull(*source, 300, all, readMs, maxReadMs);
+        const uint64_t starved = source->getStarvedFrames();
+        bench::Stopwatch watch;
+        source.reset();
+        const double destroyMs = watch.elapsedMs();
+        std::printf("  read-ahead stall: gave up after %zu frames (%llu starved), render read max %.2f ms, "
+                    "destroy %.2f ms\n",
+                    read, static_cast<unsigned long long>(starved), maxReadMs, destroyMs);
+        const auto limit = static_cast<uint64_t>(ReadAheadSource::STARVE_SECONDS * kRate);
+        if (read >= frames || starved < limit || starved > limit + kRate / 100) {
+            failures += fail("内层卡住时应补静音到上限后按读尽返回");
+        }
+        // 内层卡 1 秒：不预读时渲染线程的单次 read 与析构都会跟着卡住
+        if (maxReadMs > 100.0 || destroyMs > 100.0) {
+            failures += fail("内层卡住时 read() 与析构都不应等待");
+        }
+    }
+    return failures;
+}
+}  // namespace
+
+int benchMixer() {
+    int failures = checkBehaviour();
+    failures += checkReadAhead();
+    for (size_t voices : {1, 2, 4, 8, 16, 32}) {
+        measureCost(voices);
+    }
+    failures += measureQueue();
+    return failures;
+}
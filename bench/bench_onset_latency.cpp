@@ -0,0 +1,155 @@
+// 起播延迟记录基准：播放线程 + AudioPlayer（WAV 后端）实时播完两科指令，
+// 校验每科结束即写出报告、各阶段时刻齐全，且“出声”阶段与 WAV 后端按采样位置测得的延迟一致。
+// 实时运行，约 1.5 秒。
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "PlaybackEngine.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kMixRate = 44100;
+constexpr double kClipSeconds = 0.1;
+constexpr int kOffsetsMs[] = {150, 300, 450, 600, 750, 900};  // 前三条属第一科，后三条属第二科
+// 与 wav-backend 相同的门限：排队 4 块 (40ms) + 渲染线程半块睡眠 + 播放线程唤醒，留出调度抖动余量
+constexpr double kMaxOnsetMs = 80.0;
+// 记录的“出声”阶段与 WAV 后端测量值之差：两者只差 mixer->play() 本身的耗时
+constexpr double kMaxOutputMismatchMs = 5.0;
+
+using bench::fail;
+
+std::vector<Instruction> makeInstructions(system_clock::time_point base) {
+    std::vector<Instruction> instructions;
+    for (size_t i = 0; i < std::size(kOffsetsMs); ++i) {
+        Instruction instruction;
+        instruction.subjectId = i < 3 ? 1 : 2;
+        instruction.subjectName = i < 3 ? "语文" : "数学";
+        instruction.name = "指令" + std::to_string(i + 1);
+        instruction.audioFile = "clip" + std::to_string(i + 1) + ".wav";
+        instruction.playTime = base + milliseconds(kOffsetsMs[i]);
+        instructions.push_back(instruction);
+    }
+    return instructions;
+}
+}  // namespace
+
+int benchOnsetLatency() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-onset-latency";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    for (size_t i = 0; i < std::size(kOffsetsMs); ++i) {
+        bench::writeSine(dir / ("clip" + std::to_string(i + 1) + ".wav"), kMixRate, kClipSeconds);
+    }
+    PathUtil::setAudioDir(dir);
+
+    WavSinkOptions options;
+    options.sampleRate = kMixRate;
+    options.writeEventLog = false;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    if (!AudioPlayer::initialize()) {
+        PathUtil::setAudioDir({});
+        AudioPlayer::setBackend(nullptr);
+        return fail("WAV 后端初始化失败");
+    }
+    // 等渲染线程填满排队量（稳态）
+    std::this_thread::sleep_for(milliseconds(100));
+
+    int failures = 0;
+    const fs::path reportPath = dir / "latency.txt";
+    AudioPlayerSink sink;
+    PlaybackEngine engine(Clock::system(), sink);
+    engine.setLatencyReportPath(reportPath);
+    engine.start();
+    const auto base = time_point_cast<milliseconds>(system_clock::now());
+    engine.addInstructions(makeInstructions(base));
+
+    // 第一科最后一条起播后、第二科开始前：报告应已写出且只含第一科
+    std::this_thread::sleep_until(base + milliseconds((kOffsetsMs[2] + kOffsetsMs[3]) / 2 + 50));
+    std::string midReport;
+    {
+        std::ifstream file(reportPath, std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        midReport = buffer.str();
+    }
+    std::this_thread::sleep_until(base + milliseconds(kOffsetsMs[std::size(kOffsetsMs) - 1] + 350));
+    EngineStats stats = engine.getStats();
+    engine.stop();
+    AudioPlayer::cleanup();
+
+    if (midReport.find("== 语文") == std::string::npos || midReport.find("== 数学") != std::string::npos) {
+        failures += fail("第一科结束时应写出只含第一科的报告");
+    }
+    std::string report;
+    {
+        std::ifstream file(reportPath, std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        report = buffer.str();
+    }
+    if (report.find("== 语文") == std::string::npos || report.find("== 数学") == std::string::npos ||
+        report.find("== 全部科目") == std::string::npos) {
+        failures += fail("最终报告应含两科各一节与汇总");
+    }
+    std::printf("  %llu reports written during the session\n",
+                static_cast<unsigned long long>(stats.latencyReports));
+    if (stats.latencyReports < 2) {
+        failures += fail("每科结束都应写一次报告");
+    }
+
+    // 明细行按起播先后排列（两科先后进行），第 i 行对应 WAV 后端的第 i 个事件
+    std::vector<WavSinkEvent> events = backend->getEvents();
+    std::vector<std::pair<double, double>> details;  // {出声, 总计}
+    std::istringstream lines(report);
+    for (std::string line; std::getline(lines, line);) {
+        size_t output = line.find("出声 ");
+        size_t onset = line.find("总计 ");
+        if (line.find("  调度 ") == std::string::npos || output == std::string::npos || onset == std::string::npos) {
+            continue;
+        }
+        details.emplace_back(std::atof(line.c_str() + output + std::strlen("出声 ")),
+                             std::atof(line.c_str() + onset + std::strlen("总计 ")));
+    }
+    const std::string summary = "== 全部科目：自动 " + std::to_string(std::size(kOffsetsMs)) +
+                                " 次，手动 0 次，出声时刻未知 0 次";
+    if (events.size() != std::size(kOffsetsMs) || details.size() != std::size(kOffsetsMs) ||
+        report.find(summary) == std::string::npos) {
+        failures += fail("每次起播都应有一条出声时刻已知的记录");
+    } else {
+        double maxMismatch = 0.0;
+        double maxOnset = 0.0;
+        for (size_t i = 0; i < details.size(); ++i) {
+            maxMismatch = std::max(maxMismatch, std::fabs(details[i].first - events[i].onsetLatencyMs));
+            maxOnset = std::max(maxOnset, details[i].second);
+        }
+        std::printf("  recorded vs. sample-accurate output stage: max mismatch %.3f ms; onset max %.3f ms\n",
+                    maxMismatch, maxOnset);
+        if (maxMismatch > kMaxOutputMismatchMs) {
+            failures += fail("记录的出声阶段与 WAV 后端测量值不符");
+        }
+        if (maxOnset > kMaxOnsetMs) {
+            failures += fail("计划到出声的总延迟超出排队深度允许的范围");
+        }
+    }
+
+    PathUtil::setAudioDir({});
+    AudioPlayer::setBackend(nullptr);
+    fs::remove_all(dir, ec);
+    return failures;
+}
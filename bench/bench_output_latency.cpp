@@ -0,0 +1,180 @@
+// 输出延迟补偿基准：播放线程 + AudioPlayer 接 WavSinkBackend 实时播放四条指令，模拟的设备有固定输出延迟。
+// 分别关闭/开启补偿各播一遍，按 WAV 后端的采样位置量出首帧实际出声相对 playTime 的残余误差：
+// 不补偿时约为设备延迟 + 排队量，补偿（提前量 = 报告的设备延迟 + 排队量）后只剩调度抖动。
+// 另查会话每条指令只记一次起播观测，且观测不改变提前量。
+// 单设备与两台延迟不同的设备（扇出对齐到较慢的一台）各一遍。实时部分约 5 秒。
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "PlaybackEngine.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr double kClipSeconds = 0.1;
+constexpr int kOffsetsMs[] = {200, 400, 600, 800};
+// 补偿后的残余误差上限：播放线程唤醒 + 渲染线程半块睡眠的抖动，单核未优化构建留出余量
+constexpr double kMaxResidualMs = 15.0;
+// 估计（设备延迟 + 排队量 + 半块）与起播观测、逐采样测得的出声延迟之差：估计取平均半块，
+// 实际等到下一次补写的时长在 0～一块（10 ms）之间，另加 play() 本身与渲染线程的调度
+constexpr double kMaxEstimateErrorMs = 10.0;
+// 播放线程统计的残余误差与 WAV 后端逐采样测得值之差
+constexpr double kMaxProfileErrorMs = 5.0;
+
+using bench::fail;
+
+struct Residuals {
+    bool ok = false;
+    double meanMs = 0.0;
+    double maxAbsMs = 0.0;
+    double meanOnsetMs = 0.0;  // play() 到首帧出声（WAV 后端逐采样测得）
+    EngineStats stats;
+};
+
+// 播一遍四条指令：首帧出声时刻（WAV 后端设备时间）相对 playTime 的误差
+Residuals runSession(WavSinkBackend& backend, bool compensate) {
+    AudioPlayer::setLatencyCompensation(compensate);
+    AudioPlayerSink sink;
+    PlaybackEngine engine(Clock::system(), sink);
+    engine.start();
+    // 两个时钟的对应关系：playTime 为墙钟，WAV 后端的出声时刻为 steady_clock
+    const auto steadyAnchor = steady_clock::now();
+    const auto systemAnchor = system_clock::now();
+    const auto base = time_point_cast<milliseconds>(systemAnchor);
+    std::vector<Instruction> instructions;
+    for (size_t i = 0; i < std::size(kOffsetsMs); ++i) {
+        Instruction instruction;
+        instruction.subjectId = 1;
+        instruction.subjectName = "英语";
+        instruction.name = "指令" + std::to_string(i + 1);
+        instruction.audioFile = "clip" + std::to_string(i + 1) + ".wav";
+        instruction.playTime = base + milliseconds(kOffsetsMs[i]);
+        instructions.push_back(instruction);
+    }
+    const size_t firstEvent = backend.getEvents().size();
+    engine.addInstructions(instructions);
+    std::this_thread::sleep_until(base + milliseconds(kOffsetsMs[std::size(kOffsetsMs) - 1] + 300));
+    Residuals result;
+    result.stats = engine.getStats();
+    engine.stop();
+
+    const std::vector<WavSinkEvent> events = backend.getEvents();
+    if (events.size() != firstEvent + instructions.size()) {
+        return result;
+    }
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const WavSinkEvent& event = events[firstEvent + i];
+        if (!event.started) {
+            return result;
+        }
+        const double audibleMs =
+            duration<double, std::milli>(event.requestTime - steadyAnchor).count() + event.onsetLatencyMs;
+        const double plannedMs = duration<double, std::milli>(instructions[i].playTime - systemAnchor).count();
+        const double residual = audibleMs - plannedMs;
+        result.meanMs += residual / instructions.size();
+        result.maxAbsMs = std::max(result.maxAbsMs, std::fabs(residual));
+        result.meanOnsetMs += event.onsetLatencyMs / instructions.size();
+    }
+    result.ok = true;
+    return result;
+}
+
+int checkDevices(const std::vector<WavSinkDevice>& devices, const char* label) {
+    WavSinkOptions options;
+    options.sampleRate = kRate;
+    options.writeEventLog = false;
+    options.devices = devices;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    if (!AudioPlayer::initialize()) {
+        AudioPlayer::setBackend(nullptr);
+        return fail("WAV 后端初始化失败");
+    }
+    // 等渲染线程填满排队量（稳态）再起播
+    std::this_thread::sleep_for(milliseconds(100));
+    const OutputLatencyProfile estimated = AudioPlayer::getOutputLatencyProfile();
+
+    const Residuals off = runSession(*backend, false);
+    const Residuals on = runSession(*backend, true);
+    const OutputLatencyProfile observed = AudioPlayer::getOutputLatencyProfile();
+    AudioPlayer::cleanup();
+    AudioPlayer::setLatencyCompensation(true);
+    AudioPlayer::setBackend(nullptr);
+
+    std::printf("  %s: device %.1f ms + queue %.1f ms = estimate %.1f ms; %zu starts observed %.1f +/- %.1f ms\n",
+                label, estimated.deviceMs, estimated.queueMs, estimated.estimateMs(), observed.samples,
+                observed.measuredMs, observed.jitterMs);
+    std::printf("    compensation off: residual mean %+7.2f ms, max |%.2f| ms (play->audible %.2f ms)\n", off.meanMs,
+                off.maxAbsMs, off.meanOnsetMs);
+    std::printf("    compensation on : residual mean %+7.2f ms, max |%.2f| ms, lead %.2f ms, engine residual "
+                "last %+.2f / max %.2f ms (%llu)\n",
+                on.meanMs, on.maxAbsMs, on.stats.outputCompensationMs, on.stats.lastResidualMs, on.stats.maxResidualMs,
+                static_cast<unsigned long long>(on.stats.residualSamples));
+
+    int failures = 0;
+    double deviceMs = 0.0;
+    for (const auto& device : devices) {
+        deviceMs = std::max(deviceMs, device.latencyMs);
+    }
+    if (std::fabs(estimated.deviceMs - deviceMs) > 0.1) {
+        failures += fail("档案的设备延迟与后端报告不符");
+    }
+    // 播放线程反复轮询出声时刻，每条按时刻起播的指令仍只记一次；观测不改变提前量
+    if (observed.samples != 2 * std::size(kOffsetsMs) ||
+        std::fabs(observed.measuredMs - estimated.estimateMs()) > kMaxEstimateErrorMs) {
+        failures += fail("起播观测次数不对或与估计相差过大");
+    }
+    if (observed.estimateMs() != estimated.estimateMs()) {
+        failures += fail("起播观测不应改变提前量");
+    }
+    if (!off.ok || !on.ok) {
+        return failures + fail("每条指令都应在 WAV 后端留下已出声的记录");
+    }
+    // 不补偿时首帧晚到约 play() 到出声的延迟；补偿后只剩抖动
+    if (off.meanMs < deviceMs || std::fabs(off.meanMs - off.meanOnsetMs) > kMaxResidualMs) {
+        failures += fail("不补偿时的残余误差应约为输出延迟");
+    }
+    if (on.maxAbsMs > kMaxResidualMs) {
+        failures += fail("补偿后首帧未落在计划时刻");
+    }
+    // 提前量取自报告的设备延迟 + 排队量，应与逐采样测得的 play() 到出声一致
+    if (std::fabs(on.stats.outputCompensationMs - off.meanOnsetMs) > kMaxEstimateErrorMs) {
+        failures += fail("提前量与实际输出延迟不符");
+    }
+    if (on.stats.residualSamples != std::size(kOffsetsMs) ||
+        std::fabs(on.stats.maxResidualMs - on.maxAbsMs) > kMaxProfileErrorMs) {
+        failures += fail("播放线程统计的残余误差与 WAV 后端测量值不符");
+    }
+    return failures;
+}
+}  // namespace
+
+int benchOutputLatency() {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "evcs-bench-output-latency";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    for (size_t i = 0; i < std::size(kOffsetsMs); ++i) {
+        bench::writeSine(dir / ("clip" + std::to_string(i + 1) + ".wav"), kRate, kClipSeconds);
+    }
+    PathUtil::setAudioDir(dir);
+
+    int failures = 0;
+    failures += checkDevices({{"USB", {}, 30.0}}, "one device ");
+    failures += checkDevices({{"板载", {}, 12.0}, {"HDMI", {}, 55.0}}, "two devices");
+
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -0,0 +1,313 @@
+// PCM 内核基准：
+//  1) 逐位一致：各 SIMD 级别的每个内核与标量参考在随机输入（含越界、取整边界、各种长度与不对齐起点）上
+//     输出逐字节相同，含原地调用；
+//  2) 吞吐：每个内核各级别的 GB/s；
+//  3) 混音器：8 路声部（含闪避过渡、变采样）按标量与最佳内核各混 20 秒，逐块输出逐字节相同，对照每块开销。
+#include "AudioMixer.h"
+#include "BenchUtil.h"
+#include "PcmKernels.h"
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr size_t kThroughputSamples = 1 << 20;
+constexpr int kThroughputRounds = 50;
+// 最佳内核相对标量的混音开销：不应更慢（留 25% 给计时抖动）
+constexpr double kMaxMixCostRatio = 1.25;
+
+using bench::fail;
+
+std::vector<SimdLevel> supportedKernels() {
+    std::vector<SimdLevel> kernels;
+    for (SimdLevel kernel : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (CpuFeatures::supports(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+// 随机采样：大部分在 [-1.5, 1.5]，夹杂恰在边界与 int16 取整的半步处的值
+std::vector<float> randomFloats(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> value(-1.5f, 1.5f);
+    std::uniform_int_distribution<int> pick(0, 15);
+    std::uniform_int_distribution<int> level(-32768, 32767);
+    std::vector<float> samples(count);
+    for (float& sample : samples) {
+        switch (pick(rng)) {
+        case 0: sample = 1.0f; break;
+        case 1: sample = -1.0f; break;
+        case 2: sample = (static_cast<float>(level(rng)) + 0.5f) / 32767.0f; break;
+        default: sample = value(rng); break;
+        }
+    }
+    return samples;
+}
+
+template <typename T>
+bool sameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// 一个级别对标量：每个长度、每个不对齐起点都逐字节比较。返回不一致的用例数
+size_t compareKernels(const PcmKernels& ref, const PcmKernels& test, size_t& cases) {
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> level(-32768, 32767);
+    size_t mismatches = 0;
+    std::vector<size_t> lengths;
+    for (size_t n = 0; n <= 70; ++n) {
+        lengths.push_back(n);
+    }
+    lengths.push_back(441);
+    lengths.push_back(4099);
+    for (size_t length : lengths) {
+        for (size_t offset = 0; offset < 4; ++offset) {
+            const size_t count = length * 2;  // 立体声内核按帧，其余按采样
+            std::vector<float> in = randomFloats(count + offset, rng);
+            std::vector<float> base = randomFloats(count + offset, rng);
+            std::vector<int16_t> pcm(count + offset);
+            for (auto& sample : pcm) {
+                sample = static_cast<int16_t>(level(rng));
+            }
+            const float gain = 0.7071f;
+            const float start = 0.25f;
+            const float step = 0.75f / static_cast<float>(std::max<size_t>(length, 1));
+
+            auto check = [&](bool same) {
+                ++cases;
+                mismatches += same ? 0 : 1;
+            };
+            {
+                std::vector<float> a(count + offset), b(count + offset);
+                ref.int16ToFloat(pcm.data() + offset, a.data() + offset, count);
+                test.int16ToFloat(pcm.data() + offset, b.data() + offset, count);
+                check(sameBytes(a, b));
+            }
+            {
+                std::vector<int16_t> a(count + offset), b(count + offset);
+                ref.floatToInt16(in.data() + offset, a.data() + offset, count);
+                test.floatToInt16(in.data() + offset, b.data() + offset, count);
+                check(sameBytes(a, b));
+            }
+            {
+                std::vector<float> a = base, b = base;
+                ref.scale(a.data() + offset, count, gain);
+                test.scale(b.data() + offset, count, gain);
+                check(sameBytes(a, b));
+            }
+            {
+                std::vector<float> a = base, b = base;
+                ref.mixAdd(a.data() + offset, in.data() + offset, count, gain);
+                test.mixAdd(b.data() + offset, in.data() + offset, count, gain);
+                check(sameBytes(a, b));
+            }
+            {
+                std::vector<float> a = base, b = base;
+                ref.mixAddRamp(a.data() + offset, in.data() + offset, length, start, step);
+                test.mixAddRamp(b.data() + offset, in.data() + offset, length, start, step);
+                check(sameBytes(a, b));
+            }
+            {
+                std::vector<float> a = base, b = base;
+                ref.clamp(a.data() + offset, count);
+                test.clamp(b.data() + offset, count);
+                check(sameBytes(a, b));
+            }
+            {
+                std::vector<float> a(count + offset), b(count + offset);
+                ref.monoToStereo(in.data() + offset, a.data() + offset, length);
+                test.monoToStereo(in.data() + offset, b.data() + offset, length);
+                check(sameBytes(a, b));
+                // 原地展开：单声道放在后半段
+                std::vector<float> c(count + offset), d(count + offset);
+                std::memcpy(c.data() + offset + length, in.data(), length * sizeof(float));
+                std::memcpy(d.data() + offset + length, in.data(), length * sizeof(float));
+                ref.monoToStereo(c.data() + offset + length, c.data() + offset, length);
+                test.monoToStereo(d.data() + offset + length, d.data() + offset, length);
+                check(sameBytes(c, d));
+            }
+            {
+                std::vector<float> a(length + offset), b(length + offset);
+                ref.stereoToMono(in.data() + offset, a.data() + offset, length);
+                test.stereoToMono(in.data() + offset, b.data() + offset, length);
+                check(sameBytes(a, b));
+                std::vector<float> c = in, d = in;
+                ref.stereoToMono(c.data() + offset, c.data() + offset, length);
+                test.stereoToMono(d.data() + offset, d.data() + offset, length);
+                check(sameBytes(c, d));
+            }
+        }
+    }
+    return mismatches;
+}
+
+int checkBitExact() {
+    const PcmKernels& ref = PcmKernels::get(SimdLevel::SCALAR);
+    int failures = 0;
+    for (SimdLevel kernel : supportedKernels()) {
+        if (kernel == SimdLevel::SCALAR) {
+            continue;
+        }
+        size_t cases = 0;
+        size_t mismatches = compareKernels(ref, PcmKernels::get(kernel), cases);
+        std::printf("  bit-exact %-6s vs scalar: %zu cases, %zu mismatches\n", CpuFeatures::name(kernel), cases,
+                    mismatches);
+        if (mismatches > 0) {
+            failures += fail("SIMD 内核与标量参考不一致");
+        }
+    }
+    // 参考值抽查：取整就近取偶、越界限幅
+    const float probe[] = {0.5f / 32767.0f, 1.5f / 32767.0f, 2.0f, -2.0f, -1.0f, 32766.5f / 32767.0f};
+    int16_t rounded[6];
+    ref.floatToInt16(probe, rounded, 6);
+    const int16_t pcm[] = {-32768, 32767};
+    float converted[2];
+    ref.int16ToFloat(pcm, converted, 2);
+    if (rounded[0] != 0 || rounded[1] != 2 || rounded[2] != 32767 || rounded[3] != -32767 || rounded[4] != -32767 ||
+        converted[0] != -1.0f || converted[1] != 32767.0f / 32768.0f) {
+        failures += fail("标量参考的取整或限幅不符");
+    }
+    return failures;
+}
+
+void measureThroughput() {
+    std::mt19937 rng(5);
+    std::vector<float> in = randomFloats(kThroughputSamples, rng);
+    std::vector<float> out(kThroughputSamples, 0.0f);
+    std::vector<int16_t> pcm(kThroughputSamples);
+    PcmKernels::get(SimdLevel::SCALAR).floatToInt16(in.data(), pcm.data(), pcm.size());
+
+    struct Row {
+        const char* name;
+        double bytesPerSample;  // 读 + 写
+        void (*run)(const PcmKernels&, std::vector<float>&, std::vector<float>&, std::vector<int16_t>&);
+    };
+    const Row rows[] = {
+        {"int16->float", 6.0, [](const PcmKernels& k, std::vector<float>&, std::vector<float>& o,
+                                 std::vector<int16_t>& p) { k.int16ToFloat(p.data(), o.data(), p.size()); }},
+        {"float->int16", 6.0, [](const PcmKernels& k, std::vector<float>& i, std::vector<float>&,
+                                 std::vector<int16_t>& p) { k.floatToInt16(i.data(), p.data(), i.size()); }},
+        {"scale", 8.0, [](const PcmKernels& k, std::vector<float>&, std::vector<float>& o,
+                          std::vector<int16_t>&) { k.scale(o.data(), o.size(), 0.999f); }},
+        {"mix-add", 12.0, [](const PcmKernels& k, std::vector<float>& i, std::vector<float>& o,
+                             std::vector<int16_t>&) { k.mixAdd(o.data(), i.data(), i.size(), 0.5f); }},
+        {"mix-add ramp", 12.0, [](const PcmKernels& k, std::vector<float>& i, std::vector<float>& o,
+                                  std::vector<int16_t>&) {
+             k.mixAddRamp(o.data(), i.data(), i.size() / 2, 0.25f, 1e-7f);
+         }},
+        {"clamp", 8.0, [](const PcmKernels& k, std::vector<float>&, std::vector<float>& o,
+                          std::vector<int16_t>&) { k.clamp(o.data(), o.size()); }},
+        {"mono->stereo", 6.0, [](const PcmKernels& k, std::vector<float>& i, std::vector<float>& o,
+                                 std::vector<int16_t>&) { k.monoToStereo(i.data(), o.data(), i.size() / 2); }},
+        {"stereo->mono", 6.0, [](const PcmKernels& k, std::vector<float>& i, std::vector<float>& o,
+                                 std::vector<int16_t>&) { k.stereoToMono(i.data(), o.data(), i.size() / 2); }},
+    };
+    std::printf("  throughput (GB/s, %zu samples x %d rounds):\n   %-14s", kThroughputSamples, kThroughputRounds, "");
+    const std::vector<SimdLevel> kernels = supportedKernels();
+    for (SimdLevel kernel : kernels) {
+        std::printf(" %8s", CpuFeatures::name(kernel));
+    }
+    std::printf("\n");
+    for (const Row& row : rows) {
+        std::printf("   %-14s", row.name);
+        for (SimdLevel kernel : kernels) {
+            const PcmKernels& kernels = PcmKernels::get(kernel);
+            std::fill(out.begin(), out.end(), 0.0f);
+            bench::Stopwatch watch;
+            for (int round = 0; round < kThroughputRounds; ++round) {
+                row.run(kernels, in, out, pcm);
+            }
+            const double ms = watch.elapsedMs();
+            std::printf(" %8.2f", row.bytesPerSample * kThroughputSamples * kThroughputRounds / ms / 1e6);
+        }
+        std::printf("\n");
+    }
+}
+
+std::shared_ptr<const PcmBuffer> makeTone(double seconds, double frequency, uint32_t rate) {
+    auto buffer = std::make_shared<PcmBuffer>();
+    buffer->sampleRate = rate;
+    const size_t frames = static_cast<size_t>(seconds * rate);
+    buffer->samples.resize(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        const float value = 0.2f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * frequency * i / rate));
+        buffer->samples[i * 2] = value;
+        buffer->samples[i * 2 + 1] = -value;
+    }
+    return buffer;
+}
+
+struct MixRun {
+    std::vector<float> output;
+    double avgUs = 0.0;
+};
+
+// 8 路：一路前台闪避其余，中途切换优先级与增益，产生块内过渡；半数 48 kHz 变采样
+MixRun runMixer(SimdLevel kernel) {
+    MixerConfig config;
+    config.kernel = kernel;
+    AudioMixer mixer(config);
+    std::vector<AudioMixer::VoiceHandle> handles;
+    for (size_t i = 0; i < 8; ++i) {
+        const uint32_t rate = i % 2 == 0 ? kRate : 48000;
+        std::unique_ptr<MixerSource> source = std::make_unique<PcmBufferSource>(makeTone(25.0, 220.0 + 55.0 * i, rate));
+        if (rate != kRate) {
+            source = std::make_unique<ResamplingSource>(std::move(source), rate, kRate);
+        }
+        handles.push_back(mixer.play(std::move(source), i == 0 ? AudioMixer::PRIORITY_FOREGROUND
+                                                               : AudioMixer::PRIORITY_NORMAL,
+                                     0.6f + 0.05f * static_cast<float>(i)));
+    }
+    const size_t blocks = 2000;  // 20 秒音频
+    MixRun run;
+    run.output.resize(blocks * config.blockFrames * 2);
+    for (size_t b = 0; b < blocks; ++b) {
+        if (b == 500) {
+            mixer.setPriority(handles[0], AudioMixer::PRIORITY_NORMAL);  // 闪避恢复
+        } else if (b == 1000) {
+            mixer.setPriority(handles[3], AudioMixer::PRIORITY_FOREGROUND);
+        } else if (b == 1500) {
+            mixer.setGain(handles[5], 0.1f);
+            mixer.stop(handles[3]);  // 淡出
+        }
+        mixer.render(run.output.data() + b * config.blockFrames * 2, config.blockFrames);
+    }
+    run.avgUs = mixer.getStats().avgCostUs;
+    mixer.stopAll();
+    return run;
+}
+
+int checkMixer() {
+    const SimdLevel best = CpuFeatures::best();
+    MixRun scalar = runMixer(SimdLevel::SCALAR);
+    MixRun fast = runMixer(best);
+    // 第二次再测一遍取较小值，减少首轮缓存与频率爬升的影响
+    scalar.avgUs = std::min(scalar.avgUs, runMixer(SimdLevel::SCALAR).avgUs);
+    fast.avgUs = std::min(fast.avgUs, runMixer(best).avgUs);
+    const bool same = sameBytes(scalar.output, fast.output);
+    std::printf("  mixer 8 voices, 20 s: scalar %.2f us/block, %s %.2f us/block (%.2fx), output %s\n", scalar.avgUs,
+                CpuFeatures::name(best), fast.avgUs, fast.avgUs > 0.0 ? scalar.avgUs / fast.avgUs : 0.0,
+                same ? "bit-identical" : "DIFFERS");
+    int failures = 0;
+    if (!same) {
+        failures += fail("混音器换用 SIMD 内核后输出改变");
+    }
+    if (fast.avgUs > scalar.avgUs * kMaxMixCostRatio) {
+        failures += fail("SIMD 内核混音比标量更慢");
+    }
+    return failures;
+}
+}  // namespace
+
+int benchPcmKernels() {
+    std::printf("  best kernel on this CPU: %s\n", CpuFeatures::name(CpuFeatures::best()));
+    int failures = checkBitExact();
+    measureThroughput();
+    failures += checkMixer();
+    return failures;
+}
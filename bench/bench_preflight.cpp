@@ -0,0 +1,293 @@
+// 完整解码预检基准：临时目录下生成正常、截断（data 块头记录的长度超出文件）、削波、单点满幅、
+// 无法识别、后端不支持（ADPCM WAV）的素材，另加一个缺失文件，校验各自的结论与解码时长；
+// 随后对约 40 MB 的素材分别以 1 个线程与 CPU 核数个线程完整解码，报告墙钟耗时与加速比；
+// 最后校验后台检查的完成回调与取消。文件紧接生成之后读取，多在页缓存中。
+#include "AudioPreflight.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr double kPi = 3.14159265358979323846;
+// 吞吐部分的素材：长短不一的立体声 16 位 WAV，合计约 40 MB
+constexpr size_t kThroughputFiles = 24;
+constexpr double kMinSeconds = 4.0;
+constexpr double kMaxSeconds = 16.0;
+// 解码时长与写入时长之差的容许量
+constexpr double kDurationSlack = 1e-3;
+
+using bench::fail;
+
+// 立体声 16 位正弦：amplitude 大于 1 时波峰被限在满幅（削波）。
+// 写入 frames 帧，文件头记录 declaredFrames 帧（0 表示与写入一致；多于写入时模拟拷贝不完整）
+void writeSineWav(const std::filesystem::path& path, size_t frames, double amplitude, size_t declaredFrames = 0) {
+    const auto declaredBytes = static_cast<uint32_t>((declaredFrames > 0 ? declaredFrames : frames) * 4);
+    std::vector<char> out = bench::wavHeader(1, kRate, 2, 16, declaredBytes);
+    out.reserve(out.size() + frames * 4);
+    for (size_t i = 0; i < frames; ++i) {
+        double value = amplitude * std::sin(2.0 * kPi * 440.0 * static_cast<double>(i) / kRate);
+        value = std::clamp(value, -1.0, 1.0);
+        auto sample = static_cast<int16_t>(std::lround(value * 32767.0));
+        bench::appendLe(out, static_cast<uint16_t>(sample), 2);
+        bench::appendLe(out, static_cast<uint16_t>(sample), 2);
+    }
+    bench::writeFile(path, out);
+}
+
+// 低电平噪声中只有一个满幅采样：峰值为满幅，但不构成削波
+void writeSinglePeakWav(const std::filesystem::path& path, size_t frames) {
+    std::vector<int16_t> samples;
+    samples.reserve(frames * 2);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> noise(-3000, 3000);
+    for (size_t i = 0; i < frames; ++i) {
+        const int16_t left = i == frames / 2 ? 32767 : static_cast<int16_t>(noise(rng));
+        samples.push_back(left);
+        samples.push_back(static_cast<int16_t>(noise(rng)));
+    }
+    bench::writeWav(path, kRate, 2, samples);
+}
+
+// IMA ADPCM（formatTag 0x11）：文件头可识别，可移植解码不支持
+void writeAdpcmWav(const std::filesystem::path& path, size_t bytes) {
+    std::vector<char> out;
+    out.insert(out.end(), {'R', 'I', 'F', 'F'});
+    bench::appendLe(out, static_cast<uint32_t>(36 + bytes), 4);
+    out.insert(out.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    bench::appendLe(out, 16, 4);
+    bench::appendLe(out, 0x11, 2);
+    bench::appendLe(out, 1, 2);
+    bench::appendLe(out, kRate, 4);
+    bench::appendLe(out, kRate / 2, 4);
+    bench::appendLe(out, 512, 2);
+    bench::appendLe(out, 4, 2);
+    out.insert(out.end(), {'d', 'a', 't', 'a'});
+    bench::appendLe(out, static_cast<uint32_t>(bytes), 4);
+    out.resize(out.size() + bytes, 0);
+    bench::writeFile(path, out);
+}
+
+void writeGarbage(const std::filesystem::path& path, size_t bytes) {
+    std::mt19937 rng(11);
+    std::vector<char> out(bytes);
+    for (auto& byte : out) {
+        byte = static_cast<char>(rng());
+    }
+    bench::writeFile(path, out);
+}
+
+const PreflightResult* findResult(const PreflightReport& report, const std::string& file) {
+    for (const auto& result : report.results) {
+        if (result.file == file) {
+            return &result;
+        }
+    }
+    return nullptr;
+}
+
+void printReport(const char* label, const PreflightReport& report) {
+    std::printf("  %-22s %3zu files, decoded %3zu (%7.1f s audio), %2zu thr  %8.2f ms wall  %8.2f ms decode  "
+                "parallelism %4.1fx",
+                label, report.files, report.decodedFiles, report.decodedSeconds, report.threads, report.elapsedMs,
+                report.decodeMs, report.elapsedMs > 0.0 ? report.decodeMs / report.elapsedMs : 0.0);
+    if (report.elapsedMs > 0.0) {
+        std::printf("  %6.0f x realtime", report.decodedSeconds * 1000.0 / report.elapsedMs);
+    }
+    std::printf("\n");
+}
+
+// 各类问题的检出与结论
+int checkProblems(const std::filesystem::path& dir, const AudioPreflight::Decoder& decoder) {
+    int failures = 0;
+    const size_t goodFrames = kRate * 3 + 17;
+    writeSineWav(dir / "good.wav", goodFrames, 0.5);
+    writeSineWav(dir / "truncated.wav", kRate * 6, 0.5, kRate * 10);
+    writeSineWav(dir / "clipped.wav", kRate * 2, 1.5);
+    writeSinglePeakWav(dir / "peak.wav", kRate);
+    writeAdpcmWav(dir / "adpcm.wav", kRate);
+    writeGarbage(dir / "garbage.wav", 64 * 1024);
+
+    AudioPreflight preflight;
+    preflight.setDecoder(decoder);
+    // 重复引用的文件只检查一次，结果按首次出现的顺序排列
+    const std::vector<std::string> files = {"good.wav",  "truncated.wav", "clipped.wav", "peak.wav", "good.wav",
+                                            "adpcm.wav", "garbage.wav",   "missing.wav"};
+    const PreflightReport report = preflight.run(files);
+    std::printf("%s", AudioPreflight::formatReport(report).c_str());
+
+    struct Expected {
+        const char* file;
+        PreflightProblem problem;
+        bool decoded;
+    };
+    const Expected expected[] = {
+        {"good.wav", PreflightProblem::NONE, true},
+        {"truncated.wav", PreflightProblem::TRUNCATED, true},
+        {"clipped.wav", PreflightProblem::CLIPPED, true},
+        {"peak.wav", PreflightProblem::NONE, true},
+        {"adpcm.wav", PreflightProblem::NONE, false},
+        {"garbage.wav", PreflightProblem::UNDECODABLE, false},
+        {"missing.wav", PreflightProblem::MISSING, false},
+    };
+    if (report.files != std::size(expected) || report.results.size() != std::size(expected) || !report.complete) {
+        failures += fail("重复文件未去重或检查未完成");
+    }
+    for (size_t i = 0; i < std::size(expected) && i < report.results.size(); ++i) {
+        const PreflightResult& result = report.results[i];
+        if (result.file != expected[i].file) {
+            failures += fail("结果未按输入顺序排列");
+            break;
+        }
+        if (result.problem != expected[i].problem || result.decoded != expected[i].decoded) {
+            std::printf("  %s: %s, decoded %d\n", result.file.c_str(), AudioPreflight::problemName(result.problem),
+                        result.decoded ? 1 : 0);
+            failures += fail("结论与预期不符");
+        }
+    }
+    if (report.problemFiles != 3 || report.clippedFiles != 1 || report.headerOnlyFiles != 1 ||
+        report.decodedFiles != 4) {
+        failures += fail("汇总计数与各文件结论不符");
+    }
+
+    const PreflightResult* good = findResult(report, "good.wav");
+    if (good && (std::fabs(good->decodedSeconds - static_cast<double>(goodFrames) / kRate) > kDurationSlack ||
+                 std::fabs(good->samplePeak - 0.5) > 0.01 || good->clippedSamples != 0)) {
+        failures += fail("正常文件的时长或峰值不符");
+    }
+    const PreflightResult* truncated = findResult(report, "truncated.wav");
+    if (truncated && (std::fabs(truncated->headerSeconds - 10.0) > kDurationSlack ||
+                      std::fabs(truncated->decodedSeconds - 6.0) > kDurationSlack)) {
+        std::printf("  truncated.wav: header %.3f s, decoded %.3f s\n", truncated->headerSeconds,
+                    truncated->decodedSeconds);
+        failures += fail("截断文件的声明时长或实际时长不符");
+    }
+    const PreflightResult* peak = findResult(report, "peak.wav");
+    if (peak && (peak->samplePeak < AudioPreflight::CLIP_LEVEL || peak->clippedSamples != 0)) {
+        failures += fail("单点满幅被误判为削波");
+    }
+
+    // 单个文件的检查与线程池一致
+    const PreflightResult single = AudioPreflight::checkFile("truncated.wav", decoder);
+    if (single.problem != PreflightProblem::TRUNCATED ||
+        AudioPreflight::checkFile("missing.wav", decoder).problem != PreflightProblem::MISSING) {
+        failures += fail("checkFile 与线程池结论不一致");
+    }
+    return failures;
+}
+
+// 1 个线程与 CPU 核数个线程完整解码同一批文件
+int checkThroughput(const std::filesystem::path& dir, const AudioPreflight::Decoder& decoder) {
+    int failures = 0;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> length(kMinSeconds, kMaxSeconds);
+    std::vector<std::string> files;
+    double totalSeconds = 0.0;
+    for (size_t i = 0; i < kThroughputFiles; ++i) {
+        const double seconds = length(rng);
+        char name[32];
+        std::snprintf(name, sizeof(name), "listening_%02zu.wav", i);
+        writeSineWav(dir / name, static_cast<size_t>(seconds * kRate), 0.3);
+        files.push_back(name);
+        totalSeconds += static_cast<size_t>(seconds * kRate) / static_cast<double>(kRate);
+    }
+    std::printf("  %zu files, %.1f s of audio, %.1f MB\n", files.size(), totalSeconds,
+                totalSeconds * kRate * 4 / (1024.0 * 1024.0));
+
+    AudioPreflight preflight;
+    preflight.setDecoder(decoder);
+    preflight.setThreads(1);
+    const PreflightReport serial = preflight.run(files);
+    const size_t threads = AudioPreflight::defaultThreads();
+    preflight.setThreads(threads);
+    const PreflightReport parallel = preflight.run(files);
+    printReport("1 thread:", serial);
+    printReport("pool:", parallel);
+    const double speedup = parallel.elapsedMs > 0.0 ? serial.elapsedMs / parallel.elapsedMs : 0.0;
+    std::printf("  speedup %.2fx on %zu threads\n", speedup, threads);
+
+    for (const PreflightReport* report : {&serial, &parallel}) {
+        if (!report->complete || report->decodedFiles != files.size() || report->problemFiles != 0 ||
+            report->clippedFiles != 0 || std::fabs(report->decodedSeconds - totalSeconds) > kDurationSlack * files.size()) {
+            failures += fail("吞吐素材的检查结果不符");
+        }
+    }
+    // 多核上线程池至少应明显快于单线程（素材在页缓存中，解码是计算与内存带宽密集的）
+    if (threads >= 4 && speedup < 1.5) {
+        failures += fail("线程池没有随核数加速");
+    }
+    return failures;
+}
+
+// 后台检查：完成回调带完整结果；取消后不回调
+int checkAsync(const AudioPreflight::Decoder& decoder) {
+    int failures = 0;
+    std::vector<std::string> files;
+    for (size_t i = 0; i < kThroughputFiles; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "listening_%02zu.wav", i);
+        files.push_back(name);
+    }
+
+    AudioPreflight preflight;
+    preflight.setDecoder(decoder);
+    std::mutex mutex;
+    std::condition_variable done;
+    bool called = false;
+    size_t decoded = 0;
+    preflight.runAsync(files, [&](const PreflightReport& report) {
+        std::lock_guard<std::mutex> lock(mutex);
+        called = true;
+        decoded = report.decodedFiles;
+        done.notify_all();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!done.wait_for(lock, std::chrono::seconds(30), [&]() { return called; }) || decoded != files.size()) {
+            failures += fail("后台检查未回调完整结果");
+        }
+    }
+    preflight.cancel();
+
+    bench::Stopwatch watch;
+    called = false;
+    preflight.runAsync(files, [&](const PreflightReport&) { called = true; });
+    preflight.cancel();
+    const double cancelMs = watch.elapsedMs();
+    const PreflightReport cancelled = preflight.getReport();
+    std::printf("  cancel: %zu/%zu files checked when cancelled, %.2f ms to start + cancel\n",
+                cancelled.checkedFiles, cancelled.files, cancelMs);
+    if (called || preflight.isRunning() || (!cancelled.cancelled && !cancelled.complete)) {
+        failures += fail("取消后仍回调或仍在运行");
+    }
+    return failures;
+}
+}  // namespace
+
+int benchPreflight() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-preflight";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    PathUtil::setAudioDir(dir);
+
+    WavSinkBackend backend;  // 只用其解码，不打开输出
+    const AudioPreflight::Decoder decoder = AudioPreflight::backendDecoder(backend);
+    int failures = checkProblems(dir, decoder);
+    failures += checkThroughput(dir, decoder);
+    failures += checkAsync(decoder);
+
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
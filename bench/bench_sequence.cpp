@@ -0,0 +1,238 @@
+// 组合指令基准：
+//  1) 配置解析：以 | 分隔的片段规范化为组合指令，非法片段整行拒绝，getAudioFiles 展开为片段；
+//  2) 音频库占用：两种前缀 x 四个分钟数的提示语，整句各存一个文件 vs 共用片段；
+//  3) AudioPlayer 接 WavSinkBackend 实时播放组合指令，输出与各片段首尾相接的参考逐采样一致（拼接处无空隙）；
+//  4) 起播耗时：组合指令（片段缓存 / 散文件）与单个文件（预载池 / 散文件）对照。
+// 实时运行，约 2 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "ClipSequence.h"
+#include "ConfigManager.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr double kPi = 3.14159265358979;
+constexpr int kPlays = 30;
+// 片段缓存命中时组合指令的起播耗时上限：只是几次查表与建 PCM 源，与单个文件同一量级
+constexpr double kMaxCachedSequenceMs = 2.0;
+
+using bench::fail;
+
+// 交错立体声正弦（帧数不是块长的整数倍，拼接处落在块中间）
+std::vector<float> tone(size_t frames, double frequency) {
+    std::vector<float> samples(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        samples[i * 2] = samples[i * 2 + 1] = static_cast<float>(0.3 * std::sin(2.0 * kPi * frequency * i / kRate));
+    }
+    return samples;
+}
+
+struct Clip {
+    const char* name;
+    size_t frames;
+    double frequency;
+};
+
+// 前缀（考前/结束前）、分钟数、后缀（分钟）
+const Clip kPrefixes[] = {{"kq.wav", 26011, 330.0}, {"jsq.wav", 28123, 350.0}};
+const Clip kNumbers[] = {{"5.wav", 15013, 440.0}, {"10.wav", 16217, 494.0}, {"12.wav", 17389, 523.0},
+                         {"15.wav", 16871, 587.0}};
+const Clip kSuffix = {"fz.wav", 13007, 660.0};
+
+std::vector<float> concat(const std::vector<const Clip*>& clips) {
+    std::vector<float> samples;
+    for (const Clip* clip : clips) {
+        std::vector<float> part = tone(clip->frames, clip->frequency);
+        samples.insert(samples.end(), part.begin(), part.end());
+    }
+    return samples;
+}
+
+int checkConfig(const std::filesystem::path& dir) {
+    const std::filesystem::path path = dir / "sequence.ini";
+    std::ofstream(path, std::ios::binary) << "[测试]\nduration=10\n"
+                                             "0=考前12分钟|kq.wav|12.wav|fz.wav\n"
+                                             "60=结束前5分钟| jsq.wav | 5.wav |fz.wav \n"
+                                             "120=开始考试|ks.wav\n"
+                                             "180=空片段|kq.wav||fz.wav\n"
+                                             "240=上跳|kq.wav|../x.wav\n"
+                                             "300=过多|a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q\n";
+    auto& configManager = ConfigManager::getInstance();
+    if (!configManager.loadConfig(PathUtil::toWide(path))) {
+        return fail("组合指令配置加载失败");
+    }
+    auto templates = configManager.getInstructionTemplates("测试");
+    auto files = configManager.getAudioFiles();
+    auto clips = configManager.getSequenceClips();
+    const bool parsed = templates.size() == 3 && templates[0].audioFile == "kq.wav|12.wav|fz.wav" &&
+                        templates[1].audioFile == "jsq.wav|5.wav|fz.wav" && templates[2].audioFile == "ks.wav";
+    const std::vector<std::string> expectedFiles = {"kq.wav", "12.wav", "fz.wav", "jsq.wav", "5.wav", "ks.wav"};
+    const std::vector<std::string> expectedClips = {"kq.wav", "12.wav", "fz.wav", "jsq.wav", "5.wav"};
+    std::printf("  config: %zu instructions kept (3 rejected), %zu files, %zu sequence clips\n", templates.size(),
+                files.size(), clips.size());
+    if (!parsed || files != expectedFiles || clips != expectedClips) {
+        return fail("组合指令解析、规范化或片段展开不符");
+    }
+    return 0;
+}
+
+// 整句文件库 vs 片段库的 PCM 字节数（压缩格式同比例）
+void reportFootprint() {
+    uint64_t whole = 0;
+    uint64_t shared = kSuffix.frames;
+    for (const Clip& prefix : kPrefixes) {
+        shared += prefix.frames;
+        for (const Clip& number : kNumbers) {
+            whole += prefix.frames + number.frames + kSuffix.frames;
+        }
+    }
+    for (const Clip& number : kNumbers) {
+        shared += number.frames;
+    }
+    const size_t variants = std::size(kPrefixes) * std::size(kNumbers);
+    const size_t pieces = std::size(kPrefixes) + std::size(kNumbers) + 1;
+    std::printf("  library: %zu whole-sentence files %.2f MB vs %zu shared clips %.2f MB (%.0f%% smaller)\n",
+                variants, whole * 8 / 1e6, pieces, shared * 8 / 1e6, 100.0 * (1.0 - double(shared) / whole));
+}
+
+struct Timing {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double max = 0.0;
+};
+
+Timing measure(const std::string& filename, bool& ok) {
+    std::vector<double> samples;
+    for (int i = 0; i < kPlays; ++i) {
+        AudioPlayer::stop();
+        std::this_thread::sleep_for(milliseconds(3));
+        ok = AudioPlayer::playAudioFile(filename) && ok;
+        samples.push_back(AudioPlayer::getLastStartLatencyMs());
+    }
+    AudioPlayer::stop();
+    std::sort(samples.begin(), samples.end());
+    Timing timing;
+    for (double sample : samples) {
+        timing.mean += sample / samples.size();
+    }
+    timing.p50 = samples[samples.size() / 2];
+    timing.max = samples.back();
+    return timing;
+}
+}  // namespace
+
+int benchSequence() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-sequence";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    for (const Clip* clip : {&kPrefixes[0], &kPrefixes[1], &kNumbers[0], &kNumbers[1], &kNumbers[2], &kNumbers[3],
+                             &kSuffix}) {
+        bench::writeWav(dir / clip->name, kRate, 2, tone(clip->frames, clip->frequency));
+    }
+    const std::vector<float> reference = concat({&kPrefixes[0], &kNumbers[2], &kSuffix});
+    bench::writeWav(dir / "kq12.wav", kRate, 2, reference);  // 同一句话整句存一个文件，作单文件对照
+    PathUtil::setAudioDir(dir);
+
+    int failures = checkConfig(dir);
+    reportFootprint();
+
+    WavSinkOptions options;
+    options.path = dir / "out.wav";
+    options.sampleRate = kRate;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    AudioPlayer::setTrimLeadingSilence(false);
+    if (!AudioPlayer::initialize()) {
+        AudioPlayer::setBackend(nullptr);
+        PathUtil::setAudioDir({});
+        return failures + fail("WAV 后端初始化失败");
+    }
+
+    // 拼接：从片段缓存播放一次，输出与参考逐采样比较
+    const std::string sequence = "kq.wav|12.wav|fz.wav";
+    AssetPoolStats cache = AudioPlayer::loadClipCache(ClipSequence::split(sequence),
+                                                      AudioPlayer::CLIP_CACHE_BUDGET_BYTES);
+    std::this_thread::sleep_for(milliseconds(100));
+    const bool played = AudioPlayer::playAudioFile(sequence);
+    const double seconds = AudioPlayer::getCurrentStreamDuration();
+    std::this_thread::sleep_for(duration<double>(seconds + 0.15));
+
+    // 起播耗时：组合指令（片段缓存命中）、单个文件（预载池 PCM 命中），再清空后两者都走散文件
+    bool ok = true;
+    AudioPlayer::loadAssetPool({"kq12.wav"}, AssetPolicy::PCM, 64ull * 1024 * 1024);
+    Timing cachedSequence = measure(sequence, ok);
+    Timing pooledSingle = measure("kq12.wav", ok);
+    AudioPlayer::loadClipCache({}, 0);
+    AudioPlayer::loadAssetPool({}, AssetPolicy::PCM, 0);
+    Timing coldSequence = measure(sequence, ok);
+    Timing coldSingle = measure("kq12.wav", ok);
+    AudioPlayer::cleanup();
+
+    std::vector<WavSinkEvent> events = backend->getEvents();
+    std::ifstream file(options.path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    AudioFormatInfo info;
+    if (!played || cache.pcmFiles != 3 || events.empty() || !events[0].finished ||
+        !AudioHeaderParser::probeMemory(wav.data(), wav.size(), info)) {
+        failures += fail("组合指令未能从片段缓存播放");
+    } else {
+        const size_t frames = reference.size() / 2;
+        const uint64_t start = events[0].startFrame;
+        float worst = 0.0f;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            const uint64_t offset = info.dataOffset + (start * 2 + i) * sizeof(float);
+            float sample = 0.0f;
+            if (offset + sizeof(float) <= wav.size()) {
+                std::memcpy(&sample, wav.data() + offset, sizeof(sample));
+            } else {
+                worst = 1.0f;
+                break;
+            }
+            worst = std::max(worst, std::fabs(sample - reference[i]));
+        }
+        std::printf("  gapless: %zu frames (%.3f s reported), %llu frames played, max deviation from reference %.2g\n",
+                    frames, seconds, static_cast<unsigned long long>(events[0].endFrame - events[0].startFrame),
+                    worst);
+        if (worst > 1e-6f || events[0].endFrame - events[0].startFrame != frames ||
+            std::fabs(seconds - static_cast<double>(frames) / kRate) > 1e-3) {
+            failures += fail("拼接处有空隙或内容不符");
+        }
+    }
+
+    std::printf("  onset (ms, mean / p50 / max over %d plays):\n", kPlays);
+    std::printf("    sequence, clip cache    %7.3f / %7.3f / %7.3f\n", cachedSequence.mean, cachedSequence.p50,
+                cachedSequence.max);
+    std::printf("    single,   asset pool    %7.3f / %7.3f / %7.3f\n", pooledSingle.mean, pooledSingle.p50,
+                pooledSingle.max);
+    std::printf("    sequence, loose files   %7.3f / %7.3f / %7.3f\n", coldSequence.mean, coldSequence.p50,
+                coldSequence.max);
+    std::printf("    single,   loose file    %7.3f / %7.3f / %7.3f\n", coldSingle.mean, coldSingle.p50,
+                coldSingle.max);
+    if (!ok) {
+        failures += fail("起播失败");
+    }
+    if (cachedSequence.p50 > kMaxCachedSequenceMs) {
+        failures += fail("片段缓存命中时组合指令起播过慢");
+    }
+
+    AudioPlayer::setBackend(nullptr);
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -0,0 +1,294 @@
+// 开头静音裁剪基准：标量/SSE2/AVX2 扫描内核的一致性与吞吐，分段喂入与一次扫描一致，
+// 以及经 AudioPlayer（WAV 后端）后台分析 -> 元数据缓存 -> 起播裁剪 -> 输出中首个非静音采样位置的整条路径
+// （冷启动、预热、预载池三条建源路径与关闭裁剪对照）。整条路径实时播放约 3 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "SilenceScanner.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kToneSeconds = 0.3;
+constexpr double kThroughputSeconds = 60.0;
+constexpr int kThroughputRounds = 20;
+// 分析得出的开头静音与实际值之差：同采样率为 0，变采样时线性插值可能提前一帧
+constexpr double kMaxLeadingErrorMs = 1.0;
+// 输出中首个非静音采样相对声部首帧的位置与 TRIM_PREROLL_SECONDS 之差
+constexpr double kMaxOutputErrorMs = 1.0;
+
+using bench::fail;
+
+std::vector<SimdLevel> supportedKernels() {
+    std::vector<SimdLevel> kernels;
+    for (SimdLevel kernel : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (CpuFeatures::supports(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+float threshold() {
+    return static_cast<float>(std::pow(10.0, SilenceScanner::THRESHOLD_DBFS / 20.0));
+}
+
+// 各内核在不同位置（块边界前后、尾部零头、恰在门限、负值）的结果与标量一致，并测吞吐
+int checkKernels() {
+    int failures = 0;
+    const float limit = threshold();
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dither(-limit * 0.5f, limit * 0.5f);
+    std::vector<float> noise(4099);
+    for (float& sample : noise) {
+        sample = dither(rng);
+    }
+    const size_t positions[] = {0, 1, 3, 4, 15, 16, 17, 31, 32, 33, 63, 64, 1000, 4064, 4095, 4098};
+    size_t mismatches = 0;
+    size_t cases = 0;
+    for (SimdLevel kernel : supportedKernels()) {
+        for (size_t position : positions) {
+            for (float value : {limit * 2.0f, -limit * 2.0f, limit}) {
+                std::vector<float> samples = noise;
+                samples[position] = value;
+                size_t expected = value == limit ? samples.size() : position;  // 恰在门限不算非静音
+                ++cases;
+                if (SilenceScanner::findFirstAbove(samples.data(), samples.size(), limit, kernel) != expected) {
+                    ++mismatches;
+                }
+            }
+        }
+        // 长度不足一次向量比较
+        for (size_t count = 0; count < 40; ++count) {
+            ++cases;
+            if (SilenceScanner::findFirstAbove(noise.data(), count, limit, kernel) != count) {
+                ++mismatches;
+            }
+        }
+    }
+    std::printf("  kernel agreement: %zu cases, %zu mismatches\n", cases, mismatches);
+    if (mismatches > 0) {
+        failures += fail("扫描内核给出的位置与预期不符");
+    }
+
+    // 分段喂入（奇数帧数的块）与一次扫描结果一致
+    std::vector<float> stream(static_cast<size_t>(2.0 * kRate) * 2, 0.0f);
+    const size_t onsetFrame = 70001;
+    stream[onsetFrame * 2 + 1] = 0.5f;
+    SilenceScanner whole;
+    whole.add(stream.data(), stream.size() / 2);
+    SilenceScanner chunked;
+    for (size_t frame = 0; frame < stream.size() / 2; frame += 997) {
+        chunked.add(stream.data() + frame * 2, std::min<size_t>(997, stream.size() / 2 - frame));
+    }
+    SilenceScanner silent;
+    silent.add(noise.data(), noise.size() / 2);
+    if (!whole.found() || whole.leadingFrames() != onsetFrame || !chunked.found() ||
+        chunked.leadingFrames() != onsetFrame || silent.found() || silent.leadingFrames() != noise.size() / 2) {
+        failures += fail("分段扫描与一次扫描结果不一致");
+    }
+
+    // 吞吐：整段低于门限（最坏情况，扫到结尾），按实时倍数与 GB/s 报告
+    std::vector<float> quiet(static_cast<size_t>(kThroughputSeconds * kRate) * 2);
+    for (float& sample : quiet) {
+        sample = dither(rng);
+    }
+    for (SimdLevel kernel : supportedKernels()) {
+        size_t sink = 0;
+        bench::Stopwatch stopwatch;
+        for (int round = 0; round < kThroughputRounds; ++round) {
+            sink += SilenceScanner::findFirstAbove(quiet.data(), quiet.size(), limit, kernel);
+        }
+        double ms = stopwatch.elapsedMs();
+        double bytes = static_cast<double>(quiet.size() * sizeof(float)) * kThroughputRounds;
+        std::printf("  %-6s %8.2f GB/s  %10.0fx realtime%s\n", CpuFeatures::name(kernel), bytes / ms / 1e6,
+                    kThroughputSeconds * kThroughputRounds * 1000.0 / ms,
+                    sink == quiet.size() * kThroughputRounds ? "" : "  (mismatch)");
+    }
+    std::printf("  best kernel on this CPU: %s\n", CpuFeatures::name(CpuFeatures::best()));
+    return failures;
+}
+
+// 16 位立体声 WAV：leadingSeconds 的 -80 dBFS 抖动噪声（解码器输出的“静音”），之后 toneSeconds 的 -20 dBFS 正弦
+void writeClip(const std::filesystem::path& path, uint32_t rate, double leadingSeconds, double toneSeconds) {
+    const size_t leadingFrames = static_cast<size_t>(leadingSeconds * rate + 0.5);
+    const size_t frames = leadingFrames + static_cast<size_t>(toneSeconds * rate + 0.5);
+    std::vector<int16_t> samples;
+    samples.reserve(frames * 2);
+    std::mt19937 rng(static_cast<uint32_t>(leadingFrames));
+    std::uniform_int_distribution<int> dither(-3, 3);
+    for (size_t i = 0; i < frames; ++i) {
+        int sample = dither(rng);
+        if (i >= leadingFrames) {
+            // 从正弦峰值起音：首个采样即超过门限
+            sample = static_cast<int>(std::lround(3277.0 * std::cos(2.0 * kPi * 440.0 * (i - leadingFrames) / rate)));
+        }
+        samples.insert(samples.end(), 2, static_cast<int16_t>(sample));
+    }
+    bench::writeWav(path, rate, 2, samples);
+}
+
+// 输出 WAV（32 位 float 立体声）中 from 帧之后首个超过门限的帧
+uint64_t firstAudibleFrame(const std::vector<char>& wav, uint64_t dataOffset, uint64_t from) {
+    const uint64_t total = (wav.size() - std::min<uint64_t>(dataOffset, wav.size())) / (2 * sizeof(float));
+    if (from >= total) {
+        return total;
+    }
+    const float* samples = reinterpret_cast<const float*>(wav.data() + dataOffset) + from * 2;
+    size_t index = SilenceScanner::findFirstAbove(samples, (total - from) * 2, threshold(), CpuFeatures::best());
+    return from + index / 2;
+}
+
+struct Clip {
+    const char* name;
+    uint32_t rate;
+    double leadingSeconds;
+    double toneSeconds;
+    double expectedLeading;  // 分析应得的开头静音
+};
+
+const Clip kClips[] = {
+    {"lead0.wav", kRate, 0.0, kToneSeconds, 0.0},
+    {"lead300.wav", kRate, 0.3, kToneSeconds, 0.3},
+    {"lead550.wav", kRate, 0.55, kToneSeconds, 0.55},
+    {"lead800.wav", kRate, 0.8, kToneSeconds, 0.8},
+    {"lead400_22k.wav", 22050, 0.4, kToneSeconds, 0.4},  // 经变采样
+    {"short.wav", kRate, 0.2, 0.15, 0.2},                // 不足 400ms 测不出响度，开头静音照样有效
+    {"silent.wav", kRate, 1.0, 0.0, 0.0},                // 全静音不裁剪
+};
+
+int checkPipeline() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-silence-trim";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    std::vector<std::string> files;
+    for (const auto& clip : kClips) {
+        writeClip(dir / clip.name, clip.rate, clip.leadingSeconds, clip.toneSeconds);
+        files.push_back(clip.name);
+    }
+    PathUtil::setAudioDir(dir);
+
+    WavSinkOptions options;
+    options.path = dir / "out.wav";
+    options.sampleRate = kRate;
+    options.writeEventLog = false;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    if (!AudioPlayer::initialize()) {
+        PathUtil::setAudioDir({});
+        AudioPlayer::setBackend(nullptr);
+        return fail("WAV 后端初始化失败");
+    }
+
+    int failures = 0;
+    std::promise<void> analyzed;
+    auto done = analyzed.get_future();
+    bench::Stopwatch stopwatch;
+    AudioPlayer::refreshMetadataAsync(files, nullptr, [&analyzed] { analyzed.set_value(); });
+    done.wait();
+    std::printf("  background analysis: %zu files in %.1f ms\n", files.size(), stopwatch.elapsedMs());
+
+    // 缓存文件中的开头静音
+    auto cached = AudioMetadataCache::readCache(dir);
+    double maxLeadingError = 0.0;
+    bool complete = cached.size() == files.size();
+    for (const auto& clip : kClips) {
+        auto it = cached.find(clip.name);
+        if (it == cached.end() || it->second.loudnessStatus == LoudnessStatus::PENDING) {
+            complete = false;
+            continue;
+        }
+        double errorMs = std::fabs(it->second.leadingSilenceSeconds - clip.expectedLeading) * 1000.0;
+        maxLeadingError = std::max(maxLeadingError, errorMs);
+        std::printf("  %-16s leading silence %7.2f ms (expected %5.0f ms)%s\n", clip.name,
+                    it->second.leadingSilenceSeconds * 1000.0, clip.expectedLeading * 1000.0,
+                    it->second.loudnessStatus == LoudnessStatus::MEASURED ? "" : ", loudness not measurable");
+    }
+    if (!complete || maxLeadingError > kMaxLeadingErrorMs) {
+        failures += fail("缓存中的开头静音与实际不符");
+    }
+
+    // 冷启动、预载池、预热三条建源路径裁剪，最后关闭裁剪对照
+    struct Play {
+        const char* name;
+        double leading;
+        bool trim;
+    };
+    const Play plays[] = {{"lead300.wav", 0.3, true}, {"lead550.wav", 0.55, true}, {"lead800.wav", 0.8, true},
+                          {"lead800.wav", 0.8, false}};
+    AudioPlayer::loadAssetPool({"lead550.wav"}, AssetPolicy::PCM, 16ull * 1024 * 1024);
+    std::this_thread::sleep_for(milliseconds(100));
+    double trims[std::size(plays)] = {};
+    double durations[std::size(plays)] = {};
+    bool prepared[std::size(plays)] = {};
+    for (size_t i = 0; i < std::size(plays); ++i) {
+        AudioPlayer::setTrimLeadingSilence(plays[i].trim);
+        if (i == 2) {
+            AudioPlayer::prepareAudioFile(plays[i].name);
+        }
+        AudioPlayer::playAudioFile(plays[i].name);
+        trims[i] = AudioPlayer::getLastTrimSeconds();
+        durations[i] = AudioPlayer::getCurrentStreamDuration();
+        prepared[i] = AudioPlayer::wasLastStartPrepared();
+        std::this_thread::sleep_for(duration<double>(durations[i] + 0.15));
+    }
+    AudioPlayer::cleanup();
+    AudioPlayer::setTrimLeadingSilence(false);
+
+    std::vector<WavSinkEvent> events = backend->getEvents();
+    AudioFormatInfo info;
+    std::ifstream file(options.path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (events.size() != std::size(plays) || !prepared[2] ||
+        !AudioHeaderParser::probeMemory(wav.data(), wav.size(), info)) {
+        failures += fail("输出 WAV 或事件记录缺失");
+    } else {
+        const char* paths[] = {"cold", "pool", "prepared", "untrimmed"};
+        double audibleMs[std::size(plays)] = {};
+        for (size_t i = 0; i < std::size(plays); ++i) {
+            const double expectedTrim = plays[i].trim ? plays[i].leading - AudioPlayer::TRIM_PREROLL_SECONDS : 0.0;
+            const uint64_t audible = firstAudibleFrame(wav, info.dataOffset, events[i].startFrame);
+            const double offsetMs = (audible - events[i].startFrame) * 1000.0 / kRate;
+            audibleMs[i] = events[i].onsetLatencyMs + offsetMs;
+            std::printf("  %-9s %-12s trimmed %6.1f ms, duration %.3f s, tone at +%6.1f ms after first frame, "
+                        "audible %6.1f ms after play()\n",
+                        paths[i], plays[i].name, trims[i] * 1000.0, durations[i], offsetMs, audibleMs[i]);
+            const double expectedOffsetMs = (plays[i].leading - expectedTrim) * 1000.0;
+            if (std::fabs(trims[i] - expectedTrim) > kMaxLeadingErrorMs / 1000.0 ||
+                std::fabs(offsetMs - expectedOffsetMs) > kMaxOutputErrorMs ||
+                std::fabs(durations[i] - (plays[i].leading + kToneSeconds - expectedTrim)) > 0.002) {
+                failures += fail("起播裁剪量或输出中的起音位置与开头静音不符");
+            }
+        }
+        std::printf("  lead800: audible onset %.1f ms trimmed vs %.1f ms untrimmed\n", audibleMs[2], audibleMs[3]);
+    }
+
+    PathUtil::setAudioDir({});
+    AudioPlayer::setBackend(nullptr);
+    fs::remove_all(dir, ec);
+    return failures;
+}
+}  // namespace
+
+int benchSilenceTrim() {
+    int failures = checkKernels();
+    failures += checkPipeline();
+    return failures;
+}
@@ -0,0 +1,133 @@
+// 多会话调度基准：1000 个考场、错峰开考，每场 kMaxInstructionsPerSubject 条指令。
+// 对比时间轮（SessionScheduler）与现行做法（全表 std::sort + 每秒线性扫描）。
+#include "BenchUtil.h"
+#include "ConfigManager.h"
+#include "SessionScheduler.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr int kRooms = 1000;
+constexpr int kRoomStaggerSeconds = 7;       // 相邻考场开考间隔
+constexpr int kFirstOffsetSeconds = -720;    // 考前 12 分钟
+constexpr int kLastOffsetSeconds = 9600;     // 再选合堂第二堂结束
+constexpr int kBaselineTicks = 300;          // 线性扫描基线只跑 5 分钟，按 tick 折算
+
+std::vector<Instruction> makeRoomInstructions(int room, system_clock::time_point base, int count) {
+    std::vector<Instruction> instructions(count);
+    auto start = base + seconds(room * kRoomStaggerSeconds);
+    const int span = kLastOffsetSeconds - kFirstOffsetSeconds;
+    for (int i = 0; i < count; ++i) {
+        Instruction& instruction = instructions[i];
+        instruction.subjectId = room;
+        instruction.name = "指令";
+        instruction.audioFile = "4ksks.mp3";
+        instruction.playTime = start + seconds(kFirstOffsetSeconds + span * i / count);
+    }
+    return instructions;
+}
+}  // namespace
+
+int benchTimingWheel() {
+    const int perRoom = ConfigManager::kMaxInstructionsPerSubject;
+    const size_t total = static_cast<size_t>(kRooms) * perRoom;
+    const auto base = system_clock::time_point(seconds(1800000000));  // 固定起点，结果可复现
+    const auto simStart = base + seconds(kFirstOffsetSeconds - 1);
+    const auto simEnd = base + seconds(kRooms * kRoomStaggerSeconds + kLastOffsetSeconds + 1);
+
+    std::vector<std::vector<Instruction>> rooms;
+    rooms.reserve(kRooms);
+    for (int room = 0; room < kRooms; ++room) {
+        rooms.push_back(makeRoomInstructions(room, base, perRoom));
+    }
+    std::printf("  rooms=%d, instructions/room=%d, total=%zu\n", kRooms, perRoom, total);
+
+    // --- 时间轮：插入 ---
+    SessionScheduler scheduler(simStart);
+    std::vector<SessionScheduler::SessionId> sessions;
+    sessions.reserve(kRooms);
+    bench::Stopwatch watch;
+    for (int room = 0; room < kRooms; ++room) {
+        sessions.push_back(scheduler.addSession("room", rooms[room]));
+    }
+    bench::report("wheel insert", watch.elapsedMs(), total);
+
+    // --- 时间轮：随机取消 10% ---
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> roomDist(0, kRooms - 1);
+    std::uniform_int_distribution<int> indexDist(0, perRoom - 1);
+    const size_t cancelCount = total / 10;
+    size_t cancelled = 0;
+    watch.reset();
+    for (size_t i = 0; i < cancelCount; ++i) {
+        if (scheduler.cancelInstruction(sessions[roomDist(rng)], indexDist(rng))) {
+            ++cancelled;
+        }
+    }
+    bench::report("wheel cancel (random 10%)", watch.elapsedMs(), cancelCount);
+
+    // --- 时间轮：按秒推进整场考试日 ---
+    size_t fired = 0;
+    size_t ticks = 0;
+    watch.reset();
+    for (auto now = simStart; now <= simEnd; now += seconds(1)) {
+        scheduler.advanceTo(now, [&](SessionScheduler::SessionId, int, Instruction& instruction) {
+            instruction.status = PlaybackStatus::PLAYED;
+            ++fired;
+        });
+        ++ticks;
+    }
+    double wheelMs = watch.elapsedMs();
+    bench::report("wheel advance (per 1s tick)", wheelMs, ticks);
+    bench::report("wheel advance (per fired instruction)", wheelMs, fired);
+    std::printf("  fired=%zu cancelled=%zu pending=%zu\n", fired, cancelled, scheduler.pendingCount());
+    if (fired + cancelled != total || scheduler.pendingCount() != 0) {
+        std::printf("  [FAIL] fired + cancelled != total\n");
+        return 1;
+    }
+
+    // --- 现行做法：全表排序 + 每 tick 线性找第一条未播放指令 ---
+    std::vector<Instruction> flat;
+    flat.reserve(total);
+    for (const auto& room : rooms) {
+        flat.insert(flat.end(), room.begin(), room.end());
+    }
+    watch.reset();
+    std::sort(flat.begin(), flat.end(), [](const Instruction& a, const Instruction& b) {
+        return a.playTime < b.playTime;
+    });
+    bench::report("baseline std::sort", watch.elapsedMs(), total);
+
+    // 单机版每个考场每秒扫描自己的列表；此处按考场分表模拟
+    size_t baselineFired = 0;
+    watch.reset();
+    auto now = simStart;
+    for (int tick = 0; tick < kBaselineTicks; ++tick, now += seconds(1)) {
+        for (auto& room : rooms) {
+            for (auto& instruction : room) {
+                if (instruction.status == PlaybackStatus::UNPLAYED) {
+                    if (instruction.playTime <= now) {
+                        instruction.status = PlaybackStatus::PLAYED;
+                        ++baselineFired;
+                    }
+                    break;
+                }
+            }
+            // 过期扫描：逐条检查（与 UpdateNextInstruction 相同的全表遍历）
+            for (auto& instruction : room) {
+                if (instruction.status == PlaybackStatus::UNPLAYED &&
+                    now - instruction.playTime > seconds(60)) {
+                    instruction.status = PlaybackStatus::SKIPPED;
+                }
+            }
+        }
+    }
+    double baselineMs = watch.elapsedMs();
+    bench::report("baseline linear scan (per 1s tick)", baselineMs, kBaselineTicks);
+    std::printf("  speedup per tick: %.1fx\n",
+                (baselineMs / kBaselineTicks) / (wheelMs / static_cast<double>(ticks)));
+    return 0;
+}
@@ -0,0 +1,238 @@
+// 播放看门狗基准：AudioPlayer 接 WavSinkBackend 实时播放一段 3 秒的恒定电平音频，注入四种故障：
+//  1) 读到 1 秒处提前读尽（U 盘拔出），备用目录中有同名文件：从断点处改用备用文件接着播，
+//     播放状态全程不中断，从输出 WAV 逐采样量出听到的间隙；
+//  2) 同样的读取故障但没有备用文件：重新打开原文件仍读不出，放弃接替，这一路照常结束；
+//  3) 设备 1 秒后不再取数据（驱动挂起）：约 stallMs 内检出，换备用设备重开输出并从断点处继续；
+//  4) 设备 1 秒后写入失败（设备拔出）：立即检出，同样换备用设备。
+// 报告各次的检出与接替耗时。实时部分约 10 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kRate = 44100;
+constexpr double kToneSeconds = 3.0;
+constexpr float kLevel = 0.25f;
+constexpr double kFaultSeconds = 1.0;
+// 检出上限：提前读尽由看护源立即唤醒；设备不取数据按 stallMs（200ms）判定，加两个检查周期
+constexpr double kMaxWakeDetectMs = 50.0;
+constexpr double kMaxStallDetectMs = 260.0;
+constexpr double kMaxRecoverMs = 100.0;
+// 改用备用文件时听到的间隙上限：检出 + 接替 + 排队量，单核未优化构建留出余量
+constexpr double kMaxGapMs = 150.0;
+// 接替处与故障处之差：设备故障时往前退一个排队量（约 40ms）再加检出期间的一两块
+constexpr double kMaxPositionError = 0.1;
+
+using bench::fail;
+
+// 32 位 float 立体声 WAV，恒定电平（输出中零值即听到的间隙）
+void writeLevelWav(const std::filesystem::path& path, double seconds) {
+    bench::writeWav(path, kRate, 2, std::vector<float>(static_cast<size_t>(seconds * kRate) * 2, kLevel));
+}
+
+struct Audible {
+    uint64_t frames = 0;    // 有声的帧数
+    uint64_t gapFrames = 0; // 首个有声帧与最后一个有声帧之间的静音帧
+};
+
+Audible measure(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    AudioFormatInfo info;
+    Audible result;
+    if (!AudioHeaderParser::probeMemory(wav.data(), wav.size(), info)) {
+        return result;
+    }
+    const uint64_t frames = (wav.size() - info.dataOffset) / (2 * sizeof(float));
+    uint64_t silent = 0;
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        float sample;
+        std::memcpy(&sample, wav.data() + info.dataOffset + frame * 2 * sizeof(float), sizeof(sample));
+        if (std::fabs(sample) > kLevel / 2) {
+            if (result.frames > 0) {
+                result.gapFrames += silent;
+            }
+            silent = 0;
+            ++result.frames;
+        } else {
+            ++silent;
+        }
+    }
+    return result;
+}
+
+void printEvents(const std::vector<WatchdogEvent>& events) {
+    for (const auto& event : events) {
+        std::printf("    %-8s at %6.3f s  detect %6.1f ms  recover %6.1f ms  %s (%s)\n",
+                    PlaybackWatchdog::faultName(event.fault), event.positionSeconds, event.detectMs, event.recoverMs,
+                    event.recovered ? "recovered" : "gave up  ", event.via.c_str());
+    }
+}
+
+// 播放 tone.wav 并等它播完：返回播放状态是否在播完之前中断过。
+// lastDuration 为停止前最后一次查到的当前一路时长（接替后应只剩断点之后的部分）
+bool playToEnd(double limitSeconds, double* interruptedAt, double* lastDuration = nullptr) {
+    const auto start = steady_clock::now();
+    AudioPlayer::playAudioFile("tone.wav");
+    *interruptedAt = -1.0;
+    while (duration<double>(steady_clock::now() - start).count() < limitSeconds) {
+        std::this_thread::sleep_for(milliseconds(10));
+        if (lastDuration && AudioPlayer::isPlaying()) {
+            *lastDuration = AudioPlayer::getCurrentStreamDuration();
+        }
+        if (!AudioPlayer::isPlaying()) {
+            *interruptedAt = duration<double>(steady_clock::now() - start).count();
+            break;
+        }
+    }
+    return *interruptedAt >= 0.0;
+}
+
+// 1)/2) 读取故障：有备用文件时接替，没有时放弃
+int checkReadFault(const std::filesystem::path& dir, bool withBackup) {
+    const std::filesystem::path audio = dir / "audio";
+    const std::filesystem::path backup = dir / "backup";
+    WavSinkOptions options;
+    options.sampleRate = kRate;
+    options.path = dir / "out.wav";
+    options.readFaults.push_back({audio / "tone.wav", kFaultSeconds});
+    AudioPlayer::setBackend(std::make_unique<WavSinkBackend>(options));
+    AudioPlayer::setBackupAudioDir(withBackup ? backup : std::filesystem::path());
+    if (!AudioPlayer::initialize()) {
+        AudioPlayer::setBackend(nullptr);
+        return fail("WAV 后端初始化失败");
+    }
+    double endedAt = 0.0;
+    double lastDuration = 0.0;
+    playToEnd(kToneSeconds + 1.5, &endedAt, &lastDuration);
+    const std::vector<WatchdogEvent> events = AudioPlayer::getWatchdogEvents();
+    AudioPlayer::cleanup();
+    const Audible audible = measure(options.path);
+    AudioPlayer::setBackupAudioDir({});
+
+    int failures = 0;
+    const double gapMs = audible.gapFrames * 1000.0 / kRate;
+    std::printf("  read fault at %.1f s, %s: playing until %.2f s, %.3f s audible, gap %.1f ms\n", kFaultSeconds,
+                withBackup ? "backup file" : "no backup  ", endedAt, audible.frames / double(kRate), gapMs);
+    printEvents(events);
+    if (events.empty() || events[0].fault != WatchdogFault::SOURCE_ENDED_EARLY ||
+        std::fabs(events[0].positionSeconds - kFaultSeconds) > 0.01 || events[0].detectMs > kMaxWakeDetectMs) {
+        return fail("提前读尽未在断点处立即检出");
+    }
+    if (withBackup) {
+        if (events.size() != 1 || !events[0].recovered || events[0].via.find("备用文件") == std::string::npos ||
+            events[0].recoverMs > kMaxRecoverMs) {
+            failures += fail("未从备用文件接替");
+        }
+        // 播放状态不中断：播完（3 秒 + 间隙）之前一直为真
+        if (endedAt < kToneSeconds || std::fabs(audible.frames / double(kRate) - kToneSeconds) > 0.01 ||
+            gapMs > kMaxGapMs) {
+            failures += fail("接替后播放中断、内容缺失或间隙过长");
+        }
+        if (std::fabs(lastDuration - (kToneSeconds - events[0].positionSeconds)) > 0.01) {
+            failures += fail("接替后的当前时长未改为断点之后的部分");
+        }
+    } else {
+        // 原文件在断点处同样读不出：只记一次未接替，这一路在占位静音结束后停止
+        if (events.size() != 1 || events[0].recovered || events[0].via.find("无备用来源") == std::string::npos ||
+            endedAt < 0.0 || endedAt > kToneSeconds) {
+            failures += fail("没有备用文件时未放弃接替");
+        }
+    }
+    AudioPlayer::setBackend(nullptr);
+    return failures;
+}
+
+// 3)/4) 设备故障：换备用设备重开输出
+int checkDeviceFault(const std::filesystem::path& dir, bool stall) {
+    WavSinkOptions options;
+    options.sampleRate = kRate;
+    WavSinkDevice primary{"主", dir / "primary.wav"};
+    (stall ? primary.stallAfterSeconds : primary.failAfterSeconds) = kFaultSeconds;
+    options.devices = {primary, {"备", dir / "backup.wav"}};
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+    AudioPlayer::setOutputDevices({"主"});
+    AudioPlayer::setBackupOutputDevices({"备"});
+    int failures = 0;
+    if (!AudioPlayer::initialize()) {
+        failures += fail("WAV 后端初始化失败");
+    } else {
+        // 设备时钟自 open() 起算：先播上一段，故障发生在播放中途
+        double endedAt = 0.0;
+        double lastDuration = 0.0;
+        playToEnd(kToneSeconds + 1.5, &endedAt, &lastDuration);
+        // 起播时刻在故障之前，重开输出后仍应取得到
+        double onsetMs = -1.0;
+        const bool onsetKnown = AudioPlayer::getLastOnsetDelayMs(onsetMs);
+        const std::vector<WatchdogEvent> events = AudioPlayer::getWatchdogEvents();
+        const bool onBackup = backend->getDevices().size() == 1 && backend->getDevices()[0].name == "备";
+        AudioPlayer::cleanup();
+        const Audible heard = measure(dir / "backup.wav");
+
+        std::printf("  device %s at %.1f s: playing until %.2f s, %.3f s on backup device, onset %.1f ms\n",
+                    stall ? "stall" : "fail ", kFaultSeconds, endedAt, heard.frames / double(kRate), onsetMs);
+        printEvents(events);
+        const WatchdogFault expected = stall ? WatchdogFault::OUTPUT_STALLED : WatchdogFault::OUTPUT_FAILED;
+        if (events.size() != 1 || events[0].fault != expected || !events[0].recovered || !onBackup) {
+            failures += fail("设备故障未换备用设备接替");
+        } else {
+            if (events[0].detectMs > (stall ? kMaxStallDetectMs : kMaxWakeDetectMs + kMaxStallDetectMs / 4) ||
+                events[0].recoverMs > kMaxRecoverMs) {
+                failures += fail("设备故障检出或接替过慢");
+            }
+            // 接替处在故障之前不远；备用设备上播完其余部分
+            const double resumed = events[0].positionSeconds;
+            if (resumed > kFaultSeconds + 0.02 || resumed < kFaultSeconds - kMaxPositionError ||
+                std::fabs(heard.frames / double(kRate) - (kToneSeconds - resumed)) > 0.02 || endedAt < kToneSeconds) {
+                failures += fail("设备故障后未从断点处在备用设备上播完");
+            }
+            if (std::fabs(lastDuration - (kToneSeconds - resumed)) > 0.01) {
+                failures += fail("接替后的当前时长未改为断点之后的部分");
+            }
+            if (!onsetKnown || onsetMs < 0.0 || onsetMs > kFaultSeconds * 1000.0) {
+                failures += fail("重开输出后丢失了这一条的起播出声时刻");
+            }
+        }
+    }
+    AudioPlayer::setOutputDevices({});
+    AudioPlayer::setBackupOutputDevices({});
+    AudioPlayer::setBackend(nullptr);
+    return failures;
+}
+}  // namespace
+
+int benchWatchdog() {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "evcs-bench-watchdog";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "audio");
+    fs::create_directories(dir / "backup");
+    writeLevelWav(dir / "audio" / "tone.wav", kToneSeconds);
+    writeLevelWav(dir / "backup" / "tone.wav", kToneSeconds);
+    PathUtil::setAudioDir(dir / "audio");
+
+    int failures = 0;
+    failures += checkReadFault(dir, true);
+    failures += checkReadFault(dir, false);
+    failures += checkDeviceFault(dir, true);
+    failures += checkDeviceFault(dir, false);
+
+    PathUtil::setAudioDir({});
+    fs::remove_all(dir, ec);
+    return failures;
+}
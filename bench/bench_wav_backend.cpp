@@ -0,0 +1,185 @@
+// 无声卡音频后端基准：AudioPlayer 接 WavSinkBackend，实时播放一组 WAV（变采样、叠加、预热、停止），
+// 从事件记录与输出 WAV 校验起播延迟、叠加区间、播放时长与输出内容，并统计连续起播的延迟分布。
+// 实时运行，约 2 秒。
+#include "AudioHeaderParser.h"
+#include "AudioPlayer.h"
+#include "BenchUtil.h"
+#include "PathUtil.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint32_t kMixRate = 44100;
+constexpr milliseconds kOverlapDelay{120};  // 第二路在第一路起播后多久入队（第一路 0.5 秒，必然叠加）
+constexpr int kBurstPlays = 20;
+constexpr milliseconds kBurstSpacing{25};
+// 起播延迟上限：排队 4 块 (40ms) + 渲染线程半块睡眠，留出调度抖动余量
+constexpr double kMaxOnsetLatencyMs = 80.0;
+
+using bench::fail;
+
+const WavSinkEvent* findEvent(const std::vector<WavSinkEvent>& events, const std::string& filename) {
+    for (const auto& event : events) {
+        if (event.filename == filename) {
+            return &event;
+        }
+    }
+    return nullptr;
+}
+
+// 输出 WAV 中 [from, to) 帧的峰值
+float peak(const std::vector<char>& wav, uint64_t dataOffset, uint64_t from, uint64_t to) {
+    float result = 0.0f;
+    for (uint64_t frame = from; frame < to; ++frame) {
+        uint64_t offset = dataOffset + frame * 2 * sizeof(float);
+        if (offset + 2 * sizeof(float) > wav.size()) {
+            break;
+        }
+        float samples[2];
+        std::memcpy(samples, wav.data() + offset, sizeof(samples));
+        result = std::max({result, std::fabs(samples[0]), std::fabs(samples[1])});
+    }
+    return result;
+}
+}  // namespace
+
+int benchWavBackend() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "evcs-bench-wav-backend";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    bench::writeSine(dir / "tone_a.wav", 22050, 0.5, 1);  // 单声道 16 位，需变采样
+    bench::writeWav(dir / "tone_b.wav", kMixRate, 2, bench::sineSamples(kMixRate, 0.3));
+    bench::writeSine(dir / "long.wav", kMixRate, 2.0);
+    std::ofstream(dir / "broken.wav", std::ios::binary) << "RIFF????WAVEjunk";
+    PathUtil::setAudioDir(dir);
+
+    WavSinkOptions options;
+    options.path = dir / "out.wav";
+    options.sampleRate = kMixRate;
+    auto owned = std::make_unique<WavSinkBackend>(options);
+    WavSinkBackend* backend = owned.get();
+    AudioPlayer::setBackend(std::move(owned));
+
+    int failures = 0;
+    if (!AudioPlayer::initialize()) {
+        PathUtil::setAudioDir({});
+        AudioPlayer::setBackend(nullptr);
+        return fail("WAV 后端初始化失败");
+    }
+
+    // 等渲染线程填满排队量（稳态），起播延迟才有可比性
+    std::this_thread::sleep_for(milliseconds(100));
+
+    // 叠加：tone_a 播到一半时 tone_b 入队；损坏文件起播失败；long 预热后起播再被停止
+    bool startedA = AudioPlayer::playAudioFile("tone_a.wav");
+    std::this_thread::sleep_for(kOverlapDelay);
+    bool startedB = AudioPlayer::playAudioFile("tone_b.wav");
+    bool startedBroken = AudioPlayer::playAudioFile("broken.wav");
+    std::this_thread::sleep_for(milliseconds(500));
+    bool preparedLong = AudioPlayer::prepareAudioFile("long.wav");
+    bool startedLong = AudioPlayer::playAudioFile("long.wav") && AudioPlayer::wasLastStartPrepared();
+    std::this_thread::sleep_for(milliseconds(200));
+    AudioPlayer::stop();
+    std::this_thread::sleep_for(milliseconds(100));
+
+    // 连续起播：统计交给混音器到首帧播出的延迟
+    for (int i = 0; i < kBurstPlays; ++i) {
+        AudioPlayer::playAudioFile("tone_b.wav");
+        std::this_thread::sleep_for(kBurstSpacing);
+    }
+    std::this_thread::sleep_for(milliseconds(400));
+    AudioPlayer::cleanup();
+
+    if (!startedA || !startedB || startedBroken || !preparedLong || !startedLong) {
+        failures += fail("起播结果不符（WAV 应可播放并命中预热，损坏文件应失败）");
+    }
+
+    std::vector<WavSinkEvent> events = backend->getEvents();
+    const WavSinkEvent* a = findEvent(events, "tone_a.wav");
+    const WavSinkEvent* b = findEvent(events, "tone_b.wav");
+    const WavSinkEvent* longEvent = findEvent(events, "long.wav");
+    if (events.size() != 3 + kBurstPlays || !a || !b || !longEvent || !a->started || !b->started ||
+        !longEvent->started) {
+        failures += fail("事件记录缺失");
+    } else {
+        const double requestGapMs = duration<double, std::milli>(b->requestTime - a->requestTime).count();
+        const double startGapMs = (b->startSeconds - a->startSeconds) * 1000.0;
+        std::printf("  tone_a  %8.3f - %8.3f s  onset %6.2f ms\n", a->startSeconds, a->endSeconds,
+                    a->onsetLatencyMs);
+        std::printf("  tone_b  %8.3f - %8.3f s  onset %6.2f ms  (入队间隔 %.2f ms, 起播间隔 %.2f ms)\n",
+                    b->startSeconds, b->endSeconds, b->onsetLatencyMs, requestGapMs, startGapMs);
+        std::printf("  long    %8.3f - %8.3f s  onset %6.2f ms  (stop 截断)\n", longEvent->startSeconds,
+                    longEvent->endSeconds, longEvent->onsetLatencyMs);
+        if (!(b->startFrame < a->endFrame) || !a->finished || !b->finished) {
+            failures += fail("tone_b 应叠加在 tone_a 播完之前，且两路都应自然播完");
+        }
+        if (std::fabs(startGapMs - requestGapMs) > 30.0) {
+            failures += fail("起播间隔应与入队间隔一致（误差不超过三块）");
+        }
+        // 22.05kHz 0.5 秒变采样到 44.1kHz
+        if (std::llabs(static_cast<long long>(a->endFrame - a->startFrame) - 22050) > 2 ||
+            b->endFrame - b->startFrame != static_cast<uint64_t>(0.3 * kMixRate)) {
+            failures += fail("播放帧数应等于文件时长");
+        }
+        if (!longEvent->stoppedEarly || longEvent->endSeconds - longEvent->startSeconds > 0.5) {
+            failures += fail("stop() 应在淡出后截断 long.wav");
+        }
+    }
+
+    // 连续起播延迟分布
+    double sumMs = 0.0;
+    double maxMs = 0.0;
+    double minMs = 1e9;
+    size_t measured = 0;
+    for (const auto& event : events) {
+        if (!event.started) {
+            continue;
+        }
+        sumMs += event.onsetLatencyMs;
+        maxMs = std::max(maxMs, event.onsetLatencyMs);
+        minMs = std::min(minMs, event.onsetLatencyMs);
+        ++measured;
+    }
+    std::printf("  onset latency  %zu plays  min %.2f ms  avg %.2f ms  max %.2f ms  (padded %llu frames)\n",
+                measured, minMs, measured ? sumMs / measured : 0.0, maxMs,
+                static_cast<unsigned long long>(backend->getPaddedFrames()));
+    if (measured != events.size() || minMs < 0.0 || maxMs > kMaxOnsetLatencyMs) {
+        failures += fail("起播延迟超出排队深度允许的范围");
+    }
+
+    // 输出 WAV：格式与帧数，首路起播前为静音，tone_b 起播处有声
+    AudioFormatInfo info;
+    std::ifstream file(options.path, std::ios::binary);
+    std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!AudioHeaderParser::probeMemory(wav.data(), wav.size(), info) || info.codec != AudioCodec::WAV_FLOAT ||
+        info.channels != 2 || info.sampleRate != kMixRate || info.totalFrames != backend->getWrittenFrames()) {
+        failures += fail("输出 WAV 格式或帧数不符");
+    } else if (a && b && a->started && b->started) {
+        float before = peak(wav, info.dataOffset, 0, a->startFrame);
+        float atB = peak(wav, info.dataOffset, b->startFrame, b->startFrame + 441);
+        std::printf("  out.wav  %.3f s, peak before tone_a %.4f, peak at tone_b %.4f\n", info.durationSeconds,
+                    before, atB);
+        if (before != 0.0f || atB < 0.3f) {
+            failures += fail("输出内容与事件位置不符");
+        }
+    }
+    if (!fs::exists(dir / "out.wav.events.txt")) {
+        failures += fail("未写出事件记录");
+    }
+
+    PathUtil::setAudioDir({});
+    AudioPlayer::setBackend(nullptr);
+    fs::remove_all(dir, ec);
+    return failures;
+}
@@ -25,12 +25,12 @@ if errorlevel 1 (
 echo.
 
 REM ---- Clean old build dir ----
-echo [1/3] Cleaning old build directory...
+echo [1/4] Cleaning old build directory...
 if exist "%PROJECT_ROOT%\%BUILD_DIR%" rmdir /s /q "%PROJECT_ROOT%\%BUILD_DIR%"
 mkdir "%PROJECT_ROOT%\%BUILD_DIR%"
 
 REM ---- Configure and build Release ----
-echo [2/3] Configuring and building Release...
+echo [2/4] Configuring and building Release...
 cd /d "%PROJECT_ROOT%\%BUILD_DIR%"
 "%CMAKE_CMD%" -G "%CMAKE_GENERATOR%" -A x64 "%PROJECT_ROOT%"
 if errorlevel 1 (
@@ -49,7 +49,7 @@ if errorlevel 1 (
 cd /d "%PROJECT_ROOT%"
 
 REM ---- Deploy files to release directory ----
-echo [3/3] Deploying release files...
+echo [3/4] Deploying release files...
 call "%SCRIPT_DIR%_deploy.bat" "%RELEASE_DIR%" Release RELEASE_INFO.txt
 if errorlevel 1 (
     echo [ERROR] File deployment failed.
@@ -58,6 +58,28 @@ if errorlevel 1 (
     exit /b 1
 )
 
+REM ---- Audio integrity manifest (verified by the app at startup) ----
+echo [4/4] Generating audio integrity manifest...
+set "MANIFEST_EXE=%PROJECT_ROOT%\%BUILD_DIR%\Release\evcs-manifest.exe"
+if not exist "%MANIFEST_EXE%" (
+    echo [ERROR] evcs-manifest.exe not found.
+    pause
+    exit /b 1
+)
+copy /y "%MANIFEST_EXE%" "%PROJECT_ROOT%\%RELEASE_DIR%\" >nul
+if exist "%PROJECT_ROOT%\%BUILD_DIR%\Release\evcs-pack.exe" copy /y "%PROJECT_ROOT%\%BUILD_DIR%\Release\evcs-pack.exe" "%PROJECT_ROOT%\%RELEASE_DIR%\" >nul
+dir /b /a-d /s "%PROJECT_ROOT%\%RELEASE_DIR%\audio" >nul 2>nul
+if errorlevel 1 (
+    echo   - audio\evcs_manifest.txt [note: audio\ is empty; run "evcs-manifest generate audio" after adding files]
+) else (
+    "%MANIFEST_EXE%" generate "%PROJECT_ROOT%\%RELEASE_DIR%\audio"
+    if errorlevel 1 (
+        echo [ERROR] Manifest generation failed.
+        pause
+        exit /b 1
+    )
+)
+
 echo.
 echo =====================================
 echo Release package complete!
@@ -70,6 +92,8 @@ echo.
 echo Distribution notes:
 echo   1. The "%RELEASE_DIR%" folder is ready to distribute as-is
 echo   2. Users must add their own audio files to the audio\ subfolder
-echo   3. See README.txt for details
+echo   3. After changing audio\, regenerate the manifest: evcs-manifest generate audio
+echo   4. Optional: pack audio\ into one memory-mapped file: evcs-pack pack audio (then regenerate the manifest)
+echo   5. See README.txt for details
 echo.
 pause
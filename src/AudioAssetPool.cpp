@@ -0,0 +1,225 @@
+#include "AudioAssetPool.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include "AudioBundle.h"
+
+namespace {
+bool readWholeFile(const std::filesystem::path& path, uint64_t size, std::vector<char>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(file.read(data.data(), static_cast<std::streamsize>(size)));
+}
+
+size_t pcmBytes(const PcmBuffer& pcm) {
+    return pcm.samples.size() * sizeof(float);
+}
+}  // namespace
+
+void AudioAssetPool::setDecoder(Decoder decoder) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoder = std::move(decoder);
+}
+
+bool AudioAssetPool::parsePolicy(const std::string& text, AssetPolicy& policy) {
+    if (text == "compressed") {
+        policy = AssetPolicy::COMPRESSED;
+    } else if (text == "pcm") {
+        policy = AssetPolicy::PCM;
+    } else if (text == "auto") {
+        policy = AssetPolicy::AUTO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+AssetPoolStats AudioAssetPool::load(const std::vector<std::string>& files, AssetPolicy policy,
+                                    uint64_t budgetBytes) {
+    const auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const AssetMap> previous;
+    Decoder decoder;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        previous = m_assets;
+        decoder = m_decoder;
+    }
+    if (!decoder) {
+        policy = AssetPolicy::COMPRESSED;
+    }
+
+    AssetPoolStats stats;
+    stats.budgetBytes = budgetBytes;
+    auto next = std::make_shared<AssetMap>();
+    uint64_t used = 0;
+
+    // 同一文件（大小与修改时间未变）上一次载入的条目
+    auto previousEntry = [&previous](const std::string& filename, uint64_t size,
+                                     std::filesystem::file_time_type modified) -> const AudioAsset* {
+        if (!previous) {
+            return nullptr;
+        }
+        auto it = previous->find(filename);
+        if (it == previous->end() || it->second->fileSize != size || it->second->modifiedTime != modified) {
+            return nullptr;
+        }
+        return it->second.get();
+    };
+
+    // 解码为 PCM：能沿用就沿用
+    auto decode = [&](const AudioAsset* old, const std::vector<char>& bytes,
+                      bool& fresh) -> std::shared_ptr<const PcmBuffer> {
+        if (old && old->pcm) {
+            return old->pcm;
+        }
+        fresh = true;
+        auto pcm = std::make_shared<PcmBuffer>();
+        if (bytes.empty() || !decoder(bytes, *pcm) || pcm->samples.empty()) {
+            ++stats.decodeFailures;
+            return nullptr;
+        }
+        return pcm;
+    };
+
+    std::vector<std::shared_ptr<AudioAsset>> loaded;
+    std::set<std::string> seen;
+    for (const auto& filename : files) {
+        if (budgetBytes == 0 || !seen.insert(filename).second) {
+            continue;
+        }
+        // 打包文件中的条目从映射复制（不打开文件），其余读 audio 目录下的散文件
+        AudioLocation location;
+        if (!AudioBundle::locate(filename, location) || location.size == 0) {
+            ++stats.missingFiles;
+            continue;
+        }
+        const uint64_t size = location.size;
+        const std::filesystem::file_time_type modified = location.modifiedTime;
+
+        auto asset = std::make_shared<AudioAsset>();
+        asset->filename = filename;
+        asset->fileSize = size;
+        asset->modifiedTime = modified;
+        const AudioAsset* old = previousEntry(filename, size, modified);
+        bool fresh = false;
+
+        // 原文件字节：沿用上一次的，或整文件读入
+        auto loadBytes = [&]() -> bool {
+            if (old && old->compressed) {
+                asset->compressed = old->compressed;
+                return true;
+            }
+            auto data = std::make_shared<std::vector<char>>();
+            fresh = true;
+            if (location.inBundle()) {
+                data->assign(location.bytes.data, location.bytes.data + location.bytes.size);
+            } else if (!readWholeFile(location.path, size, *data)) {
+                return false;
+            }
+            asset->compressed = std::move(data);
+            return true;
+        };
+
+        if (policy == AssetPolicy::PCM) {
+            std::shared_ptr<const PcmBuffer> pcm;
+            if (old && old->pcm) {
+                pcm = old->pcm;
+            } else if (loadBytes()) {
+                pcm = decode(old, *asset->compressed, fresh);
+            } else {
+                ++stats.missingFiles;
+                continue;
+            }
+            if (pcm && used + pcmBytes(*pcm) <= budgetBytes) {
+                asset->pcm = std::move(pcm);
+                asset->compressed.reset();
+            } else if (size > budgetBytes - used || (!asset->compressed && !loadBytes())) {
+                // 解码后装不下、原文件也装不下（或已不可读）：留给磁盘
+                ++stats.overBudgetFiles;
+                continue;
+            }
+        } else {
+            if (size > budgetBytes - used) {
+                ++stats.overBudgetFiles;
+                continue;
+            }
+            if (!loadBytes()) {
+                ++stats.missingFiles;
+                continue;
+            }
+        }
+
+        used += asset->footprintBytes();
+        if (!fresh) {
+            ++stats.reusedFiles;
+        }
+        loaded.push_back(asset);
+    }
+
+    // AUTO：预算有余时从小到大升级为 PCM，第一个装不下的之后不再尝试（更大的同样装不下）
+    if (policy == AssetPolicy::AUTO) {
+        std::vector<std::shared_ptr<AudioAsset>> bySize = loaded;
+        std::stable_sort(bySize.begin(), bySize.end(),
+                         [](const std::shared_ptr<AudioAsset>& a, const std::shared_ptr<AudioAsset>& b) {
+                             return a->fileSize < b->fileSize;
+                         });
+        for (auto& asset : bySize) {
+            const AudioAsset* old = previousEntry(asset->filename, asset->fileSize, asset->modifiedTime);
+            bool fresh = false;
+            auto pcm = decode(old, *asset->compressed, fresh);
+            if (!pcm) {
+                continue;
+            }
+            uint64_t grown = used - asset->compressed->size() + pcmBytes(*pcm);
+            if (grown > budgetBytes) {
+                break;
+            }
+            used = grown;
+            asset->pcm = std::move(pcm);
+            asset->compressed.reset();
+        }
+    }
+
+    for (auto& asset : loaded) {
+        if (asset->pcm) {
+            ++stats.pcmFiles;
+            stats.pcmBytes += pcmBytes(*asset->pcm);
+        } else {
+            ++stats.compressedFiles;
+            stats.compressedBytes += asset->compressed->size();
+        }
+        (*next)[asset->filename] = asset;
+    }
+    stats.requestedFiles = std::set<std::string>(files.begin(), files.end()).size();
+    stats.loadedFiles = loaded.size();
+    stats.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_assets = std::move(next);
+    m_stats = stats;
+    return stats;
+}
+
+void AudioAssetPool::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_assets.reset();
+    m_stats = AssetPoolStats();
+}
+
+std::shared_ptr<const AudioAsset> AudioAssetPool::find(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_assets) {
+        return nullptr;
+    }
+    auto it = m_assets->find(filename);
+    return it != m_assets->end() ? it->second : nullptr;
+}
+
+AssetPoolStats AudioAssetPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AudioMixer.h"
+
+// 预载形式
+enum class AssetPolicy {
+    COMPRESSED,  // 原文件字节（MP3/WAV 原样），播放时从内存建解码流
+    PCM,         // 解码为 float 立体声，播放时直接交给混音器；解码失败或超预算时退回原文件字节
+    AUTO         // 先全部按原文件字节载入，预算有余时按文件从小到大升级为 PCM
+};
+
+// 一个已载入内存的音频文件。compressed 与 pcm 至少有一个非空
+struct AudioAsset {
+    std::string filename;
+    std::shared_ptr<const std::vector<char>> compressed;
+    std::shared_ptr<const PcmBuffer> pcm;
+    uint64_t fileSize = 0;
+    std::filesystem::file_time_type modifiedTime;
+
+    size_t footprintBytes() const {
+        return (compressed ? compressed->size() : 0) + (pcm ? pcm->samples.size() * sizeof(float) : 0);
+    }
+};
+
+struct AssetPoolStats {
+    size_t requestedFiles = 0;   // 配置引用到的不同文件数
+    size_t loadedFiles = 0;      // 已在内存中的文件数（= compressedFiles + pcmFiles）
+    size_t compressedFiles = 0;
+    size_t pcmFiles = 0;
+    size_t reusedFiles = 0;      // 大小与修改时间未变、沿用上一次载入结果而未重新读盘的文件
+    size_t missingFiles = 0;     // 不存在或读取失败（播放时照旧走磁盘，届时失败）
+    size_t overBudgetFiles = 0;  // 超出预算未载入（播放时走磁盘）
+    size_t decodeFailures = 0;   // PCM 解码失败（已退回原文件字节）
+    uint64_t compressedBytes = 0;
+    uint64_t pcmBytes = 0;
+    uint64_t budgetBytes = 0;
+    double loadMs = 0.0;
+
+    uint64_t footprintBytes() const { return compressedBytes + pcmBytes; }
+};
+
+// 音频预载池：配置加载后把引用到的每个不同音频文件一次性读入内存，
+// 考试期间起播不再依赖磁盘（U 盘松动、杀毒扫描、网络共享抖动都不影响已载入的文件）。
+//
+// 载入在调用线程上完成，期间旧池仍可查询；完成后整体替换。文件大小与修改时间未变的条目
+// 直接沿用，重复加载同一份配置几乎不做 I/O。find() 可在任意线程调用，
+// 返回的条目以 shared_ptr 持有，替换后仍在使用中的数据直到最后一个引用释放才回收。
+//
+// PCM 解码由注入的解码器完成（Windows 下为 BASS）；未设置解码器时 PCM/AUTO 等同 COMPRESSED。
+class AudioAssetPool {
+public:
+    // 解码整段原文件字节为交错立体声 PCM（采样率写入 out.sampleRate）。失败返回 false
+    using Decoder = std::function<bool(const std::vector<char>& bytes, PcmBuffer& out)>;
+
+    void setDecoder(Decoder decoder);
+
+    // 按 policy 与 budgetBytes 载入 files（打包文件中的条目或 audio 目录下的散文件）。budgetBytes 为 0 时清空
+    AssetPoolStats load(const std::vector<std::string>& files, AssetPolicy policy, uint64_t budgetBytes);
+    void clear();
+
+    // 已载入的条目，未载入返回空
+    std::shared_ptr<const AudioAsset> find(const std::string& filename) const;
+    AssetPoolStats getStats() const;
+
+    // "compressed" / "pcm" / "auto"，无法识别返回 false
+    static bool parsePolicy(const std::string& text, AssetPolicy& policy);
+
+private:
+    using AssetMap = std::map<std::string, std::shared_ptr<const AudioAsset>>;
+
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const AssetMap> m_assets;
+    AssetPoolStats m_stats;
+    Decoder m_decoder;
+};
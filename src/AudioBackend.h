@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AudioBundle.h"
+#include "AudioHeaderParser.h"
+#include "AudioMetadataCache.h"
+#include "AudioMixer.h"
+#include "FanOutOutput.h"
+
+// 音频后端：AudioPlayer 只经此接口接触平台音频库。
+// 后端负责输出设备（混音器的 MixerOutput）、把文件解码为混音声部、整段解码供预载池使用，
+// 以及文件头解析不认识的格式的元数据探测；声部调度、预热、预载池与元数据缓存由 AudioPlayer 统一处理。
+//
+// Windows 正式运行使用 BassAudioBackend（BASS 推送流 + 解码通道），
+// 无声卡环境（Linux、CI、基准）使用 WavSinkBackend，把混音结果写入 WAV 并记录每一路的起止采样位置。
+class IAudioBackend {
+public:
+    virtual ~IAudioBackend() = default;
+
+    // 后端名称（日志用）
+    virtual const char* name() const = 0;
+
+    // 下一次 open() 使用的输出设备（编号或名称片段，含义见各后端），空表示默认设备。
+    // 多于一台时同一混音结果经 FanOutOutput 扇出到各设备，首帧按各设备延迟对齐。默认只支持默认设备
+    virtual void setOutputDevices(const std::vector<std::string>& devices) { (void)devices; }
+    // 打开输出设备，按设备能力填写 config（采样率、块大小、排队量）。失败时自行记录原因
+    virtual bool open(MixerConfig& config) = 0;
+    // 关闭输出设备。调用前混音器已停止且全部声部源已析构
+    virtual void close() = 0;
+    // 混音渲染线程的输出端，open() 成功后有效
+    virtual MixerOutput& output() = 0;
+    // 已打开的各输出设备的延迟、补偿与偏差。只有一台设备时为空
+    virtual std::vector<OutputDeviceStats> getDeviceStats() const { return {}; }
+    // 已打开输出的设备延迟（驱动与硬件缓冲，不含混音器维持的排队量），毫秒。
+    // 多台设备时为扇出对齐到的最大值：首帧在各设备上都要过这么久才出声。未知为 0
+    virtual double getOutputLatencyMs() const { return 0.0; }
+
+    // 打开 path 的解码源，输出 mixRate 的交错立体声，从文件的 startSeconds 处开始（裁去开头静音用，须采样级准确）。
+    // data 非空时从内存中的原文件字节解码（预载池或打包文件的映射，path 仅作标识），返回的源持有 data.owner 直到析构。
+    // prime 为 true 时预解码（起点之后的）首段。durationSeconds 为整个文件的时长。失败返回 nullptr
+    virtual std::unique_ptr<MixerSource> openSource(const std::filesystem::path& path,
+                                                    AudioBytes data, uint32_t mixRate, double startSeconds,
+                                                    bool prime, double* durationSeconds) = 0;
+
+    // openSource 能否真正解码 info（文件头解析结果，无法识别时 codec 为 UNKNOWN）描述的文件；
+    // 不能时 openSource 可能以静音占位。完整解码预检据此区分"解码失败"与"后端不支持"。默认全部可解码
+    virtual bool canDecode(const AudioFormatInfo& info) const {
+        (void)info;
+        return true;
+    }
+
+    // 整段解码原文件字节为原采样率的交错立体声 float（预载池 PCM 模式）
+    virtual bool decodeToPcm(const std::vector<char>& bytes, PcmBuffer& out) = 0;
+
+    // 探测文件头解析不认识的格式（MP3/WAV 之外）。默认不支持
+    virtual bool probe(const std::filesystem::path& path, AudioMetadata& metadata) {
+        (void)path;
+        (void)metadata;
+        return false;
+    }
+
+    // 声部交给混音器前的最后一站：可包一层记录起止时间的源。默认原样返回
+    virtual std::unique_ptr<MixerSource> traceVoice(const std::string& filename,
+                                                    std::unique_ptr<MixerSource> source) {
+        (void)filename;
+        return source;
+    }
+
+    // 系统主音量百分比 [0,100]，不支持或失败返回 0
+    virtual int getSystemVolume() { return 0; }
+};
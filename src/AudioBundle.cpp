@@ -0,0 +1,303 @@
+#include "AudioBundle.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include "PathUtil.h"
+
+namespace {
+constexpr char kMagic[8] = {'E', 'V', 'C', 'S', 'P', 'A', 'K', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = 32;
+constexpr size_t kEntryFixedBytes = 18;  // 偏移 u64 + 长度 u64 + 名称长度 u16
+constexpr uint64_t kDataAlignment = 64;
+constexpr size_t kCopyBytes = 1 << 20;
+
+uint64_t readLe(const char* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i-- > 0;) {
+        value = (value << 8) | static_cast<unsigned char>(p[i]);
+    }
+    return value;
+}
+
+void appendLe(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+std::string normalizeName(std::string_view name) {
+    std::string normalized(name);
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    return normalized;
+}
+
+bool fail(std::string* error, const char* reason) {
+    if (error) {
+        *error = reason;
+    }
+    return false;
+}
+
+// 当前挂载的打包文件：audio 目录首次使用或切换时打开一次，文件不存在也记下（不再反复查找）
+struct MountState {
+    std::mutex mutex;
+    bool valid = false;
+    std::filesystem::path dir;
+    std::shared_ptr<const AudioBundle> bundle;
+};
+
+MountState& mountState() {
+    static MountState state;
+    return state;
+}
+}  // namespace
+
+AudioBytes AudioBytes::fromVector(std::shared_ptr<const std::vector<char>> bytes) {
+    AudioBytes result;
+    if (bytes && !bytes->empty()) {
+        result.data = bytes->data();
+        result.size = bytes->size();
+        result.owner = std::move(bytes);
+    }
+    return result;
+}
+
+std::shared_ptr<AudioBundle> AudioBundle::open(const std::filesystem::path& path, std::string* error) {
+    auto bundle = std::make_shared<AudioBundle>();
+    if (!bundle->m_file.open(path, error)) {
+        return nullptr;
+    }
+    const char* base = bundle->m_file.data();
+    const uint64_t fileSize = bundle->m_file.size();
+    if (fileSize < kHeaderBytes || std::memcmp(base, kMagic, sizeof(kMagic)) != 0) {
+        fail(error, "不是音频打包文件");
+        return nullptr;
+    }
+    if (readLe(base + 8, 4) != kVersion) {
+        fail(error, "打包文件版本不支持");
+        return nullptr;
+    }
+    const uint64_t count = readLe(base + 12, 4);
+    const uint64_t indexBytes = readLe(base + 16, 8);
+    const uint64_t dataOffset = readLe(base + 24, 8);
+    if (indexBytes > fileSize - kHeaderBytes || dataOffset < kHeaderBytes + indexBytes || dataOffset > fileSize) {
+        fail(error, "索引越界");
+        return nullptr;
+    }
+
+    const char* p = base + kHeaderBytes;
+    const char* indexEnd = p + indexBytes;
+    bundle->m_entries.reserve(static_cast<size_t>(std::min<uint64_t>(count, indexBytes / kEntryFixedBytes)));
+    for (uint64_t i = 0; i < count; ++i) {
+        if (static_cast<size_t>(indexEnd - p) < kEntryFixedBytes) {
+            fail(error, "索引不完整");
+            return nullptr;
+        }
+        Entry entry;
+        entry.offset = readLe(p, 8);
+        entry.size = readLe(p + 8, 8);
+        size_t nameLength = static_cast<size_t>(readLe(p + 16, 2));
+        p += kEntryFixedBytes;
+        if (nameLength == 0 || static_cast<size_t>(indexEnd - p) < nameLength) {
+            fail(error, "索引不完整");
+            return nullptr;
+        }
+        entry.name = std::string_view(p, nameLength);
+        p += nameLength;
+        if (entry.offset < dataOffset || entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+            fail(error, "条目越界");
+            return nullptr;
+        }
+        if (!bundle->m_entries.empty() && !(bundle->m_entries.back().name < entry.name)) {
+            fail(error, "索引未排序或有重名");
+            return nullptr;
+        }
+        bundle->m_entries.push_back(entry);
+    }
+
+    std::error_code ec;
+    bundle->m_modifiedTime = std::filesystem::last_write_time(path, ec);
+    bundle->m_path = path;
+    return bundle;
+}
+
+AudioBytes AudioBundle::find(std::string_view name) const {
+    std::string normalized;
+    if (name.find('\\') != std::string_view::npos) {
+        normalized = normalizeName(name);
+        name = normalized;
+    }
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name,
+                               [](const Entry& entry, std::string_view key) { return entry.name < key; });
+    if (it == m_entries.end() || it->name != name) {
+        return AudioBytes();
+    }
+    AudioBytes bytes;
+    bytes.data = m_file.data() + it->offset;
+    bytes.size = static_cast<size_t>(it->size);
+    bytes.owner = shared_from_this();
+    return bytes;
+}
+
+bool AudioBundle::pack(const std::filesystem::path& dir, const std::vector<std::string>& files,
+                       const std::filesystem::path& output, std::string& error) {
+    struct Item {
+        std::string name;
+        std::filesystem::path path;
+        uint64_t size = 0;
+        uint64_t offset = 0;
+    };
+    std::vector<Item> items;
+    for (const auto& file : files) {
+        Item item;
+        item.name = normalizeName(file);
+        item.path = dir / std::filesystem::u8path(item.name);
+        std::error_code ec;
+        item.size = std::filesystem::file_size(item.path, ec);
+        if (ec) {
+            error = "无法读取 " + file;
+            return false;
+        }
+        if (item.size == 0 || item.name.size() > 0xFFFF) {
+            error = "文件为空或文件名过长: " + file;
+            return false;
+        }
+        items.push_back(std::move(item));
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.name < b.name; });
+    for (size_t i = 1; i < items.size(); ++i) {
+        if (items[i].name == items[i - 1].name) {
+            error = "文件重复: " + items[i].name;
+            return false;
+        }
+    }
+
+    uint64_t indexBytes = 0;
+    for (const auto& item : items) {
+        indexBytes += kEntryFixedBytes + item.name.size();
+    }
+    const uint64_t dataOffset = (kHeaderBytes + indexBytes + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+    uint64_t offset = dataOffset;
+    for (auto& item : items) {
+        item.offset = offset;
+        offset += item.size;
+    }
+
+    std::string head(kMagic, sizeof(kMagic));
+    appendLe(head, kVersion, 4);
+    appendLe(head, items.size(), 4);
+    appendLe(head, indexBytes, 8);
+    appendLe(head, dataOffset, 8);
+    for (const auto& item : items) {
+        appendLe(head, item.offset, 8);
+        appendLe(head, item.size, 8);
+        appendLe(head, item.name.size(), 2);
+        head += item.name;
+    }
+    head.resize(static_cast<size_t>(dataOffset), '\0');
+
+    // 先写临时文件再替换：打包到一半出错不会留下半截的包
+    std::filesystem::path temp = output;
+    temp += ".tmp";
+    bool ok = true;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "无法写入打包文件";
+            return false;
+        }
+        out.write(head.data(), static_cast<std::streamsize>(head.size()));
+        std::vector<char> buffer(kCopyBytes);
+        for (const auto& item : items) {
+            std::ifstream in(item.path, std::ios::binary);
+            uint64_t copied = 0;
+            while (in && copied < item.size) {
+                in.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(buffer.size(), item.size - copied)));
+                std::streamsize got = in.gcount();
+                if (got <= 0) {
+                    break;
+                }
+                out.write(buffer.data(), got);
+                copied += static_cast<uint64_t>(got);
+            }
+            // 打包期间文件被改动（长度与 stat 时不同）也算失败
+            if (copied != item.size || in.peek() != std::char_traits<char>::eof()) {
+                error = "读取失败或文件在打包期间被改动: " + item.name;
+                ok = false;
+                break;
+            }
+        }
+        if (ok && !out.flush()) {
+            error = "写入打包文件失败";
+            ok = false;
+        }
+    }
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(temp, output, ec);
+        if (ec) {
+            error = "无法替换打包文件（程序运行中会占用它）";
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::filesystem::remove(temp, ec);
+    }
+    return ok;
+}
+
+std::shared_ptr<const AudioBundle> AudioBundle::mounted() {
+    const std::filesystem::path dir = PathUtil::getAudioDir();
+    MountState& state = mountState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.valid || state.dir != dir) {
+        state.bundle.reset();
+        const std::filesystem::path path = dir / BUNDLE_FILENAME;
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec)) {
+            state.bundle = open(path);
+        }
+        state.dir = dir;
+        state.valid = true;
+    }
+    return state.bundle;
+}
+
+void AudioBundle::remount() {
+    MountState& state = mountState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.valid = false;
+    state.bundle.reset();
+}
+
+bool AudioBundle::locate(const std::string& filename, AudioLocation& location) {
+    location = AudioLocation();
+    location.path = PathUtil::getAudioPath(filename);
+    if (auto bundle = mounted()) {
+        AudioBytes bytes = bundle->find(filename);
+        if (!bytes.empty()) {
+            location.size = bytes.size;
+            location.modifiedTime = bundle->modifiedTime();
+            location.bytes = std::move(bytes);
+            return true;
+        }
+    }
+    std::error_code ec;
+    location.size = std::filesystem::file_size(location.path, ec);
+    if (!ec) {
+        location.modifiedTime = std::filesystem::last_write_time(location.path, ec);
+    }
+    return !ec;
+}
+
+bool AudioBundle::exists(const std::string& filename) {
+    if (auto bundle = mounted()) {
+        if (!bundle->find(filename).empty()) {
+            return true;
+        }
+    }
+    std::error_code ec;
+    return std::filesystem::exists(PathUtil::getAudioPath(filename), ec);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+// 内存中的原文件字节：指针 + 长度，owner 保证其在使用期间有效
+// （预载池的 vector，或打包文件的映射——后者零拷贝，解码直接读映射）
+struct AudioBytes {
+    const char* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
+
+    bool empty() const { return size == 0; }
+    static AudioBytes fromVector(std::shared_ptr<const std::vector<char>> bytes);
+};
+
+// 按文件名定位到的音频：打包条目时 bytes 指向映射，散文件时 bytes 为空
+struct AudioLocation {
+    std::filesystem::path path;  // audio 目录下的散文件路径（打包条目时仅作标识）
+    AudioBytes bytes;
+    uint64_t size = 0;
+    // 散文件为其修改时间；打包条目为打包文件的修改时间（重新打包后视为新文件）
+    std::filesystem::file_time_type modifiedTime;
+    bool inBundle() const { return !bytes.empty(); }
+};
+
+// 音频打包文件：一个文件内是索引 + 首尾相接的原音频文件字节（MP3/WAV 原样，不重新编码），
+// 由 evcs-pack 生成，放在 audio 目录下（evcs_audio.pak）。
+//
+// 打开时整体内存映射并校验索引，之后按文件名取音频只是在有序索引上二分查找，
+// 返回指向映射的 AudioBytes，不打开文件、不复制。包里没有的文件照旧取 audio 目录下的散文件。
+//
+// 格式（小端）：
+//   文件头 32 字节：魔数 "EVCSPAK1"、版本 u32、条目数 u32、索引字节数 u64、数据区起点 u64
+//   索引：每条 偏移 u64、长度 u64、名称长度 u16、名称（UTF-8，'/' 分隔），按名称字节序排列
+//   数据区：各文件字节，起点按 64 字节对齐
+class AudioBundle : public std::enable_shared_from_this<AudioBundle> {
+public:
+    static constexpr const char* BUNDLE_FILENAME = "evcs_audio.pak";
+
+    struct Entry {
+        std::string_view name;  // 指向映射中的索引
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    // 映射并校验 path。格式不符、越界或重名时返回空，error 非空时写入原因
+    static std::shared_ptr<AudioBundle> open(const std::filesystem::path& path, std::string* error = nullptr);
+
+    // 包内名为 name 的文件字节（'\\' 视同 '/'），没有返回空
+    AudioBytes find(std::string_view name) const;
+    const std::vector<Entry>& entries() const { return m_entries; }
+    const std::filesystem::path& path() const { return m_path; }
+    std::filesystem::file_time_type modifiedTime() const { return m_modifiedTime; }
+    uint64_t fileSize() const { return m_file.size(); }
+
+    // 把 dir 下的 files（相对路径，UTF-8）打包写入 output（先写临时文件再替换）。
+    // 任一文件读取失败即放弃，error 给出原因
+    static bool pack(const std::filesystem::path& dir, const std::vector<std::string>& files,
+                     const std::filesystem::path& output, std::string& error);
+
+    // 当前 audio 目录（PathUtil::getAudioDir()）下的打包文件，没有返回空。
+    // 首次调用或 audio 目录切换后打开一次，此后不再访问文件系统；打包文件更新后由 remount() 重新打开
+    static std::shared_ptr<const AudioBundle> mounted();
+    static void remount();
+
+    // 按文件名定位：先查打包文件索引，再 stat 散文件。都没有返回 false
+    static bool locate(const std::string& filename, AudioLocation& location);
+    static bool exists(const std::string& filename);
+
+private:
+    MappedFile m_file;
+    std::filesystem::path m_path;
+    std::filesystem::file_time_type m_modifiedTime;
+    std::vector<Entry> m_entries;  // 按名称排序
+};
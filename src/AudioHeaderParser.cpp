@@ -0,0 +1,411 @@
+#include "AudioHeaderParser.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+// RIFF 块遍历上限：正常 WAV 只有个位数的块，超过即视为损坏
+constexpr int kMaxRiffChunks = 256;
+constexpr size_t kId3v1Size = 128;
+// MP3 同步搜索每次读入的字节数（足以容纳最大的首帧与下一帧帧头）
+constexpr size_t kScanChunk = 4096;
+
+bool fail(std::string* error, const char* reason) {
+    if (error) {
+        *error = reason;
+    }
+    return false;
+}
+
+uint32_t readLe16(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+uint32_t readLe32(const uint8_t* p) {
+    return readLe16(p) | (readLe16(p + 2) << 16);
+}
+
+uint32_t readBe32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+bool readExact(const AudioHeaderParser::ReadAt& readAt, uint64_t offset, void* out, size_t size) {
+    return readAt(offset, out, size) == size;
+}
+
+// ---- WAV ----
+
+bool probeWav(const AudioHeaderParser::ReadAt& readAt, uint64_t fileSize, AudioFormatInfo& info,
+              std::string* error) {
+    uint8_t header[12];
+    if (!readExact(readAt, 0, header, sizeof(header)) || std::memcmp(header + 8, "WAVE", 4) != 0) {
+        return fail(error, "RIFF 文件不是 WAVE");
+    }
+
+    bool haveFormat = false;
+    bool haveData = false;
+    uint32_t formatTag = 0;
+    uint32_t byteRate = 0;
+    uint32_t blockAlign = 0;
+    uint64_t declaredBytes = 0;
+    uint64_t offset = 12;
+    for (int chunk = 0; chunk < kMaxRiffChunks && !(haveFormat && haveData); ++chunk) {
+        uint8_t chunkHeader[8];
+        if (offset + 8 > fileSize || !readExact(readAt, offset, chunkHeader, sizeof(chunkHeader))) {
+            break;
+        }
+        uint64_t chunkSize = readLe32(chunkHeader + 4);
+        uint64_t body = offset + 8;
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            size_t fmtSize = static_cast<size_t>(std::min<uint64_t>(chunkSize, sizeof(fmt)));
+            if (chunkSize < 16 || !readExact(readAt, body, fmt, fmtSize)) {
+                return fail(error, "WAV fmt 块损坏");
+            }
+            formatTag = readLe16(fmt);
+            info.channels = readLe16(fmt + 2);
+            info.sampleRate = readLe32(fmt + 4);
+            byteRate = readLe32(fmt + 8);
+            blockAlign = readLe16(fmt + 12);
+            info.bitsPerSample = readLe16(fmt + 14);
+            // WAVE_FORMAT_EXTENSIBLE：真实编码在子格式 GUID 的前两个字节
+            if (formatTag == 0xFFFE && chunkSize >= 40) {
+                formatTag = readLe16(fmt + 24);
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunkHeader, "data", 4) == 0) {
+            info.dataOffset = body;
+            // 录音中断/流式写出的文件 data 长度为 0 或 0xFFFFFFFF，按文件实际长度截断
+            uint64_t available = fileSize - body;
+            info.dataBytes = (chunkSize == 0 || chunkSize == 0xFFFFFFFFu || chunkSize > available) ? available
+                                                                                                 : chunkSize;
+            // 记录了长度却超出文件：拷贝不完整或中途损坏，保留声明值供完整性检查
+            declaredBytes = chunkSize != 0xFFFFFFFFu ? std::max<uint64_t>(chunkSize, info.dataBytes) : info.dataBytes;
+            haveData = true;
+        }
+        offset = body + chunkSize + (chunkSize & 1);
+    }
+
+    if (!haveFormat) {
+        return fail(error, "WAV 缺少 fmt 块");
+    }
+    if (!haveData) {
+        return fail(error, "WAV 缺少 data 块");
+    }
+    if (info.channels == 0 || info.channels > 32 || info.sampleRate < 1000 || info.sampleRate > 768000 ||
+        blockAlign == 0 || byteRate == 0) {
+        return fail(error, "WAV 格式参数非法");
+    }
+
+    info.bitrateKbps = byteRate * 8 / 1000;
+    info.exactLength = true;
+    if (formatTag == 1 || formatTag == 3) {
+        if (info.bitsPerSample < 8 || info.bitsPerSample > 64 ||
+            blockAlign != info.channels * ((info.bitsPerSample + 7) / 8)) {
+            return fail(error, "WAV PCM 参数不一致");
+        }
+        info.codec = formatTag == 1 ? AudioCodec::WAV_PCM : AudioCodec::WAV_FLOAT;
+        info.totalFrames = info.dataBytes / blockAlign;
+        info.durationSeconds = static_cast<double>(info.totalFrames) / info.sampleRate;
+        info.declaredSeconds = static_cast<double>(declaredBytes / blockAlign) / info.sampleRate;
+    } else {
+        info.codec = AudioCodec::WAV_OTHER;
+        info.durationSeconds = static_cast<double>(info.dataBytes) / byteRate;
+        info.totalFrames = static_cast<uint64_t>(info.durationSeconds * info.sampleRate);
+        info.declaredSeconds = static_cast<double>(declaredBytes) / byteRate;
+    }
+    return true;
+}
+
+// ---- MPEG 音频 ----
+
+struct MpegFrame {
+    int version = 0;  // 1 = MPEG-1，2 = MPEG-2，3 = MPEG-2.5
+    int layer = 0;
+    uint32_t bitrateKbps = 0;
+    uint32_t sampleRate = 0;
+    uint32_t channels = 0;
+    uint32_t samplesPerFrame = 0;
+    uint32_t frameBytes = 0;
+    uint32_t sideInfoBytes = 0;
+};
+
+constexpr uint16_t kBitrates[5][15] = {
+    {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},  // MPEG-1 Layer I
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},     // MPEG-1 Layer II
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},      // MPEG-1 Layer III
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},     // MPEG-2/2.5 Layer I
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},          // MPEG-2/2.5 Layer II/III
+};
+constexpr uint32_t kSampleRates[3][3] = {
+    {44100, 48000, 32000},
+    {22050, 24000, 16000},
+    {11025, 12000, 8000},
+};
+
+// 解析 4 字节帧头；保留值、free format 一律视为非法
+bool parseFrameHeader(const uint8_t* p, MpegFrame& frame) {
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    int versionBits = (p[1] >> 3) & 3;
+    int layerBits = (p[1] >> 1) & 3;
+    int bitrateIndex = p[2] >> 4;
+    int sampleRateIndex = (p[2] >> 2) & 3;
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3 ||
+        (p[3] & 3) == 2) {
+        return false;
+    }
+    frame.version = versionBits == 3 ? 1 : (versionBits == 2 ? 2 : 3);
+    frame.layer = 4 - layerBits;
+    int table = frame.version == 1 ? frame.layer - 1 : (frame.layer == 1 ? 3 : 4);
+    frame.bitrateKbps = kBitrates[table][bitrateIndex];
+    frame.sampleRate = kSampleRates[frame.version - 1][sampleRateIndex];
+    frame.channels = (p[3] >> 6) == 3 ? 1 : 2;
+    uint32_t padding = (p[2] >> 1) & 1;
+    uint32_t bitrate = frame.bitrateKbps * 1000;
+    if (frame.layer == 1) {
+        frame.samplesPerFrame = 384;
+        frame.frameBytes = (12 * bitrate / frame.sampleRate + padding) * 4;
+    } else if (frame.layer == 2 || frame.version == 1) {
+        frame.samplesPerFrame = 1152;
+        frame.frameBytes = 144 * bitrate / frame.sampleRate + padding;
+    } else {
+        frame.samplesPerFrame = 576;
+        frame.frameBytes = 72 * bitrate / frame.sampleRate + padding;
+    }
+    if (frame.version == 1) {
+        frame.sideInfoBytes = frame.channels == 1 ? 17 : 32;
+    } else {
+        frame.sideInfoBytes = frame.channels == 1 ? 9 : 17;
+    }
+    return frame.frameBytes >= 4;
+}
+
+bool sameStream(const MpegFrame& a, const MpegFrame& b) {
+    return a.version == b.version && a.layer == b.layer && a.sampleRate == b.sampleRate;
+}
+
+// 跳过文件头的 ID3v2 标签（可连续多个），返回音频数据起点
+uint64_t skipId3v2(const AudioHeaderParser::ReadAt& readAt, uint64_t fileSize) {
+    uint64_t offset = 0;
+    uint8_t header[10];
+    while (offset + sizeof(header) <= fileSize && readExact(readAt, offset, header, sizeof(header)) &&
+           std::memcmp(header, "ID3", 3) == 0) {
+        if ((header[6] | header[7] | header[8] | header[9]) & 0x80) {
+            break;  // 同步安全整数的最高位必须为 0
+        }
+        uint64_t size = (static_cast<uint64_t>(header[6]) << 21) | (header[7] << 14) | (header[8] << 7) | header[9];
+        offset += 10 + size + ((header[5] & 0x10) ? 10 : 0);
+    }
+    return offset;
+}
+
+// 首帧中的 Xing/Info 标签：写入帧数，并按 LAME 标签扣除编码延迟与补齐
+bool parseXing(const uint8_t* frameData, size_t available, const MpegFrame& frame, AudioFormatInfo& info,
+               uint64_t& frames) {
+    size_t offset = 4 + frame.sideInfoBytes;
+    if (offset + 8 > available ||
+        (std::memcmp(frameData + offset, "Xing", 4) != 0 && std::memcmp(frameData + offset, "Info", 4) != 0)) {
+        return false;
+    }
+    info.vbr = std::memcmp(frameData + offset, "Xing", 4) == 0;
+    uint32_t flags = readBe32(frameData + offset + 4);
+    offset += 8;
+    if (!(flags & 0x1) || offset + 4 > available) {
+        return false;  // 没有帧数字段，退回码率推算
+    }
+    frames = readBe32(frameData + offset);
+    offset += 4;
+    offset += (flags & 0x2) ? 4 : 0;
+    offset += (flags & 0x4) ? 100 : 0;
+    offset += (flags & 0x8) ? 4 : 0;
+
+    // LAME 标签：9 字节编码器名之后第 21 字节起 12 + 12 位的延迟/补齐
+    if (offset + 24 <= available && std::isalpha(frameData[offset]) && std::isalpha(frameData[offset + 1]) &&
+        std::isalpha(frameData[offset + 2]) && std::isalpha(frameData[offset + 3])) {
+        const uint8_t* p = frameData + offset + 21;
+        uint64_t delay = (static_cast<uint64_t>(p[0]) << 4) | (p[1] >> 4);
+        uint64_t padding = (static_cast<uint64_t>(p[1] & 0x0F) << 8) | p[2];
+        uint64_t samples = frames * frame.samplesPerFrame;
+        if (delay + padding < samples) {
+            info.totalFrames = samples - delay - padding;
+        }
+    }
+    return true;
+}
+
+// 首帧中的 VBRI 标签（Fraunhofer 编码器）：位置固定在帧头后 32 字节
+bool parseVbri(const uint8_t* frameData, size_t available, uint64_t& frames) {
+    constexpr size_t kOffset = 4 + 32;
+    if (kOffset + 18 > available || std::memcmp(frameData + kOffset, "VBRI", 4) != 0) {
+        return false;
+    }
+    frames = readBe32(frameData + kOffset + 14);
+    return frames > 0;
+}
+
+bool probeMpeg(const AudioHeaderParser::ReadAt& readAt, uint64_t fileSize, AudioFormatInfo& info,
+               std::string* error) {
+    const uint64_t start = skipId3v2(readAt, fileSize);
+    if (start >= fileSize) {
+        return fail(error, "只有 ID3 标签，没有音频数据");
+    }
+
+    // 末尾 ID3v1 标签不计入音频数据
+    uint64_t end = fileSize;
+    if (fileSize >= start + kId3v1Size) {
+        char tag[3];
+        if (readExact(readAt, fileSize - kId3v1Size, tag, sizeof(tag)) && std::memcmp(tag, "TAG", 3) == 0) {
+            end -= kId3v1Size;
+        }
+    }
+
+    // 按块读入同步搜索区：正常文件第一块内即可同步，损坏文件最多读到 MAX_SYNC_SCAN
+    const size_t scanLimit = static_cast<size_t>(std::min<uint64_t>(end - start, AudioHeaderParser::MAX_SYNC_SCAN));
+    std::vector<uint8_t> buffer;
+    auto extend = [&]() -> bool {
+        size_t have = buffer.size();
+        if (have >= scanLimit) {
+            return false;
+        }
+        buffer.resize(std::min(scanLimit, have + kScanChunk));
+        buffer.resize(have + readAt(start + have, buffer.data() + have, buffer.size() - have));
+        return buffer.size() > have;
+    };
+    extend();
+
+    // 帧同步：帧头合法，且紧随其后的位置是同一码流的下一个帧头（或恰好到文件尾）
+    MpegFrame frame;
+    size_t position = 0;
+    bool synced = false;
+    for (; position + 4 <= buffer.size() || (extend() && position + 4 <= buffer.size()); ++position) {
+        if (!parseFrameHeader(buffer.data() + position, frame)) {
+            continue;
+        }
+        uint64_t next = start + position + frame.frameBytes;
+        if (next == end) {
+            synced = true;
+            break;
+        }
+        uint8_t nextHeader[4];
+        MpegFrame nextFrame;
+        const uint8_t* nextData = nextHeader;
+        if (next + 4 <= start + buffer.size()) {
+            nextData = buffer.data() + (next - start);
+        } else if (next + 4 > end || !readExact(readAt, next, nextHeader, sizeof(nextHeader))) {
+            continue;
+        }
+        if (parseFrameHeader(nextData, nextFrame) && sameStream(frame, nextFrame)) {
+            synced = true;
+            break;
+        }
+    }
+    if (!synced) {
+        return fail(error, "文件头中未找到连续的 MPEG 音频帧");
+    }
+
+    info.codec = frame.layer == 3 ? AudioCodec::MP3 : (frame.layer == 2 ? AudioCodec::MP2 : AudioCodec::MP1);
+    info.sampleRate = frame.sampleRate;
+    info.channels = frame.channels;
+    info.dataOffset = start + position;
+    info.dataBytes = end - info.dataOffset;
+
+    // 首帧内容（标签在首帧内；首帧可能超出已读范围时补读）
+    std::vector<uint8_t> firstFrame(frame.frameBytes);
+    size_t available = std::min<size_t>(frame.frameBytes, buffer.size() - position);
+    std::memcpy(firstFrame.data(), buffer.data() + position, available);
+    if (available < frame.frameBytes) {
+        available += readAt(info.dataOffset + available, firstFrame.data() + available, frame.frameBytes - available);
+    }
+
+    uint64_t frames = 0;
+    bool tagged = frame.layer == 3 && parseXing(firstFrame.data(), available, frame, info, frames);
+    if (!tagged && parseVbri(firstFrame.data(), available, frames)) {
+        tagged = true;
+        info.vbr = true;
+    }
+    if (tagged && frames > 0) {
+        if (info.totalFrames == 0) {
+            info.totalFrames = frames * frame.samplesPerFrame;
+        }
+        info.durationSeconds = static_cast<double>(info.totalFrames) / frame.sampleRate;
+        info.bitrateKbps = static_cast<uint32_t>(info.dataBytes * 8 / 1000 / std::max(info.durationSeconds, 1e-3));
+        info.exactLength = true;
+    } else {
+        // CBR：按首帧码率推算
+        info.vbr = false;
+        info.bitrateKbps = frame.bitrateKbps;
+        info.durationSeconds = static_cast<double>(info.dataBytes) * 8.0 / (frame.bitrateKbps * 1000.0);
+        info.totalFrames = static_cast<uint64_t>(info.durationSeconds * frame.sampleRate);
+    }
+    info.declaredSeconds = info.durationSeconds;
+    return info.durationSeconds > 0.0;
+}
+}  // namespace
+
+const char* AudioFormatInfo::codecName() const {
+    switch (codec) {
+        case AudioCodec::MP3: return "mp3";
+        case AudioCodec::MP2: return "mp2";
+        case AudioCodec::MP1: return "mp1";
+        case AudioCodec::WAV_PCM:
+        case AudioCodec::WAV_FLOAT:
+        case AudioCodec::WAV_OTHER: return "wav";
+        default: return "";
+    }
+}
+
+bool AudioHeaderParser::probe(const ReadAt& readAt, uint64_t fileSize, AudioFormatInfo& info, std::string* error) {
+    info = AudioFormatInfo();
+    uint8_t magic[4];
+    if (fileSize < sizeof(magic) || !readExact(readAt, 0, magic, sizeof(magic))) {
+        return fail(error, "文件过短");
+    }
+    if (std::memcmp(magic, "RIFF", 4) == 0) {
+        return probeWav(readAt, fileSize, info, error);
+    }
+    if (std::memcmp(magic, "ID3", 3) == 0 || (magic[0] == 0xFF && (magic[1] & 0xE0) == 0xE0)) {
+        return probeMpeg(readAt, fileSize, info, error);
+    }
+    // 其他容器（RIFX/RF64、Ogg、FLAC 等）与非音频文件：不猜测，交给解码器
+    return fail(error, "不是 MP3 或 WAV 文件");
+}
+
+bool AudioHeaderParser::probeFile(const std::filesystem::path& path, AudioFormatInfo& info, std::string* error) {
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        info = AudioFormatInfo();
+        return fail(error, "文件不存在或无法访问");
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        info = AudioFormatInfo();
+        return fail(error, "文件无法打开");
+    }
+    auto readAt = [&file](uint64_t offset, void* out, size_t size) -> size_t {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(static_cast<char*>(out), static_cast<std::streamsize>(size));
+        return static_cast<size_t>(file.gcount());
+    };
+    return probe(readAt, fileSize, info, error);
+}
+
+bool AudioHeaderParser::probeMemory(const void* data, size_t size, AudioFormatInfo& info, std::string* error) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    auto readAt = [bytes, size](uint64_t offset, void* out, size_t count) -> size_t {
+        if (offset >= size) {
+            return 0;
+        }
+        size_t n = static_cast<size_t>(std::min<uint64_t>(count, size - offset));
+        std::memcpy(out, bytes + offset, n);
+        return n;
+    };
+    return probe(readAt, size, info, error);
+}
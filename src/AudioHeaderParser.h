@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+enum class AudioCodec {
+    UNKNOWN,
+    MP3,        // MPEG-1/2/2.5 Layer III
+    MP2,        // Layer II
+    MP1,        // Layer I
+    WAV_PCM,    // RIFF/WAVE 整数 PCM
+    WAV_FLOAT,  // RIFF/WAVE IEEE float
+    WAV_OTHER   // RIFF/WAVE 其他编码（ADPCM、MP3-in-WAV 等），时长按 byteRate 计算
+};
+
+struct AudioFormatInfo {
+    AudioCodec codec = AudioCodec::UNKNOWN;
+    double durationSeconds = 0.0;
+    uint32_t sampleRate = 0;
+    uint32_t channels = 0;
+    uint32_t bitsPerSample = 0;   // WAV 有效；MP3 为 0
+    uint32_t bitrateKbps = 0;     // MP3 为平均码率，WAV 为 byteRate 折算
+    uint64_t totalFrames = 0;     // 每声道采样数（MP3 已扣除 LAME 标签记录的编码延迟与补齐）
+    uint64_t dataOffset = 0;      // 首个音频帧 / data 块在文件中的位置
+    uint64_t dataBytes = 0;
+    bool vbr = false;             // 时长来自 Xing / VBRI 帧数而非码率推算
+    bool exactLength = false;     // 时长来自帧数/采样数（Xing、VBRI、Info 或 WAV data 块），而非 CBR 码率推算
+    // 文件头声明的时长：WAV data 块头记录的长度超出文件（拷贝不完整）时按记录值，大于 durationSeconds；
+    // 其余同 durationSeconds
+    double declaredSeconds = 0.0;
+
+    const char* codecName() const;
+};
+
+// 可移植的 MP3 / WAV 文件头解析：只读文件头（及 MP3 末尾 128 字节 ID3v1），
+// 不解码，给出时长与格式。无需 BASS，Linux 构建与工具链同样可用。
+//
+// - WAV：逐块查找 fmt / data，data 长度缺失或越界（录音中断的文件）时按文件实际长度截断；
+// - MP3：跳过 ID3v2，找到连续两个合法帧头才认定为 MPEG 音频；首帧带 Xing/Info 或 VBRI 标签时
+//   按帧数计算精确时长（并扣除 LAME 标签中的编码延迟与补齐），否则按 CBR 码率推算。
+//
+// 损坏或非音频文件在读完头部前即返回 false，error 给出原因。
+class AudioHeaderParser {
+public:
+    // 在 offset 处读至多 size 字节到 out，返回实际读到的字节数
+    using ReadAt = std::function<size_t(uint64_t offset, void* out, size_t size)>;
+
+    // MP3 帧同步的最大搜索范围（ID3v2 之后）
+    static constexpr size_t MAX_SYNC_SCAN = 64 * 1024;
+
+    static bool probeFile(const std::filesystem::path& path, AudioFormatInfo& info, std::string* error = nullptr);
+    static bool probeMemory(const void* data, size_t size, AudioFormatInfo& info, std::string* error = nullptr);
+    static bool probe(const ReadAt& readAt, uint64_t fileSize, AudioFormatInfo& info, std::string* error = nullptr);
+};
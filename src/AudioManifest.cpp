@@ -0,0 +1,459 @@
+#include "AudioManifest.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include "AudioMetadataCache.h"
+#include "XxHash64.h"
+
+namespace {
+// 文件首行：格式变化时递增版本号
+constexpr const char* MANIFEST_HEADER = "# EVCS audio manifest v1 xxh64";
+constexpr const char* STATE_HEADER = "# EVCS manifest state v1";
+// 计算哈希时每次读取的字节数
+constexpr size_t kHashReadBytes = 1 << 20;
+
+// 本机上次校验通过时的文件状态
+struct StateEntry {
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    uint64_t hash = 0;
+
+    bool operator==(const StateEntry& other) const {
+        return size == other.size && modifiedTime == other.modifiedTime && hash == other.hash;
+    }
+};
+using StateMap = std::map<std::string, StateEntry>;
+
+// 清单中的路径统一为 UTF-8、'/' 分隔，与发布机的平台无关
+std::string toManifestPath(const std::filesystem::path& relative) {
+    return relative.generic_u8string();
+}
+
+std::filesystem::path fromManifestPath(const std::filesystem::path& dir, const std::string& path) {
+    return dir / std::filesystem::u8path(path);
+}
+
+// 按制表符切出 count 个字段，最后一个字段取余下整行（路径可含空格与制表符以外的任意字符）
+bool splitFields(const std::string& line, size_t count, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t start = 0;
+    while (fields.size() + 1 < count) {
+        size_t tab = line.find('\t', start);
+        if (tab == std::string::npos) {
+            return false;
+        }
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    fields.push_back(line.substr(start));
+    return true;
+}
+
+// 先写临时文件再替换，写到一半断电/拔盘不会留下半截文件
+template <typename Writer>
+bool writeAtomically(const std::filesystem::path& path, const char* header, Writer writer) {
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << header << '\n';
+        writer(file);
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool readState(const std::filesystem::path& path, StateMap& entries) {
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != STATE_HEADER) {
+        return false;
+    }
+    std::vector<std::string> fields;
+    while (std::getline(file, line)) {
+        // 哈希 \t 大小 \t 修改时间 \t 路径
+        if (!splitFields(line, 4, fields) || fields[3].empty()) {
+            continue;
+        }
+        StateEntry entry;
+        entry.hash = std::strtoull(fields[0].c_str(), nullptr, 16);
+        entry.size = std::strtoull(fields[1].c_str(), nullptr, 10);
+        entry.modifiedTime = std::strtoll(fields[2].c_str(), nullptr, 10);
+        entries[fields[3]] = entry;
+    }
+    return true;
+}
+
+bool writeState(const std::filesystem::path& path, const StateMap& entries) {
+    return writeAtomically(path, STATE_HEADER, [&entries](std::ofstream& file) {
+        char buf[96];
+        for (const auto& entry : entries) {
+            std::snprintf(buf, sizeof(buf), "%016llx\t%llu\t%lld\t",
+                          static_cast<unsigned long long>(entry.second.hash),
+                          static_cast<unsigned long long>(entry.second.size),
+                          static_cast<long long>(entry.second.modifiedTime));
+            file << buf << entry.first << '\n';
+        }
+    });
+}
+
+bool isOwnFile(const std::string& name) {
+    if (name == AudioManifest::MANIFEST_FILENAME || name == AudioManifest::STATE_FILENAME ||
+        name == AudioMetadataCache::CACHE_FILENAME) {
+        return true;
+    }
+    const std::string suffix = ".tmp";
+    return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+}  // namespace
+
+bool AudioManifest::hashFile(const std::filesystem::path& path, uint64_t& hash, uint64_t* bytes,
+                             const std::atomic<bool>* cancel) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    XxHash64 hasher;
+    std::vector<char> buffer(kHashReadBytes);
+    uint64_t total = 0;
+    while (file) {
+        if (cancel && cancel->load()) {
+            return false;
+        }
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize got = file.gcount();
+        if (got <= 0) {
+            break;
+        }
+        hasher.update(buffer.data(), static_cast<size_t>(got));
+        total += static_cast<uint64_t>(got);
+    }
+    if (file.bad()) {
+        return false;
+    }
+    hash = hasher.digest();
+    if (bytes) {
+        *bytes = total;
+    }
+    return true;
+}
+
+std::vector<std::string> AudioManifest::listFiles(const std::filesystem::path& dir) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(dir, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        std::string relative = toManifestPath(it->path().lexically_relative(dir));
+        size_t slash = relative.rfind('/');
+        if (isOwnFile(slash == std::string::npos ? relative : relative.substr(slash + 1))) {
+            continue;
+        }
+        files.push_back(std::move(relative));
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool AudioManifest::generate(const std::filesystem::path& dir, size_t threads, std::vector<ManifestEntry>& entries,
+                             std::string& error) {
+    entries.clear();
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) {
+        error = "目录不存在";
+        return false;
+    }
+    const std::vector<std::string> files = listFiles(dir);
+    entries.resize(files.size());
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        for (size_t i = next++; i < files.size() && !failed.load(); i = next++) {
+            ManifestEntry& entry = entries[i];
+            entry.path = files[i];
+            if (!hashFile(fromManifestPath(dir, entry.path), entry.hash, &entry.size)) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!failed.exchange(true)) {
+                    error = "无法读取 " + entry.path;
+                }
+            }
+        }
+    };
+    const size_t count = std::min(threads > 0 ? threads : defaultThreads(), std::max<size_t>(files.size(), 1));
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < count; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (failed.load()) {
+        entries.clear();
+        return false;
+    }
+    if (!write(dir / MANIFEST_FILENAME, entries)) {
+        error = "无法写入清单文件";
+        return false;
+    }
+    return true;
+}
+
+bool AudioManifest::read(const std::filesystem::path& file, std::vector<ManifestEntry>& entries) {
+    entries.clear();
+    std::ifstream in(file, std::ios::binary);
+    std::string line;
+    if (!in || !std::getline(in, line) || line != MANIFEST_HEADER) {
+        return false;
+    }
+    std::vector<std::string> fields;
+    while (std::getline(in, line)) {
+        // 哈希 \t 大小 \t 路径
+        if (!splitFields(line, 3, fields) || fields[2].empty()) {
+            continue;
+        }
+        ManifestEntry entry;
+        entry.hash = std::strtoull(fields[0].c_str(), nullptr, 16);
+        entry.size = std::strtoull(fields[1].c_str(), nullptr, 10);
+        entry.path = fields[2];
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool AudioManifest::write(const std::filesystem::path& file, const std::vector<ManifestEntry>& entries) {
+    return writeAtomically(file, MANIFEST_HEADER, [&entries](std::ofstream& out) {
+        char buf[64];
+        for (const auto& entry : entries) {
+            std::snprintf(buf, sizeof(buf), "%016llx\t%llu\t", static_cast<unsigned long long>(entry.hash),
+                          static_cast<unsigned long long>(entry.size));
+            out << buf << entry.path << '\n';
+        }
+    });
+}
+
+size_t AudioManifest::defaultThreads() {
+    size_t cores = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(cores, 2, 8);
+}
+
+const char* AudioManifest::problemName(ManifestProblem problem) {
+    switch (problem) {
+    case ManifestProblem::MISSING:
+        return "缺失";
+    case ManifestProblem::SIZE_MISMATCH:
+        return "大小不符";
+    case ManifestProblem::HASH_MISMATCH:
+        return "内容不符";
+    case ManifestProblem::UNREADABLE:
+        return "无法读取";
+    }
+    return "未知";
+}
+
+ManifestVerifier::~ManifestVerifier() {
+    cancel();
+}
+
+void ManifestVerifier::setThreads(size_t threads) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threads = threads;
+}
+
+void ManifestVerifier::setBudget(std::chrono::milliseconds budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+}
+
+ManifestReport ManifestVerifier::verify(const std::filesystem::path& dir) {
+    return verifyImpl(dir, Completion());
+}
+
+void ManifestVerifier::verifyAsync(std::filesystem::path dir, Completion onBudget, Completion onDone) {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+    m_worker = std::thread([this, dir = std::move(dir), onBudget = std::move(onBudget),
+                            onDone = std::move(onDone)]() {
+        ManifestReport report = verifyImpl(dir, onBudget);
+        if (!report.cancelled && onDone) {
+            onDone(report);
+        }
+    });
+}
+
+void ManifestVerifier::cancel() {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+}
+
+ManifestReport ManifestVerifier::getReport() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_report;
+}
+
+ManifestReport ManifestVerifier::verifyImpl(const std::filesystem::path& dir, const Completion& onBudget) {
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    size_t threads;
+    std::chrono::milliseconds budget;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        threads = m_threads > 0 ? m_threads : AudioManifest::defaultThreads();
+        budget = m_budget;
+        m_report = ManifestReport();
+    }
+
+    ManifestReport report;
+    report.threads = threads;
+    std::vector<ManifestEntry> entries;
+    if (!AudioManifest::read(dir / AudioManifest::MANIFEST_FILENAME, entries)) {
+        report.complete = true;
+        report.elapsedMs = elapsedMs();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_report = report;
+        return report;
+    }
+    report.manifestFound = true;
+    report.files = entries.size();
+
+    // 第一遍只 stat：缺失与大小不符立即得出，大小与修改时间都未变的沿用上次结果
+    StateMap previous;
+    readState(dir / AudioManifest::STATE_FILENAME, previous);
+    StateMap state;
+    struct Pending {
+        const ManifestEntry* entry;
+        std::filesystem::path path;
+        int64_t modifiedTime;
+    };
+    std::vector<Pending> pending;
+    std::set<std::string> listed;
+    for (const ManifestEntry& entry : entries) {
+        listed.insert(entry.path);
+        std::filesystem::path path = fromManifestPath(dir, entry.path);
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            report.problems.emplace_back(entry.path, ManifestProblem::MISSING);
+            continue;
+        }
+        if (size != entry.size) {
+            report.problems.emplace_back(entry.path, ManifestProblem::SIZE_MISMATCH);
+            continue;
+        }
+        int64_t modifiedTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        auto it = previous.find(entry.path);
+        if (!ec && it != previous.end() && it->second == StateEntry{size, modifiedTime, entry.hash}) {
+            state[entry.path] = it->second;
+            ++report.verifiedFiles;
+            ++report.reusedFiles;
+            continue;
+        }
+        pending.push_back({&entry, std::move(path), modifiedTime});
+    }
+    for (const std::string& file : AudioManifest::listFiles(dir)) {
+        if (listed.count(file) == 0) {
+            ++report.unlistedFiles;
+        }
+    }
+    // 小文件优先：预算内确认的文件数最多，大文件留到最后
+    std::sort(pending.begin(), pending.end(),
+              [](const Pending& a, const Pending& b) { return a.entry->size < b.entry->size; });
+    report.pendingFiles = pending.size();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_report = report;
+    }
+
+    // 线程池从共享下标取任务，每完成一个文件更新一次 m_report 并通知协调线程
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < pending.size(); i = next++) {
+            const Pending& item = pending[i];
+            uint64_t hash = 0;
+            uint64_t bytes = 0;
+            bool readOk = AudioManifest::hashFile(item.path, hash, &bytes, &m_cancel);
+            if (m_cancel.load()) {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_report.pendingFiles;
+            ++m_report.hashedFiles;
+            m_report.hashedBytes += bytes;
+            if (!readOk) {
+                m_report.problems.emplace_back(item.entry->path, ManifestProblem::UNREADABLE);
+            } else if (hash != item.entry->hash || bytes != item.entry->size) {
+                m_report.problems.emplace_back(item.entry->path, ManifestProblem::HASH_MISMATCH);
+            } else {
+                ++m_report.verifiedFiles;
+                state[item.entry->path] = StateEntry{bytes, item.modifiedTime, hash};
+            }
+            m_progress.notify_all();
+        }
+    };
+    std::vector<std::thread> pool;
+    const size_t poolSize = std::min(threads, pending.size());
+    for (size_t i = 0; i < poolSize; ++i) {
+        pool.emplace_back(worker);
+    }
+
+    if (onBudget && !pending.empty()) {
+        ManifestReport partial;
+        bool overBudget = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            overBudget = !m_progress.wait_until(lock, start + budget, [this]() {
+                return m_report.pendingFiles == 0 || m_cancel.load();
+            });
+            if (overBudget) {
+                m_report.elapsedMs = elapsedMs();
+                partial = m_report;
+            }
+        }
+        if (overBudget && !m_cancel.load()) {
+            onBudget(partial);
+        }
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_report.cancelled = m_cancel.load();
+    m_report.complete = !m_report.cancelled && m_report.pendingFiles == 0;
+    m_report.elapsedMs = elapsedMs();
+    std::sort(m_report.problems.begin(), m_report.problems.end());
+    // 只记录校验通过的文件；取消时已确认的部分同样有效，下次不必重读
+    if (state != previous) {
+        writeState(dir / AudioManifest::STATE_FILENAME, state);
+    }
+    return m_report;
+}
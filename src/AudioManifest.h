@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 清单中的一个文件：audio 目录下的相对路径（UTF-8，'/' 分隔）、大小与 XXH64
+struct ManifestEntry {
+    std::string path;
+    uint64_t size = 0;
+    uint64_t hash = 0;
+};
+
+enum class ManifestProblem : uint8_t {
+    MISSING,        // 清单登记的文件不存在
+    SIZE_MISMATCH,  // 大小不符（stat 即可发现，不必读文件）
+    HASH_MISMATCH,  // 大小相同但内容不符
+    UNREADABLE      // 读取失败
+};
+
+struct ManifestReport {
+    bool manifestFound = false;  // audio 目录下没有清单时不做校验
+    size_t files = 0;            // 清单登记的文件数
+    size_t verifiedFiles = 0;    // 已确认完好（含沿用上次结果的）
+    size_t reusedFiles = 0;      // 大小与修改时间未变，沿用上次校验结果，未读文件
+    size_t hashedFiles = 0;      // 本次读完并计算了哈希的文件
+    size_t pendingFiles = 0;     // 尚未校验完的文件（预算用完时校验仍在进行）
+    size_t unlistedFiles = 0;    // 目录中有而清单未登记的文件（仅提示，不算问题）
+    uint64_t hashedBytes = 0;
+    size_t threads = 0;
+    std::vector<std::pair<std::string, ManifestProblem>> problems;
+    bool complete = false;       // 全部文件已有结论
+    bool cancelled = false;
+    double elapsedMs = 0.0;
+};
+
+// audio 目录完整性清单：发布时由 evcs-manifest 对 audio 目录下全部文件生成（路径、大小、XXH64），
+// 考场机启动时由 ManifestVerifier 在后台线程池上校验。
+//
+// 清单 evcs_manifest.txt 与本机校验状态 evcs_manifest.state 都在 audio 目录下；
+// 后者记录上次校验通过的文件的大小与修改时间，二者未变的文件不再读取（与元数据缓存同样的取舍：
+// 只改内容不改大小与修改时间的篡改不在防范之内，防的是拷贝不完整、U 盘坏块与误替换）。
+class AudioManifest {
+public:
+    static constexpr const char* MANIFEST_FILENAME = "evcs_manifest.txt";
+    static constexpr const char* STATE_FILENAME = "evcs_manifest.state";
+
+    // 读文件计算 XXH64。cancel 非空且置位时中途返回 false
+    static bool hashFile(const std::filesystem::path& path, uint64_t& hash, uint64_t* bytes = nullptr,
+                         const std::atomic<bool>* cancel = nullptr);
+
+    // dir 下的全部普通文件（递归，相对路径，按名称排序），不含清单、校验状态与元数据缓存等程序自己写的文件
+    static std::vector<std::string> listFiles(const std::filesystem::path& dir);
+
+    // 用 threads 个线程（0 为自动）计算 dir 下全部文件的哈希并写入清单。失败时 error 给出原因
+    static bool generate(const std::filesystem::path& dir, size_t threads, std::vector<ManifestEntry>& entries,
+                         std::string& error);
+
+    static bool read(const std::filesystem::path& file, std::vector<ManifestEntry>& entries);
+    static bool write(const std::filesystem::path& file, const std::vector<ManifestEntry>& entries);
+
+    // 默认线程数：读盘为主，取 CPU 核数并限制在 [2, 8]
+    static size_t defaultThreads();
+    static const char* problemName(ManifestProblem problem);
+};
+
+// 清单校验：先逐个 stat（缺失、大小不符立即得出），沿用未变化文件的上次结果，
+// 其余按文件从小到大交给线程池计算哈希——时间预算内能覆盖尽可能多的文件，
+// 多 GB 的听力文件排在最后。
+//
+// verifyAsync() 在后台线程上校验：到达时间预算仍未完成时先以部分结果调用 onBudget
+// （已发现的问题全部在内），校验继续进行，完成后调用 onDone。新的校验取消并等待上一次。
+class ManifestVerifier {
+public:
+    using Completion = std::function<void(const ManifestReport& report)>;
+    static constexpr std::chrono::milliseconds DEFAULT_BUDGET{2000};
+
+    ManifestVerifier() = default;
+    ~ManifestVerifier();
+
+    ManifestVerifier(const ManifestVerifier&) = delete;
+    ManifestVerifier& operator=(const ManifestVerifier&) = delete;
+
+    void setThreads(size_t threads);  // 0 为 AudioManifest::defaultThreads()
+    void setBudget(std::chrono::milliseconds budget);
+
+    // 同步校验 dir（不受预算限制）
+    ManifestReport verify(const std::filesystem::path& dir);
+    // 后台校验：onBudget / onDone 均在后台线程上调用（只应做投递，可为空；被取消时不调用）
+    void verifyAsync(std::filesystem::path dir, Completion onBudget, Completion onDone);
+    // 取消并等待进行中的后台校验
+    void cancel();
+
+    // 最近一次校验的结果（进行中为当前的部分结果）
+    ManifestReport getReport() const;
+
+private:
+    ManifestReport verifyImpl(const std::filesystem::path& dir, const Completion& onBudget);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_progress;  // 线程池每完成一个文件通知一次
+    ManifestReport m_report;
+    size_t m_threads = 0;
+    std::chrono::milliseconds m_budget = DEFAULT_BUDGET;
+
+    std::mutex m_workerMutex;  // 串行化 verifyAsync / cancel
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{false};
+};
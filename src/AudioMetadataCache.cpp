@@ -0,0 +1,376 @@
+#include "AudioMetadataCache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include "AudioHeaderParser.h"
+#include "AudioMixer.h"
+#include "LoudnessMeter.h"
+#include "PathUtil.h"
+#include "SilenceScanner.h"
+
+namespace {
+// 缓存文件首行：格式变化时递增版本号，旧文件整体作废
+constexpr const char* CACHE_HEADER = "# EVCS audio metadata v3";
+// 分析时每次从解码源读取的帧数（44.1kHz 约 0.37 秒）
+constexpr size_t kAnalysisReadFrames = 16384;
+
+// 按制表符切出 count 个字段，最后一个字段取余下整行（文件名可含空格）
+bool splitFields(const std::string& line, size_t count, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t start = 0;
+    while (fields.size() + 1 < count) {
+        size_t tab = line.find('\t', start);
+        if (tab == std::string::npos) {
+            return false;
+        }
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    fields.push_back(line.substr(start));
+    return true;
+}
+
+// 响度字段：未分析为 "-"，分析失败为 "x"，否则为 LUFS
+std::string formatLoudness(const AudioMetadata& metadata) {
+    if (metadata.loudnessStatus == LoudnessStatus::PENDING) {
+        return "-";
+    }
+    if (metadata.loudnessStatus == LoudnessStatus::FAILED) {
+        return "x";
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", metadata.loudnessLufs);
+    return buf;
+}
+
+void parseLoudness(const std::string& field, AudioMetadata& metadata) {
+    if (field == "x") {
+        metadata.loudnessStatus = LoudnessStatus::FAILED;
+    } else if (!field.empty() && field != "-") {
+        metadata.loudnessStatus = LoudnessStatus::MEASURED;
+        metadata.loudnessLufs = std::strtod(field.c_str(), nullptr);
+    }
+}
+}  // namespace
+
+AudioMetadataCache::~AudioMetadataCache() {
+    cancel();
+}
+
+bool AudioMetadataCache::probeHeader(const AudioLocation& location, AudioMetadata& metadata) {
+    AudioFormatInfo info;
+    bool recognized = location.inBundle()
+                          ? AudioHeaderParser::probeMemory(location.bytes.data, location.bytes.size, info)
+                          : AudioHeaderParser::probeFile(location.path, info);
+    if (!recognized) {
+        return false;
+    }
+    metadata.durationSeconds = info.durationSeconds;
+    metadata.sampleRate = info.sampleRate;
+    metadata.channels = info.channels;
+    metadata.codec = info.codecName();
+    return true;
+}
+
+bool AudioMetadataCache::analyzeSource(MixerSource& source, uint32_t sampleRate, AudioMetadata& metadata,
+                                       const std::function<bool()>& cancelled) {
+    LoudnessMeter meter(sampleRate);
+    SilenceScanner scanner;
+    std::vector<float> buffer(kAnalysisReadFrames * 2);
+    size_t frames = 0;
+    while ((frames = source.read(buffer.data(), kAnalysisReadFrames)) > 0) {
+        if (cancelled && cancelled()) {
+            return false;
+        }
+        scanner.add(buffer.data(), frames);
+        meter.add(buffer.data(), frames);
+    }
+    // 全静音的文件不裁剪
+    metadata.leadingSilenceSeconds =
+        scanner.found() && sampleRate > 0 ? static_cast<double>(scanner.leadingFrames()) / sampleRate : 0.0;
+
+    LoudnessResult result;
+    if (!meter.finish(result)) {
+        return false;
+    }
+    metadata.loudnessLufs = result.integratedLufs;
+    metadata.samplePeak = result.samplePeak;
+    return true;
+}
+
+void AudioMetadataCache::setProber(Prober prober) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_prober = std::move(prober);
+}
+
+void AudioMetadataCache::setAnalyzer(Analyzer analyzer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_analyzer = std::move(analyzer);
+}
+
+MetadataCacheStats AudioMetadataCache::refresh(const std::vector<std::string>& files) {
+    return refreshImpl(files, Completion());
+}
+
+void AudioMetadataCache::refreshAsync(std::vector<std::string> files, Completion onProbed, Completion onDone) {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+    m_worker = std::thread([this, files = std::move(files), onProbed = std::move(onProbed),
+                            onDone = std::move(onDone)]() {
+        MetadataCacheStats stats = refreshImpl(files, onProbed);
+        if (!stats.cancelled && onDone) {
+            onDone(stats);
+        }
+    });
+}
+
+void AudioMetadataCache::cancel() {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+}
+
+MetadataCacheStats AudioMetadataCache::refreshImpl(const std::vector<std::string>& files,
+                                                   const Completion& onProbed) {
+    std::lock_guard<std::mutex> refreshLock(m_refreshMutex);
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path dir = PathUtil::getAudioDir();
+    const std::filesystem::path cachePath = dir / CACHE_FILENAME;
+
+    MetadataCacheStats stats;
+    std::shared_ptr<const MetadataMap> previous;
+    Prober prober;
+    Analyzer analyzer;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_loadedDir == dir) {
+            previous = m_known;
+        }
+        prober = m_prober ? m_prober : Prober(probeHeader);
+        analyzer = m_analyzer;
+    }
+    // 本进程首次刷新（或 audio 目录已切换）：从缓存文件读入上一次的结果
+    if (!previous) {
+        auto loaded = std::make_shared<MetadataMap>();
+        readCacheFile(cachePath, *loaded);
+        stats.loadedEntries = loaded->size();
+        previous = std::move(loaded);
+    }
+
+    // 第一遍只 stat：未变化的记录直接沿用，其余留给第二遍探测
+    struct Pending {
+        std::string filename;
+        AudioLocation location;
+        AudioMetadata metadata;
+    };
+    auto next = std::make_shared<MetadataMap>();
+    std::vector<Pending> pending;
+    std::set<std::string> seen;
+    for (const auto& filename : files) {
+        if (!seen.insert(filename).second) {
+            continue;
+        }
+        Pending item{filename, {}, {}};
+        if (!AudioBundle::locate(filename, item.location)) {
+            ++stats.missingFiles;
+            continue;
+        }
+        item.metadata.fileSize = item.location.size;
+        item.metadata.modifiedTime = item.location.modifiedTime.time_since_epoch().count();
+        auto it = previous->find(filename);
+        if (it != previous->end() && it->second->fileSize == item.metadata.fileSize &&
+            it->second->modifiedTime == item.metadata.modifiedTime) {
+            (*next)[filename] = it->second;
+            ++stats.reusedFiles;
+        } else {
+            pending.push_back(std::move(item));
+        }
+    }
+    stats.requestedFiles = seen.size();
+    publish(next);
+
+    // 第二遍：探测新文件/已变化的文件。可被取消，已探测的部分照样发布
+    if (!pending.empty()) {
+        auto probed = std::make_shared<MetadataMap>(*next);
+        for (auto& item : pending) {
+            if (m_cancel.load()) {
+                stats.cancelled = true;
+                break;
+            }
+            AudioMetadata& metadata = item.metadata;
+            if (!prober || !prober(item.location, metadata) || metadata.durationSeconds <= 0.0) {
+                ++stats.probeFailures;
+                uint64_t size = metadata.fileSize;
+                int64_t modified = metadata.modifiedTime;
+                metadata = AudioMetadata();
+                metadata.fileSize = size;
+                metadata.modifiedTime = modified;
+            }
+            ++stats.probedFiles;
+            (*probed)[item.filename] = std::make_shared<const AudioMetadata>(std::move(metadata));
+        }
+        next = probed;
+        publish(next);
+    }
+    if (onProbed && !stats.cancelled) {
+        onProbed(stats);
+    }
+
+    // 第三遍：响度与开头静音分析（整文件解码）。每完成一个文件发布一次，起播时即可取用；可被取消
+    if (analyzer && !stats.cancelled) {
+        const auto analysisStart = std::chrono::steady_clock::now();
+        for (const auto& filename : files) {
+            auto it = next->find(filename);
+            if (it == next->end() || it->second->durationSeconds <= 0.0 ||
+                it->second->loudnessStatus != LoudnessStatus::PENDING) {
+                continue;
+            }
+            if (m_cancel.load()) {
+                stats.cancelled = true;
+                break;
+            }
+            AudioMetadata metadata = *it->second;
+            AudioLocation location;
+            bool measured = AudioBundle::locate(filename, location) && analyzer(location, metadata);
+            if (m_cancel.load()) {
+                stats.cancelled = true;  // 分析中途被取消，结果不可信，下次再分析
+                break;
+            }
+            if (measured) {
+                metadata.loudnessStatus = LoudnessStatus::MEASURED;
+            } else {
+                metadata.loudnessStatus = LoudnessStatus::FAILED;
+                ++stats.analysisFailures;
+            }
+            ++stats.analyzedFiles;
+            auto analyzed = std::make_shared<MetadataMap>(*next);
+            (*analyzed)[filename] = std::make_shared<const AudioMetadata>(std::move(metadata));
+            next = analyzed;
+            publish(next);
+        }
+        stats.analysisMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - analysisStart).count();
+    }
+
+    // 本次未引用的旧记录一并保留（切换配置再切回不必重新探测）；有新探测结果时写回，失败不影响本次结果
+    auto known = std::make_shared<MetadataMap>(*next);
+    for (const auto& entry : *previous) {
+        if (!seen.count(entry.first)) {
+            known->emplace(entry.first, entry.second);
+        }
+    }
+    if (stats.probedFiles > 0 || stats.analyzedFiles > 0) {
+        stats.saved = writeCacheFile(cachePath, *known);
+    }
+
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_known = std::move(known);
+    m_loadedDir = dir;
+    m_stats = stats;
+    return stats;
+}
+
+void AudioMetadataCache::publish(std::shared_ptr<const MetadataMap> entries) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries = std::move(entries);
+}
+
+std::shared_ptr<const AudioMetadata> AudioMetadataCache::find(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_entries) {
+        return nullptr;
+    }
+    auto it = m_entries->find(filename);
+    return it != m_entries->end() ? it->second : nullptr;
+}
+
+double AudioMetadataCache::getDuration(const std::string& filename) const {
+    auto metadata = find(filename);
+    return metadata ? metadata->durationSeconds : 0.0;
+}
+
+MetadataCacheStats AudioMetadataCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::map<std::string, AudioMetadata> AudioMetadataCache::readCache(const std::filesystem::path& dir) {
+    MetadataMap entries;
+    readCacheFile(dir / CACHE_FILENAME, entries);
+    std::map<std::string, AudioMetadata> result;
+    for (const auto& entry : entries) {
+        result.emplace(entry.first, *entry.second);
+    }
+    return result;
+}
+
+bool AudioMetadataCache::readCacheFile(const std::filesystem::path& path, MetadataMap& entries) {
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != CACHE_HEADER) {
+        return false;
+    }
+    std::vector<std::string> fields;
+    while (std::getline(file, line)) {
+        // 大小 \t 修改时间 \t 时长 \t 采样率 \t 声道 \t 编码 \t 响度 \t 峰值 \t 开头静音 \t 文件名
+        if (!splitFields(line, 10, fields) || fields[9].empty()) {
+            continue;
+        }
+        auto metadata = std::make_shared<AudioMetadata>();
+        metadata->fileSize = std::strtoull(fields[0].c_str(), nullptr, 10);
+        metadata->modifiedTime = std::strtoll(fields[1].c_str(), nullptr, 10);
+        metadata->durationSeconds = std::strtod(fields[2].c_str(), nullptr);
+        metadata->sampleRate = static_cast<uint32_t>(std::strtoul(fields[3].c_str(), nullptr, 10));
+        metadata->channels = static_cast<uint32_t>(std::strtoul(fields[4].c_str(), nullptr, 10));
+        metadata->codec = fields[5];
+        parseLoudness(fields[6], *metadata);
+        metadata->samplePeak = std::strtod(fields[7].c_str(), nullptr);
+        metadata->leadingSilenceSeconds = std::strtod(fields[8].c_str(), nullptr);
+        entries[fields[9]] = std::move(metadata);
+    }
+    return true;
+}
+
+bool AudioMetadataCache::writeCacheFile(const std::filesystem::path& path, const MetadataMap& entries) {
+    // 先写临时文件再替换，写到一半断电/拔盘不会留下半截缓存
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << CACHE_HEADER << '\n';
+        char buf[160];
+        for (const auto& entry : entries) {
+            const AudioMetadata& metadata = *entry.second;
+            std::snprintf(buf, sizeof(buf), "%llu\t%lld\t%.6f\t%u\t%u\t",
+                          static_cast<unsigned long long>(metadata.fileSize),
+                          static_cast<long long>(metadata.modifiedTime), metadata.durationSeconds,
+                          metadata.sampleRate, metadata.channels);
+            file << buf << metadata.codec << '\t' << formatLoudness(metadata) << '\t';
+            std::snprintf(buf, sizeof(buf), "%.6f\t%.6f\t", metadata.samplePeak, metadata.leadingSilenceSeconds);
+            file << buf << entry.first << '\n';
+        }
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioBundle.h"
+
+class MixerSource;
+
+// 响度分析状态：未分析的文件由后台分析补上，分析失败的在文件变化前不再重试
+enum class LoudnessStatus : uint8_t { PENDING, MEASURED, FAILED };
+
+// 一个音频文件的元数据。以 文件名（audio 目录下）+ 大小 + 修改时间 为键，
+// 三者之一变化即视为新文件重新探测（打包文件中的条目取包的修改时间，重新打包后重新探测）
+struct AudioMetadata {
+    uint64_t fileSize = 0;
+    int64_t modifiedTime = 0;      // file_time_type 的计数（仅与同一平台上的记录比较）
+    double durationSeconds = 0.0;  // <=0 表示探测失败（仍记录，未变化前不再重复探测）
+    uint32_t sampleRate = 0;
+    uint32_t channels = 0;
+    std::string codec;             // "mp3" / "wav" / ...，探测失败为空
+    LoudnessStatus loudnessStatus = LoudnessStatus::PENDING;
+    double loudnessLufs = 0.0;     // EBU R128 积分响度（MEASURED 时有效）
+    double samplePeak = 0.0;       // 采样峰值（线性）
+    // 首个非静音采样之前的时长（秒）。与响度同一遍分析得出，loudnessStatus 非 PENDING 即有效
+    // （过短无法测响度的文件照样有值；无法解码或全静音为 0）
+    double leadingSilenceSeconds = 0.0;
+};
+
+struct MetadataCacheStats {
+    size_t requestedFiles = 0;  // 不同文件数
+    size_t loadedEntries = 0;   // 从磁盘缓存文件读入的记录数
+    size_t reusedFiles = 0;     // 大小与修改时间未变，未重新探测
+    size_t probedFiles = 0;     // 新文件或已变化的文件
+    size_t probeFailures = 0;
+    size_t missingFiles = 0;
+    size_t analyzedFiles = 0;   // 本次做了响度分析的文件
+    size_t analysisFailures = 0;
+    double analysisMs = 0.0;
+    bool saved = false;         // 有变化且已写回缓存文件（audio 目录只读时为 false）
+    bool cancelled = false;
+    double elapsedMs = 0.0;
+};
+
+// 音频元数据缓存：时长、采样率、声道数、编码格式持久化在 audio 目录下的缓存文件中，
+// 启动时只对每个文件做一次 stat，未变化的文件不再打开解码流，界面可在播放前显示时长、检查重叠。
+//
+// refresh() 先校验已有记录并立即发布（只 stat），再探测新文件/已变化的文件，完成后发布并写回。
+// refreshAsync() 在后台线程上做同样的事，新的刷新会取消并等待上一次。
+// find() 可在任意线程调用，返回最近一次发布的记录。
+//
+// 探测默认由 AudioHeaderParser 读文件头完成（MP3/WAV，无需 BASS）；Windows 下注入的 Prober
+// 先读文件头，其他格式再交给 BASS。
+//
+// 设置了 Analyzer 时，探测结果发布之后再对尚未分析的文件做响度与开头静音分析（整文件解码，较慢），
+// 每分析完一个文件发布一次；结果与时长一起写入缓存文件，文件不变就不再分析。
+class AudioMetadataCache {
+public:
+    // 缓存文件名（位于 PathUtil::getAudioDir() 下）
+    static constexpr const char* CACHE_FILENAME = "evcs_metadata.cache";
+
+    // 探测 location（散文件或打包条目）的元数据，填写 durationSeconds / sampleRate / channels / codec。失败返回 false
+    using Prober = std::function<bool(const AudioLocation& location, AudioMetadata& metadata)>;
+    // 分析 location 的响度与开头静音，填写 loudnessLufs / samplePeak / leadingSilenceSeconds。
+    // 响度无法测量（无法解码、静音、过短）返回 false
+    using Analyzer = std::function<bool(const AudioLocation& location, AudioMetadata& metadata)>;
+    using Completion = std::function<void(const MetadataCacheStats& stats)>;
+
+    AudioMetadataCache() = default;
+    ~AudioMetadataCache();
+
+    AudioMetadataCache(const AudioMetadataCache&) = delete;
+    AudioMetadataCache& operator=(const AudioMetadataCache&) = delete;
+
+    void setProber(Prober prober);
+    void setAnalyzer(Analyzer analyzer);
+    // 默认探测器：AudioHeaderParser 读 MP3/WAV 文件头（打包条目直接读映射）
+    static bool probeHeader(const AudioLocation& location, AudioMetadata& metadata);
+    // Analyzer 的公共部分：逐段读完 source（sampleRate 的交错立体声），同一遍测响度并找首个非静音采样。
+    // cancelled 返回 true 时提前返回 false
+    static bool analyzeSource(MixerSource& source, uint32_t sampleRate, AudioMetadata& metadata,
+                              const std::function<bool()>& cancelled = std::function<bool()>());
+
+    // 同步刷新 files（经 AudioBundle::locate 定位：打包文件中的条目或 audio 目录下的散文件），含响度分析
+    MetadataCacheStats refresh(const std::vector<std::string>& files);
+    // 后台刷新：时长等探测结果发布后调用 onProbed，响度分析结束后调用 onDone。
+    // 均在后台线程上调用（可为空；被取消时不调用）
+    void refreshAsync(std::vector<std::string> files, Completion onProbed, Completion onDone = Completion());
+    // 取消并等待进行中的后台刷新
+    void cancel();
+    // 刷新正被取消：Analyzer 可据此提前返回（结果不会被记录）
+    bool cancelRequested() const { return m_cancel.load(); }
+
+    // 直接读 dir 下的缓存文件（不校验文件是否变化、不发布），供工具离线查看。
+    // 文件不存在或版本不符返回空
+    static std::map<std::string, AudioMetadata> readCache(const std::filesystem::path& dir);
+
+    // 已发布的记录，没有返回空
+    std::shared_ptr<const AudioMetadata> find(const std::string& filename) const;
+    // 已知时长（秒），未知或探测失败返回 0.0
+    double getDuration(const std::string& filename) const;
+    MetadataCacheStats getStats() const;
+
+private:
+    using MetadataMap = std::map<std::string, std::shared_ptr<const AudioMetadata>>;
+
+    MetadataCacheStats refreshImpl(const std::vector<std::string>& files, const Completion& onProbed);
+    void publish(std::shared_ptr<const MetadataMap> entries);
+    static bool readCacheFile(const std::filesystem::path& path, MetadataMap& entries);
+    static bool writeCacheFile(const std::filesystem::path& path, const MetadataMap& entries);
+
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const MetadataMap> m_entries;  // 已校验的记录（本次引用到的文件）
+    std::shared_ptr<const MetadataMap> m_known;    // 全部已知记录（含未引用、未校验的），即缓存文件内容
+    std::filesystem::path m_loadedDir;             // m_known 对应的 audio 目录（目录切换后重新读缓存文件）
+    MetadataCacheStats m_stats;
+    Prober m_prober;
+    Analyzer m_analyzer;
+
+    std::mutex m_refreshMutex;  // 同一时刻只有一次刷新在做
+    std::mutex m_workerMutex;   // 串行化 refreshAsync / cancel
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{false};
+};
@@ -0,0 +1,410 @@
+#include "AudioMirror.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include "AudioBundle.h"
+#include "AudioManifest.h"
+#include "AudioMetadataCache.h"
+#include "XxHash64.h"
+
+namespace {
+// 文件首行：格式变化时递增版本号
+constexpr const char* STATE_HEADER = "# EVCS mirror state v1";
+// 拷贝时每次读写的字节数
+constexpr size_t kCopyBytes = 1 << 20;
+// 拷贝中的临时文件后缀（与清单工具忽略的后缀一致）
+constexpr const char* kTempSuffix = ".tmp";
+// 可用空间须比待拷贝量多出的余量
+constexpr uint64_t kSpaceMarginBytes = 64ull * 1024 * 1024;
+
+// 上次校验通过时源文件的状态与内容哈希
+struct StateEntry {
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    uint64_t hash = 0;
+};
+using StateMap = std::map<std::string, StateEntry>;
+
+enum class CopyResult { OK, READ_FAILED, WRITE_FAILED, CANCELLED };
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double megabytes(uint64_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+// 哈希 \t 大小 \t 修改时间 \t 路径（路径取余下整行）
+void readState(const std::filesystem::path& path, StateMap& entries) {
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != STATE_HEADER) {
+        return;
+    }
+    while (std::getline(file, line)) {
+        size_t fields[3];
+        size_t start = 0;
+        bool ok = true;
+        for (size_t& tab : fields) {
+            tab = line.find('\t', start);
+            if (tab == std::string::npos) {
+                ok = false;
+                break;
+            }
+            start = tab + 1;
+        }
+        if (!ok || start >= line.size()) {
+            continue;
+        }
+        StateEntry entry;
+        entry.hash = std::strtoull(line.c_str(), nullptr, 16);
+        entry.size = std::strtoull(line.c_str() + fields[0] + 1, nullptr, 10);
+        entry.modifiedTime = std::strtoll(line.c_str() + fields[1] + 1, nullptr, 10);
+        entries[line.substr(start)] = entry;
+    }
+}
+
+// 先写临时文件再替换，写到一半被打断时保留旧状态
+bool writeState(const std::filesystem::path& path, const StateMap& entries) {
+    std::filesystem::path temp = path;
+    temp += kTempSuffix;
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << STATE_HEADER << '\n';
+        char buf[96];
+        for (const auto& entry : entries) {
+            std::snprintf(buf, sizeof(buf), "%016llx\t%llu\t%lld\t",
+                          static_cast<unsigned long long>(entry.second.hash),
+                          static_cast<unsigned long long>(entry.second.size),
+                          static_cast<long long>(entry.second.modifiedTime));
+            file << buf << entry.first << '\n';
+        }
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// 顺序读 from 写到 to，边读边算 XXH64
+CopyResult copyHashed(const std::filesystem::path& from, const std::filesystem::path& to, uint64_t& hash,
+                      uint64_t& bytes, const std::atomic<bool>& cancel) {
+    std::ifstream in(from, std::ios::binary);
+    if (!in) {
+        return CopyResult::READ_FAILED;
+    }
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return CopyResult::WRITE_FAILED;
+    }
+    XxHash64 hasher;
+    std::vector<char> buffer(kCopyBytes);
+    bytes = 0;
+    while (in) {
+        if (cancel.load()) {
+            return CopyResult::CANCELLED;
+        }
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto got = static_cast<size_t>(in.gcount());
+        if (got == 0) {
+            break;
+        }
+        hasher.update(buffer.data(), got);
+        if (!out.write(buffer.data(), static_cast<std::streamsize>(got))) {
+            return CopyResult::WRITE_FAILED;
+        }
+        bytes += got;
+    }
+    if (in.bad()) {
+        return CopyResult::READ_FAILED;
+    }
+    if (!out.flush()) {
+        return CopyResult::WRITE_FAILED;
+    }
+    hash = hasher.digest();
+    return CopyResult::OK;
+}
+}  // namespace
+
+AudioMirror::~AudioMirror() {
+    cancel();
+}
+
+std::filesystem::path AudioMirror::defaultMirrorDir() {
+    std::error_code ec;
+    std::filesystem::path temp = std::filesystem::temp_directory_path(ec);
+    if (ec) {
+        return std::filesystem::path();
+    }
+    return temp / "EVCS" / "audio_mirror";
+}
+
+std::vector<std::string> AudioMirror::listFiles(const std::filesystem::path& sourceDir,
+                                                const std::vector<std::string>& referenced) {
+    std::error_code ec;
+    const std::filesystem::path bundlePath = sourceDir / AudioBundle::BUNDLE_FILENAME;
+    std::shared_ptr<AudioBundle> bundle;
+    if (std::filesystem::exists(bundlePath, ec)) {
+        bundle = AudioBundle::open(bundlePath);
+    }
+    std::vector<std::string> files;
+    std::set<std::string> seen;
+    for (const std::string& file : referenced) {
+        // 打包文件中的条目随打包文件整体镜像
+        if ((bundle && !bundle->find(file).empty()) || !seen.insert(file).second) {
+            continue;
+        }
+        files.push_back(file);
+    }
+    for (const char* own : {AudioBundle::BUNDLE_FILENAME, AudioMetadataCache::CACHE_FILENAME}) {
+        if (std::filesystem::exists(sourceDir / own, ec) && seen.insert(own).second) {
+            files.push_back(own);
+        }
+    }
+    return files;
+}
+
+const char* AudioMirror::problemName(MirrorProblem problem) {
+    switch (problem) {
+    case MirrorProblem::MISSING:
+        return "源中缺失";
+    case MirrorProblem::READ_FAILED:
+        return "读取失败";
+    case MirrorProblem::WRITE_FAILED:
+        return "写入失败";
+    case MirrorProblem::HASH_MISMATCH:
+        return "校验不符";
+    }
+    return "未知";
+}
+
+std::string AudioMirror::formatReport(const MirrorReport& report) {
+    char buf[512];
+    if (report.cancelled) {
+        return "本机镜像: 已取消";
+    }
+    if (!report.error.empty()) {
+        return "本机镜像: 未启用（" + report.error + "）";
+    }
+    if (!report.complete) {
+        std::snprintf(buf, sizeof(buf), "本机镜像: 拷贝中 %zu/%zu", report.files - report.pendingFiles, report.files);
+        return buf;
+    }
+    size_t missing = 0;
+    const std::pair<std::string, MirrorProblem>* failure = nullptr;
+    for (const auto& problem : report.problems) {
+        if (problem.second == MirrorProblem::MISSING) {
+            ++missing;
+        } else if (!failure) {
+            failure = &problem;
+        }
+    }
+    std::snprintf(buf, sizeof(buf),
+                  "本机镜像: %s %zu 个文件（拷贝 %zu 个 %.1f MB，%.1f MB/s；沿用 %zu 个），用时 %.2f s",
+                  report.ready ? "就绪" : "未启用", report.files, report.copiedFiles, megabytes(report.copiedBytes),
+                  report.copyMegabytesPerSecond(), report.reusedFiles, report.elapsedMs / 1000.0);
+    std::string text = buf;
+    if (missing > 0) {
+        std::snprintf(buf, sizeof(buf), "，源中缺失 %zu 个", missing);
+        text += buf;
+    }
+    if (failure) {
+        text += "，" + failure->first + " " + problemName(failure->second);
+    }
+    return text;
+}
+
+MirrorReport AudioMirror::sync(const std::filesystem::path& sourceDir, const std::filesystem::path& mirrorDir,
+                               const std::vector<std::string>& files) {
+    return syncImpl(sourceDir, mirrorDir, files);
+}
+
+void AudioMirror::syncAsync(std::filesystem::path sourceDir, std::filesystem::path mirrorDir,
+                            std::vector<std::string> files, Completion onDone) {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+    m_worker = std::thread([this, sourceDir = std::move(sourceDir), mirrorDir = std::move(mirrorDir),
+                            files = std::move(files), onDone = std::move(onDone)]() {
+        MirrorReport report = syncImpl(sourceDir, mirrorDir, files);
+        if (!report.cancelled && onDone) {
+            onDone(report);
+        }
+    });
+}
+
+void AudioMirror::cancel() {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+}
+
+MirrorReport AudioMirror::getReport() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_report;
+}
+
+MirrorReport AudioMirror::syncImpl(const std::filesystem::path& sourceDir, const std::filesystem::path& mirrorDir,
+                                   const std::vector<std::string>& files) {
+    const auto start = std::chrono::steady_clock::now();
+    MirrorReport report;
+    report.sourceDir = sourceDir;
+    report.mirrorDir = mirrorDir;
+    report.files = files.size();
+    auto publish = [this, &report, &start]() {
+        report.elapsedMs = elapsedSince(start);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_report = report;
+    };
+    auto finish = [&]() {
+        report.cancelled = m_cancel.load();
+        report.complete = !report.cancelled;
+        std::sort(report.problems.begin(), report.problems.end());
+        const bool failed = std::any_of(report.problems.begin(), report.problems.end(), [](const auto& problem) {
+            return problem.second != MirrorProblem::MISSING;
+        });
+        report.ready = report.complete && report.error.empty() && !failed;
+        publish();
+        return report;
+    };
+
+    std::error_code ec;
+    if (mirrorDir.empty() || std::filesystem::equivalent(sourceDir, mirrorDir, ec)) {
+        report.error = "镜像目录无效";
+        return finish();
+    }
+    std::filesystem::create_directories(mirrorDir, ec);
+    if (!std::filesystem::is_directory(mirrorDir, ec)) {
+        report.error = "无法创建镜像目录";
+        return finish();
+    }
+
+    // 第一遍只 stat 源：缺失立即得出；源未变化且镜像大小相符的文件只回读镜像校验
+    StateMap previous;
+    readState(mirrorDir / STATE_FILENAME, previous);
+    StateMap state;
+    struct Pending {
+        const std::string* file;
+        std::filesystem::path source;
+        std::filesystem::path target;
+        uint64_t size;
+        std::filesystem::file_time_type modified;
+    };
+    std::vector<Pending> pending;
+    uint64_t pendingBytes = 0;
+    for (const std::string& file : files) {
+        const std::filesystem::path source = sourceDir / std::filesystem::u8path(file);
+        const std::filesystem::path target = mirrorDir / std::filesystem::u8path(file);
+        const uint64_t size = std::filesystem::file_size(source, ec);
+        if (ec) {
+            report.problems.emplace_back(file, MirrorProblem::MISSING);
+            continue;
+        }
+        const auto modified = std::filesystem::last_write_time(source, ec);
+        report.totalBytes += size;
+        const int64_t modifiedTime = modified.time_since_epoch().count();
+        auto it = previous.find(file);
+        if (it != previous.end() && it->second.size == size && it->second.modifiedTime == modifiedTime &&
+            std::filesystem::file_size(target, ec) == size && !ec) {
+            const auto verifyStart = std::chrono::steady_clock::now();
+            uint64_t hash = 0;
+            const bool hashed = AudioManifest::hashFile(target, hash, nullptr, &m_cancel);
+            report.verifyMs += elapsedSince(verifyStart);
+            if (hashed && hash == it->second.hash) {
+                state[file] = it->second;
+                ++report.reusedFiles;
+                continue;
+            }
+        }
+        pending.push_back({&file, source, target, size, modified});
+        pendingBytes += size;
+    }
+    if (m_cancel.load()) {
+        return finish();
+    }
+    report.pendingFiles = pending.size();
+    const auto space = std::filesystem::space(mirrorDir, ec);
+    if (!ec && space.available < pendingBytes + kSpaceMarginBytes) {
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "镜像目录空间不足，需要 %.0f MB，可用 %.0f MB", megabytes(pendingBytes),
+                      megabytes(space.available));
+        report.error = buf;
+        return finish();
+    }
+    publish();
+
+    // 第二遍顺序拷贝：读源算哈希 → 写临时文件 → 回读校验 → 换为正式文件并沿用源的修改时间
+    for (const Pending& item : pending) {
+        std::filesystem::path temp = item.target;
+        temp += kTempSuffix;
+        std::filesystem::create_directories(item.target.parent_path(), ec);
+        uint64_t hash = 0;
+        uint64_t bytes = 0;
+        const auto copyStart = std::chrono::steady_clock::now();
+        const CopyResult copied = copyHashed(item.source, temp, hash, bytes, m_cancel);
+        report.copyMs += elapsedSince(copyStart);
+        report.copiedBytes += bytes;
+        if (copied == CopyResult::CANCELLED) {
+            std::filesystem::remove(temp, ec);
+            break;
+        }
+        MirrorProblem problem = MirrorProblem::MISSING;
+        bool ok = copied == CopyResult::OK;
+        if (!ok) {
+            problem = copied == CopyResult::READ_FAILED ? MirrorProblem::READ_FAILED : MirrorProblem::WRITE_FAILED;
+        } else {
+            const auto verifyStart = std::chrono::steady_clock::now();
+            uint64_t verifyHash = 0;
+            uint64_t verifyBytes = 0;
+            ok = AudioManifest::hashFile(temp, verifyHash, &verifyBytes, &m_cancel) && verifyHash == hash &&
+                 verifyBytes == bytes && bytes == item.size;
+            report.verifyMs += elapsedSince(verifyStart);
+            if (m_cancel.load()) {
+                std::filesystem::remove(temp, ec);
+                break;
+            }
+            problem = MirrorProblem::HASH_MISMATCH;
+        }
+        if (ok) {
+            std::filesystem::rename(temp, item.target, ec);
+            ok = !ec;
+            if (ok) {
+                std::filesystem::last_write_time(item.target, item.modified, ec);
+            }
+            problem = MirrorProblem::WRITE_FAILED;
+        }
+        if (ok) {
+            state[*item.file] = StateEntry{item.size, item.modified.time_since_epoch().count(), hash};
+            ++report.copiedFiles;
+        } else {
+            std::filesystem::remove(temp, ec);
+            report.problems.emplace_back(*item.file, problem);
+        }
+        --report.pendingFiles;
+        publish();
+    }
+
+    // 只记录校验通过的文件；取消时已拷好的部分同样有效，下次不必再读源
+    writeState(mirrorDir / STATE_FILENAME, state);
+    return finish();
+}
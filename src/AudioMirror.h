@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class MirrorProblem : uint8_t {
+    MISSING,       // 源目录中没有（不影响就绪：镜像与源一样缺这个文件）
+    READ_FAILED,   // 读源文件失败（U 盘拔出、坏扇区）
+    WRITE_FAILED,  // 写镜像失败（空间不足、无权限、镜像文件被占用）
+    HASH_MISMATCH  // 回读镜像的大小或 XXH64 与读源时算出的不一致
+};
+
+struct MirrorReport {
+    std::filesystem::path sourceDir;
+    std::filesystem::path mirrorDir;
+    size_t files = 0;          // 需要镜像的文件：引用到的散文件、打包文件与元数据缓存
+    size_t copiedFiles = 0;
+    size_t reusedFiles = 0;    // 镜像中已有且校验通过，未从源读取
+    size_t pendingFiles = 0;
+    uint64_t totalBytes = 0;
+    uint64_t copiedBytes = 0;
+    double copyMs = 0.0;       // 读源 + 写镜像
+    double verifyMs = 0.0;     // 回读镜像计算哈希（含沿用文件的校验）
+    double elapsedMs = 0.0;    // 开始到结束；就绪时即 time-to-ready
+    std::vector<std::pair<std::string, MirrorProblem>> problems;  // 按路径排序
+    std::string error;         // 整体失败的原因（镜像目录无法创建、空间不足），否则为空
+    bool complete = false;
+    bool cancelled = false;
+    bool ready = false;        // 除源中缺失的文件外全部在镜像中校验通过，可以重定向
+
+    double copyMegabytesPerSecond() const {
+        return copyMs > 0.0 ? copiedBytes / (1024.0 * 1024.0) / (copyMs / 1000.0) : 0.0;
+    }
+};
+
+// 本机镜像：把配置引用到的音频从慢速/可移动介质（U 盘上程序目录下的 audio）拷到本机目录（或内存盘），
+// 校验通过后由调用方经 PathUtil::setAudioMirror() 把取音频重定向到镜像，考试期间不再随机读 U 盘。
+//
+// 单线程顺序拷贝（U 盘并发随机读反而更慢），边读边算 XXH64，写完回读镜像再算一遍，大小与哈希都一致
+// 才把临时文件换为正式文件，并沿用源文件的修改时间（元数据缓存与打包条目以修改时间为键，镜像中照样命中）。
+// 镜像目录下的状态文件记录上次校验通过时源文件的大小、修改时间与哈希：源未变化时只回读本机镜像校验，
+// 不再读 U 盘，第二次启动的就绪时间只取决于本机磁盘。
+//
+// syncAsync() 在后台线程上拷贝，结束后调用 onDone（就绪与否见 report.ready）；新的同步取消并等待上一次。
+class AudioMirror {
+public:
+    using Completion = std::function<void(const MirrorReport& report)>;
+    static constexpr const char* STATE_FILENAME = "evcs_mirror.state";
+
+    AudioMirror() = default;
+    ~AudioMirror();
+
+    AudioMirror(const AudioMirror&) = delete;
+    AudioMirror& operator=(const AudioMirror&) = delete;
+
+    // 默认镜像目录：系统临时目录下的 EVCS/audio_mirror
+    static std::filesystem::path defaultMirrorDir();
+    // 需要镜像的文件（相对路径，UTF-8）：referenced 中不在源打包文件里的，加上源目录下的打包文件与元数据缓存
+    static std::vector<std::string> listFiles(const std::filesystem::path& sourceDir,
+                                              const std::vector<std::string>& referenced);
+    static const char* problemName(MirrorProblem problem);
+    // 一行摘要：就绪/未就绪、文件数、拷贝量与吞吐、就绪用时，以及第一个问题
+    static std::string formatReport(const MirrorReport& report);
+
+    // 同步镜像 files（listFiles 的结果）
+    MirrorReport sync(const std::filesystem::path& sourceDir, const std::filesystem::path& mirrorDir,
+                      const std::vector<std::string>& files);
+    // 后台镜像：onDone 在后台线程上调用（只应做投递，可为空；被取消时不调用）
+    void syncAsync(std::filesystem::path sourceDir, std::filesystem::path mirrorDir, std::vector<std::string> files,
+                   Completion onDone);
+    // 取消并等待进行中的后台镜像
+    void cancel();
+
+    // 最近一次同步的结果（进行中为当前的部分结果）
+    MirrorReport getReport() const;
+
+private:
+    MirrorReport syncImpl(const std::filesystem::path& sourceDir, const std::filesystem::path& mirrorDir,
+                          const std::vector<std::string>& files);
+
+    mutable std::mutex m_mutex;
+    MirrorReport m_report;
+
+    std::mutex m_workerMutex;  // 串行化 syncAsync / cancel
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{false};
+};
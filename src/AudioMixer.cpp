@@ -0,0 +1,578 @@
+#include "AudioMixer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace std::chrono;
+
+namespace {
+constexpr size_t kChannels = 2;
+constexpr size_t kResampleChunkFrames = 1024;
+
+float approach(float current, float target, float maxDelta) {
+    if (current < target) {
+        return std::min(current + maxDelta, target);
+    }
+    return std::max(current - maxDelta, target);
+}
+}  // namespace
+
+size_t PcmBufferSource::read(float* out, size_t frames) {
+    const size_t total = m_buffer ? m_buffer->frames() : 0;
+    const size_t count = std::min(frames, total - std::min(m_position, total));
+    if (count > 0) {
+        std::memcpy(out, m_buffer->samples.data() + m_position * kChannels, count * kChannels * sizeof(float));
+        m_position += count;
+    }
+    return count;
+}
+
+size_t SequenceSource::read(float* out, size_t frames) {
+    size_t total = 0;
+    while (total < frames && m_current < m_parts.size()) {
+        Part& part = m_parts[m_current];
+        float* dest = out + total * kChannels;
+        const size_t count = part.source->read(dest, frames - total);
+        if (part.gain != 1.0f) {
+            m_kernels.scale(dest, count * kChannels, part.gain);
+        }
+        total += count;
+        if (total < frames) {
+            ++m_current;  // 本段已读尽，下一段接着填
+        }
+    }
+    return total;
+}
+
+ResamplingSource::ResamplingSource(std::unique_ptr<MixerSource> inner, uint32_t inputRate, uint32_t outputRate)
+    : m_inner(std::move(inner)),
+      m_step(outputRate > 0 ? static_cast<double>(inputRate) / outputRate : 1.0),
+      m_input(kResampleChunkFrames * kChannels) {}
+
+bool ResamplingSource::refill() {
+    // 保留插值仍需要的最后一帧，其余丢弃后从 inner 续读
+    const size_t consumed = std::min(static_cast<size_t>(m_position), m_inputFrames);
+    const size_t keep = m_inputFrames - consumed;
+    if (keep > 0 && consumed > 0) {
+        std::memmove(m_input.data(), m_input.data() + consumed * kChannels, keep * kChannels * sizeof(float));
+    }
+    m_inputFrames = keep;
+    m_position -= static_cast<double>(consumed);
+    if (m_innerDone) {
+        return false;
+    }
+    size_t got = m_inner->read(m_input.data() + keep * kChannels, kResampleChunkFrames - keep);
+    if (got < kResampleChunkFrames - keep) {
+        m_innerDone = true;
+    }
+    m_inputFrames += got;
+    return got > 0;
+}
+
+size_t ResamplingSource::read(float* out, size_t frames) {
+    size_t produced = 0;
+    while (produced < frames) {
+        size_t index = static_cast<size_t>(m_position);
+        if (index + 1 >= m_inputFrames) {
+            if (!refill()) {
+                break;
+            }
+            continue;
+        }
+        const float t = static_cast<float>(m_position - static_cast<double>(index));
+        const float* a = m_input.data() + index * kChannels;
+        const float* b = a + kChannels;
+        out[produced * kChannels] = a[0] + (b[0] - a[0]) * t;
+        out[produced * kChannels + 1] = a[1] + (b[1] - a[1]) * t;
+        m_position += m_step;
+        ++produced;
+    }
+    return produced;
+}
+
+AudioMixer::AudioMixer(const MixerConfig& config)
+    : m_config(config),
+      m_kernels(PcmKernels::get(config.kernel)),
+      m_commands(config.commandCapacity),
+      // 存活的源至多为：排队中的 PLAY + 各声部及其接续 + 待回收，回收队列按其上界开
+      m_retired(config.commandCapacity + config.voiceCount * 2),
+      m_voices(config.voiceCount),
+      m_scratch(config.blockFrames * kChannels),
+      m_publishedHandles(new std::atomic<VoiceHandle>[config.voiceCount]) {
+    const double rampFrames = std::max(1.0, m_config.rampMs * m_config.sampleRate / 1000.0);
+    m_maxStepPerFrame = static_cast<float>(1.0 / rampFrames);
+    for (size_t i = 0; i < m_config.voiceCount; ++i) {
+        m_publishedHandles[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+AudioMixer::~AudioMixer() {
+    stopRenderThread();
+    Command command;
+    while (m_commands.tryPop(command)) {
+        delete command.source;
+    }
+    for (auto& voice : m_voices) {
+        delete voice.source;
+        delete voice.next;
+        voice.source = nullptr;
+        voice.next = nullptr;
+    }
+    collectRetired();
+}
+
+// ---- 控制端 ----
+
+bool AudioMixer::pushCommand(Command command) {
+    collectRetired();
+    return m_commands.tryPush(std::move(command));
+}
+
+AudioMixer::VoiceHandle AudioMixer::play(std::unique_ptr<MixerSource> source, int priority, float gain) {
+    if (!source) {
+        return 0;
+    }
+    Command command;
+    command.type = CommandType::PLAY;
+    command.handle = m_nextHandle;
+    command.priority = priority;
+    command.gain = gain;
+    command.source = source.get();
+    if (!pushCommand(command)) {
+        return 0;  // 队满：source 仍归调用方的 unique_ptr 释放
+    }
+    source.release();
+    // 句柄单调递增且跳过 0；回绕需要连续 40 亿次播放，不做处理
+    if (++m_nextHandle == 0) {
+        m_nextHandle = 1;
+    }
+    return command.handle;
+}
+
+AudioMixer::VoiceHandle AudioMixer::playAfter(VoiceHandle previous, std::unique_ptr<MixerSource> source,
+                                              int priority, float gain) {
+    if (!source) {
+        return 0;
+    }
+    Command command;
+    command.type = CommandType::PLAY_AFTER;
+    command.handle = m_nextHandle;
+    command.priority = priority;
+    command.gain = gain;
+    command.source = source.get();
+    command.previous = previous;
+    if (!pushCommand(command)) {
+        return 0;
+    }
+    source.release();
+    if (++m_nextHandle == 0) {
+        m_nextHandle = 1;
+    }
+    return command.handle;
+}
+
+void AudioMixer::stop(VoiceHandle handle) {
+    if (handle == 0) {
+        return;
+    }
+    Command command;
+    command.type = CommandType::STOP;
+    command.handle = handle;
+    pushCommand(command);
+}
+
+void AudioMixer::stopAll() {
+    Command command;
+    command.type = CommandType::STOP_ALL;
+    pushCommand(command);
+}
+
+void AudioMixer::setPriority(VoiceHandle handle, int priority) {
+    Command command;
+    command.type = CommandType::SET_PRIORITY;
+    command.handle = handle;
+    command.priority = priority;
+    pushCommand(command);
+}
+
+void AudioMixer::setGain(VoiceHandle handle, float gain) {
+    Command command;
+    command.type = CommandType::SET_GAIN;
+    command.handle = handle;
+    command.gain = gain;
+    pushCommand(command);
+}
+
+bool AudioMixer::isPlaying(VoiceHandle handle) const {
+    if (handle == 0) {
+        return false;
+    }
+    // 先读已处理句柄（acquire），再读声部：渲染端发布声部在前、推进句柄在后
+    if (handle > m_appliedHandle.load(std::memory_order_acquire)) {
+        return true;  // PLAY 命令尚在队列中
+    }
+    for (size_t i = 0; i < m_config.voiceCount; ++i) {
+        if (m_publishedHandles[i].load(std::memory_order_acquire) == handle) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AudioMixer::collectRetired() {
+    MixerSource* source = nullptr;
+    while (m_retired.tryPop(source)) {
+        delete source;
+    }
+}
+
+// ---- 渲染端 ----
+
+AudioMixer::Voice* AudioMixer::findVoice(VoiceHandle handle) {
+    for (auto& voice : m_voices) {
+        if (voice.source && voice.handle == handle) {
+            return &voice;
+        }
+    }
+    return nullptr;
+}
+
+void AudioMixer::retire(MixerSource* source) {
+    // 回收队列按上界开，满只可能发生在控制端长期不回收时，此时只能就地释放
+    if (source && !m_retired.tryPush(source)) {
+        delete source;
+    }
+}
+
+bool AudioMixer::releaseVoice(size_t index) {
+    Voice& voice = m_voices[index];
+    // 未接上的接续声部随本声部一起释放（被停止或抢占时不再接续）
+    if (voice.next && !m_retired.tryPush(voice.next)) {
+        voice.finished = true;  // 回收队列满：保持占用，下块重试
+        return false;
+    }
+    voice.next = nullptr;
+    if (voice.source && !m_retired.tryPush(voice.source)) {
+        voice.finished = true;
+        return false;
+    }
+    voice = Voice();
+    m_publishedHandles[index].store(0, std::memory_order_release);
+    return true;
+}
+
+void AudioMixer::applyPlay(const Command& command) {
+    // 空闲声部优先，其次抢占：正在淡出的 > 优先级最低的 > 最早开始的
+    size_t target = m_voices.size();
+    for (size_t i = 0; i < m_voices.size(); ++i) {
+        if (!m_voices[i].source) {
+            target = i;
+            break;
+        }
+    }
+    if (target == m_voices.size() && !m_voices.empty()) {
+        auto rank = [](const Voice& voice) {
+            return std::make_tuple(voice.stopping || voice.finished ? 0 : 1, voice.priority, voice.handle);
+        };
+        size_t victim = 0;
+        for (size_t i = 1; i < m_voices.size(); ++i) {
+            if (rank(m_voices[i]) < rank(m_voices[victim])) {
+                victim = i;
+            }
+        }
+        const Voice& candidate = m_voices[victim];
+        // 已结束或正在淡出的声部只是回收槽位，仍在出声的才算抢占
+        const bool playing = !candidate.stopping && !candidate.finished;
+        bool reclaimable = !playing || candidate.priority <= command.priority;
+        if (reclaimable && releaseVoice(victim)) {
+            if (playing) {
+                m_stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            target = victim;
+        }
+    }
+    if (target == m_voices.size()) {
+        // 无可抢占：丢弃新请求
+        retire(command.source);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Voice& voice = m_voices[target];
+    voice.source = command.source;
+    voice.handle = command.handle;
+    voice.priority = command.priority;
+    voice.gain = command.gain;
+    voice.envelope = command.gain;  // 起播不淡入，保证起点准时
+    m_publishedHandles[target].store(command.handle, std::memory_order_release);
+    recordOnset(command.handle, 0);
+}
+
+void AudioMixer::applyPlayAfter(const Command& command) {
+    Voice* voice = findVoice(command.previous);
+    if (!voice || voice->stopping || voice->finished) {
+        applyPlay(command);  // 上一路已读尽或正在停止：不再等，立即起播
+        return;
+    }
+    retire(voice->next);  // 同一声部只挂一个接续，新的替换旧的
+    voice->next = command.source;
+    voice->nextHandle = command.handle;
+    voice->nextPriority = command.priority;
+    voice->nextGain = command.gain;
+}
+
+// 声部 index 的源在块内第 got 帧读尽：就地换上接续源，从同一帧起填满本块的剩余部分。
+// 返回接续源读到的帧数，写在 m_scratch 的第 got 帧之后
+size_t AudioMixer::handOff(size_t index, size_t got, size_t frames) {
+    Voice& voice = m_voices[index];
+    const VoiceHandle ended = voice.handle;
+    retire(voice.source);
+    voice.source = voice.next;
+    voice.handle = voice.nextHandle;
+    voice.priority = voice.nextPriority;
+    voice.next = nullptr;
+    voice.nextHandle = 0;
+    // 先发布新句柄再通知：收到通知的一方看到上一路已结束时，接续声部已在发声
+    m_publishedHandles[index].store(voice.handle, std::memory_order_release);
+    recordOnset(voice.handle, m_chunkOffset + got);
+    m_handoffs.fetch_add(1, std::memory_order_relaxed);
+    if (m_endCallback) {
+        m_endCallback(ended);
+    }
+    return voice.source->read(m_scratch.data() + got * kChannels, frames - got);
+}
+
+void AudioMixer::recordOnset(VoiceHandle handle, size_t frameOffset) {
+    // PLAY 命令在本次 render 开头生效，声部从第一块第一帧起发声；接续声部从接上的那一帧起。
+    // 均排在设备已排队的数据之后
+    auto onset = m_renderBegin + duration_cast<steady_clock::duration>(duration<double>(
+        static_cast<double>(m_renderQueuedFrames + frameOffset) / m_config.sampleRate));
+    OnsetSlot& slot = m_onsets[handle % ONSET_SLOTS];
+    slot.handle.store(0, std::memory_order_relaxed);
+    slot.ticks.store(onset.time_since_epoch().count(), std::memory_order_release);
+    slot.handle.store(handle, std::memory_order_release);
+}
+
+bool AudioMixer::getOnsetTime(VoiceHandle handle, steady_clock::time_point& onset) const {
+    if (handle == 0) {
+        return false;
+    }
+    const OnsetSlot& slot = m_onsets[handle % ONSET_SLOTS];
+    if (slot.handle.load(std::memory_order_acquire) != handle) {
+        return false;
+    }
+    int64_t ticks = slot.ticks.load(std::memory_order_acquire);
+    if (slot.handle.load(std::memory_order_acquire) != handle) {
+        return false;
+    }
+    onset = steady_clock::time_point(steady_clock::duration(ticks));
+    return true;
+}
+
+void AudioMixer::applyCommands() {
+    Command command;
+    while (m_commands.tryPop(command)) {
+        switch (command.type) {
+            case CommandType::PLAY:
+                applyPlay(command);
+                m_appliedHandle.store(command.handle, std::memory_order_release);
+                break;
+            case CommandType::PLAY_AFTER:
+                applyPlayAfter(command);
+                m_appliedHandle.store(command.handle, std::memory_order_release);
+                break;
+            case CommandType::STOP:
+                if (Voice* voice = findVoice(command.handle)) {
+                    voice->stopping = true;
+                    break;
+                }
+                // 尚未接上的接续声部：直接摘下
+                for (auto& voice : m_voices) {
+                    if (voice.next && voice.nextHandle == command.handle) {
+                        retire(voice.next);
+                        voice.next = nullptr;
+                        voice.nextHandle = 0;
+                    }
+                }
+                break;
+            case CommandType::STOP_ALL:
+                for (auto& voice : m_voices) {
+                    voice.stopping = voice.source != nullptr;
+                }
+                break;
+            case CommandType::SET_PRIORITY:
+                if (Voice* voice = findVoice(command.handle)) {
+                    voice->priority = command.priority;
+                }
+                break;
+            case CommandType::SET_GAIN:
+                if (Voice* voice = findVoice(command.handle)) {
+                    voice->gain = command.gain;
+                }
+                break;
+        }
+    }
+}
+
+void AudioMixer::mixChunk(float* out, size_t frames) {
+    std::fill(out, out + frames * kChannels, 0.0f);
+
+    // 闪避：低于当前最高优先级的声部压到 duckGain
+    bool anyVoice = false;
+    int topPriority = 0;
+    for (const auto& voice : m_voices) {
+        if (voice.source && !voice.stopping && !voice.finished) {
+            topPriority = anyVoice ? std::max(topPriority, voice.priority) : voice.priority;
+            anyVoice = true;
+        }
+    }
+
+    const float maxDelta = m_maxStepPerFrame * static_cast<float>(frames);
+    for (size_t v = 0; v < m_voices.size(); ++v) {
+        Voice& voice = m_voices[v];
+        if (!voice.source) {
+            continue;
+        }
+        if (voice.finished) {
+            releaseVoice(v);
+            continue;
+        }
+
+        float target = voice.gain * (voice.priority < topPriority ? m_config.duckGain : 1.0f);
+        if (voice.stopping) {
+            target = 0.0f;
+        }
+        const float startGain = voice.envelope;
+        const float endGain = approach(startGain, target, maxDelta);
+        voice.envelope = endGain;
+
+        size_t got = voice.source->read(m_scratch.data(), frames);
+        if (got < frames && voice.next && !voice.stopping) {
+            // 接续声部按自己的增益接上：本块剩余部分先按增益比缩放，包络随之换算，不做过渡
+            const float nextGain = voice.nextGain;
+            const float ratio = voice.gain > 0.0f ? nextGain / voice.gain : 1.0f;
+            const size_t from = got;
+            got += handOff(v, got, frames);
+            if (ratio != 1.0f) {
+                m_kernels.scale(m_scratch.data() + from * kChannels, (got - from) * kChannels, ratio);
+            }
+            voice.gain = nextGain;
+            voice.envelope = endGain * ratio;
+        }
+        if (got < frames) {
+            voice.finished = true;
+            if (m_endCallback && !voice.stopping) {
+                m_endCallback(voice.handle);
+            }
+        }
+
+        // 块内增益线性过渡，避免闪避/淡出的台阶噪声
+        if (startGain == endGain) {
+            m_kernels.mixAdd(out, m_scratch.data(), got * kChannels, endGain);
+        } else {
+            m_kernels.mixAddRamp(out, m_scratch.data(), got, startGain,
+                                 (endGain - startGain) / static_cast<float>(frames));
+        }
+
+        if (voice.finished || (voice.stopping && endGain <= 0.0f)) {
+            releaseVoice(v);
+        }
+    }
+
+    m_kernels.clamp(out, frames * kChannels);
+}
+
+void AudioMixer::render(float* out, size_t frames) {
+    auto begin = steady_clock::now();
+    m_renderBegin = begin;
+    applyCommands();
+    const size_t block = std::max<size_t>(m_config.blockFrames, 1);
+    for (size_t done = 0; done < frames; done += block) {
+        m_chunkOffset = done;
+        mixChunk(out + done * kChannels, std::min(block, frames - done));
+    }
+
+    uint64_t costNs = static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - begin).count());
+    m_renderedFrames.fetch_add(frames, std::memory_order_relaxed);
+    m_totalCostNs.fetch_add(costNs, std::memory_order_relaxed);
+    m_lastCostNs.store(costNs, std::memory_order_relaxed);
+    if (costNs > m_maxCostNs.load(std::memory_order_relaxed)) {
+        m_maxCostNs.store(costNs, std::memory_order_relaxed);  // 仅渲染端写，无需 CAS
+    }
+}
+
+bool AudioMixer::startRenderThread(MixerOutput& output) {
+    if (m_running.exchange(true)) {
+        return false;
+    }
+    m_renderThread = std::thread(&AudioMixer::renderLoop, this, &output);
+    return true;
+}
+
+void AudioMixer::stopRenderThread() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_renderThread.joinable()) {
+        m_renderThread.join();
+    }
+}
+
+void AudioMixer::renderLoop(MixerOutput* output) {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#endif
+    std::vector<float> block(m_config.blockFrames * kChannels);
+    const auto blockPeriod = duration_cast<microseconds>(
+        duration<double>(static_cast<double>(m_config.blockFrames) / m_config.sampleRate));
+    bool primed = false;
+    while (m_running.load(std::memory_order_acquire)) {
+        m_heartbeat.store(steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        size_t queued = output->queuedFrames();
+        if (queued >= m_config.targetQueuedFrames) {
+            // 队列够深：睡半块再看，设备时钟决定节奏，不与墙钟漂移
+            std::this_thread::sleep_for(blockPeriod / 2);
+            continue;
+        }
+        if (primed && queued == 0) {
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_renderQueuedFrames = queued;
+        render(block.data(), m_config.blockFrames);
+        if (!output->write(block.data(), m_config.blockFrames)) {
+            // 设备已不接受数据（排队量多为 0）：按块时长退避，声部仍按实时进度前进而不是瞬间读完
+            m_failedWrites.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(blockPeriod);
+        }
+        primed = true;
+    }
+}
+
+MixerStats AudioMixer::getStats() const {
+    MixerStats stats;
+    const size_t block = std::max<size_t>(m_config.blockFrames, 1);
+    stats.blocks = m_renderedFrames.load(std::memory_order_relaxed) / block;
+    uint64_t totalNs = m_totalCostNs.load(std::memory_order_relaxed);
+    stats.avgCostUs = stats.blocks > 0 ? totalNs / 1000.0 / static_cast<double>(stats.blocks) : 0.0;
+    stats.maxCostUs = m_maxCostNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.lastCostUs = m_lastCostNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.budgetUs = m_config.sampleRate > 0
+        ? static_cast<double>(m_config.blockFrames) * 1e6 / m_config.sampleRate : 0.0;
+    stats.load = stats.budgetUs > 0.0 ? stats.avgCostUs / stats.budgetUs : 0.0;
+    stats.underruns = m_underruns.load(std::memory_order_relaxed);
+    stats.stolen = m_stolen.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.handoffs = m_handoffs.load(std::memory_order_relaxed);
+    stats.failedWrites = m_failedWrites.load(std::memory_order_relaxed);
+    stats.heartbeat = steady_clock::time_point(steady_clock::duration(m_heartbeat.load(std::memory_order_relaxed)));
+    for (size_t i = 0; i < m_config.voiceCount; ++i) {
+        if (m_publishedHandles[i].load(std::memory_order_relaxed) != 0) {
+            ++stats.activeVoices;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "CpuFeatures.h"
+#include "PcmKernels.h"
+#include "SpscQueue.h"
+
+// 混音输入源：以混音器采样率输出交错立体声 float 帧。
+// read() 只在渲染线程上调用，不得读文件或等锁：从磁盘解码的源须包一层 ReadAheadSource 再交给混音器
+class MixerSource {
+public:
+    virtual ~MixerSource() = default;
+    // 读取至多 frames 帧到 out（frames * 2 个 float）。返回实际帧数，小于 frames 表示已到结尾
+    virtual size_t read(float* out, size_t frames) = 0;
+};
+
+// 内存中的 PCM 数据（交错立体声，已是混音器采样率），可被多个声部共享
+struct PcmBuffer {
+    std::vector<float> samples;
+    uint32_t sampleRate = 44100;
+
+    size_t frames() const { return samples.size() / 2; }
+    double durationSeconds() const {
+        return sampleRate > 0 ? static_cast<double>(frames()) / sampleRate : 0.0;
+    }
+};
+
+class PcmBufferSource : public MixerSource {
+public:
+    // 从 startFrame 帧处开始（裁去开头静音），超出长度即为空源
+    explicit PcmBufferSource(std::shared_ptr<const PcmBuffer> buffer, size_t startFrame = 0)
+        : m_buffer(std::move(buffer)), m_position(startFrame) {}
+    size_t read(float* out, size_t frames) override;
+
+private:
+    std::shared_ptr<const PcmBuffer> m_buffer;
+    size_t m_position = 0;
+};
+
+// 依次读完各段，段与段之间不留空隙：某段在块中间读尽时，同一块的剩余部分由下一段接着填满。
+// 各段可带各自的增益（分别做响度归一化）。读尽的段不在渲染线程上释放，随整个源一起回收
+class SequenceSource : public MixerSource {
+public:
+    struct Part {
+        std::unique_ptr<MixerSource> source;
+        float gain = 1.0f;
+    };
+
+    explicit SequenceSource(std::vector<Part> parts) : m_parts(std::move(parts)) {}
+    size_t read(float* out, size_t frames) override;
+
+private:
+    std::vector<Part> m_parts;
+    size_t m_current = 0;
+    const PcmKernels& m_kernels = PcmKernels::get();
+};
+
+// 线性插值变采样：把 inner（inputRate，交错立体声）换算到 outputRate。
+// 提示音与人声对线性插值不敏感，换取渲染线程上恒定且极低的开销
+class ResamplingSource : public MixerSource {
+public:
+    ResamplingSource(std::unique_ptr<MixerSource> inner, uint32_t inputRate, uint32_t outputRate);
+    size_t read(float* out, size_t frames) override;
+
+private:
+    bool refill();
+
+    std::unique_ptr<MixerSource> m_inner;
+    double m_step;                 // 每个输出帧在输入上前进的帧数
+    double m_position = 0.0;       // 相对 m_input 起点的输入帧位置
+    std::vector<float> m_input;
+    size_t m_inputFrames = 0;
+    bool m_innerDone = false;
+};
+
+// 设备输出端：渲染线程按设备已排队的帧数决定何时补写下一块
+class MixerOutput {
+public:
+    virtual ~MixerOutput() = default;
+    // 设备尚未播放的已排队帧数
+    virtual size_t queuedFrames() = 0;
+    // 追加 frames 帧交错立体声数据
+    virtual bool write(const float* samples, size_t frames) = 0;
+};
+
+struct MixerConfig {
+    uint32_t sampleRate = 44100;
+    size_t voiceCount = 8;
+    size_t blockFrames = 441;            // 每块 10ms
+    size_t targetQueuedFrames = 441 * 4; // 渲染线程维持的设备排队量（决定命令生效延迟）
+    float duckGain = 0.25f;              // 被更高优先级压低时的增益（约 -12 dB）
+    double rampMs = 30.0;                // 闪避/恢复/停止淡出的增益过渡时长
+    size_t commandCapacity = 256;
+    SimdLevel kernel = CpuFeatures::best();  // 混音内核级别（PcmKernels），不支持时回退到标量
+};
+
+// 混音开销统计：load 为每块平均开销占块时长的比例，1 - load 即 CPU 余量
+struct MixerStats {
+    uint64_t blocks = 0;     // 已混出的块数（按 blockFrames 折算）
+    double avgCostUs = 0.0;  // 每块平均开销
+    double maxCostUs = 0.0;  // 单次 render 最大开销
+    double lastCostUs = 0.0;
+    double budgetUs = 0.0;   // 一块音频的时长
+    double load = 0.0;
+    uint64_t underruns = 0;  // 渲染线程补写时设备队列已空
+    uint64_t stolen = 0;     // 声部用尽时被抢占的仍在出声的低优先级声部
+    uint64_t dropped = 0;    // 声部用尽且无可抢占时被丢弃的播放请求
+    uint64_t handoffs = 0;   // 接续声部在上一路读尽的同一帧接上的次数
+    uint64_t failedWrites = 0;  // 写入输出端失败的块数（设备消失）
+    int activeVoices = 0;
+    // 渲染线程最近一次循环的时刻（含排队量足够时的等待）；长时间不更新说明渲染线程卡在读取或写入中
+    std::chrono::steady_clock::time_point heartbeat;
+};
+
+// N 声部实时混音器。
+//
+// 控制端（界面/调度线程）经无锁命令队列下发播放/停止/优先级/增益，
+// 渲染端（专用渲染线程，或直接调用 render() 的设备回调/基准）取命令、拉取各声部源、
+// 按优先级闪避并叠加输出。新播放不再截断上一路：同时段的提示可以叠加，
+// 较低优先级的声部被压到 duckGain，高优先级结束后平滑恢复。
+//
+// 声部用尽时抢占优先级最低（同级取最早）的声部；新请求优先级更低则丢弃。
+// 接续声部（playAfter）挂在上一路所在的声部上，上一路读尽的那一帧起由它接着填满本块，中间没有空隙。
+// 源对象在渲染线程上只移交不释放，结束后经回收队列交还控制端析构，
+// 渲染路径上没有锁和堆分配。
+//
+// 控制端接口须串行调用（单线程或外部加锁）；render() 与渲染线程二选一。
+class AudioMixer {
+public:
+    using VoiceHandle = uint32_t;  // 0 表示无效
+    static constexpr int PRIORITY_BACKGROUND = 0;
+    static constexpr int PRIORITY_NORMAL = 50;
+    static constexpr int PRIORITY_FOREGROUND = 100;
+
+    explicit AudioMixer(const MixerConfig& config = MixerConfig());
+    ~AudioMixer();
+
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    const MixerConfig& getConfig() const { return m_config; }
+
+    // ---- 控制端 ----
+    // 新开一个声部播放 source（接管所有权）。命令队列满返回 0
+    VoiceHandle play(std::unique_ptr<MixerSource> source, int priority, float gain = 1.0f);
+    // 接续播放：previous 读尽的同一帧起播放 source，沿用其声部。previous 被停止时一并丢弃；
+    // 渲染端处理命令时 previous 已不在发声则立即起播。接上之前 isPlaying() 为 false。命令队列满返回 0
+    VoiceHandle playAfter(VoiceHandle previous, std::unique_ptr<MixerSource> source, int priority,
+                          float gain = 1.0f);
+    void stop(VoiceHandle handle);
+    void stopAll();
+    void setPriority(VoiceHandle handle, int priority);
+    void setGain(VoiceHandle handle, float gain);
+    // 声部是否仍在发声（含尚未被渲染端取走的播放命令）
+    bool isPlaying(VoiceHandle handle) const;
+    // 析构渲染端交还的源对象（各控制端接口内部也会调用）
+    void collectRetired();
+
+    // 声部读尽时（含接续声部接上的那一刻）在渲染线程上调用，参数为读尽的声部。
+    // 只应做唤醒之类的轻量操作，不得调用本类的控制端接口。须在启动渲染线程（或首次 render()）之前设置
+    void setEndCallback(std::function<void(VoiceHandle)> callback) { m_endCallback = std::move(callback); }
+
+    // ---- 渲染端 ----
+    // 混出 frames 帧交错立体声到 out（覆盖写）
+    void render(float* out, size_t frames);
+
+    // 专用渲染线程：按 output 排队量补写，维持 targetQueuedFrames 的提前量
+    bool startRenderThread(MixerOutput& output);
+    void stopRenderThread();
+
+    MixerStats getStats() const;
+
+    // 声部首帧预计出声的时刻：渲染该块的时刻 + 当时设备已排队的帧数（直接调用 render() 时排队量按 0 计）。
+    // 尚未渲染、被丢弃或记录已被之后的 ONSET_SLOTS 个声部覆盖时返回 false。可在任意线程调用
+    bool getOnsetTime(VoiceHandle handle, std::chrono::steady_clock::time_point& onset) const;
+
+private:
+    static constexpr size_t ONSET_SLOTS = 64;
+
+    // 渲染端写、控制端读：句柄两次读取一致才采信时刻
+    struct OnsetSlot {
+        std::atomic<VoiceHandle> handle{0};
+        std::atomic<int64_t> ticks{0};  // steady_clock 计数
+    };
+
+    enum class CommandType : uint8_t { PLAY, PLAY_AFTER, STOP, STOP_ALL, SET_PRIORITY, SET_GAIN };
+
+    struct Command {
+        CommandType type = CommandType::STOP;
+        VoiceHandle handle = 0;
+        int priority = 0;
+        float gain = 1.0f;
+        MixerSource* source = nullptr;  // PLAY/PLAY_AFTER 时移交所有权
+        VoiceHandle previous = 0;       // PLAY_AFTER 接在其后的声部
+    };
+
+    struct Voice {
+        MixerSource* source = nullptr;
+        VoiceHandle handle = 0;
+        int priority = 0;
+        float gain = 1.0f;
+        float envelope = 1.0f;   // 当前实际增益（含闪避/淡出），按块线性过渡
+        bool stopping = false;   // 淡出后释放
+        bool finished = false;   // 源已读尽（或回收队列满，待下块重试释放）
+        // 接续声部：本声部读尽时就地接上
+        MixerSource* next = nullptr;
+        VoiceHandle nextHandle = 0;
+        int nextPriority = 0;
+        float nextGain = 1.0f;
+    };
+
+    bool pushCommand(Command command);
+    void applyCommands();
+    void applyPlay(const Command& command);
+    void applyPlayAfter(const Command& command);
+    void retire(MixerSource* source);
+    size_t handOff(size_t index, size_t got, size_t frames);
+    Voice* findVoice(VoiceHandle handle);
+    bool releaseVoice(size_t index);
+    void recordOnset(VoiceHandle handle, size_t frameOffset);
+    void mixChunk(float* out, size_t frames);
+    void renderLoop(MixerOutput* output);
+
+    const MixerConfig m_config;
+    const PcmKernels& m_kernels;
+    SpscQueue<Command> m_commands;
+    SpscQueue<MixerSource*> m_retired;
+
+    // 控制端私有
+    VoiceHandle m_nextHandle = 1;
+
+    // 渲染端私有
+    std::vector<Voice> m_voices;
+    std::vector<float> m_scratch;
+    float m_maxStepPerFrame;  // 增益每帧最大变化量（由 rampMs 换算）
+    std::chrono::steady_clock::time_point m_renderBegin;
+    size_t m_renderQueuedFrames = 0;  // 本次 render 前设备已排队的帧数（渲染线程填写）
+    size_t m_chunkOffset = 0;         // 当前块在本次 render 输出中的起点（帧）
+    std::function<void(VoiceHandle)> m_endCallback;
+
+    // 渲染端发布、控制端读取
+    std::unique_ptr<std::atomic<VoiceHandle>[]> m_publishedHandles;
+    std::atomic<VoiceHandle> m_appliedHandle{0};  // 已被渲染端处理的最大 PLAY 句柄
+    OnsetSlot m_onsets[ONSET_SLOTS];
+
+    std::atomic<uint64_t> m_renderedFrames{0};
+    std::atomic<uint64_t> m_totalCostNs{0};
+    std::atomic<uint64_t> m_maxCostNs{0};
+    std::atomic<uint64_t> m_lastCostNs{0};
+    std::atomic<uint64_t> m_underruns{0};
+    std::atomic<uint64_t> m_stolen{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_handoffs{0};
+    std::atomic<uint64_t> m_failedWrites{0};
+    std::atomic<int64_t> m_heartbeat{0};  // steady_clock 计数
+
+    std::thread m_renderThread;
+    std::atomic<bool> m_running{false};
+};
@@ -1,60 +1,318 @@
 #include "AudioPlayer.h"
-#include "StringUtil.h"
+#include "AudioBundle.h"
+#include "ClipSequence.h"
+#include "LoudnessMeter.h"
 #include "PathUtil.h"
-#include <mmdeviceapi.h>
-#include <endpointvolume.h>
-#include <filesystem>
+#include "ReadAheadSource.h"
 #include <algorithm>
-#include <cctype>
-#include <windows.h>
-#include <mmsystem.h>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <filesystem>
+#include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+std::atomic<bool> AudioPlayer::s_initialized{false};
+std::unique_ptr<IAudioBackend> AudioPlayer::s_backend;
+std::unique_ptr<AudioMixer> AudioPlayer::s_mixer;
+AudioMixer::VoiceHandle AudioPlayer::s_currentVoice = 0;
+double AudioPlayer::s_currentDuration = 0.0;
+std::unique_ptr<MixerSource> AudioPlayer::s_preparedSource;
+std::string AudioPlayer::s_preparedFilename;
+double AudioPlayer::s_preparedDuration = 0.0;
+double AudioPlayer::s_preparedTrimSeconds = 0.0;
+AudioMixer::VoiceHandle AudioPlayer::s_queuedVoice = 0;
+std::string AudioPlayer::s_queuedFilename;
+double AudioPlayer::s_queuedDuration = 0.0;
+double AudioPlayer::s_queuedTrimSeconds = 0.0;
+float AudioPlayer::s_queuedGain = 1.0f;
+double AudioPlayer::s_lastStartLatencyMs = 0.0;
+bool AudioPlayer::s_lastStartPrepared = false;
+std::chrono::steady_clock::time_point AudioPlayer::s_lastHandoffTime;
+double AudioPlayer::s_loudnessTargetLufs = 0.0;
+float AudioPlayer::s_lastGain = 1.0f;
+bool AudioPlayer::s_trimLeadingSilence = false;
+double AudioPlayer::s_lastTrimSeconds = 0.0;
+std::vector<std::string> AudioPlayer::s_outputDevices;
+std::vector<std::string> AudioPlayer::s_backupOutputDevices;
+std::filesystem::path AudioPlayer::s_backupAudioDir;
+std::shared_ptr<VoiceProgress> AudioPlayer::s_watched;
+std::shared_ptr<VoiceProgress> AudioPlayer::s_queuedProgress;
+AudioMixer::VoiceHandle AudioPlayer::s_startedVoice = 0;
+std::chrono::steady_clock::time_point AudioPlayer::s_startedOnset;
+bool AudioPlayer::s_startedOnsetKnown = false;
+OutputLatencyProfiles AudioPlayer::s_latencyProfiles;
+bool AudioPlayer::s_latencyCompensation = true;
+double AudioPlayer::s_outputLatencyMs = 0.0;
+AudioMixer::VoiceHandle AudioPlayer::s_measuredVoice = 0;
+std::mutex AudioPlayer::s_mutex;
+bool AudioPlayer::s_reopening = false;
+std::condition_variable AudioPlayer::s_reopened;
+std::function<void()> AudioPlayer::s_endNotify;
+std::mutex AudioPlayer::s_endNotifyMutex;
+AudioAssetPool AudioPlayer::s_assetPool;
+AudioAssetPool AudioPlayer::s_clipCache;
+AudioMetadataCache AudioPlayer::s_metadataCache;
+PlaybackWatchdog AudioPlayer::s_watchdog;
 
-// 包含 Bass Audio Library
-#include "../third_party/bass/bass.h"
+namespace {
+// 预热时整文件读入内存的上限；更大的文件（长听力）只建文件流
+constexpr std::uintmax_t kMaxPreloadBytes = 64ull * 1024 * 1024;
+// 接替组合指令时跳过断点之前部分的读取块
+constexpr size_t kSkipChunkFrames = 4096;
+// 音频中断且没有备用文件时，先从原文件断点处试读这么多帧，读不出就不算接替
+constexpr size_t kResumeProbeFrames = 1024;
 
-// 根据平台链接对应的 Bass 库
-#ifdef _WIN64
-#pragma comment(lib, "../third_party/bass/x64/bass.lib")
+void logPlayer(const char* msg) {
+#ifdef _WIN32
+    OutputDebugStringA(msg);
 #else
-#pragma comment(lib, "../third_party/bass/bass.lib")
+    std::fputs(msg, stderr);
 #endif
+}
 
-#pragma comment(lib, "winmm.lib")
-
-bool AudioPlayer::s_initialized = false;
-DWORD AudioPlayer::s_currentStream = 0;
-
-namespace {
-void logBassError(const char* context) {
-    int code = BASS_ErrorGetCode();
-    char buf[128];
-    std::snprintf(buf, sizeof(buf), "[BASS] %s failed, error=%d\n", context, code);
-    OutputDebugStringA(buf);
+// 预载池条目作为声部：PCM 直接交给混音器（采样率不同时变采样），原文件字节交给后端建内存解码流
+std::unique_ptr<MixerSource> openAssetSource(IAudioBackend& backend, const std::string& filename,
+                                             const AudioAsset& asset, uint32_t mixRate, double startSeconds,
+                                             bool prime, double* durationSeconds) {
+    if (asset.pcm) {
+        *durationSeconds = asset.pcm->durationSeconds();
+        auto startFrame = static_cast<size_t>(startSeconds * asset.pcm->sampleRate + 0.5);
+        std::unique_ptr<MixerSource> source = std::make_unique<PcmBufferSource>(asset.pcm, startFrame);
+        if (asset.pcm->sampleRate == mixRate) {
+            return source;
+        }
+        return std::make_unique<ResamplingSource>(std::move(source), asset.pcm->sampleRate, mixRate);
+    }
+    return backend.openSource(PathUtil::getAudioPath(filename), AudioBytes::fromVector(asset.compressed), mixRate,
+                              startSeconds, prime, durationSeconds);
 }
 }  // namespace
 
+void AudioPlayer::setBackend(std::unique_ptr<IAudioBackend> backend) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_initialized || s_reopening) {
+        logPlayer("[EVCS] 音频后端已在使用中，须先 cleanup() 再更换\n");
+        return;
+    }
+    s_backend = std::move(backend);
+    s_latencyProfiles.clear();  // 换后端即换了设备，之前的实测不再适用
+}
+
 bool AudioPlayer::initialize() {
+    std::unique_lock<std::mutex> lock(s_mutex);
+    // 看门狗正在锁外重开输出：等它结束，重开成功即可直接使用，失败再按原设备初始化
+    s_reopened.wait(lock, [] { return !s_reopening; });
     if (s_initialized) {
         return true;
     }
+    if (!s_backend) {
+        logPlayer("[EVCS] 未设置音频后端\n");
+        return false;
+    }
 
-    // 初始化 Bass 库（-1 表示使用默认输出设备）
-    if (BASS_Init(-1, 44100, 0, NULL, NULL)) {
-        s_initialized = true;
-        return true;
+    if (!openOutputLocked(s_outputDevices)) {
+        return false;
     }
+    const MixerConfig& config = s_mixer->getConfig();
+
+    // 预载池解码与元数据探测在各自的工作线程上调用后端；后端在 cleanup() 之前不会更换
+    IAudioBackend* backend = s_backend.get();
+    s_assetPool.setDecoder([backend](const std::vector<char>& bytes, PcmBuffer& out) {
+        return backend->decodeToPcm(bytes, out);
+    });
+    s_clipCache.setDecoder([backend](const std::vector<char>& bytes, PcmBuffer& out) {
+        return backend->decodeToPcm(bytes, out);
+    });
+    const uint32_t mixRate = config.sampleRate;
+    s_metadataCache.setProber([backend, mixRate](const AudioLocation& location, AudioMetadata& metadata) {
+        // MP3/WAV 先读文件头，其他格式交给后端；打包条目没有文件路径，建一次解码源取时长
+        if (AudioMetadataCache::probeHeader(location, metadata)) {
+            return true;
+        }
+        if (!location.inBundle()) {
+            return backend->probe(location.path, metadata);
+        }
+        double duration = 0.0;
+        auto source = backend->openSource(location.path, location.bytes, mixRate, 0.0, false, &duration);
+        metadata.durationSeconds = duration;
+        return source != nullptr && duration > 0.0;
+    });
+    // 响度与开头静音按混音器实际收到的信号（已变采样到混音采样率的立体声）测量，逐段读解码源，不整文件展开为 PCM
+    s_metadataCache.setAnalyzer([backend, mixRate](const AudioLocation& location, AudioMetadata& metadata) {
+        double duration = 0.0;
+        auto source = backend->openSource(location.path, location.bytes, mixRate, 0.0, false, &duration);
+        if (!source) {
+            return false;
+        }
+        return AudioMetadataCache::analyzeSource(*source, mixRate, metadata,
+                                                 [] { return s_metadataCache.cancelRequested(); });
+    });
+    s_initialized = true;
+
+    // 看门狗线程经 s_mutex 采样，本函数返回后才开始检查
+    s_watchdog.setSampler(sampleWatchdog);
+    s_watchdog.setRecoverer(recoverPlayback);
+    s_watchdog.setEventCallback([](const WatchdogEvent& event) {
+        logPlayer(("[EVCS] " + PlaybackWatchdog::formatEvent(event) + "\n").c_str());
+    });
+    s_watchdog.clearEvents();
+    s_watchdog.start();
 
-    logBassError("BASS_Init");
-    return false;
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "[EVCS] 音频后端 %s: %u Hz, 每块 %zu 帧, 排队 %zu 帧\n", backend->name(),
+                  config.sampleRate, config.blockFrames, config.targetQueuedFrames);
+    logPlayer(buf);
+    for (const auto& device : backend->getDeviceStats()) {
+        std::snprintf(buf, sizeof(buf), "[EVCS] 输出设备 %s: 延迟 %.1f ms\n", device.name.c_str(),
+                      device.latencyFrames * 1000.0 / config.sampleRate);
+        logPlayer(buf);
+    }
+    logPlayer(("[EVCS] " + OutputLatencyProfiles::formatProfile(s_latencyProfiles.current()) + "\n").c_str());
+    return true;
+}
+
+bool AudioPlayer::openOutputLocked(const std::vector<std::string>& devices) {
+    std::unique_ptr<AudioMixer> mixer = openOutput(devices);
+    if (!mixer) {
+        return false;
+    }
+    publishOutputLocked(std::move(mixer), devices);
+    return true;
+}
+
+std::unique_ptr<AudioMixer> AudioPlayer::openOutput(const std::vector<std::string>& devices) {
+    MixerConfig config;
+    s_backend->setOutputDevices(devices);
+    if (!s_backend->open(config)) {
+        return nullptr;
+    }
+    auto mixer = std::make_unique<AudioMixer>(config);
+    mixer->setEndCallback([](AudioMixer::VoiceHandle) {
+        std::lock_guard<std::mutex> lock(s_endNotifyMutex);
+        if (s_endNotify) {
+            s_endNotify();
+        }
+    });
+    mixer->startRenderThread(s_backend->output());
+    return mixer;
+}
+
+void AudioPlayer::publishOutputLocked(std::unique_ptr<AudioMixer> mixer, const std::vector<std::string>& devices) {
+    s_mixer = std::move(mixer);
+    const MixerConfig& config = s_mixer->getConfig();
+    // 估计：设备延迟 + 排队量 + 等到下一次补写的平均半块
+    std::string selection;
+    for (const auto& device : devices) {
+        selection += (selection.empty() ? "" : "|") + device;
+    }
+    s_outputLatencyMs = s_backend->getOutputLatencyMs();
+    s_latencyProfiles.select(selection, s_outputLatencyMs,
+                             (config.targetQueuedFrames + config.blockFrames / 2.0) * 1000.0 / config.sampleRate);
 }
 
 void AudioPlayer::cleanup() {
-    if (s_initialized) {
-        stop();
-        BASS_Free();
-        s_initialized = false;
+    // 看门狗的采样与接替要取 s_mutex，须在加锁之前停下
+    s_watchdog.stop();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_initialized) {
+        return;
+    }
+    discardPreparedLocked();
+    cancelQueuedLocked();
+    s_mixer->stopRenderThread();
+    s_assetPool.clear();
+    s_clipCache.clear();
+    s_metadataCache.cancel();
+
+    MixerStats stats = s_mixer->getStats();
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "[EVCS] 混音统计: %llu 块, 平均 %.1fus / 最大 %.1fus (预算 %.0fus, 负载 %.2f%%), "
+        "欠载 %llu, 抢占 %llu, 丢弃 %llu\n",
+        static_cast<unsigned long long>(stats.blocks), stats.avgCostUs, stats.maxCostUs, stats.budgetUs,
+        stats.load * 100.0, static_cast<unsigned long long>(stats.underruns),
+        static_cast<unsigned long long>(stats.stolen), static_cast<unsigned long long>(stats.dropped));
+    logPlayer(buf);
+    const double rate = s_mixer->getConfig().sampleRate;
+    for (const auto& device : s_backend->getDeviceStats()) {
+        std::snprintf(buf, sizeof(buf),
+            "[EVCS] 输出设备 %s: 补偿 %.2f ms, 偏差 %.2f ms (最大 %.2f ms), 追平漂移丢帧 %llu, 写入失败 %llu%s\n",
+            device.name.c_str(), device.compensationFrames * 1000.0 / rate, device.skewFrames * 1000.0 / rate,
+            device.maxSkewFrames * 1000.0 / rate, static_cast<unsigned long long>(device.droppedFrames),
+            static_cast<unsigned long long>(device.failedWrites), device.lost ? ", 已放弃" : "");
+        logPlayer(buf);
     }
+
+    // 源对象可能持有后端的解码通道，须在关闭后端之前析构
+    s_mixer.reset();
+    s_backend->close();
+    s_currentVoice = 0;
+    s_currentDuration = 0.0;
+    s_startedVoice = 0;
+    s_startedOnsetKnown = false;
+    s_measuredVoice = 0;
+    s_watched.reset();
+    s_queuedProgress.reset();
+    s_initialized = false;
+}
+
+void AudioPlayer::setOutputDevices(const std::vector<std::string>& devices) {
+    bool reopen = false;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (devices == s_outputDevices) {
+            return;
+        }
+        s_outputDevices = devices;
+        reopen = s_initialized;
+    }
+    // 设备在 open() 时选定，更换设备只能整体重开
+    if (reopen) {
+        cleanup();
+        if (!initialize()) {
+            logPlayer("[EVCS] 按新的输出设备重开音频失败\n");
+        }
+    }
+}
+
+void AudioPlayer::setBackupOutputDevices(const std::vector<std::string>& devices) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_backupOutputDevices = devices;
+}
+
+void AudioPlayer::setBackupAudioDir(const std::filesystem::path& dir) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_backupAudioDir = dir;
+}
+
+std::vector<WatchdogEvent> AudioPlayer::getWatchdogEvents() {
+    return s_watchdog.getEvents();
+}
+
+void AudioPlayer::setLatencyCompensation(bool enabled) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_latencyCompensation = enabled;
+}
+
+double AudioPlayer::getOutputCompensationMs() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_initialized && s_latencyCompensation ? s_latencyProfiles.current().estimateMs() : 0.0;
+}
+
+OutputLatencyProfile AudioPlayer::getOutputLatencyProfile() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_initialized ? s_latencyProfiles.current() : OutputLatencyProfile();
+}
+
+std::vector<OutputDeviceStats> AudioPlayer::getOutputDeviceStats() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_initialized) {
+        return {};
+    }
+    return s_backend->getDeviceStats();
 }
 
 bool AudioPlayer::playAudioFile(const std::string& filename) {
@@ -64,127 +322,788 @@ bool AudioPlayer::playAudioFile(const std::string& filename) {
         }
     }
 
-    std::filesystem::path audioPath = PathUtil::getAudioPath(filename);
-    if (!std::filesystem::exists(audioPath)) {
+    auto startTime = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(s_mutex);
+    // 看门狗正在锁外重开输出：等重开结束；重开失败则本次不播
+    s_reopened.wait(lock, [] { return !s_reopening; });
+    if (!s_initialized) {
         return false;
     }
 
-    // 停止上一次播放（如有）
-    stop();
+    // 接续命中：混音器已在上一路读尽的那一帧接上，直接接管该声部（出声早于本次调用）
+    std::chrono::steady_clock::time_point onset;
+    if (s_queuedVoice != 0 && s_queuedFilename == filename && s_mixer->getOnsetTime(s_queuedVoice, onset)) {
+        s_currentVoice = s_queuedVoice;
+        s_startedVoice = s_queuedVoice;
+        s_startedOnsetKnown = false;
+        s_measuredVoice = 0;  // 出声早于本次调用，不是输出延迟
+        s_watched = std::move(s_queuedProgress);
+        s_currentDuration = std::max(0.0, s_queuedDuration - s_queuedTrimSeconds);
+        s_lastStartPrepared = true;
+        s_lastGain = s_queuedGain;
+        s_lastTrimSeconds = s_queuedTrimSeconds;
+        s_queuedVoice = 0;
+        s_queuedFilename.clear();
+        s_lastHandoffTime = std::chrono::steady_clock::now();
+        s_lastStartLatencyMs = std::chrono::duration<double, std::milli>(s_lastHandoffTime - startTime).count();
+
+        char buf[320];
+        std::snprintf(buf, sizeof(buf), "[EVCS] 接续 %s: 已于 %.2fms 前在上一条结束处接上\n", filename.c_str(),
+                      std::chrono::duration<double, std::milli>(s_lastHandoffTime - onset).count());
+        logPlayer(buf);
+        return true;
+    }
+    cancelQueuedLocked();
+
+    // 预热命中：接管已打开并预解码的源，跳过文件检查与建流
+    bool prepared = s_preparedSource && s_preparedFilename == filename;
+    std::unique_ptr<MixerSource> source;
+    double duration = 0.0;
+    double trim = 0.0;
+    if (prepared) {
+        source = std::move(s_preparedSource);
+        duration = s_preparedDuration;
+        trim = s_preparedTrimSeconds;
+        s_preparedFilename.clear();
+    } else {
+        bool fromDisk = false;
+        if (ClipSequence::isSequence(filename)) {
+            source = openSequenceLocked(filename, false, &duration, &trim, &fromDisk);
+        } else {
+            trim = trimSecondsLocked(filename);
+            source = openFileLocked(filename, trim, false, &duration, &fromDisk);
+        }
+        if (!source) {
+            return false;
+        }
+        source = readAheadLocked(std::move(source), fromDisk);
+    }
 
-    // 不使用 BASS_STREAM_AUTOFREE：保留句柄以便查询活跃状态
-    // 播放结束/出错时由 stop()/cleanup() 显式释放
-    std::wstring widePath = audioPath.wstring();
-    HSTREAM stream = BASS_StreamCreateFile(FALSE, widePath.c_str(), 0, 0, BASS_UNICODE);
-    if (!stream) {
-        logBassError("BASS_StreamCreateFile");
+    // 上一路不截断：降为后台，被新前台闪避，直到自然播完。组合指令的增益已按片段施加
+    const float gain = ClipSequence::isSequence(filename) ? 1.0f : normalizationGainLocked(filename);
+    source = s_backend->traceVoice(filename, std::move(source));
+    std::shared_ptr<VoiceProgress> progress;
+    source = watchLocked(filename, std::move(source), trim, duration, gain, 0, progress);
+    AudioMixer::VoiceHandle voice = s_mixer->play(std::move(source), AudioMixer::PRIORITY_FOREGROUND, gain);
+    if (voice == 0) {
+        logPlayer("[EVCS] 混音命令队列已满，播放失败\n");
         return false;
     }
+    if (s_currentVoice != 0) {
+        s_mixer->setPriority(s_currentVoice, AudioMixer::PRIORITY_BACKGROUND);
+    }
+
+    s_currentVoice = voice;
+    s_startedVoice = voice;
+    s_startedOnsetKnown = false;
+    s_measuredVoice = voice;
+    s_watched = std::move(progress);
+    s_currentDuration = std::max(0.0, duration - trim);
+    s_lastStartPrepared = prepared;
+    s_lastGain = gain;
+    s_lastTrimSeconds = trim;
+    s_lastHandoffTime = std::chrono::steady_clock::now();
+    s_lastStartLatencyMs = std::chrono::duration<double, std::milli>(s_lastHandoffTime - startTime).count();
 
-    if (!BASS_ChannelPlay(stream, FALSE)) {
-        logBassError("BASS_ChannelPlay");
-        BASS_StreamFree(stream);
+    char buf[320];
+    std::snprintf(buf, sizeof(buf), "[EVCS] 起播 %s: %.2fms (%s), 响度增益 %+.1f dB, 裁去开头静音 %.0fms\n",
+                  filename.c_str(), s_lastStartLatencyMs, prepared ? "预热命中" : "冷启动", 20.0 * std::log10(gain),
+                  trim * 1000.0);
+    logPlayer(buf);
+    return true;
+}
+
+bool AudioPlayer::prepareAudioFile(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_initialized) {
         return false;
     }
+    if (s_preparedSource && s_preparedFilename == filename) {
+        return true;  // 已预热
+    }
+    discardPreparedLocked();
 
-    s_currentStream = stream;
+    // 开头静音在建源时就跳过，到点起播不再额外读解码
+    double duration = 0.0;
+    double trim = 0.0;
+    std::unique_ptr<MixerSource> source;
+    bool fromDisk = false;
+    if (ClipSequence::isSequence(filename)) {
+        source = openSequenceLocked(filename, true, &duration, &trim, &fromDisk);
+    } else {
+        trim = trimSecondsLocked(filename);
+        source = openFileLocked(filename, trim, true, &duration, &fromDisk);
+    }
+    if (!source) {
+        return false;
+    }
+
+    s_preparedSource = readAheadLocked(std::move(source), fromDisk);
+    s_preparedFilename = filename;
+    s_preparedDuration = duration;
+    s_preparedTrimSeconds = trim;
     return true;
 }
 
-bool AudioPlayer::isPlaying() {
-    if (!s_initialized || !s_currentStream) {
+bool AudioPlayer::queueAudioFile(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_initialized || s_currentVoice == 0) {
         return false;
     }
-    // BASS_ACTIVE_PLAYING / BASS_ACTIVE_STALLED 都视为"占用中"
-    DWORD active = BASS_ChannelIsActive(s_currentStream);
-    return active == BASS_ACTIVE_PLAYING || active == BASS_ACTIVE_STALLED;
+    cancelQueuedLocked();
+    return queueLocked(filename);
 }
 
-void AudioPlayer::stop() {
-    if (s_currentStream) {
-        BASS_ChannelStop(s_currentStream);
-        BASS_StreamFree(s_currentStream);
-        s_currentStream = 0;
+bool AudioPlayer::queueLocked(const std::string& filename) {
+    // 与预热相同：建源并预解码首段，接上时第一块即有数据
+    double duration = 0.0;
+    double trim = 0.0;
+    std::unique_ptr<MixerSource> source;
+    bool fromDisk = false;
+    if (ClipSequence::isSequence(filename)) {
+        source = openSequenceLocked(filename, true, &duration, &trim, &fromDisk);
+    } else {
+        trim = trimSecondsLocked(filename);
+        source = openFileLocked(filename, trim, true, &duration, &fromDisk);
+    }
+    if (!source) {
+        return false;
+    }
+    source = readAheadLocked(std::move(source), fromDisk);
+    const float gain = ClipSequence::isSequence(filename) ? 1.0f : normalizationGainLocked(filename);
+    source = s_backend->traceVoice(filename, std::move(source));
+    std::shared_ptr<VoiceProgress> progress;
+    source = watchLocked(filename, std::move(source), trim, duration, gain, 0, progress);
+    AudioMixer::VoiceHandle voice =
+        s_mixer->playAfter(s_currentVoice, std::move(source), AudioMixer::PRIORITY_FOREGROUND, gain);
+    if (voice == 0) {
+        return false;
     }
+    s_queuedVoice = voice;
+    s_queuedProgress = std::move(progress);
+    s_queuedFilename = filename;
+    s_queuedDuration = duration;
+    s_queuedTrimSeconds = trim;
+    s_queuedGain = gain;
+    return true;
 }
 
-double AudioPlayer::getCurrentStreamDuration() {
-    if (!s_initialized || !s_currentStream) {
-        return 0.0;
+void AudioPlayer::cancelQueuedLocked() {
+    if (s_queuedVoice != 0 && s_initialized) {
+        s_mixer->stop(s_queuedVoice);
+    }
+    s_queuedVoice = 0;
+    s_queuedFilename.clear();
+    s_queuedProgress.reset();
+}
+
+void AudioPlayer::setEndNotify(std::function<void()> notify) {
+    std::lock_guard<std::mutex> lock(s_endNotifyMutex);
+    s_endNotify = std::move(notify);
+}
+
+std::unique_ptr<MixerSource> AudioPlayer::openFileLocked(const std::string& filename, double trim, bool prime,
+                                                         double* durationSeconds, bool* fromDisk) {
+    const uint32_t mixRate = s_mixer->getConfig().sampleRate;
+    *fromDisk = false;
+    // 片段缓存或预载池命中：从内存建源，不碰磁盘（prime 时预解码首段）
+    if (auto asset = s_clipCache.find(filename)) {
+        return openAssetSource(*s_backend, filename, *asset, mixRate, trim, prime, durationSeconds);
     }
-    // 直接查询当前播放通道长度，无需另开流
-    QWORD lengthBytes = BASS_ChannelGetLength(s_currentStream, BASS_POS_BYTE);
-    if (lengthBytes == (QWORD)-1) {
+    if (auto asset = s_assetPool.find(filename)) {
+        return openAssetSource(*s_backend, filename, *asset, mixRate, trim, prime, durationSeconds);
+    }
+
+    // 打包文件中的条目：索引查找后直接从映射解码；否则打开 audio 目录下的散文件
+    AudioLocation location;
+    if (!AudioBundle::locate(filename, location)) {
+        return nullptr;
+    }
+    AudioBytes data = location.bytes;
+    if (prime) {
+        if (location.size == 0) {
+            return nullptr;
+        }
+        // 预热：散文件中的小文件整读入内存（U 盘/网络共享上的读延迟在此提前付清），大文件只建流；
+        // 打包条目本就在映射中，不再复制
+        if (!location.inBundle() && location.size <= kMaxPreloadBytes) {
+            std::ifstream file(location.path, std::ios::binary);
+            auto bytes = std::make_shared<std::vector<char>>(static_cast<size_t>(location.size));
+            if (!file || !file.read(bytes->data(), static_cast<std::streamsize>(location.size))) {
+                return nullptr;
+            }
+            data = AudioBytes::fromVector(std::move(bytes));
+        }
+    }
+    // 预热时首段预解码，到点交给混音器后第一块即可出声；散文件流与打包映射之后的读取仍会碰磁盘
+    *fromDisk = data.empty() || location.inBundle();
+    return s_backend->openSource(location.path, std::move(data), mixRate, trim, prime, durationSeconds);
+}
+
+std::unique_ptr<MixerSource> AudioPlayer::openSequenceLocked(const std::string& audioFile, bool prime,
+                                                             double* durationSeconds, double* trimSeconds,
+                                                             bool* fromDisk) {
+    std::vector<SequenceSource::Part> parts;
+    *fromDisk = false;
+    double played = 0.0;
+    for (const auto& clip : ClipSequence::split(audioFile)) {
+        // 每个片段各自裁去开头静音、各自做响度归一化，拼接处不留录音自带的空白
+        const double trim = trimSecondsLocked(clip);
+        double duration = 0.0;
+        SequenceSource::Part part;
+        bool clipFromDisk = false;
+        part.source = openFileLocked(clip, trim, prime, &duration, &clipFromDisk);
+        if (!part.source) {
+            char buf[320];
+            std::snprintf(buf, sizeof(buf), "[EVCS] 组合指令的片段无法打开: %s\n", clip.c_str());
+            logPlayer(buf);
+            return nullptr;
+        }
+        part.gain = normalizationGainLocked(clip);
+        *fromDisk = *fromDisk || clipFromDisk;
+        if (parts.empty()) {
+            *trimSeconds = trim;
+        }
+        played += std::max(0.0, duration - trim);
+        parts.push_back(std::move(part));
+    }
+    // 与单个文件一致：时长 - 开头裁去的静音 = 实际播放时长
+    *durationSeconds = played + *trimSeconds;
+    return std::make_unique<SequenceSource>(std::move(parts));
+}
+
+std::unique_ptr<MixerSource> AudioPlayer::readAheadLocked(std::unique_ptr<MixerSource> source, bool fromDisk) {
+    if (!fromDisk) {
+        return source;
+    }
+    return std::make_unique<ReadAheadSource>(std::move(source), s_mixer->getConfig().sampleRate);
+}
+
+std::unique_ptr<MixerSource> AudioPlayer::watchLocked(const std::string& filename,
+                                                      std::unique_ptr<MixerSource> source, double startSeconds,
+                                                      double durationSeconds, float gain, int recoveries,
+                                                      std::shared_ptr<VoiceProgress>& progress) {
+    progress = std::make_shared<VoiceProgress>();
+    progress->filename = filename;
+    progress->startSeconds = startSeconds;
+    progress->sampleRate = s_mixer->getConfig().sampleRate;
+    if (durationSeconds > startSeconds) {
+        progress->expectedFrames = static_cast<uint64_t>((durationSeconds - startSeconds) * progress->sampleRate);
+    }
+    progress->gain = gain;
+    progress->recoveries = recoveries;
+    return std::make_unique<WatchedSource>(std::move(source), progress, [] { s_watchdog.wake(); });
+}
+
+bool AudioPlayer::sampleWatchdog(WatchdogSample& sample) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_initialized || !s_watched) {
+        return false;
+    }
+    const MixerStats stats = s_mixer->getStats();
+    sample.progress = s_watched;
+    sample.failedWrites = stats.failedWrites;
+    sample.heartbeat = stats.heartbeat;
+    sample.queuedFrames = s_mixer->getConfig().targetQueuedFrames;
+    return true;
+}
+
+bool AudioPlayer::recoverPlayback(const WatchdogSample& sample, WatchdogFault fault, double positionSeconds,
+                                  std::string& via) {
+    // 设备故障：音频本身没有问题，换设备后按原来的取法建源；音频中断：先找备用文件
+    const bool outputFault = fault == WatchdogFault::OUTPUT_STALLED || fault == WatchdogFault::OUTPUT_FAILED;
+    const VoiceProgress& failed = *sample.progress;
+    std::unique_lock<std::mutex> lock(s_mutex);
+    if (!s_initialized || s_watched != sample.progress) {
+        via = "这一路已停止或已被新指令取代";
+        return false;
+    }
+
+    // 备用文件在锁外查找并建源：备用盘/镜像源盘上的 is_regular_file 与首段解码可能很慢
+    std::unique_ptr<MixerSource> source;
+    double duration = 0.0;
+    std::string from;
+    bool fromDisk = false;
+    if (!outputFault && !ClipSequence::isSequence(failed.filename)) {
+        std::vector<std::filesystem::path> dirs;
+        if (!s_backupAudioDir.empty()) {
+            dirs.push_back(s_backupAudioDir);
+        }
+        if (!PathUtil::getAudioMirror().empty()) {
+            dirs.push_back(PathUtil::getAudioSourceDir());
+        }
+        if (!dirs.empty()) {
+            const uint32_t mixRate = s_mixer->getConfig().sampleRate;
+            lock.unlock();
+            // 后端在 cleanup() 之前不会更换，cleanup() 先停看门狗，会等本函数返回
+            source = openBackup(dirs, failed.filename, positionSeconds, mixRate, &duration, from);
+            lock.lock();
+            if (!s_initialized || s_watched != sample.progress) {
+                via = "这一路已停止或已被新指令取代";
+                return false;
+            }
+            fromDisk = source != nullptr;
+        }
+    }
+
+    const std::string queuedFilename = s_queuedVoice != 0 ? s_queuedFilename : std::string();
+    std::string device;
+    if (outputFault) {
+        if (!failoverOutput(lock, device)) {
+            via = device;
+            return false;
+        }
+        if (s_watched != sample.progress) {
+            via = device + "，这一路已在重开期间停止";
+            return false;
+        }
+    }
+    const bool reopenSame = !source;
+    if (reopenSame) {
+        source = openResumeLocked(failed.filename, positionSeconds, &duration, &fromDisk, from);
+    }
+    if (!source) {
+        via = outputFault ? device + "，但无法重新打开音频" : "无法重新打开音频";
+        return false;
+    }
+    if (reopenSame && !outputFault) {
+        // 原文件本身在断点处截断（U 盘坏扇区、文件不完整）时重新打开仍读不出：不报接替成功。
+        // 试读出的部分放在接替声部最前面，不丢帧
+        auto probe = std::make_shared<PcmBuffer>();
+        probe->sampleRate = s_mixer->getConfig().sampleRate;
+        probe->samples.resize(kResumeProbeFrames * 2);
+        const size_t read = source->read(probe->samples.data(), kResumeProbeFrames);
+        if (read == 0) {
+            via = "无备用来源，原文件在断点处同样读不出";
+            return false;
+        }
+        probe->samples.resize(read * 2);
+        std::vector<SequenceSource::Part> parts(2);
+        parts[0].source = std::make_unique<PcmBufferSource>(probe);
+        parts[1].source = std::move(source);
+        source = std::make_unique<SequenceSource>(std::move(parts));
+    }
+    // 断点之前的部分已在建源时跳过，预读从断点开始
+    source = readAheadLocked(std::move(source), fromDisk);
+    source = s_backend->traceVoice(failed.filename, std::move(source));
+    std::shared_ptr<VoiceProgress> progress;
+    source = watchLocked(failed.filename, std::move(source), positionSeconds, duration, failed.gain,
+                         failed.recoveries + 1, progress);
+    AudioMixer::VoiceHandle voice = s_mixer->play(std::move(source), AudioMixer::PRIORITY_FOREGROUND, failed.gain);
+    if (voice == 0) {
+        via = "混音命令队列已满";
+        return false;
+    }
+    if (!outputFault) {
+        // 停掉占位的原声部，挂在其后的接续随之作废，下面重新挂到接替声部之后
+        s_mixer->stop(s_currentVoice);
+    }
+    // 接替声部只播断点之后的部分。原声部已出声的，起播延迟仍按原声部统计（出声时刻在重开输出前已记下）；
+    // 原声部还没出声（设备一开始就卡住），这一条以接替声部出声为准，从接替时刻起算
+    s_currentVoice = voice;
+    s_currentDuration = std::max(0.0, duration - positionSeconds);
+    std::chrono::steady_clock::time_point onset;
+    if (!startedOnsetLocked(onset)) {
+        s_startedVoice = voice;
+        s_lastHandoffTime = std::chrono::steady_clock::now();
+    }
+    s_watched = std::move(progress);
+    s_queuedVoice = 0;
+    s_queuedProgress.reset();
+    if (!queuedFilename.empty() && !queueLocked(queuedFilename)) {
+        s_queuedFilename.clear();
+    }
+    via = outputFault ? device + "，" + from : from;
+    return true;
+}
+
+bool AudioPlayer::failoverOutput(std::unique_lock<std::mutex>& lock, std::string& via) {
+    const bool hasBackup = !s_backupOutputDevices.empty();
+    const std::vector<std::string> devices = hasBackup ? s_backupOutputDevices : s_outputDevices;
+    const std::vector<std::string> original = s_outputDevices;
+    // 锁内只摘下旧混音器并作废句柄：新混音器的句柄从头编号。预热源可能持有后端的解码通道，须在关闭后端之前析构。
+    // s_watched 保留：重开期间被 stop() 清掉即表示不再接替
+    // 原声部的出声时刻随旧混音器一起作废，先记下
+    std::chrono::steady_clock::time_point onset;
+    startedOnsetLocked(onset);
+    std::unique_ptr<AudioMixer> mixer = std::move(s_mixer);
+    discardPreparedLocked();
+    s_currentVoice = 0;
+    s_startedVoice = 0;
+    s_measuredVoice = 0;
+    s_queuedVoice = 0;
+    s_queuedProgress.reset();
+    s_initialized = false;
+    s_reopening = true;
+    lock.unlock();
+
+    // 锁外：等渲染线程退出（可能卡在失效设备的写入上）、关闭并重开设备。
+    // 此间 UI 的查询照常返回（按未初始化），播放请求在 initialize() 中等重开结束
+    mixer->stopRenderThread();
+    mixer.reset();
+    s_backend->close();
+    std::vector<std::string> opened = devices;
+    std::unique_ptr<AudioMixer> replacement = openOutput(devices);
+    if (!replacement && hasBackup) {
+        opened = original;
+        replacement = openOutput(original);
+    }
+
+    lock.lock();
+    s_reopening = false;
+    s_reopened.notify_all();
+    auto describe = [](const std::vector<std::string>& selection) {
+        std::string text;
+        for (const auto& device : selection) {
+            text += (text.empty() ? "" : "|") + device;
+        }
+        return text.empty() ? std::string("默认设备") : text;
+    };
+    if (!replacement) {
+        // 下一次播放时重新初始化
+        s_watched.reset();
+        s_currentDuration = 0.0;
+        via = "输出设备无法重开";
+        return false;
+    }
+    publishOutputLocked(std::move(replacement), opened);
+    s_initialized = true;
+    via = opened == devices ? "已在 " + describe(devices) + " 上重开输出"
+                            : "备用设备无法打开，已在 " + describe(opened) + " 上重开输出";
+    return true;
+}
+
+std::unique_ptr<MixerSource> AudioPlayer::openBackup(const std::vector<std::filesystem::path>& dirs,
+                                                     const std::string& filename, double positionSeconds,
+                                                     uint32_t mixRate, double* durationSeconds, std::string& via) {
+    for (const auto& dir : dirs) {
+        const std::filesystem::path path = dir / std::filesystem::u8path(filename);
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) {
+            continue;
+        }
+        // 备用盘上的文件流：首段在此预解码，其后由预读线程接着读
+        auto source = s_backend->openSource(path, AudioBytes(), mixRate, positionSeconds, true, durationSeconds);
+        if (source) {
+            via = "备用文件 " + path.u8string();
+            return source;
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<MixerSource> AudioPlayer::openResumeLocked(const std::string& filename, double positionSeconds,
+                                                           double* durationSeconds, bool* fromDisk,
+                                                           std::string& via) {
+    if (ClipSequence::isSequence(filename)) {
+        // 片段多在片段缓存中：重新拼接后读过断点之前的部分
+        const uint32_t mixRate = s_mixer->getConfig().sampleRate;
+        double trim = 0.0;
+        std::unique_ptr<MixerSource> source = openSequenceLocked(filename, false, durationSeconds, &trim, fromDisk);
+        if (!source) {
+            return nullptr;
+        }
+        std::vector<float> scratch(kSkipChunkFrames * 2);
+        auto skip = static_cast<uint64_t>(std::max(0.0, positionSeconds - trim) * mixRate + 0.5);
+        while (skip > 0) {
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(skip, kSkipChunkFrames));
+            const size_t read = source->read(scratch.data(), want);
+            if (read == 0) {
+                break;
+            }
+            skip -= read;
+        }
+        via = "重新拼接组合指令";
+        return source;
+    }
+    auto source = openFileLocked(filename, positionSeconds, false, durationSeconds, fromDisk);
+    if (source) {
+        via = "重新打开 " + filename;
+    }
+    return source;
+}
+
+void AudioPlayer::discardPrepared() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    discardPreparedLocked();
+}
+
+void AudioPlayer::discardPreparedLocked() {
+    s_preparedSource.reset();
+    s_preparedFilename.clear();
+    s_preparedDuration = 0.0;
+    s_preparedTrimSeconds = 0.0;
+}
+
+double AudioPlayer::getLastStartLatencyMs() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_lastStartLatencyMs;
+}
+
+bool AudioPlayer::wasLastStartPrepared() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_lastStartPrepared;
+}
+
+float AudioPlayer::getLastGain() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_lastGain;
+}
+
+void AudioPlayer::setLoudnessTarget(double targetLufs) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_loudnessTargetLufs = targetLufs;
+}
+
+void AudioPlayer::setTrimLeadingSilence(bool enabled) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_trimLeadingSilence = enabled;
+}
+
+double AudioPlayer::getLastTrimSeconds() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_lastTrimSeconds;
+}
+
+double AudioPlayer::trimSecondsLocked(const std::string& filename) {
+    if (!s_trimLeadingSilence) {
         return 0.0;
     }
-    return BASS_ChannelBytes2Seconds(s_currentStream, lengthBytes);
+    auto metadata = s_metadataCache.find(filename);
+    if (!metadata || metadata->loudnessStatus == LoudnessStatus::PENDING) {
+        return 0.0;  // 尚未分析的文件从头播放
+    }
+    // 起音前留一小段余量，不切掉渐入的第一个音头
+    return std::max(0.0, metadata->leadingSilenceSeconds - TRIM_PREROLL_SECONDS);
 }
 
-int AudioPlayer::getSystemVolume() {
-    HRESULT hr;
-    IMMDeviceEnumerator* deviceEnumerator = NULL;
-    IMMDevice* defaultDevice = NULL;
-    IAudioEndpointVolume* endpointVolume = NULL;
-    float currentVolume = 0;
+float AudioPlayer::normalizationGainLocked(const std::string& filename) {
+    if (s_loudnessTargetLufs >= 0.0) {
+        return 1.0f;
+    }
+    auto metadata = s_metadataCache.find(filename);
+    if (!metadata || metadata->loudnessStatus != LoudnessStatus::MEASURED) {
+        return 1.0f;  // 尚未分析（或无法分析）的文件按原样播放
+    }
+    return LoudnessMeter::normalizationGain(metadata->loudnessLufs, metadata->samplePeak, s_loudnessTargetLufs);
+}
+
+bool AudioPlayer::startedOnsetLocked(std::chrono::steady_clock::time_point& onset) {
+    if (!s_startedOnsetKnown && s_initialized && s_startedVoice != 0) {
+        s_startedOnsetKnown = s_mixer->getOnsetTime(s_startedVoice, s_startedOnset);
+    }
+    onset = s_startedOnset;
+    return s_startedOnsetKnown;
+}
+
+bool AudioPlayer::getLastOnsetDelayMs(double& delayMs) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::chrono::steady_clock::time_point onset;
+    if (!startedOnsetLocked(onset)) {
+        return false;
+    }
+    delayMs = std::chrono::duration<double, std::milli>(onset - s_lastHandoffTime).count() + s_outputLatencyMs;
+    return true;
+}
+
+bool AudioPlayer::recordOnsetMeasurement() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::chrono::steady_clock::time_point onset;
+    if (s_measuredVoice == 0 || s_measuredVoice != s_startedVoice || !startedOnsetLocked(onset)) {
+        return false;
+    }
+    s_measuredVoice = 0;
+    const double delayMs =
+        std::chrono::duration<double, std::milli>(onset - s_lastHandoffTime).count() + s_outputLatencyMs;
+    return s_latencyProfiles.addMeasurement(delayMs);
+}
+
+bool AudioPlayer::isPlaying() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    // 看门狗正在锁外重开输出：这一路（未被停止时）随后在新设备上从断点接着播，仍算在播
+    return (s_reopening && s_watched) || (s_initialized && s_mixer->isPlaying(s_currentVoice));
+}
+
+void AudioPlayer::stop() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    stopLocked();
+}
+
+void AudioPlayer::stopLocked() {
+    if (s_initialized) {
+        s_mixer->stopAll();
+    }
+    s_queuedVoice = 0;  // 接续随上一路一起停止
+    s_queuedFilename.clear();
+    s_queuedProgress.reset();
+    s_currentVoice = 0;
+    s_currentDuration = 0.0;
+    s_startedVoice = 0;
+    s_startedOnsetKnown = false;
+    s_watched.reset();
+}
+
+double AudioPlayer::getCurrentStreamDuration() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_currentVoice != 0 ? s_currentDuration : 0.0;
+}
+
+AssetPoolStats AudioPlayer::loadAssetPool(const std::vector<std::string>& files, AssetPolicy policy,
+                                          uint64_t budgetBytes) {
+    if (!s_initialized && !initialize()) {
+        return AssetPoolStats();
+    }
+
+    // 不持 s_mutex：载入期间播放照常进行，查到的仍是旧池
+    AssetPoolStats stats = s_assetPool.load(files, policy, budgetBytes);
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "[EVCS] 音频预载: %zu/%zu 个文件 (原文件 %zu, PCM %zu, 沿用 %zu), 占用 %.1f MB / 预算 %.1f MB, "
+        "缺失 %zu, 超预算 %zu, 解码失败 %zu, 用时 %.1f ms\n",
+        stats.loadedFiles, stats.requestedFiles, stats.compressedFiles, stats.pcmFiles, stats.reusedFiles,
+        stats.footprintBytes() / (1024.0 * 1024.0), stats.budgetBytes / (1024.0 * 1024.0),
+        stats.missingFiles, stats.overBudgetFiles, stats.decodeFailures, stats.loadMs);
+    logPlayer(buf);
+    return stats;
+}
 
-    hr = CoCreateInstance(
-        __uuidof(MMDeviceEnumerator),
-        NULL,
-        CLSCTX_ALL,
-        __uuidof(IMMDeviceEnumerator),
-        (void**)&deviceEnumerator);
-    if (FAILED(hr)) return 0;
+AssetPoolStats AudioPlayer::getAssetPoolStats() {
+    return s_assetPool.getStats();
+}
 
-    hr = deviceEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &defaultDevice);
-    if (FAILED(hr)) {
-        deviceEnumerator->Release();
-        return 0;
+AssetPoolStats AudioPlayer::loadClipCache(const std::vector<std::string>& clips, uint64_t budgetBytes) {
+    if (!s_initialized && !initialize()) {
+        return AssetPoolStats();
     }
 
-    hr = defaultDevice->Activate(
-        __uuidof(IAudioEndpointVolume),
-        CLSCTX_ALL,
-        NULL,
-        (void**)&endpointVolume);
-    if (FAILED(hr)) {
-        defaultDevice->Release();
-        deviceEnumerator->Release();
-        return 0;
+    AssetPoolStats stats = s_clipCache.load(clips, AssetPolicy::PCM, budgetBytes);
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "[EVCS] 片段缓存: %zu/%zu 个片段 (PCM %zu, 沿用 %zu), 占用 %.1f MB, 缺失 %zu, 超预算 %zu, 解码失败 %zu, "
+        "用时 %.1f ms\n",
+        stats.loadedFiles, stats.requestedFiles, stats.pcmFiles, stats.reusedFiles,
+        stats.footprintBytes() / (1024.0 * 1024.0), stats.missingFiles, stats.overBudgetFiles,
+        stats.decodeFailures, stats.loadMs);
+    logPlayer(buf);
+    return stats;
+}
+
+AssetPoolStats AudioPlayer::getClipCacheStats() {
+    return s_clipCache.getStats();
+}
+
+void AudioPlayer::refreshMetadataAsync(std::vector<std::string> files, std::function<void()> onDone,
+                                       std::function<void()> onAnalyzed) {
+    if (!s_initialized && !initialize()) {
+        return;
     }
 
-    hr = endpointVolume->GetMasterVolumeLevelScalar(&currentVolume);
+    auto onProbed = [onDone = std::move(onDone)](const MetadataCacheStats& stats) {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf), "[EVCS] 音频元数据: %zu 个文件 (沿用 %zu, 探测 %zu, 失败 %zu, 缺失 %zu)\n",
+                      stats.requestedFiles, stats.reusedFiles, stats.probedFiles, stats.probeFailures,
+                      stats.missingFiles);
+        logPlayer(buf);
+        if (onDone) {
+            onDone();
+        }
+    };
+    auto onFinished = [onAnalyzed = std::move(onAnalyzed)](const MetadataCacheStats& stats) {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf),
+            "[EVCS] 响度分析: %zu 个文件 (失败 %zu), 分析 %.1f ms, 缓存文件%s, 总用时 %.1f ms\n",
+            stats.analyzedFiles, stats.analysisFailures, stats.analysisMs,
+            stats.probedFiles + stats.analyzedFiles == 0 ? "无变化" : (stats.saved ? "已更新" : "写入失败"),
+            stats.elapsedMs);
+        logPlayer(buf);
+        if (onAnalyzed) {
+            onAnalyzed();
+        }
+    };
+    s_metadataCache.refreshAsync(std::move(files), std::move(onProbed), std::move(onFinished));
+}
 
-    endpointVolume->Release();
-    defaultDevice->Release();
-    deviceEnumerator->Release();
+AudioPreflight::Decoder AudioPlayer::getPreflightDecoder() {
+    if (!s_initialized && !initialize()) {
+        return AudioPreflight::Decoder();
+    }
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_backend) {
+        return AudioPreflight::Decoder();
+    }
+    return AudioPreflight::backendDecoder(*s_backend);
+}
 
-    if (FAILED(hr)) return 0;
-    return static_cast<int>(currentVolume * 100);
+double AudioPlayer::getCachedDuration(const std::string& filename) {
+    if (!ClipSequence::isSequence(filename)) {
+        return s_metadataCache.getDuration(filename);
+    }
+    double total = 0.0;
+    for (const auto& clip : ClipSequence::split(filename)) {
+        const double duration = s_metadataCache.getDuration(clip);
+        if (duration <= 0.0) {
+            return 0.0;  // 有片段时长未知，整体按未知处理
+        }
+        total += duration;
+    }
+    return total;
+}
+
+MixerStats AudioPlayer::getMixerStats() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_initialized ? s_mixer->getStats() : MixerStats();
+}
+
+int AudioPlayer::getSystemVolume() {
+    return s_backend ? s_backend->getSystemVolume() : 0;
 }
 
 double AudioPlayer::getAudioDuration(const std::string& filename) {
-    if (!s_initialized) {
-        if (!initialize()) {
-            return 0.0;
+    if (ClipSequence::isSequence(filename)) {
+        double total = 0.0;
+        for (const auto& clip : ClipSequence::split(filename)) {
+            const double duration = getAudioDuration(clip);
+            if (duration <= 0.0) {
+                return 0.0;
+            }
+            total += duration;
         }
+        return total;
     }
 
-    std::filesystem::path audioPath = PathUtil::getAudioPath(filename);
-    if (!std::filesystem::exists(audioPath)) {
-        return 0.0;
+    double cached = s_metadataCache.getDuration(filename);
+    if (cached > 0.0) {
+        return cached;
     }
 
-    std::wstring widePath = audioPath.wstring();
-    HSTREAM stream = BASS_StreamCreateFile(FALSE, widePath.c_str(), 0, 0, BASS_UNICODE);
-    if (!stream) {
+    // MP3/WAV 只读文件头（打包条目直接读映射）
+    AudioLocation location;
+    if (!AudioBundle::locate(filename, location)) {
         return 0.0;
     }
+    AudioMetadata header;
+    if (AudioMetadataCache::probeHeader(location, header)) {
+        return header.durationSeconds;
+    }
 
-    double lengthSeconds = 0.0;
-    QWORD lengthBytes = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
-    if (lengthBytes != (QWORD)-1) {
-        lengthSeconds = BASS_ChannelBytes2Seconds(stream, lengthBytes);
+    // 其他格式交给后端探测
+    if (!s_initialized && !initialize()) {
+        return 0.0;
+    }
+    if (location.inBundle()) {
+        uint32_t mixRate = 0;
+        {
+            // 混音器可能正被看门狗换掉
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (!s_initialized) {
+                return 0.0;
+            }
+            mixRate = s_mixer->getConfig().sampleRate;
+        }
+        double duration = 0.0;
+        auto source = s_backend->openSource(location.path, location.bytes, mixRate, 0.0, false, &duration);
+        return source ? duration : 0.0;
     }
-    BASS_StreamFree(stream);
-    return lengthSeconds;
+    AudioMetadata metadata;
+    return s_backend->probe(location.path, metadata) ? metadata.durationSeconds : 0.0;
 }
@@ -1,34 +1,273 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <windows.h>
+#include <vector>
+#include "AudioAssetPool.h"
+#include "AudioBackend.h"
+#include "AudioMetadataCache.h"
+#include "AudioMixer.h"
+#include "AudioPreflight.h"
+#include "AudioSink.h"
+#include "OutputLatency.h"
+#include "PlaybackWatchdog.h"
 
+// 所有指令音频经 AudioMixer 混到音频后端的同一路输出：
+// 文件由后端打开为解码源并作为混音声部，渲染线程按后端输出的排队量补写。
+// 新播放不截断上一路，上一路转为后台优先级（被闪避）直到自然播完。
+// 平台相关部分（设备、解码、系统音量）全部在 IAudioBackend 中，本类可在任意平台编译运行。
+//
+// 前台声部由播放看门狗（PlaybackWatchdog）看护：音频提前中断时从断点处改用备用文件接着播，
+// 设备不再取数据或写入失败时换备用设备重开输出并从断点处继续，检出与接替耗时写入调试输出。
+//
+// 每组输出设备有一份延迟档案（OutputLatencyProfiles）：会话按后端报告的设备延迟 + 混音排队量提前起播。
+// 每次起播的出声观测（recordOnsetMeasurement）只记入档案作诊断，不改变提前量。
 class AudioPlayer {
 public:
-    // 初始化 BASS 库。失败时通过 OutputDebugString 输出 BASS 错误码
+    // 指定音频后端（Windows 为 BassAudioBackend，无声卡环境为 WavSinkBackend）。须在 initialize() 之前调用。
+    // 同时清空输出延迟档案
+    static void setBackend(std::unique_ptr<IAudioBackend> backend);
+
+    // 打开后端输出并启动混音渲染线程。未设置后端或后端打开失败返回 false
     static bool initialize();
     static void cleanup();
 
-    // 播放音频文件（位于 audio 子目录）。返回是否成功开始播放
+    // 输出设备（编号或名称片段，见后端），空表示默认设备。多台时同一指令在各设备上按采样对齐起播。
+    // 与当前不同且已初始化时整体重开输出：正在播放的声部随之停止，预载池被清空（调用方随后重新载入）
+    static void setOutputDevices(const std::vector<std::string>& devices);
+    // 各输出设备的延迟、补偿与偏差。只有一台设备时为空
+    static std::vector<OutputDeviceStats> getOutputDeviceStats();
+
+    // 备用输出设备：看门狗检出设备故障时改用这些设备重开输出（空则在原设备上重开）
+    static void setBackupOutputDevices(const std::vector<std::string>& devices);
+    // 备用音频目录：音频提前中断时优先从这里的同名文件接着播；本机镜像生效时源目录也作为备用
+    static void setBackupAudioDir(const std::filesystem::path& dir);
+    // 自上次 initialize() 起看门狗检出的故障与接替记录（按发生先后）
+    static std::vector<WatchdogEvent> getWatchdogEvents();
+
+    // 输出延迟补偿（默认开启）：会话按当前输出设备的延迟档案提前起播，使首帧落在计划时刻
+    static void setLatencyCompensation(bool enabled);
+    // 会话应提前起播的毫秒数：当前档案的提前量，未开启补偿或未初始化为 0
+    static double getOutputCompensationMs();
+    // 当前输出设备的延迟档案（未初始化时为空档案）
+    static OutputLatencyProfile getOutputLatencyProfile();
+
+    // 播放音频文件（位于 audio 子目录），作为新的前台声部叠加到混音输出。返回是否成功开始播放。
+    // 若该文件已由 prepareAudioFile 预热，直接接管已缓冲的解码源；在片段缓存/预载池中则从内存建源。
+    // filename 为组合指令（ClipSequence，以 | 分隔的片段）时各片段首尾相接作为一个声部播放
     static bool playAudioFile(const std::string& filename);
 
-    // 当前是否有音频正在播放（基于 BASS 通道活跃状态）
+    // 预热下一条指令的音频：整文件读入内存、建解码流并预解码首段，
+    // 到点时 playAudioFile 只需把源交给混音器。可在非 UI 线程调用；
+    // 同一时刻只保留一路预热源，新的预热替换旧的
+    static bool prepareAudioFile(const std::string& filename);
+    static void discardPrepared();
+
+    // 接续预约：当前声部读尽的同一帧起接着播放 filename（混音器就地换源，无空隙）。
+    // 随后 playAudioFile 同名文件时，已接上的直接接管；尚未接上（上一路仍在播）的取消后按普通播放起播。
+    // 同一时刻只保留一路预约，新的预约替换旧的；playAudioFile 其他文件或 stop() 取消预约。无当前声部返回 false
+    static bool queueAudioFile(const std::string& filename);
+    // 声部播完时的通知（在混音渲染线程上调用，只应做唤醒），空表示取消。可在任意时刻设置
+    static void setEndNotify(std::function<void()> notify);
+
+    // 最近一次 playAudioFile 从进入到命令入队的耗时（毫秒），以及是否命中预热。
+    // 实际出声另加混音输出的排队延迟（MixerConfig::targetQueuedFrames）
+    static double getLastStartLatencyMs();
+    static bool wasLastStartPrepared();
+    // 最近一次 playAudioFile 返回到首帧出声的时长（毫秒）：混音器渲染该声部首块的时刻 + 输出排队量 + 设备延迟。
+    // 渲染线程尚未取走该声部时返回 false
+    static bool getLastOnsetDelayMs(double& delayMs);
+    // 把最近一次普通起播（非接续）的出声延迟记入当前延迟档案的起播观测，每个声部只记一次。
+    // 尚未出声、已记过或是接续接上的声部返回 false
+    static bool recordOnsetMeasurement();
+
+    // 最近一次播放的声部是否仍在发声
     static bool isPlaying();
 
-    // 停止当前播放（如有）
+    // 停止全部声部（短淡出）
     static void stop();
 
-    // 获取当前正在播放流的时长（秒）。无活跃流或失败返回 0.0
+    // 最近一次播放的音频时长（秒，已扣除裁去的开头静音）。无播放返回 0.0
     static double getCurrentStreamDuration();
 
-    // 获取音频文件时长（秒）。失败返回 0.0
+    // 配置加载后把 files 预载入内存（原文件字节或解码后的 PCM，受 budgetBytes 约束），
+    // 之后的播放/预热优先从内存建源。载入耗时与内存占用写入调试输出并返回
+    static AssetPoolStats loadAssetPool(const std::vector<std::string>& files, AssetPolicy policy,
+                                        uint64_t budgetBytes);
+    static AssetPoolStats getAssetPoolStats();
+
+    // 片段缓存的默认预算：组合指令的片段多为一两秒的短句，解码为 PCM 后仍很小
+    static constexpr uint64_t CLIP_CACHE_BUDGET_BYTES = 64ull * 1024 * 1024;
+    // 把组合指令用到的片段预解码为 PCM（与预载池分开，不受 asset_pool_mode 影响），
+    // 拼接时各片段直接从内存读，起播不为每个片段建解码流
+    static AssetPoolStats loadClipCache(const std::vector<std::string>& clips, uint64_t budgetBytes);
+    static AssetPoolStats getClipCacheStats();
+
+    // 后台刷新 files 的元数据缓存（audio 目录下的缓存文件，未变化的文件不重新探测），
+    // 时长可用后在后台线程上调用 onDone（只应做投递，如 PostMessage），随后对尚未分析的文件做响度与开头静音分析，
+    // 结束后调用 onAnalyzed（可为空）。新的刷新取消进行中的上一次
+    static void refreshMetadataAsync(std::vector<std::string> files, std::function<void()> onDone,
+                                     std::function<void()> onAnalyzed = std::function<void()>());
+    // 元数据缓存中的时长（秒），未知返回 0.0（组合指令为各片段之和，有片段未知即为 0.0）。
+    // 不做任何 I/O，可在任意线程调用
+    static double getCachedDuration(const std::string& filename);
+
+    // 完整解码预检用的解码器：经当前后端按文件原采样率打开解码源（可在任意线程调用）。
+    // 未初始化时先初始化，失败返回空。返回的解码器引用后端，须在 cleanup() 之前用完
+    static AudioPreflight::Decoder getPreflightDecoder();
+
+    // 混音开销统计（每块平均/最大开销、CPU 负载、欠载次数）
+    static MixerStats getMixerStats();
+
+    // 获取音频文件时长（秒）：优先取元数据缓存，其次读 MP3/WAV 文件头，其他格式再经后端探测。失败返回 0.0
     static double getAudioDuration(const std::string& filename);
 
+    // 响度归一化目标（LUFS，如 -16）；>= 0 关闭。已分析的文件起播时按元数据缓存中的响度施加增益，
+    // 未分析的文件按原样播放
+    static void setLoudnessTarget(double targetLufs);
+    // 最近一次起播施加的响度增益（线性）。组合指令为 1（增益按片段分别施加）
+    static float getLastGain();
+
+    // 起音前保留的静音（秒）
+    static constexpr double TRIM_PREROLL_SECONDS = 0.02;
+    // 裁去开头静音：已分析的文件从首个非静音采样前 TRIM_PREROLL_SECONDS 处起播，
+    // 未分析的文件从头播放。默认关闭
+    static void setTrimLeadingSilence(bool enabled);
+    // 最近一次起播裁去的开头静音（秒）
+    static double getLastTrimSeconds();
+
     // 获取系统主音量百分比 [0,100]，失败返回 0
     static int getSystemVolume();
 
 private:
-    static bool s_initialized;
-    // BASS 流句柄（HSTREAM 即 DWORD）。0 表示无流。
-    // 用 DWORD 而非 HSTREAM，避免头文件依赖 bass.h
-    static DWORD s_currentStream;
+    static void stopLocked();
+    static void discardPreparedLocked();
+    static void cancelQueuedLocked();
+    static bool queueLocked(const std::string& filename);
+    static float normalizationGainLocked(const std::string& filename);
+    static double trimSecondsLocked(const std::string& filename);
+    // 单个文件建源：片段缓存 → 预载池 → 打包条目/散文件。prime 时预解码首段（散文件中的小文件先整读入内存）。
+    // fromDisk 返回源是否仍从磁盘（文件流或打包文件映射）读取
+    static std::unique_ptr<MixerSource> openFileLocked(const std::string& filename, double trim, bool prime,
+                                                       double* durationSeconds, bool* fromDisk);
+    // 组合指令建源：逐片段建源后拼接。trimSeconds 为首个片段裁去的开头静音；任一片段从磁盘读取即 fromDisk
+    static std::unique_ptr<MixerSource> openSequenceLocked(const std::string& audioFile, bool prime,
+                                                           double* durationSeconds, double* trimSeconds,
+                                                           bool* fromDisk);
+    // 从磁盘读取的源包一层 ReadAheadSource，交给混音器后渲染线程不再碰文件
+    static std::unique_ptr<MixerSource> readAheadLocked(std::unique_ptr<MixerSource> source, bool fromDisk);
+    // s_startedVoice 的首帧出声时刻；取到后记在 s_startedOnset，重开输出作废句柄后仍可取
+    static bool startedOnsetLocked(std::chrono::steady_clock::time_point& onset);
+    // 按设备打开后端输出、建混音器并启动渲染线程。openOutput 只碰后端：调用方须独占后端
+    // （持 s_mutex，或 s_reopening 期间），成功后由 publishOutputLocked 装入并选定延迟档案
+    static bool openOutputLocked(const std::vector<std::string>& devices);
+    static std::unique_ptr<AudioMixer> openOutput(const std::vector<std::string>& devices);
+    static void publishOutputLocked(std::unique_ptr<AudioMixer> mixer, const std::vector<std::string>& devices);
+    // 前台声部最外层包一层看护源；progress 返回其进度记录
+    static std::unique_ptr<MixerSource> watchLocked(const std::string& filename, std::unique_ptr<MixerSource> source,
+                                                    double startSeconds, double durationSeconds, float gain,
+                                                    int recoveries, std::shared_ptr<VoiceProgress>& progress);
+    // 看门狗的采样与接替（在看门狗线程上调用）
+    static bool sampleWatchdog(WatchdogSample& sample);
+    static bool recoverPlayback(const WatchdogSample& sample, WatchdogFault fault, double positionSeconds,
+                                std::string& via);
+    // 换备用设备（没有则原设备）整体重开输出，原有声部、预热与接续全部作废。
+    // 进入与返回时都持 lock；停渲染线程、关闭与重开设备期间释放，s_mutex 只在摘下旧混音器与装入新混音器时持有
+    static bool failoverOutput(std::unique_lock<std::mutex>& lock, std::string& via);
+    // 在备用目录/镜像源目录中找同名文件，从 positionSeconds 处建源（读盘，不持 s_mutex 调用）
+    static std::unique_ptr<MixerSource> openBackup(const std::vector<std::filesystem::path>& dirs,
+                                                   const std::string& filename, double positionSeconds,
+                                                   uint32_t mixRate, double* durationSeconds, std::string& via);
+    // 从文件中 positionSeconds 处按原来的取法重新建源（组合指令重新拼接后跳过断点之前的部分）
+    static std::unique_ptr<MixerSource> openResumeLocked(const std::string& filename, double positionSeconds,
+                                                         double* durationSeconds, bool* fromDisk, std::string& via);
+
+    // 写入均持 s_mutex；playAudioFile 等入口不持锁先查一次（未初始化再进 initialize()），故为原子量。
+    // 看门狗在 failoverOutput 中会清掉又置回
+    static std::atomic<bool> s_initialized;
+    static std::unique_ptr<IAudioBackend> s_backend;
+    static std::unique_ptr<AudioMixer> s_mixer;
+
+    // 最近一次播放的声部（前台），0 表示无
+    static AudioMixer::VoiceHandle s_currentVoice;
+    static double s_currentDuration;
+
+    // 预热源：由播放线程提前建立，到点起播时接管
+    static std::unique_ptr<MixerSource> s_preparedSource;
+    static std::string s_preparedFilename;
+    static double s_preparedDuration;
+    static double s_preparedTrimSeconds;
+
+    // 接续预约：已交给混音器挂在当前声部之后
+    static AudioMixer::VoiceHandle s_queuedVoice;
+    static std::string s_queuedFilename;
+    static double s_queuedDuration;
+    static double s_queuedTrimSeconds;
+    static float s_queuedGain;
+
+    static double s_lastStartLatencyMs;
+    static bool s_lastStartPrepared;
+    static std::chrono::steady_clock::time_point s_lastHandoffTime;  // 最近一次声部交给混音器的时刻
+    static double s_loudnessTargetLufs;  // >= 0 表示不做响度归一化
+    static float s_lastGain;
+    static bool s_trimLeadingSilence;
+    static double s_lastTrimSeconds;
+    static std::vector<std::string> s_outputDevices;
+    static std::vector<std::string> s_backupOutputDevices;
+    static std::filesystem::path s_backupAudioDir;
+
+    // 看门狗看护的前台声部（s_currentVoice）与已预约接续的进度记录
+    static std::shared_ptr<VoiceProgress> s_watched;
+    static std::shared_ptr<VoiceProgress> s_queuedProgress;
+
+    // 输出延迟档案与补偿开关；s_outputLatencyMs 为打开输出时后端报告的设备延迟
+    static OutputLatencyProfiles s_latencyProfiles;
+    static bool s_latencyCompensation;
+    static double s_outputLatencyMs;
+    // 出声时刻尚未记入档案的普通起播声部
+    static AudioMixer::VoiceHandle s_measuredVoice;
+    // 起播延迟按此声部测量：接替换上的声部不算新的起播（原声部尚未出声时除外）
+    static AudioMixer::VoiceHandle s_startedVoice;
+    static std::chrono::steady_clock::time_point s_startedOnset;
+    static bool s_startedOnsetKnown;
+
+    // 保护以上状态并串行化混音器控制端（预热与播放在播放线程，查询在 UI 线程）
+    static std::mutex s_mutex;
+    // 看门狗在锁外重开输出期间为真（s_initialized 为假）：initialize() 等重开结束，不另开输出
+    static bool s_reopening;
+    static std::condition_variable s_reopened;
+
+    // 播完通知：渲染线程上读取，与 s_mutex 分开，不与控制端争锁
+    static std::function<void()> s_endNotify;
+    static std::mutex s_endNotifyMutex;
+
+    // 音频预载池（自带锁，载入不阻塞播放）
+    static AudioAssetPool s_assetPool;
+    // 组合指令的片段缓存（PCM）
+    static AudioAssetPool s_clipCache;
+    // 音频元数据缓存（自带锁与后台刷新线程）
+    static AudioMetadataCache s_metadataCache;
+    // 播放看门狗（自带线程，在 s_mutex 之外启停）
+    static PlaybackWatchdog s_watchdog;
+};
+
+// AudioSink 适配器：把 ExamSession 的播放请求转发给 AudioPlayer
+class AudioPlayerSink : public AudioSink {
+public:
+    bool prepare(const std::string& filename) override { return AudioPlayer::prepareAudioFile(filename); }
+    bool play(const std::string& filename) override { return AudioPlayer::playAudioFile(filename); }
+    bool queue(const std::string& filename) override { return AudioPlayer::queueAudioFile(filename); }
+    bool isPlaying() override { return AudioPlayer::isPlaying(); }
+    void stop() override { AudioPlayer::stop(); }
+    double getCurrentStreamDuration() override { return AudioPlayer::getCurrentStreamDuration(); }
+    void setEndNotify(std::function<void()> notify) override { AudioPlayer::setEndNotify(std::move(notify)); }
+    bool supportsOverlap() const override { return true; }
+    bool measuresOnset() const override { return true; }
+    bool getOnsetDelayMs(double& delayMs) override { return AudioPlayer::getLastOnsetDelayMs(delayMs); }
+    void recordOnsetMeasurement() override { AudioPlayer::recordOnsetMeasurement(); }
+    double getOutputLatencyMs() override { return AudioPlayer::getOutputCompensationMs(); }
 };
@@ -0,0 +1,302 @@
+#include "AudioPreflight.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "AudioBackend.h"
+#include "AudioMixer.h"
+
+namespace {
+// 每次从解码源读取的帧数
+constexpr size_t kPreflightReadFrames = 16384;
+// 文件头无法给出采样率时请求的输出采样率
+constexpr uint32_t kFallbackSampleRate = 44100;
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 已定位的文件：读文件头、逐段解码，统计时长、峰值与满幅连续段
+void checkLocated(const AudioLocation& location, const AudioPreflight::Decoder& decoder,
+                  const std::atomic<bool>* cancel, PreflightResult& result) {
+    const auto start = std::chrono::steady_clock::now();
+    AudioFormatInfo header;
+    const bool recognized = location.inBundle()
+                                ? AudioHeaderParser::probeMemory(location.bytes.data, location.bytes.size, header)
+                                : AudioHeaderParser::probeFile(location.path, header);
+    if (recognized) {
+        result.codec = header.codecName();
+        result.headerSeconds = header.declaredSeconds;
+    }
+
+    uint32_t sampleRate = 0;
+    bool unsupported = false;
+    std::unique_ptr<MixerSource> source = decoder(location, header, sampleRate, unsupported);
+    if (!source) {
+        // 后端不支持的格式只能以文件头为准：头也认不出则无从判断能否播放
+        result.problem = unsupported && recognized ? PreflightProblem::NONE : PreflightProblem::UNDECODABLE;
+        result.decodeMs = elapsedSince(start);
+        return;
+    }
+
+    // 满幅连续段按声道分别计数，跨越读取块边界
+    std::vector<float> buffer(kPreflightReadFrames * 2);
+    int run[2] = {0, 0};
+    uint64_t frames = 0;
+    float peak = 0.0f;
+    size_t read = 0;
+    while ((read = source->read(buffer.data(), kPreflightReadFrames)) > 0) {
+        if (cancel && cancel->load()) {
+            return;
+        }
+        frames += read;
+        for (size_t i = 0; i < read * 2; ++i) {
+            const float level = std::fabs(buffer[i]);
+            peak = std::max(peak, level);
+            int& length = run[i & 1];
+            if (level < AudioPreflight::CLIP_LEVEL) {
+                length = 0;
+            } else if (++length == AudioPreflight::CLIP_RUN) {
+                result.clippedSamples += AudioPreflight::CLIP_RUN;
+            } else if (length > AudioPreflight::CLIP_RUN) {
+                ++result.clippedSamples;
+            }
+        }
+    }
+    result.decoded = true;
+    result.samplePeak = peak;
+    result.decodedSeconds = sampleRate > 0 ? static_cast<double>(frames) / sampleRate : 0.0;
+    result.decodeMs = elapsedSince(start);
+
+    if (frames == 0 && (!recognized || result.headerSeconds > 0.0)) {
+        result.problem = PreflightProblem::UNDECODABLE;
+    } else if (recognized && result.decodedSeconds < result.headerSeconds - AudioPreflight::TRUNCATION_TOLERANCE) {
+        result.problem = PreflightProblem::TRUNCATED;
+    } else if (result.clippedSamples > 0) {
+        result.problem = PreflightProblem::CLIPPED;
+    }
+}
+}  // namespace
+
+AudioPreflight::~AudioPreflight() {
+    cancel();
+}
+
+AudioPreflight::Decoder AudioPreflight::backendDecoder(IAudioBackend& backend) {
+    IAudioBackend* target = &backend;
+    return [target](const AudioLocation& location, const AudioFormatInfo& header, uint32_t& sampleRate,
+                    bool& unsupported) -> std::unique_ptr<MixerSource> {
+        unsupported = !target->canDecode(header);
+        if (unsupported) {
+            return nullptr;
+        }
+        // 按原采样率打开：检查的是文件本身，不经变采样
+        sampleRate = header.sampleRate > 0 ? header.sampleRate : kFallbackSampleRate;
+        double duration = 0.0;
+        return target->openSource(location.path, location.bytes, sampleRate, 0.0, false, &duration);
+    };
+}
+
+PreflightResult AudioPreflight::checkFile(const std::string& file, const Decoder& decoder,
+                                          const std::atomic<bool>* cancel) {
+    PreflightResult result;
+    result.file = file;
+    AudioLocation location;
+    if (!AudioBundle::locate(file, location)) {
+        result.problem = PreflightProblem::MISSING;
+        return result;
+    }
+    checkLocated(location, decoder, cancel, result);
+    return result;
+}
+
+size_t AudioPreflight::defaultThreads() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+const char* AudioPreflight::problemName(PreflightProblem problem) {
+    switch (problem) {
+    case PreflightProblem::NONE:
+        return "正常";
+    case PreflightProblem::MISSING:
+        return "缺失";
+    case PreflightProblem::UNDECODABLE:
+        return "无法解码";
+    case PreflightProblem::TRUNCATED:
+        return "截断";
+    case PreflightProblem::CLIPPED:
+        return "削波";
+    }
+    return "未知";
+}
+
+std::string AudioPreflight::formatReport(const PreflightReport& report) {
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+                  "音频预检: %zu 个文件，完整解码 %zu 个（合计 %.1f 秒），仅检查文件头 %zu 个；"
+                  "异常 %zu 个，削波 %zu 个；%zu 线程，用时 %.1f ms（解码合计 %.1f ms）%s\n",
+                  report.files, report.decodedFiles, report.decodedSeconds, report.headerOnlyFiles,
+                  report.problemFiles, report.clippedFiles, report.threads, report.elapsedMs, report.decodeMs,
+                  report.cancelled ? "，已取消" : (report.complete ? "" : "，未完成"));
+    std::string text = buf;
+    for (const PreflightResult& result : report.results) {
+        if (result.problem == PreflightProblem::NONE) {
+            continue;
+        }
+        switch (result.problem) {
+        case PreflightProblem::TRUNCATED:
+            std::snprintf(buf, sizeof(buf), "  %s: %s（文件头 %.3f 秒，实际 %.3f 秒）\n", result.file.c_str(),
+                          problemName(result.problem), result.headerSeconds, result.decodedSeconds);
+            break;
+        case PreflightProblem::CLIPPED:
+            std::snprintf(buf, sizeof(buf), "  %s: %s（%llu 个满幅采样，峰值 %.1f dBFS）\n", result.file.c_str(),
+                          problemName(result.problem), static_cast<unsigned long long>(result.clippedSamples),
+                          20.0 * std::log10(std::max(result.samplePeak, 1e-9)));
+            break;
+        default:
+            std::snprintf(buf, sizeof(buf), "  %s: %s\n", result.file.c_str(), problemName(result.problem));
+            break;
+        }
+        text += buf;
+    }
+    return text;
+}
+
+void AudioPreflight::setThreads(size_t threads) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threads = threads;
+}
+
+void AudioPreflight::setDecoder(Decoder decoder) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoder = std::move(decoder);
+}
+
+PreflightReport AudioPreflight::run(const std::vector<std::string>& files) {
+    return runImpl(files);
+}
+
+void AudioPreflight::runAsync(std::vector<std::string> files, Completion onDone) {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+    m_running.store(true);
+    m_worker = std::thread([this, files = std::move(files), onDone = std::move(onDone)]() {
+        PreflightReport report = runImpl(files);
+        m_running.store(false);
+        if (!report.cancelled && onDone) {
+            onDone(report);
+        }
+    });
+}
+
+void AudioPreflight::cancel() {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (m_worker.joinable()) {
+        m_cancel.store(true);
+        m_worker.join();
+    }
+    m_cancel.store(false);
+}
+
+PreflightReport AudioPreflight::getReport() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_report;
+}
+
+PreflightReport AudioPreflight::runImpl(const std::vector<std::string>& files) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t threads;
+    Decoder decoder;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        threads = m_threads > 0 ? m_threads : defaultThreads();
+        decoder = m_decoder;
+        m_report = PreflightReport();
+    }
+
+    PreflightReport report;
+    report.threads = threads;
+    std::vector<std::string> unique;
+    for (const std::string& file : files) {
+        if (std::find(unique.begin(), unique.end(), file) == unique.end()) {
+            unique.push_back(file);
+        }
+    }
+    report.files = unique.size();
+    report.results.resize(unique.size());
+
+    // 第一遍只定位：缺失立即得出，其余按大小从大到小排队，最长的文件最先开始解码
+    struct Pending {
+        size_t index;
+        AudioLocation location;
+    };
+    std::vector<Pending> pending;
+    for (size_t i = 0; i < unique.size(); ++i) {
+        PreflightResult& result = report.results[i];
+        result.file = unique[i];
+        AudioLocation location;
+        if (!decoder || !AudioBundle::locate(unique[i], location)) {
+            result.problem = decoder ? PreflightProblem::MISSING : PreflightProblem::UNDECODABLE;
+            ++report.checkedFiles;
+            ++report.problemFiles;
+            continue;
+        }
+        pending.push_back({i, std::move(location)});
+    }
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const Pending& a, const Pending& b) { return a.location.size > b.location.size; });
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_report = report;
+    }
+
+    // 线程池从共享下标取任务，每完成一个文件把结果写回 m_report
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < pending.size() && !m_cancel.load(); i = next++) {
+            const Pending& item = pending[i];
+            PreflightResult result;
+            result.file = unique[item.index];
+            checkLocated(item.location, decoder, &m_cancel, result);
+            if (m_cancel.load()) {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_report.checkedFiles;
+            m_report.decodeMs += result.decodeMs;
+            if (result.decoded) {
+                ++m_report.decodedFiles;
+                m_report.decodedSeconds += result.decodedSeconds;
+            } else if (result.problem == PreflightProblem::NONE) {
+                ++m_report.headerOnlyFiles;
+            }
+            if (result.problem == PreflightProblem::CLIPPED) {
+                ++m_report.clippedFiles;
+            } else if (result.problem != PreflightProblem::NONE) {
+                ++m_report.problemFiles;
+            }
+            m_report.results[item.index] = std::move(result);
+        }
+    };
+    const size_t poolSize = std::min(threads, pending.size());
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < poolSize; ++i) {
+        pool.emplace_back(worker);
+    }
+    if (poolSize > 0) {
+        worker();
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_report.cancelled = m_cancel.load();
+    m_report.complete = !m_report.cancelled && m_report.checkedFiles == m_report.files;
+    m_report.elapsedMs = elapsedSince(start);
+    return m_report;
+}
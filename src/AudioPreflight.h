@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioBundle.h"
+#include "AudioHeaderParser.h"
+
+class IAudioBackend;
+class MixerSource;
+
+enum class PreflightProblem : uint8_t {
+    NONE,
+    MISSING,      // 文件不存在（打包文件与 audio 目录下都没有）
+    UNDECODABLE,  // 文件头无法识别、解码源打不开或解不出任何采样
+    TRUNCATED,    // 解码出的时长明显短于文件头声明的时长（拷贝不完整、文件中途损坏）
+    CLIPPED       // 有满幅削波（仍可播放，提示重新制作）
+};
+
+// 一个文件的检查结果
+struct PreflightResult {
+    std::string file;
+    PreflightProblem problem = PreflightProblem::NONE;
+    bool decoded = false;          // 已完整解码；false 且无问题表示后端不能解码该格式，只检查了文件头
+    std::string codec;             // 文件头识别的格式，无法识别为空
+    double headerSeconds = 0.0;    // 文件头声明的时长（无法识别为 0）
+    double decodedSeconds = 0.0;   // 完整解码得到的时长
+    double samplePeak = 0.0;       // 采样峰值（线性）
+    uint64_t clippedSamples = 0;   // 落在满幅连续段中的采样数
+    double decodeMs = 0.0;
+};
+
+struct PreflightReport {
+    size_t files = 0;           // 不同文件数
+    size_t checkedFiles = 0;    // 已有结论的文件
+    size_t decodedFiles = 0;
+    size_t headerOnlyFiles = 0; // 后端不能解码，只检查了文件头
+    size_t problemFiles = 0;    // 缺失/无法解码/截断（不含削波）
+    size_t clippedFiles = 0;
+    double decodedSeconds = 0.0;  // 解码出的音频总时长
+    size_t threads = 0;
+    double elapsedMs = 0.0;     // 墙钟耗时
+    double decodeMs = 0.0;      // 各文件解码耗时之和（/ elapsedMs 即并行度）
+    std::vector<PreflightResult> results;  // 与输入文件同序
+    bool complete = false;
+    bool cancelled = false;
+};
+
+// 完整解码预检：把配置引用到的每个不同音频文件从头到尾解码一遍，报告解码错误、截断、削波与实际时长。
+//
+// 存在检查（Instruction::checkAudioFileExists）只证明文件在；截断或编码损坏的文件要到起播时才暴露，
+// 可能正是考试的最后一条指令。预检在线程池上进行（解码是计算密集的，线程数取 CPU 核数），
+// 文件按从大到小分配，最长的听力文件先开始，墙钟时间随核数近似线性下降。
+//
+// 解码经注入的 Decoder（通常为 backendDecoder：与起播同一个后端解码源，按原采样率输出）逐段读取，
+// 不整文件展开为 PCM。文件头声明了时长（MP3 的 Xing/VBRI 帧数、WAV data 块头记录的长度）时，
+// 解码出的时长短于它即判为截断；CBR MP3 的时长由文件大小推算，截断后两者一致，只能发现解不出的情况。
+//
+// runAsync() 在后台线程上检查，完成后调用 onDone；新的检查取消并等待上一次。
+class AudioPreflight {
+public:
+    // 打开 location 的解码源，输出交错立体声（尽量按 header.sampleRate，不做变采样），
+    // sampleRate 填实际输出采样率。header 为文件头解析结果（无法识别时 codec 为 UNKNOWN）。
+    // 后端不能解码该格式时返回 nullptr 并置 unsupported
+    using Decoder = std::function<std::unique_ptr<MixerSource>(const AudioLocation& location,
+                                                               const AudioFormatInfo& header, uint32_t& sampleRate,
+                                                               bool& unsupported)>;
+    using Completion = std::function<void(const PreflightReport& report)>;
+
+    static constexpr float CLIP_LEVEL = 0.999f;          // 约 -0.01 dBFS
+    static constexpr int CLIP_RUN = 3;                   // 连续这么多个采样达到满幅才算削波（单个满幅峰值不算）
+    static constexpr double TRUNCATION_TOLERANCE = 0.1;  // 秒：编码器延迟与尾部填充之外的差距才算截断
+
+    AudioPreflight() = default;
+    ~AudioPreflight();
+
+    AudioPreflight(const AudioPreflight&) = delete;
+    AudioPreflight& operator=(const AudioPreflight&) = delete;
+
+    // 后端的解码源：按文件原采样率打开，不能解码的格式（如 WAV 后端的 MP3）置 unsupported
+    static Decoder backendDecoder(IAudioBackend& backend);
+    // 检查一个文件（经 AudioBundle::locate 定位）。cancel 置位时中途返回，结果不完整
+    static PreflightResult checkFile(const std::string& file, const Decoder& decoder,
+                                     const std::atomic<bool>* cancel = nullptr);
+    // 默认线程数：CPU 核数，至少 1
+    static size_t defaultThreads();
+    static const char* problemName(PreflightProblem problem);
+    // 多行文本报告：汇总一行，之后每个有问题（含削波）的文件一行
+    static std::string formatReport(const PreflightReport& report);
+
+    void setThreads(size_t threads);  // 0 为 defaultThreads()
+    void setDecoder(Decoder decoder);
+
+    // 同步检查 files（重复的只查一次）
+    PreflightReport run(const std::vector<std::string>& files);
+    // 后台检查：onDone 在后台线程上调用（只应做投递，可为空；被取消时不调用）
+    void runAsync(std::vector<std::string> files, Completion onDone);
+    // 取消并等待进行中的后台检查
+    void cancel();
+    bool isRunning() const { return m_running.load(); }
+
+    // 最近一次检查的结果（进行中为当前的部分结果）
+    PreflightReport getReport() const;
+
+private:
+    PreflightReport runImpl(const std::vector<std::string>& files);
+
+    mutable std::mutex m_mutex;
+    PreflightReport m_report;
+    size_t m_threads = 0;
+    Decoder m_decoder;
+
+    std::mutex m_workerMutex;  // 串行化 runAsync / cancel
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_running{false};
+};
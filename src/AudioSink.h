@@ -0,0 +1,42 @@
+#pragma once
+#include <functional>
+#include <string>
+
+// 播放输出端口：ExamSession 只通过此接口驱动音频。
+// Windows 正式运行由 AudioPlayerSink 适配 BASS，模拟器/测试注入 RecordingAudioSink。
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    // 预热即将播放的文件（打开、预读、预缓冲），到点 play() 同名文件时直接起播。
+    // 默认不支持预热，返回 false；失败不影响随后 play() 走冷启动路径
+    virtual bool prepare(const std::string& filename) { (void)filename; return false; }
+    // 播放 audio 目录下的文件。返回是否成功开始播放。
+    // 不支持叠加的输出端先停止上一路；支持叠加的把上一路转入后台（闪避）继续播完
+    virtual bool play(const std::string& filename) = 0;
+    // 接续预约：当前这一路播完时，在同一采样处接着播放 filename（中间没有空隙）。
+    // 随后 play() 同名文件时直接接管已在发声的接续，不再建流；新的 play() 其他文件或 stop() 取消预约。
+    // 默认不支持，返回 false：调用方在播放完成后再 play()
+    virtual bool queue(const std::string& filename) { (void)filename; return false; }
+    // 最近一次 play() 的这一路是否仍在播放
+    virtual bool isPlaying() = 0;
+    // 停止全部播放（如有）
+    virtual void stop() = 0;
+    // 当前播放流的时长（秒），无流或失败返回 0.0
+    virtual double getCurrentStreamDuration() = 0;
+    // 某一路播完时的通知（在音频线程上调用，只应做唤醒），空表示取消。
+    // 调用方据此立即检测完成，不必等轮询周期。默认不支持：调用方只能轮询 isPlaying()
+    virtual void setEndNotify(std::function<void()> notify) { (void)notify; }
+
+    // 是否支持叠加播放（混音输出）。支持时会话到点即播，不必等上一条播完
+    virtual bool supportsOverlap() const { return false; }
+
+    // 是否能测量起播到实际出声的延迟。不能测量的输出端，调用方不等待 getOnsetDelayMs()
+    virtual bool measuresOnset() const { return false; }
+    // 最近一次 play() 返回到首帧实际出声的时长（毫秒）。尚未出声（仍在设备队列之前）返回 false
+    virtual bool getOnsetDelayMs(double& delayMs) { (void)delayMs; return false; }
+    // 会话在按时刻起播的指令出声后调用一次：输出端可把这次出声延迟记作诊断。默认不记
+    virtual void recordOnsetMeasurement() {}
+    // 预计 play() 到首帧出声的输出延迟（毫秒）：会话按此提前起播，使首帧落在计划时刻。默认 0（不补偿）
+    virtual double getOutputLatencyMs() { return 0.0; }
+};
@@ -0,0 +1,406 @@
+#include "BassAudioBackend.h"
+#include <mmdeviceapi.h>
+#include <endpointvolume.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mmsystem.h>
+#include "PcmKernels.h"
+
+// 包含 Bass Audio Library
+#include "../third_party/bass/bass.h"
+
+// 根据平台链接对应的 Bass 库
+#ifdef _WIN64
+#pragma comment(lib, "../third_party/bass/x64/bass.lib")
+#else
+#pragma comment(lib, "../third_party/bass/bass.lib")
+#endif
+
+#pragma comment(lib, "winmm.lib")
+
+namespace {
+// 解码通道每次读取的帧数；预热时预解码的首段帧数（约 100ms）
+constexpr size_t kDecodeChunkFrames = 1024;
+constexpr size_t kPrimeFrames = 4096;
+constexpr uint32_t kDefaultMixRate = 44100;
+
+void logBassError(const char* context) {
+    int code = BASS_ErrorGetCode();
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "[BASS] %s failed, error=%d\n", context, code);
+    OutputDebugStringA(buf);
+}
+
+// BASS 解码通道作为混音声部：float 输出，按声道数折算为立体声（单声道复制，多声道取前两路）。
+// 文件数据（内存流）须在通道释放前保持有效，由本对象共同持有（预载池与打包文件映射中的数据不复制）
+class BassDecodeSource : public MixerSource {
+public:
+    BassDecodeSource(HSTREAM stream, DWORD channels, AudioBytes data)
+        : m_stream(stream), m_channels(std::max<DWORD>(channels, 1)), m_data(std::move(data)),
+          m_native(kDecodeChunkFrames * m_channels) {}
+
+    ~BassDecodeSource() override {
+        BASS_StreamFree(m_stream);
+    }
+
+    // 预解码首段：起播后的第一次 read 不必等文件读取与解码
+    void prime() {
+        m_head.resize(kPrimeFrames * 2);
+        m_headFrames = decode(m_head.data(), kPrimeFrames);
+        m_headPosition = 0;
+    }
+
+    size_t read(float* out, size_t frames) override {
+        size_t done = 0;
+        if (m_headPosition < m_headFrames) {
+            size_t count = std::min(frames, m_headFrames - m_headPosition);
+            std::memcpy(out, m_head.data() + m_headPosition * 2, count * 2 * sizeof(float));
+            m_headPosition += count;
+            done = count;
+        }
+        return done + decode(out + done * 2, frames - done);
+    }
+
+private:
+    size_t decode(float* out, size_t frames) {
+        size_t done = 0;
+        while (done < frames && !m_ended) {
+            size_t want = std::min(frames - done, kDecodeChunkFrames);
+            DWORD bytes = BASS_ChannelGetData(m_stream, m_native.data(),
+                static_cast<DWORD>(want * m_channels * sizeof(float)));
+            if (bytes == static_cast<DWORD>(-1) || bytes == 0) {
+                m_ended = true;
+                break;
+            }
+            size_t got = bytes / (m_channels * sizeof(float));
+            if (m_channels == 2) {
+                std::memcpy(out + done * 2, m_native.data(), got * 2 * sizeof(float));
+            } else if (m_channels == 1) {
+                m_kernels.monoToStereo(m_native.data(), out + done * 2, got);
+            } else {
+                for (size_t i = 0; i < got; ++i) {
+                    const float* frame = m_native.data() + i * m_channels;
+                    out[(done + i) * 2] = frame[0];
+                    out[(done + i) * 2 + 1] = frame[1];
+                }
+            }
+            done += got;
+        }
+        return done;
+    }
+
+    HSTREAM m_stream;
+    DWORD m_channels;
+    AudioBytes m_data;
+    std::vector<float> m_native;
+    std::vector<float> m_head;
+    const PcmKernels& m_kernels = PcmKernels::get();
+    size_t m_headFrames = 0;
+    size_t m_headPosition = 0;
+    bool m_ended = false;
+};
+
+// 混音输出：BASS 推送流。关闭通道播放缓冲后，推送队列即唯一的输出缓冲，
+// 渲染线程按其排队量补写，设备时钟决定节奏
+class BassPushOutput : public MixerOutput {
+public:
+    explicit BassPushOutput(HSTREAM stream) : m_stream(stream) {}
+
+    size_t queuedFrames() override {
+        DWORD bytes = BASS_ChannelGetData(m_stream, NULL, BASS_DATA_AVAILABLE);
+        return bytes == static_cast<DWORD>(-1) ? 0 : bytes / (2 * sizeof(float));
+    }
+
+    bool write(const float* samples, size_t frames) override {
+        return BASS_StreamPutData(m_stream, samples,
+            static_cast<DWORD>(frames * 2 * sizeof(float))) != static_cast<DWORD>(-1);
+    }
+
+private:
+    HSTREAM m_stream;
+};
+
+// 按编号或名称片段在 BASS 设备列表中查找（跳过 0 号“无声”设备与未启用的设备），返回设备号，不重复
+std::vector<int> resolveDevices(const std::vector<std::string>& selection) {
+    std::vector<int> indices;
+    for (const auto& wanted : selection) {
+        const bool numeric = !wanted.empty() && wanted.find_first_not_of("0123456789") == std::string::npos;
+        int found = -1;
+        BASS_DEVICEINFO info;
+        for (DWORD i = 1; found < 0 && BASS_GetDeviceInfo(i, &info); ++i) {
+            if (!(info.flags & BASS_DEVICE_ENABLED)) {
+                continue;
+            }
+            if (numeric ? std::to_string(i) == wanted : (!wanted.empty() && std::strstr(info.name, wanted.c_str()))) {
+                found = static_cast<int>(i);
+            }
+        }
+        if (found < 0) {
+            char buf[256];
+            std::snprintf(buf, sizeof(buf), "[BASS] output device not found: %s\n", wanted.c_str());
+            OutputDebugStringA(buf);
+        } else if (std::find(indices.begin(), indices.end(), found) == indices.end()) {
+            indices.push_back(found);
+        }
+    }
+    return indices;
+}
+
+// 打开解码源（data 非空时为内存流），采样率与混音器不同时套一层变采样
+std::unique_ptr<MixerSource> openDecodeSource(const std::filesystem::path& audioPath, AudioBytes data,
+                                              uint32_t mixRate, double startSeconds, bool prime,
+                                              double* durationSeconds) {
+    HSTREAM stream = 0;
+    if (!data.empty()) {
+        stream = BASS_StreamCreateFile(TRUE, data.data, 0, data.size, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+    } else {
+        std::wstring widePath = audioPath.wstring();
+        stream = BASS_StreamCreateFile(FALSE, widePath.c_str(), 0, 0,
+                                       BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT | BASS_UNICODE);
+    }
+    if (!stream) {
+        logBassError("BASS_StreamCreateFile (decode)");
+        return nullptr;
+    }
+
+    BASS_CHANNELINFO info = {};
+    BASS_ChannelGetInfo(stream, &info);
+    QWORD lengthBytes = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
+    *durationSeconds = lengthBytes != (QWORD)-1 ? BASS_ChannelBytes2Seconds(stream, lengthBytes) : 0.0;
+
+    // 裁去开头静音：解码到起点而非按码率跳转（VBR MP3 跳转不准），首段预解码从起点开始
+    if (startSeconds > 0.0 &&
+        !BASS_ChannelSetPosition(stream, BASS_ChannelSeconds2Bytes(stream, startSeconds),
+                                 BASS_POS_BYTE | BASS_POS_DECODETO)) {
+        logBassError("BASS_ChannelSetPosition (trim)");
+    }
+
+    auto decoder = std::make_unique<BassDecodeSource>(stream, info.chans, std::move(data));
+    if (prime) {
+        decoder->prime();
+    }
+    if (info.freq == 0 || info.freq == mixRate) {
+        return decoder;
+    }
+    return std::make_unique<ResamplingSource>(std::move(decoder), info.freq, mixRate);
+}
+
+
+// 预载池的 PCM 解码器：整段解码为原采样率的交错立体声 float
+bool decodeAll(const std::vector<char>& bytes, PcmBuffer& out) {
+    HSTREAM stream = BASS_StreamCreateFile(TRUE, bytes.data(), 0, bytes.size(), BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+    if (!stream) {
+        logBassError("BASS_StreamCreateFile (pool decode)");
+        return false;
+    }
+    BASS_CHANNELINFO info = {};
+    BASS_ChannelGetInfo(stream, &info);
+    out.sampleRate = info.freq;
+    QWORD lengthBytes = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
+    if (lengthBytes != (QWORD)-1 && info.chans > 0) {
+        out.samples.reserve(static_cast<size_t>(lengthBytes / (info.chans * sizeof(float))) * 2);
+    }
+
+    // 通道由 decoder 接管释放；字节由调用方在解码期间保持有效
+    BassDecodeSource decoder(stream, info.chans, AudioBytes());
+    std::vector<float> chunk(kDecodeChunkFrames * 2);
+    while (true) {
+        size_t frames = decoder.read(chunk.data(), kDecodeChunkFrames);
+        out.samples.insert(out.samples.end(), chunk.begin(), chunk.begin() + frames * 2);
+        if (frames < kDecodeChunkFrames) {
+            break;
+        }
+    }
+    return !out.samples.empty();
+}
+
+const char* codecName(DWORD ctype) {
+    switch (ctype) {
+        case BASS_CTYPE_STREAM_MP3: return "mp3";
+        case BASS_CTYPE_STREAM_MP2: return "mp2";
+        case BASS_CTYPE_STREAM_MP1: return "mp1";
+        case BASS_CTYPE_STREAM_OGG: return "ogg";
+        case BASS_CTYPE_STREAM_AIFF: return "aiff";
+        default: return (ctype & BASS_CTYPE_STREAM_WAV) ? "wav" : "other";
+    }
+}
+}  // namespace
+
+BassAudioBackend::~BassAudioBackend() {
+    close();
+}
+
+// 初始化一台设备（-1 为默认设备）并建立输出推送流。第一台设备决定混音采样率
+bool BassAudioBackend::openDevice(int index, MixerConfig& config, bool first) {
+    if (!BASS_Init(index, kDefaultMixRate, 0, NULL, NULL)) {
+        logBassError("BASS_Init");
+        return false;
+    }
+    Device device;
+    device.index = BASS_GetDevice();
+    BASS_DEVICEINFO info;
+    device.name = BASS_GetDeviceInfo(device.index, &info) && info.name ? info.name : "default";
+
+    // 混音器以设备输出采样率工作，省去 BASS 的二次变采样（其余设备由 BASS 变采样）
+    BASS_INFO deviceInfo = {};
+    const bool hasInfo = BASS_GetInfo(&deviceInfo) != FALSE;
+    if (first) {
+        config.sampleRate = hasInfo && deviceInfo.freq ? deviceInfo.freq : kDefaultMixRate;
+        config.blockFrames = config.sampleRate / 100;
+        config.targetQueuedFrames = config.blockFrames * 4;
+    }
+    // BASS 初始化时测得的设备延迟（BASS_INFO.latency），扇出据此对齐各设备的首帧
+    device.latencyFrames = hasInfo ? static_cast<size_t>(deviceInfo.latency) * config.sampleRate / 1000 : 0;
+
+    HSTREAM output = BASS_StreamCreate(config.sampleRate, 2, BASS_SAMPLE_FLOAT, STREAMPROC_PUSH, NULL);
+    if (!output) {
+        logBassError("BASS_StreamCreate (push)");
+        BASS_Free();
+        return false;
+    }
+    BASS_ChannelSetAttribute(output, BASS_ATTRIB_BUFFER, 0);
+    device.stream = output;
+    device.output = std::make_unique<BassPushOutput>(output);
+    m_devices.push_back(std::move(device));
+    return true;
+}
+
+bool BassAudioBackend::open(MixerConfig& config) {
+    if (m_open) {
+        return true;
+    }
+    // 设备名按 UTF-8 返回，与配置文件一致
+    BASS_SetConfig(BASS_CONFIG_UNICODE, TRUE);
+
+    std::vector<int> indices = resolveDevices(m_selection);
+    for (int index : indices) {
+        openDevice(index, config, m_devices.empty());
+    }
+    // 未选择设备，或所选设备都不可用：退回默认设备
+    if (m_devices.empty() && !openDevice(-1, config, true)) {
+        return false;
+    }
+
+    // 推送流建好后再一起开始播放，各设备的起点尽量接近（余下的差异由扇出按排队量补偿）
+    for (size_t i = 0; i < m_devices.size(); ++i) {
+        BASS_SetDevice(m_devices[i].index);
+        if (!BASS_ChannelPlay(m_devices[i].stream, FALSE)) {
+            logBassError("BASS_ChannelPlay (push)");
+        }
+    }
+    size_t maxLatencyFrames = 0;
+    for (const auto& device : m_devices) {
+        maxLatencyFrames = std::max(maxLatencyFrames, device.latencyFrames);
+    }
+    m_outputLatencyMs = maxLatencyFrames * 1000.0 / config.sampleRate;
+    if (m_devices.size() > 1) {
+        std::vector<FanOutDevice> fanOut;
+        for (const auto& device : m_devices) {
+            fanOut.push_back({device.name, device.output.get(), device.latencyFrames});
+        }
+        // BASS 的排队量随设备周期成块跳变，漂移容差取 1ms
+        m_fanOut = std::make_unique<FanOutOutput>(std::move(fanOut), config.sampleRate, config.sampleRate / 1000);
+    }
+    m_open = true;
+    return true;
+}
+
+void BassAudioBackend::close() {
+    if (!m_open) {
+        return;
+    }
+    // 解码源持有的通道已随混音器释放，此处只剩输出流
+    m_fanOut.reset();
+    for (auto& device : m_devices) {
+        device.output.reset();
+        BASS_StreamFree(device.stream);
+        BASS_SetDevice(device.index);
+        BASS_Free();
+    }
+    m_devices.clear();
+    m_outputLatencyMs = 0.0;
+    m_open = false;
+}
+
+MixerOutput& BassAudioBackend::output() {
+    if (m_fanOut) {
+        return *m_fanOut;
+    }
+    return *m_devices.front().output;
+}
+
+std::vector<OutputDeviceStats> BassAudioBackend::getDeviceStats() const {
+    return m_fanOut ? m_fanOut->getStats() : std::vector<OutputDeviceStats>();
+}
+
+std::unique_ptr<MixerSource> BassAudioBackend::openSource(const std::filesystem::path& path, AudioBytes data,
+                                                          uint32_t mixRate, double startSeconds, bool prime,
+                                                          double* durationSeconds) {
+    return openDecodeSource(path, std::move(data), mixRate, startSeconds, prime, durationSeconds);
+}
+
+bool BassAudioBackend::decodeToPcm(const std::vector<char>& bytes, PcmBuffer& out) {
+    return decodeAll(bytes, out);
+}
+
+bool BassAudioBackend::probe(const std::filesystem::path& path, AudioMetadata& metadata) {
+    std::wstring widePath = path.wstring();
+    HSTREAM stream = BASS_StreamCreateFile(FALSE, widePath.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_UNICODE);
+    if (!stream) {
+        return false;
+    }
+    BASS_CHANNELINFO info = {};
+    BASS_ChannelGetInfo(stream, &info);
+    QWORD lengthBytes = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
+    if (lengthBytes != (QWORD)-1) {
+        metadata.durationSeconds = BASS_ChannelBytes2Seconds(stream, lengthBytes);
+    }
+    metadata.sampleRate = info.freq;
+    metadata.channels = info.chans;
+    metadata.codec = codecName(info.ctype);
+    BASS_StreamFree(stream);
+    return metadata.durationSeconds > 0.0;
+}
+
+int BassAudioBackend::getSystemVolume() {
+    HRESULT hr;
+    IMMDeviceEnumerator* deviceEnumerator = NULL;
+    IMMDevice* defaultDevice = NULL;
+    IAudioEndpointVolume* endpointVolume = NULL;
+    float currentVolume = 0;
+
+    hr = CoCreateInstance(
+        __uuidof(MMDeviceEnumerator),
+        NULL,
+        CLSCTX_ALL,
+        __uuidof(IMMDeviceEnumerator),
+        (void**)&deviceEnumerator);
+    if (FAILED(hr)) return 0;
+
+    hr = deviceEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &defaultDevice);
+    if (FAILED(hr)) {
+        deviceEnumerator->Release();
+        return 0;
+    }
+
+    hr = defaultDevice->Activate(
+        __uuidof(IAudioEndpointVolume),
+        CLSCTX_ALL,
+        NULL,
+        (void**)&endpointVolume);
+    if (FAILED(hr)) {
+        defaultDevice->Release();
+        deviceEnumerator->Release();
+        return 0;
+    }
+
+    hr = endpointVolume->GetMasterVolumeLevelScalar(&currentVolume);
+
+    endpointVolume->Release();
+    defaultDevice->Release();
+    deviceEnumerator->Release();
+
+    if (FAILED(hr)) return 0;
+    return static_cast<int>(currentVolume * 100);
+}
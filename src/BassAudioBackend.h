@@ -0,0 +1,52 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <windows.h>
+#include "AudioBackend.h"
+
+// BASS 实现的音频后端：混音结果写入 BASS 推送流输出到默认设备（或配置的多台设备，经 FanOutOutput 对齐），
+// 文件以 BASS 解码通道打开作为混音声部，系统音量经 Core Audio (COM) 读取
+class BassAudioBackend : public IAudioBackend {
+public:
+    BassAudioBackend() = default;
+    ~BassAudioBackend() override;
+
+    const char* name() const override { return "BASS"; }
+
+    // 编号为 BASS 设备号（1 起），否则按名称片段匹配 BASS_GetDeviceInfo 的设备名（UTF-8）
+    void setOutputDevices(const std::vector<std::string>& devices) override { m_selection = devices; }
+    // 初始化所选设备（未选择或都不可用时为默认设备）、各建一路输出推送流。
+    // 失败时通过 OutputDebugString 输出 BASS 错误码
+    bool open(MixerConfig& config) override;
+    void close() override;
+    MixerOutput& output() override;
+    std::vector<OutputDeviceStats> getDeviceStats() const override;
+    // 各设备 BASS_INFO.latency 的最大值
+    double getOutputLatencyMs() const override { return m_outputLatencyMs; }
+
+    std::unique_ptr<MixerSource> openSource(const std::filesystem::path& path, AudioBytes data, uint32_t mixRate,
+                                            double startSeconds, bool prime, double* durationSeconds) override;
+    bool decodeToPcm(const std::vector<char>& bytes, PcmBuffer& out) override;
+    // 只建解码通道读头部信息与长度，不解码
+    bool probe(const std::filesystem::path& path, AudioMetadata& metadata) override;
+    int getSystemVolume() override;
+
+private:
+    struct Device {
+        DWORD index = 0;     // BASS 设备号
+        std::string name;
+        // 输出推送流句柄（HSTREAM 即 DWORD）。用 DWORD 而非 HSTREAM，避免头文件依赖 bass.h
+        DWORD stream = 0;
+        std::unique_ptr<MixerOutput> output;
+        size_t latencyFrames = 0;
+    };
+
+    bool openDevice(int index, MixerConfig& config, bool first);
+
+    std::vector<std::string> m_selection;
+    std::vector<Device> m_devices;
+    std::unique_ptr<FanOutOutput> m_fanOut;  // 多于一台设备时
+    bool m_open = false;
+    double m_outputLatencyMs = 0.0;
+};
@@ -0,0 +1,43 @@
+#include "ClipSequence.h"
+#include "AudioBundle.h"
+
+bool ClipSequence::isSequence(const std::string& audioFile) {
+    return audioFile.find(SEPARATOR) != std::string::npos;
+}
+
+std::vector<std::string> ClipSequence::split(const std::string& audioFile) {
+    std::vector<std::string> clips;
+    size_t start = 0;
+    while (true) {
+        size_t end = audioFile.find(SEPARATOR, start);
+        clips.push_back(audioFile.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return clips;
+}
+
+std::string ClipSequence::join(const std::vector<std::string>& clips) {
+    std::string joined;
+    for (size_t i = 0; i < clips.size(); ++i) {
+        if (i > 0) {
+            joined += SEPARATOR;
+        }
+        joined += clips[i];
+    }
+    return joined;
+}
+
+bool ClipSequence::exists(const std::string& audioFile) {
+    if (!isSequence(audioFile)) {
+        return AudioBundle::exists(audioFile);
+    }
+    for (const auto& clip : split(audioFile)) {
+        if (!AudioBundle::exists(clip)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 组合指令：配置中指令的音频字段可写成以 | 分隔的多个片段（如 考前.mp3|12.mp3|分钟.mp3），
+// 播放时依次首尾相接、不留空隙（见 SequenceSource）。只差一个数字的提示语共用片段，音频库随之变小。
+//
+// 指令的 audioFile 即规范化后的字段：各片段名去掉首尾空白后以 | 连接。只有一个文件的指令不受影响。
+// 预载、元数据、打包与清单都按片段处理（ConfigManager::getAudioFiles 展开组合指令）
+class ClipSequence {
+public:
+    static constexpr char SEPARATOR = '|';
+    static constexpr size_t MAX_CLIPS = 16;
+
+    static bool isSequence(const std::string& audioFile);
+    // 各片段文件名；单个文件返回只含它的列表
+    static std::vector<std::string> split(const std::string& audioFile);
+    static std::string join(const std::vector<std::string>& clips);
+    // 每个片段都存在（打包条目或 audio 目录下的散文件）
+    static bool exists(const std::string& audioFile);
+};
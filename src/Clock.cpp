@@ -0,0 +1,16 @@
+#include "Clock.h"
+
+Clock& Clock::system() {
+    static SystemClock instance;
+    return instance;
+}
+
+std::tm toLocalTm(std::time_t time) {
+    std::tm tm = {};
+#ifdef _WIN32
+    localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
+    return tm;
+}
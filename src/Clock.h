@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <ctime>
+
+// 时钟抽象：调度与过期判定统一经由 Clock::now() 取墙钟时间，
+// 正式运行注入系统时钟，模拟器注入虚拟时钟以快于实时地回放整场考试。
+class Clock {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    virtual ~Clock() = default;
+    virtual time_point now() const = 0;
+
+    // 进程级系统时钟实例
+    static Clock& system();
+};
+
+class SystemClock : public Clock {
+public:
+    time_point now() const override { return std::chrono::system_clock::now(); }
+};
+
+// 虚拟时钟：只在 set()/advance() 时前进。非线程安全，由驱动方单线程使用。
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(time_point start = time_point()) : m_now(start) {}
+
+    time_point now() const override { return m_now; }
+    void set(time_point timePoint) { m_now = timePoint; }
+    void advance(std::chrono::system_clock::duration delta) { m_now += delta; }
+
+private:
+    time_point m_now;
+};
+
+// 可移植的本地时间换算（Windows: localtime_s，POSIX: localtime_r）
+std::tm toLocalTm(std::time_t time);
@@ -1,18 +1,24 @@
 #include "ConfigManager.h"
 #include "Subject.h"
+#include "ClipSequence.h"
 #include "PathUtil.h"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <climits>
 #include <filesystem>
+#include <fstream>
+#include <set>
 #include <cstdio>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 namespace {
 // 防御性上限（不变量 §4）：实际配置远小于这些值，超出视为异常输入并拒绝。
-constexpr DWORD kMaxConfigFileSize = 1 * 1024 * 1024;      // 单文件 ≤ 1MB
+constexpr size_t kMaxConfigFileSize = 1 * 1024 * 1024;     // 单文件 ≤ 1MB
 constexpr int kMaxConfigLineCount = 10000;                  // 行数 ≤ 10000
-constexpr int kMaxInstructionsPerSubject = 500;             // 单科目指令 ≤ 500
-constexpr int kMaxInstructionsTotal = 5000;                 // 全局指令 ≤ 5000
+// 指令数上限见 ConfigManager::kMaxInstructionsPerSubject / kMaxInstructionsTotal
 constexpr size_t kMaxAudioFilenameLength = 260;             // 音频文件名长度 ≤ 260
 
 // audioFile 路径穿越防护（不变量 §4/§5）。
@@ -48,21 +54,16 @@ bool isSafeAudioFilename(const std::string& name) {
 void logConfigWarning(const char* msg) {
     char buf[256];
     std::snprintf(buf, sizeof(buf), "[ConfigManager] %s\n", msg);
+#ifdef _WIN32
     OutputDebugStringA(buf);
+#else
+    std::fputs(buf, stderr);
+#endif
 }
-}  // namespace
-
-ConfigManager& ConfigManager::getInstance() {
-    static ConfigManager instance;
-    return instance;
-}
-
-bool ConfigManager::loadConfig(const std::wstring& filePath) {
-    m_currentConfigPath = filePath;
-
-    // 清空现有配置
-    m_subjectConfigs.clear();
 
+// 整体读入配置文件。打开失败/空文件/超限返回 false
+bool readConfigFile(const std::wstring& filePath, std::string& content) {
+#ifdef _WIN32
     // 使用 Windows API 打开文件 - 方案1
     HANDLE hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ,
                               NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
@@ -84,14 +85,62 @@ bool ConfigManager::loadConfig(const std::wstring& filePath) {
     }
 
     // 读取文件内容
-    std::string fileContent(fileSize, '\0');
+    content.assign(fileSize, '\0');
     DWORD bytesRead;
-    if (!ReadFile(hFile, &fileContent[0], fileSize, &bytesRead, NULL)) {
+    if (!ReadFile(hFile, &content[0], fileSize, &bytesRead, NULL)) {
         CloseHandle(hFile);
         return false;
     }
 
     CloseHandle(hFile);
+    return true;
+#else
+    std::ifstream file(PathUtil::fromWide(filePath), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    if (fileSize <= 0) {
+        return false;
+    }
+    if (static_cast<size_t>(fileSize) > kMaxConfigFileSize) {
+        logConfigWarning("config file exceeds size limit, rejected");
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    content.assign(static_cast<size_t>(fileSize), '\0');
+    return static_cast<bool>(file.read(&content[0], fileSize));
+#endif
+}
+}  // namespace
+
+ConfigManager& ConfigManager::getInstance() {
+    static ConfigManager instance;
+    return instance;
+}
+
+bool ConfigManager::loadConfig(const std::wstring& filePath) {
+    m_currentConfigPath = filePath;
+
+    // 清空现有配置
+    m_subjectConfigs.clear();
+    m_prefetchSeconds = kDefaultPrefetchSeconds;
+    m_assetPoolMegabytes = kDefaultAssetPoolMegabytes;
+    m_assetPoolMode = kDefaultAssetPoolMode;
+    m_loudnessTarget = kDefaultLoudnessTarget;
+    m_trimLeadingSilence = kDefaultTrimLeadingSilence;
+    m_outputDevices.clear();
+    m_audioMirror = kDefaultAudioMirror;
+    m_audioMirrorDir.clear();
+    m_backupOutputDevices.clear();
+    m_backupAudioDir.clear();
+    m_latencyCompensation = kDefaultLatencyCompensation;
+
+    std::string fileContent;
+    if (!readConfigFile(filePath, fileContent)) {
+        return false;
+    }
 
     // 使用字符串流解析内容
     std::istringstream file(fileContent);
@@ -128,8 +177,8 @@ bool ConfigManager::loadConfig(const std::wstring& filePath) {
             currentSection = line.substr(1, line.length() - 2);
             currentSection = trim(currentSection);
 
-            // 如果不是空节标题，初始化科目配置
-            if (!currentSection.empty()) {
+            // 如果不是空节标题（也不是保留的设置节），初始化科目配置
+            if (!currentSection.empty() && currentSection != kSettingsSection) {
                 SubjectFullConfig& config = m_subjectConfigs[currentSection];
                 config.subjectInfo.name = currentSection;
                 config.subjectInfo.durationMinutes = Subject::DEFAULT_DURATION_MINUTES;
@@ -140,7 +189,9 @@ bool ConfigManager::loadConfig(const std::wstring& filePath) {
         // 解析键值对
         std::string key, value;
         if (parseConfigLine(line, key, value)) {
-            if (!currentSection.empty() && m_subjectConfigs.find(currentSection) != m_subjectConfigs.end()) {
+            if (currentSection == kSettingsSection) {
+                parseSettingLine(key, value);
+            } else if (!currentSection.empty() && m_subjectConfigs.find(currentSection) != m_subjectConfigs.end()) {
                 SubjectFullConfig& config = m_subjectConfigs[currentSection];
 
                 // 只支持新的简化格式
@@ -172,11 +223,30 @@ bool ConfigManager::loadConfig(const std::wstring& filePath) {
         }
     }
 
+    // 接续指令须接在同一科目某条指令之后：所接的偏移处没有指令时退回按该偏移到点播放
+    for (auto& pair : m_subjectConfigs) {
+        auto& instructions = pair.second.instructions;
+        for (auto& instruction : instructions) {
+            if (!instruction.chained) {
+                continue;
+            }
+            bool anchored = std::any_of(instructions.begin(), instructions.end(),
+                                        [&instruction](const InstructionTemplate& other) {
+                                            return !other.chained &&
+                                                   other.offsetMilliseconds == instruction.offsetMilliseconds;
+                                        });
+            if (!anchored) {
+                logConfigWarning("after: offset has no instruction, played at that offset instead");
+                instruction.chained = false;
+            }
+        }
+    }
+
     return !m_subjectConfigs.empty();
 }
 
 std::wstring ConfigManager::getDefaultConfigPath() const {
-    return PathUtil::getConfigPath(L"default.ini").wstring();
+    return PathUtil::toWide(PathUtil::getConfigPath(L"default.ini"));
 }
 
 std::vector<SubjectConfig> ConfigManager::getSubjects() const {
@@ -200,12 +270,16 @@ SubjectConfig ConfigManager::getSubjectConfig(const std::string& subjectName) co
 std::vector<InstructionTemplate> ConfigManager::getInstructionTemplates(const std::string& subjectName) const {
     auto it = m_subjectConfigs.find(subjectName);
     if (it != m_subjectConfigs.end()) {
-        // 返回该科目的指令列表，并确保按时间排序
+        // 返回该科目的指令列表，并确保按时间排序。同一偏移处接续指令排在按时刻播放的指令之后，
+        // 各自保持配置顺序（多条接续依次首尾相接）
         auto instructions = it->second.instructions;
-        std::sort(instructions.begin(), instructions.end(),
-                  [](const InstructionTemplate& a, const InstructionTemplate& b) {
-                      return a.offsetSeconds < b.offsetSeconds;
-                  });
+        std::stable_sort(instructions.begin(), instructions.end(),
+                         [](const InstructionTemplate& a, const InstructionTemplate& b) {
+                             if (a.offsetMilliseconds != b.offsetMilliseconds) {
+                                 return a.offsetMilliseconds < b.offsetMilliseconds;
+                             }
+                             return !a.chained && b.chained;
+                         });
         return instructions;
     }
 
@@ -221,6 +295,42 @@ std::vector<std::string> ConfigManager::getSubjectNames() const {
     return names;
 }
 
+std::vector<std::string> ConfigManager::getAudioFiles() const {
+    std::vector<std::string> files;
+    std::set<std::string> seen;
+    for (const auto& pair : m_subjectConfigs) {
+        for (const auto& instruction : pair.second.instructions) {
+            if (instruction.audioFile.empty()) {
+                continue;
+            }
+            for (auto& clip : ClipSequence::split(instruction.audioFile)) {
+                if (seen.insert(clip).second) {
+                    files.push_back(std::move(clip));
+                }
+            }
+        }
+    }
+    return files;
+}
+
+std::vector<std::string> ConfigManager::getSequenceClips() const {
+    std::vector<std::string> clips;
+    std::set<std::string> seen;
+    for (const auto& pair : m_subjectConfigs) {
+        for (const auto& instruction : pair.second.instructions) {
+            if (!ClipSequence::isSequence(instruction.audioFile)) {
+                continue;
+            }
+            for (auto& clip : ClipSequence::split(instruction.audioFile)) {
+                if (seen.insert(clip).second) {
+                    clips.push_back(std::move(clip));
+                }
+            }
+        }
+    }
+    return clips;
+}
+
 bool ConfigManager::loadDefaultConfig() {
     return loadConfig(getDefaultConfigPath());
 }
@@ -236,6 +346,89 @@ bool ConfigManager::parseConfigLine(const std::string& line, std::string& key, s
     return !key.empty() && !value.empty();
 }
 
+void ConfigManager::parseSettingLine(const std::string& key, const std::string& value) {
+    if (key == "prefetch_seconds") {
+        try {
+            m_prefetchSeconds = std::clamp(std::stoi(value), 0, kMaxPrefetchSeconds);
+        } catch (...) {
+            logConfigWarning("prefetch_seconds invalid, using default");
+            m_prefetchSeconds = kDefaultPrefetchSeconds;
+        }
+    } else if (key == "asset_pool_mb") {
+        try {
+            m_assetPoolMegabytes = std::clamp(std::stoi(value), 0, kMaxAssetPoolMegabytes);
+        } catch (...) {
+            logConfigWarning("asset_pool_mb invalid, using default");
+            m_assetPoolMegabytes = kDefaultAssetPoolMegabytes;
+        }
+    } else if (key == "asset_pool_mode") {
+        if (value == "compressed" || value == "pcm" || value == "auto") {
+            m_assetPoolMode = value;
+        } else {
+            logConfigWarning("asset_pool_mode invalid, using default");
+            m_assetPoolMode = kDefaultAssetPoolMode;
+        }
+    } else if (key == "loudness_target") {
+        try {
+            int target = std::stoi(value);
+            m_loudnessTarget = target == 0 ? 0 : std::clamp(target, kMinLoudnessTarget, kMaxLoudnessTarget);
+        } catch (...) {
+            logConfigWarning("loudness_target invalid, using default");
+            m_loudnessTarget = kDefaultLoudnessTarget;
+        }
+    } else if (key == "trim_leading_silence") {
+        if (value == "0" || value == "1") {
+            m_trimLeadingSilence = value == "1";
+        } else {
+            logConfigWarning("trim_leading_silence invalid, using default");
+            m_trimLeadingSilence = kDefaultTrimLeadingSilence;
+        }
+    } else if (key == "output_devices") {
+        parseDeviceList(key, value, m_outputDevices);
+    } else if (key == "backup_output_devices") {
+        parseDeviceList(key, value, m_backupOutputDevices);
+    } else if (key == "audio_mirror") {
+        if (value == "auto" || value == "on" || value == "off") {
+            m_audioMirror = value;
+        } else {
+            logConfigWarning("audio_mirror invalid, using default");
+            m_audioMirror = kDefaultAudioMirror;
+        }
+    } else if (key == "audio_mirror_dir") {
+        m_audioMirrorDir = value;
+    } else if (key == "backup_audio_dir") {
+        m_backupAudioDir = value;
+    } else if (key == "latency_compensation") {
+        if (value == "0" || value == "1") {
+            m_latencyCompensation = value == "1";
+        } else {
+            logConfigWarning("latency_compensation invalid, using default");
+            m_latencyCompensation = kDefaultLatencyCompensation;
+        }
+    } else {
+        logConfigWarning("unknown setting ignored");
+    }
+}
+
+void ConfigManager::parseDeviceList(const std::string& key, const std::string& value,
+                                    std::vector<std::string>& devices) {
+    devices.clear();
+    std::istringstream list(value);
+    std::string device;
+    while (std::getline(list, device, '|')) {
+        device = trim(device);
+        if (device.empty()) {
+            continue;
+        }
+        if (devices.size() >= kMaxOutputDevices) {
+            logConfigWarning((key + " exceeds limit, extra devices ignored").c_str());
+            break;
+        }
+        if (std::find(devices.begin(), devices.end(), device) == devices.end()) {
+            devices.push_back(device);
+        }
+    }
+}
 
 bool ConfigManager::parseInstructionLine(const std::string& timeKey, const std::string& config,
                                         InstructionTemplate& instruction) {
@@ -245,28 +438,91 @@ bool ConfigManager::parseInstructionLine(const std::string& timeKey, const std::
     }
 
     std::string name = trim(config.substr(0, pipePos1));
-    std::string audioFile = trim(config.substr(pipePos1 + 1));
-
-    if (name.empty() || audioFile.empty()) {
+    if (name.empty()) {
         return false;
     }
 
-    // 路径穿越防护（不变量 §4/§5）：禁止绝对路径/盘符/..上跳
-    if (!isSafeAudioFilename(audioFile)) {
-        logConfigWarning("audioFile rejected: path traversal or invalid");
+    // 音频字段：一个文件，或以 | 分隔的多个片段（组合指令，依次无缝播放）
+    std::vector<std::string> clips = ClipSequence::split(config.substr(pipePos1 + 1));
+    if (clips.size() > ClipSequence::MAX_CLIPS) {
+        logConfigWarning("audioFile rejected: too many clips");
         return false;
     }
+    for (auto& clip : clips) {
+        clip = trim(clip);
+        if (clip.empty()) {
+            return false;
+        }
+        // 路径穿越防护（不变量 §4/§5）：禁止绝对路径/盘符/..上跳
+        if (!isSafeAudioFilename(clip)) {
+            logConfigWarning("audioFile rejected: path traversal or invalid");
+            return false;
+        }
+    }
 
     instruction.name = name;
-    instruction.audioFile = audioFile;
+    instruction.audioFile = ClipSequence::join(clips);
 
-    // 解析时间偏移（直接使用秒数）
-    try {
-        instruction.offsetSeconds = std::stoi(timeKey);
-    } catch (...) {
+    // 接续指令：after:偏移，接在该偏移处的指令播完之后
+    static const std::string kAfterPrefix = "after:";
+    instruction.chained = timeKey.compare(0, kAfterPrefix.size(), kAfterPrefix) == 0;
+    const std::string offset = instruction.chained ? trim(timeKey.substr(kAfterPrefix.size())) : timeKey;
+
+    // 解析时间偏移（秒，可带毫秒小数）
+    return parseOffsetMilliseconds(offset, instruction.offsetMilliseconds);
+}
+
+// 与旧版 std::stoi 一致地容忍数字后的多余字符
+bool ConfigManager::parseOffsetMilliseconds(const std::string& text, int& offsetMilliseconds) {
+    constexpr long long kMaxOffsetSeconds = INT_MAX / 1000;
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+        negative = text[pos] == '-';
+        ++pos;
+    }
+
+    long long seconds = 0;
+    size_t integerDigits = 0;
+    while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+        seconds = seconds * 10 + (text[pos] - '0');
+        if (seconds > kMaxOffsetSeconds) {
+            return false;
+        }
+        ++pos;
+        ++integerDigits;
+    }
+
+    long long milliseconds = 0;
+    size_t fractionDigits = 0;
+    if (pos < text.size() && text[pos] == '.') {
+        ++pos;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            if (fractionDigits < 3) {
+                milliseconds = milliseconds * 10 + (text[pos] - '0');
+            }
+            ++pos;
+            ++fractionDigits;
+        }
+    }
+    if (integerDigits == 0 && fractionDigits == 0) {
         return false;
     }
+    for (size_t i = fractionDigits; i < 3; ++i) {
+        milliseconds *= 10;
+    }
+    if (fractionDigits > 3) {
+        logConfigWarning("offset finer than 1 ms truncated");
+    }
+    if (pos < text.size()) {
+        logConfigWarning("trailing characters after offset ignored");
+    }
 
+    long long total = seconds * 1000 + milliseconds;
+    if (total > INT_MAX) {
+        return false;
+    }
+    offsetMilliseconds = static_cast<int>(negative ? -total : total);
     return true;
 }
 
@@ -10,9 +10,12 @@ struct SubjectConfig {
 };
 
 struct InstructionTemplate {
-    int offsetSeconds;
+    // 相对开考时间的偏移（毫秒）。配置中以秒书写，可带至多 3 位小数（如 20.500）
+    int offsetMilliseconds;
     std::string name;
     std::string audioFile;
+    // 接续指令：配置键写成 after:偏移，在该偏移处的指令（及排在其后的接续指令）播完时立即播放
+    bool chained = false;
 };
 
 struct SubjectFullConfig {
@@ -22,8 +25,39 @@ struct SubjectFullConfig {
 
 class ConfigManager {
 public:
+    // 防御性上限（不变量 §4）：单科目/全局指令数，超出视为异常配置整体拒绝
+    static constexpr int kMaxInstructionsPerSubject = 500;
+    static constexpr int kMaxInstructionsTotal = 5000;
+
+    // 保留节名：[设置] 存放全局运行参数，不作为科目
+    static constexpr const char* kSettingsSection = "设置";
+    // 预取提前量（秒）：下一条指令的音频在播放前多久打开并预缓冲。0 表示关闭
+    static constexpr int kDefaultPrefetchSeconds = 10;
+    static constexpr int kMaxPrefetchSeconds = 300;
+    // 音频预载池：配置加载后把引用到的音频整体读入内存的预算（MB，0 表示关闭）与存放形式
+    static constexpr int kDefaultAssetPoolMegabytes = 256;
+    static constexpr int kMaxAssetPoolMegabytes = 4096;
+    static constexpr const char* kDefaultAssetPoolMode = "auto";  // compressed | pcm | auto
+    // 响度归一化目标（LUFS）：已分析的音频起播时按 EBU R128 积分响度调到该值。0 表示关闭
+    static constexpr int kDefaultLoudnessTarget = -16;
+    static constexpr int kMinLoudnessTarget = -40;
+    static constexpr int kMaxLoudnessTarget = -5;
+    // 起播时裁去音频开头的静音（按后台分析得出的首个非静音采样）
+    static constexpr bool kDefaultTrimLeadingSilence = true;
+    static constexpr bool kDefaultLatencyCompensation = true;
+    // 输出设备：以 | 分隔的设备编号或名称片段，多台时同一指令在各设备上对齐播放。为空使用默认设备。
+    // 备用输出设备写法相同：播放看门狗检出设备故障时改用它们重开输出，为空则在原设备上重开
+    static constexpr size_t kMaxOutputDevices = 8;
+    // 本机镜像：启动/加载配置后把引用到的音频拷到本机目录，校验通过后改从镜像取音频。
+    // auto 仅当 audio 目录在可移动介质或网络驱动器上时启用；镜像目录为空时取系统临时目录下的默认位置
+    static constexpr const char* kDefaultAudioMirror = "auto";  // auto | on | off
+
     static ConfigManager& getInstance();
 
+    // 时间偏移：秒，可带至多 3 位小数（毫秒），如 "20"、"20.500"、"-0.25"。超出毫秒的小数位截断，
+    // 数字后的多余字符忽略（均记警告）；结果须落在 int 毫秒范围内（约 ±24 天）
+    static bool parseOffsetMilliseconds(const std::string& text, int& offsetMilliseconds);
+
     bool loadConfig(const std::wstring& filePath);
     bool loadDefaultConfig();
 
@@ -31,9 +65,27 @@ public:
     SubjectConfig getSubjectConfig(const std::string& subjectName) const;
     std::vector<InstructionTemplate> getInstructionTemplates(const std::string& subjectName) const;
     std::vector<std::string> getSubjectNames() const;
+    // 全部科目引用到的音频文件名（组合指令展开为各片段；去重，按科目名、指令顺序）
+    std::vector<std::string> getAudioFiles() const;
+    // 组合指令用到的片段（去重），预解码后放入片段缓存
+    std::vector<std::string> getSequenceClips() const;
 
     std::wstring getCurrentConfigPath() const { return m_currentConfigPath; }
 
+    int getPrefetchSeconds() const { return m_prefetchSeconds; }
+    int getAssetPoolMegabytes() const { return m_assetPoolMegabytes; }
+    const std::string& getAssetPoolMode() const { return m_assetPoolMode; }
+    int getLoudnessTarget() const { return m_loudnessTarget; }
+    bool getTrimLeadingSilence() const { return m_trimLeadingSilence; }
+    const std::vector<std::string>& getOutputDevices() const { return m_outputDevices; }
+    const std::string& getAudioMirror() const { return m_audioMirror; }
+    const std::string& getAudioMirrorDir() const { return m_audioMirrorDir; }  // UTF-8，空为默认位置
+    const std::vector<std::string>& getBackupOutputDevices() const { return m_backupOutputDevices; }
+    // 音频提前中断时接着播的备用目录（UTF-8，空为不设）
+    const std::string& getBackupAudioDir() const { return m_backupAudioDir; }
+    // 按输出设备报告的延迟 + 混音排队量提前起播
+    bool getLatencyCompensation() const { return m_latencyCompensation; }
+
 private:
     std::wstring getDefaultConfigPath() const;
 
@@ -44,6 +96,8 @@ private:
     ConfigManager& operator=(const ConfigManager&) = delete;
 
     bool parseConfigLine(const std::string& line, std::string& key, std::string& value);
+    void parseSettingLine(const std::string& key, const std::string& value);
+    void parseDeviceList(const std::string& key, const std::string& value, std::vector<std::string>& devices);
     bool parseInstructionLine(const std::string& timeKey, const std::string& config,
                              InstructionTemplate& instruction);
     std::string trim(const std::string& str);
@@ -51,4 +105,15 @@ private:
 private:
     std::wstring m_currentConfigPath;
     std::map<std::string, SubjectFullConfig> m_subjectConfigs;
+    int m_prefetchSeconds = kDefaultPrefetchSeconds;
+    int m_assetPoolMegabytes = kDefaultAssetPoolMegabytes;
+    std::string m_assetPoolMode = kDefaultAssetPoolMode;
+    int m_loudnessTarget = kDefaultLoudnessTarget;
+    bool m_trimLeadingSilence = kDefaultTrimLeadingSilence;
+    std::vector<std::string> m_outputDevices;
+    std::string m_audioMirror = kDefaultAudioMirror;
+    std::string m_audioMirrorDir;
+    std::vector<std::string> m_backupOutputDevices;
+    std::string m_backupAudioDir;
+    bool m_latencyCompensation = kDefaultLatencyCompensation;
 };
\ No newline at end of file
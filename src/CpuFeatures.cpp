@@ -0,0 +1,85 @@
+#include "CpuFeatures.h"
+
+#if defined(EVCS_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+#ifdef EVCS_X86
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;  // 系统未启用 YMM 状态保存
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpuHasSse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return false;
+#endif
+}
+#endif  // EVCS_X86
+}  // namespace
+
+bool CpuFeatures::supports(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SCALAR:
+        return true;
+#ifdef EVCS_X86
+    case SimdLevel::SSE2: {
+        static const bool sse2 = cpuHasSse2();
+        return sse2;
+    }
+    case SimdLevel::AVX2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+SimdLevel CpuFeatures::best() {
+    static const SimdLevel best = supports(SimdLevel::AVX2)   ? SimdLevel::AVX2
+                                  : supports(SimdLevel::SSE2) ? SimdLevel::SSE2
+                                                              : SimdLevel::SCALAR;
+    return best;
+}
+
+const char* CpuFeatures::name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE2:
+        return "sse2";
+    case SimdLevel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+// x86 上按函数开启指令集：GCC/Clang 用 target 属性，其余代码仍按基线编译；MSVC 无需标注。
+// 使用 SIMD 内核的源文件在 EVCS_X86 下包含 <immintrin.h>，运行时经 CpuFeatures 选择内核
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define EVCS_X86 1
+#endif
+
+#if defined(EVCS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define EVCS_TARGET_SSE2 __attribute__((target("sse2")))
+#define EVCS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define EVCS_TARGET_SSE2
+#define EVCS_TARGET_AVX2
+#endif
+
+// SIMD 内核级别。SSE2/AVX2 仅在 x86 上可用
+enum class SimdLevel : uint8_t { SCALAR, SSE2, AVX2 };
+
+// 运行时 CPU 特性检测（结果缓存，可在任意线程调用）
+class CpuFeatures {
+public:
+    // 当前 CPU 与操作系统是否支持该级别（AVX2 还要求系统启用 YMM 状态保存）
+    static bool supports(SimdLevel level);
+    // 支持的最高级别
+    static SimdLevel best();
+    // "scalar" / "sse2" / "avx2"
+    static const char* name(SimdLevel level);
+};
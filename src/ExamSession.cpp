@@ -0,0 +1,361 @@
+#include "ExamSession.h"
+#include <algorithm>
+
+using namespace std::chrono;
+
+namespace {
+int64_t toMilliseconds(system_clock::time_point timePoint) {
+    return duration_cast<milliseconds>(timePoint.time_since_epoch()).count();
+}
+}  // namespace
+
+ExamSession::ExamSession(Clock& clock, AudioSink& sink)
+    : m_clock(clock), m_sink(sink) {}
+
+bool ExamSession::isPlayingIndexValid() const {
+    return m_currentPlayingIndex >= 0 &&
+           static_cast<size_t>(m_currentPlayingIndex) < m_instructions.size();
+}
+
+void ExamSession::notify(SessionEventType type, int index, bool isManualPlay) {
+    if (type != SessionEventType::COMPLETED) {
+        m_latency.noteProgress(m_instructions.subjectId(index));
+    }
+    if (m_listener) {
+        m_listener->onSessionEvent(SessionEvent{type, index, isManualPlay, m_clock.now()});
+    }
+}
+
+bool ExamSession::isExpired(size_t index, system_clock::time_point now) const {
+    if (m_instructions.chained(index)) {
+        return false;  // 接续指令没有到点时刻，随所接的指令处理
+    }
+    // 按毫秒比较，与配置偏移精度一致
+    auto nowTimestamp = toMilliseconds(now);
+    auto instructionTimestamp = m_instructions.playTimeMilliseconds(index);
+    return instructionTimestamp < nowTimestamp &&
+           (nowTimestamp - instructionTimestamp) > duration_cast<milliseconds>(EXPIRY_WINDOW).count();
+}
+
+void ExamSession::sortByPlayTime() {
+    // 稳定排序并同步重映射当前播放下标（同一时刻的指令保持配置顺序）
+    auto order = m_instructions.stableOrderByPlayTime();
+    int newPlayingIndex = -1;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (static_cast<int>(order[i]) == m_currentPlayingIndex) {
+            newPlayingIndex = static_cast<int>(i);
+            break;
+        }
+    }
+    m_instructions.gather(order);
+    m_currentPlayingIndex = newPlayingIndex;
+}
+
+void ExamSession::addSubject(const Subject& subject) {
+    addInstructions(Instruction::generateInstructions(subject));
+}
+
+void ExamSession::addInstructions(const std::vector<Instruction>& instructions) {
+    m_instructions.append(instructions);
+    // 归并排序：后添加但更早开考的科目不会排在前一科目之后而被判过期
+    sortByPlayTime();
+    setNextInstruction();
+}
+
+void ExamSession::removeSubject(int subjectId) {
+    if (isPlayingIndexValid() && m_instructions.subjectId(m_currentPlayingIndex) == subjectId) {
+        stopPlayback();
+    }
+
+    std::vector<size_t> remaining;
+    remaining.reserve(m_instructions.size());
+    int newPlayingIndex = -1;
+    for (size_t i = 0; i < m_instructions.size(); ++i) {
+        if (m_instructions.subjectId(i) == subjectId) {
+            continue;
+        }
+        if (static_cast<int>(i) == m_currentPlayingIndex) {
+            newPlayingIndex = static_cast<int>(remaining.size());
+        }
+        remaining.push_back(i);
+    }
+    m_instructions.gather(remaining);
+    m_currentPlayingIndex = newPlayingIndex;
+    setNextInstruction();
+}
+
+void ExamSession::regenerate(const std::vector<Subject>& subjects) {
+    std::vector<Instruction> instructions;
+    for (const auto& subject : subjects) {
+        auto generated = Instruction::generateInstructions(subject);
+        instructions.insert(instructions.end(), generated.begin(), generated.end());
+    }
+    regenerate(instructions);
+}
+
+void ExamSession::regenerate(const std::vector<Instruction>& instructions) {
+    if (m_currentPlayingIndex >= 0) {
+        m_sink.stop();
+    }
+
+    m_instructions.clear();
+    m_instructions.append(instructions);
+
+    m_currentPlayingIndex = -1;
+    m_nextInstructionIndex = -1;
+    sortByPlayTime();
+    setNextInstruction();
+}
+
+size_t ExamSession::applyDurations(const std::map<std::string, double>& durations) {
+    return m_instructions.fillDurations([&durations](const std::string& audioFile) {
+        auto it = durations.find(audioFile);
+        return it != durations.end() ? it->second : 0.0;
+    });
+}
+
+bool ExamSession::checkPlaybackCompletion() {
+    m_latency.resolvePending(m_sink, m_clock.now());
+    if (!isPlayingIndexValid()) {
+        return false;
+    }
+
+    if (m_instructions.status(m_currentPlayingIndex) != PlaybackStatus::PLAYING) {
+        return false;
+    }
+
+    // 基于输出端活跃状态判断播放是否结束（与真实音频输出严格对齐）
+    if (m_sink.isPlaying()) {
+        return false;
+    }
+
+    int completedIndex = m_currentPlayingIndex;
+    m_instructions.setStatus(completedIndex, PlaybackStatus::PLAYED);
+    m_currentPlayingIndex = -1;
+    setNextInstruction();
+    notify(SessionEventType::COMPLETED, completedIndex, false);
+    playChainedFollower(completedIndex);
+    return true;
+}
+
+bool ExamSession::isChainPending() const {
+    if (!isPlayingIndexValid() || m_instructions.status(m_currentPlayingIndex) != PlaybackStatus::PLAYING) {
+        return false;
+    }
+    int follower = m_instructions.chainedFollower(m_currentPlayingIndex);
+    return follower != InstructionTable::NPOS && m_instructions.status(follower) == PlaybackStatus::UNPLAYED;
+}
+
+void ExamSession::playChainedFollower(int index) {
+    int follower = m_instructions.chainedFollower(index);
+    if (follower == InstructionTable::NPOS || m_instructions.status(follower) != PlaybackStatus::UNPLAYED) {
+        return;
+    }
+    // 计划时刻取上一条实际出声 + 时长（即它真正播完的时刻），起播延迟即交接间隙；
+    // 上一条出声时刻或时长未知时取当前时刻
+    auto scheduled = m_clock.now();
+    const double seconds = m_instructions.cachedDurationSeconds(index);
+    if (m_currentSample < m_latency.samples().size() && seconds > 0.0) {
+        const OnsetSample& previous = m_latency.samples()[m_currentSample];
+        if (previous.audibleKnown) {
+            scheduled = previous.audible + duration_cast<system_clock::duration>(duration<double>(seconds));
+        }
+    }
+    startInstruction(follower, false, scheduled);
+}
+
+void ExamSession::skipChainedFollowers(int index, SessionEventType type) {
+    for (int follower = m_instructions.chainedFollower(index);
+         follower != InstructionTable::NPOS && m_instructions.status(follower) == PlaybackStatus::UNPLAYED;
+         follower = m_instructions.chainedFollower(follower)) {
+        m_instructions.setStatus(follower, PlaybackStatus::SKIPPED);
+        notify(type, follower, false);
+    }
+}
+
+bool ExamSession::isWaitingForPlayback() const {
+    // 单路输出：当前有指令正在播放时，等待播放完成；混音输出到点即播，上一条转入后台
+    return !m_sink.supportsOverlap() && isPlayingIndexValid() &&
+           m_instructions.status(m_currentPlayingIndex) == PlaybackStatus::PLAYING;
+}
+
+bool ExamSession::updateNextInstruction() {
+    if (isWaitingForPlayback()) {
+        return false;
+    }
+
+    // 标记过期超过 60 秒的指令为跳过
+    m_changedRows.clear();
+    bool changed = m_instructions.skipExpired(toMilliseconds(m_clock.now()),
+                                              duration_cast<milliseconds>(EXPIRY_WINDOW).count(),
+                                              &m_changedRows) > 0;
+    for (int index : m_changedRows) {
+        notify(SessionEventType::EXPIRED, index, false);
+        skipChainedFollowers(index, SessionEventType::EXPIRED);
+    }
+
+    if (m_nextInstructionIndex < 0 ||
+        static_cast<size_t>(m_nextInstructionIndex) >= m_instructions.size() ||
+        m_instructions.status(m_nextInstructionIndex) != PlaybackStatus::UNPLAYED) {
+        setNextInstruction();
+    }
+
+    if (m_nextInstructionIndex >= 0 && isTimeToPlayNextInstruction()) {
+        playInstruction(m_nextInstructionIndex, false);
+        changed = true;
+    }
+    return changed;
+}
+
+ExamSession::PlayResult ExamSession::playInstruction(int index, bool isManualPlay) {
+    if (index < 0 || static_cast<size_t>(index) >= m_instructions.size()) {
+        return PlayResult::INVALID;
+    }
+    return startInstruction(index, isManualPlay, m_instructions.playTime(index));
+}
+
+ExamSession::PlayResult ExamSession::startInstruction(int index, bool isManualPlay, system_clock::time_point scheduled) {
+    // 过期检查（仅自动播放）
+    const auto fired = m_clock.now();
+    if (!isManualPlay && isExpired(index, fired)) {
+        m_instructions.setStatus(index, PlaybackStatus::SKIPPED);
+        setNextInstruction();
+        notify(SessionEventType::EXPIRED, index, false);
+        skipChainedFollowers(index, SessionEventType::EXPIRED);
+        return PlayResult::EXPIRED;
+    }
+
+    if (isManualPlay) {
+        markPreviousAsSkipped(index);
+    }
+
+    // 之前在播放的指令置为已播放。仍在播放就被打断的，其接续指令不再接在新指令之上播放
+    if (isPlayingIndexValid()) {
+        const int previous = m_currentPlayingIndex;
+        const bool interrupted = m_instructions.status(previous) == PlaybackStatus::PLAYING;
+        m_instructions.setStatus(previous, PlaybackStatus::PLAYED);
+        if (interrupted && m_instructions.chainedFollower(previous) != index) {
+            skipChainedFollowers(previous, SessionEventType::SKIPPED);
+        }
+    }
+
+    // 上一路的出声时刻须在本次 play() 之前取到，之后输出端只报告新的一路
+    m_latency.resolvePending(m_sink, fired);
+    m_latency.abandonPending();
+
+    // 先尝试播放音频文件
+    if (!m_sink.play(m_instructions.audioFile(index))) {
+        // 播放失败：标记已播放，不进入 PLAYING
+        m_instructions.setStatus(index, PlaybackStatus::PLAYED);
+        m_currentPlayingIndex = -1;
+        setNextInstruction();
+        notify(SessionEventType::PLAY_FAILED, index, isManualPlay);
+        // 播放失败也算「播完」：接续指令立即起播，不因一个坏文件整串落空
+        m_currentSample = SIZE_MAX;
+        playChainedFollower(index);
+        return PlayResult::FAILED;
+    }
+
+    // 播放成功：从当前播放流直接取时长（避免再开一路流），进入 PLAYING
+    m_instructions.setCachedDurationSeconds(index, m_sink.getCurrentStreamDuration());
+    m_instructions.setStatus(index, PlaybackStatus::PLAYING);
+    m_currentPlayingIndex = index;
+    m_currentPlayingStartTime = m_clock.now();
+
+    OnsetSample sample;
+    sample.subjectId = m_instructions.subjectId(index);
+    sample.subjectName = m_instructions.subjectName(index);
+    sample.instructionName = m_instructions.name(index);
+    sample.audioFile = m_instructions.audioFile(index);
+    sample.manual = isManualPlay;
+    sample.chained = m_instructions.chained(index) && !isManualPlay;
+    sample.scheduled = scheduled;
+    if (!sample.manual && !sample.chained) {
+        sample.compensationMs = duration<double, std::milli>(getStartLead()).count();
+    }
+    sample.fired = fired;
+    sample.created = m_currentPlayingStartTime;
+    m_latency.recordPlay(std::move(sample), m_sink.measuresOnset());
+    m_latency.resolvePending(m_sink, m_currentPlayingStartTime);
+    m_currentSample = m_latency.samples().size() - 1;
+
+    // 立即指向下一条：混音输出不等本条播完，到点就要能布防下一条。
+    // 接续指令排在所接指令旁边，其前后的按时刻指令须从头找
+    m_nextInstructionIndex = m_instructions.chained(index) ? findNextUnplayedInstruction()
+                                                           : findNextUnplayedInstructionAfter(index);
+    notify(SessionEventType::PLAYED, index, isManualPlay);
+
+    // 有接续指令：现在就向输出端预约，本条播完的那一刻接上（不支持预约的输出端在完成检测后再起播）
+    int follower = m_instructions.chainedFollower(index);
+    if (follower != InstructionTable::NPOS && m_instructions.status(follower) == PlaybackStatus::UNPLAYED) {
+        m_sink.queue(m_instructions.audioFile(follower));
+    }
+    return PlayResult::PLAYED;
+}
+
+void ExamSession::stopPlayback() {
+    m_sink.stop();
+    if (isPlayingIndexValid() &&
+        m_instructions.status(m_currentPlayingIndex) == PlaybackStatus::PLAYING) {
+        m_instructions.setStatus(m_currentPlayingIndex, PlaybackStatus::PLAYED);
+        skipChainedFollowers(m_currentPlayingIndex, SessionEventType::SKIPPED);
+    }
+    m_currentPlayingIndex = -1;
+}
+
+void ExamSession::markPreviousAsSkipped(int playIndex) {
+    m_changedRows.clear();
+    m_instructions.skipUnplayedBefore(static_cast<size_t>(std::max(playIndex, 0)), &m_changedRows);
+    for (int index : m_changedRows) {
+        notify(SessionEventType::SKIPPED, index, true);
+    }
+}
+
+void ExamSession::setNextInstruction() {
+    m_nextInstructionIndex = findNextUnplayedInstruction();
+}
+
+// 「下一条」只指按时刻播放的指令：接续指令由所接指令播完触发
+int ExamSession::findNextUnplayedInstruction() const {
+    return m_instructions.findFirstScheduled();
+}
+
+int ExamSession::findNextUnplayedInstructionAfter(int index) const {
+    return m_instructions.findFirstScheduled(static_cast<size_t>(index) + 1);
+}
+
+bool ExamSession::isTimeToPlayNextInstruction() const {
+    if (m_nextInstructionIndex < 0 ||
+        static_cast<size_t>(m_nextInstructionIndex) >= m_instructions.size()) {
+        return false;
+    }
+
+    if (m_instructions.status(m_nextInstructionIndex) != PlaybackStatus::UNPLAYED) {
+        return false;
+    }
+
+    auto now = m_clock.now();
+    if (isExpired(m_nextInstructionIndex, now)) {
+        return false;
+    }
+
+    return m_instructions.playTimeMilliseconds(m_nextInstructionIndex) <= toMilliseconds(now + getStartLead());
+}
+
+system_clock::time_point ExamSession::getNextDueTime() const {
+    if (isWaitingForPlayback()) {
+        return system_clock::time_point::max();
+    }
+    if (m_nextInstructionIndex >= 0 &&
+        static_cast<size_t>(m_nextInstructionIndex) < m_instructions.size() &&
+        m_instructions.status(m_nextInstructionIndex) == PlaybackStatus::UNPLAYED) {
+        return m_instructions.playTime(m_nextInstructionIndex) - getStartLead();
+    }
+    return system_clock::time_point::max();
+}
+
+system_clock::duration ExamSession::getStartLead() const {
+    const double leadMs = std::clamp(m_sink.getOutputLatencyMs(), 0.0,
+                                     static_cast<double>(MAX_START_LEAD.count()));
+    return duration_cast<system_clock::duration>(duration<double, std::milli>(leadMs));
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "AudioSink.h"
+#include "Clock.h"
+#include "Instruction.h"
+#include "InstructionTable.h"
+#include "OnsetLatency.h"
+#include "Subject.h"
+
+// 会话事件：每一次播放/跳过/过期决策都会通知监听者（界面刷新、日志、模拟器报告）
+enum class SessionEventType {
+    PLAYED,        // 开始播放
+    PLAY_FAILED,   // 播放失败（文件缺失/解码失败），指令记为已播放
+    SKIPPED,       // 手动播放后续指令时被跳过；所接指令被停止或被新指令打断时，接续指令随之跳过
+    EXPIRED,       // 迟到超过 EXPIRY_WINDOW 被跳过
+    COMPLETED      // 播放完成
+};
+
+struct SessionEvent {
+    SessionEventType type;
+    int index;                                   // 指令在 getInstructions() 中的行号
+    bool isManualPlay;
+    std::chrono::system_clock::time_point time;  // 决策时刻（Clock::now()）
+};
+
+class ExamSessionListener {
+public:
+    virtual ~ExamSessionListener() = default;
+    virtual void onSessionEvent(const SessionEvent& event) = 0;
+};
+
+// 考试会话：持有指令列表与播放状态，封装全部播放决策（原 MainWindow 内逻辑）。
+// 时间只经由注入的 Clock 读取，音频只经由注入的 AudioSink 输出，
+// 因此可在无界面、无声卡的环境中以虚拟时间完整回放。
+//
+// 接续指令（Instruction::chained）不按时刻到点：所接的指令起播时即向输出端预约接续（AudioSink::queue），
+// 检测到它播完（或播放失败）时立即播放，支持预约的输出端在同一采样处已经接上。
+// 接续指令不单独过期：所接指令过期/被跳过/被停止/被新指令打断时一并跳过。
+// 按时刻播放的指令提前输出端的输出延迟（AudioSink::getOutputLatencyMs）起播，首帧落在 playTime 上。
+// 非线程安全：由拥有者线程独占调用。
+class ExamSession {
+public:
+    // 自动播放的过期阈值：迟到超过该值的指令直接跳过
+    static constexpr std::chrono::seconds EXPIRY_WINDOW{60};
+    // 提前起播量的上限：输出端报告的延迟超出时按此截断
+    static constexpr std::chrono::milliseconds MAX_START_LEAD{500};
+
+    enum class PlayResult {
+        PLAYED,
+        EXPIRED,
+        FAILED,
+        INVALID
+    };
+
+    ExamSession(Clock& clock, AudioSink& sink);
+
+    void setListener(ExamSessionListener* listener) { m_listener = listener; }
+    Clock& getClock() const { return m_clock; }
+
+    // 列式指令表（按播放时间排序）
+    const InstructionTable& getInstructions() const { return m_instructions; }
+    int getCurrentPlayingIndex() const { return m_currentPlayingIndex; }
+    int getNextInstructionIndex() const { return m_nextInstructionIndex; }
+    std::chrono::system_clock::time_point getCurrentPlayingStartTime() const {
+        return m_currentPlayingStartTime;
+    }
+    // 每次起播的计划/决策/建流/出声时刻（配置重载后保留，便于全天汇总）
+    OnsetLatencyRecorder& getLatency() { return m_latency; }
+    const OnsetLatencyRecorder& getLatency() const { return m_latency; }
+
+    // 科目增删：按播放时间归并，正在播放的指令保持不变
+    void addSubject(const Subject& subject);
+    void removeSubject(int subjectId);
+    // 配置重载后全量重建：停止当前播放并重置全部状态
+    void regenerate(const std::vector<Subject>& subjects);
+    // 同上，但指令已在调用方生成（播放线程不读配置单例，由界面线程生成后移交）
+    void addInstructions(const std::vector<Instruction>& instructions);
+    void regenerate(const std::vector<Instruction>& instructions);
+    // 按文件名填写已知音频时长（元数据缓存），播放前即可显示时长、检查重叠。返回填写的行数
+    size_t applyDurations(const std::map<std::string, double>& durations);
+
+    // 周期/到点驱动：先检测播放完成，再做过期判定与自动播放。返回状态是否变化
+    bool checkPlaybackCompletion();
+    bool updateNextInstruction();
+
+    PlayResult playInstruction(int index, bool isManualPlay);
+    void stopPlayback();
+
+    void setNextInstruction();
+    int findNextUnplayedInstruction() const;
+    int findNextUnplayedInstructionAfter(int index) const;
+    bool isTimeToPlayNextInstruction() const;
+    // 当前播放的指令之后有等它播完的接续指令
+    bool isChainPending() const;
+
+    // 下一次需要驱动的时间点：单路输出且有指令在播放时返回 time_point::max()（等完成检测），
+    // 否则为下一条未播放指令的 playTime 减去提前起播量
+    std::chrono::system_clock::time_point getNextDueTime() const;
+    // 提前起播量：输出端当前的输出延迟，截断到 [0, MAX_START_LEAD]
+    std::chrono::system_clock::duration getStartLead() const;
+
+private:
+    bool isExpired(size_t index, std::chrono::system_clock::time_point now) const;
+    bool isPlayingIndexValid() const;
+    bool isWaitingForPlayback() const;
+    PlayResult startInstruction(int index, bool isManualPlay, std::chrono::system_clock::time_point scheduled);
+    void playChainedFollower(int index);
+    void skipChainedFollowers(int index, SessionEventType type);
+    void markPreviousAsSkipped(int playIndex);
+    void sortByPlayTime();
+    void notify(SessionEventType type, int index, bool isManualPlay);
+
+    Clock& m_clock;
+    AudioSink& m_sink;
+    ExamSessionListener* m_listener = nullptr;
+
+    InstructionTable m_instructions;
+    std::vector<int> m_changedRows;  // 批量状态变更的行号（复用缓冲，避免每次分配）
+    int m_currentPlayingIndex = -1;  // 当前播放的指令索引，-1 表示无
+    int m_nextInstructionIndex = -1; // 下一个要播放的指令索引，-1 表示无
+    std::chrono::system_clock::time_point m_currentPlayingStartTime;
+    size_t m_currentSample = SIZE_MAX;  // 当前播放的指令在 m_latency 中的样本下标
+    OnsetLatencyRecorder m_latency;
+};
@@ -0,0 +1,163 @@
+#include "FanOutOutput.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr size_t kChannels = 2;
+constexpr size_t kSilenceFrames = 1024;
+constexpr double kWindowSeconds = 0.1;
+constexpr double kLostSeconds = 2.0;
+constexpr int64_t kResyncFactor = 8;
+
+size_t maxLatency(const std::vector<FanOutDevice>& devices) {
+    size_t latency = 0;
+    for (const auto& device : devices) {
+        latency = std::max(latency, device.latencyFrames);
+    }
+    return latency;
+}
+}  // namespace
+
+FanOutOutput::FanOutOutput(std::vector<FanOutDevice> devices, uint32_t sampleRate, size_t driftToleranceFrames)
+    : m_count(devices.size()),
+      m_devices(new DeviceState[devices.size()]),
+      m_maxLatency(maxLatency(devices)),
+      m_tolerance(static_cast<int64_t>(std::max<size_t>(driftToleranceFrames, 1))),
+      m_resyncFrames(m_tolerance * kResyncFactor),
+      m_lostFrames(static_cast<int64_t>(sampleRate * kLostSeconds)),
+      m_windowFrames(std::max<uint64_t>(static_cast<uint64_t>(sampleRate * kWindowSeconds), 1)) {
+    for (size_t i = 0; i < m_count; ++i) {
+        m_devices[i].device = std::move(devices[i]);
+    }
+}
+
+int64_t FanOutOutput::totalDelay(DeviceState& state) {
+    return static_cast<int64_t>(state.device.output->queuedFrames()) +
+           static_cast<int64_t>(state.device.latencyFrames);
+}
+
+size_t FanOutOutput::queuedFrames() {
+    int64_t least = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < m_count; ++i) {
+        DeviceState& state = m_devices[i];
+        if (!state.lost.load(std::memory_order_relaxed)) {
+            least = std::min(least, totalDelay(state) - static_cast<int64_t>(m_maxLatency));
+        }
+    }
+    return least > 0 && least != std::numeric_limits<int64_t>::max() ? static_cast<size_t>(least) : 0;
+}
+
+void FanOutOutput::markLost(DeviceState& state) {
+    size_t healthy = 0;
+    for (size_t i = 0; i < m_count; ++i) {
+        healthy += m_devices[i].lost.load(std::memory_order_relaxed) ? 0 : 1;
+    }
+    if (healthy > 1) {
+        state.lost.store(true, std::memory_order_relaxed);
+    }
+}
+
+// 首次写入前：按各设备当前的 排队量 + 延迟 补静音，对齐到总延迟最大的设备
+void FanOutOutput::compensate() {
+    static const float kSilence[kSilenceFrames * kChannels] = {};
+    int64_t longest = 0;
+    for (size_t i = 0; i < m_count; ++i) {
+        m_devices[i].windowMin = totalDelay(m_devices[i]);
+        longest = std::max(longest, m_devices[i].windowMin);
+    }
+    for (size_t i = 0; i < m_count; ++i) {
+        DeviceState& state = m_devices[i];
+        size_t remaining = static_cast<size_t>(longest - state.windowMin);
+        state.compensationFrames.store(remaining, std::memory_order_relaxed);
+        while (remaining > 0) {
+            size_t count = std::min(remaining, kSilenceFrames);
+            if (!state.device.output->write(kSilence, count)) {
+                state.failedWrites.fetch_add(1, std::memory_order_relaxed);
+                markLost(state);
+                break;
+            }
+            remaining -= count;
+        }
+    }
+}
+
+// 测量窗结束：超前量 = 窗内最小总延迟 - 各设备中的最小值，超出容差的设备排上丢帧。
+// 每个窗重新计算待丢帧数（不累加）：窗内已丢的帧已反映在最小值里
+void FanOutOutput::endWindow() {
+    int64_t least = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < m_count; ++i) {
+        if (!m_devices[i].lost.load(std::memory_order_relaxed)) {
+            least = std::min(least, m_devices[i].windowMin);
+        }
+    }
+    for (size_t i = 0; i < m_count; ++i) {
+        DeviceState& state = m_devices[i];
+        if (state.lost.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        const int64_t skew = state.windowMin - least;
+        state.skew.store(skew, std::memory_order_relaxed);
+        if (skew > state.maxSkew.load(std::memory_order_relaxed)) {
+            state.maxSkew.store(skew, std::memory_order_relaxed);
+        }
+        if (skew > m_lostFrames) {
+            markLost(state);
+            continue;
+        }
+        // 丢到容差的一半，避免在容差边缘来回触发
+        state.pendingDrops = skew > m_tolerance ? skew - m_tolerance / 2 : 0;
+    }
+}
+
+bool FanOutOutput::write(const float* samples, size_t frames) {
+    if (!m_started) {
+        compensate();
+        m_started = true;
+    }
+    bool written = false;
+    for (size_t i = 0; i < m_count; ++i) {
+        DeviceState& state = m_devices[i];
+        if (state.lost.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        const int64_t delay = totalDelay(state);
+        state.windowMin = m_windowWritten == 0 ? delay : std::min(state.windowMin, delay);
+        size_t drop = 0;
+        if (state.pendingDrops > 0 && frames > 1) {
+            const int64_t step = state.pendingDrops > m_resyncFrames ? static_cast<int64_t>(frames / 4) : 1;
+            drop = static_cast<size_t>(std::min(state.pendingDrops, std::max<int64_t>(step, 1)));
+            state.pendingDrops -= static_cast<int64_t>(drop);
+            state.dropped.fetch_add(drop, std::memory_order_relaxed);
+        }
+        if (state.device.output->write(samples + drop * kChannels, frames - drop)) {
+            written = true;
+        } else {
+            state.failedWrites.fetch_add(1, std::memory_order_relaxed);
+            markLost(state);
+        }
+    }
+    m_written.fetch_add(frames, std::memory_order_release);
+
+    m_windowWritten += frames;
+    if (m_windowWritten >= m_windowFrames) {
+        m_windowWritten = 0;
+        endWindow();
+    }
+    return written;
+}
+
+std::vector<OutputDeviceStats> FanOutOutput::getStats() const {
+    std::vector<OutputDeviceStats> stats(m_count);
+    for (size_t i = 0; i < m_count; ++i) {
+        const DeviceState& state = m_devices[i];
+        stats[i].name = state.device.name;
+        stats[i].latencyFrames = state.device.latencyFrames;
+        stats[i].compensationFrames = state.compensationFrames.load(std::memory_order_relaxed);
+        stats[i].skewFrames = state.skew.load(std::memory_order_relaxed);
+        stats[i].maxSkewFrames = state.maxSkew.load(std::memory_order_relaxed);
+        stats[i].droppedFrames = state.dropped.load(std::memory_order_relaxed);
+        stats[i].failedWrites = state.failedWrites.load(std::memory_order_relaxed);
+        stats[i].lost = state.lost.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AudioMixer.h"
+
+// 扇出中的一台输出设备
+struct FanOutDevice {
+    std::string name;
+    MixerOutput* output = nullptr;  // 由后端持有，生命周期长于扇出
+    size_t latencyFrames = 0;       // 排队之外的输出延迟（驱动与硬件缓冲），由后端测得
+};
+
+// 一台输出设备的对齐状态
+struct OutputDeviceStats {
+    std::string name;
+    size_t latencyFrames = 0;
+    size_t compensationFrames = 0;  // 首次写入前补的静音（对齐到总延迟最大的设备）
+    int64_t skewFrames = 0;         // 最近一个测量窗的超前量：本设备总延迟 - 各设备中最小的总延迟
+    int64_t maxSkewFrames = 0;      // 补偿前观察到的最大超前量
+    uint64_t droppedFrames = 0;     // 为追平时钟漂移丢弃的帧
+    uint64_t failedWrites = 0;
+    bool lost = false;              // 写入失败或长时间不取数据，已不再写入
+};
+
+// 多设备扇出：同一混音结果写到每台设备，同一声部的首帧在各设备上同时出声。
+//
+// 设备 i 上刚写入的一帧要过 排队量 q_i + 设备延迟 L_i 才听到。首次写入前给总延迟较小的设备补静音，
+// 此后各设备收到逐帧相同的数据，起播按采样对齐。各声卡晶振不同，长时间运行后 q_i + L_i 会慢慢拉开：
+// 每个测量窗（约 100ms）取各设备窗内的最小值（滤掉设备按周期取数造成的锯齿），超前量超过容差的设备
+// 在下一个窗内每块丢一帧追平；某台设备欠载后落后较多时一次丢得更多，尽快重新对齐。
+// 只丢不补：总延迟最小的设备即基准，各设备队列不会无限增长。
+//
+// 混音器按 queuedFrames() 补写：取各设备 q_i + L_i - max L 的最小值，即最缺数据的设备的提前量。
+// 写入失败或超前超过 2 秒（设备已不取数据）的设备不再写入，其余设备照常；最后一台设备不会被放弃。
+// 渲染路径上无锁、无堆分配；getStats() 可在任意线程调用
+class FanOutOutput : public MixerOutput {
+public:
+    FanOutOutput(std::vector<FanOutDevice> devices, uint32_t sampleRate, size_t driftToleranceFrames);
+
+    size_t queuedFrames() override;
+    bool write(const float* samples, size_t frames) override;
+
+    size_t deviceCount() const { return m_count; }
+    std::vector<OutputDeviceStats> getStats() const;
+    // 已写出的混音帧数（不含补偿静音，不扣丢帧）
+    const std::atomic<uint64_t>& writtenCounter() const { return m_written; }
+
+private:
+    struct DeviceState {
+        FanOutDevice device;
+        std::atomic<size_t> compensationFrames{0};
+        int64_t windowMin = 0;
+        int64_t pendingDrops = 0;
+        std::atomic<int64_t> skew{0};
+        std::atomic<int64_t> maxSkew{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> failedWrites{0};
+        std::atomic<bool> lost{false};
+    };
+
+    int64_t totalDelay(DeviceState& state);
+    void compensate();
+    void endWindow();
+    void markLost(DeviceState& state);
+
+    const size_t m_count;
+    std::unique_ptr<DeviceState[]> m_devices;
+    const size_t m_maxLatency;
+    const int64_t m_tolerance;
+    const int64_t m_resyncFrames;  // 超前量超过此值时按块的 1/4 丢帧
+    const int64_t m_lostFrames;
+    const uint64_t m_windowFrames;
+
+    // 渲染端私有
+    bool m_started = false;
+    uint64_t m_windowWritten = 0;
+    std::atomic<uint64_t> m_written{0};
+};
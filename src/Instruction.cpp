@@ -1,11 +1,13 @@
 #include "Instruction.h"
 #include "ConfigManager.h"
-#include "PathUtil.h"
+#include "ClipSequence.h"
+#include "Clock.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#ifdef _WIN32
 #include <windows.h>
-#include <filesystem>
+#endif
 
 std::vector<Instruction> Instruction::generateInstructions(const Subject& subject) {
     std::vector<Instruction> instructions;
@@ -18,8 +20,9 @@ std::vector<Instruction> Instruction::generateInstructions(const Subject& subjec
         instr.subjectId = subject.id;
         instr.subjectName = subject.name;
         instr.name = temp.name;  // UTF-8 直接使用，无需往返转换
-        instr.playTime = subject.startTime + std::chrono::seconds(temp.offsetSeconds);
+        instr.playTime = subject.startTime + std::chrono::milliseconds(temp.offsetMilliseconds);
         instr.audioFile = temp.audioFile;
+        instr.chained = temp.chained;
         instructions.push_back(instr);
     }
 
@@ -27,9 +30,12 @@ std::vector<Instruction> Instruction::generateInstructions(const Subject& subjec
 }
 
 std::string Instruction::getPlayDateTimeString() const {
+    return formatPlayDateTime(playTime);
+}
+
+std::string Instruction::formatPlayDateTime(std::chrono::system_clock::time_point playTime) {
     auto time = std::chrono::system_clock::to_time_t(playTime);
-    std::tm tm = {};
-    localtime_s(&tm, &time);
+    std::tm tm = toLocalTm(time);
     std::stringstream ss;
     ss << (tm.tm_year + 1900) << "-"
        << std::setfill('0') << std::setw(2) << (tm.tm_mon + 1) << "-"
@@ -39,12 +45,17 @@ std::string Instruction::getPlayDateTimeString() const {
     return ss.str();
 }
 
-// 实时检查音频文件是否存在（不使用缓存）
+// 实时检查音频文件是否存在（不使用缓存）。组合指令须每个片段都存在
 bool Instruction::checkAudioFileExists() const {
-    return std::filesystem::exists(PathUtil::getAudioPath(audioFile));
+    return ClipSequence::exists(audioFile);
 }
 
+#ifdef _WIN32
 COLORREF Instruction::getStatusTextColor() const {
+    return statusTextColor(status);
+}
+
+COLORREF Instruction::statusTextColor(PlaybackStatus status) {
     switch (status) {
         case PlaybackStatus::UNPLAYED:
             return RGB(0, 0, 0);        // 黑色
@@ -58,8 +69,13 @@ COLORREF Instruction::getStatusTextColor() const {
             return RGB(0, 0, 0);
     }
 }
+#endif
 
 std::string Instruction::getStatusString() const {
+    return statusString(status);
+}
+
+std::string Instruction::statusString(PlaybackStatus status) {
     switch (status) {
         case PlaybackStatus::UNPLAYED:
             return "未播放";
@@ -2,7 +2,9 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#ifdef _WIN32
 #include <windows.h>  // COLORREF
+#endif
 #include "Subject.h"
 #include <filesystem>
 
@@ -21,6 +23,9 @@ struct Instruction {
     std::chrono::system_clock::time_point playTime;
     std::string audioFile;
     PlaybackStatus status;
+    // 接续指令（配置中的 after:）：同一科目的上一条播完时立即播放，不按 playTime 到点。
+    // playTime 取所接指令的计划时刻，只用于排序
+    bool chained = false;
 
     // 缓存的音频时长（秒）。<=0 表示未取或取失败
     mutable double cachedDurationSeconds = 0.0;
@@ -31,6 +36,15 @@ struct Instruction {
     std::string getPlayDateTimeString() const;
     bool checkAudioFileExists() const;
 
+#ifdef _WIN32
     COLORREF getStatusTextColor() const;
+#endif
     std::string getStatusString() const;
+
+    // 按字段值格式化（列式指令表按列取值后直接调用，无需物化整行）
+    static std::string formatPlayDateTime(std::chrono::system_clock::time_point playTime);
+#ifdef _WIN32
+    static COLORREF statusTextColor(PlaybackStatus status);
+#endif
+    static std::string statusString(PlaybackStatus status);
 };
@@ -0,0 +1,273 @@
+#include "InstructionTable.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+using namespace std::chrono;
+
+namespace {
+constexpr uint8_t kUnplayed = static_cast<uint8_t>(PlaybackStatus::UNPLAYED);
+constexpr uint8_t kSkipped = static_cast<uint8_t>(PlaybackStatus::SKIPPED);
+
+int32_t clampToInt32(int64_t value) {
+    return static_cast<int32_t>(std::clamp<int64_t>(value, std::numeric_limits<int32_t>::min(),
+                                                    std::numeric_limits<int32_t>::max()));
+}
+
+template <typename T>
+void gatherColumn(std::vector<T>& column, const std::vector<size_t>& order) {
+    std::vector<T> gathered;
+    gathered.reserve(order.size());
+    for (size_t index : order) {
+        gathered.push_back(std::move(column[index]));
+    }
+    column = std::move(gathered);
+}
+}  // namespace
+
+uint32_t StringTable::intern(const std::string& value) {
+    auto it = m_ids.find(value);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(m_values.size());
+    m_values.push_back(value);
+    m_ids.emplace(value, id);
+    return id;
+}
+
+void StringTable::clear() {
+    m_values.clear();
+    m_ids.clear();
+}
+
+void InstructionTable::clear() {
+    m_strings.clear();
+    m_baseMilliseconds = 0;
+    m_playTimeOffsets.clear();
+    m_status.clear();
+    m_subjectIds.clear();
+    m_subjectNameIds.clear();
+    m_nameIds.clear();
+    m_audioFileIds.clear();
+    m_playTimes.clear();
+    m_cachedDurations.clear();
+    m_chained.clear();
+}
+
+void InstructionTable::append(const Instruction& instruction) {
+    int64_t playMilliseconds = duration_cast<milliseconds>(instruction.playTime.time_since_epoch()).count();
+    if (m_playTimeOffsets.empty()) {
+        m_baseMilliseconds = playMilliseconds;
+    }
+    m_playTimeOffsets.push_back(clampToInt32(playMilliseconds - m_baseMilliseconds));
+    m_status.push_back(static_cast<uint8_t>(instruction.status));
+    m_subjectIds.push_back(instruction.subjectId);
+    m_subjectNameIds.push_back(m_strings.intern(instruction.subjectName));
+    m_nameIds.push_back(m_strings.intern(instruction.name));
+    m_audioFileIds.push_back(m_strings.intern(instruction.audioFile));
+    m_playTimes.push_back(instruction.playTime);
+    m_cachedDurations.push_back(instruction.cachedDurationSeconds);
+    m_chained.push_back(instruction.chained ? 1 : 0);
+}
+
+void InstructionTable::append(const std::vector<Instruction>& instructions) {
+    for (const auto& instruction : instructions) {
+        append(instruction);
+    }
+}
+
+Instruction InstructionTable::row(size_t index) const {
+    Instruction instruction;
+    instruction.subjectId = m_subjectIds[index];
+    instruction.subjectName = subjectName(index);
+    instruction.name = name(index);
+    instruction.playTime = m_playTimes[index];
+    instruction.audioFile = audioFile(index);
+    instruction.status = status(index);
+    instruction.cachedDurationSeconds = m_cachedDurations[index];
+    instruction.chained = m_chained[index] != 0;
+    return instruction;
+}
+
+int64_t InstructionTable::playTimeMilliseconds(size_t index) const {
+    return duration_cast<milliseconds>(m_playTimes[index].time_since_epoch()).count();
+}
+
+int InstructionTable::findFirst(PlaybackStatus status, size_t from) const {
+    if (from >= m_status.size()) {
+        return NPOS;
+    }
+    const void* hit = std::memchr(m_status.data() + from, static_cast<uint8_t>(status),
+                                  m_status.size() - from);
+    if (!hit) {
+        return NPOS;
+    }
+    return static_cast<int>(static_cast<const uint8_t*>(hit) - m_status.data());
+}
+
+int InstructionTable::findFirstScheduled(size_t from) const {
+    int index = findFirst(PlaybackStatus::UNPLAYED, from);
+    while (index != NPOS && m_chained[index]) {
+        index = findFirst(PlaybackStatus::UNPLAYED, static_cast<size_t>(index) + 1);
+    }
+    return index;
+}
+
+int InstructionTable::chainedFollower(size_t index) const {
+    for (size_t i = index + 1; i < size(); ++i) {
+        if (m_subjectIds[i] == m_subjectIds[index]) {
+            return m_chained[i] ? static_cast<int>(i) : NPOS;
+        }
+    }
+    return NPOS;
+}
+
+int InstructionTable::chainPredecessor(size_t index) const {
+    if (!m_chained[index]) {
+        return NPOS;
+    }
+    for (size_t i = index; i-- > 0;) {
+        if (m_subjectIds[i] == m_subjectIds[index]) {
+            return static_cast<int>(i);
+        }
+    }
+    return NPOS;
+}
+
+InstructionTable::time_point InstructionTable::expectedStart(size_t index) const {
+    // 沿接续链回溯到按时刻播放的行，再依次累加各行时长
+    int predecessor = chainPredecessor(index);
+    if (predecessor == NPOS) {
+        return m_playTimes[index];
+    }
+    const double seconds = std::max(m_cachedDurations[predecessor], 0.0);
+    return expectedStart(static_cast<size_t>(predecessor)) +
+           duration_cast<time_point::duration>(duration<double>(seconds));
+}
+
+size_t InstructionTable::skipExpired(int64_t nowMilliseconds, int64_t windowMilliseconds,
+                                     std::vector<int>* changed) {
+    // window >= 0 时「迟到超过 window」已蕴含「playTime 早于 now」
+    // 即 playTime < now - window，换算到偏移坐标后做 32 位比较
+    windowMilliseconds = std::max<int64_t>(windowMilliseconds, 0);
+    const int64_t cutoff = nowMilliseconds - windowMilliseconds;
+    const int64_t rawThreshold = cutoff - m_baseMilliseconds;
+    const size_t count = m_status.size();
+    if (rawThreshold != clampToInt32(rawThreshold)) {
+        // 阈值超出偏移列范围（距首行逾 24 天）：按完整精度列逐行比较
+        size_t skipped = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (m_status[i] == kUnplayed && !m_chained[i] && playTimeMilliseconds(i) < cutoff) {
+                m_status[i] = kSkipped;
+                ++skipped;
+                if (changed) {
+                    changed->push_back(static_cast<int>(i));
+                }
+            }
+        }
+        return skipped;
+    }
+    const int32_t threshold = static_cast<int32_t>(rawThreshold);
+    const int32_t* offsets = m_playTimeOffsets.data();
+    uint8_t* status = m_status.data();
+    const uint8_t* chained = m_chained.data();
+
+    // 第一遍无分支计数（常见情况为 0，一遍结束），可向量化
+    uint32_t hits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        hits += static_cast<uint32_t>(offsets[i] < threshold) & static_cast<uint32_t>(status[i] == kUnplayed) &
+                static_cast<uint32_t>(chained[i] == 0);
+    }
+    if (hits == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (status[i] == kUnplayed && !chained[i] && offsets[i] < threshold) {
+            status[i] = kSkipped;
+            if (changed) {
+                changed->push_back(static_cast<int>(i));
+            }
+        }
+    }
+    return hits;
+}
+
+size_t InstructionTable::skipUnplayedBefore(size_t end, std::vector<int>* changed) {
+    end = std::min(end, m_status.size());
+    size_t skipped = 0;
+    for (int i = findFirst(PlaybackStatus::UNPLAYED); i != NPOS && static_cast<size_t>(i) < end;
+         i = findFirst(PlaybackStatus::UNPLAYED, static_cast<size_t>(i) + 1)) {
+        m_status[i] = kSkipped;
+        ++skipped;
+        if (changed) {
+            changed->push_back(i);
+        }
+    }
+    return skipped;
+}
+
+size_t InstructionTable::countMissingAudio(const std::function<bool(const std::string&)>& exists) const {
+    // 每个驻留字符串至多探测一次（只探测被用作音频文件的编号）
+    std::vector<uint8_t> probed(m_strings.size(), 0);
+    std::vector<uint8_t> missing(m_strings.size(), 0);
+    size_t missingRows = 0;
+    for (uint32_t id : m_audioFileIds) {
+        if (!probed[id]) {
+            probed[id] = 1;
+            missing[id] = exists(m_strings.get(id)) ? 0 : 1;
+        }
+        missingRows += missing[id];
+    }
+    return missingRows;
+}
+
+size_t InstructionTable::fillDurations(const std::function<double(const std::string&)>& lookup) {
+    std::vector<double> durations(m_strings.size(), -1.0);  // <0 表示尚未查询
+    size_t filled = 0;
+    for (size_t i = 0; i < m_audioFileIds.size(); ++i) {
+        uint32_t id = m_audioFileIds[i];
+        if (durations[id] < 0.0) {
+            durations[id] = std::max(lookup(m_strings.get(id)), 0.0);
+        }
+        if (durations[id] > 0.0) {
+            m_cachedDurations[i] = durations[id];
+            ++filled;
+        }
+    }
+    return filled;
+}
+
+bool InstructionTable::overlapsNext(size_t index) const {
+    if (index + 1 >= size() || m_cachedDurations[index] <= 0.0) {
+        return false;
+    }
+    if (chainPredecessor(index + 1) == static_cast<int>(index)) {
+        return false;
+    }
+    auto end = expectedStart(index) + duration_cast<time_point::duration>(duration<double>(m_cachedDurations[index]));
+    return end > expectedStart(index + 1);
+}
+
+void InstructionTable::gather(const std::vector<size_t>& order) {
+    gatherColumn(m_playTimeOffsets, order);
+    gatherColumn(m_status, order);
+    gatherColumn(m_subjectIds, order);
+    gatherColumn(m_subjectNameIds, order);
+    gatherColumn(m_nameIds, order);
+    gatherColumn(m_audioFileIds, order);
+    gatherColumn(m_playTimes, order);
+    gatherColumn(m_cachedDurations, order);
+    gatherColumn(m_chained, order);
+}
+
+std::vector<size_t> InstructionTable::stableOrderByPlayTime() const {
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return m_playTimes[a] < m_playTimes[b];
+    });
+    return order;
+}
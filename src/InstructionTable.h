@@ -0,0 +1,107 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Instruction.h"
+
+// 字符串驻留表：相同字符串只存一份，行内只存 32 位编号
+class StringTable {
+public:
+    uint32_t intern(const std::string& value);
+    const std::string& get(uint32_t id) const { return m_values[id]; }
+    size_t size() const { return m_values.size(); }
+    void clear();
+
+private:
+    std::vector<std::string> m_values;
+    std::unordered_map<std::string, uint32_t> m_ids;
+};
+
+// 列式（SoA）指令表：每个字段一段连续数组，状态压成字节，字符串换成驻留编号。
+// 过期扫描、找下一条未播放、手动播放跳过前序、缺失文件计数等全表遍历
+// 只触及需要的列，循环体无分支、可被编译器向量化。
+// 非线程安全：由 ExamSession 在拥有者线程上独占使用。
+class InstructionTable {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+    static constexpr int NPOS = -1;
+
+    size_t size() const { return m_status.size(); }
+    bool empty() const { return m_status.empty(); }
+    void clear();
+
+    void append(const Instruction& instruction);
+    void append(const std::vector<Instruction>& instructions);
+
+    // 物化一行（显示/调试用；热路径请直接读列）
+    Instruction row(size_t index) const;
+
+    int subjectId(size_t index) const { return m_subjectIds[index]; }
+    const std::string& subjectName(size_t index) const { return m_strings.get(m_subjectNameIds[index]); }
+    const std::string& name(size_t index) const { return m_strings.get(m_nameIds[index]); }
+    const std::string& audioFile(size_t index) const { return m_strings.get(m_audioFileIds[index]); }
+    time_point playTime(size_t index) const { return m_playTimes[index]; }
+    // 播放时间（自纪元起的毫秒），按完整精度列计算，不受偏移列饱和影响
+    int64_t playTimeMilliseconds(size_t index) const;
+    PlaybackStatus status(size_t index) const { return static_cast<PlaybackStatus>(m_status[index]); }
+    void setStatus(size_t index, PlaybackStatus status) { m_status[index] = static_cast<uint8_t>(status); }
+    double cachedDurationSeconds(size_t index) const { return m_cachedDurations[index]; }
+    void setCachedDurationSeconds(size_t index, double seconds) { m_cachedDurations[index] = seconds; }
+    bool chained(size_t index) const { return m_chained[index] != 0; }
+
+    // 从 from 起第一条处于 status 的行，没有返回 NPOS（memchr 扫状态字节）
+    int findFirst(PlaybackStatus status, size_t from = 0) const;
+    // 从 from 起第一条按时刻播放（非接续）的未播放行，没有返回 NPOS
+    int findFirstScheduled(size_t from = 0) const;
+
+    // 接续关系：同一科目中紧接在 index 之后的一行若是接续指令，返回其行号，否则 NPOS
+    int chainedFollower(size_t index) const;
+    // 接续指令所接的行（同一科目中排在它前面的最近一行），不是接续指令或找不到返回 NPOS
+    int chainPredecessor(size_t index) const;
+    // 预计开始时刻：按时刻播放的行即 playTime；接续指令为所接行的预计开始 + 已知时长（时长未知按 0 计）
+    time_point expectedStart(size_t index) const;
+
+    // 过期清扫：未播放且迟到超过 windowMilliseconds 的行置为 SKIPPED（毫秒精度）。
+    // 接续指令不按时刻过期（随所接的行一起处理），不在清扫之列。
+    // 被清扫的行号追加到 changed（可为空），返回清扫条数
+    size_t skipExpired(int64_t nowMilliseconds, int64_t windowMilliseconds, std::vector<int>* changed);
+
+    // 把 [0, end) 内未播放的行置为 SKIPPED，行号追加到 changed（可为空）
+    size_t skipUnplayedBefore(size_t end, std::vector<int>* changed);
+
+    // 缺失音频的行数：每个不同的文件名只探测一次，再按编号列计数
+    size_t countMissingAudio(const std::function<bool(const std::string&)>& exists) const;
+
+    // 按文件名填写时长列：每个不同的文件名只查一次，lookup 返回 <=0 的行保持原值。返回填写的行数
+    size_t fillDurations(const std::function<double(const std::string&)>& lookup);
+
+    // 该行按已知时长播完时，下一行（按播放时间排序）已经开始。时长未知返回 false。
+    // 接续指令按预计开始时刻计；紧接其后的接续指令本就在它播完时才开始，不算重叠
+    bool overlapsNext(size_t index) const;
+
+    // 按行号列表重排/筛选（order[i] 为新表第 i 行的旧行号）
+    void gather(const std::vector<size_t>& order);
+
+    // 按播放时间稳定排序的行号序列（同一时刻保持原顺序）
+    std::vector<size_t> stableOrderByPlayTime() const;
+
+private:
+    StringTable m_strings;
+
+    // 播放时间（毫秒）相对 m_baseMilliseconds 的偏移：32 位比较在 SSE2 基线即可向量化，
+    // 64 位有符号比较则要 SSE4.2。范围约 ±24 天，超出的行饱和存储，
+    // 饱和行的比较结论仍正确；仅当清扫阈值本身饱和时退回按完整精度列逐行比较
+    int64_t m_baseMilliseconds = 0;
+    std::vector<int32_t> m_playTimeOffsets;
+    std::vector<uint8_t> m_status;           // PlaybackStatus
+    std::vector<int32_t> m_subjectIds;
+    std::vector<uint32_t> m_subjectNameIds;
+    std::vector<uint32_t> m_nameIds;
+    std::vector<uint32_t> m_audioFileIds;
+    std::vector<time_point> m_playTimes;     // 完整精度，排序与显示用
+    std::vector<double> m_cachedDurations;
+    std::vector<uint8_t> m_chained;          // 接续指令标记
+};
@@ -0,0 +1,296 @@
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef EVCS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kChunkSteps = 16;  // 每次交给内核 1.6 秒（可被 SSE2 两段、AVX2 四段整除）
+
+using Kernel = void (*)(const float* samples, size_t steps, const LoudnessMeter::Params& params, double* energy,
+                        float& peak);
+
+// BS.1770-4 K 加权：按采样率由模拟原型重新设计（48kHz 时与标准给出的系数一致）
+void designKWeighting(uint32_t sampleRate, LoudnessMeter::Params& params) {
+    const double rate = static_cast<double>(sampleRate);
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(kPi * f0 / rate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        params.shelf[0] = static_cast<float>((vh + vb * k / q + k * k) / a0);
+        params.shelf[1] = static_cast<float>(2.0 * (k * k - vh) / a0);
+        params.shelf[2] = static_cast<float>((vh - vb * k / q + k * k) / a0);
+        params.shelf[3] = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+        params.shelf[4] = static_cast<float>((1.0 - k / q + k * k) / a0);
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(kPi * f0 / rate);
+        const double a0 = 1.0 + k / q + k * k;
+        params.highpass[0] = 1.0f;
+        params.highpass[1] = -2.0f;
+        params.highpass[2] = 1.0f;
+        params.highpass[3] = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+        params.highpass[4] = static_cast<float>((1.0 - k / q + k * k) / a0);
+    }
+}
+
+// 转置直接 II 型双二阶；SIMD 内核按同样的运算顺序逐通道计算
+inline float biquad(const float* c, float x, float& z1, float& z2) {
+    float y = c[0] * x + z1;
+    z1 = c[1] * x - c[3] * y + z2;
+    z2 = c[2] * x - c[4] * y;
+    return y;
+}
+
+// 逐采样：整段一个时间段，两声道各两级
+void kernelScalar(const float* samples, size_t steps, const LoudnessMeter::Params& params, double* energy,
+                  float& peak) {
+    float z[2][4] = {};
+    const float* in = samples - params.warmupFrames * 2;
+    for (size_t i = 0; i < params.warmupFrames; ++i, in += 2) {
+        for (int c = 0; c < 2; ++c) {
+            float y = biquad(params.shelf, in[c], z[c][0], z[c][1]);
+            biquad(params.highpass, y, z[c][2], z[c][3]);
+        }
+    }
+    for (size_t s = 0; s < steps; ++s) {
+        float acc[2] = {0.0f, 0.0f};
+        for (size_t i = 0; i < params.stepFrames; ++i, in += 2) {
+            for (int c = 0; c < 2; ++c) {
+                peak = std::max(peak, std::fabs(in[c]));
+                float y = biquad(params.shelf, in[c], z[c][0], z[c][1]);
+                y = biquad(params.highpass, y, z[c][2], z[c][3]);
+                acc[c] += y * y;
+            }
+        }
+        energy[s] = static_cast<double>(acc[0]) + static_cast<double>(acc[1]);
+    }
+}
+
+#ifdef EVCS_X86
+// 两个时间段 x 立体声 = 4 通道：[段0 L, 段0 R, 段1 L, 段1 R]
+EVCS_TARGET_SSE2 void kernelSse2(const float* samples, size_t steps, const LoudnessMeter::Params& params,
+                                 double* energy, float& peak) {
+    const size_t segmentSteps = steps / 2;
+    const size_t segmentFloats = segmentSteps * params.stepFrames * 2;
+    const float* p0 = samples - params.warmupFrames * 2;
+    const float* p1 = p0 + segmentFloats;
+
+    const __m128 sb0 = _mm_set1_ps(params.shelf[0]), sb1 = _mm_set1_ps(params.shelf[1]);
+    const __m128 sb2 = _mm_set1_ps(params.shelf[2]), sa1 = _mm_set1_ps(params.shelf[3]);
+    const __m128 sa2 = _mm_set1_ps(params.shelf[4]);
+    const __m128 hb0 = _mm_set1_ps(params.highpass[0]), hb1 = _mm_set1_ps(params.highpass[1]);
+    const __m128 hb2 = _mm_set1_ps(params.highpass[2]), ha1 = _mm_set1_ps(params.highpass[3]);
+    const __m128 ha2 = _mm_set1_ps(params.highpass[4]);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 z0 = _mm_setzero_ps(), z1 = _mm_setzero_ps(), z2 = _mm_setzero_ps(), z3 = _mm_setzero_ps();
+    __m128 peakv = _mm_setzero_ps();
+
+    // 第 0 轮为预热（不计能量），之后每轮一个 100ms 步长
+    for (size_t round = 0; round <= segmentSteps; ++round) {
+        const size_t frames = round == 0 ? params.warmupFrames : params.stepFrames;
+        __m128 acc = _mm_setzero_ps();
+        for (size_t i = 0; i < frames; ++i, p0 += 2, p1 += 2) {
+            __m128 x = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p0));
+            x = _mm_loadh_pi(x, reinterpret_cast<const __m64*>(p1));
+            __m128 y = _mm_add_ps(_mm_mul_ps(sb0, x), z0);
+            z0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(sb1, x), _mm_mul_ps(sa1, y)), z1);
+            z1 = _mm_sub_ps(_mm_mul_ps(sb2, x), _mm_mul_ps(sa2, y));
+            __m128 k = _mm_add_ps(_mm_mul_ps(hb0, y), z2);
+            z2 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(hb1, y), _mm_mul_ps(ha1, k)), z3);
+            z3 = _mm_sub_ps(_mm_mul_ps(hb2, y), _mm_mul_ps(ha2, k));
+            acc = _mm_add_ps(acc, _mm_mul_ps(k, k));
+            peakv = _mm_max_ps(peakv, _mm_and_ps(x, absMask));
+        }
+        if (round == 0) {
+            continue;  // 峰值按重读的前文取最大值不受影响
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc);
+        energy[round - 1] = static_cast<double>(lanes[0]) + static_cast<double>(lanes[1]);
+        energy[segmentSteps + round - 1] = static_cast<double>(lanes[2]) + static_cast<double>(lanes[3]);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, peakv);
+    peak = std::max({peak, lanes[0], lanes[1], lanes[2], lanes[3]});
+}
+
+// 四个时间段 x 立体声 = 8 通道：低 128 位为段 0/1，高 128 位为段 2/3
+EVCS_TARGET_AVX2 void kernelAvx2(const float* samples, size_t steps, const LoudnessMeter::Params& params,
+                                 double* energy, float& peak) {
+    const size_t segmentSteps = steps / 4;
+    const size_t segmentFloats = segmentSteps * params.stepFrames * 2;
+    const float* p0 = samples - params.warmupFrames * 2;
+    const float* p1 = p0 + segmentFloats;
+    const float* p2 = p1 + segmentFloats;
+    const float* p3 = p2 + segmentFloats;
+
+    const __m256 sb0 = _mm256_set1_ps(params.shelf[0]), sb1 = _mm256_set1_ps(params.shelf[1]);
+    const __m256 sb2 = _mm256_set1_ps(params.shelf[2]), sa1 = _mm256_set1_ps(params.shelf[3]);
+    const __m256 sa2 = _mm256_set1_ps(params.shelf[4]);
+    const __m256 hb0 = _mm256_set1_ps(params.highpass[0]), hb1 = _mm256_set1_ps(params.highpass[1]);
+    const __m256 hb2 = _mm256_set1_ps(params.highpass[2]), ha1 = _mm256_set1_ps(params.highpass[3]);
+    const __m256 ha2 = _mm256_set1_ps(params.highpass[4]);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 z0 = _mm256_setzero_ps(), z1 = _mm256_setzero_ps(), z2 = _mm256_setzero_ps(), z3 = _mm256_setzero_ps();
+    __m256 peakv = _mm256_setzero_ps();
+
+    for (size_t round = 0; round <= segmentSteps; ++round) {
+        const size_t frames = round == 0 ? params.warmupFrames : params.stepFrames;
+        __m256 acc = _mm256_setzero_ps();
+        for (size_t i = 0; i < frames; ++i, p0 += 2, p1 += 2, p2 += 2, p3 += 2) {
+            __m128 lo = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p0));
+            lo = _mm_loadh_pi(lo, reinterpret_cast<const __m64*>(p1));
+            __m128 hi = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p2));
+            hi = _mm_loadh_pi(hi, reinterpret_cast<const __m64*>(p3));
+            __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(sb0, x), z0);
+            z0 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(sb1, x), _mm256_mul_ps(sa1, y)), z1);
+            z1 = _mm256_sub_ps(_mm256_mul_ps(sb2, x), _mm256_mul_ps(sa2, y));
+            __m256 k = _mm256_add_ps(_mm256_mul_ps(hb0, y), z2);
+            z2 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(hb1, y), _mm256_mul_ps(ha1, k)), z3);
+            z3 = _mm256_sub_ps(_mm256_mul_ps(hb2, y), _mm256_mul_ps(ha2, k));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(k, k));
+            peakv = _mm256_max_ps(peakv, _mm256_and_ps(x, absMask));
+        }
+        if (round == 0) {
+            continue;
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, acc);
+        for (size_t segment = 0; segment < 4; ++segment) {
+            energy[segment * segmentSteps + round - 1] =
+                static_cast<double>(lanes[segment * 2]) + static_cast<double>(lanes[segment * 2 + 1]);
+        }
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, peakv);
+    for (float lane : lanes) {
+        peak = std::max(peak, lane);
+    }
+}
+
+#endif  // EVCS_X86
+
+Kernel kernelFor(SimdLevel kernel) {
+#ifdef EVCS_X86
+    switch (kernel) {
+    case SimdLevel::AVX2:
+        return kernelAvx2;
+    case SimdLevel::SSE2:
+        return kernelSse2;
+    default:
+        break;
+    }
+#endif
+    (void)kernel;
+    return kernelScalar;
+}
+}  // namespace
+
+LoudnessMeter::LoudnessMeter(uint32_t sampleRate, SimdLevel kernel)
+    : m_kernel(CpuFeatures::supports(kernel) ? kernel : SimdLevel::SCALAR) {
+    designKWeighting(sampleRate, m_params);
+    m_params.stepFrames = std::max<size_t>(1, (sampleRate + 5) / 10);
+    m_params.warmupFrames = m_params.stepFrames / 2;
+    // 文件开头之前按静音预热（与零状态等价）
+    m_buffer.assign((m_params.warmupFrames + kChunkSteps * m_params.stepFrames) * 2, 0.0f);
+}
+
+void LoudnessMeter::add(const float* samples, size_t frames) {
+    const size_t chunkFrames = kChunkSteps * m_params.stepFrames;
+    while (frames > 0) {
+        size_t count = std::min(frames, chunkFrames - m_bufferedFrames);
+        std::memcpy(m_buffer.data() + (m_params.warmupFrames + m_bufferedFrames) * 2, samples,
+                    count * 2 * sizeof(float));
+        m_bufferedFrames += count;
+        samples += count * 2;
+        frames -= count;
+        if (m_bufferedFrames == chunkFrames) {
+            processSteps(kChunkSteps, m_kernel);
+            // 本块末尾留作下一块的预热前文
+            std::memmove(m_buffer.data(), m_buffer.data() + chunkFrames * 2, m_params.warmupFrames * 2 * sizeof(float));
+            m_bufferedFrames = 0;
+        }
+    }
+}
+
+void LoudnessMeter::processSteps(size_t steps, SimdLevel kernel) {
+    const size_t first = m_energy.size();
+    m_energy.resize(first + steps);
+    kernelFor(kernel)(m_buffer.data() + m_params.warmupFrames * 2, steps, m_params, m_energy.data() + first,
+                      m_peak);
+}
+
+bool LoudnessMeter::finish(LoudnessResult& result) {
+    // 不足一块（1.6 秒）的尾部逐采样处理；不足 100ms 的零头按标准舍弃
+    size_t steps = m_bufferedFrames / m_params.stepFrames;
+    if (steps > 0) {
+        processSteps(steps, SimdLevel::SCALAR);
+    }
+    m_bufferedFrames = 0;
+
+    result = LoudnessResult();
+    result.samplePeak = m_peak;
+    if (m_energy.size() < 4) {
+        return false;
+    }
+
+    // 400ms 块 = 相邻 4 个 100ms 步长；均方按两声道相加（声道权重均为 1）
+    const double blockFrames = 4.0 * static_cast<double>(m_params.stepFrames);
+    std::vector<double> power(m_energy.size() - 3);
+    for (size_t j = 0; j < power.size(); ++j) {
+        power[j] = (m_energy[j] + m_energy[j + 1] + m_energy[j + 2] + m_energy[j + 3]) / blockFrames;
+    }
+    result.blocks = power.size();
+
+    auto loudness = [](double meanSquare) { return -0.691 + 10.0 * std::log10(meanSquare); };
+    const double absoluteGate = std::pow(10.0, (ABSOLUTE_GATE_LUFS + 0.691) / 10.0);
+    double sum = 0.0;
+    size_t count = 0;
+    for (double value : power) {
+        if (value > absoluteGate) {
+            sum += value;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+    const double relativeGate = std::max(absoluteGate, sum / count * std::pow(10.0, RELATIVE_GATE_LU / 10.0));
+    sum = 0.0;
+    count = 0;
+    for (double value : power) {
+        if (value > relativeGate) {
+            sum += value;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+    result.integratedLufs = loudness(sum / count);
+    result.gatedBlocks = count;
+    return true;
+}
+
+float LoudnessMeter::normalizationGain(double lufs, double samplePeak, double targetLufs) {
+    double gainDb = std::min(targetLufs - lufs, MAX_BOOST_DB);
+    double gain = std::pow(10.0, gainDb / 20.0);
+    if (gain > 1.0 && samplePeak > 0.0) {
+        // 只限制提升：已经超过峰值上限的文件保持原样，不因归一化再削波
+        double ceiling = std::pow(10.0, PEAK_CEILING_DB / 20.0) / samplePeak;
+        gain = std::max(1.0, std::min(gain, ceiling));
+    }
+    return static_cast<float>(gain);
+}
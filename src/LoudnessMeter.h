@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CpuFeatures.h"
+
+// 一段音频的 EBU R128 积分响度
+struct LoudnessResult {
+    double integratedLufs = 0.0;  // 门限后的积分响度（LUFS）
+    double samplePeak = 0.0;      // 采样峰值（线性，1.0 为满刻度）
+    size_t blocks = 0;            // 400ms 测量块总数（相邻块重叠 75%）
+    size_t gatedBlocks = 0;       // 通过绝对/相对门限的块数
+};
+
+// EBU R128 / ITU-R BS.1770-4 积分响度测量（交错立体声 float 输入，可分段喂入）。
+//
+// K 加权（高架 + 高通两级双二阶）后按 100ms 步长累计平方和，finish() 时组成 400ms 块，
+// 经 -70 LUFS 绝对门限与 -10 LU 相对门限求积分响度。
+//
+// 双二阶是递推的，同一路信号内无法按采样并行；SIMD 内核把一段输入切成若干时间段
+// 放进不同通道（SSE2 两段、AVX2 四段，每段立体声两路），各段从零状态起先用前 50ms 数据预热滤波器
+// （K 加权的冲激响应在此之内衰减到 float 精度以下），段间结果与逐采样计算一致。
+// 预热所需的前文由本类保留，文件开头之前视为静音。
+class LoudnessMeter {
+public:
+    static constexpr double ABSOLUTE_GATE_LUFS = -70.0;
+    static constexpr double RELATIVE_GATE_LU = -10.0;
+    // 归一化增益上限：最多提升 12 dB，提升后采样峰值不超过 -1 dBFS；衰减不受限
+    static constexpr double MAX_BOOST_DB = 12.0;
+    static constexpr double PEAK_CEILING_DB = -1.0;
+
+    explicit LoudnessMeter(uint32_t sampleRate, SimdLevel kernel = CpuFeatures::best());
+
+    // 追加 frames 帧交错立体声
+    void add(const float* samples, size_t frames);
+    // 结束测量。不足一个 400ms 块或全部低于门限（静音）返回 false
+    bool finish(LoudnessResult& result);
+
+    // 实际使用的内核（CPU 不支持请求的内核时退回标量）
+    SimdLevel getKernel() const { return m_kernel; }
+
+    // 把 lufs 归一到 targetLufs 的线性增益（受 MAX_BOOST_DB 与 PEAK_CEILING_DB 约束）
+    static float normalizationGain(double lufs, double samplePeak, double targetLufs);
+
+    // 内核参数：两级双二阶系数（各 b0 b1 b2 a1 a2）与分段长度
+    struct Params {
+        float shelf[5];
+        float highpass[5];
+        size_t stepFrames = 0;    // 100ms
+        size_t warmupFrames = 0;  // 50ms
+    };
+
+private:
+    void processSteps(size_t steps, SimdLevel kernel);
+
+    const SimdLevel m_kernel;
+    Params m_params;
+    std::vector<float> m_buffer;   // 预热前文 + 待处理的帧
+    size_t m_bufferedFrames = 0;   // m_buffer 中预热前文之后的帧数
+    std::vector<double> m_energy;  // 每 100ms 两声道 K 加权平方和
+    float m_peak = 0.0f;
+};
@@ -1,5 +1,7 @@
 #include "MainWindow.h"
 #include "AudioPlayer.h"
+#include "AudioBundle.h"
+#include "ClipSequence.h"
 #include "ConfigManager.h"
 #include "resource.h"
 #include "version.h"
@@ -11,12 +13,56 @@
 #include <chrono>
 #include <algorithm>
 #include <filesystem>
+#include <map>
 
 #pragma comment(lib, "comctl32.lib")
 
 // 听力文件名常量（英语科目）
 static constexpr const char* LISTENING_AUDIO_FILE = "tl.mp3";
 
+// 起播延迟报告文件名（程序目录下）
+static constexpr const char* LATENCY_REPORT_FILE = "evcs_latency.txt";
+
+// 音频预载结果摘要（配置加载成功提示用）
+static std::wstring FormatAssetPoolSummary(const AssetPoolStats& stats) {
+    if (stats.budgetBytes == 0) {
+        return L"音频预载：已关闭";
+    }
+    wchar_t text[256];
+    swprintf_s(text, _countof(text), L"音频预载：%zu/%zu 个文件，占用 %.1f MB，用时 %.0f ms",
+        stats.loadedFiles, stats.requestedFiles, stats.footprintBytes() / (1024.0 * 1024.0), stats.loadMs);
+    std::wstring summary = text;
+    if (stats.missingFiles > 0 || stats.overBudgetFiles > 0) {
+        swprintf_s(text, _countof(text), L"（缺失 %zu 个，超出预算 %zu 个将从磁盘播放）",
+            stats.missingFiles, stats.overBudgetFiles);
+        summary += text;
+    }
+    return summary;
+}
+
+// 按元数据缓存填写已知音频时长（生成指令后、交给播放线程前）
+static void FillKnownDurations(std::vector<Instruction>& instructions) {
+    for (auto& instruction : instructions) {
+        double seconds = AudioPlayer::getCachedDuration(instruction.audioFile);
+        if (seconds > 0.0) {
+            instruction.cachedDurationSeconds = seconds;
+        }
+    }
+}
+
+// 「时长」列文本：m:ss，播完时下一条指令已开始则追加「重叠」；时长未知为空
+static std::wstring FormatDurationColumn(const InstructionTable& instructions, size_t index) {
+    double seconds = instructions.cachedDurationSeconds(index);
+    if (seconds <= 0.0) {
+        return std::wstring();
+    }
+    int total = static_cast<int>(seconds + 0.5);
+    wchar_t text[32];
+    swprintf_s(text, _countof(text), L"%d:%02d%s", total / 60, total % 60,
+        instructions.overlapsNext(index) ? L" 重叠" : L"");
+    return text;
+}
+
 // 定义 UNICODE 版本的窗口类名和标题
 #ifdef UNICODE
 #define WINDOW_CLASS_NAME L"Examination Voice Command System"
@@ -28,10 +74,17 @@ static constexpr const char* LISTENING_AUDIO_FILE = "tl.mp3";
 
 MainWindow::MainWindow() : m_hwnd(NULL), m_hwndStatusBar(NULL), m_hwndStatusPanel(NULL), m_hStatusPanelFont(NULL),
     m_hwndSubjectList(NULL), m_hwndInstructionList(NULL), m_dpi(96), m_dpiScaleX(1.0f), m_dpiScaleY(1.0f),
-    m_currentPlayingIndex(-1), m_nextInstructionIndex(-1) {
+    m_engine(Clock::system(), m_audioSink), m_view(std::make_shared<SessionView>()) {
     // 初始化 COM
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
 
+    // 播放线程上只投递消息（合并为一条），界面在 WM_ENGINE_EVENTS 中取走全部事件
+    m_engine.setNotify([this]() {
+        PostMessage(m_hwnd, WM_ENGINE_EVENTS, 0, 0);
+    });
+    // 每科考完把起播延迟（计划/决策/建流/出声各阶段的 p50/p99/max）写到程序目录
+    m_engine.setLatencyReportPath(PathUtil::getAppDir() / LATENCY_REPORT_FILE);
+
     // 初始化通用控件
     INITCOMMONCONTROLSEX icex;
     icex.dwSize = sizeof(INITCOMMONCONTROLSEX);
@@ -43,6 +96,8 @@ MainWindow::MainWindow() : m_hwnd(NULL), m_hwndStatusBar(NULL), m_hwndStatusPane
     if (!configManager.loadDefaultConfig()) {
         // 默认配置加载失败，显示警告但不阻止启动
         // 此处窗口尚未创建，暂不弹消息框
+    } else {
+        PreloadAudioAssets();
     }
 
     m_lastVolumeCheck = std::chrono::steady_clock::time_point();
@@ -75,11 +130,21 @@ LRESULT CALLBACK MainWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPA
                 pThis->UpdateDpiInfo();
                 pThis->UpdateLayoutForDpi();
                 SetTimer(hwnd, TIMER_ID, TIMER_INTERVAL, NULL);
+                pThis->ApplyPrefetchSetting();
+                pThis->m_engine.start();
+                pThis->RefreshAudioMetadata();
+                pThis->VerifyAudioManifest();
+                pThis->StartAudioMirror();
                 return 0;
 
             case WM_DESTROY:
+                // 播放线程退出前停掉全部播放
+                pThis->m_engine.stop();
+                pThis->m_manifestVerifier.cancel();
+                // 预检的解码器引用音频后端，须在 AudioPlayer::cleanup() 之前结束
+                pThis->m_preflight.cancel();
+                pThis->m_audioMirror.cancel();
                 KillTimer(hwnd, TIMER_ID);
-                AudioPlayer::stop();
                 PostQuitMessage(0);
                 return 0;
 
@@ -106,11 +171,29 @@ LRESULT CALLBACK MainWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPA
                     pThis->UpdateStatusBar();
                     pThis->UpdateStatusPanel();
                     pThis->RefreshFileExistColumn();
-                    pThis->CheckPlaybackCompletion();
-                    pThis->UpdateNextInstruction();
                 }
                 return 0;
 
+            case WM_ENGINE_EVENTS:
+                pThis->HandleEngineEvents();
+                return 0;
+
+            case WM_METADATA_READY:
+                pThis->ApplyAudioDurations();
+                return 0;
+
+            case WM_MANIFEST_REPORT:
+                pThis->ApplyManifestReport();
+                return 0;
+
+            case WM_PREFLIGHT_REPORT:
+                pThis->ShowPreflightReport();
+                return 0;
+
+            case WM_MIRROR_READY:
+                pThis->ApplyMirrorReport();
+                return 0;
+
             case WM_NOTIFY: {
                 LPNMHDR lpnmh = (LPNMHDR)lParam;
                 if (lpnmh->hwndFrom == pThis->m_hwndSubjectList) {
@@ -136,6 +219,9 @@ LRESULT CALLBACK MainWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPA
                     case IDM_FILE_RELOAD_CONFIG:
                         pThis->ReloadConfigFile();
                         return 0;
+                    case IDM_FILE_PREFLIGHT:
+                        pThis->RunAudioPreflight();
+                        return 0;
                     case IDM_DELETE_SUBJECT: {
                         int selectedItem = ListView_GetNextItem(pThis->m_hwndSubjectList, -1, LVNI_SELECTED);
                         if (selectedItem >= 0) {
@@ -327,6 +413,11 @@ void MainWindow::CreateControls() {
     lvc.pszText = (LPWSTR)L"文件存在";
     lvc.cx = ScaleX(80);
     ListView_InsertColumn(m_hwndInstructionList, 4, &lvc);
+
+    lvc.iSubItem = 5;
+    lvc.pszText = (LPWSTR)L"时长";
+    lvc.cx = ScaleX(90);
+    ListView_InsertColumn(m_hwndInstructionList, 5, &lvc);
 }
 
 void MainWindow::AddSubject() {
@@ -349,22 +440,11 @@ void MainWindow::DeleteSubject(int index) {
         return;
     }
 
-    auto& subject = m_subjects[index];
-    int subjectIdToDelete = subject.id;
-
-    m_instructions.erase(
-        std::remove_if(m_instructions.begin(), m_instructions.end(),
-            [subjectIdToDelete](const Instruction& instr) {
-                return instr.subjectId == subjectIdToDelete;
-            }),
-        m_instructions.end());
-
+    // 播放线程负责删除该科目的指令；若正在播放其指令则先停止。指令列表随事件刷新
+    m_engine.removeSubject(m_subjects[index].id);
     m_subjects.erase(m_subjects.begin() + index);
 
-    InvalidateAudioCache();
     UpdateSubjectList();
-    UpdateInstructionList();
-    UpdateStatusPanel();
 }
 
 void MainWindow::UpdateStatusBar() {
@@ -388,17 +468,16 @@ void MainWindow::UpdateStatusBar() {
     // 音频文件状态：指令缺失数走缓存；听力文件单文件、exists 便宜，每秒实时查
     wchar_t audioFileStatusText[512] = L"音频文件: 无指令";
 
-    bool listeningFileExists = std::filesystem::exists(PathUtil::getAudioPath(LISTENING_AUDIO_FILE));
+    bool listeningFileExists = AudioBundle::exists(LISTENING_AUDIO_FILE);
 
-    if (!m_instructions.empty()) {
+    const auto& instructions = m_view->instructions;
+    if (!instructions.empty()) {
         if (m_cachedMissingInstructionCount < 0) {
-            int missing = 0;
-            for (const auto& instruction : m_instructions) {
-                if (!instruction.checkAudioFileExists()) {
-                    missing++;
-                }
-            }
-            m_cachedMissingInstructionCount = missing;
+            // 每个不同的音频文件只探测一次
+            m_cachedMissingInstructionCount = static_cast<int>(instructions.countMissingAudio(
+                [](const std::string& audioFile) {
+                    return ClipSequence::exists(audioFile);
+                }));
         }
         int missingCount = m_cachedMissingInstructionCount;
 
@@ -419,6 +498,22 @@ void MainWindow::UpdateStatusBar() {
         }
     }
 
+    wcsncat_s(audioFileStatusText, _countof(audioFileStatusText), m_manifestStatusText.c_str(), _TRUNCATE);
+    wcsncat_s(audioFileStatusText, _countof(audioFileStatusText), m_mirrorStatusText.c_str(), _TRUNCATE);
+
+    // 输出延迟补偿：提前量（设备延迟 + 排队量），补偿后最近一次首帧出声相对计划时刻的残余误差
+    const EngineStats stats = m_engine.getStats();
+    wchar_t latencyText[96] = L"";
+    if (stats.outputCompensationMs <= 0.0) {
+        swprintf_s(latencyText, _countof(latencyText), L", 输出延迟: 未补偿");
+    } else if (stats.residualSamples > 0) {
+        swprintf_s(latencyText, _countof(latencyText), L", 输出延迟: 提前%.0fms, 误差%+.1fms",
+            stats.outputCompensationMs, stats.lastResidualMs);
+    } else {
+        swprintf_s(latencyText, _countof(latencyText), L", 输出延迟: 提前%.0fms", stats.outputCompensationMs);
+    }
+    wcsncat_s(audioFileStatusText, _countof(audioFileStatusText), latencyText, _TRUNCATE);
+
     SendMessage(m_hwndStatusBar, SB_SETTEXT, 0, (LPARAM)volumeText);
     SendMessage(m_hwndStatusBar, SB_SETTEXT, 1, (LPARAM)audioFileStatusText);
     SendMessage(m_hwndStatusBar, SB_SETTEXT, 2, (LPARAM)currentTimeText);
@@ -428,25 +523,27 @@ void MainWindow::UpdateStatusPanel() {
     wchar_t statusText[512] = L"";
     bool hasCurrentInstruction = false;
 
-    if (m_currentPlayingIndex >= 0 &&
-        static_cast<size_t>(m_currentPlayingIndex) < m_instructions.size()) {
+    const auto& instructions = m_view->instructions;
+    const int currentPlayingIndex = m_view->currentPlayingIndex;
+    const int nextInstructionIndex = m_view->nextInstructionIndex;
 
-        const auto& currentInstruction = m_instructions[m_currentPlayingIndex];
+    if (currentPlayingIndex >= 0 &&
+        static_cast<size_t>(currentPlayingIndex) < instructions.size()) {
 
-        if (currentInstruction.status == PlaybackStatus::PLAYING) {
-            auto now = std::chrono::system_clock::now();
+        if (instructions.status(currentPlayingIndex) == PlaybackStatus::PLAYING) {
+            auto now = Clock::system().now();
             auto playedDuration = std::chrono::duration_cast<std::chrono::seconds>(
-                now - m_currentPlayingStartTime).count();
+                now - m_view->currentPlayingStartTime).count();
 
             // 使用缓存的音频时长（播放开始时已取），避免每秒重开文件
-            double totalDuration = currentInstruction.cachedDurationSeconds;
+            double totalDuration = instructions.cachedDurationSeconds(currentPlayingIndex);
             int totalSeconds = static_cast<int>(totalDuration);
             int remainingSeconds = (totalSeconds - static_cast<int>(playedDuration)) > 0 ?
                                  (totalSeconds - static_cast<int>(playedDuration)) : 0;
 
             swprintf_s(statusText, _countof(statusText),
                 L"当前指令: %s (剩余 %d秒 / 总计 %d秒)",
-                StringUtil::utf8ToWide(currentInstruction.name).c_str(),
+                StringUtil::utf8ToWide(instructions.name(currentPlayingIndex)).c_str(),
                 remainingSeconds,
                 totalSeconds);
 
@@ -457,30 +554,30 @@ void MainWindow::UpdateStatusPanel() {
     if (!hasCurrentInstruction) {
         wcscpy_s(statusText, _countof(statusText), L"下一指令: 无");
 
-        if (m_nextInstructionIndex >= 0 &&
-            static_cast<size_t>(m_nextInstructionIndex) < m_instructions.size()) {
+        if (nextInstructionIndex >= 0 &&
+            static_cast<size_t>(nextInstructionIndex) < instructions.size()) {
 
-            const auto& instruction = m_instructions[m_nextInstructionIndex];
+            const std::wstring instrName = StringUtil::utf8ToWide(instructions.name(nextInstructionIndex));
 
-            if (instruction.status == PlaybackStatus::UNPLAYED) {
-                auto now = std::chrono::system_clock::now();
+            if (instructions.status(nextInstructionIndex) == PlaybackStatus::UNPLAYED) {
+                auto now = Clock::system().now();
                 auto nowTime = std::chrono::system_clock::to_time_t(now);
-                auto instrTime = std::chrono::system_clock::to_time_t(instruction.playTime);
+                auto instrTime = std::chrono::system_clock::to_time_t(instructions.playTime(nextInstructionIndex));
 
                 int timeDiffMinutes = static_cast<int>((instrTime - nowTime) / 60);
 
                 if (timeDiffMinutes > 0) {
                     swprintf_s(statusText, _countof(statusText),
                         L"下一指令: %s (%d分钟后)",
-                        StringUtil::utf8ToWide(instruction.name).c_str(), timeDiffMinutes);
+                        instrName.c_str(), timeDiffMinutes);
                 } else if (timeDiffMinutes == 0) {
                     swprintf_s(statusText, _countof(statusText),
                         L"下一指令: %s (即将播放)",
-                        StringUtil::utf8ToWide(instruction.name).c_str());
+                        instrName.c_str());
                 } else {
                     swprintf_s(statusText, _countof(statusText),
                         L"下一指令: %s (播放时间已到)",
-                        StringUtil::utf8ToWide(instruction.name).c_str());
+                        instrName.c_str());
                 }
             }
         }
@@ -536,23 +633,26 @@ void MainWindow::UpdateSubjectList() {
 void MainWindow::UpdateInstructionList() {
     ListView_DeleteAllItems(m_hwndInstructionList);
 
-    m_nextInstructionIndex = -1;
-
-    if (m_instructions.empty()) {
+    const auto& instructions = m_view->instructions;
+    if (instructions.empty()) {
         return;
     }
 
-    ListView_SetItemCount(m_hwndInstructionList, static_cast<int>(m_instructions.size()));
-
-    for (size_t i = 0; i < m_instructions.size(); ++i) {
-        const auto& instruction = m_instructions[i];
+    ListView_SetItemCount(m_hwndInstructionList, static_cast<int>(instructions.size()));
 
+    for (size_t i = 0; i < instructions.size(); ++i) {
         try {
-            std::wstring subjectName = StringUtil::utf8ToWide(instruction.subjectName);
-            std::wstring instrName = StringUtil::utf8ToWide(instruction.name);
-            std::wstring playTime = StringUtil::utf8ToWide(instruction.getPlayDateTimeString());
-            std::wstring status = StringUtil::utf8ToWide(instruction.getStatusString());
-            std::wstring fileExist = instruction.checkAudioFileExists() ? L"存在" : L"缺失";
+            std::wstring subjectName = StringUtil::utf8ToWide(instructions.subjectName(i));
+            std::wstring instrName = StringUtil::utf8ToWide(instructions.name(i));
+            // 接续指令没有固定时刻：显示按上一条时长推算的预计开始时刻
+            std::wstring playTime = StringUtil::utf8ToWide(
+                Instruction::formatPlayDateTime(instructions.expectedStart(i)));
+            if (instructions.chained(i)) {
+                playTime = L"接续 " + playTime;
+            }
+            std::wstring status = StringUtil::utf8ToWide(Instruction::statusString(instructions.status(i)));
+            std::wstring fileExist = ClipSequence::exists(instructions.audioFile(i)) ? L"存在" : L"缺失";
+            std::wstring duration = FormatDurationColumn(instructions, i);
 
             LVITEM lvi = {0};
             lvi.mask = LVIF_TEXT;
@@ -570,6 +670,8 @@ void MainWindow::UpdateInstructionList() {
                                    const_cast<LPWSTR>(status.c_str()));
                 ListView_SetItemText(m_hwndInstructionList, itemIndex, 4,
                                    const_cast<LPWSTR>(fileExist.c_str()));
+                ListView_SetItemText(m_hwndInstructionList, itemIndex, 5,
+                                   const_cast<LPWSTR>(duration.c_str()));
             }
         } catch (const std::exception& e) {
             OutputDebugStringA("UpdateInstructionList error: ");
@@ -588,7 +690,8 @@ void MainWindow::UpdateInstructionList() {
 void MainWindow::RefreshFileExistColumn() {
     // 「文件存在」列周期补刷：仅刷新第 4 列文本，不重建整表。
     // 路径存在性实时检查（不缓存单路径结果），按 5s 节流以降低文件系统开销。
-    if (m_instructions.empty() || m_hwndInstructionList == nullptr) {
+    const auto& instructions = m_view->instructions;
+    if (instructions.empty() || m_hwndInstructionList == nullptr) {
         return;
     }
 
@@ -600,8 +703,8 @@ void MainWindow::RefreshFileExistColumn() {
     }
     m_lastFileExistRefresh = now;
 
-    // RAII 守卫：无论下方是否抛异常（checkAudioFileExists 走 filesystem::exists，
-    // 介质损坏/权限错误时会抛 filesystem_error），都保证 WM_SETREDRAW 被恢复，
+    // RAII 守卫：无论下方是否抛异常（文件存在检查走 filesystem，
+    // 介质损坏/权限错误时可能抛 filesystem_error），都保证 WM_SETREDRAW 被恢复，
     // 否则列表控件将永久不再重绘，UI 表现为卡死（AGENTS.md §4/§5）。
     bool redrawDisabled = false;
     auto enableRedrawGuard = [&]() {
@@ -619,11 +722,10 @@ void MainWindow::RefreshFileExistColumn() {
     const int itemCount = ListView_GetItemCount(m_hwndInstructionList);
     try {
         for (int i = 0; i < itemCount; ++i) {
-            if (i < 0 || static_cast<size_t>(i) >= m_instructions.size()) {
+            if (i < 0 || static_cast<size_t>(i) >= instructions.size()) {
                 break;
             }
-            const auto& instruction = m_instructions[i];
-            const wchar_t* newText = instruction.checkAudioFileExists() ? L"存在" : L"缺失";
+            const wchar_t* newText = ClipSequence::exists(instructions.audioFile(i)) ? L"存在" : L"缺失";
 
             wchar_t buf[16] = {0};
             ListView_GetItemText(m_hwndInstructionList, i, 4, buf, _countof(buf));
@@ -649,50 +751,6 @@ void MainWindow::RefreshFileExistColumn() {
     }
 }
 
-void MainWindow::UpdateNextInstruction() {
-    // 当前有指令正在播放时，等待播放完成
-    if (m_currentPlayingIndex >= 0 &&
-        static_cast<size_t>(m_currentPlayingIndex) < m_instructions.size() &&
-        m_instructions[m_currentPlayingIndex].status == PlaybackStatus::PLAYING) {
-        return;
-    }
-
-    // 标记过期超过 60 秒的指令为跳过
-    auto now = std::chrono::system_clock::now();
-    auto nowTimestamp = std::chrono::duration_cast<std::chrono::seconds>(
-        now.time_since_epoch()).count();
-
-    bool hasExpiredInstructions = false;
-    for (auto& instruction : m_instructions) {
-        if (instruction.status == PlaybackStatus::UNPLAYED) {
-            auto instructionTimestamp = std::chrono::duration_cast<std::chrono::seconds>(
-                instruction.playTime.time_since_epoch()).count();
-
-            if (instructionTimestamp < nowTimestamp &&
-                (nowTimestamp - instructionTimestamp) > 60) {
-                instruction.status = PlaybackStatus::SKIPPED;
-                hasExpiredInstructions = true;
-            }
-        }
-    }
-
-    if (hasExpiredInstructions) {
-        UpdateInstructionListDisplay();
-    }
-
-    if (m_nextInstructionIndex < 0 ||
-        static_cast<size_t>(m_nextInstructionIndex) >= m_instructions.size() ||
-        m_instructions[m_nextInstructionIndex].status != PlaybackStatus::UNPLAYED) {
-        SetNextInstruction();
-    }
-
-    if (m_nextInstructionIndex >= 0 && IsTimeToPlayNextInstruction()) {
-        PlayInstruction(m_nextInstructionIndex, false);
-    } else if (m_nextInstructionIndex >= 0) {
-        EnsureInstructionListFocus();
-    }
-}
-
 void MainWindow::HandleSubjectListNotify(LPNMHDR lpnmh) {
     switch (lpnmh->code) {
         case NM_RCLICK: {
@@ -729,8 +787,9 @@ LRESULT MainWindow::HandleInstructionListNotify(LPNMHDR lpnmh) {
 
                 case CDDS_ITEMPREPAINT: {
                     int itemIndex = (int)lpCustomDraw->nmcd.dwItemSpec;
-                    if (itemIndex >= 0 && static_cast<size_t>(itemIndex) < m_instructions.size()) {
-                        COLORREF textColor = m_instructions[itemIndex].getStatusTextColor();
+                    const auto& instructions = m_view->instructions;
+                    if (itemIndex >= 0 && static_cast<size_t>(itemIndex) < instructions.size()) {
+                        COLORREF textColor = Instruction::statusTextColor(instructions.status(itemIndex));
                         lpCustomDraw->clrText = textColor;
                     }
                     // 请求子项绘制通知，以便对「文件存在」列单独上色
@@ -738,8 +797,15 @@ LRESULT MainWindow::HandleInstructionListNotify(LPNMHDR lpnmh) {
                 }
 
                 case CDDS_SUBITEM | CDDS_ITEMPREPAINT: {
-                    // 第 4 列（文件存在）按存在/缺失上色；其余列沿用默认行色
-                    if (lpCustomDraw->iSubItem == 4) {
+                    // 第 4 列（文件存在）按存在/缺失上色，第 5 列（时长）重叠标橙；其余列沿用默认行色
+                    if (lpCustomDraw->iSubItem == 5) {
+                        int itemIndex = (int)lpCustomDraw->nmcd.dwItemSpec;
+                        const auto& instructions = m_view->instructions;
+                        if (itemIndex >= 0 && static_cast<size_t>(itemIndex) < instructions.size() &&
+                            instructions.overlapsNext(itemIndex)) {
+                            lpCustomDraw->clrText = RGB(220, 110, 0);
+                        }
+                    } else if (lpCustomDraw->iSubItem == 4) {
                         wchar_t buf[16] = {0};
                         ListView_GetItemText(m_hwndInstructionList,
                                              (int)lpCustomDraw->nmcd.dwItemSpec, 4,
@@ -760,7 +826,7 @@ LRESULT MainWindow::HandleInstructionListNotify(LPNMHDR lpnmh) {
 
         case NM_DBLCLK: {
             LPNMITEMACTIVATE lpnmitem = (LPNMITEMACTIVATE)lpnmh;
-            if (lpnmitem->iItem >= 0 && static_cast<size_t>(lpnmitem->iItem) < m_instructions.size()) {
+            if (lpnmitem->iItem >= 0 && static_cast<size_t>(lpnmitem->iItem) < m_view->instructions.size()) {
                 PlayInstruction(lpnmitem->iItem, true);
             }
             break;
@@ -768,7 +834,7 @@ LRESULT MainWindow::HandleInstructionListNotify(LPNMHDR lpnmh) {
 
         case NM_RCLICK: {
             LPNMITEMACTIVATE lpnmitem = (LPNMITEMACTIVATE)lpnmh;
-            if (lpnmitem->iItem >= 0 && static_cast<size_t>(lpnmitem->iItem) < m_instructions.size()) {
+            if (lpnmitem->iItem >= 0 && static_cast<size_t>(lpnmitem->iItem) < m_view->instructions.size()) {
                 ListView_SetItemState(m_hwndInstructionList, lpnmitem->iItem,
                     LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
 
@@ -909,14 +975,10 @@ INT_PTR CALLBACK MainWindow::AddSubjectDialogProc(HWND hwnd, UINT msg, WPARAM wP
                         pMainWindow->m_subjects.push_back(subject);
                         pMainWindow->UpdateSubjectList();
 
-                        auto instructions = Instruction::generateInstructions(subject);
-                        pMainWindow->m_instructions.insert(
-                            pMainWindow->m_instructions.end(),
-                            instructions.begin(),
-                            instructions.end());
-                        pMainWindow->InvalidateAudioCache();
-                        pMainWindow->UpdateInstructionList();
-                        pMainWindow->UpdateStatusPanel();
+                        // 指令在界面线程按当前配置生成，交给播放线程归并；列表随事件刷新
+                        auto generated = Instruction::generateInstructions(subject);
+                        FillKnownDurations(generated);
+                        pMainWindow->m_engine.addInstructions(std::move(generated));
 
                         EndDialog(hwnd, IDOK);
                         return TRUE;
@@ -1079,83 +1141,75 @@ void MainWindow::UpdateLayoutForDpi() {
 
 // 指令播放相关方法
 void MainWindow::PlayInstruction(int index, bool isManualPlay) {
-    if (index < 0 || static_cast<size_t>(index) >= m_instructions.size()) {
+    if (index < 0 || static_cast<size_t>(index) >= m_view->instructions.size()) {
         return;
     }
 
-    auto& instruction = m_instructions[index];
-
-    // 过期检查（仅自动播放）
-    if (!isManualPlay) {
-        auto now = std::chrono::system_clock::now();
-        auto nowTimestamp = std::chrono::duration_cast<std::chrono::seconds>(
-            now.time_since_epoch()).count();
-        auto instructionTimestamp = std::chrono::duration_cast<std::chrono::seconds>(
-            instruction.playTime.time_since_epoch()).count();
-
-        if (instructionTimestamp < nowTimestamp &&
-            (nowTimestamp - instructionTimestamp) > 60) {
-            instruction.status = PlaybackStatus::SKIPPED;
-            UpdateInstructionListDisplay();
-            SetNextInstruction();
-            return;
-        }
+    // 行号按当前快照版本下发；播放结果（含手动播放失败提示）随事件返回
+    if (!m_engine.playInstruction(index, isManualPlay, m_view->generation)) {
+        OutputDebugStringA("[EVCS] 播放命令队列已满，忽略本次播放\n");
     }
+}
 
-    if (isManualPlay) {
-        MarkPreviousAsSkipped(index);
+void MainWindow::HandleEngineEvents() {
+    // 先全部取出再处理：处理中弹出的模态框会重入本消息，届时由内层取走后续事件
+    std::vector<EngineEvent> events;
+    m_engine.drainEvents([&events](EngineEvent& event) {
+        events.push_back(std::move(event));
+    });
+    if (events.empty()) {
+        return;
     }
 
-    // 之前在播放的指令置为已播放
-    if (m_currentPlayingIndex >= 0 &&
-        static_cast<size_t>(m_currentPlayingIndex) < m_instructions.size()) {
-        m_instructions[m_currentPlayingIndex].status = PlaybackStatus::PLAYED;
+    bool structural = false;
+    bool manualPlayFailed = false;
+    for (const auto& event : events) {
+        structural = structural || event.structural;
+        if (event.hasSessionEvent) {
+            onSessionEvent(event.sessionEvent, *event.view);
+            manualPlayFailed = manualPlayFailed ||
+                (event.sessionEvent.type == SessionEventType::PLAY_FAILED && event.sessionEvent.isManualPlay);
+        }
     }
+    m_view = events.back().view;
 
-    // 先尝试播放音频文件
-    bool ok = AudioPlayer::playAudioFile(instruction.audioFile);
-    if (!ok) {
-        // 播放失败：标记已播放，不进入 PLAYING
-        instruction.status = PlaybackStatus::PLAYED;
-        m_currentPlayingIndex = -1;
+    if (structural) {
         InvalidateAudioCache();
-        UpdateInstructionListDisplay();
-        // 自动播放失败仅记录日志，避免模态框阻塞定时器消息循环
-        // （手动播放才弹窗提示用户）
-        if (isManualPlay) {
-            MessageBoxW(m_hwnd, L"音频文件播放失败，请检查文件是否存在或格式是否支持。",
-                L"播放错误", MB_OK | MB_ICONWARNING);
-        } else {
-            std::string dbgName = instruction.audioFile;
-            OutputDebugStringA("[EVCS] 自动播放失败: ");
-            OutputDebugStringA(dbgName.c_str());
-            OutputDebugStringA("\n");
-        }
-        SetNextInstruction();
-        return;
     }
-
-    // 播放成功：从当前播放流直接取时长（避免再开一路流），进入 PLAYING
-    instruction.cachedDurationSeconds = AudioPlayer::getCurrentStreamDuration();
-    instruction.status = PlaybackStatus::PLAYING;
-    m_currentPlayingIndex = index;
-    m_currentPlayingStartTime = std::chrono::system_clock::now();
-
-    InvalidateAudioCache();
     UpdateInstructionListDisplay();
-    EnsureInstructionListFocus();
 
-    if (isManualPlay) {
-        m_nextInstructionIndex = FindNextUnplayedInstructionAfter(index);
+    if (manualPlayFailed) {
+        // 模态框只阻塞界面线程，播放线程照常按时起播
+        MessageBoxW(m_hwnd, L"音频文件播放失败，请检查文件是否存在或格式是否支持。",
+            L"播放错误", MB_OK | MB_ICONWARNING);
     }
 }
 
-void MainWindow::MarkPreviousAsSkipped(int playIndex) {
-    for (size_t i = 0; i < static_cast<size_t>(playIndex) && i < m_instructions.size(); ++i) {
-        auto& instruction = m_instructions[i];
-        if (instruction.status == PlaybackStatus::UNPLAYED) {
-            instruction.status = PlaybackStatus::SKIPPED;
-        }
+void MainWindow::onSessionEvent(const SessionEvent& event, const SessionView& view) {
+    const bool indexValid = event.index >= 0 &&
+        static_cast<size_t>(event.index) < view.instructions.size();
+    switch (event.type) {
+        case SessionEventType::PLAYED:
+            InvalidateAudioCache();
+            // 接续指令没有到点时刻，交接间隙见起播延迟报告
+            if (!event.isManualPlay && indexValid && !view.instructions.chained(event.index)) {
+                wchar_t dbg[96];
+                swprintf_s(dbg, _countof(dbg), L"[EVCS] 自动起播 #%d, 迟到 %.2fms\n", event.index,
+                    std::chrono::duration<double, std::milli>(
+                        event.time - view.instructions.playTime(event.index)).count());
+                OutputDebugStringW(dbg);
+            }
+            break;
+        case SessionEventType::PLAY_FAILED:
+            InvalidateAudioCache();
+            if (!event.isManualPlay && indexValid) {
+                OutputDebugStringA("[EVCS] 自动播放失败: ");
+                OutputDebugStringA(view.instructions.audioFile(event.index).c_str());
+                OutputDebugStringA("\n");
+            }
+            break;
+        default:
+            break;
     }
 }
 
@@ -1165,25 +1219,23 @@ void MainWindow::UpdateInstructionListDisplay() {
 }
 
 void MainWindow::EnsureInstructionListFocus() {
-    if (m_instructions.empty() || !m_hwndInstructionList) {
+    const auto& instructions = m_view->instructions;
+    if (instructions.empty() || !m_hwndInstructionList) {
         return;
     }
 
     int focusIndex = -1;
-
-    if (m_currentPlayingIndex >= 0 &&
-        static_cast<size_t>(m_currentPlayingIndex) < m_instructions.size()) {
-        focusIndex = m_currentPlayingIndex;
-    } else if (m_nextInstructionIndex >= 0 &&
-             static_cast<size_t>(m_nextInstructionIndex) < m_instructions.size()) {
-        focusIndex = m_nextInstructionIndex;
+    const int currentPlayingIndex = m_view->currentPlayingIndex;
+    const int nextInstructionIndex = m_view->nextInstructionIndex;
+
+    if (currentPlayingIndex >= 0 &&
+        static_cast<size_t>(currentPlayingIndex) < instructions.size()) {
+        focusIndex = currentPlayingIndex;
+    } else if (nextInstructionIndex >= 0 &&
+             static_cast<size_t>(nextInstructionIndex) < instructions.size()) {
+        focusIndex = nextInstructionIndex;
     } else {
-        for (size_t i = 0; i < m_instructions.size(); ++i) {
-            if (m_instructions[i].status == PlaybackStatus::UNPLAYED) {
-                focusIndex = static_cast<int>(i);
-                break;
-            }
-        }
+        focusIndex = m_view->findNextUnplayedInstruction();
     }
 
     if (focusIndex >= 0) {
@@ -1194,54 +1246,6 @@ void MainWindow::EnsureInstructionListFocus() {
     }
 }
 
-int MainWindow::FindNextUnplayedInstruction() const {
-    for (size_t i = 0; i < m_instructions.size(); ++i) {
-        if (m_instructions[i].status == PlaybackStatus::UNPLAYED) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
-}
-
-int MainWindow::FindNextUnplayedInstructionAfter(int index) const {
-    for (size_t i = index + 1; i < m_instructions.size(); ++i) {
-        if (m_instructions[i].status == PlaybackStatus::UNPLAYED) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
-}
-
-void MainWindow::SetNextInstruction() {
-    m_nextInstructionIndex = FindNextUnplayedInstruction();
-}
-
-bool MainWindow::IsTimeToPlayNextInstruction() const {
-    if (m_nextInstructionIndex < 0 ||
-        static_cast<size_t>(m_nextInstructionIndex) >= m_instructions.size()) {
-        return false;
-    }
-
-    const auto& instruction = m_instructions[m_nextInstructionIndex];
-
-    if (instruction.status != PlaybackStatus::UNPLAYED) {
-        return false;
-    }
-
-    auto now = std::chrono::system_clock::now();
-    auto nowTimestamp = std::chrono::duration_cast<std::chrono::seconds>(
-        now.time_since_epoch()).count();
-    auto instructionTimestamp = std::chrono::duration_cast<std::chrono::seconds>(
-        instruction.playTime.time_since_epoch()).count();
-
-    if (instructionTimestamp < nowTimestamp &&
-        (nowTimestamp - instructionTimestamp) > 60) {
-        return false;
-    }
-
-    return instructionTimestamp <= nowTimestamp;
-}
-
 void MainWindow::ShowInstructionContextMenu(int x, int y, int itemIndex) {
     HMENU hMenu = CreatePopupMenu();
     if (hMenu) {
@@ -1259,29 +1263,6 @@ void MainWindow::ShowInstructionContextMenu(int x, int y, int itemIndex) {
     }
 }
 
-void MainWindow::CheckPlaybackCompletion() {
-    if (m_currentPlayingIndex < 0 ||
-        static_cast<size_t>(m_currentPlayingIndex) >= m_instructions.size()) {
-        return;
-    }
-
-    auto& currentInstruction = m_instructions[m_currentPlayingIndex];
-
-    if (currentInstruction.status != PlaybackStatus::PLAYING) {
-        return;
-    }
-
-    // 基于 BASS 通道活跃状态判断播放是否结束（推荐做法，与真实音频输出严格对齐）
-    if (!AudioPlayer::isPlaying()) {
-        currentInstruction.status = PlaybackStatus::PLAYED;
-        m_currentPlayingIndex = -1;
-
-        SetNextInstruction();
-        UpdateInstructionListDisplay();
-        EnsureInstructionListFocus();
-    }
-}
-
 void MainWindow::LoadConfigFile() {
     OPENFILENAMEW ofn;
     wchar_t szFile[260] = {0};
@@ -1316,6 +1297,8 @@ void MainWindow::LoadConfigFile() {
             std::wstring message = L"配置文件加载成功！\n\n";
             message += L"配置文件：";
             message += szFile;
+            message += L"\n";
+            message += FormatAssetPoolSummary(AudioPlayer::getAssetPoolStats());
             MessageBoxW(m_hwnd, message.c_str(), L"加载成功", MB_OK | MB_ICONINFORMATION);
         } else {
             std::wstring message = L"配置文件加载失败！\n\n";
@@ -1353,6 +1336,8 @@ void MainWindow::ReloadConfigFile() {
     std::wstring message = L"配置文件重新加载成功！\n\n";
     message += L"配置文件：";
     message += currentConfigPath;
+    message += L"\n";
+    message += FormatAssetPoolSummary(AudioPlayer::getAssetPoolStats());
     MessageBoxW(m_hwnd, message.c_str(), L"重新加载成功", MB_OK | MB_ICONINFORMATION);
 }
 
@@ -1363,26 +1348,178 @@ void MainWindow::InvalidateAudioCache() {
 
 // 根据当前科目与配置重生成指令列表，按播放时间排序并重置播放状态
 void MainWindow::RegenerateInstructions() {
-    if (m_currentPlayingIndex >= 0) {
-        AudioPlayer::stop();
-    }
+    ApplyPrefetchSetting();
+    PreloadAudioAssets();
 
-    m_instructions.clear();
+    // 配置单例只在界面线程读写：在此按新配置生成指令，再整表交给播放线程重建
+    std::vector<Instruction> instructions;
     for (const auto& subject : m_subjects) {
-        auto subjectInstructions = Instruction::generateInstructions(subject);
-        m_instructions.insert(m_instructions.end(),
-            subjectInstructions.begin(), subjectInstructions.end());
+        auto generated = Instruction::generateInstructions(subject);
+        instructions.insert(instructions.end(), generated.begin(), generated.end());
     }
+    FillKnownDurations(instructions);
+    m_engine.regenerate(std::move(instructions));
+    RefreshAudioMetadata();
+    StartAudioMirror();
+}
 
-    std::sort(m_instructions.begin(), m_instructions.end(),
-        [](const Instruction& a, const Instruction& b) {
-            return a.playTime < b.playTime;
-        });
+// 按当前配置设置预热提前量（配置加载/重载后调用）
+void MainWindow::ApplyPrefetchSetting() {
+    int prefetchSeconds = ConfigManager::getInstance().getPrefetchSeconds();
+    m_engine.setPrefetchLead(std::chrono::seconds(prefetchSeconds));
+}
 
-    m_currentPlayingIndex = -1;
-    m_nextInstructionIndex = -1;
+// 按当前配置选择输出设备、把引用到的音频预载入内存（组合指令的片段解码进片段缓存）并设置响度归一化目标、
+// 开头静音裁剪（配置加载/重载后调用）。
+// 在界面线程上同步完成；期间播放线程照常按旧池/磁盘起播（输出设备变化时先整体重开输出）
+void MainWindow::PreloadAudioAssets() {
+    auto& configManager = ConfigManager::getInstance();
+    AudioBundle::remount();  // audio 目录下的打包文件可能已更新
+    AudioPlayer::setOutputDevices(configManager.getOutputDevices());
+    AudioPlayer::setBackupOutputDevices(configManager.getBackupOutputDevices());
+    AudioPlayer::setBackupAudioDir(std::filesystem::u8path(configManager.getBackupAudioDir()));
+    AudioPlayer::setLoudnessTarget(configManager.getLoudnessTarget());
+    AudioPlayer::setTrimLeadingSilence(configManager.getTrimLeadingSilence());
+    // 提前量取自打开输出时后端报告的设备延迟与排队量，加载配置时无需校准
+    AudioPlayer::setLatencyCompensation(configManager.getLatencyCompensation());
+    AssetPolicy policy = AssetPolicy::AUTO;
+    AudioAssetPool::parsePolicy(configManager.getAssetPoolMode(), policy);
+    uint64_t budgetBytes = static_cast<uint64_t>(configManager.getAssetPoolMegabytes()) * 1024 * 1024;
+    // 组合指令的片段解码为 PCM 放入片段缓存，不再占预载池的预算
+    std::vector<std::string> clips = configManager.getSequenceClips();
+    std::vector<std::string> files;
+    for (auto& file : configManager.getAudioFiles()) {
+        if (std::find(clips.begin(), clips.end(), file) == clips.end()) {
+            files.push_back(std::move(file));
+        }
+    }
+    AudioPlayer::loadAssetPool(files, policy, budgetBytes);
+    AudioPlayer::loadClipCache(clips, AudioPlayer::CLIP_CACHE_BUDGET_BYTES);
+}
 
-    InvalidateAudioCache();
-    UpdateInstructionList();
-    UpdateStatusPanel();
+// 后台刷新配置引用到的音频元数据（启动、配置加载/重载后调用）。未变化的文件只 stat 不探测，
+// 完成后投递 WM_METADATA_READY，由界面线程把时长交给播放线程
+void MainWindow::RefreshAudioMetadata() {
+    HWND hwnd = m_hwnd;
+    AudioPlayer::refreshMetadataAsync(ConfigManager::getInstance().getAudioFiles(), [hwnd]() {
+        PostMessage(hwnd, WM_METADATA_READY, 0, 0);
+    });
+}
+
+// 启动时按 audio 目录下的清单（由发布脚本生成）在后台校验素材完整性。大小与修改时间未变的文件
+// 沿用上次结果；预算（2 秒）到点仍未校验完时先投递一次部分结果，多 GB 的素材也能及时在状态栏报出缺失与截断
+void MainWindow::VerifyAudioManifest() {
+    HWND hwnd = m_hwnd;
+    auto post = [hwnd](const ManifestReport&) { PostMessage(hwnd, WM_MANIFEST_REPORT, 0, 0); };
+    m_manifestVerifier.verifyAsync(PathUtil::getAudioDir(), post, post);
+}
+
+// WM_MANIFEST_REPORT：取当前结果（预算到点时为部分结果）生成状态栏文字
+void MainWindow::ApplyManifestReport() {
+    ManifestReport report = m_manifestVerifier.getReport();
+    wchar_t text[256] = L"";
+    if (!report.manifestFound) {
+        // 没有清单（开发环境、未经发布脚本打包）：不显示
+    } else if (!report.problems.empty()) {
+        const auto& first = report.problems.front();
+        std::wstring name = StringUtil::utf8ToWide(first.first);
+        std::wstring problem = StringUtil::utf8ToWide(AudioManifest::problemName(first.second));
+        swprintf_s(text, _countof(text), L", 校验: %zu个异常 (%s %s%s)", report.problems.size(), name.c_str(),
+            problem.c_str(), report.problems.size() > 1 ? L" 等" : L"");
+    } else if (!report.complete) {
+        swprintf_s(text, _countof(text), L", 校验中 %zu/%zu", report.verifiedFiles, report.files);
+    } else {
+        swprintf_s(text, _countof(text), L", 校验通过 %zu个", report.files);
+    }
+    m_manifestStatusText = text;
+    UpdateStatusBar();
+}
+
+// 本机镜像：新配置可能引用镜像中没有的文件，先回到源目录，新的镜像校验通过后再切换。
+// 源未变化的文件只回读本机镜像校验，重新加载配置时通常不再读 U 盘
+void MainWindow::StartAudioMirror() {
+    auto& configManager = ConfigManager::getInstance();
+    const std::string& mode = configManager.getAudioMirror();
+    const std::filesystem::path sourceDir = PathUtil::getAudioSourceDir();
+    m_audioMirror.cancel();
+    if (!PathUtil::getAudioMirror().empty()) {
+        PathUtil::setAudioMirror({});
+        InvalidateAudioCache();
+    }
+    m_mirrorStatusText.clear();
+    if (mode == "off" || (mode == "auto" && !PathUtil::isRemovableMedia(sourceDir))) {
+        return;
+    }
+    const std::string& configuredDir = configManager.getAudioMirrorDir();
+    std::filesystem::path mirrorDir =
+        configuredDir.empty() ? AudioMirror::defaultMirrorDir() : std::filesystem::u8path(configuredDir);
+    m_mirrorStatusText = L", 镜像: 拷贝中";
+    HWND hwnd = m_hwnd;
+    m_audioMirror.syncAsync(sourceDir, std::move(mirrorDir),
+                            AudioMirror::listFiles(sourceDir, configManager.getAudioFiles()),
+                            [hwnd](const MirrorReport&) { PostMessage(hwnd, WM_MIRROR_READY, 0, 0); });
+}
+
+// WM_MIRROR_READY：校验通过则切换到镜像。打包文件随目录切换重新映射，元数据缓存改读镜像中的副本
+// （修改时间已沿用源文件，记录照样命中）
+void MainWindow::ApplyMirrorReport() {
+    MirrorReport report = m_audioMirror.getReport();
+    if (!report.complete) {
+        return;  // 已被新的同步取代
+    }
+    std::string summary = AudioMirror::formatReport(report) + "\n";
+    OutputDebugStringW(StringUtil::utf8ToWide(summary).c_str());
+    wchar_t text[128];
+    if (report.ready) {
+        PathUtil::setAudioMirror(report.mirrorDir);
+        InvalidateAudioCache();
+        RefreshAudioMetadata();
+        swprintf_s(text, _countof(text), L", 镜像: 就绪 (%.1f 秒)", report.elapsedMs / 1000.0);
+    } else {
+        swprintf_s(text, _countof(text), L", 镜像: 未启用");
+    }
+    m_mirrorStatusText = text;
+    UpdateStatusBar();
+}
+
+// 完整解码预检：配置引用到的每个不同文件经音频后端（与起播同一解码路径）从头解码到尾，
+// 线程数取 CPU 核数。考试进行中也可运行（解码与播放互不影响，但会占满 CPU），建议考前执行
+void MainWindow::RunAudioPreflight() {
+    if (m_preflight.isRunning()) {
+        MessageBoxW(m_hwnd, L"音频检查正在进行，完成后将显示报告。", L"检查音频", MB_OK | MB_ICONINFORMATION);
+        return;
+    }
+    AudioPreflight::Decoder decoder = AudioPlayer::getPreflightDecoder();
+    if (!decoder) {
+        MessageBoxW(m_hwnd, L"音频后端未能初始化，无法检查。", L"检查音频", MB_OK | MB_ICONERROR);
+        return;
+    }
+    m_preflight.setDecoder(std::move(decoder));
+    HWND hwnd = m_hwnd;
+    m_preflight.runAsync(ConfigManager::getInstance().getAudioFiles(), [hwnd](const PreflightReport&) {
+        PostMessage(hwnd, WM_PREFLIGHT_REPORT, 0, 0);
+    });
+}
+
+// WM_PREFLIGHT_REPORT：汇总与每个有问题的文件各一行
+void MainWindow::ShowPreflightReport() {
+    PreflightReport report = m_preflight.getReport();
+    std::wstring text = StringUtil::utf8ToWide(AudioPreflight::formatReport(report));
+    bool failed = report.problemFiles > 0;
+    MessageBoxW(m_hwnd, text.c_str(), L"检查音频", MB_OK | (failed ? MB_ICONWARNING : MB_ICONINFORMATION));
+}
+
+// WM_METADATA_READY：按当前快照中的文件名取缓存时长，交给播放线程填写时长列
+void MainWindow::ApplyAudioDurations() {
+    const auto& instructions = m_view->instructions;
+    std::map<std::string, double> durations;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const std::string& audioFile = instructions.audioFile(i);
+        if (durations.find(audioFile) == durations.end()) {
+            durations[audioFile] = AudioPlayer::getCachedDuration(audioFile);
+        }
+    }
+    if (!durations.empty()) {
+        m_engine.applyDurations(std::move(durations));
+    }
 }
@@ -3,8 +3,15 @@
 #include <commctrl.h>
 #include <vector>
 #include <chrono>
+#include <memory>
+#include <string>
 #include "Subject.h"
 #include "Instruction.h"
+#include "PlaybackEngine.h"
+#include "AudioPlayer.h"
+#include "AudioManifest.h"
+#include "AudioMirror.h"
+#include "AudioPreflight.h"
 #include "resource.h"
 
 class MainWindow {
@@ -25,18 +32,41 @@ private:
     HWND m_hwndInstructionList;
 
     std::vector<Subject> m_subjects;
-    std::vector<Instruction> m_instructions;
+
+    // 播放线程：独占考试会话与音频输出，界面只发命令、按事件刷新
+    AudioPlayerSink m_audioSink;
+    PlaybackEngine m_engine;
+    std::shared_ptr<const SessionView> m_view;  // 最近一次收到的会话快照（只读）
+    void HandleEngineEvents();  // WM_ENGINE_EVENTS：取走播放线程事件并刷新界面
+    void onSessionEvent(const SessionEvent& event, const SessionView& view);
+    void ApplyPrefetchSetting();  // 按配置 [设置] prefetch_seconds 设置预热提前量
+    void PreloadAudioAssets();    // 按配置 [设置] asset_pool_mb / asset_pool_mode 预载音频
+    void RefreshAudioMetadata();  // 后台刷新音频元数据缓存，完成后投递 WM_METADATA_READY
+    void ApplyAudioDurations();   // WM_METADATA_READY：把缓存的时长交给播放线程
+
+    // audio 目录完整性校验：启动时在后台线程池上按清单校验，结果显示在状态栏
+    ManifestVerifier m_manifestVerifier;
+    std::wstring m_manifestStatusText;  // 追加在状态栏「音频文件」一栏之后，无清单时为空
+    void VerifyAudioManifest();         // 启动后台校验，预算到点与完成时各投递一次 WM_MANIFEST_REPORT
+    void ApplyManifestReport();         // WM_MANIFEST_REPORT：按当前结果更新状态栏文字
+
+    // 本机镜像：audio 目录在 U 盘/网络盘上（或配置 audio_mirror=on）时把引用到的音频拷到本机，
+    // 校验通过后经 PathUtil 改从镜像取音频，结果显示在状态栏
+    AudioMirror m_audioMirror;
+    std::wstring m_mirrorStatusText;    // 追加在状态栏「音频文件」一栏之后，未启用镜像时为空
+    void StartAudioMirror();            // 按配置启动后台镜像（先回到源目录），结束后投递 WM_MIRROR_READY
+    void ApplyMirrorReport();           // WM_MIRROR_READY：校验通过则切换到镜像并更新状态栏
+
+    // 完整解码预检（文件菜单）：在后台线程池上把配置引用到的每个音频解码一遍，完成后弹出报告
+    AudioPreflight m_preflight;
+    void RunAudioPreflight();           // 启动后台预检，完成后投递 WM_PREFLIGHT_REPORT
+    void ShowPreflightReport();         // WM_PREFLIGHT_REPORT：弹出预检报告
 
     // DPI 相关成员
     UINT m_dpi;
     float m_dpiScaleX;
     float m_dpiScaleY;
 
-    // 指令列表状态相关
-    int m_currentPlayingIndex;  // 当前播放的指令索引，-1 表示无
-    int m_nextInstructionIndex; // 下一个要播放的指令索引，-1 表示无
-    std::chrono::system_clock::time_point m_currentPlayingStartTime;
-
     // 音频文件状态缓存（避免每秒全量扫描文件系统）
     int m_cachedMissingInstructionCount = -1;  // <0 表示缓存失效
 
@@ -59,10 +89,8 @@ private:
     LRESULT HandleInstructionListNotify(LPNMHDR lpnmh);
     void ShowSubjectContextMenu(int x, int y, int itemIndex);
     void ShowInstructionContextMenu(int x, int y, int itemIndex);
-    void UpdateNextInstruction();
     void UpdateStatusBar();
     void UpdateStatusPanel();
-    void CheckPlaybackCompletion();
 
     // 菜单相关方法
     void ShowHelp();
@@ -74,13 +102,8 @@ private:
 
     // 指令播放相关方法
     void PlayInstruction(int index, bool isManualPlay = false);
-    void MarkPreviousAsSkipped(int playIndex);
     void UpdateInstructionListDisplay();
     void EnsureInstructionListFocus();
-    int FindNextUnplayedInstruction() const;
-    int FindNextUnplayedInstructionAfter(int index) const;
-    void SetNextInstruction();
-    bool IsTimeToPlayNextInstruction() const;
 
     // DPI 相关函数
     void UpdateDpiInfo();
@@ -90,7 +113,12 @@ private:
 
     // 辅助函数
     static constexpr int TIMER_ID = 1;
-    static constexpr int TIMER_INTERVAL = 1000;  // 1 秒
+    static constexpr int TIMER_INTERVAL = 1000;  // 1 秒（仅刷新界面）
+    static constexpr UINT WM_ENGINE_EVENTS = WM_APP + 1;  // 播放线程有新事件待取
+    static constexpr UINT WM_METADATA_READY = WM_APP + 2; // 音频元数据后台刷新完成
+    static constexpr UINT WM_MANIFEST_REPORT = WM_APP + 3; // audio 目录校验有新结果（预算到点或完成）
+    static constexpr UINT WM_PREFLIGHT_REPORT = WM_APP + 4; // 完整解码预检完成
+    static constexpr UINT WM_MIRROR_READY = WM_APP + 5;     // 本机镜像同步结束（就绪或失败）
 
     // 对话框过程
     static INT_PTR CALLBACK AddSubjectDialogProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
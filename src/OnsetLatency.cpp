@@ -0,0 +1,296 @@
+#include "OnsetLatency.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include "Clock.h"
+
+using namespace std::chrono;
+
+namespace {
+constexpr double kLastBucketBound = 16384.0;  // 16 秒以上归入最后一桶
+
+double toMs(system_clock::duration d) {
+    return duration<double, std::milli>(d).count();
+}
+
+std::string formatClock(system_clock::time_point timePoint) {
+    std::tm tm = toLocalTm(system_clock::to_time_t(timePoint));
+    auto ms = duration_cast<milliseconds>(timePoint.time_since_epoch()).count() % 1000;
+    if (ms < 0) ms += 1000;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%03d", tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms));
+    return buf;
+}
+
+struct StageHistograms {
+    LatencyHistogram compensation;
+    LatencyHistogram fire;
+    LatencyHistogram create;
+    LatencyHistogram output;
+    LatencyHistogram onset;
+    size_t automatic = 0;
+    size_t manual = 0;
+    size_t unknownOnset = 0;
+
+    void add(const OnsetSample& sample) {
+        ++(sample.manual ? manual : automatic);
+        if (!sample.manual) {
+            fire.add(sample.fireMs());
+            if (!sample.chained) {
+                compensation.add(sample.compensationMs);
+            }
+        }
+        create.add(sample.createMs());
+        if (!sample.audibleKnown) {
+            ++unknownOnset;
+            return;
+        }
+        output.add(sample.outputMs());
+        if (!sample.manual) {
+            onset.add(sample.onsetMs());
+        }
+    }
+};
+
+void appendStage(std::string& out, const char* label, const LatencyHistogram& histogram) {
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "%-8s %6zu %10.3f %10.3f %10.3f %10.3f\n", label, histogram.count(),
+                  histogram.percentile(50), histogram.percentile(99), histogram.max(), histogram.mean());
+    out += buf;
+}
+
+void appendSection(std::string& out, const std::string& title, const StageHistograms& stages) {
+    char buf[200];
+    std::snprintf(buf, sizeof(buf), "== %s：自动 %zu 次，手动 %zu 次，出声时刻未知 %zu 次\n", title.c_str(),
+                  stages.automatic, stages.manual, stages.unknownOnset);
+    out += buf;
+    out += "阶段       次数        p50        p99        max       平均\n";
+    appendStage(out, "补偿", stages.compensation);
+    appendStage(out, "调度", stages.fire);
+    appendStage(out, "建流", stages.create);
+    appendStage(out, "出声", stages.output);
+    appendStage(out, "总计", stages.onset);
+
+    out += "总计分布:";
+    double lower = 0.0;
+    for (const auto& bucket : stages.onset.buckets()) {
+        if (bucket.second > 0) {
+            if (bucket.first <= 0.0) {
+                std::snprintf(buf, sizeof(buf), " <0:%zu", bucket.second);
+            } else if (std::isinf(bucket.first)) {
+                std::snprintf(buf, sizeof(buf), " >=%.0f:%zu", lower, bucket.second);
+            } else {
+                std::snprintf(buf, sizeof(buf), " [%.0f,%.0f):%zu", lower, bucket.first, bucket.second);
+            }
+            out += buf;
+        }
+        lower = std::max(bucket.first, 0.0);
+    }
+    out += "\n";
+}
+}  // namespace
+
+double OnsetSample::fireMs() const {
+    return toMs(fired - scheduled);
+}
+
+double OnsetSample::createMs() const {
+    return toMs(created - fired);
+}
+
+double OnsetSample::outputMs() const {
+    return audibleKnown ? toMs(audible - created) : 0.0;
+}
+
+double OnsetSample::onsetMs() const {
+    return audibleKnown ? toMs(audible - scheduled) : 0.0;
+}
+
+void LatencyHistogram::sort() const {
+    if (!m_sorted) {
+        std::sort(m_samples.begin(), m_samples.end());
+        m_sorted = true;
+    }
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    sort();
+    double rank = std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(m_samples.size()));
+    size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    return m_samples[std::min(index, m_samples.size() - 1)];
+}
+
+double LatencyHistogram::max() const {
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    sort();
+    return m_samples.back();
+}
+
+double LatencyHistogram::mean() const {
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double value : m_samples) {
+        sum += value;
+    }
+    return sum / static_cast<double>(m_samples.size());
+}
+
+std::vector<std::pair<double, size_t>> LatencyHistogram::buckets() const {
+    std::vector<std::pair<double, size_t>> result;
+    result.emplace_back(0.0, 0);
+    for (double bound = 1.0; bound <= kLastBucketBound; bound *= 2.0) {
+        result.emplace_back(bound, 0);
+    }
+    result.emplace_back(std::numeric_limits<double>::infinity(), 0);
+    for (double value : m_samples) {
+        auto it = std::upper_bound(result.begin(), result.end(), value,
+                                   [](double v, const std::pair<double, size_t>& bucket) { return v < bucket.first; });
+        if (it == result.end()) {
+            --it;
+        }
+        ++it->second;
+    }
+    return result;
+}
+
+void OnsetLatencyRecorder::clear() {
+    m_samples.clear();
+    m_pending = false;
+    m_touchedSubjects.clear();
+}
+
+void OnsetLatencyRecorder::recordPlay(OnsetSample sample, bool awaitOnset) {
+    m_samples.push_back(std::move(sample));
+    m_pending = awaitOnset;
+}
+
+void OnsetLatencyRecorder::resolvePending(AudioSink& sink, system_clock::time_point now) {
+    if (!m_pending || m_samples.empty()) {
+        return;
+    }
+    OnsetSample& last = m_samples.back();
+    double delayMs = 0.0;
+    if (sink.getOnsetDelayMs(delayMs)) {
+        last.audible = last.created + duration_cast<system_clock::duration>(duration<double, std::milli>(delayMs));
+        last.audibleKnown = true;
+        m_pending = false;
+        if (!last.manual && !last.chained) {
+            sink.recordOnsetMeasurement();
+        }
+    } else if (now - last.created > ONSET_TIMEOUT) {
+        m_pending = false;
+    }
+}
+
+void OnsetLatencyRecorder::abandonPending() {
+    m_pending = false;
+}
+
+void OnsetLatencyRecorder::noteProgress(int subjectId) {
+    m_touchedSubjects.insert(subjectId);
+}
+
+bool OnsetLatencyRecorder::takeReportDue(const InstructionTable& instructions) {
+    if (m_pending || m_touchedSubjects.empty()) {
+        return false;
+    }
+    std::set<int> unfinished;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        if (instructions.status(i) == PlaybackStatus::UNPLAYED) {
+            unfinished.insert(instructions.subjectId(i));
+        }
+    }
+    bool due = false;
+    for (int subjectId : m_touchedSubjects) {
+        if (unfinished.count(subjectId)) {
+            continue;
+        }
+        due = due || std::any_of(m_samples.begin(), m_samples.end(),
+                                 [subjectId](const OnsetSample& sample) { return sample.subjectId == subjectId; });
+    }
+    m_touchedSubjects.clear();
+    return due;
+}
+
+std::string OnsetLatencyRecorder::formatReport() const {
+    std::string out = "# EVCS 起播延迟报告（毫秒）\n"
+                      "# 调度 = 决策 - 计划，建流 = play() 返回 - 决策，出声 = 首帧出声 - play() 返回，"
+                      "总计 = 首帧出声 - 计划\n"
+                      "# 补偿 = 按输出延迟提前起播的量：调度为负即提前决策，总计为补偿后的残余误差\n"
+                      "# 手动播放只计入建流/出声\n"
+                      "# 接续指令的计划时刻为上一条实际播完的时刻，总计即交接间隙；已在上一条结束处接上的出声为负\n\n";
+
+    // 按首次起播的先后排列科目
+    std::vector<int> order;
+    std::map<int, std::string> names;
+    std::map<int, StageHistograms> bySubject;
+    StageHistograms overall;
+    for (const auto& sample : m_samples) {
+        if (!bySubject.count(sample.subjectId)) {
+            order.push_back(sample.subjectId);
+            names[sample.subjectId] = sample.subjectName;
+        }
+        bySubject[sample.subjectId].add(sample);
+        overall.add(sample);
+    }
+
+    char buf[160];
+    for (int subjectId : order) {
+        appendSection(out, names[subjectId], bySubject[subjectId]);
+        out += "明细:\n";
+        for (const auto& sample : m_samples) {
+            if (sample.subjectId != subjectId) {
+                continue;
+            }
+            std::string when = sample.manual ? "手动        " : formatClock(sample.scheduled);
+            std::snprintf(buf, sizeof(buf), "  %s  补偿 %8.3f  调度 %8.3f  建流 %8.3f  出声 ", when.c_str(),
+                          sample.compensationMs, sample.manual ? 0.0 : sample.fireMs(), sample.createMs());
+            out += buf;
+            if (sample.audibleKnown) {
+                std::snprintf(buf, sizeof(buf), "%8.3f  总计 %8.3f", sample.outputMs(),
+                              sample.manual ? 0.0 : sample.onsetMs());
+            } else {
+                std::snprintf(buf, sizeof(buf), "%8s  总计 %8s", "未知", "未知");
+            }
+            out += buf;
+            out += "  " + sample.instructionName + " (" + sample.audioFile + ")";
+            out += sample.chained ? "  [接续]\n" : "\n";
+        }
+        out += "\n";
+    }
+    appendSection(out, "全部科目", overall);
+    return out;
+}
+
+bool OnsetLatencyRecorder::writeReport(const std::filesystem::path& path) const {
+    // 先写临时文件再替换，考试中途被关机也不会留下半截报告
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << formatReport();
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AudioSink.h"
+#include "InstructionTable.h"
+
+// 一次起播的各阶段时刻（均为会话 Clock 时间）
+struct OnsetSample {
+    int subjectId = 0;
+    std::string subjectName;
+    std::string instructionName;
+    std::string audioFile;
+    bool manual = false;                               // 手动播放没有计划时刻，不计入调度/总延迟
+    bool chained = false;                              // 接续指令：计划时刻为上一条实际播完的时刻，总计即交接间隙
+    std::chrono::system_clock::time_point scheduled;   // 指令计划时刻
+    double compensationMs = 0.0;                       // 按输出延迟提前起播的毫秒数（仅自动按时刻播放）
+    std::chrono::system_clock::time_point fired;       // 会话做出播放决策的时刻
+    std::chrono::system_clock::time_point created;     // 输出端 play() 返回（建流并交给混音器）
+    std::chrono::system_clock::time_point audible;     // 首帧实际出声
+    bool audibleKnown = false;                         // 输出端不能测量或超时未出声时为 false
+
+    double fireMs() const;     // fired - scheduled
+    double createMs() const;   // created - fired
+    double outputMs() const;   // audible - created
+    double onsetMs() const;    // audible - scheduled
+};
+
+// 延迟分布：保留全部样本（每场考试几十条），给出精确分位数与按 2 的幂分桶的直方图
+class LatencyHistogram {
+public:
+    void add(double ms) { m_samples.push_back(ms); m_sorted = false; }
+    size_t count() const { return m_samples.size(); }
+    // 最近秩分位数，p 取 [0,100]；无样本返回 0
+    double percentile(double p) const;
+    double max() const;
+    double mean() const;
+    // 分桶 [上界, 计数]：<0、[0,1)、[1,2)、[2,4) ... ms，最后一桶收纳其余
+    std::vector<std::pair<double, size_t>> buckets() const;
+
+private:
+    void sort() const;
+
+    mutable std::vector<double> m_samples;
+    mutable bool m_sorted = true;
+};
+
+// 起播延迟记录：ExamSession 在每次起播成功后登记计划/决策/建流时刻，
+// 随后（完成检测轮询、下一次起播前）向输出端补齐出声时刻。
+// 某科目的指令全部处理完（无未播放）且出声时刻已补齐时，takeReportDue() 返回 true，
+// 拥有者据此写出报告（每科一节 + 全天汇总）。非线程安全：与会话同一线程使用。
+class OnsetLatencyRecorder {
+public:
+    // 出声时刻的等待上限：超过仍未出声（或输出端已换成下一路）记为未知
+    static constexpr std::chrono::seconds ONSET_TIMEOUT{2};
+
+    void clear();
+    // 登记一次起播；awaitOnset 为 false（输出端不能测量）时不等待出声时刻
+    void recordPlay(OnsetSample sample, bool awaitOnset);
+    // 尝试补齐最近一次起播的出声时刻；超时放弃。补齐的是按时刻起播（非手动、非接续）的指令时，
+    // 通知输出端记一次出声观测（AudioSink::recordOnsetMeasurement），每条指令只通知一次
+    void resolvePending(AudioSink& sink, std::chrono::system_clock::time_point now);
+    // 在下一次起播前调用：最近一次若仍未出声，不再等待
+    void abandonPending();
+    // 某科目有指令状态变化（播放/跳过/过期），之后检查该科是否结束
+    void noteProgress(int subjectId);
+    // 有科目结束且出声时刻均已确定时返回 true（每次结束只返回一次）
+    bool takeReportDue(const InstructionTable& instructions);
+
+    const std::vector<OnsetSample>& samples() const { return m_samples; }
+    bool isPending() const { return m_pending; }
+
+    // 报告文本：每科一节（阶段 count/p50/p99/max 与总延迟直方图、逐条明细）+ 全部科目汇总
+    std::string formatReport() const;
+    bool writeReport(const std::filesystem::path& path) const;
+
+private:
+    std::vector<OnsetSample> m_samples;
+    bool m_pending = false;
+    std::set<int> m_touchedSubjects;
+};
@@ -0,0 +1,65 @@
+#include "OutputLatency.h"
+#include <cmath>
+#include <cstdio>
+
+void OutputLatencyProfiles::select(const std::string& devices, double deviceMs, double queueMs) {
+    OutputLatencyProfile& profile = m_profiles[devices];
+    if (std::fabs(profile.deviceMs - deviceMs) > ESTIMATE_TOLERANCE_MS ||
+        std::fabs(profile.queueMs - queueMs) > ESTIMATE_TOLERANCE_MS) {
+        profile.measuredMs = 0.0;
+        profile.jitterMs = 0.0;
+        profile.samples = 0;
+    }
+    profile.devices = devices;
+    profile.deviceMs = deviceMs;
+    profile.queueMs = queueMs;
+    m_current = &profile;
+}
+
+void OutputLatencyProfiles::clear() {
+    m_profiles.clear();
+    m_current = nullptr;
+}
+
+bool OutputLatencyProfiles::addMeasurement(double ms) {
+    if (!m_current || !(ms >= 0.0) || ms > MAX_LATENCY_MS) {
+        return false;
+    }
+    OutputLatencyProfile& profile = *m_current;
+    if (profile.samples == 0) {
+        profile.measuredMs = ms;
+    } else {
+        const double deviation = ms - profile.measuredMs;
+        profile.measuredMs += SMOOTHING * deviation;
+        profile.jitterMs += SMOOTHING * (std::fabs(deviation) - profile.jitterMs);
+    }
+    ++profile.samples;
+    return true;
+}
+
+const OutputLatencyProfile& OutputLatencyProfiles::current() const {
+    static const OutputLatencyProfile kEmpty;
+    return m_current ? *m_current : kEmpty;
+}
+
+std::vector<OutputLatencyProfile> OutputLatencyProfiles::all() const {
+    std::vector<OutputLatencyProfile> result;
+    for (const auto& entry : m_profiles) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+std::string OutputLatencyProfiles::formatProfile(const OutputLatencyProfile& profile) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "输出延迟 %s: 提前 %.1f ms = 设备 %.1f + 排队 %.1f",
+                  profile.devices.empty() ? "默认设备" : profile.devices.c_str(), profile.estimateMs(),
+                  profile.deviceMs, profile.queueMs);
+    std::string text = buf;
+    if (profile.samples > 0) {
+        std::snprintf(buf, sizeof(buf), "，起播观测 %.1f ± %.1f ms（%zu 次）", profile.measuredMs, profile.jitterMs,
+                      profile.samples);
+        text += buf;
+    }
+    return text;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// 一组输出设备的延迟档案：声部交给混音器到首帧实际出声的时长。
+// 起播提前量 = 后端报告的设备延迟 + 混音排队量（含半块），没有独立的回环/录音测量。
+// 起播观测取混音器渲染首块的时刻加上同一个设备延迟，只能反映排队与调度的偏差，因此只作诊断，不反馈进提前量
+struct OutputLatencyProfile {
+    std::string devices;        // 设备选择（| 分隔），空为默认设备
+    double deviceMs = 0.0;      // 后端报告的设备延迟（BASS_INFO.latency；多台设备为扇出对齐到的最大值）
+    double queueMs = 0.0;       // 混音器维持的排队量 + 等到下一次补写的平均半块
+    double measuredMs = 0.0;    // 起播观测（play() 到首块渲染 + 设备延迟）的指数滑动平均
+    double jitterMs = 0.0;      // 观测相对滑动平均的平均绝对偏差
+    size_t samples = 0;
+
+    // 估计的输出延迟，即会话的起播提前量
+    double estimateMs() const { return deviceMs + queueMs; }
+};
+
+// 各组输出设备的延迟档案。换设备时保留之前设备的起播观测，换回来接着累计。
+// 非线程安全：由 AudioPlayer 在 s_mutex 下使用
+class OutputLatencyProfiles {
+public:
+    static constexpr double SMOOTHING = 0.2;          // 指数滑动平均的新样本权重
+    static constexpr double MAX_LATENCY_MS = 500.0;   // 超过的观测视为异常（渲染卡顿、设备挂起）丢弃
+    static constexpr double ESTIMATE_TOLERANCE_MS = 1.0; // 估计值变化超过此值视为换了设备
+
+    // 打开输出后调用：切换到该组设备的档案（没有则新建），更新估计值。
+    // 设备报告的延迟或排队量变了（换了声卡、驱动或缓冲设置）时之前的观测作废
+    void select(const std::string& devices, double deviceMs, double queueMs);
+    void clear();
+    // 记入当前档案，异常值返回 false
+    bool addMeasurement(double ms);
+    // 未打开输出时为空档案
+    const OutputLatencyProfile& current() const;
+    std::vector<OutputLatencyProfile> all() const;
+
+    // 一行摘要：设备、提前量的组成与起播观测
+    static std::string formatProfile(const OutputLatencyProfile& profile);
+
+private:
+    std::map<std::string, OutputLatencyProfile> m_profiles;
+    OutputLatencyProfile* m_current = nullptr;
+};
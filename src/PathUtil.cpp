@@ -1,14 +1,30 @@
 #include "PathUtil.h"
 #include "StringUtil.h"
+#include <mutex>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 namespace {
 // audio 子目录用宽字符字面量，避免与宽字符 path 拼接时触发 locale 依赖转换。
 constexpr const wchar_t* AUDIO_DIR = L"audio";
 constexpr const wchar_t* CONFIG_DIR = L"config";
+
+// audio 目录的覆盖与镜像：播放线程、后台刷新与界面线程都会读取，镜像在后台拷贝完成后切换
+struct AudioDirState {
+    std::mutex mutex;
+    std::filesystem::path overrideDir;
+    std::filesystem::path mirrorDir;
+};
+
+AudioDirState& audioDirState() {
+    static AudioDirState state;
+    return state;
+}
 }  // namespace
 
 std::filesystem::path PathUtil::getAppDir() {
+#ifdef _WIN32
     wchar_t exePath[MAX_PATH];
     DWORD len = GetModuleFileNameW(NULL, exePath, MAX_PATH);
     if (len == 0 || len >= MAX_PATH) {
@@ -16,15 +32,100 @@ std::filesystem::path PathUtil::getAppDir() {
         return std::filesystem::path();
     }
     return std::filesystem::path(exePath).parent_path();
+#else
+    std::error_code ec;
+    std::filesystem::path exePath = std::filesystem::read_symlink("/proc/self/exe", ec);
+    if (ec) {
+        return std::filesystem::path();
+    }
+    return exePath.parent_path();
+#endif
+}
+
+std::filesystem::path PathUtil::getAudioDir() {
+    {
+        AudioDirState& state = audioDirState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.mirrorDir.empty()) {
+            return state.mirrorDir;
+        }
+    }
+    return getAudioSourceDir();
+}
+
+std::filesystem::path PathUtil::getAudioSourceDir() {
+    {
+        AudioDirState& state = audioDirState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.overrideDir.empty()) {
+            return state.overrideDir;
+        }
+    }
+    return getAppDir() / AUDIO_DIR;
+}
+
+void PathUtil::setAudioDir(const std::filesystem::path& dir) {
+    AudioDirState& state = audioDirState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.overrideDir = dir;
+}
+
+void PathUtil::setAudioMirror(const std::filesystem::path& dir) {
+    AudioDirState& state = audioDirState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.mirrorDir = dir;
+}
+
+std::filesystem::path PathUtil::getAudioMirror() {
+    AudioDirState& state = audioDirState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.mirrorDir;
+}
+
+bool PathUtil::isRemovableMedia(const std::filesystem::path& path) {
+#ifdef _WIN32
+    // 取卷根（C:\ 或 \\server\share\）判断驱动器类型
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::absolute(path, ec).root_path();
+    if (ec || root.empty()) {
+        return false;
+    }
+    UINT type = GetDriveTypeW(root.c_str());
+    return type == DRIVE_REMOVABLE || type == DRIVE_CDROM || type == DRIVE_REMOTE;
+#else
+    (void)path;
+    return false;
+#endif
 }
 
 std::filesystem::path PathUtil::getAudioPath(const std::string& filename) {
+#ifdef _WIN32
     // filename 为 UTF-8 字节串（来自 INI），必须先显式转宽字符再拼接，
     // 否则 path 的 operator/ 接受 std::string 时会走 locale 依赖转换，
     // 导致中文文件名错码（不变量 §5 + 中文路径一等公民）。
-    return getAppDir() / AUDIO_DIR / StringUtil::utf8ToWide(filename);
+    return getAudioDir() / StringUtil::utf8ToWide(filename);
+#else
+    // POSIX 原生路径即 UTF-8 字节串，直接拼接
+    return getAudioDir() / filename;
+#endif
 }
 
 std::filesystem::path PathUtil::getConfigPath(const std::wstring& filename) {
-    return getAppDir() / CONFIG_DIR / filename;
+    return getAppDir() / CONFIG_DIR / fromWide(filename);
+}
+
+std::filesystem::path PathUtil::fromWide(const std::wstring& widePath) {
+#ifdef _WIN32
+    return std::filesystem::path(widePath);
+#else
+    return std::filesystem::path(StringUtil::wideToUtf8(widePath));
+#endif
+}
+
+std::wstring PathUtil::toWide(const std::filesystem::path& path) {
+#ifdef _WIN32
+    return path.wstring();
+#else
+    return StringUtil::utf8ToWide(path.string());
+#endif
 }
@@ -14,4 +14,22 @@ public:
 
     // 获取 config 子目录下的完整路径
     static std::filesystem::path getConfigPath(const std::wstring& filename);
+
+    // 覆盖 audio 目录（模拟器/工具指定外部素材目录用）；传空 path 恢复默认
+    static void setAudioDir(const std::filesystem::path& dir);
+    // 当前取音频的目录：设置了本机镜像时为镜像，否则为 getAudioSourceDir()。可在任意线程调用
+    static std::filesystem::path getAudioDir();
+
+    // 源素材目录（setAudioDir 的覆盖或程序目录下的 audio），不经镜像重定向
+    static std::filesystem::path getAudioSourceDir();
+    // 本机镜像（AudioMirror 校验通过后设置）：getAudioDir()/getAudioPath() 改指向 dir，传空 path 回到源目录
+    static void setAudioMirror(const std::filesystem::path& dir);
+    static std::filesystem::path getAudioMirror();
+    // path 是否在可移动介质（U 盘、存储卡、光盘）或网络驱动器上。仅 Windows 能判断，其他平台返回 false
+    static bool isRemovableMedia(const std::filesystem::path& path);
+
+    // 宽字符串与 path 互转。POSIX 下 path(wstring) 依赖进程 locale，
+    // 中文会抛 filesystem_error，故统一经 UTF-8 中转
+    static std::filesystem::path fromWide(const std::wstring& widePath);
+    static std::wstring toWide(const std::filesystem::path& path);
 };
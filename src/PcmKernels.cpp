@@ -0,0 +1,311 @@
+#include "PcmKernels.h"
+#include <cmath>
+#include <cstring>
+
+#ifdef EVCS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr float kInt16Scale = 1.0f / 32768.0f;
+
+// 与 SIMD 的 max/min 同一写法：NaN 落到下限，各级别结果一致
+inline float clampUnit(float x) {
+    x = x > -1.0f ? x : -1.0f;
+    return x < 1.0f ? x : 1.0f;
+}
+
+// ---- 标量参考 ----
+
+void int16ToFloatScalar(const int16_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        int16_t value;
+        std::memcpy(&value, in + i, sizeof(value));
+        out[i] = static_cast<float>(value) * kInt16Scale;
+    }
+}
+
+void floatToInt16Scalar(const float* in, int16_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const int16_t value = static_cast<int16_t>(std::lrint(clampUnit(in[i]) * 32767.0f));
+        std::memcpy(out + i, &value, sizeof(value));
+    }
+}
+
+void scaleScalar(float* samples, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] *= gain;
+    }
+}
+
+void mixAddScalar(float* out, const float* in, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] += in[i] * gain;
+    }
+}
+
+void mixAddRampScalar(float* out, const float* in, size_t frames, float startGain, float step) {
+    for (size_t i = 0; i < frames; ++i) {
+        const float gain = startGain + step * static_cast<float>(i);
+        out[i * 2] += in[i * 2] * gain;
+        out[i * 2 + 1] += in[i * 2 + 1] * gain;
+    }
+}
+
+void clampScalar(float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = clampUnit(samples[i]);
+    }
+}
+
+void monoToStereoScalar(const float* in, float* out, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        out[i * 2] = out[i * 2 + 1] = in[i];
+    }
+}
+
+void stereoToMonoScalar(const float* in, float* out, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        out[i] = (in[i * 2] + in[i * 2 + 1]) * 0.5f;
+    }
+}
+
+#ifdef EVCS_X86
+// ---- SSE2：每次 4 个 float（int16 每次 8 个），零头交给标量 ----
+
+EVCS_TARGET_SSE2 void int16ToFloatSse2(const int16_t* in, float* out, size_t count) {
+    const __m128 scale = _mm_set1_ps(kInt16Scale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // 复制到高半字后算术右移，即符号扩展为 32 位
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+
+EVCS_TARGET_SSE2 void floatToInt16Sse2(const float* in, int16_t* out, size_t count) {
+    const __m128 lower = _mm_set1_ps(-1.0f);
+    const __m128 upper = _mm_set1_ps(1.0f);
+    const __m128 full = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lower), upper);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lower), upper);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, full)),
+                                               _mm_cvtps_epi32(_mm_mul_ps(b, full)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+
+EVCS_TARGET_SSE2 void scaleSse2(float* samples, size_t count, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+    }
+    scaleScalar(samples + i, count - i, gain);
+}
+
+EVCS_TARGET_SSE2 void mixAddSse2(float* out, const float* in, size_t count, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 sum = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), g));
+        _mm_storeu_ps(out + i, sum);
+    }
+    mixAddScalar(out + i, in + i, count - i, gain);
+}
+
+// 每次 2 帧（4 个采样），帧号向量 {f, f, f+1, f+1}
+EVCS_TARGET_SSE2 void mixAddRampSse2(float* out, const float* in, size_t frames, float startGain, float step) {
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 s = _mm_set1_ps(step);
+    const __m128 two = _mm_set1_ps(2.0f);
+    __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+    size_t i = 0;
+    for (; i + 2 <= frames; i += 2) {
+        const __m128 gain = _mm_add_ps(start, _mm_mul_ps(s, index));
+        const __m128 sum = _mm_add_ps(_mm_loadu_ps(out + i * 2), _mm_mul_ps(_mm_loadu_ps(in + i * 2), gain));
+        _mm_storeu_ps(out + i * 2, sum);
+        index = _mm_add_ps(index, two);  // 帧号在 2^24 以内逐一精确
+    }
+    for (; i < frames; ++i) {
+        const float gain = startGain + step * static_cast<float>(i);
+        out[i * 2] += in[i * 2] * gain;
+        out[i * 2 + 1] += in[i * 2 + 1] * gain;
+    }
+}
+
+EVCS_TARGET_SSE2 void clampSse2(float* samples, size_t count) {
+    const __m128 lower = _mm_set1_ps(-1.0f);
+    const __m128 upper = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), lower), upper));
+    }
+    clampScalar(samples + i, count - i);
+}
+
+EVCS_TARGET_SSE2 void monoToStereoSse2(const float* in, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 mono = _mm_loadu_ps(in + i);
+        _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(mono, mono));
+        _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(mono, mono));
+    }
+    monoToStereoScalar(in + i, out + i * 2, frames - i);
+}
+
+EVCS_TARGET_SSE2 void stereoToMonoSse2(const float* in, float* out, size_t frames) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(in + i * 2);      // L0 R0 L1 R1
+        const __m128 b = _mm_loadu_ps(in + i * 2 + 4);  // L2 R2 L3 R3
+        const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+    }
+    stereoToMonoScalar(in + i * 2, out + i, frames - i);
+}
+
+// ---- AVX2：每次 8 个 float（int16 每次 16 个），零头交给标量 ----
+
+EVCS_TARGET_AVX2 void int16ToFloatAvx2(const int16_t* in, float* out, size_t count) {
+    const __m256 scale = _mm256_set1_ps(kInt16Scale);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        const __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(a), scale));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+
+EVCS_TARGET_AVX2 void floatToInt16Avx2(const float* in, int16_t* out, size_t count) {
+    const __m256 lower = _mm256_set1_ps(-1.0f);
+    const __m256 upper = _mm256_set1_ps(1.0f);
+    const __m256 full = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), lower), upper);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 8), lower), upper);
+        // packs 按 128 位通道交错，permute 还原顺序
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a, full)),
+                                                  _mm256_cvtps_epi32(_mm256_mul_ps(b, full)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+
+EVCS_TARGET_AVX2 void scaleAvx2(float* samples, size_t count, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+    }
+    scaleScalar(samples + i, count - i, gain);
+}
+
+EVCS_TARGET_AVX2 void mixAddAvx2(float* out, const float* in, size_t count, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 sum = _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), g));
+        _mm256_storeu_ps(out + i, sum);
+    }
+    mixAddScalar(out + i, in + i, count - i, gain);
+}
+
+// 每次 4 帧（8 个采样），帧号向量 {f, f, f+1, f+1, ..., f+3, f+3}
+EVCS_TARGET_AVX2 void mixAddRampAvx2(float* out, const float* in, size_t frames, float startGain, float step) {
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 s = _mm256_set1_ps(step);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m256 gain = _mm256_add_ps(start, _mm256_mul_ps(s, index));
+        const __m256 sum =
+            _mm256_add_ps(_mm256_loadu_ps(out + i * 2), _mm256_mul_ps(_mm256_loadu_ps(in + i * 2), gain));
+        _mm256_storeu_ps(out + i * 2, sum);
+        index = _mm256_add_ps(index, four);
+    }
+    for (; i < frames; ++i) {
+        const float gain = startGain + step * static_cast<float>(i);
+        out[i * 2] += in[i * 2] * gain;
+        out[i * 2 + 1] += in[i * 2 + 1] * gain;
+    }
+}
+
+EVCS_TARGET_AVX2 void clampAvx2(float* samples, size_t count) {
+    const __m256 lower = _mm256_set1_ps(-1.0f);
+    const __m256 upper = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(samples + i), lower), upper));
+    }
+    clampScalar(samples + i, count - i);
+}
+
+EVCS_TARGET_AVX2 void monoToStereoAvx2(const float* in, float* out, size_t frames) {
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 mono = _mm256_loadu_ps(in + i);
+        // unpack 在各 128 位通道内交错，permute2f128 拼回连续的 8 帧
+        const __m256 lo = _mm256_unpacklo_ps(mono, mono);
+        const __m256 hi = _mm256_unpackhi_ps(mono, mono);
+        _mm256_storeu_ps(out + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(out + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    monoToStereoScalar(in + i, out + i * 2, frames - i);
+}
+
+EVCS_TARGET_AVX2 void stereoToMonoAvx2(const float* in, float* out, size_t frames) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 a = _mm256_loadu_ps(in + i * 2);      // 帧 0-3
+        const __m256 b = _mm256_loadu_ps(in + i * 2 + 8);  // 帧 4-7
+        const __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        // shuffle 后顺序为 0 1 4 5 | 2 3 6 7，按 64 位重排
+        const __m256 sum = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+        _mm256_storeu_ps(out + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), 0xD8)));
+    }
+    stereoToMonoScalar(in + i * 2, out + i, frames - i);
+}
+#endif  // EVCS_X86
+
+const PcmKernels kScalar = {SimdLevel::SCALAR, int16ToFloatScalar, floatToInt16Scalar, scaleScalar, mixAddScalar,
+                            mixAddRampScalar,  clampScalar,        monoToStereoScalar, stereoToMonoScalar};
+#ifdef EVCS_X86
+const PcmKernels kSse2 = {SimdLevel::SSE2, int16ToFloatSse2, floatToInt16Sse2, scaleSse2, mixAddSse2,
+                          mixAddRampSse2,  clampSse2,        monoToStereoSse2, stereoToMonoSse2};
+const PcmKernels kAvx2 = {SimdLevel::AVX2, int16ToFloatAvx2, floatToInt16Avx2, scaleAvx2, mixAddAvx2,
+                          mixAddRampAvx2,  clampAvx2,        monoToStereoAvx2, stereoToMonoAvx2};
+#endif
+}  // namespace
+
+const PcmKernels& PcmKernels::get(SimdLevel level) {
+    if (!CpuFeatures::supports(level)) {
+        level = SimdLevel::SCALAR;
+    }
+#ifdef EVCS_X86
+    switch (level) {
+    case SimdLevel::AVX2:
+        return kAvx2;
+    case SimdLevel::SSE2:
+        return kSse2;
+    default:
+        break;
+    }
+#endif
+    return kScalar;
+}
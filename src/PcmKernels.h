@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "CpuFeatures.h"
+
+// PCM 采样内核：混音累加、增益（含块内线性过渡）、限幅、int16 <-> float 与单声道 <-> 立体声换算。
+//
+// 每个级别一张函数表，取表时按 CpuFeatures 回退到当前 CPU 支持的级别，渲染线程只做间接调用不再判断。
+// 各级别逐位一致：SIMD 内核与标量参考做同样的单次乘/加（不融合为 FMA），过渡增益按 start + step * i
+// 逐帧算出而不是累加，float -> int16 按当前舍入模式（就近取偶）取整。因此换用内核不改变输出。
+// 指针均可不对齐；int16 按小端读写（与 WAV 及 x86 一致）
+struct PcmKernels {
+    SimdLevel level;
+
+    // out[i] = in[i] / 32768
+    void (*int16ToFloat)(const int16_t* in, float* out, size_t count);
+    // out[i] = round(clamp(in[i], -1, 1) * 32767)
+    void (*floatToInt16)(const float* in, int16_t* out, size_t count);
+    // samples[i] *= gain
+    void (*scale)(float* samples, size_t count, float gain);
+    // out[i] += in[i] * gain
+    void (*mixAdd)(float* out, const float* in, size_t count, float gain);
+    // 交错立体声：第 f 帧两路都加 in * (startGain + step * f)
+    void (*mixAddRamp)(float* out, const float* in, size_t frames, float startGain, float step);
+    // samples[i] 限到 [-1, 1]
+    void (*clamp)(float* samples, size_t count);
+    // 单声道复制为交错立体声（out 须有 frames * 2 个采样；可原地展开：in 位于 out + frames 处）
+    void (*monoToStereo)(const float* in, float* out, size_t frames);
+    // 交错立体声取两路平均（out 可与 in 相同）
+    void (*stereoToMono)(const float* in, float* out, size_t frames);
+
+    // 指定级别的内核表，不支持时回退到标量
+    static const PcmKernels& get(SimdLevel level = CpuFeatures::best());
+};
@@ -0,0 +1,409 @@
+#include "PlaybackEngine.h"
+#include <algorithm>
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace std::chrono;
+
+namespace {
+int64_t toMicroseconds(system_clock::duration value) {
+    return duration_cast<microseconds>(value).count();
+}
+}  // namespace
+
+PlaybackEngine::PlaybackEngine(Clock& clock, AudioSink& sink)
+    : m_clock(clock), m_sink(sink), m_session(clock, sink),
+      m_commands(QUEUE_CAPACITY), m_events(QUEUE_CAPACITY) {
+    m_session.setListener(this);
+}
+
+PlaybackEngine::~PlaybackEngine() {
+    stop();
+}
+
+void PlaybackEngine::start() {
+    // 输出端的播完通知直接唤醒播放线程：接续指令与单路输出的下一条不等轮询周期。
+    // 通知在音频线程上持输出端的锁再取 m_wakeMutex，须在持 m_wakeMutex 之前设置，不反向嵌套
+    m_sink.setEndNotify([this] { wake(); });
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&PlaybackEngine::threadMain, this);
+}
+
+void PlaybackEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wakeCv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_sink.setEndNotify(nullptr);
+}
+
+void PlaybackEngine::wake() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeRequested = true;
+    }
+    m_wakeCv.notify_one();
+}
+
+bool PlaybackEngine::pushCommand(Command command) {
+    if (!m_commands.tryPush(std::move(command))) {
+        m_commandsRejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    wake();
+    return true;
+}
+
+bool PlaybackEngine::addInstructions(std::vector<Instruction> instructions) {
+    Command command;
+    command.type = CommandType::ADD_INSTRUCTIONS;
+    command.instructions = std::move(instructions);
+    return pushCommand(std::move(command));
+}
+
+bool PlaybackEngine::removeSubject(int subjectId) {
+    Command command;
+    command.type = CommandType::REMOVE_SUBJECT;
+    command.value = subjectId;
+    return pushCommand(std::move(command));
+}
+
+bool PlaybackEngine::regenerate(std::vector<Instruction> instructions) {
+    Command command;
+    command.type = CommandType::REGENERATE;
+    command.instructions = std::move(instructions);
+    return pushCommand(std::move(command));
+}
+
+bool PlaybackEngine::playInstruction(int index, bool isManualPlay, uint64_t generation) {
+    Command command;
+    command.type = CommandType::PLAY;
+    command.value = index;
+    command.isManualPlay = isManualPlay;
+    command.generation = generation;
+    return pushCommand(std::move(command));
+}
+
+bool PlaybackEngine::stopPlayback() {
+    Command command;
+    command.type = CommandType::STOP;
+    return pushCommand(std::move(command));
+}
+
+bool PlaybackEngine::setPrefetchLead(milliseconds lead) {
+    Command command;
+    command.type = CommandType::SET_PREFETCH_LEAD;
+    command.lead = lead;
+    return pushCommand(std::move(command));
+}
+
+bool PlaybackEngine::applyDurations(std::map<std::string, double> durations) {
+    Command command;
+    command.type = CommandType::APPLY_DURATIONS;
+    command.durations = std::move(durations);
+    return pushCommand(std::move(command));
+}
+
+size_t PlaybackEngine::drainEvents(const std::function<void(EngineEvent&)>& handler) {
+    // 先清标志再取：此后入队的事件必然再触发一次 notify，不会滞留
+    m_notifyPending.store(false);
+    size_t count = 0;
+    EngineEvent event;
+    while (m_events.tryPop(event)) {
+        ++count;
+        handler(event);
+        event = EngineEvent();
+    }
+    return count;
+}
+
+EngineStats PlaybackEngine::getStats() const {
+    EngineStats stats;
+    stats.wakeups = m_wakeups.load(std::memory_order_relaxed);
+    stats.commands = m_commandCount.load(std::memory_order_relaxed);
+    stats.eventsPublished = m_eventsPublished.load(std::memory_order_relaxed);
+    stats.eventsDropped = m_eventsDropped.load(std::memory_order_relaxed);
+    stats.commandsRejected = m_commandsRejected.load(std::memory_order_relaxed);
+    stats.lastDueLatenessMs = m_lastDueLatenessUs.load(std::memory_order_relaxed) / 1000.0;
+    stats.maxDueLatenessMs = m_maxDueLatenessUs.load(std::memory_order_relaxed) / 1000.0;
+    stats.latencyReports = m_latencyReports.load(std::memory_order_relaxed);
+    stats.outputCompensationMs = m_outputCompensationUs.load(std::memory_order_relaxed) / 1000.0;
+    stats.lastResidualMs = m_lastResidualUs.load(std::memory_order_relaxed) / 1000.0;
+    stats.maxResidualMs = m_maxResidualUs.load(std::memory_order_relaxed) / 1000.0;
+    stats.residualSamples = m_residualSamples.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PlaybackEngine::onSessionEvent(const SessionEvent& event) {
+    // 接续指令没有到点时刻，不计入到点迟到量（其交接间隙见起播延迟报告）
+    if (event.type == SessionEventType::PLAYED && !event.isManualPlay &&
+        !m_session.getInstructions().chained(event.index)) {
+        int64_t lateUs = toMicroseconds(event.time - (m_session.getInstructions().playTime(event.index) -
+                                                      m_session.getStartLead()));
+        m_lastDueLatenessUs.store(lateUs, std::memory_order_relaxed);
+        if (lateUs > m_maxDueLatenessUs.load(std::memory_order_relaxed)) {
+            m_maxDueLatenessUs.store(lateUs, std::memory_order_relaxed);
+        }
+    }
+    m_pendingEvents.push_back(event);
+}
+
+bool PlaybackEngine::processCommands(bool& structural) {
+    bool changed = false;
+    Command command;
+    while (m_commands.tryPop(command)) {
+        m_commandCount.fetch_add(1, std::memory_order_relaxed);
+        changed = true;
+        switch (command.type) {
+            case CommandType::ADD_INSTRUCTIONS:
+                m_session.addInstructions(command.instructions);
+                ++m_generation;
+                structural = true;
+                break;
+            case CommandType::REMOVE_SUBJECT:
+                m_session.removeSubject(command.value);
+                ++m_generation;
+                structural = true;
+                break;
+            case CommandType::REGENERATE:
+                m_session.regenerate(command.instructions);
+                ++m_generation;
+                structural = true;
+                break;
+            case CommandType::PLAY:
+                if (command.generation == m_generation) {
+                    m_session.playInstruction(command.value, command.isManualPlay);
+                } else {
+                    // 界面按旧快照点选：行号已失效，不播放，推送整表让界面重建
+                    m_resyncPending = true;
+                }
+                break;
+            case CommandType::STOP:
+                m_session.stopPlayback();
+                break;
+            case CommandType::SET_PREFETCH_LEAD:
+                m_prefetchLead = std::max(command.lead, milliseconds::zero());
+                m_prefetchedIndex = -1;
+                break;
+            case CommandType::APPLY_DURATIONS:
+                // 行集合不变（版本不变），但时长列全表更新，界面整表重建
+                m_session.applyDurations(command.durations);
+                structural = true;
+                break;
+        }
+        command = Command();
+    }
+    return changed;
+}
+
+void PlaybackEngine::prefetchIfDue() {
+    const auto& instructions = m_session.getInstructions();
+    const int next = m_session.getNextInstructionIndex();
+    if (m_prefetchLead <= milliseconds::zero() || next < 0 ||
+        static_cast<size_t>(next) >= instructions.size() ||
+        instructions.status(next) != PlaybackStatus::UNPLAYED) {
+        return;
+    }
+    if (m_prefetchedGeneration == m_generation && m_prefetchedIndex == next) {
+        return;
+    }
+
+    // 已进入精等待窗口（含已过期）的不再预热，避免推迟起播
+    auto remaining = instructions.playTime(next) - m_session.getStartLead() - m_clock.now();
+    if (remaining > m_prefetchLead) {
+        return;
+    }
+    m_prefetchedGeneration = m_generation;
+    m_prefetchedIndex = next;
+    if (remaining > SPIN_WINDOW) {
+        m_sink.prepare(instructions.audioFile(next));
+    }
+}
+
+void PlaybackEngine::publish(bool structural) {
+    auto view = std::make_shared<SessionView>();
+    view->instructions = m_session.getInstructions();
+    view->currentPlayingIndex = m_session.getCurrentPlayingIndex();
+    view->nextInstructionIndex = m_session.getNextInstructionIndex();
+    view->currentPlayingStartTime = m_session.getCurrentPlayingStartTime();
+    view->generation = m_generation;
+    std::shared_ptr<const SessionView> shared = std::move(view);
+
+    structural = structural || m_resyncPending;
+    m_resyncPending = false;
+
+    auto push = [this, &shared](EngineEvent&& event) {
+        event.view = shared;
+        if (m_events.tryPush(std::move(event))) {
+            m_eventsPublished.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // 界面长时间未取：丢弃本条，下一次发布带整表快照补齐
+            m_eventsDropped.fetch_add(1, std::memory_order_relaxed);
+            m_resyncPending = true;
+        }
+    };
+
+    if (m_pendingEvents.empty()) {
+        EngineEvent event;
+        event.structural = structural;
+        push(std::move(event));
+    }
+    for (size_t i = 0; i < m_pendingEvents.size(); ++i) {
+        EngineEvent event;
+        event.hasSessionEvent = true;
+        event.sessionEvent = m_pendingEvents[i];
+        event.structural = structural && i == 0;
+        push(std::move(event));
+    }
+    m_pendingEvents.clear();
+
+    if (m_notify && !m_notifyPending.exchange(true)) {
+        m_notify();
+    }
+}
+
+void PlaybackEngine::waitForWork() {
+    const auto now = m_clock.now();
+    const auto due = m_session.getNextDueTime();
+
+    // 非到点的唤醒：预热时刻、播放完成检测、丢事件后的重同步
+    auto other = now + duration_cast<system_clock::duration>(MAX_SLEEP);
+    const auto& instructions = m_session.getInstructions();
+    const int next = m_session.getNextInstructionIndex();
+    if (m_prefetchLead > milliseconds::zero() && next >= 0 &&
+        static_cast<size_t>(next) < instructions.size() &&
+        instructions.status(next) == PlaybackStatus::UNPLAYED &&
+        !(m_prefetchedGeneration == m_generation && m_prefetchedIndex == next)) {
+        other = std::min(other, instructions.playTime(next) - m_session.getStartLead() - m_prefetchLead);
+    }
+    const int playing = m_session.getCurrentPlayingIndex();
+    if (playing >= 0 || m_resyncPending) {
+        other = std::min(other, now + duration_cast<system_clock::duration>(COMPLETION_POLL));
+    }
+    if (playing >= 0 && static_cast<size_t>(playing) < instructions.size()) {
+        // 按起播时刻 + 时长在预计结束点醒来，单路输出的下一条不必等满一个轮询周期
+        double seconds = instructions.cachedDurationSeconds(playing);
+        auto expectedEnd = m_session.getCurrentPlayingStartTime() +
+                           duration_cast<system_clock::duration>(duration<double>(seconds));
+        if (seconds > 0.0 && expectedEnd > now) {
+            other = std::min(other, expectedEnd);
+        }
+    }
+
+    if (due != system_clock::time_point::max() && due <= other) {
+        auto remaining = due - now;
+        if (remaining <= system_clock::duration::zero()) {
+            return;
+        }
+        if (remaining <= SPIN_WINDOW) {
+            // 精等待：短睡/让出到墙钟真正到达 playTime（期间到来的命令顺延至多 SPIN_WINDOW）
+            while (true) {
+                auto left = due - m_clock.now();
+                if (left <= system_clock::duration::zero()) {
+                    break;
+                }
+                if (left > milliseconds(2)) {
+                    std::this_thread::sleep_for(milliseconds(1));
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            m_wakeups.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        other = due - SPIN_WINDOW;
+    }
+
+    // 粗等待：steady_clock 截止点由墙钟换算，每轮醒来重新锚定
+    auto sleepFor = std::max(other - now, system_clock::duration::zero());
+    auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(sleepFor);
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wakeCv.wait_until(lock, deadline, [this] { return m_wakeRequested || !m_running; });
+    m_wakeRequested = false;
+    m_wakeups.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PlaybackEngine::threadMain() {
+#ifdef _WIN32
+    // 播放决策优先于界面：界面线程卡顿时本线程仍能按时起播
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#endif
+    publish(true);
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            if (!m_running) {
+                break;
+            }
+        }
+
+        bool structural = false;
+        bool changed = processCommands(structural);
+        // 先检测播放完成，再做过期判定与自动播放；到点的多条指令逐轮播放
+        changed = m_session.checkPlaybackCompletion() || changed;
+        changed = m_session.updateNextInstruction() || changed;
+        if (changed || !m_pendingEvents.empty() || m_resyncPending) {
+            publish(structural);
+        }
+        prefetchIfDue();
+        updateResidualStats();
+        if (m_session.getLatency().takeReportDue(m_session.getInstructions())) {
+            writeLatencyReport();
+        }
+        if (!changed) {
+            waitForWork();
+        }
+    }
+
+    m_session.stopPlayback();
+    m_session.getLatency().resolvePending(m_sink, m_clock.now());
+    if (!m_session.getLatency().samples().empty()) {
+        writeLatencyReport();
+    }
+}
+
+void PlaybackEngine::updateResidualStats() {
+    m_outputCompensationUs.store(toMicroseconds(m_session.getStartLead()), std::memory_order_relaxed);
+    const OnsetLatencyRecorder& latency = m_session.getLatency();
+    const auto& samples = latency.samples();
+    if (m_residualIndex > samples.size()) {
+        m_residualIndex = 0;  // 记录被清空
+    }
+    // 最后一条仍在等出声时刻时留到下一轮
+    const size_t resolved = latency.isPending() ? samples.size() - 1 : samples.size();
+    for (; m_residualIndex < resolved; ++m_residualIndex) {
+        const OnsetSample& sample = samples[m_residualIndex];
+        if (sample.manual || sample.chained || !sample.audibleKnown) {
+            continue;
+        }
+        const int64_t residualUs = toMicroseconds(sample.audible - sample.scheduled);
+        m_lastResidualUs.store(residualUs, std::memory_order_relaxed);
+        if (std::abs(residualUs) > m_maxResidualUs.load(std::memory_order_relaxed)) {
+            m_maxResidualUs.store(std::abs(residualUs), std::memory_order_relaxed);
+        }
+        m_residualSamples.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PlaybackEngine::writeLatencyReport() {
+    if (m_latencyReportPath.empty()) {
+        return;
+    }
+    if (m_session.getLatency().writeReport(m_latencyReportPath)) {
+        m_latencyReports.fetch_add(1, std::memory_order_relaxed);
+    }
+}
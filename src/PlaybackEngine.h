@@ -0,0 +1,177 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioSink.h"
+#include "Clock.h"
+#include "ExamSession.h"
+#include "Instruction.h"
+#include "InstructionTable.h"
+#include "SpscQueue.h"
+
+// 会话快照：播放线程每次状态变化后复制一份，界面线程只读，不与播放线程共享可变状态
+struct SessionView {
+    InstructionTable instructions;
+    int currentPlayingIndex = -1;
+    int nextInstructionIndex = -1;
+    std::chrono::system_clock::time_point currentPlayingStartTime;
+    uint64_t generation = 0;  // 指令表结构版本：增删科目/重建时递增，行号只在同一版本内有效
+
+    int findNextUnplayedInstruction() const { return instructions.findFirst(PlaybackStatus::UNPLAYED); }
+};
+
+// 播放线程 -> 界面线程的事件。view 为事件发生后的会话快照
+struct EngineEvent {
+    bool hasSessionEvent = false;
+    SessionEvent sessionEvent{SessionEventType::PLAYED, -1, false, {}};
+    bool structural = false;  // 指令表行集合变化（或快照丢失后的重同步），界面须整表重建
+    std::shared_ptr<const SessionView> view;
+};
+
+struct EngineStats {
+    uint64_t wakeups = 0;         // 播放线程醒来次数
+    uint64_t commands = 0;        // 已处理的界面命令
+    uint64_t eventsPublished = 0;
+    uint64_t eventsDropped = 0;   // 事件队列满（界面长时间未取）时丢弃的事件
+    uint64_t commandsRejected = 0; // 命令队列满被拒绝的命令
+    double lastDueLatenessMs = 0.0;  // 最近一次到点驱动相对计划时刻（减去提前起播量）的迟到量
+    double maxDueLatenessMs = 0.0;
+    uint64_t latencyReports = 0;     // 已写出的起播延迟报告次数
+    double outputCompensationMs = 0.0; // 当前提前起播量（输出延迟补偿）
+    double lastResidualMs = 0.0;       // 最近一次自动起播首帧出声相对计划时刻的残余误差
+    double maxResidualMs = 0.0;        // 残余误差绝对值的最大值
+    uint64_t residualSamples = 0;      // 出声时刻已知的自动起播次数
+};
+
+// 专用播放线程：独占 ExamSession 与音频输出，自己睡到下一条指令的 playTime 再做播放决策，
+// 不再经由界面消息循环（WM_TIMER / WM_INSTRUCTION_DUE）。界面线程的列表重建、
+// 文件对话框、模态消息框都不会推迟考试指令。
+//
+// 两个方向都走无锁 SPSC 队列：
+// - 界面 -> 播放线程：命令（增删科目、重建、手动播放、停止、预热提前量、音频时长），入队后唤醒播放线程；
+// - 播放线程 -> 界面：EngineEvent（会话事件 + 快照）。队列由空变非空时调用一次 notify
+//   （如 PostMessage），界面在消息处理中 drainEvents() 取走全部事件；notify 在界面取之前合并。
+//
+// 等待基于 steady_clock，截止点每轮由墙钟换算（锚定），不受睡眠期间系统时间跳变的影响；
+// 单次睡眠上限 MAX_SLEEP，醒来后重新锚定以吸收 NTP 校时；最后 SPIN_WINDOW 内改为短睡/让出，
+// 触发抖动在个位毫秒级。到点前 prefetchLead 在本线程上预热下一条指令。
+// 有指令在播放时按 COMPLETION_POLL 检测播放完成；输出端支持播完通知（AudioSink::setEndNotify）时
+// 一播完即被唤醒，接续指令与单路输出的下一条不等轮询周期。
+//
+// 注入的 Clock 须与墙钟同速（SystemClock）；命令接口与 drainEvents() 须由同一个线程调用。
+class PlaybackEngine : private ExamSessionListener {
+public:
+    using Notify = std::function<void()>;
+
+    static constexpr std::chrono::milliseconds COMPLETION_POLL{100};
+    static constexpr std::chrono::seconds MAX_SLEEP{60};
+    static constexpr std::chrono::milliseconds SPIN_WINDOW{20};
+    static constexpr size_t QUEUE_CAPACITY = 256;
+
+    PlaybackEngine(Clock& clock, AudioSink& sink);
+    ~PlaybackEngine() override;
+
+    PlaybackEngine(const PlaybackEngine&) = delete;
+    PlaybackEngine& operator=(const PlaybackEngine&) = delete;
+
+    // 事件通知回调：在播放线程上调用，只应做投递（如 PostMessage），start() 前设置
+    void setNotify(Notify notify) { m_notify = std::move(notify); }
+    // 起播延迟报告路径：每科考完（及播放线程退出时）在播放线程上重写，空则不写。start() 前设置
+    void setLatencyReportPath(std::filesystem::path path) { m_latencyReportPath = std::move(path); }
+
+    // 启动/停止播放线程（重复调用安全）。启动后先发布一次初始快照；停止时停掉全部播放
+    void start();
+    void stop();
+
+    // ---- 命令（界面线程）：队列满返回 false ----
+    bool addInstructions(std::vector<Instruction> instructions);
+    bool removeSubject(int subjectId);
+    bool regenerate(std::vector<Instruction> instructions);
+    // index 为界面所持快照中的行号，generation 为该快照的版本；版本已变则忽略该命令
+    bool playInstruction(int index, bool isManualPlay, uint64_t generation);
+    bool stopPlayback();
+    bool setPrefetchLead(std::chrono::milliseconds lead);
+    // 按文件名填写已知音频时长（元数据缓存刷新后），行集合不变，界面按新快照刷新
+    bool applyDurations(std::map<std::string, double> durations);
+
+    // ---- 事件（界面线程）：依次交给 handler，返回取出的事件数 ----
+    size_t drainEvents(const std::function<void(EngineEvent&)>& handler);
+
+    EngineStats getStats() const;
+
+private:
+    enum class CommandType : uint8_t {
+        ADD_INSTRUCTIONS, REMOVE_SUBJECT, REGENERATE, PLAY, STOP, SET_PREFETCH_LEAD, APPLY_DURATIONS
+    };
+
+    struct Command {
+        CommandType type = CommandType::STOP;
+        std::vector<Instruction> instructions;
+        int value = 0;                // subjectId / 行号
+        bool isManualPlay = false;
+        uint64_t generation = 0;
+        std::chrono::milliseconds lead{0};
+        std::map<std::string, double> durations;
+    };
+
+    void onSessionEvent(const SessionEvent& event) override;
+
+    bool pushCommand(Command command);
+    void wake();
+    bool processCommands(bool& structural);
+    void prefetchIfDue();
+    // 把新补齐出声时刻的自动起播计入残余误差统计
+    void updateResidualStats();
+    void publish(bool structural);
+    void writeLatencyReport();
+    void waitForWork();
+    void threadMain();
+
+    Clock& m_clock;
+    AudioSink& m_sink;
+    Notify m_notify;
+    std::filesystem::path m_latencyReportPath;
+
+    // 播放线程私有
+    ExamSession m_session;
+    std::vector<SessionEvent> m_pendingEvents;
+    uint64_t m_generation = 0;
+    std::chrono::milliseconds m_prefetchLead{0};
+    uint64_t m_prefetchedGeneration = UINT64_MAX;  // 已预热（或已放弃预热）的指令：版本 + 行号
+    int m_prefetchedIndex = -1;
+    bool m_resyncPending = false;  // 有事件被丢弃，下一次发布须带整表快照
+
+    SpscQueue<Command> m_commands;
+    SpscQueue<EngineEvent> m_events;
+    std::atomic<bool> m_notifyPending{false};  // 已 notify、界面尚未开始取
+
+    // 唤醒播放线程（仅用于睡眠，命令本身走无锁队列）
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    bool m_wakeRequested = false;
+    bool m_running = false;
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_wakeups{0};
+    std::atomic<uint64_t> m_commandCount{0};
+    std::atomic<uint64_t> m_eventsPublished{0};
+    std::atomic<uint64_t> m_eventsDropped{0};
+    std::atomic<uint64_t> m_commandsRejected{0};
+    std::atomic<int64_t> m_lastDueLatenessUs{0};
+    std::atomic<int64_t> m_maxDueLatenessUs{0};
+    std::atomic<uint64_t> m_latencyReports{0};
+    std::atomic<int64_t> m_outputCompensationUs{0};
+    std::atomic<int64_t> m_lastResidualUs{0};
+    std::atomic<int64_t> m_maxResidualUs{0};
+    std::atomic<uint64_t> m_residualSamples{0};
+    size_t m_residualIndex = 0;  // 播放线程私有：下一个待统计的起播样本
+};
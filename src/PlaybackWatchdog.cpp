@@ -0,0 +1,250 @@
+#include "PlaybackWatchdog.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace std::chrono;
+
+namespace {
+constexpr size_t kChannels = 2;
+
+int64_t nowTicks() {
+    return steady_clock::now().time_since_epoch().count();
+}
+
+steady_clock::time_point fromTicks(int64_t ticks) {
+    return steady_clock::time_point(steady_clock::duration(ticks));
+}
+
+double millisecondsBetween(steady_clock::time_point from, steady_clock::time_point to) {
+    return duration<double, std::milli>(to - from).count();
+}
+}  // namespace
+
+WatchedSource::WatchedSource(std::unique_ptr<MixerSource> inner, std::shared_ptr<VoiceProgress> progress,
+                             std::function<void()> onFault)
+    : m_inner(std::move(inner)), m_progress(std::move(progress)), m_onFault(std::move(onFault)),
+      m_toleranceFrames(static_cast<uint64_t>(END_TOLERANCE_SECONDS * m_progress->sampleRate)) {}
+
+WatchedSource::~WatchedSource() {
+    m_progress->ended.store(true, std::memory_order_release);
+}
+
+size_t WatchedSource::read(float* out, size_t frames) {
+    VoiceProgress& progress = *m_progress;
+    if (progress.failed.load(std::memory_order_relaxed)) {
+        // 占位：等看门狗接替（接替后本声部被停止），放弃或超时则结束
+        if (progress.releaseHold.load(std::memory_order_acquire) ||
+            m_heldFrames >= static_cast<uint64_t>(HOLD_SECONDS * progress.sampleRate)) {
+            return 0;
+        }
+        std::fill(out, out + frames * kChannels, 0.0f);
+        m_heldFrames += frames;
+        return frames;
+    }
+
+    progress.reading.store(true, std::memory_order_relaxed);
+    const size_t count = m_inner->read(out, frames);
+    progress.reading.store(false, std::memory_order_relaxed);
+    const uint64_t total = progress.frames.load(std::memory_order_relaxed) + count;
+    if (count > 0) {
+        progress.frames.store(total, std::memory_order_release);
+        progress.lastReadTicks.store(nowTicks(), std::memory_order_release);
+    }
+    if (count == frames) {
+        return count;
+    }
+    if (progress.expectedFrames > 0 && total + m_toleranceFrames < progress.expectedFrames) {
+        std::fill(out + count * kChannels, out + frames * kChannels, 0.0f);
+        progress.failedTicks.store(nowTicks(), std::memory_order_relaxed);
+        progress.failed.store(true, std::memory_order_release);
+        if (m_onFault) {
+            m_onFault();
+        }
+        return frames;
+    }
+    progress.ended.store(true, std::memory_order_release);
+    return count;
+}
+
+PlaybackWatchdog::PlaybackWatchdog(const WatchdogConfig& config) : m_config(config) {}
+
+PlaybackWatchdog::~PlaybackWatchdog() {
+    stop();
+}
+
+const char* PlaybackWatchdog::faultName(WatchdogFault fault) {
+    switch (fault) {
+    case WatchdogFault::SOURCE_ENDED_EARLY:
+        return "音频提前中断";
+    case WatchdogFault::OUTPUT_STALLED:
+        return "设备停止取数据";
+    case WatchdogFault::OUTPUT_FAILED:
+        return "设备写入失败";
+    case WatchdogFault::RENDER_BLOCKED:
+        return "渲染线程阻塞";
+    }
+    return "未知";
+}
+
+std::string PlaybackWatchdog::formatEvent(const WatchdogEvent& event) {
+    char buf[512];
+    std::snprintf(buf, sizeof(buf), "看门狗: %s %s 于 %.3f 秒处，检出 %.1f ms，%s %.1f ms（%s）",
+                  faultName(event.fault), event.filename.c_str(), event.positionSeconds, event.detectMs,
+                  event.recovered ? "接替" : "未接替，尝试", event.recoverMs, event.via.c_str());
+    return buf;
+}
+
+void PlaybackWatchdog::start() {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = false;
+        m_woken = false;
+    }
+    m_thread = std::thread([this]() { run(); });
+}
+
+void PlaybackWatchdog::stop() {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (!m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    m_thread.join();
+    m_watched.reset();
+}
+
+void PlaybackWatchdog::wake() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_woken = true;
+    }
+    m_wakeCondition.notify_all();
+}
+
+std::vector<WatchdogEvent> PlaybackWatchdog::getEvents() const {
+    std::lock_guard<std::mutex> lock(m_eventsMutex);
+    return m_events;
+}
+
+void PlaybackWatchdog::clearEvents() {
+    std::lock_guard<std::mutex> lock(m_eventsMutex);
+    m_events.clear();
+}
+
+void PlaybackWatchdog::run() {
+    const auto period = duration_cast<steady_clock::duration>(duration<double, std::milli>(m_config.pollMs));
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (!m_stopping) {
+        m_wakeCondition.wait_for(lock, period, [this]() { return m_woken || m_stopping; });
+        if (m_stopping) {
+            break;
+        }
+        m_woken = false;
+        lock.unlock();
+        check();
+        lock.lock();
+    }
+}
+
+void PlaybackWatchdog::check() {
+    WatchdogSample sample;
+    if (!m_sampler || !m_sampler(sample) || !sample.progress) {
+        m_watched.reset();
+        return;
+    }
+    const auto now = steady_clock::now();
+    VoiceProgress& progress = *sample.progress;
+    if (sample.progress != m_watched) {
+        m_watched = sample.progress;
+        m_lastFrames = m_goodFrames = progress.frames.load(std::memory_order_acquire);
+        m_goodTime = m_watchStart = now;
+        m_lastFailedWrites = sample.failedWrites;
+        m_blockedReported = false;
+    }
+    // 已结束，或已处理过（接替失败后不再反复尝试）
+    if (progress.ended.load(std::memory_order_acquire) || progress.releaseHold.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (progress.failed.load(std::memory_order_acquire)) {
+        handle(sample, WatchdogFault::SOURCE_ENDED_EARLY, progress.frames.load(std::memory_order_acquire),
+               fromTicks(progress.failedTicks.load(std::memory_order_relaxed)));
+        return;
+    }
+    // 设备故障时排队中的数据已读出但未必听到：从上次正常时的进度再往前退一个排队量，宁可重复几十毫秒
+    if (sample.failedWrites != m_lastFailedWrites) {
+        m_lastFailedWrites = sample.failedWrites;
+        const uint64_t resume = m_goodFrames - std::min<uint64_t>(m_goodFrames, sample.queuedFrames);
+        handle(sample, WatchdogFault::OUTPUT_FAILED, resume, m_goodTime);
+        return;
+    }
+    const uint64_t frames = progress.frames.load(std::memory_order_acquire);
+    if (frames != m_lastFrames) {
+        m_lastFrames = m_goodFrames = frames;
+        m_goodTime = now;
+        m_blockedReported = false;
+        return;
+    }
+
+    // 不前进的起点：最近一次读出数据的时刻（尚未读过则为开始看护的时刻）
+    const int64_t lastRead = progress.lastReadTicks.load(std::memory_order_acquire);
+    const auto stalledSince = lastRead != 0 ? std::max(fromTicks(lastRead), m_watchStart) : m_watchStart;
+    if (millisecondsBetween(stalledSince, now) < m_config.stallMs) {
+        return;
+    }
+    const bool renderAlive = millisecondsBetween(sample.heartbeat, now) < m_config.stallMs / 2;
+    if (renderAlive) {
+        handle(sample, WatchdogFault::OUTPUT_STALLED, frames - std::min<uint64_t>(frames, sample.queuedFrames),
+               stalledSince);
+    } else if (!m_blockedReported) {
+        m_blockedReported = true;
+        handle(sample, WatchdogFault::RENDER_BLOCKED, frames, stalledSince);
+    }
+}
+
+void PlaybackWatchdog::handle(const WatchdogSample& sample, WatchdogFault fault, uint64_t resumeFrame,
+                              steady_clock::time_point occurred) {
+    VoiceProgress& progress = *sample.progress;
+    const auto detected = steady_clock::now();
+    WatchdogEvent event;
+    event.filename = progress.filename;
+    event.fault = fault;
+    event.positionSeconds = progress.positionSeconds(resumeFrame);
+    event.detectMs = std::max(0.0, millisecondsBetween(occurred, detected));
+
+    if (fault == WatchdogFault::RENDER_BLOCKED) {
+        event.via = progress.reading.load(std::memory_order_relaxed)
+                        ? "渲染线程卡在本声部的读取中，无法安全重开"
+                        : "渲染线程卡在设备写入或其他声部中，无法安全重开";
+    } else if (progress.recoveries >= m_config.maxRecoveries) {
+        event.via = "已达接替次数上限";
+    } else if (fault == WatchdogFault::SOURCE_ENDED_EARLY && progress.recoveries > 0 &&
+               progress.frames.load(std::memory_order_acquire) == 0) {
+        event.via = "接替来源同样无法继续";
+    } else if (!m_recoverer) {
+        event.via = "未设置接替";
+    } else {
+        event.recovered = m_recoverer(sample, fault, event.positionSeconds, event.via);
+        event.recoverMs = millisecondsBetween(detected, steady_clock::now());
+    }
+    // 接替失败（或不接替）：占位静音结束，这一路照常播完；不再对它反复尝试
+    if (!event.recovered && fault != WatchdogFault::RENDER_BLOCKED) {
+        progress.releaseHold.store(true, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_eventsMutex);
+        m_events.push_back(event);
+    }
+    if (m_onEvent) {
+        m_onEvent(event);
+    }
+}
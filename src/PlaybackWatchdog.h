@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioMixer.h"
+
+enum class WatchdogFault : uint8_t {
+    SOURCE_ENDED_EARLY,  // 解码源在应有长度之前读尽（读盘失败、U 盘拔出、文件损坏）
+    OUTPUT_STALLED,      // 设备不再取数据：渲染线程在等排队量下降，声部不再前进
+    OUTPUT_FAILED,       // 写入设备失败（设备消失）
+    RENDER_BLOCKED       // 渲染线程卡在读取或写入中未返回：无法安全接替，只记录
+};
+
+// 被看护的一路前台声部：建源时由 AudioPlayer 填写前几项，之后 WatchedSource 在渲染线程上更新进度，
+// 看门狗线程读取
+struct VoiceProgress {
+    std::string filename;
+    double startSeconds = 0.0;    // 本声部在文件中的起点（裁去的开头静音 + 之前接替的进度）
+    uint32_t sampleRate = 44100;  // 混音采样率
+    uint64_t expectedFrames = 0;  // 自起点起应有的帧数，0 表示未知（不判提前读尽）
+    float gain = 1.0f;
+    int recoveries = 0;           // 这条指令已被接替的次数
+
+    std::atomic<uint64_t> frames{0};        // 已读出的帧
+    std::atomic<int64_t> lastReadTicks{0};  // 最近一次读出数据的时刻（steady_clock 计数）
+    std::atomic<bool> reading{false};       // 渲染线程正在此源的 read() 中
+    std::atomic<bool> ended{false};         // 正常读尽，或声部已被混音器释放
+    std::atomic<bool> failed{false};        // 提前读尽：改为输出静音占住声部，等待接替
+    std::atomic<int64_t> failedTicks{0};
+    std::atomic<bool> releaseHold{false};   // 不再接替：占位静音随即结束
+
+    double positionSeconds(uint64_t frame) const {
+        return startSeconds + (sampleRate > 0 ? static_cast<double>(frame) / sampleRate : 0.0);
+    }
+};
+
+// 看护源：包在前台声部最外层记录进度。内层在应有长度（减去容差）之前读尽时不结束声部，
+// 改为输出静音占住它（isPlaying() 仍为真，会话不会把指令记为已播放），并唤醒看门狗从断点处接替。
+// 看门狗放弃或 HOLD_SECONDS 内未接替时照常结束
+class WatchedSource : public MixerSource {
+public:
+    // 末尾这么短之内读尽视为正常结束（时长估算误差）
+    static constexpr double END_TOLERANCE_SECONDS = 0.5;
+    static constexpr double HOLD_SECONDS = 2.0;
+
+    WatchedSource(std::unique_ptr<MixerSource> inner, std::shared_ptr<VoiceProgress> progress,
+                  std::function<void()> onFault);
+    ~WatchedSource() override;
+    size_t read(float* out, size_t frames) override;
+
+private:
+    std::unique_ptr<MixerSource> m_inner;
+    std::shared_ptr<VoiceProgress> m_progress;
+    std::function<void()> m_onFault;
+    uint64_t m_toleranceFrames;
+    uint64_t m_heldFrames = 0;
+};
+
+// 看门狗的一次采样：当前被看护的声部与混音输出状态
+struct WatchdogSample {
+    std::shared_ptr<VoiceProgress> progress;
+    uint64_t failedWrites = 0;  // MixerStats::failedWrites
+    std::chrono::steady_clock::time_point heartbeat;
+    size_t queuedFrames = 0;    // 渲染线程维持的设备排队量：设备故障时这部分已读出但未必听到
+};
+
+struct WatchdogEvent {
+    std::string filename;
+    WatchdogFault fault = WatchdogFault::SOURCE_ENDED_EARLY;
+    double positionSeconds = 0.0;  // 接替处（文件中的秒数）
+    double detectMs = 0.0;         // 故障发生（最后一次正常前进）到检出
+    double recoverMs = 0.0;        // 检出到接替声部交给混音器
+    bool recovered = false;
+    std::string via;               // 接替来源（备用文件、备用设备），未接替时为原因
+};
+
+struct WatchdogConfig {
+    double pollMs = 20.0;   // 检查卡顿的周期；提前读尽由看护源立即唤醒，不等周期
+    double stallMs = 200.0; // 声部这么久不前进判为卡住
+    int maxRecoveries = 3;  // 同一条指令最多接替的次数
+};
+
+// 播放看门狗：独立线程（不能放在它要看护的渲染线程上）按 pollMs 检查当前前台声部的进度。
+//   - 看护源提前读尽：立即唤醒，从断点处接替（SOURCE_ENDED_EARLY）
+//   - 写入设备失败：从上一次正常采样时的进度减去排队量处接替（OUTPUT_FAILED）
+//   - 声部 stallMs 不前进而渲染线程仍在循环：设备不取数据，同样减去排队量接替（OUTPUT_STALLED）
+//   - 声部不前进且渲染线程也停了：卡在读取/写入中，强行重开会卡住看门狗自己，只记录（RENDER_BLOCKED）
+// 接替由 Recoverer 完成（换备用文件、换备用设备重开输出），看门狗只负责检出、计时与记录。
+// Sampler/Recoverer/EventCallback 在看门狗线程上调用，须在 start() 之前设置
+class PlaybackWatchdog {
+public:
+    // 取当前被看护的声部，没有返回 false
+    using Sampler = std::function<bool(WatchdogSample& sample)>;
+    // 从文件中 positionSeconds 处接替 sample.progress 这一路。成功返回 true；via 填接替来源或失败原因
+    using Recoverer = std::function<bool(const WatchdogSample& sample, WatchdogFault fault,
+                                         double positionSeconds, std::string& via)>;
+    using EventCallback = std::function<void(const WatchdogEvent& event)>;
+
+    explicit PlaybackWatchdog(const WatchdogConfig& config = WatchdogConfig());
+    ~PlaybackWatchdog();
+
+    PlaybackWatchdog(const PlaybackWatchdog&) = delete;
+    PlaybackWatchdog& operator=(const PlaybackWatchdog&) = delete;
+
+    static const char* faultName(WatchdogFault fault);
+    // 一行记录：故障、文件、位置、检出与接替耗时、来源
+    static std::string formatEvent(const WatchdogEvent& event);
+
+    void setSampler(Sampler sampler) { m_sampler = std::move(sampler); }
+    void setRecoverer(Recoverer recoverer) { m_recoverer = std::move(recoverer); }
+    void setEventCallback(EventCallback callback) { m_onEvent = std::move(callback); }
+
+    void start();
+    void stop();
+    // 立即检查一次（看护源检出提前读尽时在渲染线程上调用，只做唤醒）
+    void wake();
+
+    std::vector<WatchdogEvent> getEvents() const;
+    void clearEvents();
+
+private:
+    void run();
+    void check();
+    void handle(const WatchdogSample& sample, WatchdogFault fault, uint64_t resumeFrame,
+                std::chrono::steady_clock::time_point occurred);
+
+    const WatchdogConfig m_config;
+    Sampler m_sampler;
+    Recoverer m_recoverer;
+    EventCallback m_onEvent;
+
+    std::mutex m_controlMutex;  // 串行化 start / stop
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    bool m_woken = false;
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    // 看门狗线程私有：当前这一路的检查状态
+    std::shared_ptr<VoiceProgress> m_watched;
+    uint64_t m_lastFrames = 0;
+    uint64_t m_goodFrames = 0;  // 最近一次确认设备正常时的进度
+    std::chrono::steady_clock::time_point m_goodTime;
+    std::chrono::steady_clock::time_point m_watchStart;
+    uint64_t m_lastFailedWrites = 0;
+    bool m_blockedReported = false;
+
+    mutable std::mutex m_eventsMutex;
+    std::vector<WatchdogEvent> m_events;
+};
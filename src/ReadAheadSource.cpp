@@ -0,0 +1,113 @@
+#include "ReadAheadSource.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+constexpr size_t kChannels = 2;
+constexpr size_t kDecodeChunkFrames = 1024;
+// 环满时解码线程的轮询间隔：远小于 BUFFER_SECONDS，环始终接近满
+constexpr auto kIdleWait = std::chrono::milliseconds(2);
+}  // namespace
+
+ReadAheadSource::ReadAheadSource(std::unique_ptr<MixerSource> inner, uint32_t sampleRate)
+    : m_state(std::make_shared<State>()),
+      m_starveLimit(static_cast<uint64_t>(STARVE_SECONDS * sampleRate)) {
+    State& state = *m_state;
+    state.inner = std::move(inner);
+    state.capacity = std::max<size_t>(PRIME_FRAMES + kDecodeChunkFrames,
+                                      static_cast<size_t>(BUFFER_SECONDS * sampleRate));
+    state.ring.resize(state.capacity * kChannels);
+
+    // 首段在调用线程上读出，此时解码线程尚未启动
+    std::vector<float> chunk(kDecodeChunkFrames * kChannels);
+    size_t primed = 0;
+    while (primed < PRIME_FRAMES) {
+        const size_t read = state.inner->read(chunk.data(), kDecodeChunkFrames);
+        primed += fill(state, chunk.data(), read);
+        if (read < kDecodeChunkFrames) {
+            state.ended.store(true, std::memory_order_release);
+            return;
+        }
+    }
+    m_thread = std::thread(run, m_state);
+}
+
+ReadAheadSource::~ReadAheadSource() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    // 与 run() 中的 decoding/stopping 成对（均为 seq_cst）：此处读到 decoding 为假时，解码线程随后必然
+    // 看到 stopping，不会再进内层 read()，最多等一次轮询；正在读（卡在 U 盘上）则不等，由解码线程收尾
+    m_state->stopping.store(true);
+    if (m_state->decoding.load()) {
+        m_thread.detach();
+    } else {
+        m_thread.join();
+    }
+}
+
+size_t ReadAheadSource::fill(State& state, const float* samples, size_t frames) {
+    const uint64_t tail = state.tail.load(std::memory_order_relaxed);
+    const size_t start = static_cast<size_t>(tail % state.capacity);
+    const size_t first = std::min(frames, state.capacity - start);
+    std::copy(samples, samples + first * kChannels, state.ring.data() + start * kChannels);
+    std::copy(samples + first * kChannels, samples + frames * kChannels, state.ring.data());
+    state.tail.store(tail + frames, std::memory_order_release);
+    return frames;
+}
+
+void ReadAheadSource::run(std::shared_ptr<State> shared) {
+    State& state = *shared;
+    std::vector<float> chunk(kDecodeChunkFrames * kChannels);
+    while (!state.stopping.load()) {
+        const uint64_t used = state.tail.load(std::memory_order_relaxed) - state.head.load(std::memory_order_acquire);
+        if (state.capacity - used < kDecodeChunkFrames) {
+            std::this_thread::sleep_for(kIdleWait);
+            continue;
+        }
+        state.decoding.store(true);
+        if (state.stopping.load()) {
+            state.decoding.store(false);
+            break;
+        }
+        const size_t read = state.inner->read(chunk.data(), kDecodeChunkFrames);
+        state.decoding.store(false);
+        fill(state, chunk.data(), read);
+        if (read < kDecodeChunkFrames) {
+            state.ended.store(true, std::memory_order_release);
+            break;
+        }
+    }
+}
+
+size_t ReadAheadSource::read(float* out, size_t frames) {
+    State& state = *m_state;
+    // 先取 ended 再取 tail：看到读尽时，tail 已是最终值
+    const bool ended = state.ended.load(std::memory_order_acquire);
+    const uint64_t head = state.head.load(std::memory_order_relaxed);
+    const uint64_t available = state.tail.load(std::memory_order_acquire) - head;
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(frames, available));
+    const size_t start = static_cast<size_t>(head % state.capacity);
+    const size_t first = std::min(count, state.capacity - start);
+    const float* ring = state.ring.data();
+    std::copy(ring + start * kChannels, ring + (start + first) * kChannels, out);
+    std::copy(ring, ring + (count - first) * kChannels, out + first * kChannels);
+    state.head.store(head + count, std::memory_order_release);
+    if (count == frames) {
+        m_starveRun = 0;
+        return count;
+    }
+    if (ended || m_starveRun >= m_starveLimit) {
+        return count;
+    }
+    // 解码线程落后：补静音保住声部，不在渲染线程上等
+    const size_t missing = frames - count;
+    std::fill(out + count * kChannels, out + frames * kChannels, 0.0f);
+    m_starveRun += missing;
+    state.starvedFrames.fetch_add(missing, std::memory_order_relaxed);
+    return frames;
+}
+
+uint64_t ReadAheadSource::getStarvedFrames() const {
+    return m_state->starvedFrames.load(std::memory_order_relaxed);
+}
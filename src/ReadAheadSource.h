@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "AudioMixer.h"
+
+// 预读源：包在从磁盘（散文件流、打包文件映射）解码的源外层，由专门的解码线程提前读出约 BUFFER_SECONDS
+// 放进环形缓冲，渲染线程上的 read() 只做拷贝，不碰文件。构造时在调用线程上先读出 PRIME_FRAMES，
+// 交给混音器后第一块即有数据。
+// 解码线程跟不上（U 盘卡顿）时以静音补足；连续补足 STARVE_SECONDS 仍无数据则按已读尽返回，
+// 由外层 WatchedSource 判为提前读尽、交看门狗接替（接替点因此最多偏后 STARVE_SECONDS）
+class ReadAheadSource : public MixerSource {
+public:
+    static constexpr double BUFFER_SECONDS = 0.5;
+    static constexpr double STARVE_SECONDS = 0.25;
+    static constexpr size_t PRIME_FRAMES = 4096;
+
+    ReadAheadSource(std::unique_ptr<MixerSource> inner, uint32_t sampleRate);
+    ~ReadAheadSource() override;
+    size_t read(float* out, size_t frames) override;
+
+    // 以静音补足的帧数（渲染线程写入，可在任意线程读取）
+    uint64_t getStarvedFrames() const;
+
+private:
+    // 解码线程与本对象共享：析构时解码线程若正卡在内层 read() 中，不等它返回，由它最后释放
+    struct State {
+        std::unique_ptr<MixerSource> inner;
+        std::vector<float> ring;  // capacity 帧交错立体声
+        size_t capacity = 0;
+        std::atomic<uint64_t> head{0};  // 已交给渲染线程的帧（渲染线程写）
+        std::atomic<uint64_t> tail{0};  // 已解码入环的帧（解码线程写）
+        std::atomic<bool> ended{false};     // 内层已读尽，tail 不再增长
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> decoding{false};  // 解码线程正在内层 read() 中
+        std::atomic<uint64_t> starvedFrames{0};
+    };
+
+    static size_t fill(State& state, const float* samples, size_t frames);
+    static void run(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> m_state;
+    std::thread m_thread;
+    uint64_t m_starveLimit;
+    uint64_t m_starveRun = 0;  // 连续补静音的帧数（渲染线程）
+};
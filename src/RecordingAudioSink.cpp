@@ -0,0 +1,124 @@
+#include "RecordingAudioSink.h"
+#include "AudioBundle.h"
+
+using namespace std::chrono;
+
+RecordingAudioSink::RecordingAudioSink(const Clock& clock) : m_clock(clock) {}
+
+void RecordingAudioSink::setDurationSeconds(const std::string& filename, double seconds) {
+    m_durations[filename] = seconds;
+}
+
+void RecordingAudioSink::setMissing(const std::string& filename) {
+    m_missing.insert(filename);
+}
+
+double RecordingAudioSink::durationFor(const std::string& filename) const {
+    auto it = m_durations.find(filename);
+    return it != m_durations.end() ? it->second : m_defaultDurationSeconds;
+}
+
+bool RecordingAudioSink::isAvailable(const std::string& filename) const {
+    if (m_missing.count(filename) > 0) {
+        return false;
+    }
+    if (m_requireFiles) {
+        if (!AudioBundle::exists(filename)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RecordingAudioSink::prepare(const std::string& filename) {
+    if (!isAvailable(filename)) {
+        return false;
+    }
+    m_preparedFilename = filename;
+    ++m_prepareCount;
+    return true;
+}
+
+bool RecordingAudioSink::play(const std::string& filename) {
+    if (!isAvailable(filename)) {
+        return false;
+    }
+
+    auto now = m_clock.now();
+    // 接续命中：上一路已播完，输出端在它结束的那一刻就已接上
+    const bool joined = m_queuedFilename == filename && m_active && m_records.back().endTime <= now;
+    const auto start = joined ? m_records.back().endTime : now;
+    m_queuedFilename.clear();
+    if (!m_overlap) {
+        stop();
+    } else {
+        for (auto& previous : m_records) {
+            if (previous.endTime > now) {
+                previous.overlapped = true;
+            }
+        }
+    }
+
+    PlayRecord record;
+    record.filename = filename;
+    record.prepared = joined || (!m_preparedFilename.empty() && m_preparedFilename == filename);
+    if (record.prepared && !joined) {
+        m_preparedFilename.clear();  // 预热流被接管
+    }
+    record.joined = joined;
+    record.startTime = start;
+    m_joinOffsetMs = duration<double, std::milli>(start - now).count();
+    record.endTime = record.startTime + duration_cast<system_clock::duration>(
+        duration<double>(durationFor(filename)));
+    m_records.push_back(record);
+    m_active = true;
+    return true;
+}
+
+bool RecordingAudioSink::queue(const std::string& filename) {
+    if (!m_active || !isAvailable(filename)) {
+        return false;
+    }
+    m_queuedFilename = filename;
+    return true;
+}
+
+bool RecordingAudioSink::getOnsetDelayMs(double& delayMs) {
+    if (m_records.empty()) {
+        return false;
+    }
+    // 接续的一路随上一路出声，设备延迟已计在上一路里
+    delayMs = m_onsetDelayMs + m_joinOffsetMs;
+    return true;
+}
+
+bool RecordingAudioSink::isPlaying() {
+    return m_active && m_clock.now() < m_records.back().endTime;
+}
+
+void RecordingAudioSink::stop() {
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+    m_queuedFilename.clear();
+    // 叠加模式下可能有多路仍在发声，全部截断
+    auto now = m_clock.now();
+    for (auto& record : m_records) {
+        if (now < record.endTime) {
+            record.endTime = now;
+            record.stoppedEarly = true;
+        }
+    }
+}
+
+double RecordingAudioSink::getCurrentStreamDuration() {
+    return m_active ? durationFor(m_records.back().filename) : 0.0;
+}
+
+system_clock::time_point RecordingAudioSink::getPlaybackEndTime() const {
+    if (!m_active || m_clock.now() >= m_records.back().endTime) {
+        return system_clock::time_point::max();
+    }
+    return m_records.back().endTime;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "AudioSink.h"
+#include "Clock.h"
+
+// 替身输出端：不出声，只按注入的时钟记录每次播放的起止时间。
+// 播放时长按文件名查表（未登记的用默认时长），isPlaying() 依据时钟判定，
+// 因此配合 VirtualClock 可以毫秒级、快于实时地回放整场考试。
+// 打开叠加模式后模拟混音输出：play() 不截断上一路，被新播放覆盖的记录标记为后台。
+// 接续预约（queue()）模拟混音器的就地接续：上一路播完后 play() 同名文件，记录的起点为上一路的结束时刻。
+class RecordingAudioSink : public AudioSink {
+public:
+    struct PlayRecord {
+        std::string filename;
+        std::chrono::system_clock::time_point startTime;
+        std::chrono::system_clock::time_point endTime;  // 被 stop() 截断时为截断时刻
+        bool stoppedEarly = false;
+        bool prepared = false;  // 起播时是否命中 prepare() 预热
+        bool overlapped = false;  // 叠加模式下被后续播放叠加（转入后台闪避）
+        bool joined = false;      // 命中接续预约：在上一路结束处接上
+    };
+
+    explicit RecordingAudioSink(const Clock& clock);
+
+    void setDefaultDurationSeconds(double seconds) { m_defaultDurationSeconds = seconds; }
+    void setDurationSeconds(const std::string& filename, double seconds);
+    // 标记文件为缺失：play() 将失败，模拟文件丢失/损坏
+    void setMissing(const std::string& filename);
+    // 打开后 play() 会检查文件是否真实存在（打包文件中的条目或 audio 目录下的散文件）
+    void setRequireFiles(bool requireFiles) { m_requireFiles = requireFiles; }
+    // 叠加模式（模拟混音输出端）
+    void setOverlap(bool overlap) { m_overlap = overlap; }
+    // getOnsetDelayMs() 报告的出声延迟（默认 0：play() 即出声）。只影响报告，不改变记录的起止时间
+    void setOnsetDelayMs(double delayMs) { m_onsetDelayMs = delayMs; }
+    // getOutputLatencyMs() 报告的输出延迟（默认 0：会话不提前起播）
+    void setOutputLatencyMs(double latencyMs) { m_outputLatencyMs = latencyMs; }
+
+    bool prepare(const std::string& filename) override;
+    bool play(const std::string& filename) override;
+    bool queue(const std::string& filename) override;
+    bool isPlaying() override;
+    void stop() override;
+    double getCurrentStreamDuration() override;
+    bool supportsOverlap() const override { return m_overlap; }
+    bool measuresOnset() const override { return true; }
+    bool getOnsetDelayMs(double& delayMs) override;
+    double getOutputLatencyMs() override { return m_outputLatencyMs; }
+
+    // 当前播放的预计结束时间，无播放或已播完返回 time_point::max()
+    std::chrono::system_clock::time_point getPlaybackEndTime() const;
+    const std::vector<PlayRecord>& getRecords() const { return m_records; }
+    int getPrepareCount() const { return m_prepareCount; }
+
+private:
+    double durationFor(const std::string& filename) const;
+    bool isAvailable(const std::string& filename) const;
+
+    const Clock& m_clock;
+    double m_defaultDurationSeconds = 10.0;
+    bool m_requireFiles = false;
+    bool m_overlap = false;
+    double m_onsetDelayMs = 0.0;
+    double m_outputLatencyMs = 0.0;
+    std::map<std::string, double> m_durations;
+    std::set<std::string> m_missing;
+    std::vector<PlayRecord> m_records;
+    bool m_active = false;
+    std::string m_preparedFilename;
+    std::string m_queuedFilename;
+    double m_joinOffsetMs = 0.0;  // 最近一次接续的起点相对 play() 调用的偏移（<= 0）
+    int m_prepareCount = 0;
+};
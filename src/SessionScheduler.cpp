@@ -0,0 +1,126 @@
+#include "SessionScheduler.h"
+
+using namespace std::chrono;
+
+namespace {
+const std::string kEmptyName;
+const std::vector<Instruction> kEmptyInstructions;
+}  // namespace
+
+SessionScheduler::SessionScheduler(system_clock::time_point start)
+    : m_wheel(toTick(start)) {}
+
+uint64_t SessionScheduler::toTick(system_clock::time_point timePoint) {
+    auto ms = duration_cast<milliseconds>(timePoint.time_since_epoch()).count();
+    return ms < 0 ? 0 : static_cast<uint64_t>(ms);
+}
+
+bool SessionScheduler::isValidSession(SessionId sessionId) const {
+    return sessionId >= 0 &&
+           static_cast<size_t>(sessionId) < m_sessions.size() &&
+           m_sessions[sessionId].active;
+}
+
+SessionScheduler::SessionId SessionScheduler::addSession(const std::string& name,
+                                                         std::vector<Instruction> instructions) {
+    SessionId sessionId = static_cast<SessionId>(m_sessions.size());
+    m_sessions.emplace_back();
+    Session& session = m_sessions.back();
+    session.name = name;
+    session.instructions = std::move(instructions);
+    session.timers.assign(session.instructions.size(), TimingWheel::INVALID_TIMER);
+    session.active = true;
+
+    for (size_t i = 0; i < session.instructions.size(); ++i) {
+        const Instruction& instruction = session.instructions[i];
+        if (instruction.status != PlaybackStatus::UNPLAYED) {
+            continue;
+        }
+        session.timers[i] = m_wheel.schedule(toTick(instruction.playTime),
+                                             makePayload(sessionId, static_cast<int>(i)));
+    }
+
+    ++m_activeSessionCount;
+    return sessionId;
+}
+
+bool SessionScheduler::removeSession(SessionId sessionId) {
+    if (!isValidSession(sessionId)) {
+        return false;
+    }
+    Session& session = m_sessions[sessionId];
+    for (auto timer : session.timers) {
+        m_wheel.cancel(timer);
+    }
+    session.timers.clear();
+    session.instructions.clear();
+    session.active = false;
+    --m_activeSessionCount;
+    return true;
+}
+
+bool SessionScheduler::cancelInstruction(SessionId sessionId, int index) {
+    if (!isValidSession(sessionId)) {
+        return false;
+    }
+    Session& session = m_sessions[sessionId];
+    if (index < 0 || static_cast<size_t>(index) >= session.instructions.size()) {
+        return false;
+    }
+    if (!m_wheel.cancel(session.timers[index])) {
+        return false;
+    }
+    session.timers[index] = TimingWheel::INVALID_TIMER;
+    session.instructions[index].status = PlaybackStatus::SKIPPED;
+    return true;
+}
+
+size_t SessionScheduler::advanceTo(system_clock::time_point now,
+                                   const DueHandler& onDue,
+                                   const ExpiredHandler& onExpired) {
+    const uint64_t nowTick = toTick(now);
+    const uint64_t expiryMs = static_cast<uint64_t>(duration_cast<milliseconds>(EXPIRY_WINDOW).count());
+
+    return m_wheel.advance(nowTick, [&](uint64_t payload, uint64_t expiryTick) {
+        SessionId sessionId = static_cast<SessionId>(payload >> 32);
+        int index = static_cast<int>(payload & 0xFFFFFFFFu);
+        if (!isValidSession(sessionId)) {
+            return;
+        }
+        Session& session = m_sessions[sessionId];
+        session.timers[index] = TimingWheel::INVALID_TIMER;
+        Instruction& instruction = session.instructions[index];
+        if (instruction.status != PlaybackStatus::UNPLAYED) {
+            return;
+        }
+
+        // 与单机版一致：迟到超过 60 秒视为过期，直接跳过
+        if (nowTick > expiryTick && nowTick - expiryTick > expiryMs) {
+            instruction.status = PlaybackStatus::SKIPPED;
+            if (onExpired) {
+                onExpired(sessionId, index, instruction);
+            }
+            return;
+        }
+        if (onDue) {
+            onDue(sessionId, index, instruction);
+        }
+    });
+}
+
+system_clock::time_point SessionScheduler::nextWakeTime() const {
+    uint64_t tick = m_wheel.nextEventTick();
+    if (tick == TimingWheel::NO_EVENT) {
+        return system_clock::time_point::max();
+    }
+    return system_clock::time_point(
+        duration_cast<system_clock::duration>(milliseconds(static_cast<int64_t>(tick))));
+}
+
+const std::string& SessionScheduler::getSessionName(SessionId sessionId) const {
+    return isValidSession(sessionId) ? m_sessions[sessionId].name : kEmptyName;
+}
+
+const std::vector<Instruction>& SessionScheduler::getInstructions(SessionId sessionId) const {
+    return isValidSession(sessionId) ? m_sessions[sessionId].instructions : kEmptyInstructions;
+}
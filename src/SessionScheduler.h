@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Instruction.h"
+#include "TimingWheel.h"
+
+// 多会话（多考场）调度核心：一个进程驱动成百上千个考场的指令表。
+//
+// 每个会话持有自己的 Instruction 列表（播放状态按会话独立），
+// 所有未播放指令以毫秒 tick 登记进同一个分层时间轮：
+// 插入/取消 O(1)，推进只触碰到期指令，无需全表排序或逐秒线性扫描。
+// 过期策略与单机版一致：迟到超过 EXPIRY_WINDOW 的指令标记为 SKIPPED。
+//
+// 非线程安全：由单一调度线程独占使用。
+class SessionScheduler {
+public:
+    using SessionId = int;
+    static constexpr SessionId INVALID_SESSION = -1;
+    static constexpr std::chrono::seconds EXPIRY_WINDOW{60};
+
+    // 到期回调：sessionId/index 定位指令，instruction 状态仍为 UNPLAYED，
+    // 由回调方决定是否置为 PLAYING
+    using DueHandler = std::function<void(SessionId sessionId, int index, Instruction& instruction)>;
+    // 过期回调（可选）：指令已被置为 SKIPPED
+    using ExpiredHandler = std::function<void(SessionId sessionId, int index, const Instruction& instruction)>;
+
+    explicit SessionScheduler(std::chrono::system_clock::time_point start);
+
+    // 新增会话并登记其全部 UNPLAYED 指令，返回会话 id
+    SessionId addSession(const std::string& name, std::vector<Instruction> instructions);
+    // 移除会话并取消其所有未触发指令
+    bool removeSession(SessionId sessionId);
+    // 取消单条指令（置为 SKIPPED），O(1)
+    bool cancelInstruction(SessionId sessionId, int index);
+
+    // 推进到 now：依次触发所有 playTime <= now 的指令，返回触发 + 过期条数
+    size_t advanceTo(std::chrono::system_clock::time_point now,
+                     const DueHandler& onDue,
+                     const ExpiredHandler& onExpired = ExpiredHandler());
+
+    // 下一次需要推进的时间（下界），无待触发指令返回 time_point::max()
+    std::chrono::system_clock::time_point nextWakeTime() const;
+
+    size_t sessionCount() const { return m_activeSessionCount; }
+    size_t pendingCount() const { return m_wheel.size(); }
+    const std::string& getSessionName(SessionId sessionId) const;
+    const std::vector<Instruction>& getInstructions(SessionId sessionId) const;
+
+private:
+    struct Session {
+        std::string name;
+        std::vector<Instruction> instructions;
+        std::vector<TimingWheel::TimerId> timers;  // 与 instructions 一一对应
+        bool active = false;
+    };
+
+    static uint64_t toTick(std::chrono::system_clock::time_point timePoint);
+    static uint64_t makePayload(SessionId sessionId, int index) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(sessionId)) << 32) |
+               static_cast<uint32_t>(index);
+    }
+    bool isValidSession(SessionId sessionId) const;
+
+    TimingWheel m_wheel;
+    std::vector<Session> m_sessions;
+    size_t m_activeSessionCount = 0;
+};
@@ -0,0 +1,92 @@
+#include "SilenceScanner.h"
+#include <cmath>
+
+#ifdef EVCS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+using Kernel = size_t (*)(const float* samples, size_t count, float threshold);
+
+size_t scanScalar(const float* samples, size_t count, float threshold) {
+    for (size_t i = 0; i < count; ++i) {
+        if (std::fabs(samples[i]) > threshold) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef EVCS_X86
+// 每次 16 个采样（四组 4 路比较合并为一次 movemask 判断），命中后交给标量定位
+EVCS_TARGET_SSE2 size_t scanSse2(const float* samples, size_t count, float threshold) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 limit = _mm_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128 a = _mm_cmpgt_ps(_mm_and_ps(_mm_loadu_ps(samples + i), absMask), limit);
+        __m128 b = _mm_cmpgt_ps(_mm_and_ps(_mm_loadu_ps(samples + i + 4), absMask), limit);
+        __m128 c = _mm_cmpgt_ps(_mm_and_ps(_mm_loadu_ps(samples + i + 8), absMask), limit);
+        __m128 d = _mm_cmpgt_ps(_mm_and_ps(_mm_loadu_ps(samples + i + 12), absMask), limit);
+        if (_mm_movemask_ps(_mm_or_ps(_mm_or_ps(a, b), _mm_or_ps(c, d))) != 0) {
+            break;
+        }
+    }
+    return i + scanScalar(samples + i, count - i, threshold);
+}
+
+// 每次 32 个采样，做法同 SSE2
+EVCS_TARGET_AVX2 size_t scanAvx2(const float* samples, size_t count, float threshold) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 limit = _mm256_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256 a = _mm256_cmp_ps(_mm256_and_ps(_mm256_loadu_ps(samples + i), absMask), limit, _CMP_GT_OQ);
+        __m256 b = _mm256_cmp_ps(_mm256_and_ps(_mm256_loadu_ps(samples + i + 8), absMask), limit, _CMP_GT_OQ);
+        __m256 c = _mm256_cmp_ps(_mm256_and_ps(_mm256_loadu_ps(samples + i + 16), absMask), limit, _CMP_GT_OQ);
+        __m256 d = _mm256_cmp_ps(_mm256_and_ps(_mm256_loadu_ps(samples + i + 24), absMask), limit, _CMP_GT_OQ);
+        if (_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(a, b), _mm256_or_ps(c, d))) != 0) {
+            break;
+        }
+    }
+    return i + scanScalar(samples + i, count - i, threshold);
+}
+#endif  // EVCS_X86
+
+Kernel kernelFor(SimdLevel kernel) {
+#ifdef EVCS_X86
+    switch (kernel) {
+    case SimdLevel::AVX2:
+        return scanAvx2;
+    case SimdLevel::SSE2:
+        return scanSse2;
+    default:
+        break;
+    }
+#endif
+    (void)kernel;
+    return scanScalar;
+}
+}  // namespace
+
+SilenceScanner::SilenceScanner(SimdLevel kernel)
+    : m_kernel(CpuFeatures::supports(kernel) ? kernel : SimdLevel::SCALAR),
+      m_threshold(static_cast<float>(std::pow(10.0, THRESHOLD_DBFS / 20.0))) {}
+
+bool SilenceScanner::add(const float* samples, size_t frames) {
+    if (m_found) {
+        return true;
+    }
+    const size_t count = frames * 2;
+    size_t index = findFirstAbove(samples, count, m_threshold, m_kernel);
+    m_frames += index / 2;
+    m_found = index < count;
+    return m_found;
+}
+
+size_t SilenceScanner::findFirstAbove(const float* samples, size_t count, float threshold, SimdLevel kernel) {
+    if (!CpuFeatures::supports(kernel)) {
+        kernel = SimdLevel::SCALAR;
+    }
+    return kernelFor(kernel)(samples, count, threshold);
+}
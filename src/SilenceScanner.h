@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "CpuFeatures.h"
+
+// 开头静音检测：找出首个绝对值超过门限的采样（交错立体声 float 输入，可分段喂入）。
+//
+// 解码器输出的 MP3 开头常有数百毫秒的静音或 -90 dBFS 量级的抖动噪声，门限取 -60 dBFS，
+// 高于噪声而远低于任何提示音的起音。SIMD 内核一次比较 4（SSE2）/ 8（AVX2）个采样，
+// 掩码非零时再逐个定位，绝大部分输入只做一次比较与一次 movemask。
+class SilenceScanner {
+public:
+    static constexpr double THRESHOLD_DBFS = -60.0;
+
+    explicit SilenceScanner(SimdLevel kernel = CpuFeatures::best());
+
+    // 追加 frames 帧交错立体声。找到非静音采样后返回 true，之后的输入不再扫描
+    bool add(const float* samples, size_t frames);
+
+    bool found() const { return m_found; }
+    // 首个非静音帧之前的帧数；尚未找到时为已扫描的帧数
+    uint64_t leadingFrames() const { return m_frames; }
+    SimdLevel getKernel() const { return m_kernel; }
+
+    // samples[0, count) 中首个 |x| > threshold 的下标，没有返回 count
+    static size_t findFirstAbove(const float* samples, size_t count, float threshold, SimdLevel kernel);
+
+private:
+    const SimdLevel m_kernel;
+    const float m_threshold;
+    uint64_t m_frames = 0;
+    bool m_found = false;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 有界单生产者/单消费者无锁队列（环形缓冲）。
+// 生产端与消费端各自只写自己的下标，另一端以 acquire 读取，全程无锁、无分配，
+// 可在音频渲染线程上安全使用。容量向上取整为 2 的幂；T 须可默认构造、可移动。
+// 多个生产线程必须在外部串行（例如持同一把锁）后再调用 tryPush。
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : m_capacity(roundUpPow2(capacity < 2 ? 2 : capacity)),
+          m_mask(m_capacity - 1),
+          m_slots(new T[m_capacity]) {
+        static_assert(std::is_default_constructible<T>::value, "SpscQueue 元素须可默认构造");
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    // 生产端：队满返回 false，value 保持不变
+    bool tryPush(T&& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == m_capacity) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == m_capacity) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(const T& value) {
+        T copy(value);
+        return tryPush(std::move(copy));
+    }
+
+    // 消费端：队空返回 false
+    bool tryPop(T& out) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) {
+                return false;
+            }
+        }
+        out = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似元素数（任一端调用均可，仅用于统计）
+    size_t sizeApprox() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // 生产端与消费端的下标分处不同缓存行，避免伪共享
+    static constexpr size_t kCacheLine = 64;
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    alignas(kCacheLine) std::atomic<size_t> m_head{0};  // 消费端写
+    size_t m_tailCache = 0;                             // 消费端私有
+
+    alignas(kCacheLine) std::atomic<size_t> m_tail{0};  // 生产端写
+    size_t m_headCache = 0;                             // 生产端私有
+};
@@ -1,12 +1,22 @@
 #include "StringUtil.h"
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 std::wstring StringUtil::utf8ToWide(const std::string& utf8Str) {
+#ifdef _WIN32
     return utf8ToWideWindows(utf8Str);
+#else
+    return utf8ToWidePosix(utf8Str);
+#endif
 }
 
 std::string StringUtil::wideToUtf8(const std::wstring& wideStr) {
+#ifdef _WIN32
     return wideToUtf8Windows(wideStr);
+#else
+    return wideToUtf8Posix(wideStr);
+#endif
 }
 
 std::wstring StringUtil::utf8ToWide(const char* utf8Str) {
@@ -19,6 +29,7 @@ std::string StringUtil::wideToUtf8(const wchar_t* wideStr) {
     return wideToUtf8(std::wstring(wideStr));
 }
 
+#ifdef _WIN32
 std::wstring StringUtil::utf8ToWideWindows(const std::string& utf8Str) {
     if (utf8Str.empty()) {
         return std::wstring();
@@ -47,4 +58,79 @@ std::string StringUtil::wideToUtf8Windows(const std::wstring& wideStr) {
     std::string result(size_needed - 1, 0);  // 减1去掉null终止符
     WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), -1, &result[0], size_needed, NULL, NULL);
     return result;
-}
\ No newline at end of file
+}
+#else
+std::wstring StringUtil::utf8ToWidePosix(const std::string& utf8Str) {
+    std::wstring result;
+    result.reserve(utf8Str.size());
+    size_t i = 0;
+    while (i < utf8Str.size()) {
+        unsigned char lead = static_cast<unsigned char>(utf8Str[i]);
+        int extra = 0;
+        char32_t codePoint = 0;
+        if (lead < 0x80) {
+            codePoint = lead;
+        } else if ((lead & 0xE0) == 0xC0) {
+            codePoint = lead & 0x1F;
+            extra = 1;
+        } else if ((lead & 0xF0) == 0xE0) {
+            codePoint = lead & 0x0F;
+            extra = 2;
+        } else if ((lead & 0xF8) == 0xF0) {
+            codePoint = lead & 0x07;
+            extra = 3;
+        } else {
+            // 非法首字节：与 MultiByteToWideChar 一致，替换为 U+FFFD
+            result.push_back(static_cast<wchar_t>(0xFFFD));
+            ++i;
+            continue;
+        }
+        if (i + extra >= utf8Str.size()) {
+            // 末尾序列被截断
+            result.push_back(static_cast<wchar_t>(0xFFFD));
+            break;
+        }
+        bool valid = true;
+        for (int k = 1; k <= extra; ++k) {
+            unsigned char cont = static_cast<unsigned char>(utf8Str[i + k]);
+            if ((cont & 0xC0) != 0x80) {
+                valid = false;
+                break;
+            }
+            codePoint = (codePoint << 6) | (cont & 0x3F);
+        }
+        if (!valid) {
+            result.push_back(static_cast<wchar_t>(0xFFFD));
+            ++i;
+            continue;
+        }
+        result.push_back(static_cast<wchar_t>(codePoint));
+        i += extra + 1;
+    }
+    return result;
+}
+
+std::string StringUtil::wideToUtf8Posix(const std::wstring& wideStr) {
+    std::string result;
+    result.reserve(wideStr.size() * 3);
+    for (wchar_t ch : wideStr) {
+        char32_t codePoint = static_cast<char32_t>(ch);
+        if (codePoint < 0x80) {
+            result.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+    return result;
+}
+#endif
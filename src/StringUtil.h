@@ -39,7 +39,13 @@ public:
     static std::string wideToUtf8(const wchar_t* wideStr);
 
 private:
+#ifdef _WIN32
     // 使用Windows API进行转换的内部函数
     static std::wstring utf8ToWideWindows(const std::string& utf8Str);
     static std::string wideToUtf8Windows(const std::wstring& wideStr);
+#else
+    // POSIX 下 wchar_t 为 UTF-32，直接按码点编解码（不依赖进程 locale）
+    static std::wstring utf8ToWidePosix(const std::string& utf8Str);
+    static std::string wideToUtf8Posix(const std::wstring& wideStr);
+#endif
 };
\ No newline at end of file
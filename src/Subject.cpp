@@ -1,6 +1,8 @@
 #include "Subject.h"
 #include "ConfigManager.h"
+#include "Clock.h"
 #include <map>
+#include <stdexcept>
 #include <sstream>
 #include <iomanip>
 
@@ -65,9 +67,8 @@ void Subject::setStartTime(const std::string& timeStr) {
         throw std::invalid_argument("Invalid time format");
     }
 
-    std::tm tm = {};
-    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    localtime_s(&tm, &now);
+    auto now = std::chrono::system_clock::to_time_t(Clock::system().now());
+    std::tm tm = toLocalTm(now);
 
     int hours = std::stoi(timeStr.substr(0, 2));
     int minutes = std::stoi(timeStr.substr(3, 2));
@@ -106,8 +107,7 @@ void Subject::setStartDateTime(const std::string& dateStr, const std::string& ti
 
 std::string Subject::getStartDateTimeString() const {
     auto time = std::chrono::system_clock::to_time_t(startTime);
-    std::tm tm = {};
-    localtime_s(&tm, &time);
+    std::tm tm = toLocalTm(time);
     std::stringstream ss;
     ss << (tm.tm_year + 1900) << "-"
        << std::setfill('0') << std::setw(2) << (tm.tm_mon + 1) << "-"
@@ -120,8 +120,7 @@ std::string Subject::getStartDateTimeString() const {
 std::string Subject::getEndDateTimeString() const {
     auto endTime = startTime + std::chrono::minutes(durationMinutes);
     auto time = std::chrono::system_clock::to_time_t(endTime);
-    std::tm tm = {};
-    localtime_s(&tm, &time);
+    std::tm tm = toLocalTm(time);
     std::stringstream ss;
     ss << (tm.tm_year + 1900) << "-"
        << std::setfill('0') << std::setw(2) << (tm.tm_mon + 1) << "-"
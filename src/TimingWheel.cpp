@@ -0,0 +1,201 @@
+#include "TimingWheel.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+int countTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+}  // namespace
+
+TimingWheel::TimingWheel(uint64_t startTick) : m_now(startTick) {
+    for (auto& level : m_heads) {
+        std::fill(std::begin(level), std::end(level), NIL);
+    }
+    for (auto& level : m_bitmap) {
+        std::fill(std::begin(level), std::end(level), 0);
+    }
+}
+
+TimingWheel::TimerId TimingWheel::schedule(uint64_t expiryTick, uint64_t payload) {
+    uint32_t index = allocNode();
+    Node& node = m_nodes[index];
+    node.expiry = expiryTick;
+    node.payload = payload;
+    place(index);
+    ++m_activeCount;
+    return (static_cast<TimerId>(node.generation) << 32) | index;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (id == INVALID_TIMER || index >= m_nodes.size()) {
+        return false;
+    }
+    Node& node = m_nodes[index];
+    if (node.level == LEVEL_FREE || node.generation != generation) {
+        return false;
+    }
+    unlink(index);
+    freeNode(index);
+    return true;
+}
+
+uint64_t TimingWheel::nextEventTick() const {
+    if (m_activeCount == 0) {
+        return NO_EVENT;
+    }
+
+    // 第 0 层：当前 256 tick 块内，精确到 tick
+    int slot = findOccupied(0, static_cast<int>(m_now & (SLOTS - 1)));
+    if (slot >= 0) {
+        return (m_now & ~uint64_t(SLOTS - 1)) | static_cast<uint64_t>(slot);
+    }
+
+    // 高层：层级越低事件越早，找到即返回对应槽起点
+    for (int level = 1; level < LEVELS; ++level) {
+        const int shift = SLOT_BITS * level;
+        const int current = static_cast<int>((m_now >> shift) & (SLOTS - 1));
+        if (current + 1 >= SLOTS) {
+            continue;
+        }
+        slot = findOccupied(level, current + 1);
+        if (slot >= 0) {
+            const int upperShift = shift + SLOT_BITS;
+            return ((m_now >> upperShift) << upperShift) | (static_cast<uint64_t>(slot) << shift);
+        }
+    }
+
+    // 只剩溢出链：下一个 2^32 边界时降级
+    const int topShift = SLOT_BITS * LEVELS;
+    return ((m_now >> topShift) + 1) << topShift;
+}
+
+uint32_t TimingWheel::allocNode() {
+    if (m_freeHead != NIL) {
+        uint32_t index = m_freeHead;
+        m_freeHead = m_nodes[index].next;
+        m_nodes[index].next = NIL;
+        return index;
+    }
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void TimingWheel::freeNode(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.level = LEVEL_FREE;
+    node.prev = NIL;
+    node.next = m_freeHead;
+    ++node.generation;
+    if (node.generation == 0) {
+        node.generation = 1;  // 保证 TimerId 永不为 INVALID_TIMER
+    }
+    m_freeHead = index;
+    --m_activeCount;
+}
+
+uint32_t& TimingWheel::headOf(int level, int slot) {
+    return level == LEVEL_OVERFLOW ? m_overflowHead : m_heads[level][slot];
+}
+
+void TimingWheel::place(uint32_t index) {
+    Node& node = m_nodes[index];
+    const uint64_t expiry = std::max(node.expiry, m_now);
+    const uint64_t diff = expiry ^ m_now;
+
+    int level = LEVEL_OVERFLOW;
+    for (int candidate = 0; candidate < LEVELS; ++candidate) {
+        if ((diff >> (SLOT_BITS * (candidate + 1))) == 0) {
+            level = candidate;
+            break;
+        }
+    }
+
+    int slot = 0;
+    if (level != LEVEL_OVERFLOW) {
+        slot = static_cast<int>((expiry >> (SLOT_BITS * level)) & (SLOTS - 1));
+        setBit(level, slot);
+    }
+    node.level = static_cast<int8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+
+    uint32_t& head = headOf(level, slot);
+    node.prev = NIL;
+    node.next = head;
+    if (head != NIL) {
+        m_nodes[head].prev = index;
+    }
+    head = index;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    Node& node = m_nodes[index];
+    uint32_t& head = headOf(node.level, node.slot);
+    if (node.prev != NIL) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        head = node.next;
+    }
+    if (node.next != NIL) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    if (head == NIL && node.level != LEVEL_OVERFLOW) {
+        clearBit(node.level, node.slot);
+    }
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+void TimingWheel::cascadeAtNow() {
+    // 从高到低处理：高层降下来的定时器可能正落在随后要降级的低层槽里
+    const int topShift = SLOT_BITS * LEVELS;
+    if ((m_now & ((uint64_t(1) << topShift) - 1)) == 0) {
+        uint32_t index = m_overflowHead;
+        while (index != NIL) {
+            uint32_t next = m_nodes[index].next;
+            if ((m_nodes[index].expiry >> topShift) <= (m_now >> topShift)) {
+                unlink(index);
+                place(index);
+            }
+            index = next;
+        }
+    }
+
+    for (int level = LEVELS - 1; level >= 1; --level) {
+        const int shift = SLOT_BITS * level;
+        if ((m_now & ((uint64_t(1) << shift) - 1)) != 0) {
+            continue;
+        }
+        const int slot = static_cast<int>((m_now >> shift) & (SLOTS - 1));
+        uint32_t index = m_heads[level][slot];
+        while (index != NIL) {
+            uint32_t next = m_nodes[index].next;
+            unlink(index);
+            place(index);
+            index = next;
+        }
+    }
+}
+
+int TimingWheel::findOccupied(int level, int from) const {
+    for (int word = from >> 6; word < SLOTS / 64; ++word) {
+        uint64_t bits = m_bitmap[level][word];
+        if (word == (from >> 6)) {
+            bits &= ~uint64_t(0) << (from & 63);
+        }
+        if (bits != 0) {
+            return word * 64 + countTrailingZeros(bits);
+        }
+    }
+    return -1;
+}
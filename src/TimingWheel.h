@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 分层时间轮：O(1) 插入/取消，推进时借占用位图跳过空槽。
+//
+// 4 层 × 256 槽，tick 单位由调用方决定（SessionScheduler 用毫秒）：
+// 第 0 层覆盖 256 tick，第 3 层覆盖 2^32 tick（毫秒下约 49.7 天），
+// 更远的定时器进溢出链，跨过 2^32 边界时再降级。
+// 定时器按 (到期 tick XOR 当前 tick) 的最高差异字节选层，
+// 当前 tick 跨过某层槽边界时把该槽整体降级（cascade）。
+//
+// 非线程安全：由单一调度线程独占使用。
+class TimingWheel {
+public:
+    using TimerId = uint64_t;  // 高 32 位为代数，低 32 位为节点下标
+    static constexpr TimerId INVALID_TIMER = 0;
+    static constexpr uint64_t NO_EVENT = UINT64_MAX;
+
+    explicit TimingWheel(uint64_t startTick = 0);
+
+    // 登记一个到期 tick 为 expiryTick 的定时器；早于当前 tick 的视为下一次推进即到期
+    TimerId schedule(uint64_t expiryTick, uint64_t payload);
+    // 取消未到期定时器；已到期/已取消/无效 id 返回 false
+    bool cancel(TimerId id);
+
+    // 推进到 targetTick（含），按到期顺序对每个到期定时器调用 fn(payload, expiryTick)。
+    // 回调内可以 schedule/cancel。返回触发个数。
+    template <typename Fn>
+    size_t advance(uint64_t targetTick, Fn&& fn);
+
+    // 下一次需要处理的 tick（下界：高层槽只精确到槽起点）。无定时器返回 NO_EVENT
+    uint64_t nextEventTick() const;
+
+    uint64_t currentTick() const { return m_now; }
+    size_t size() const { return m_activeCount; }
+    bool empty() const { return m_activeCount == 0; }
+
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr int8_t LEVEL_FREE = -1;
+    static constexpr int8_t LEVEL_OVERFLOW = LEVELS;
+
+    struct Node {
+        uint64_t expiry = 0;
+        uint64_t payload = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t generation = 1;
+        int8_t level = LEVEL_FREE;
+        uint8_t slot = 0;
+    };
+
+    uint32_t allocNode();
+    void freeNode(uint32_t index);
+    void place(uint32_t index);
+    void unlink(uint32_t index);
+    void cascadeAtNow();
+    uint32_t& headOf(int level, int slot);
+
+    void setBit(int level, int slot) { m_bitmap[level][slot >> 6] |= (uint64_t(1) << (slot & 63)); }
+    void clearBit(int level, int slot) { m_bitmap[level][slot >> 6] &= ~(uint64_t(1) << (slot & 63)); }
+    // 从 from 起（含）找第一个占用槽，没有返回 -1
+    int findOccupied(int level, int from) const;
+
+    uint64_t m_now;
+    size_t m_activeCount = 0;
+    std::vector<Node> m_nodes;
+    uint32_t m_freeHead = NIL;
+    uint32_t m_heads[LEVELS][SLOTS];
+    uint64_t m_bitmap[LEVELS][SLOTS / 64];
+    uint32_t m_overflowHead = NIL;
+};
+
+template <typename Fn>
+size_t TimingWheel::advance(uint64_t targetTick, Fn&& fn) {
+    size_t fired = 0;
+    while (m_now <= targetTick) {
+        uint64_t event = nextEventTick();
+        if (event == NO_EVENT || event > targetTick) {
+            // 区间内无事件：直接跳到 targetTick 之后，落在边界上时降级
+            m_now = targetTick + 1;
+            cascadeAtNow();
+            break;
+        }
+        if (event > m_now) {
+            m_now = event;
+            cascadeAtNow();
+        }
+
+        // 逐个弹出当前槽：回调中新登记的同 tick 定时器也会在本轮触发
+        const int slot = static_cast<int>(m_now & (SLOTS - 1));
+        uint32_t& head = headOf(0, slot);
+        while (head != NIL) {
+            uint32_t index = head;
+            uint64_t payload = m_nodes[index].payload;
+            uint64_t expiry = m_nodes[index].expiry;
+            unlink(index);
+            freeNode(index);
+            ++fired;
+            fn(payload, expiry);
+        }
+
+        ++m_now;
+        cascadeAtNow();
+    }
+    return fired;
+}
@@ -0,0 +1,533 @@
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "AudioHeaderParser.h"
+#include "PcmKernels.h"
+
+using namespace std::chrono;
+
+namespace {
+constexpr size_t kChannels = 2;
+
+void putU16(char* p, uint16_t v) {
+    p[0] = static_cast<char>(v & 0xFF);
+    p[1] = static_cast<char>(v >> 8);
+}
+
+void putU32(char* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+}
+
+void writeWavHeader(std::ofstream& file, uint32_t sampleRate, uint64_t frames) {
+    const uint32_t blockAlign = kChannels * sizeof(float);
+    // 超过 4 GB（约 3.4 小时 44.1kHz 立体声 float）时大小字段封顶，多数读取器按文件长度继续读
+    const uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(frames * blockAlign, 0xFFFFFFFFull - 36));
+    char header[44];
+    std::memcpy(header, "RIFF", 4);
+    putU32(header + 4, 36 + dataBytes);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    putU32(header + 16, 16);
+    putU16(header + 20, 3);  // WAVE_FORMAT_IEEE_FLOAT
+    putU16(header + 22, static_cast<uint16_t>(kChannels));
+    putU32(header + 24, sampleRate);
+    putU32(header + 28, sampleRate * blockAlign);
+    putU16(header + 32, static_cast<uint16_t>(blockAlign));
+    putU16(header + 34, 32);
+    std::memcpy(header + 36, "data", 4);
+    putU32(header + 40, dataBytes);
+    file.write(header, sizeof(header));
+}
+
+int32_t readSample(const unsigned char* p, uint32_t bytes) {
+    switch (bytes) {
+        case 1: return (static_cast<int32_t>(p[0]) - 128) * (1 << 24);
+        case 2: return static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 16 | static_cast<uint32_t>(p[1]) << 24);
+        case 3: return static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 |
+                                            static_cast<uint32_t>(p[2]) << 24);
+        default: return static_cast<int32_t>(static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                                             static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24);
+    }
+}
+
+float readFloat(const unsigned char* p, uint32_t bytes) {
+    if (bytes == 8) {
+        double value;
+        std::memcpy(&value, p, sizeof(value));
+        return static_cast<float>(value);
+    }
+    float value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 把 WAV 的 data 块解码为交错立体声 float（单声道复制，多声道取前两路）
+bool decodeWavData(const AudioFormatInfo& info, const char* data, size_t size, PcmBuffer& out) {
+    if (info.codec != AudioCodec::WAV_PCM && info.codec != AudioCodec::WAV_FLOAT) {
+        return false;
+    }
+    const uint32_t sampleBytes = info.bitsPerSample / 8;
+    const bool isFloat = info.codec == AudioCodec::WAV_FLOAT;
+    const bool supported = isFloat ? (sampleBytes == 4 || sampleBytes == 8) : (sampleBytes >= 1 && sampleBytes <= 4);
+    if (info.channels == 0 || !supported) {
+        return false;
+    }
+    const size_t frameBytes = static_cast<size_t>(sampleBytes) * info.channels;
+    const uint64_t available = info.dataOffset < size ? size - info.dataOffset : 0;
+    const size_t frames = static_cast<size_t>(std::min<uint64_t>(info.dataBytes, available) / frameBytes);
+    const auto* base = reinterpret_cast<const unsigned char*>(data) + info.dataOffset;
+
+    out.sampleRate = info.sampleRate;
+    out.samples.resize(frames * kChannels);
+    // 16 位单/双声道（提示音素材的绝大多数）：整段交给 PCM 内核换算
+    if (!isFloat && sampleBytes == 2 && info.channels <= 2) {
+        const PcmKernels& kernels = PcmKernels::get();
+        const auto* pcm = reinterpret_cast<const int16_t*>(base);
+        if (info.channels == 2) {
+            kernels.int16ToFloat(pcm, out.samples.data(), frames * kChannels);
+        } else {
+            // 先换算到后半段，再原地展开为立体声（读在写之前，不会覆盖未读的采样）
+            float* mono = out.samples.data() + frames;
+            kernels.int16ToFloat(pcm, mono, frames);
+            kernels.monoToStereo(mono, out.samples.data(), frames);
+        }
+        return frames > 0;
+    }
+    constexpr float kScale = 1.0f / 2147483648.0f;
+    for (size_t i = 0; i < frames; ++i) {
+        const unsigned char* frame = base + i * frameBytes;
+        const unsigned char* right = info.channels > 1 ? frame + sampleBytes : frame;
+        out.samples[i * 2] = isFloat ? readFloat(frame, sampleBytes) : readSample(frame, sampleBytes) * kScale;
+        out.samples[i * 2 + 1] = isFloat ? readFloat(right, sampleBytes) : readSample(right, sampleBytes) * kScale;
+    }
+    return frames > 0;
+}
+
+// 占位源：按时长输出静音（不能解码的格式仍按真实时长参与调度）
+class SilenceSource : public MixerSource {
+public:
+    explicit SilenceSource(uint64_t frames) : m_remaining(frames) {}
+
+    size_t read(float* out, size_t frames) override {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(frames, m_remaining));
+        std::fill(out, out + count * kChannels, 0.0f);
+        m_remaining -= count;
+        return count;
+    }
+
+private:
+    uint64_t m_remaining;
+};
+
+// 读取故障：读出 limit 帧后提前读尽
+class FaultySource : public MixerSource {
+public:
+    FaultySource(std::unique_ptr<MixerSource> inner, uint64_t limit) : m_inner(std::move(inner)), m_remaining(limit) {}
+
+    size_t read(float* out, size_t frames) override {
+        size_t count = m_inner->read(out, static_cast<size_t>(std::min<uint64_t>(frames, m_remaining)));
+        m_remaining -= count;
+        return count;
+    }
+
+private:
+    std::unique_ptr<MixerSource> m_inner;
+    uint64_t m_remaining;
+};
+
+std::unique_ptr<MixerSource> toMixRate(std::unique_ptr<MixerSource> source, uint32_t inputRate, uint32_t mixRate) {
+    if (inputRate == 0 || inputRate == mixRate) {
+        return source;
+    }
+    return std::make_unique<ResamplingSource>(std::move(source), inputRate, mixRate);
+}
+}  // namespace
+
+// 模拟设备：自打开起按采样率（含时钟偏差）消耗已写入的帧
+class WavSinkBackend::Output : public MixerOutput {
+public:
+    Output(uint32_t sampleRate, std::ofstream* file, double clockPpm = 0.0, double stallAfterSeconds = 0.0,
+           double failAfterSeconds = 0.0)
+        : m_sampleRate(sampleRate), m_clockRate(sampleRate * (1.0 + clockPpm * 1e-6)), m_file(file),
+          m_start(steady_clock::now()), m_stallAfter(stallAfterSeconds), m_failAfter(failAfterSeconds) {}
+
+    size_t queuedFrames() override {
+        double elapsed = duration<double>(steady_clock::now() - m_start).count();
+        if (failed(elapsed)) {
+            return 0;  // 与 BASS 推送流在设备消失后查询失败一致
+        }
+        if (m_stallAfter > 0.0) {
+            elapsed = std::min(elapsed, m_stallAfter);
+        }
+        const uint64_t consumed = static_cast<uint64_t>(elapsed * m_clockRate);
+        const uint64_t written = m_written.load(std::memory_order_relaxed);
+        if (consumed > written) {
+            // 欠载：设备已播到写入位置之后，补静音让 WAV 时间轴与墙钟对齐
+            pad(consumed - written);
+            return 0;
+        }
+        return static_cast<size_t>(written - consumed);
+    }
+
+    bool write(const float* samples, size_t frames) override {
+        if (failed(duration<double>(steady_clock::now() - m_start).count())) {
+            return false;
+        }
+        if (m_file && m_file->is_open()) {
+            m_file->write(reinterpret_cast<const char*>(samples),
+                          static_cast<std::streamsize>(frames * kChannels * sizeof(float)));
+        }
+        m_written.fetch_add(frames, std::memory_order_release);
+        return true;
+    }
+
+    steady_clock::time_point startTime() const { return m_start; }
+
+    const std::atomic<uint64_t>& writtenCounter() const { return m_written; }
+    uint64_t written() const { return m_written.load(std::memory_order_acquire); }
+    uint64_t padded() const { return m_padded.load(std::memory_order_relaxed); }
+    uint32_t sampleRate() const { return m_sampleRate; }
+    double clockRate() const { return m_clockRate; }
+
+private:
+    bool failed(double elapsed) const { return m_failAfter > 0.0 && elapsed >= m_failAfter; }
+
+    void pad(uint64_t frames) {
+        static const float kSilence[1024 * kChannels] = {};
+        uint64_t remaining = frames;
+        while (remaining > 0) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(remaining, 1024));
+            write(kSilence, count);
+            remaining -= count;
+        }
+        m_padded.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    const uint32_t m_sampleRate;
+    const double m_clockRate;  // 实际每秒消耗的帧数
+    std::ofstream* m_file;
+    const steady_clock::time_point m_start;
+    const double m_stallAfter;
+    const double m_failAfter;
+    std::atomic<uint64_t> m_written{0};
+    std::atomic<uint64_t> m_padded{0};
+};
+
+// 一路声部的记录：控制端登记，渲染线程只写原子量
+struct WavSinkBackend::Slot {
+    std::string filename;
+    steady_clock::time_point requestTime;
+    std::atomic<int64_t> startFrame{-1};
+    std::atomic<uint64_t> framesRead{0};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> released{false};
+};
+
+// 记录首帧位置与已读帧数；析构（混音器释放声部）即为停止
+class WavSinkBackend::TracingSource : public MixerSource {
+public:
+    TracingSource(std::unique_ptr<MixerSource> inner, std::shared_ptr<Slot> slot,
+                  const std::atomic<uint64_t>& written)
+        : m_inner(std::move(inner)), m_slot(std::move(slot)), m_written(written) {}
+
+    ~TracingSource() override {
+        m_slot->released.store(true, std::memory_order_release);
+    }
+
+    // 混音器整块渲染后才写出，读取时的已写帧数即本块在输出中的起点
+    size_t read(float* out, size_t frames) override {
+        size_t count = m_inner->read(out, frames);
+        if (count > 0 && m_slot->startFrame.load(std::memory_order_relaxed) < 0) {
+            m_slot->startFrame.store(static_cast<int64_t>(m_written.load(std::memory_order_acquire)),
+                                     std::memory_order_release);
+        }
+        m_slot->framesRead.fetch_add(count, std::memory_order_release);
+        if (count < frames) {
+            m_slot->finished.store(true, std::memory_order_release);
+        }
+        return count;
+    }
+
+private:
+    std::unique_ptr<MixerSource> m_inner;
+    std::shared_ptr<Slot> m_slot;
+    const std::atomic<uint64_t>& m_written;
+};
+
+WavSinkBackend::WavSinkBackend(WavSinkOptions options) : m_options(std::move(options)) {}
+
+WavSinkBackend::~WavSinkBackend() {
+    close();
+}
+
+bool WavSinkBackend::open(MixerConfig& config) {
+    if (m_open) {
+        return true;
+    }
+    if (m_options.sampleRate == 0 || m_options.blockFrames == 0) {
+        std::fputs("[WavSink] 采样率与块大小须为正\n", stderr);
+        return false;
+    }
+    m_active.clear();
+    if (m_options.devices.empty()) {
+        WavSinkDevice device;
+        device.name = "WAV";
+        device.path = m_options.path;
+        m_active.push_back(std::move(device));
+    } else {
+        for (size_t i = 0; i < m_options.devices.size(); ++i) {
+            const WavSinkDevice& device = m_options.devices[i];
+            bool selected = m_selection.empty();
+            for (const auto& wanted : m_selection) {
+                selected = selected || wanted == std::to_string(i + 1) ||
+                           (!wanted.empty() && device.name.find(wanted) != std::string::npos);
+            }
+            if (selected) {
+                m_active.push_back(device);
+            }
+        }
+        if (m_active.empty()) {
+            std::fputs("[WavSink] 所选设备都不存在，只用第一台\n", stderr);
+            m_active.push_back(m_options.devices.front());
+        }
+    }
+
+    m_files.clear();
+    for (const auto& device : m_active) {
+        std::unique_ptr<std::ofstream> file;
+        if (!device.path.empty()) {
+            file = std::make_unique<std::ofstream>(device.path, std::ios::binary | std::ios::trunc);
+            if (!*file) {
+                std::fprintf(stderr, "[WavSink] 无法写入 %s\n", device.path.u8string().c_str());
+                m_files.clear();
+                return false;
+            }
+            writeWavHeader(*file, m_options.sampleRate, 0);
+        }
+        m_files.push_back(std::move(file));
+    }
+
+    config.sampleRate = m_options.sampleRate;
+    config.blockFrames = m_options.blockFrames;
+    config.targetQueuedFrames = m_options.blockFrames * std::max<size_t>(m_options.queuedBlocks, 1);
+
+    {
+        std::lock_guard<std::mutex> lock(m_slotsMutex);
+        m_slots.clear();
+    }
+    m_fanOut.reset();
+    m_outputs.clear();
+    std::vector<FanOutDevice> fanOut;
+    for (size_t i = 0; i < m_active.size(); ++i) {
+        m_outputs.push_back(std::make_unique<Output>(m_options.sampleRate, m_files[i].get(), m_active[i].clockPpm,
+                                                     m_active[i].stallAfterSeconds, m_active[i].failAfterSeconds));
+        FanOutDevice device;
+        device.name = m_active[i].name;
+        device.output = m_outputs.back().get();
+        const double latencyMs = std::max(0.0, m_active[i].latencyMs);
+        device.latencyFrames = static_cast<size_t>(latencyMs * m_options.sampleRate / 1000.0 + 0.5);
+        fanOut.push_back(std::move(device));
+    }
+    if (m_outputs.size() > 1) {
+        m_fanOut = std::make_unique<FanOutOutput>(std::move(fanOut), m_options.sampleRate,
+                                                  m_options.driftToleranceFrames);
+    }
+    m_open = true;
+    return true;
+}
+
+void WavSinkBackend::close() {
+    if (!m_open) {
+        return;
+    }
+    bool wroteFile = false;
+    for (size_t i = 0; i < m_files.size(); ++i) {
+        if (m_files[i]) {
+            m_files[i]->seekp(0);
+            writeWavHeader(*m_files[i], m_options.sampleRate, m_outputs[i]->written());
+            m_files[i]->close();
+            wroteFile = true;
+        }
+    }
+    if (wroteFile && m_options.writeEventLog && !writeEventLog()) {
+        std::fputs("[WavSink] 事件记录写入失败\n", stderr);
+    }
+    m_open = false;
+}
+
+MixerOutput& WavSinkBackend::output() {
+    if (m_fanOut) {
+        return *m_fanOut;
+    }
+    return *m_outputs.front();
+}
+
+void WavSinkBackend::setOutputDevices(const std::vector<std::string>& devices) {
+    m_selection = devices;
+}
+
+std::vector<OutputDeviceStats> WavSinkBackend::getDeviceStats() const {
+    return m_fanOut ? m_fanOut->getStats() : std::vector<OutputDeviceStats>();
+}
+
+double WavSinkBackend::getOutputLatencyMs() const {
+    double latencyMs = 0.0;
+    for (const auto& device : m_active) {
+        latencyMs = std::max(latencyMs, device.latencyMs);
+    }
+    return m_open ? latencyMs : 0.0;
+}
+
+steady_clock::time_point WavSinkBackend::getDeviceFrameTime(size_t device, uint64_t frame) const {
+    const Output& output = *m_outputs.at(device);
+    const double seconds = frame / output.clockRate() + m_active.at(device).latencyMs / 1000.0;
+    return output.startTime() + duration_cast<steady_clock::duration>(duration<double>(seconds));
+}
+
+namespace {
+// 文件头识别后解码：WAV 完整解码，其他格式按文件头时长输出静音
+std::unique_ptr<MixerSource> openDecoded(const std::filesystem::path& path, AudioBytes data, uint32_t mixRate,
+                                         double startSeconds, double* durationSeconds) {
+    AudioFormatInfo info;
+    bool recognized = !data.empty() ? AudioHeaderParser::probeMemory(data.data, data.size, info)
+                                    : AudioHeaderParser::probeFile(path, info);
+    if (!recognized) {
+        return nullptr;
+    }
+
+    if (info.codec == AudioCodec::WAV_PCM || info.codec == AudioCodec::WAV_FLOAT) {
+        if (data.empty()) {
+            // 按文件大小一次读入（完整解码预检逐个读入全部素材，逐字符迭代在此处占大头）
+            std::error_code ec;
+            const uint64_t size = std::filesystem::file_size(path, ec);
+            auto bytes = std::make_shared<std::vector<char>>(ec ? 0 : static_cast<size_t>(size));
+            std::ifstream file(path, std::ios::binary);
+            if (!bytes->empty() && !file.read(bytes->data(), static_cast<std::streamsize>(bytes->size()))) {
+                bytes->resize(static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0)));
+            }
+            data = AudioBytes::fromVector(std::move(bytes));
+        }
+        auto pcm = std::make_shared<PcmBuffer>();
+        if (decodeWavData(info, data.data, data.size, *pcm)) {
+            *durationSeconds = pcm->durationSeconds();
+            uint32_t rate = pcm->sampleRate;
+            auto startFrame = static_cast<size_t>(std::max(0.0, startSeconds) * rate + 0.5);
+            return toMixRate(std::make_unique<PcmBufferSource>(std::move(pcm), startFrame), rate, mixRate);
+        }
+    }
+
+    // 不能解码：按文件头时长输出静音
+    *durationSeconds = info.durationSeconds;
+    double remaining = std::max(0.0, info.durationSeconds - std::max(0.0, startSeconds));
+    return std::make_unique<SilenceSource>(static_cast<uint64_t>(remaining * mixRate + 0.5));
+}
+}  // namespace
+
+std::unique_ptr<MixerSource> WavSinkBackend::openSource(const std::filesystem::path& path, AudioBytes data,
+                                                        uint32_t mixRate, double startSeconds, bool prime,
+                                                        double* durationSeconds) {
+    (void)prime;  // 整段解码在打开时完成，无需预解码首段
+    const bool fromDisk = data.empty();
+    std::unique_ptr<MixerSource> source = openDecoded(path, std::move(data), mixRate, startSeconds, durationSeconds);
+    if (!source || !fromDisk) {
+        return source;
+    }
+    for (const auto& fault : m_options.readFaults) {
+        if (fault.path == path) {
+            const double frames = std::max(0.0, fault.seconds - std::max(0.0, startSeconds)) * mixRate;
+            return std::make_unique<FaultySource>(std::move(source), static_cast<uint64_t>(frames + 0.5));
+        }
+    }
+    return source;
+}
+
+bool WavSinkBackend::canDecode(const AudioFormatInfo& info) const {
+    return info.codec == AudioCodec::WAV_PCM || info.codec == AudioCodec::WAV_FLOAT;
+}
+
+bool WavSinkBackend::decodeToPcm(const std::vector<char>& bytes, PcmBuffer& out) {
+    AudioFormatInfo info;
+    return AudioHeaderParser::probeMemory(bytes.data(), bytes.size(), info) &&
+           decodeWavData(info, bytes.data(), bytes.size(), out);
+}
+
+std::unique_ptr<MixerSource> WavSinkBackend::traceVoice(const std::string& filename,
+                                                        std::unique_ptr<MixerSource> source) {
+    auto slot = std::make_shared<Slot>();
+    slot->filename = filename;
+    slot->requestTime = steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_slotsMutex);
+        m_slots.push_back(slot);
+    }
+    const std::atomic<uint64_t>& written = m_fanOut ? m_fanOut->writtenCounter() : m_outputs.front()->writtenCounter();
+    return std::make_unique<TracingSource>(std::move(source), std::move(slot), written);
+}
+
+std::vector<WavSinkEvent> WavSinkBackend::getEvents() const {
+    std::vector<WavSinkEvent> events;
+    if (m_outputs.empty()) {
+        return events;
+    }
+    const double rate = m_options.sampleRate;
+    // 多设备时按第一台设备折算出声时刻（计入起播补偿，不计追平漂移的丢帧）
+    const uint64_t compensation = m_fanOut ? m_fanOut->getStats().front().compensationFrames : 0;
+    std::lock_guard<std::mutex> lock(m_slotsMutex);
+    events.reserve(m_slots.size());
+    for (const auto& slot : m_slots) {
+        WavSinkEvent event;
+        event.filename = slot->filename;
+        event.requestTime = slot->requestTime;
+        int64_t start = slot->startFrame.load(std::memory_order_acquire);
+        event.started = start >= 0;
+        event.finished = slot->finished.load(std::memory_order_acquire);
+        event.stoppedEarly = slot->released.load(std::memory_order_acquire) && !event.finished;
+        if (event.started) {
+            event.startFrame = static_cast<uint64_t>(start);
+            event.endFrame = event.startFrame + slot->framesRead.load(std::memory_order_acquire);
+            event.startSeconds = event.startFrame / rate;
+            event.endSeconds = event.endFrame / rate;
+            auto onset = getDeviceFrameTime(0, event.startFrame + compensation);
+            event.onsetLatencyMs = duration<double, std::milli>(onset - slot->requestTime).count();
+        }
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+uint64_t WavSinkBackend::getWrittenFrames() const {
+    return m_outputs.empty() ? 0 : m_outputs.front()->written();
+}
+
+uint64_t WavSinkBackend::getPaddedFrames() const {
+    return m_outputs.empty() ? 0 : m_outputs.front()->padded();
+}
+
+bool WavSinkBackend::writeEventLog() const {
+    std::filesystem::path logPath;
+    for (const auto& device : m_active) {
+        if (!device.path.empty()) {
+            logPath = device.path;
+            break;
+        }
+    }
+    logPath += ".events.txt";
+    std::ofstream file(logPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << "# EVCS WAV sink events, sample_rate=" << m_options.sampleRate << "\n"
+         << "# start_s\tend_s\tonset_ms\tstate\tfile\n";
+    char buf[128];
+    for (const auto& event : getEvents()) {
+        const char* state = !event.started ? "not-started"
+                            : event.finished ? "finished"
+                            : event.stoppedEarly ? "stopped" : "playing";
+        std::snprintf(buf, sizeof(buf), "%.6f\t%.6f\t%.3f\t%s\t", event.startSeconds, event.endSeconds,
+                      event.onsetLatencyMs, state);
+        file << buf << event.filename << '\n';
+    }
+    return static_cast<bool>(file.flush());
+}
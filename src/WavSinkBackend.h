@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AudioBackend.h"
+
+// 一路声部在输出中的实际起止（以 WAV 采样位置计，与墙钟一一对应）
+struct WavSinkEvent {
+    std::string filename;
+    std::chrono::steady_clock::time_point requestTime;  // 交给混音器的时刻
+    bool started = false;        // 渲染线程已读到首帧
+    bool finished = false;       // 源自然读尽
+    bool stoppedEarly = false;   // 未读尽即被停止/抢占释放
+    uint64_t startFrame = 0;     // 首帧在输出中的位置
+    uint64_t endFrame = 0;       // 末帧之后的位置（仍在播放时为当前已读到的位置）
+    double startSeconds = 0.0;   // startFrame 折算的秒数（相对输出起点）
+    double endSeconds = 0.0;
+    double onsetLatencyMs = 0.0; // 首帧被“设备”播出的时刻 - requestTime
+};
+
+// 模拟的一台输出设备（多设备扇出）
+struct WavSinkDevice {
+    std::string name;
+    std::filesystem::path path;  // 该设备的输出 WAV，为空则不写
+    double latencyMs = 0.0;      // 排队之外的固定输出延迟（驱动/硬件缓冲），作为测得的设备延迟交给扇出
+    double clockPpm = 0.0;       // 设备时钟相对墙钟的偏差（百万分之一，正为快），模拟各声卡晶振不同
+    // 设备故障（看门狗用）：打开后这么多秒起不再取数据（驱动挂起），或写入失败（设备拔出）。0 表示不发生
+    double stallAfterSeconds = 0.0;
+    double failAfterSeconds = 0.0;
+};
+
+// 模拟读取故障：从磁盘打开 path 的解码源读到文件中 seconds 处即提前读尽（U 盘拔出、坏扇区）。
+// 从内存（预载池、打包文件映射、预热时整读入内存的小文件）建的源不受影响
+struct WavSinkReadFault {
+    std::filesystem::path path;
+    double seconds = 0.0;
+};
+
+struct WavSinkOptions {
+    std::filesystem::path path;  // 输出 WAV（32 位 float 立体声）；为空则只记录事件不写文件
+    uint32_t sampleRate = 44100;
+    size_t blockFrames = 441;    // 每块 10ms
+    size_t queuedBlocks = 4;     // 渲染线程维持的排队块数，与 BASS 后端一致
+    bool writeEventLog = true;   // close() 时在 WAV 旁写 <path>.events.txt
+    // 非空时模拟多台设备，混音结果经 FanOutOutput 扇出到 setOutputDevices 选中的各台（未选择时为全部）。
+    // 此时不用 path：各设备写各自的 WAV，事件记录写在第一台设备的 WAV 旁
+    std::vector<WavSinkDevice> devices;
+    size_t driftToleranceFrames = 2;  // 多设备：超前量超过此值即丢帧追平（模拟设备的排队量是精确的）
+    std::vector<WavSinkReadFault> readFaults;
+};
+
+// 无声卡的音频后端：以墙钟模拟一台按采样率消耗数据的设备，混音结果原样写入 WAV，
+// 并记录每一路声部首帧/末帧在输出中的采样位置。
+//
+// 设备自 open() 起开始走，WAV 第 f 帧对应 open() 时刻 + f / sampleRate；
+// 渲染跟不上（欠载）时按实际耽误的时长补静音，WAV 的时间轴始终与墙钟一致。
+// 因此起播延迟、叠加与调度行为可以在 Linux/CI 上按采样精度测量。
+//
+// 设置 devices 时模拟多台各有延迟与时钟偏差的设备（各自一个 WAV），用于在 Linux 上测量多设备起播对齐：
+// 某一帧在第 i 台设备上的出声时刻见 getDeviceFrameTime()。
+//
+// 解码：WAV（整数 PCM / float）完整解码；MP3 等仅能识别文件头的格式按头部时长输出静音占位，
+// 时序照常记录。文件头也无法识别的文件打开失败（与损坏文件在 BASS 下的表现一致）。
+class WavSinkBackend : public IAudioBackend {
+public:
+    explicit WavSinkBackend(WavSinkOptions options = WavSinkOptions());
+    ~WavSinkBackend() override;
+
+    const char* name() const override { return "WAV"; }
+
+    bool open(MixerConfig& config) override;
+    // 回填 WAV 头并写出事件记录。事件在 close() 之后仍可查询，下一次 open() 时清空
+    void close() override;
+    MixerOutput& output() override;
+    // 按 1 起的编号或名称片段从 options.devices 中选择；都不匹配时只用第一台。未设置 devices 时无效
+    void setOutputDevices(const std::vector<std::string>& devices) override;
+    std::vector<OutputDeviceStats> getDeviceStats() const override;
+    // 已打开设备 latencyMs 的最大值
+    double getOutputLatencyMs() const override;
+
+    std::unique_ptr<MixerSource> openSource(const std::filesystem::path& path, AudioBytes data, uint32_t mixRate,
+                                            double startSeconds, bool prime, double* durationSeconds) override;
+    // 只解码整数/浮点 PCM 的 WAV，其他格式以文件头时长的静音占位
+    bool canDecode(const AudioFormatInfo& info) const override;
+    // 只解码 WAV；其他格式返回 false（预载池保留原文件字节，播放时走静音占位）
+    bool decodeToPcm(const std::vector<char>& bytes, PcmBuffer& out) override;
+    std::unique_ptr<MixerSource> traceVoice(const std::string& filename,
+                                            std::unique_ptr<MixerSource> source) override;
+
+    // 按交给混音器的先后排列
+    std::vector<WavSinkEvent> getEvents() const;
+    uint64_t getWrittenFrames() const;  // 含补的静音（多设备时为第一台）
+    uint64_t getPaddedFrames() const;   // 欠载时补的静音帧（多设备时为第一台）
+    uint32_t getSampleRate() const { return m_options.sampleRate; }
+
+    // 已打开的设备（未设置 devices 时为一台，名为 "WAV"）
+    const std::vector<WavSinkDevice>& getDevices() const { return m_active; }
+    // 第 device 台设备输出中第 frame 帧实际出声的时刻：设备起点 + 按该设备时钟折算 + 设备延迟
+    std::chrono::steady_clock::time_point getDeviceFrameTime(size_t device, uint64_t frame) const;
+
+private:
+    class Output;
+    class TracingSource;
+    struct Slot;
+
+    bool writeEventLog() const;
+
+    const WavSinkOptions m_options;
+    std::vector<std::string> m_selection;
+    std::vector<WavSinkDevice> m_active;
+    std::vector<std::unique_ptr<std::ofstream>> m_files;  // 与 m_active 一一对应，不写文件的为空
+    std::vector<std::unique_ptr<Output>> m_outputs;
+    std::unique_ptr<FanOutOutput> m_fanOut;               // 多于一台设备时
+    bool m_open = false;
+
+    mutable std::mutex m_slotsMutex;
+    std::vector<std::shared_ptr<Slot>> m_slots;
+};
@@ -0,0 +1,142 @@
+#include "XxHash64.h"
+#include <cstring>
+
+namespace {
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// 按小端读取（格式定义如此）。小端主机（x86/x64/ARM 默认）直接 memcpy，编译为一次加载
+inline uint64_t read64(const unsigned char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+#else
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+#endif
+}
+
+inline uint32_t read32(const unsigned char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+#else
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+#endif
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+// 四路累加器各吃 8 字节，共 32 字节一条带
+inline const unsigned char* consumeStripes(uint64_t* acc, const unsigned char* p, const unsigned char* end) {
+    uint64_t a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+    for (; p + 32 <= end; p += 32) {
+        a0 = round(a0, read64(p));
+        a1 = round(a1, read64(p + 8));
+        a2 = round(a2, read64(p + 16));
+        a3 = round(a3, read64(p + 24));
+    }
+    acc[0] = a0;
+    acc[1] = a1;
+    acc[2] = a2;
+    acc[3] = a3;
+    return p;
+}
+}  // namespace
+
+XxHash64::XxHash64(uint64_t seed) : m_seed(seed) {
+    m_acc[0] = seed + kPrime1 + kPrime2;
+    m_acc[1] = seed + kPrime2;
+    m_acc[2] = seed;
+    m_acc[3] = seed - kPrime1;
+}
+
+void XxHash64::update(const void* data, size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    m_totalLength += length;
+
+    if (m_bufferedBytes + length < 32) {
+        if (length > 0) {
+            std::memcpy(m_buffer + m_bufferedBytes, p, length);
+        }
+        m_bufferedBytes += length;
+        return;
+    }
+    if (m_bufferedBytes > 0) {
+        size_t fill = 32 - m_bufferedBytes;
+        std::memcpy(m_buffer + m_bufferedBytes, p, fill);
+        consumeStripes(m_acc, m_buffer, m_buffer + 32);
+        p += fill;
+        m_bufferedBytes = 0;
+    }
+    p = consumeStripes(m_acc, p, end);
+    m_bufferedBytes = static_cast<size_t>(end - p);
+    if (m_bufferedBytes > 0) {
+        std::memcpy(m_buffer, p, m_bufferedBytes);
+    }
+}
+
+uint64_t XxHash64::digest() const {
+    uint64_t h;
+    if (m_totalLength >= 32) {
+        h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+        for (uint64_t acc : m_acc) {
+            h = mergeRound(h, acc);
+        }
+    } else {
+        h = m_seed + kPrime5;
+    }
+    h += m_totalLength;
+
+    const unsigned char* p = m_buffer;
+    const unsigned char* end = m_buffer + m_bufferedBytes;
+    for (; p + 8 <= end; p += 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= *p * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t XxHash64::hash(const void* data, size_t length, uint64_t seed) {
+    XxHash64 hasher(seed);
+    hasher.update(data, length);
+    return hasher.digest();
+}
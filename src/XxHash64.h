@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// XXH64（xxHash 64 位）：非加密的快速校验哈希，用于音频目录完整性清单。
+// 与参考实现逐位一致（同一文件在任何平台、任意分段喂入得到同一值），可分段 update()
+class XxHash64 {
+public:
+    explicit XxHash64(uint64_t seed = 0);
+
+    void update(const void* data, size_t length);
+    uint64_t digest() const;
+
+    // 一次性计算
+    static uint64_t hash(const void* data, size_t length, uint64_t seed = 0);
+
+private:
+    uint64_t m_acc[4];
+    uint64_t m_seed;
+    uint64_t m_totalLength = 0;
+    unsigned char m_buffer[32];
+    size_t m_bufferedBytes = 0;
+};
@@ -1,5 +1,6 @@
 #include "MainWindow.h"
 #include "AudioPlayer.h"
+#include "BassAudioBackend.h"
 
 namespace {
 // RAII 守卫：考试期间持续阻止系统休眠与熄屏（AGENTS.md 不变量 §2）。
@@ -29,7 +30,8 @@ int WINAPI wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PWSTR
     // 必须先于任何可能阻塞消息泵的逻辑；RAII 保证任何退出路径都还原。
     PowerStateGuard powerGuard;
 
-    // 初始化音频播放器
+    // 初始化音频播放器（BASS 输出到默认设备）
+    AudioPlayer::setBackend(std::make_unique<BassAudioBackend>());
     if (!AudioPlayer::initialize()) {
         MessageBoxW(NULL, L"音频系统初始化失败", L"错误", MB_OK | MB_ICONERROR);
         return 1;
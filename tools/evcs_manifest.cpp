@@ -0,0 +1,103 @@
+// evcs-manifest：audio 目录完整性清单。发布时生成（script/release.bat 第 4 步），
+// 考场机上程序启动时自动校验；本工具也可在拷盘后手动校验。
+//
+// 用法：evcs-manifest generate <audio-dir> [--threads N]
+//       evcs-manifest verify <audio-dir> [--threads N]
+#include "AudioManifest.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+    std::printf(
+        "用法: evcs-manifest generate <audio-dir> [--threads N]\n"
+        "      evcs-manifest verify <audio-dir> [--threads N]\n"
+        "  generate      计算目录下全部文件的 XXH64，写入 %s\n"
+        "  verify        按清单校验目录，大小与修改时间未变的文件沿用上次结果；有异常时退出码 1\n"
+        "  --threads N   计算哈希的线程数（默认按 CPU 核数，2~8）\n",
+        AudioManifest::MANIFEST_FILENAME);
+}
+
+double megabytes(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+int generate(const std::filesystem::path& dir, const std::string& dirArg, size_t threads) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<ManifestEntry> entries;
+    std::string error;
+    if (!AudioManifest::generate(dir, threads, entries, error)) {
+        std::fprintf(stderr, "生成清单失败: %s（%s）\n", dirArg.c_str(), error.c_str());
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t bytes = 0;
+    for (const auto& entry : entries) {
+        bytes += entry.size;
+    }
+    std::printf("已生成 %s: %zu 个文件, %.1f MB, 耗时 %.0f ms (%.0f MB/s)\n",
+                (dir / AudioManifest::MANIFEST_FILENAME).u8string().c_str(), entries.size(), megabytes(bytes), ms,
+                ms > 0 ? megabytes(bytes) / (ms / 1000.0) : 0.0);
+    return 0;
+}
+
+int verify(const std::filesystem::path& dir, const std::string& dirArg, size_t threads) {
+    ManifestVerifier verifier;
+    verifier.setThreads(threads);
+    const ManifestReport report = verifier.verify(dir);
+    if (!report.manifestFound) {
+        std::fprintf(stderr, "未找到清单: %s/%s\n", dirArg.c_str(), AudioManifest::MANIFEST_FILENAME);
+        return 1;
+    }
+    std::printf("校验 %s: %zu 个文件, 通过 %zu（沿用上次结果 %zu，重新计算 %zu 个 / %.1f MB）, %zu 线程, 耗时 %.0f ms\n",
+                dirArg.c_str(), report.files, report.verifiedFiles, report.reusedFiles, report.hashedFiles,
+                megabytes(report.hashedBytes), report.threads, report.elapsedMs);
+    if (report.unlistedFiles > 0) {
+        std::printf("清单未登记的文件: %zu 个\n", report.unlistedFiles);
+    }
+    for (const auto& problem : report.problems) {
+        std::printf("  %-8s %s\n", AudioManifest::problemName(problem.second), problem.first.c_str());
+    }
+    if (!report.problems.empty()) {
+        std::printf("异常: %zu 个文件\n", report.problems.size());
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    const std::string command = argv[1];
+    const std::string dirArg = argv[2];
+    size_t threads = 0;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "未知选项: %s\n", arg.c_str());
+            printUsage();
+            return 2;
+        }
+    }
+
+    const std::filesystem::path dir = std::filesystem::u8path(dirArg);
+    if (command == "generate") {
+        return generate(dir, dirArg, threads);
+    }
+    if (command == "verify") {
+        return verify(dir, dirArg, threads);
+    }
+    printUsage();
+    return 2;
+}
@@ -0,0 +1,129 @@
+// evcs-pack：把 audio 目录下的音频打成一个打包文件（evcs_audio.pak），程序运行时整体内存映射，
+// 按文件名取音频只查索引。包里没有的文件照旧取散文件，可只打包常用的部分。
+//
+// 用法：evcs-pack pack <audio-dir> [--config INI] [--output FILE]
+//       evcs-pack list <bundle>
+#include "AudioBundle.h"
+#include "AudioManifest.h"
+#include "ConfigManager.h"
+#include "StringUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+    std::printf(
+        "用法: evcs-pack pack <audio-dir> [--config INI] [--output FILE]\n"
+        "      evcs-pack list <bundle>\n"
+        "  pack          打包目录下的全部文件（清单、缓存等程序自身的文件除外），默认写入 <audio-dir>/%s\n"
+        "  --config INI  只打包该配置引用到的文件\n"
+        "  --output FILE 输出路径\n"
+        "  list          列出打包文件中的条目\n",
+        AudioBundle::BUNDLE_FILENAME);
+}
+
+double megabytes(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+int pack(const std::filesystem::path& dir, const std::string& dirArg, const std::string& configPath,
+         std::filesystem::path output) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) {
+        std::fprintf(stderr, "目录不存在: %s\n", dirArg.c_str());
+        return 1;
+    }
+    if (output.empty()) {
+        output = dir / AudioBundle::BUNDLE_FILENAME;
+    }
+
+    std::vector<std::string> files;
+    if (!configPath.empty()) {
+        auto& configManager = ConfigManager::getInstance();
+        if (!configManager.loadConfig(StringUtil::utf8ToWide(configPath))) {
+            std::fprintf(stderr, "配置文件加载失败: %s\n", configPath.c_str());
+            return 1;
+        }
+        files = configManager.getAudioFiles();
+    } else {
+        files = AudioManifest::listFiles(dir);
+        files.erase(std::remove(files.begin(), files.end(), std::string(AudioBundle::BUNDLE_FILENAME)), files.end());
+    }
+    if (files.empty()) {
+        std::fprintf(stderr, "没有要打包的文件\n");
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!AudioBundle::pack(dir, files, output, error)) {
+        std::fprintf(stderr, "打包失败: %s\n", error.c_str());
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    auto bundle = AudioBundle::open(output, &error);
+    if (!bundle) {
+        std::fprintf(stderr, "打包结果无法打开: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("已生成 %s: %zu 个文件, %.1f MB, 耗时 %.0f ms\n", output.u8string().c_str(),
+                bundle->entries().size(), megabytes(bundle->fileSize()), ms);
+    return 0;
+}
+
+int list(const std::filesystem::path& path, const std::string& pathArg) {
+    std::string error;
+    auto bundle = AudioBundle::open(path, &error);
+    if (!bundle) {
+        std::fprintf(stderr, "无法打开 %s: %s\n", pathArg.c_str(), error.c_str());
+        return 1;
+    }
+    uint64_t bytes = 0;
+    for (const auto& entry : bundle->entries()) {
+        std::printf("%12llu  %.*s\n", static_cast<unsigned long long>(entry.size),
+                    static_cast<int>(entry.name.size()), entry.name.data());
+        bytes += entry.size;
+    }
+    std::printf("共 %zu 个文件, %.1f MB\n", bundle->entries().size(), megabytes(bytes));
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    const std::string command = argv[1];
+    const std::string pathArg = argv[2];
+    std::string configPath;
+    std::filesystem::path output;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (command == "pack" && arg == "--config" && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (command == "pack" && arg == "--output" && i + 1 < argc) {
+            output = std::filesystem::u8path(argv[++i]);
+        } else {
+            std::fprintf(stderr, "未知选项: %s\n", arg.c_str());
+            printUsage();
+            return 2;
+        }
+    }
+
+    const std::filesystem::path path = std::filesystem::u8path(pathArg);
+    if (command == "pack") {
+        return pack(path, pathArg, configPath, output);
+    }
+    if (command == "list") {
+        return list(path, pathArg);
+    }
+    printUsage();
+    return 2;
+}
@@ -0,0 +1,646 @@
+// evcs-sim：考试日模拟器。以虚拟时间（毫秒精度）回放整份配置，
+// 使用替身输出端记录播放事件，报告每一次播放、跳过与 60 秒过期决策。
+//
+// 用法：evcs-sim <config.ini> [选项]，详见 --help
+//       evcs-sim --scan-audio DIR 列出素材目录下各音频的开头静音与起播时裁去的时长
+//       evcs-sim <config.ini> --preflight 完整解码配置引用到的全部音频，报告解码错误、截断与削波
+#include "AudioBundle.h"
+#include "AudioHeaderParser.h"
+#include "AudioMetadataCache.h"
+#include "AudioMirror.h"
+#include "AudioPreflight.h"
+#include "AudioPlayer.h"
+#include "Clock.h"
+#include "ConfigManager.h"
+#include "ExamSession.h"
+#include "PathUtil.h"
+#include "PlaybackEngine.h"
+#include "RecordingAudioSink.h"
+#include "SilenceScanner.h"
+#include "StringUtil.h"
+#include "Subject.h"
+#include "WavSinkBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+struct SimOptions {
+    std::string configPath;
+    std::string date = "2026-06-07";
+    std::string startTime = "09:00";
+    int gapMinutes = 60;
+    std::vector<std::string> subjects;
+    int launchOffsetSeconds = -900;
+    double defaultDurationSeconds = 10.0;
+    std::vector<std::pair<std::string, double>> durations;
+    std::vector<std::string> missing;
+    std::string audioDir;
+    int pollMs = 1000;
+    int prefetchSeconds = -1;  // <0 表示沿用配置 [设置] prefetch_seconds
+    bool mix = false;
+    double maxOnsetErrorMs = -1.0;  // >=0 时作为校验门限，超出则以非零退出
+    std::string latencyReport;
+    double onsetDelayMs = 0.0;
+    bool compensateLatency = false;  // 按出声延迟提前起播
+    std::string scanAudioDir;  // 非空时只做开头静音扫描，不回放配置
+    bool preflight = false;    // 只做完整解码预检，不回放配置
+    size_t preflightThreads = 0;  // 0 为 CPU 核数
+    std::string mirrorDir;     // 非空时先把引用到的音频镜像到该目录，校验通过后改从镜像取音频
+};
+
+void printUsage() {
+    std::printf(
+        "用法: evcs-sim <config.ini> [选项]\n"
+        "      evcs-sim --scan-audio DIR\n"
+        "      evcs-sim <config.ini> --preflight [--threads N] [--audio-dir DIR]\n"
+        "  --date YYYY-MM-DD        首科开考日期（默认 2026-06-07）\n"
+        "  --start HH:MM            首科开考时间（默认 09:00）\n"
+        "  --gap MINUTES            上一科结束到下一科开考的间隔（默认 60）\n"
+        "  --subjects A,B,...       按顺序回放指定科目（默认配置内全部）\n"
+        "  --launch SECONDS         程序启动时刻相对首科开考的秒数（默认 -900）\n"
+        "  --default-duration SEC   未登记音频的播放时长（默认 10）\n"
+        "  --duration FILE=SEC      登记某音频的播放时长，可重复\n"
+        "  --missing FILE           模拟音频缺失，可重复\n"
+        "  --audio-dir DIR          按该目录下真实文件判定是否缺失，MP3/WAV 时长取自文件头\n"
+        "  --poll-ms MS             播放完成检测周期（默认 1000，对应界面定时器）\n"
+        "  --prefetch SECONDS       预热提前量（默认取配置 prefetch_seconds，0 关闭）\n"
+        "  --mix                    模拟混音输出：到点即播，与上一条叠加而不是等它播完\n"
+        "  --max-onset-error-ms MS  校验自动起播时刻与计划时刻之差不超过 MS，否则退出码 3\n"
+        "  --latency-report FILE    每科结束时把起播延迟（各阶段 p50/p99/max 与直方图）写入 FILE\n"
+        "  --onset-delay-ms MS      替身输出端报告的出声延迟（默认 0），用于检查报告\n"
+        "  --compensate-latency     替身输出端同时把该延迟报告为输出延迟：会话提前起播，起播偏差按出声时刻计\n"
+        "  --scan-audio DIR         列出 DIR 下各音频的开头静音与起播时裁去的时长（不需要配置）：\n"
+        "                           优先取程序写下的元数据缓存，其余 WAV 现场分析，MP3 需由程序分析\n"
+        "  --preflight              完整解码配置引用到的每个音频（不回放），报告缺失、无法解码、截断与削波，\n"
+        "                           有缺失/无法解码/截断时退出码 4。WAV 完整解码，MP3 只检查文件头\n"
+        "  --threads N              预检线程数（默认 CPU 核数）\n"
+        "  --mirror DIR             先把引用到的音频镜像到 DIR（大小 + XXH64 校验），就绪后改从镜像取音频，\n"
+        "                           报告拷贝吞吐与就绪用时；未就绪时仍从源目录取\n");
+}
+
+bool parseArgs(int argc, char** argv, SimOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "缺少参数值: %s\n", name);
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (arg == "--date") {
+            const char* value = next("--date");
+            if (!value) return false;
+            options.date = value;
+        } else if (arg == "--start") {
+            const char* value = next("--start");
+            if (!value) return false;
+            options.startTime = value;
+        } else if (arg == "--gap") {
+            const char* value = next("--gap");
+            if (!value) return false;
+            options.gapMinutes = std::atoi(value);
+        } else if (arg == "--subjects") {
+            const char* value = next("--subjects");
+            if (!value) return false;
+            std::stringstream ss(value);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                if (!name.empty()) options.subjects.push_back(name);
+            }
+        } else if (arg == "--launch") {
+            const char* value = next("--launch");
+            if (!value) return false;
+            options.launchOffsetSeconds = std::atoi(value);
+        } else if (arg == "--default-duration") {
+            const char* value = next("--default-duration");
+            if (!value) return false;
+            options.defaultDurationSeconds = std::atof(value);
+        } else if (arg == "--duration") {
+            const char* value = next("--duration");
+            if (!value) return false;
+            std::string spec = value;
+            size_t eq = spec.rfind('=');
+            if (eq == std::string::npos) {
+                std::fprintf(stderr, "--duration 格式应为 FILE=SEC: %s\n", value);
+                return false;
+            }
+            options.durations.emplace_back(spec.substr(0, eq), std::atof(spec.c_str() + eq + 1));
+        } else if (arg == "--missing") {
+            const char* value = next("--missing");
+            if (!value) return false;
+            options.missing.push_back(value);
+        } else if (arg == "--audio-dir") {
+            const char* value = next("--audio-dir");
+            if (!value) return false;
+            options.audioDir = value;
+        } else if (arg == "--poll-ms") {
+            const char* value = next("--poll-ms");
+            if (!value) return false;
+            options.pollMs = std::max(1, std::atoi(value));
+        } else if (arg == "--prefetch") {
+            const char* value = next("--prefetch");
+            if (!value) return false;
+            options.prefetchSeconds = std::max(0, std::atoi(value));
+        } else if (arg == "--mix") {
+            options.mix = true;
+        } else if (arg == "--max-onset-error-ms") {
+            const char* value = next("--max-onset-error-ms");
+            if (!value) return false;
+            options.maxOnsetErrorMs = std::max(0.0, std::atof(value));
+        } else if (arg == "--latency-report") {
+            const char* value = next("--latency-report");
+            if (!value) return false;
+            options.latencyReport = value;
+        } else if (arg == "--onset-delay-ms") {
+            const char* value = next("--onset-delay-ms");
+            if (!value) return false;
+            options.onsetDelayMs = std::max(0.0, std::atof(value));
+        } else if (arg == "--compensate-latency") {
+            options.compensateLatency = true;
+        } else if (arg == "--preflight") {
+            options.preflight = true;
+        } else if (arg == "--threads") {
+            const char* value = next("--threads");
+            if (!value) return false;
+            options.preflightThreads = static_cast<size_t>(std::max(1, std::atoi(value)));
+        } else if (arg == "--mirror") {
+            const char* value = next("--mirror");
+            if (!value) return false;
+            options.mirrorDir = value;
+        } else if (arg == "--scan-audio") {
+            const char* value = next("--scan-audio");
+            if (!value) return false;
+            options.scanAudioDir = value;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "未知选项: %s\n", arg.c_str());
+            return false;
+        } else {
+            options.configPath = arg;
+        }
+    }
+    return !options.configPath.empty() || !options.scanAudioDir.empty();
+}
+
+std::string formatTime(system_clock::time_point timePoint) {
+    std::tm tm = toLocalTm(system_clock::to_time_t(timePoint));
+    auto ms = duration_cast<milliseconds>(timePoint.time_since_epoch()).count() % 1000;
+    if (ms < 0) ms += 1000;
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms));
+    return buf;
+}
+
+const char* eventLabel(SessionEventType type) {
+    switch (type) {
+        case SessionEventType::PLAYED:      return "PLAY";
+        case SessionEventType::PLAY_FAILED: return "FAIL";
+        case SessionEventType::SKIPPED:     return "SKIP";
+        case SessionEventType::EXPIRED:     return "EXPIRE";
+        case SessionEventType::COMPLETED:   return "DONE";
+        default:                            return "?";
+    }
+}
+
+// 把会话事件打印为一行报告，并做分类计数
+class ReportListener : public ExamSessionListener {
+public:
+    ReportListener(const ExamSession& session, const RecordingAudioSink& sink,
+                   system_clock::time_point origin, double onsetDelayMs)
+        : m_session(session), m_sink(sink), m_origin(origin), m_onsetDelayMs(onsetDelayMs) {}
+
+    void onSessionEvent(const SessionEvent& event) override {
+        const Instruction instruction = m_session.getInstructions().row(event.index);
+        ++m_counts[static_cast<int>(event.type)];
+
+        long long offsetMs = duration_cast<milliseconds>(event.time - m_origin).count();
+        long long lateMs = duration_cast<milliseconds>(event.time - instruction.playTime).count();
+        char offset[32];
+        std::snprintf(offset, sizeof(offset), "%s%02lld:%02lld:%02lld.%03lld",
+                      offsetMs < 0 ? "-" : "+",
+                      std::llabs(offsetMs) / 3600000, (std::llabs(offsetMs) / 60000) % 60,
+                      (std::llabs(offsetMs) / 1000) % 60, std::llabs(offsetMs) % 1000);
+
+        std::printf("T%s  %s  %-6s %s / %s (%s)",
+                    offset, formatTime(event.time).c_str(), eventLabel(event.type),
+                    instruction.subjectName.c_str(), instruction.name.c_str(),
+                    instruction.audioFile.c_str());
+        const auto& instructions = m_session.getInstructions();
+        const int predecessor = instructions.chainPredecessor(event.index);
+        const bool handoff = event.type == SessionEventType::PLAYED && !event.isManualPlay &&
+                             predecessor != InstructionTable::NPOS && m_sink.getRecords().size() >= 2;
+        if (event.type != SessionEventType::COMPLETED && predecessor != InstructionTable::NPOS) {
+            // 接续指令没有计划时刻：报告所接的指令与交接间隙（上一路结束到本路开始）
+            std::printf("  接续 %s", instructions.name(predecessor).c_str());
+            if (handoff) {
+                const auto& records = m_sink.getRecords();
+                double gapMs = duration<double, std::milli>(records.back().startTime -
+                                                            records[records.size() - 2].endTime).count();
+                std::printf("  间隙 %+.0fms", gapMs);
+                m_maxHandoffGapMs = std::max(m_maxHandoffGapMs, std::fabs(gapMs));
+                ++m_handoffs;
+            }
+        } else if (event.type != SessionEventType::COMPLETED) {
+            std::printf("  计划 %s  偏差 %+lldms", formatTime(instruction.playTime).c_str(), lateMs);
+        }
+        if (event.type == SessionEventType::PLAYED && m_sink.getRecords().back().prepared) {
+            std::printf("  [预热]");
+            ++m_preparedStarts;
+        }
+        if (event.type == SessionEventType::PLAYED && !event.isManualPlay && !instruction.chained) {
+            // 起播误差取输出端记录的实际起点加出声延迟，而非决策时刻
+            double onsetErrorMs = duration<double, std::milli>(
+                m_sink.getRecords().back().startTime - instruction.playTime).count() + m_onsetDelayMs;
+            m_maxOnsetErrorMs = std::max(m_maxOnsetErrorMs, std::fabs(onsetErrorMs));
+        }
+        std::printf("\n");
+    }
+
+    int count(SessionEventType type) const { return m_counts[static_cast<int>(type)]; }
+    int preparedStarts() const { return m_preparedStarts; }
+    double maxOnsetErrorMs() const { return m_maxOnsetErrorMs; }
+    int handoffs() const { return m_handoffs; }
+    double maxHandoffGapMs() const { return m_maxHandoffGapMs; }
+
+private:
+    const ExamSession& m_session;
+    const RecordingAudioSink& m_sink;
+    system_clock::time_point m_origin;
+    double m_onsetDelayMs;
+    int m_counts[5] = {0, 0, 0, 0, 0};
+    int m_preparedStarts = 0;
+    double m_maxOnsetErrorMs = 0.0;
+    int m_handoffs = 0;
+    double m_maxHandoffGapMs = 0.0;
+};
+
+// --scan-audio：目录下每个可识别的音频一行。开头静音优先取缓存文件中大小与修改时间未变的记录
+// （Windows 上由程序经 BASS 分析，含 MP3），否则 WAV 用可移植解码现场分析；不写缓存文件
+int scanAudio(const std::string& dirArg) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::u8path(dirArg);
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        std::fprintf(stderr, "不是目录: %s\n", dirArg.c_str());
+        return 1;
+    }
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file(ec)) {
+            files.push_back(entry.path().filename().u8string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    const auto cached = AudioMetadataCache::readCache(dir);
+    const uint32_t rate = WavSinkOptions().sampleRate;
+    WavSinkBackend decoder;  // 只用其解码，不打开输出
+
+    std::printf("开头静音扫描: %s  门限 %.0f dBFS，起音前保留 %.0f ms，内核 %s\n", dirArg.c_str(),
+                SilenceScanner::THRESHOLD_DBFS, AudioPlayer::TRIM_PREROLL_SECONDS * 1000.0,
+                CpuFeatures::name(CpuFeatures::best()));
+    std::printf("%-32s %9s %12s %10s %10s  %s\n", "文件", "时长(s)", "开头静音(ms)", "裁去(ms)", "响度", "来源");
+    size_t audioFiles = 0;
+    size_t analyzed = 0;
+    double totalTrimMs = 0.0;
+    double maxTrimMs = 0.0;
+    std::string maxTrimFile;
+    const auto scanStart = steady_clock::now();
+    for (const auto& file : files) {
+        const fs::path path = dir / fs::u8path(file);
+        AudioFormatInfo info;
+        if (!AudioHeaderParser::probeFile(path, info)) {
+            continue;  // 非音频（含缓存文件本身）
+        }
+        ++audioFiles;
+
+        AudioMetadata metadata;
+        const char* from = nullptr;
+        auto it = cached.find(file);
+        uint64_t size = fs::file_size(path, ec);
+        int64_t modified = fs::last_write_time(path, ec).time_since_epoch().count();
+        if (it != cached.end() && it->second.fileSize == size && it->second.modifiedTime == modified &&
+            it->second.loudnessStatus != LoudnessStatus::PENDING) {
+            metadata = it->second;
+            from = "缓存";
+        } else if (info.codec == AudioCodec::WAV_PCM || info.codec == AudioCodec::WAV_FLOAT) {
+            double duration = 0.0;
+            auto source = decoder.openSource(path, AudioBytes(), rate, 0.0, false, &duration);
+            if (source) {
+                metadata.loudnessStatus = AudioMetadataCache::analyzeSource(*source, rate, metadata)
+                                              ? LoudnessStatus::MEASURED
+                                              : LoudnessStatus::FAILED;
+                from = "分析";
+            }
+        }
+        if (!from) {
+            std::printf("%-32s %9.3f %12s %10s %10s  %s\n", file.c_str(), info.durationSeconds, "-", "-", "-",
+                        "未分析（需由程序分析）");
+            continue;
+        }
+        ++analyzed;
+        const double leadingMs = metadata.leadingSilenceSeconds * 1000.0;
+        const double trimMs = std::max(0.0, leadingMs - AudioPlayer::TRIM_PREROLL_SECONDS * 1000.0);
+        totalTrimMs += trimMs;
+        if (trimMs > maxTrimMs) {
+            maxTrimMs = trimMs;
+            maxTrimFile = file;
+        }
+        char loudness[32] = "-";
+        if (metadata.loudnessStatus == LoudnessStatus::MEASURED) {
+            std::snprintf(loudness, sizeof(loudness), "%.1f", metadata.loudnessLufs);
+        }
+        std::printf("%-32s %9.3f %12.1f %10.1f %10s  %s\n", file.c_str(), info.durationSeconds, leadingMs, trimMs,
+                    loudness, from);
+    }
+    double wallMs = duration<double, std::milli>(steady_clock::now() - scanStart).count();
+    std::printf("\n汇总: 音频 %zu 个，已分析 %zu 个，未分析 %zu 个；裁去合计 %.1f ms，平均 %.1f ms",
+                audioFiles, analyzed, audioFiles - analyzed, totalTrimMs, analyzed ? totalTrimMs / analyzed : 0.0);
+    if (!maxTrimFile.empty()) {
+        std::printf("，最大 %.1f ms (%s)", maxTrimMs, maxTrimFile.c_str());
+    }
+    std::printf("\n耗时 %.2f ms\n", wallMs);
+    return 0;
+}
+
+// --preflight：按 --threads 个线程完整解码配置引用到的每个不同文件（打包文件优先，其次 audio 目录）。
+// 可移植解码只支持 WAV，MP3 只检查文件头（Windows 上由程序菜单经 BASS 完整解码）
+int runPreflight(const std::vector<std::string>& files, size_t threads) {
+    WavSinkBackend decoder;  // 只用其解码，不打开输出
+    AudioPreflight preflight;
+    preflight.setDecoder(AudioPreflight::backendDecoder(decoder));
+    preflight.setThreads(threads);
+    const PreflightReport report = preflight.run(files);
+    std::printf("素材: %s  内核 %s\n", PathUtil::getAudioDir().u8string().c_str(),
+                CpuFeatures::name(CpuFeatures::best()));
+    std::printf("%-32s %6s %10s %10s %9s %10s  %s\n", "文件", "格式", "文件头(s)", "解码(s)", "峰值", "耗时(ms)",
+                "结论");
+    for (const PreflightResult& result : report.results) {
+        char decoded[32] = "-";
+        char peak[32] = "-";
+        if (result.decoded) {
+            std::snprintf(decoded, sizeof(decoded), "%.3f", result.decodedSeconds);
+            std::snprintf(peak, sizeof(peak), "%.3f", result.samplePeak);
+        }
+        std::printf("%-32s %6s %10.3f %10s %9s %10.1f  %s%s\n", result.file.c_str(),
+                    result.codec.empty() ? "-" : result.codec.c_str(), result.headerSeconds, decoded, peak,
+                    result.decodeMs, AudioPreflight::problemName(result.problem),
+                    !result.decoded && result.problem == PreflightProblem::NONE ? "（仅文件头）" : "");
+    }
+    std::printf("\n%s", AudioPreflight::formatReport(report).c_str());
+    return report.problemFiles > 0 ? 4 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (!options.scanAudioDir.empty()) {
+        return scanAudio(options.scanAudioDir);
+    }
+
+    auto& configManager = ConfigManager::getInstance();
+    if (!configManager.loadConfig(StringUtil::utf8ToWide(options.configPath))) {
+        std::fprintf(stderr, "配置文件加载失败: %s\n", options.configPath.c_str());
+        return 1;
+    }
+    if (options.subjects.empty()) {
+        options.subjects = configManager.getSubjectNames();
+    }
+    if (!options.audioDir.empty()) {
+        PathUtil::setAudioDir(options.audioDir);
+    }
+    if (options.prefetchSeconds < 0) {
+        options.prefetchSeconds = configManager.getPrefetchSeconds();
+    }
+    if (!options.mirrorDir.empty()) {
+        AudioMirror mirror;
+        const std::filesystem::path sourceDir = PathUtil::getAudioSourceDir();
+        const MirrorReport mirrored = mirror.sync(sourceDir, std::filesystem::u8path(options.mirrorDir),
+                                                  AudioMirror::listFiles(sourceDir, configManager.getAudioFiles()));
+        std::printf("%s（校验 %.1f ms）\n", AudioMirror::formatReport(mirrored).c_str(), mirrored.verifyMs);
+        for (const auto& problem : mirrored.problems) {
+            std::printf("  %s: %s\n", problem.first.c_str(), AudioMirror::problemName(problem.second));
+        }
+        if (mirrored.ready) {
+            PathUtil::setAudioMirror(mirrored.mirrorDir);
+        }
+    }
+    if (options.preflight) {
+        return runPreflight(configManager.getAudioFiles(), options.preflightThreads);
+    }
+
+    // 按顺序排布科目：首科按 --date/--start，其后每科在上一科结束 + gap 开考
+    std::vector<Subject> subjects;
+    system_clock::time_point nextStart;
+    for (size_t i = 0; i < options.subjects.size(); ++i) {
+        if (configManager.getSubjectConfig(options.subjects[i]).name.empty()) {
+            std::fprintf(stderr, "配置中不存在科目: %s\n", options.subjects[i].c_str());
+            return 1;
+        }
+        Subject subject = Subject::createSubject(options.subjects[i]);
+        if (i == 0) {
+            if (!Subject::isValidDateTime(options.date, options.startTime)) {
+                std::fprintf(stderr, "日期/时间格式错误: %s %s\n",
+                             options.date.c_str(), options.startTime.c_str());
+                return 1;
+            }
+            subject.setStartDateTime(options.date, options.startTime);
+        } else {
+            subject.startTime = nextStart;
+        }
+        nextStart = subject.startTime + minutes(subject.durationMinutes + options.gapMinutes);
+        subjects.push_back(subject);
+    }
+    if (subjects.empty()) {
+        std::fprintf(stderr, "没有可回放的科目\n");
+        return 1;
+    }
+
+    const auto origin = subjects.front().startTime;
+    VirtualClock clock(origin + seconds(options.launchOffsetSeconds));
+    RecordingAudioSink sink(clock);
+    sink.setDefaultDurationSeconds(options.defaultDurationSeconds);
+    sink.setRequireFiles(!options.audioDir.empty());
+    sink.setOverlap(options.mix);
+    sink.setOnsetDelayMs(options.onsetDelayMs);
+    sink.setOutputLatencyMs(options.compensateLatency ? options.onsetDelayMs : 0.0);
+    // 指定素材目录时按文件头取真实时长（目录下有打包文件时先查包）；无法识别的文件按播放失败处理
+    // （--duration 仍可覆盖）
+    size_t probedFiles = 0;
+    size_t bundledFiles = 0;
+    std::vector<std::string> unreadable;
+    if (!options.audioDir.empty()) {
+        for (const auto& file : configManager.getAudioFiles()) {
+            AudioLocation location;
+            if (!AudioBundle::locate(file, location)) {
+                continue;
+            }
+            AudioFormatInfo info;
+            std::string error;
+            bool recognized = location.inBundle()
+                                  ? AudioHeaderParser::probeMemory(location.bytes.data, location.bytes.size, info,
+                                                                   &error)
+                                  : AudioHeaderParser::probeFile(location.path, info, &error);
+            if (recognized) {
+                sink.setDurationSeconds(file, info.durationSeconds);
+                ++probedFiles;
+                bundledFiles += location.inBundle() ? 1 : 0;
+            } else {
+                sink.setMissing(file);
+                unreadable.push_back(file + "（" + error + "）");
+            }
+        }
+    }
+    for (const auto& entry : options.durations) {
+        sink.setDurationSeconds(entry.first, entry.second);
+    }
+    for (const auto& file : options.missing) {
+        sink.setMissing(file);
+    }
+
+    ExamSession session(clock, sink);
+    ReportListener report(session, sink, origin, options.onsetDelayMs);
+    session.setListener(&report);
+    session.regenerate(subjects);
+
+    if (!options.audioDir.empty()) {
+        std::printf("素材: %s  按文件头取时长 %zu 个，无法识别 %zu 个\n", options.audioDir.c_str(), probedFiles,
+                    unreadable.size());
+        if (auto bundle = AudioBundle::mounted()) {
+            std::printf("打包文件: %s  %zu 个条目，本配置引用 %zu 个\n", bundle->path().u8string().c_str(),
+                        bundle->entries().size(), bundledFiles);
+        }
+        for (const auto& file : unreadable) {
+            std::printf("  无法识别: %s\n", file.c_str());
+        }
+    }
+    std::printf("配置: %s  科目: %zu  指令: %zu  启动: %s\n",
+                options.configPath.c_str(), subjects.size(), session.getInstructions().size(),
+                formatTime(clock.now()).c_str());
+    for (const auto& subject : subjects) {
+        std::printf("  %s  %s ~ %s\n", subject.name.c_str(),
+                    subject.getStartDateTimeString().c_str(), subject.getEndDateTimeString().c_str());
+    }
+
+    // 事件驱动推进：下一条指令到点（对应调度器）、到点前的预热（对应调度器预取）
+    // 与播放结束后的首个检测周期（对应界面定时器）
+    const auto launchTime = clock.now();
+    const auto pollPeriod = milliseconds(options.pollMs);
+    const auto prefetchLead = seconds(options.prefetchSeconds);
+    int preparedIndex = -1;
+    const std::filesystem::path latencyPath = std::filesystem::u8path(options.latencyReport);
+    int latencyReports = 0;
+    auto wallStart = steady_clock::now();
+    size_t steps = 0;
+    // 驱动一次：与界面定时器处理顺序一致，先检测完成再做播放决策
+    bool progressed = session.checkPlaybackCompletion();
+    progressed = session.updateNextInstruction() || progressed;
+    while (true) {
+        auto due = session.getNextDueTime();
+        auto playbackEnd = sink.getPlaybackEndTime();
+        // 完成检测按界面定时器周期取整；有接续指令在等时由输出端播完通知驱动，在结束时刻当即检测
+        if (playbackEnd != system_clock::time_point::max() && !session.isChainPending()) {
+            auto sinceLaunch = playbackEnd - launchTime;
+            auto periods = (sinceLaunch + pollPeriod - system_clock::duration(1)) / pollPeriod;
+            playbackEnd = launchTime + periods * pollPeriod;
+        }
+        // 与调度器一致：每次布防至多预热一次，已进入精等待窗口的不再预热
+        const int nextIndex = session.getNextInstructionIndex();
+        auto prefetchAt = system_clock::time_point::max();
+        if (prefetchLead > seconds::zero() && due != system_clock::time_point::max() &&
+            nextIndex != preparedIndex) {
+            if (due - clock.now() <= PlaybackEngine::SPIN_WINDOW) {
+                preparedIndex = nextIndex;
+            } else if (due - prefetchLead <= clock.now()) {
+                sink.prepare(session.getInstructions().audioFile(nextIndex));
+                preparedIndex = nextIndex;
+                continue;
+            } else {
+                prefetchAt = due - prefetchLead;
+            }
+        }
+
+        auto next = std::min({due, playbackEnd, prefetchAt});
+        if (next == system_clock::time_point::max()) {
+            break;
+        }
+        if (next == prefetchAt) {
+            clock.set(next);
+            continue;
+        }
+        // 同一时刻到点的多条指令（混音输出下逐条起播）不推进时钟；无进展时推进 1ms 防止空转
+        clock.set(std::max(next, clock.now() + milliseconds(next > clock.now() || progressed ? 0 : 1)));
+        progressed = session.checkPlaybackCompletion();
+        progressed = session.updateNextInstruction() || progressed;
+        ++steps;
+        if (!latencyPath.empty() && session.getLatency().takeReportDue(session.getInstructions())) {
+            latencyReports += session.getLatency().writeReport(latencyPath) ? 1 : 0;
+        }
+    }
+    double wallMs = duration<double, std::milli>(steady_clock::now() - wallStart).count();
+
+    std::printf("\n汇总: 播放 %d  失败 %d  跳过 %d  过期 %d  完成 %d\n",
+                report.count(SessionEventType::PLAYED), report.count(SessionEventType::PLAY_FAILED),
+                report.count(SessionEventType::SKIPPED), report.count(SessionEventType::EXPIRED),
+                report.count(SessionEventType::COMPLETED));
+    std::printf("预热 %d 次，起播命中 %d/%d（提前量 %d 秒）\n",
+                sink.getPrepareCount(), report.preparedStarts(),
+                report.count(SessionEventType::PLAYED), options.prefetchSeconds);
+    int overlapped = 0;
+    for (const auto& record : sink.getRecords()) {
+        overlapped += record.overlapped ? 1 : 0;
+    }
+    std::printf("自动起播最大偏差 %.3f ms；%s\n", report.maxOnsetErrorMs(),
+                options.mix ? ("叠加播放 " + std::to_string(overlapped) + " 次").c_str()
+                            : "单路输出（上一条未播完时顺延）");
+    if (report.handoffs() > 0) {
+        std::printf("接续 %d 次，最大交接间隙 %.3f ms\n", report.handoffs(), report.maxHandoffGapMs());
+    }
+    if (options.compensateLatency) {
+        std::printf("输出延迟补偿：提前 %.3f ms 起播\n",
+                    duration<double, std::milli>(session.getStartLead()).count());
+    }
+    std::printf("虚拟时长 %.1f 分钟，推进 %zu 步，耗时 %.2f ms\n",
+                duration<double>(clock.now() - launchTime).count() / 60.0, steps, wallMs);
+    if (!latencyPath.empty()) {
+        // 末科最后一条之后可能没有状态变化，收尾再写一次
+        if (!session.getLatency().samples().empty()) {
+            latencyReports += session.getLatency().writeReport(latencyPath) ? 1 : 0;
+        }
+        LatencyHistogram onset;
+        for (const auto& sample : session.getLatency().samples()) {
+            if (!sample.manual && sample.audibleKnown) {
+                onset.add(sample.onsetMs());
+            }
+        }
+        std::printf("起播延迟报告 %s：写出 %d 次，%zu 条，总计 p50 %.3f / p99 %.3f / max %.3f ms\n",
+                    options.latencyReport.c_str(), latencyReports, onset.count(), onset.percentile(50),
+                    onset.percentile(99), onset.max());
+    }
+    if (options.maxOnsetErrorMs >= 0.0 && report.maxOnsetErrorMs() > options.maxOnsetErrorMs) {
+        std::printf("起播偏差校验失败: %.3f ms > %.3f ms\n", report.maxOnsetErrorMs(), options.maxOnsetErrorMs);
+        return 3;
+    }
+    return 0;
+}